@@ -3,10 +3,13 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <arith_uint256.h>
 #include <bench/bench.h>
 #include <config.h>
 #include <consensus/validation.h>
+#include <miner.h>
 #include <script/standard.h>
+#include <test/setup_common.h>
 #include <test/util.h>
 #include <txmempool.h>
 #include <validation.h>
@@ -56,3 +59,50 @@ static void AssembleBlock(benchmark::State &state) {
 }
 
 BENCHMARK(AssembleBlock, 700);
+
+/// Fill a mempool with `nTxs` independent transactions, then repeatedly add 100 more and assemble a block template,
+/// either by selecting from the whole mempool or by updating an incrementally maintained template.
+static void benchAssembleBlockFromMempool(benchmark::State &state, size_t nTxs, bool incremental) {
+    const Config &config = GetConfig();
+    CTxMemPool pool;
+    IncrementalBlockTemplate incrementalTemplate(pool);
+    TestMemPoolEntryHelper entry;
+
+    size_t nextTx = 0;
+    auto AddTxs = [&](size_t count) {
+        LOCK2(cs_main, pool.cs);
+        for (size_t i = 0; i < count; ++i, ++nextTx) {
+            CMutableTransaction tx;
+            tx.vin.emplace_back(COutPoint(TxId(ArithToUint256(arith_uint256(nextTx + 1))), 0),
+                                CScript() << std::vector<uint8_t>(100, 0xff));
+            tx.vout.emplace_back(1337 * SATOSHI, CScript() << OP_TRUE);
+            pool.addUnchecked(entry.Fee(int64_t(1000 + nextTx % 5000) * SATOSHI).FromTx(tx));
+        }
+    };
+    AddTxs(nTxs);
+
+    auto AssembleBlock = [&] {
+        const CScript scriptPubKey = CScript() << OP_TRUE;
+        auto blocktemplate = incremental
+                ? BlockAssembler(config, incrementalTemplate).CreateNewBlock(scriptPubKey, 0, false)
+                : BlockAssembler(config, pool).CreateNewBlock(scriptPubKey, 0, false);
+        assert(blocktemplate->block.vtx.size() == nextTx + 1);
+    };
+    // The first incremental template is a full selection.
+    AssembleBlock();
+
+    BENCHMARK_LOOP {
+        AddTxs(100);
+        AssembleBlock();
+    }
+}
+
+static void AssembleBlockFromMempool100k(benchmark::State &state) {
+    benchAssembleBlockFromMempool(state, 100'000, false);
+}
+static void AssembleBlockIncremental100k(benchmark::State &state) {
+    benchAssembleBlockFromMempool(state, 100'000, true);
+}
+
+BENCHMARK(AssembleBlockFromMempool100k, 10);
+BENCHMARK(AssembleBlockIncremental100k, 10);
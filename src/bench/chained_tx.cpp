@@ -6,14 +6,19 @@
 #include <bench/bench.h>
 #include <config.h>
 #include <consensus/validation.h>
+#include <key.h>
 #include <miner.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <script/script.h>
+#include <script/sighashtype.h>
 #include <script/standard.h>
 #include <test/setup_common.h>
 #include <test/util.h>
 #include <txmempool.h>
 #include <util/system.h>
+#include <util/time.h>
 #include <validation.h>
 
 #include <list>
@@ -152,6 +157,117 @@ static void benchATMP(const Config& config,
 }
 
 
+/// Sign input 0 of `tx`, which spends `prevTxOut`, a P2PK output of `key`
+static void signInput(const CKey &key, const CTxOut &prevTxOut, CMutableTransaction &tx) {
+    const SigHashType sigHashType = SigHashType().withFork();
+    const uint256 hash = SignatureHash(prevTxOut.scriptPubKey, ScriptExecutionContext{0, prevTxOut, tx},
+                                       sigHashType, nullptr, STANDARD_SCRIPT_VERIFY_FLAGS).signatureHash;
+    std::vector<uint8_t> vchSig;
+    const bool ok = key.SignSchnorr(hash, vchSig);
+    assert(ok);
+    vchSig.push_back(uint8_t(sigHashType.getRawSigHashType()));
+    tx.vin[0].scriptSig = CScript() << vchSig;
+}
+
+/// Create a signed 1-input-1-output transaction spending `prevout`
+static CTransactionRef signedSpend(const CKey &key, const COutPoint &prevout, const CTxOut &prevTxOut,
+                                   const Amount fee) {
+    CMutableTransaction tx;
+    tx.vin.emplace_back(prevout);
+    tx.vout.emplace_back(prevTxOut.nValue - fee, prevTxOut.scriptPubKey);
+    signInput(key, prevTxOut, tx);
+    return MakeTransactionRef(tx);
+}
+
+/// Mine a transaction with `n` P2PK outputs of `key`
+static CTransactionRef createSignedUTXOs(const Config &config, const CKey &key, size_t n) {
+    const CScript scriptPubKey = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+    const CTxIn coinbaseIn = MineBlock(config, scriptPubKey);
+    for (size_t i = 0; i < COINBASE_MATURITY; ++i) {
+        MineBlock(config, SCRIPT_PUB_KEY);
+    }
+    const CTxOut coinbaseOut = WITH_LOCK(::cs_main, return pcoinsTip->AccessCoin(coinbaseIn.prevout).GetTxOut());
+
+    CMutableTransaction tx;
+    tx.vin.emplace_back(coinbaseIn);
+    const Amount value = (coinbaseOut.nValue - COIN) / int64_t(n);
+    for (size_t i = 0; i < n; ++i) {
+        tx.vout.emplace_back(value, scriptPubKey);
+    }
+    signInput(key, coinbaseOut, tx);
+    const CTransactionRef txRef = MakeTransactionRef(tx);
+    {
+        LOCK(::cs_main);
+        CValidationState vstate;
+        const bool ok = AcceptToMemoryPool(config, g_mempool, vstate, txRef, nullptr /* pfMissingInputs */,
+                                           false /* bypass_limits */, Amount::zero() /* nAbsurdFee */);
+        assert(ok);
+    }
+    MineBlock(config, SCRIPT_PUB_KEY);
+    assert(g_mempool.size() == 0);
+    return txRef;
+}
+
+/// Run benchmark on AcceptToMemoryPool, or on AcceptToMemoryPoolBatch if
+/// 'batch' is set, with signed transactions that spend the outputs of
+/// 'fundingTx' independently of each other, or one after the other in a
+/// single chain if 'chained' is set.
+///
+/// Every iteration gets its own set of transactions (they differ in fee), so
+/// that signatures are never found in the signature cache.
+static void benchSignedATMP(const Config &config, benchmark::State &state, size_t txCount, bool chained, bool batch) {
+    CKey key;
+    key.MakeNewKey(true);
+    const CTransactionRef fundingTx = createSignedUTXOs(config, key, chained ? 1 : txCount);
+
+    std::vector<std::vector<CTransactionRef>> txSets(state.m_num_iters);
+    for (uint64_t iter = 0; iter < state.m_num_iters; ++iter) {
+        const Amount fee = (1000 + int64_t(iter)) * SATOSHI;
+        auto &txs = txSets[iter];
+        txs.reserve(txCount);
+        if (chained) {
+            txs.push_back(signedSpend(key, COutPoint(fundingTx->GetId(), 0), fundingTx->vout[0], fee));
+            while (txs.size() < txCount) {
+                txs.push_back(signedSpend(key, COutPoint(txs.back()->GetId(), 0), txs.back()->vout[0], fee));
+            }
+        } else {
+            for (uint32_t n = 0; n < txCount; ++n) {
+                txs.push_back(signedSpend(key, COutPoint(fundingTx->GetId(), n), fundingTx->vout[n], fee));
+            }
+        }
+    }
+
+    auto it = txSets.begin();
+    LOCK(::cs_main);
+    assert(g_mempool.size() == 0);
+    BENCHMARK_LOOP {
+        assert(it != txSets.end());
+        const auto &txs = *it++;
+        if (batch) {
+            std::vector<MempoolAcceptBatchEntry> entries;
+            entries.reserve(txs.size());
+            for (const auto &tx : txs) {
+                entries.emplace_back(tx, GetTime());
+            }
+            AcceptToMemoryPoolBatch(config, g_mempool, entries, false /* bypass_limits */,
+                                    Amount::zero() /* nAbsurdFee */);
+            for (const auto &entry : entries) {
+                assert(entry.fAccepted);
+            }
+        } else {
+            for (const auto &tx : txs) {
+                CValidationState vstate;
+                bool ok = AcceptToMemoryPool(config, g_mempool, vstate, tx, nullptr /* pfMissingInputs */,
+                                             false /* bypass_limits */, Amount::zero() /* nAbsurdFee */);
+                assert(ok);
+            }
+        }
+        assert(g_mempool.size() == txs.size());
+        g_mempool.clear();
+    }
+}
+
+
 /// Run benchmark that reorganizes blocks with one-input-one-output transaction
 /// chains in them.
 ///
@@ -353,6 +469,26 @@ static void MempoolAcceptance511TxTree(benchmark::State& state) {
     benchATMP(config, state, chainedTxs);
 }
 
+/// Tests 200 independent signed transactions, one at a time
+static void MempoolAcceptance200SignedTxs(benchmark::State& state) {
+    benchSignedATMP(GetConfig(), state, 200, false /* chained */, false /* batch */);
+}
+
+/// Tests 200 independent signed transactions, as one batch
+static void MempoolAcceptance200SignedTxsBatch(benchmark::State& state) {
+    benchSignedATMP(GetConfig(), state, 200, false /* chained */, true /* batch */);
+}
+
+/// Tests a chain of 200 signed 1-input-1-output transactions, one at a time
+static void MempoolAcceptance200SignedChainedTxs(benchmark::State& state) {
+    benchSignedATMP(GetConfig(), state, 200, true /* chained */, false /* batch */);
+}
+
+/// Tests a chain of 200 signed 1-input-1-output transactions, as one batch
+static void MempoolAcceptance200SignedChainedTxsBatch(benchmark::State& state) {
+    benchSignedATMP(GetConfig(), state, 200, true /* chained */, true /* batch */);
+}
+
 
 /// Try to reorg a chain of depth 10 where each block has a 50 tx 1-input-1-output chain.
 static void Reorg10BlocksWith50TxChain(benchmark::State& state) {
@@ -427,6 +563,10 @@ BENCHMARK(MempoolAcceptance50ChainedTxs, 600);
 BENCHMARK(MempoolAcceptance500ChainedTxs, 6);
 BENCHMARK(MempoolAcceptance63TxTree, 800);
 BENCHMARK(MempoolAcceptance511TxTree, 80);
+BENCHMARK(MempoolAcceptance200SignedTxs, 30);
+BENCHMARK(MempoolAcceptance200SignedTxsBatch, 30);
+BENCHMARK(MempoolAcceptance200SignedChainedTxs, 30);
+BENCHMARK(MempoolAcceptance200SignedChainedTxsBatch, 30);
 
 BENCHMARK(Reorg10BlocksWith50TxChain, 10);
 BENCHMARK(Reorg10BlocksWith500TxChain, 1);
@@ -6,6 +6,7 @@
 #include <bench/bench.h>
 #include <bench/data.h>
 #include <checkqueue.h>
+#include <crypto/sha256.h>
 #include <logging.h>
 #include <policy/policy.h>
 #include <prevector.h>
@@ -13,10 +14,12 @@
 #include <random.h>
 #include <script/sigcache.h>
 #include <streams.h>
+#include <tinyformat.h>
 #include <util/defer.h>
 #include <util/system.h>
 #include <validation.h>
 
+#include <any>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -161,6 +164,94 @@ static void CCheckQueue_RealBlock_32MB_WithCacheStore(benchmark::State &state) {
     CCheckQueue_RealData32MB(true, state);
 }
 
+/**
+ * Scaling benchmark: the same synthetic block is verified with a total of
+ * `nThreads` threads (the master plus nThreads - 1 workers), so the results of
+ * the CCheckQueueScaling_* benchmarks can be compared directly with each other.
+ * Each check hashes a bit of data to stand in for a signature check, and the
+ * checks are added per transaction the way ConnectBlock() does. The steal
+ * counts and the time the master spent waiting for the workers are reported
+ * as extra data.
+ */
+static void CCheckQueueScaling(benchmark::State &state, int nThreads) {
+    static constexpr size_t TXS = 10000;
+    static constexpr int HASH_ROUNDS = 16;
+
+    struct HashJob {
+        uint8_t data[64]{};
+        bool operator()() {
+            for (int i = 0; i < HASH_ROUNDS; ++i) {
+                CSHA256().Write(data, sizeof(data)).Finalize(data);
+            }
+            return true;
+        }
+    };
+    FastRandomContext insecure_rand(true);
+    std::vector<size_t> vChecksPerTx(TXS);
+    for (auto &n : vChecksPerTx) {
+        n = 1 + insecure_rand.randrange(3);
+    }
+
+    CCheckQueue<HashJob> queue{QUEUE_BATCH_SIZE};
+    queue.StartWorkerThreads(nThreads - 1);
+    Defer d([&queue]{
+        queue.StopWorkerThreads();
+    });
+
+    struct Totals {
+        int nThreads;
+        uint64_t nRuns = 0;
+        CCheckQueueStats stats;
+    } totals{nThreads};
+    BENCHMARK_LOOP {
+        CCheckQueueControl<HashJob> control(&queue);
+        for (const size_t n : vChecksPerTx) {
+            std::vector<HashJob> vChecks(n);
+            control.Add(vChecks);
+        }
+        const bool result = control.Wait();
+        assert(result);
+        const CCheckQueueStats stats = control.GetStats();
+        totals.stats.nChecks += stats.nChecks;
+        totals.stats.nSteals += stats.nSteals;
+        totals.stats.nStolenChecks += stats.nStolenChecks;
+        totals.stats.nMasterWaitMicros += stats.nMasterWaitMicros;
+        ++totals.nRuns;
+    }
+
+    state.anyData = totals;
+    if (!state.completionFunction) {
+        state.completionFunction = [](const benchmark::State &st, benchmark::Printer &p) {
+            const auto &[threads, runs, stats] = std::any_cast<const Totals &>(st.anyData);
+            if (!runs) return;
+            benchmark::Printer::ExtraData data = {{
+                {"Name", st.GetName()},
+                {"Threads", strprintf("%d", threads)},
+                {"ChecksPerRun", strprintf("%d", stats.nChecks / runs)},
+                {"StealsPerRun", strprintf("%d", stats.nSteals / runs)},
+                {"StolenChecksPerRun", strprintf("%d", stats.nStolenChecks / runs)},
+                {"MasterWaitMsPerRun", strprintf("%1.3f", stats.nMasterWaitMicros / 1000.0 / runs)},
+            }};
+            p.appendExtraDataForCategory("checkqueue (scaling)", std::move(data));
+        };
+    }
+}
+
+static void CCheckQueueScaling_1Thread(benchmark::State &state) { CCheckQueueScaling(state, 1); }
+static void CCheckQueueScaling_2Threads(benchmark::State &state) { CCheckQueueScaling(state, 2); }
+static void CCheckQueueScaling_4Threads(benchmark::State &state) { CCheckQueueScaling(state, 4); }
+static void CCheckQueueScaling_8Threads(benchmark::State &state) { CCheckQueueScaling(state, 8); }
+static void CCheckQueueScaling_16Threads(benchmark::State &state) { CCheckQueueScaling(state, 16); }
+static void CCheckQueueScaling_32Threads(benchmark::State &state) { CCheckQueueScaling(state, 32); }
+static void CCheckQueueScaling_64Threads(benchmark::State &state) { CCheckQueueScaling(state, 64); }
+
 BENCHMARK(CCheckQueueSpeedPrevectorJob, 1400);
+BENCHMARK(CCheckQueueScaling_1Thread, 5);
+BENCHMARK(CCheckQueueScaling_2Threads, 5);
+BENCHMARK(CCheckQueueScaling_4Threads, 5);
+BENCHMARK(CCheckQueueScaling_8Threads, 5);
+BENCHMARK(CCheckQueueScaling_16Threads, 5);
+BENCHMARK(CCheckQueueScaling_32Threads, 5);
+BENCHMARK(CCheckQueueScaling_64Threads, 5);
 BENCHMARK(CCheckQueue_RealBlock_32MB_NoCacheStore, 5);
 BENCHMARK(CCheckQueue_RealBlock_32MB_WithCacheStore, 5);
@@ -0,0 +1,63 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <bench/bench.h>
+#include <blockencodings.h>
+#include <config.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <test/setup_common.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <cassert>
+#include <vector>
+
+/// Fill a mempool with `nPoolTxs` independent transactions, then repeatedly reconstruct a compact block that contains
+/// `nBlockTxs` of them, which dominates the cost of receiving a cmpctblock from a peer.
+static void benchCompactBlockReconstruction(benchmark::State &state, size_t nPoolTxs, size_t nBlockTxs) {
+    const Config &config = GetConfig();
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+
+    CBlock block;
+    block.nBits = 0x207fffff;
+    {
+        CMutableTransaction coinbase;
+        coinbase.vin.emplace_back(COutPoint(), CScript() << OP_0 << OP_0);
+        coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+        block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    }
+
+    {
+        LOCK2(cs_main, pool.cs);
+        for (size_t i = 0; i < nPoolTxs; ++i) {
+            CMutableTransaction tx;
+            tx.vin.emplace_back(COutPoint(TxId(ArithToUint256(arith_uint256(i + 1))), 0),
+                                CScript() << std::vector<uint8_t>(100, 0xff));
+            tx.vout.emplace_back(1337 * SATOSHI, CScript() << OP_TRUE);
+            const CTransactionRef ptx = MakeTransactionRef(std::move(tx));
+            pool.addUnchecked(entry.FromTx(ptx));
+            // Spread the block transactions over the whole mempool
+            if (block.vtx.size() <= nBlockTxs && i % (nPoolTxs / nBlockTxs) == 0) {
+                block.vtx.push_back(ptx);
+            }
+        }
+    }
+    const CBlockHeaderAndShortTxIDs cmpctblock(block);
+
+    BENCHMARK_LOOP {
+        PartiallyDownloadedBlock partialBlock(config, &pool);
+        const ReadStatus status = partialBlock.InitData(cmpctblock, {});
+        assert(status == READ_STATUS_OK);
+        assert(partialBlock.IsTxAvailable(nBlockTxs));
+    }
+}
+
+static void CompactBlockReconstruction200k(benchmark::State &state) {
+    benchCompactBlockReconstruction(state, 200'000, 5'000);
+}
+
+BENCHMARK(CompactBlockReconstruction200k, 50);
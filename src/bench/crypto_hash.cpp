@@ -69,6 +69,32 @@ static void SHA256D64_1024(benchmark::State &state) {
     }
 }
 
+/* Number of messages, and their size (about that of a typical transaction), for the multi-buffer benchmarks */
+static const size_t MULTI_COUNT = 64;
+static const size_t MULTI_SIZE = 250;
+
+static void SHA256D_250b_x64(benchmark::State &state) {
+    std::vector<uint8_t> in(MULTI_SIZE * MULTI_COUNT, 0);
+    std::vector<uint8_t> out(32 * MULTI_COUNT);
+    BENCHMARK_LOOP {
+        for (size_t i = 0; i < MULTI_COUNT; ++i) {
+            CHash256().Write({in.data() + MULTI_SIZE * i, MULTI_SIZE}).Finalize({out.data() + 32 * i, 32});
+        }
+    }
+}
+
+static void SHA256DMulti_250b_x64(benchmark::State &state) {
+    std::vector<uint8_t> in(MULTI_SIZE * MULTI_COUNT, 0);
+    std::vector<uint8_t> out(32 * MULTI_COUNT);
+    std::vector<Span<const uint8_t>> msgs;
+    for (size_t i = 0; i < MULTI_COUNT; ++i) {
+        msgs.emplace_back(in.data() + MULTI_SIZE * i, MULTI_SIZE);
+    }
+    BENCHMARK_LOOP {
+        SHA256DMulti(out.data(), msgs.data(), msgs.size());
+    }
+}
+
 static void SHA512(benchmark::State &state) {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
     std::vector<uint8_t> in(BUFFER_SIZE, 0);
@@ -149,6 +175,8 @@ BENCHMARK(SHA3_256_1M, 250);
 BENCHMARK(SHA256_32b, 4700 * 1000);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(SHA256D64_1024, 7400);
+BENCHMARK(SHA256D_250b_x64, 30 * 1000);
+BENCHMARK(SHA256DMulti_250b_x64, 30 * 1000);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
 
@@ -7,6 +7,7 @@
 #include <coins.h>
 #include <config.h>
 #include <script/interpreter.h>
+#include <script/stackbufferpool.h>
 #include <span.h>
 #include <test/libauth_testing_setup.h>
 #include <tinyformat.h>
@@ -67,9 +68,10 @@ using TxStandard = LibauthTestingSetup::TxStandard;
 using State = benchmark::State;
 using Printer = benchmark::Printer;
 
-void RunBench(State &state, const Test &test, const PackDesc &packDesc, TxStandard testStd, TxStandard useStd);
+void RunBench(State &state, const Test &test, const PackDesc &packDesc, TxStandard testStd, TxStandard useStd,
+              bool coldPool);
 void BenchCompleted(const State &state, Printer &printer, const Test &test, const PackDesc &packDesc,
-                    TxStandard testStd, TxStandard useStd);
+                    TxStandard testStd, TxStandard useStd, bool coldPool);
 
 const auto TxStd2Letter = LibauthTestingSetup::TxStd2Letter;
 
@@ -109,6 +111,7 @@ void registerBenches(const std::string &arg) {
             // Count how many benches total (use by MkName() below to pad with proper number of 0's).
             // Note: We run each *standard* test using "standard" *and* "nonstandard" mode
             //       We run "invalid" and "nonstandard" tests in "nonstandard" mode only.
+            //       Outside of "all" mode, each bench is also run with a cold StackBufferPool (suffix "_coldpool").
             size_t numBenches = 0;
             if (runAll) {
                 for (const auto &testVec : pack->testVectors) {
@@ -119,6 +122,7 @@ void registerBenches(const std::string &arg) {
                     const auto &testVec = pack->testVectors.at(idx);
                     numBenches += GetEvalModesForTestStandardness(testVec.standardness).size() * testVec.benchmarks.size();
                 }
+                numBenches *= 2;
             }
             assert(numBenches > 0u);
             // add baseline first
@@ -138,13 +142,13 @@ void registerBenches(const std::string &arg) {
                     "LibAuth_" + packDesc.name + "_" + MkName(test.ident) + "_baseline", // We must ensure this sorts first!
                     // Runner
                     [&test, txStd, &packDesc](State &state) {
-                        RunBench(state, test, packDesc, txStd, txStd);
+                        RunBench(state, test, packDesc, txStd, txStd, false);
                     },
                     // Number of iterations is based off the txSize
                     GetIters(test.txSize),
                     // Completion
                     [&test, txStd, &packDesc](const State &s, Printer &p) {
-                        BenchCompleted(s, p, test, packDesc, txStd, txStd);
+                        BenchCompleted(s, p, test, packDesc, txStd, txStd, false);
                     },
                     // resuseChain = true for faster evals
                     true
@@ -156,21 +160,22 @@ void registerBenches(const std::string &arg) {
             }
             assert(baselineAdded != nullptr);
             // next add everything but baseline
-            auto AddTest = [&](const Test &test, const TxStandard testStd) {
+            auto AddTest = [&](const Test &test, const TxStandard testStd, const bool coldPool) {
                 for (const auto useStd : GetEvalModesForTestStandardness(testStd)) {
                     benchmark::BenchRunner( // implicitly adds to benchmarks map
                         // Name
                         "LibAuth_" + packDesc.name + "_" + MkName(test.ident)
-                            + strprintf("_%s_%s", TxStd2Letter(testStd), TxStd2Letter(useStd)),
+                            + strprintf("_%s_%s%s", TxStd2Letter(testStd), TxStd2Letter(useStd),
+                                        coldPool ? "_coldpool" : ""),
                         // Runner
-                        [&test, testStd, useStd, &packDesc](State &state) {
-                            RunBench(state, test, packDesc, testStd, useStd);
+                        [&test, testStd, useStd, &packDesc, coldPool](State &state) {
+                            RunBench(state, test, packDesc, testStd, useStd, coldPool);
                         },
                         // Number of iterations is based off the txSize
                         GetIters(test.txSize),
                         // Completion
-                        [&test, testStd, useStd, &packDesc](const State &s, Printer &p) {
-                            BenchCompleted(s, p, test, packDesc, testStd, useStd);
+                        [&test, testStd, useStd, &packDesc, coldPool](const State &s, Printer &p) {
+                            BenchCompleted(s, p, test, packDesc, testStd, useStd, coldPool);
                         },
                         // resuseChain = true for faster evals
                         true
@@ -184,7 +189,7 @@ void registerBenches(const std::string &arg) {
                     const auto testStd = testVec.standardness;
                     for (const auto &test : testVec.vec) {
                         if (&test == baselineAdded) continue;
-                        AddTest(test, testStd);
+                        AddTest(test, testStd, false);
                     }
                 }
             } else {
@@ -194,9 +199,9 @@ void registerBenches(const std::string &arg) {
                     const auto testStd = testVec.standardness;
                     for (const size_t tidx : testVec.benchmarks) {
                         const auto &test = testVec.vec.at(tidx);
-                        if (&test == baselineAdded) continue;
                         assert(test.benchmark);
-                        AddTest(test, testStd);
+                        if (&test != baselineAdded) AddTest(test, testStd, false);
+                        AddTest(test, testStd, true);
                     }
                 }
             }
@@ -208,7 +213,8 @@ void registerBenches(const std::string &arg) {
 std::map<std::string, ScriptError> failures;
 
 // This gets called once for each benchmark evaluation.
-void RunBench(State &state, const Test &test, const PackDesc &packDesc, const TxStandard testStd, const TxStandard useStd) {
+void RunBench(State &state, const Test &test, const PackDesc &packDesc, const TxStandard testStd, const TxStandard useStd,
+              const bool coldPool) {
     // We cache the setup for each evaluation to save cycles in the overall runtime of the benchmark(s)
     struct CacheData {
         CCoinsView coinsDummy;
@@ -267,9 +273,15 @@ void RunBench(State &state, const Test &test, const PackDesc &packDesc, const Tx
 
     bool didFail = failures.find(state.GetName()) != failures.end();
 
+    // With `coldPool`, each input starts out without the stack element buffers pooled by the previous ones
+    StackBufferPool &pool = StackBufferPool::Get();
+
     // Finally, after everything is set up ahead of time, run the benchmark loop
     BENCHMARK_LOOP {
         for (size_t size = txn.vin.size(), inputNum = 0; inputNum < size; ++inputNum) {
+            if (coldPool) {
+                pool.Clear();
+            }
             const ScriptExecutionContext &context = cdata->contexts[inputNum];
             const BaseSignatureChecker &checker = *cdata->txSigCheckers[inputNum];
             const uint32_t scriptFlags = cdata->scriptFlags;
@@ -287,7 +299,7 @@ void RunBench(State &state, const Test &test, const PackDesc &packDesc, const Tx
 // Completion function called once after each LibAuth bench completes all evaluations; pushes supplemental stats to be
 // printed in a table at the end.
 void BenchCompleted(const State &state, Printer &printer, const Test &test, const PackDesc &packDesc,
-                    TxStandard testStd, TxStandard useStd) {
+                    TxStandard testStd, TxStandard useStd, bool coldPool) {
     struct Cost {
         size_t txSize;
         double perIter;
@@ -298,7 +310,7 @@ void BenchCompleted(const State &state, Printer &printer, const Test &test, cons
     const double costPerEval = state.GetTotal() / state.GetResults().size();
     const Cost cost{test.txSize, costPerEval / state.GetNumIters()};
     const Cost *baseline{};
-    if (test.baselineBench) {
+    if (test.baselineBench && !coldPool) {
         baseline = &(packBaselines[packDesc.name] = cost); // save baseline (should be first one seen)
     } else if (auto it = packBaselines.find(packDesc.name); it != packBaselines.end()) {
         baseline = &it->second;
@@ -338,6 +350,7 @@ void BenchCompleted(const State &state, Printer &printer, const Test &test, cons
         {"TestPack", packDesc.name},
         {"OrigStd", strprintf("%s", TxStd2Letter(testStd))},
         {"UsedStd", strprintf("%s", TxStd2Letter(useStd))},
+        {"ColdPool", coldPool ? "1" : "0"},
         {"ErrMsg", strprintf("%s", failStr)},
         {"Description", MkDesc(test.description)},
     }});
@@ -5,8 +5,10 @@
 
 #include <bench/bench.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <txmempool.h>
 
+#include <cassert>
 #include <list>
 #include <vector>
 
@@ -118,4 +120,45 @@ static void MempoolEviction(benchmark::State &state) {
     }
 }
 
+/// Fill a mempool with 500k transactions in unconfirmed chains of four, then trim a tenth of it away
+static void MempoolEviction500k(benchmark::State &state) {
+    constexpr size_t nTx = 500'000;
+    FastRandomContext rng(true /* deterministic */);
+    std::vector<CTransactionRef> txs;
+    std::vector<Amount> fees;
+    txs.reserve(nTx);
+    fees.reserve(nTx);
+    for (size_t i = 0; i < nTx; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = i % 4 == 0 ? COutPoint(TxId(rng.rand256()), 0) : COutPoint(txs.back()->GetId(), 0);
+        tx.vin[0].scriptSig = CScript() << OP_1;
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[0].nValue = 10 * COIN;
+        txs.push_back(MakeTransactionRef(tx));
+        fees.push_back(int64_t(1000 + rng.randrange(10000)) * SATOSHI);
+    }
+
+    // Trimming changes the pool, so every iteration gets a pool of its own,
+    // filled up front.
+    std::list<CTxMemPool> pools;
+    for (uint64_t i = 0; i < state.m_num_iters + 1; ++i) {
+        CTxMemPool &pool = pools.emplace_back();
+        LOCK2(cs_main, pool.cs);
+        for (size_t n = 0; n < nTx; ++n) {
+            AddTx(txs[n], fees[n], pool);
+        }
+    }
+
+    auto it = pools.begin();
+    BENCHMARK_LOOP {
+        assert(it != pools.end());
+        CTxMemPool &pool = *it++;
+        LOCK2(cs_main, pool.cs);
+        pool.TrimToSize(pool.DynamicMemoryUsage() * 9 / 10);
+    }
+}
+
 BENCHMARK(MempoolEviction, 41000);
+BENCHMARK(MempoolEviction500k, 1);
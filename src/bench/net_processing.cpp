@@ -0,0 +1,138 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <config.h>
+#include <hash.h>
+#include <net.h>
+#include <net_processing.h>
+#include <netmessagemaker.h>
+#include <primitives/block.h>
+#include <protocol.h>
+#include <scheduler.h>
+#include <validation.h>
+
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+//! @returns `msg` as it would have come in off the wire, ready to be queued for the message handler
+CNetMessage MakeNetMessage(const Config &config, const CSerializedNetMsg &msg) {
+    const Span<const uint8_t> payload = msg.Payload();
+    const uint256 hash = Hash(payload);
+    CMessageHeader hdr(config.GetChainParams().NetMagic(), msg.m_type.c_str(), payload.size());
+    std::memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    std::vector<uint8_t> header;
+    CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, header, 0, hdr};
+
+    CNetMessage netmsg(config.GetChainParams().NetMagic(), SER_NETWORK, INIT_PROTO_VERSION);
+    int nRead = netmsg.readHeader(config, reinterpret_cast<const char *>(header.data()), header.size());
+    assert(nRead == int(header.size()));
+    if (!payload.empty()) {
+        nRead = netmsg.readData(reinterpret_cast<const char *>(payload.data()), payload.size());
+        assert(nRead == int(payload.size()));
+    }
+    assert(netmsg.complete());
+    return netmsg;
+}
+} // namespace
+
+/// Queue a few messages (pings, which do not need cs_main, and getheaders, which do) for each of `numPeers` fully
+/// connected inbound peers, then have `nThreads` message handler threads drain them through PeerLogicValidation. Like
+/// CConnman::ThreadMessageHandler(), every thread only services the peers whose id maps to it.
+static void benchMessageHandler(benchmark::State &state, size_t numPeers, int nThreads) {
+    const Config &config = GetConfig();
+    std::atomic<bool> interruptDummy(false);
+
+    CScheduler scheduler;
+    CConnman connman(config, 0x1337, 0x1337);
+    CConnman::Options options;
+    options.nReceiveFloodSize = 1000 * DEFAULT_MAXRECEIVEBUFFER;
+    options.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    connman.Init(options);
+    PeerLogicValidation peerLogic(&connman, nullptr, scheduler, false, true);
+
+    std::vector<NodeRef> nodes;
+    nodes.reserve(numPeers);
+    for (size_t i = 0; i < numPeers; ++i) {
+        const CAddress addr(CService(CNetAddr(in_addr{htonl(0x0a000000 | i)}), 8333), NODE_NONE);
+        NodeRef pnode = CNode::Make({}, NodeId(i), NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "",
+                                    /*fInboundIn=*/true);
+        pnode->SetSendVersion(PROTOCOL_VERSION);
+        pnode->SetRecvVersion(PROTOCOL_VERSION);
+        peerLogic.InitializeNode(config, pnode);
+        pnode->nVersion = PROTOCOL_VERSION;
+        pnode->fSuccessfullyConnected = true;
+        nodes.push_back(std::move(pnode));
+    }
+
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    const CBlockLocator locator = WITH_LOCK(cs_main, return ::ChainActive().GetLocator());
+    const std::vector<CNetMessage> messages{
+        MakeNetMessage(config, msgMaker.Make(NetMsgType::PING, uint64_t{1})),
+        MakeNetMessage(config, msgMaker.Make(NetMsgType::GETHEADERS, locator, uint256())),
+        MakeNetMessage(config, msgMaker.Make(NetMsgType::PING, uint64_t{2})),
+        MakeNetMessage(config, msgMaker.Make(NetMsgType::GETHEADERS, locator, uint256())),
+    };
+
+    auto handler = [&](const int nThread) {
+        bool fMoreWork = true;
+        while (fMoreWork) {
+            fMoreWork = false;
+            for (const NodeRef &pnode : nodes) {
+                if (pnode->GetId() % nThreads != nThread) {
+                    continue;
+                }
+                fMoreWork |= peerLogic.ProcessMessages(config, pnode, interruptDummy);
+                LOCK(pnode->cs_sendProcessing);
+                peerLogic.SendMessages(config, pnode, interruptDummy);
+            }
+        }
+    };
+
+    BENCHMARK_LOOP {
+        for (const NodeRef &pnode : nodes) {
+            LOCK(pnode->cs_vProcessMsg);
+            for (const CNetMessage &msg : messages) {
+                pnode->vProcessMsg.push_back(msg);
+                pnode->nProcessQueueSize += msg.vRecv.size() + CMessageHeader::HEADER_SIZE;
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (int i = 1; i < nThreads; ++i) {
+            threads.emplace_back(handler, i);
+        }
+        handler(0);
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        for (const NodeRef &pnode : nodes) {
+            assert(!pnode->fDisconnect);
+            LOCK(pnode->cs_vSend);
+            pnode->vSendMsg.clear();
+            pnode->nSendSize = 0;
+            pnode->fPauseSend = false;
+        }
+    }
+
+    for (const NodeRef &pnode : nodes) {
+        bool dummy;
+        peerLogic.FinalizeNode(config, pnode->GetId(), dummy);
+    }
+}
+
+static void MessageHandler500Peers1Thread(benchmark::State &state) {
+    benchMessageHandler(state, 500, 1);
+}
+static void MessageHandler500Peers4Threads(benchmark::State &state) {
+    benchMessageHandler(state, 500, 4);
+}
+
+BENCHMARK(MessageHandler500Peers1Thread, 50);
+BENCHMARK(MessageHandler500Peers4Threads, 50);
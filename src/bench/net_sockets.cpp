@@ -0,0 +1,145 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat.h>
+#include <config.h>
+#include <hash.h>
+#include <net.h>
+#include <netaddress.h>
+#include <netbase.h>
+#include <protocol.h>
+#include <scheduler.h>
+#include <streams.h>
+#include <util/system.h>
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+//! Drops all received messages, so that only the socket handling is measured
+class DiscardingMessageProcessor final : public NetEventsInterface {
+public:
+    bool ProcessMessages(const Config &, NodeRef pnode, std::atomic<bool> &) override {
+        LOCK(pnode->cs_vProcessMsg);
+        pnode->vProcessMsg.clear();
+        pnode->nProcessQueueSize = 0;
+        pnode->fPauseRecv = false;
+        return false;
+    }
+    bool SendMessages(const Config &, NodeRef, std::atomic<bool> &) override { return false; }
+    void InitializeNode(const Config &, NodeRef) override {}
+    void FinalizeNode(const Config &, NodeId, bool &) override {}
+    bool IsPerPeerRateLimitingTemporarilySuppressed() const override { return true; }
+};
+
+//! @returns a loopback port that nothing listens on, as the listening sockets of CConnman are private
+uint16_t GetFreeLoopbackPort() {
+    SOCKET hSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    assert(hSocket != INVALID_SOCKET);
+    struct sockaddr_in sockaddr{};
+    sockaddr.sin_family = AF_INET;
+    sockaddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(sockaddr);
+    const int rc = bind(hSocket, reinterpret_cast<struct sockaddr *>(&sockaddr), len);
+    assert(rc == 0);
+    getsockname(hSocket, reinterpret_cast<struct sockaddr *>(&sockaddr), &len);
+    CloseSocket(hSocket);
+    return ntohs(sockaddr.sin_port);
+}
+} // namespace
+
+/// Connect `numPeers` loopback peers to a CConnman, then have `activePeers` of them (in turn) send a ping at a time,
+/// and wait until the socket handler received them all. With poll(), each wakeup costs O(numPeers); with epoll it
+/// should only cost O(activePeers).
+static void benchSocketHandler(benchmark::State &state, bool useEpoll, size_t numPeers, size_t activePeers) {
+    const Config &config = GetConfig();
+    RaiseFileDescriptorLimit(2 * numPeers + 100);
+
+    const CService service(CNetAddr(in_addr{htonl(INADDR_LOOPBACK)}), GetFreeLoopbackPort());
+    DiscardingMessageProcessor msgproc;
+    CScheduler scheduler;
+    auto connman = std::make_unique<CConnman>(config, 0x1337, 0x1337);
+    CConnman::Options options;
+    options.nMaxConnections = numPeers + 1;
+    options.m_msgproc = &msgproc;
+    // Lets Interrupt() wake the -addnode thread
+    options.nMaxAddnode = 1;
+    options.nReceiveFloodSize = 1000 * DEFAULT_MAXRECEIVEBUFFER;
+    options.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    // The peers never complete a handshake
+    options.m_peer_connect_timeout = 60 * 60;
+    options.vBinds.push_back(service);
+    options.m_use_addrman_outgoing = false;
+    options.m_use_epoll = useEpoll;
+    gArgs.ForceSetArg("-dnsseed", "0");
+    const bool started = connman->Start(scheduler, options);
+    gArgs.ClearArg("-dnsseed");
+    assert(started);
+
+    std::vector<SOCKET> peers;
+    peers.reserve(numPeers);
+    for (size_t i = 0; i < numPeers; ++i) {
+        SOCKET hSocket = CreateSocket(service);
+        assert(hSocket != INVALID_SOCKET);
+        const bool connected = ConnectSocketDirectly(service, hSocket, DEFAULT_CONNECT_TIMEOUT, false);
+        assert(connected);
+        peers.push_back(hSocket);
+        // Don't overrun the listen backlog
+        while (connman->GetNodeCount(CConnman::CONNECTIONS_IN) + 64 <= peers.size()) {
+            std::this_thread::yield();
+        }
+    }
+    while (connman->GetNodeCount(CConnman::CONNECTIONS_IN) < numPeers) {
+        std::this_thread::yield();
+    }
+
+    const std::vector<uint8_t> payload(8, 0x42);
+    const uint256 hash = Hash(payload);
+    CMessageHeader hdr(config.GetChainParams().NetMagic(), NetMsgType::PING, payload.size());
+    std::memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    std::vector<uint8_t> message;
+    CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, message, 0, hdr};
+    message.insert(message.end(), payload.begin(), payload.end());
+
+    size_t next = 0;
+    BENCHMARK_LOOP {
+        const uint64_t target = connman->GetTotalBytesRecv() + activePeers * message.size();
+        for (size_t i = 0; i < activePeers; ++i) {
+            const auto nBytes = send(peers[next], reinterpret_cast<const char *>(message.data()), message.size(), 0);
+            assert(nBytes == decltype(nBytes)(message.size()));
+            next = (next + 1) % peers.size();
+        }
+        while (connman->GetTotalBytesRecv() < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    connman->Interrupt();
+    connman->Stop();
+    for (SOCKET &hSocket : peers) {
+        CloseSocket(hSocket);
+    }
+}
+
+static void SocketHandlerPoll1000Peers(benchmark::State &state) {
+    benchSocketHandler(state, false, 1000, 10);
+}
+static void SocketHandlerEpoll1000Peers(benchmark::State &state) {
+    benchSocketHandler(state, true, 1000, 10);
+}
+static void SocketHandlerPoll1000PeersAllActive(benchmark::State &state) {
+    benchSocketHandler(state, false, 1000, 1000);
+}
+static void SocketHandlerEpoll1000PeersAllActive(benchmark::State &state) {
+    benchSocketHandler(state, true, 1000, 1000);
+}
+
+BENCHMARK(SocketHandlerPoll1000Peers, 100);
+BENCHMARK(SocketHandlerEpoll1000Peers, 100);
+BENCHMARK(SocketHandlerPoll1000PeersAllActive, 5);
+BENCHMARK(SocketHandlerEpoll1000PeersAllActive, 5);
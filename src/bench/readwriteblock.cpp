@@ -17,6 +17,8 @@
 #include <serialize.h>
 #include <streams.h>
 #include <sync.h>
+#include <util/defer.h>
+#include <util/mappedfile.h>
 
 #include <cassert>
 
@@ -36,7 +38,10 @@ static void WriteBlockBench(benchmark::State &state) {
     }
 }
 
-static void ReadBlockBench(benchmark::State &state) {
+static void ReadBlock(benchmark::State &state, bool mmap) {
+    const bool origMmapBlockReads = fMmapBlockReads;
+    fMmapBlockReads = mmap;
+    Defer d([&]{ fMmapBlockReads = origMmapBlockReads; });
     // Setup: ensure we have the block on disk
     const FlatFilePos pos = WITH_LOCK(cs_main, return SaveBlockToDisk(GetTestBlock(), 413'567, ::Params(), nullptr));
     assert(!pos.IsNull());
@@ -47,7 +52,13 @@ static void ReadBlockBench(benchmark::State &state) {
     }
 }
 
-static void ReadRawBlockBench(benchmark::State &state) {
+static void ReadBlockBench(benchmark::State &state) { ReadBlock(state, false); }
+static void ReadBlockMmapBench(benchmark::State &state) { ReadBlock(state, true); }
+
+static void ReadRawBlock(benchmark::State &state, bool mmap) {
+    const bool origMmapBlockReads = fMmapBlockReads;
+    fMmapBlockReads = mmap;
+    Defer d([&]{ fMmapBlockReads = origMmapBlockReads; });
     // Setup 1: ensure we have the block on disk
     const CBlock block = GetTestBlock();
     const FlatFilePos pos = WITH_LOCK(cs_main, return SaveBlockToDisk(block, 413'567, ::Params(), nullptr));
@@ -61,13 +72,26 @@ static void ReadRawBlockBench(benchmark::State &state) {
     fakeIndex.nDataPos = pos.nPos;
     fakeIndex.nStatus = BlockStatus{}.withData(true);
     BENCHMARK_LOOP {
-        std::vector<uint8_t> rawBlock;
-        const bool success = ReadRawBlockFromDisk(rawBlock, &fakeIndex, ::Params(), SER_DISK, CLIENT_VERSION);
-        assert(success);
-        assert(!rawBlock.empty());
+        if (mmap) {
+            // The zero-copy path, as used for serving blocks to peers
+            SharedByteSpan rawBlock;
+            const bool success = ReadRawBlockFromDisk(rawBlock, &fakeIndex, ::Params(), SER_DISK, CLIENT_VERSION);
+            assert(success);
+            assert(!rawBlock.empty());
+        } else {
+            std::vector<uint8_t> rawBlock;
+            const bool success = ReadRawBlockFromDisk(rawBlock, &fakeIndex, ::Params(), SER_DISK, CLIENT_VERSION);
+            assert(success);
+            assert(!rawBlock.empty());
+        }
     }
 }
 
+static void ReadRawBlockBench(benchmark::State &state) { ReadRawBlock(state, false); }
+static void ReadRawBlockMmapBench(benchmark::State &state) { ReadRawBlock(state, true); }
+
 BENCHMARK(WriteBlockBench, 50);
 BENCHMARK(ReadBlockBench, 50);
+BENCHMARK(ReadBlockMmapBench, 50);
 BENCHMARK(ReadRawBlockBench, 50);
+BENCHMARK(ReadRawBlockMmapBench, 50);
@@ -12,11 +12,13 @@
 #include <script/standard.h>
 #include <test/setup_common.h>
 #include <test/util.h>
+#include <tinyformat.h>
 #include <txmempool.h>
 #include <util/defer.h>
 #include <util/system.h>
 #include <validation.h>
 
+#include <any>
 #include <cassert>
 #include <list>
 #include <utility>
@@ -148,6 +150,21 @@ static void benchRemoveForBlock(const Config& config, benchmark::State& state,
         assert(pool.size() == g_mempool.size());
     }
 
+    {
+        const auto &pool = pools.front();
+        state.anyData = pool.DynamicMemoryUsage() / double(pool.size());
+    }
+    if (!state.completionFunction) {
+        state.completionFunction = [](const benchmark::State &st, benchmark::Printer &p) {
+            const double bytesPerTx = std::any_cast<double>(st.anyData);
+            benchmark::Printer::ExtraData data = {{
+                {"Name", st.GetName()},
+                {"MempoolBytesPerTx", strprintf("%1.1f", bytesPerTx)},
+            }};
+            p.appendExtraDataForCategory("removeforblock (memory)", std::move(data));
+        };
+    }
+
     auto it = pools.begin();
 
     BENCHMARK_LOOP {
@@ -157,30 +174,30 @@ static void benchRemoveForBlock(const Config& config, benchmark::State& state,
     }
 }
 
-/// Fill a mempool with 450k txs, then repeatedly test removeForBlock with a 32MB block of ~170k small-sized txs
+/// Fill a mempool with 500k txs, then repeatedly test removeForBlock with a 32MB block of ~170k small-sized txs
 static void RemoveForBlock32MB(benchmark::State& state) {
     const Config& config = GetConfig();
-    benchRemoveForBlock(config, state, 450'000, 32, false);
+    benchRemoveForBlock(config, state, 500'000, 32, false);
 }
 
-/// Fill a mempool with 450k txs, then repeatedly test removeForBlock with an 8MB block of ~43k small-sized txs
+/// Fill a mempool with 500k txs, then repeatedly test removeForBlock with an 8MB block of ~43k small-sized txs
 static void RemoveForBlock8MB(benchmark::State& state) {
     const Config& config = GetConfig();
-    benchRemoveForBlock(config, state, 450'000, 8, false);
+    benchRemoveForBlock(config, state, 500'000, 8, false);
 }
 
-/// Fill a mempool with ~450k txs, then repeatedly test removeForBlock with a 32MB block of ~93k mixed-sized txs,
+/// Fill a mempool with ~500k txs, then repeatedly test removeForBlock with a 32MB block of ~93k mixed-sized txs,
 /// leaving some unconfirmed chains in mempool too so that the parentSet for some txs is larger
 static void RemoveForBlock32MB_UnconfChains(benchmark::State& state) {
     const Config& config = GetConfig();
-    benchRemoveForBlock(config, state, 450'000, 32, true);
+    benchRemoveForBlock(config, state, 500'000, 32, true);
 }
 
-/// Fill a mempool with 450k txs, then repeatedly test removeForBlock with an 8MB block of ~8k mixed-sized txs,
+/// Fill a mempool with 500k txs, then repeatedly test removeForBlock with an 8MB block of ~8k mixed-sized txs,
 /// leaving some unconfirmed chains in mempool too so that the parentSet for some txs is larger
 static void RemoveForBlock8MB_UnconfChains(benchmark::State& state) {
     const Config& config = GetConfig();
-    benchRemoveForBlock(config, state, 450'000, 8, true);
+    benchRemoveForBlock(config, state, 500'000, 8, true);
 }
 
 BENCHMARK(RemoveForBlock32MB, 1);
@@ -0,0 +1,71 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <coins.h>
+#include <random.h>
+#include <rpc/blockchain.h>
+#include <script/script.h>
+#include <txdb.h>
+
+#include <atomic>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <vector>
+
+/// Scan an in-memory coins database of 100k P2PKH coins for 10k scripts, 100 of which are found, in `nShards` shards
+/// on `nThreads` threads.
+static void benchScanTxOutSet(benchmark::State &state, size_t nShards, size_t nThreads) {
+    constexpr size_t nCoins = 100'000, nNeedles = 10'000, nFound = 100;
+    FastRandomContext rng(true);
+    auto P2PKH = [&] {
+        return CScript() << OP_DUP << OP_HASH160 << rng.randbytes(20) << OP_EQUALVERIFY << OP_CHECKSIG;
+    };
+
+    CCoinsViewDB db(1 << 23, true, true);
+    ScanTxOutNeedles needles;
+    {
+        CCoinsViewCache cache(&db);
+        for (size_t i = 0; i < nCoins; ++i) {
+            const CTxOut txout(int64_t(1 + rng.randrange(100'000)) * SATOSHI, P2PKH());
+            if (i % (nCoins / nFound) == 0) {
+                needles.scriptPubKeys.insert(txout.scriptPubKey);
+            }
+            cache.AddCoin(COutPoint(TxId(rng.rand256()), 0), Coin(txout, 1, false), false);
+        }
+        cache.SetBestBlock(BlockHash(rng.rand256()));
+        const bool flushed = cache.Flush();
+        assert(flushed);
+    }
+    while (needles.scriptPubKeys.size() < nNeedles) {
+        needles.scriptPubKeys.insert(P2PKH());
+    }
+
+    std::atomic<int> progress;
+    const std::atomic<bool> shouldAbort{false};
+    BENCHMARK_LOOP {
+        std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+        if (nShards > 1) {
+            cursors = db.CursorShards(nShards);
+        } else {
+            cursors.emplace_back(db.Cursor());
+        }
+        int64_t count = 0;
+        std::map<COutPoint, Coin> results;
+        const bool success = FindScriptPubKeysAndTokens(progress, shouldAbort, count, cursors, needles, results, {},
+                                                        nThreads);
+        assert(success && results.size() == nFound);
+    }
+}
+
+static void ScanTxOutSet10kNeedles(benchmark::State &state) {
+    benchScanTxOutSet(state, 1, 1);
+}
+static void ScanTxOutSet10kNeedles4Threads(benchmark::State &state) {
+    benchScanTxOutSet(state, 32, 4);
+}
+
+BENCHMARK(ScanTxOutSet10kNeedles, 5);
+BENCHMARK(ScanTxOutSet10kNeedles4Threads, 5);
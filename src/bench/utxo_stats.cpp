@@ -0,0 +1,72 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <coins.h>
+#include <coinstats.h>
+#include <random.h>
+#include <script/script.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+/// Fill an in-memory coins database with `nTxs` transactions of 2 outputs each, then compute the statistics and the
+/// ECMH or MuHash commitment of the whole set on `nThreads` threads.
+static void benchComputeUTXOStats(benchmark::State &state, CoinStatsHashType hashType, size_t nThreads) {
+    constexpr size_t nTxs = 50'000;
+    FastRandomContext rng(true);
+    CCoinsViewDB db(1 << 23, true, true);
+    {
+        CCoinsViewCache cache(&db);
+        for (size_t i = 0; i < nTxs; ++i) {
+            const TxId txid(rng.rand256());
+            for (uint32_t n = 0; n < 2; ++n) {
+                cache.AddCoin(COutPoint(txid, n),
+                              Coin(CTxOut(int64_t(1 + rng.randrange(100'000)) * SATOSHI,
+                                          CScript() << OP_DUP << OP_HASH160 << rng.randbytes(20) << OP_EQUALVERIFY
+                                                    << OP_CHECKSIG),
+                                   1, false),
+                              false);
+            }
+        }
+        cache.SetBestBlock(WITH_LOCK(cs_main, return ::ChainActive().Genesis()->GetBlockHash()));
+        const bool flushed = cache.Flush();
+        assert(flushed);
+    }
+
+    BENCHMARK_LOOP {
+        const auto stats = ComputeUTXOStats(&db, hashType, {}, nThreads);
+        assert(stats && stats->nTransactionOutputs == 2 * nTxs);
+    }
+}
+
+static void ComputeUTXOStatsECMH1Thread(benchmark::State &state) {
+    benchComputeUTXOStats(state, CoinStatsHashType::ECMH, 1);
+}
+static void ComputeUTXOStatsECMH2Threads(benchmark::State &state) {
+    benchComputeUTXOStats(state, CoinStatsHashType::ECMH, 2);
+}
+static void ComputeUTXOStatsECMH4Threads(benchmark::State &state) {
+    benchComputeUTXOStats(state, CoinStatsHashType::ECMH, 4);
+}
+static void ComputeUTXOStatsECMH8Threads(benchmark::State &state) {
+    benchComputeUTXOStats(state, CoinStatsHashType::ECMH, 8);
+}
+static void ComputeUTXOStatsMuHash1Thread(benchmark::State &state) {
+    benchComputeUTXOStats(state, CoinStatsHashType::MUHASH_TESTING, 1);
+}
+static void ComputeUTXOStatsMuHash4Threads(benchmark::State &state) {
+    benchComputeUTXOStats(state, CoinStatsHashType::MUHASH_TESTING, 4);
+}
+
+BENCHMARK(ComputeUTXOStatsECMH1Thread, 1);
+BENCHMARK(ComputeUTXOStatsECMH2Threads, 1);
+BENCHMARK(ComputeUTXOStatsECMH4Threads, 1);
+BENCHMARK(ComputeUTXOStatsECMH8Threads, 1);
+BENCHMARK(ComputeUTXOStatsMuHash1Thread, 1);
+BENCHMARK(ComputeUTXOStatsMuHash4Threads, 1);
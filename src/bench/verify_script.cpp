@@ -9,6 +9,7 @@
 #include <coins.h>
 #include <key.h>
 #include <policy/policy.h>
+#include <random.h>
 #if defined(HAVE_CONSENSUS_LIB)
 #include <script/bitcoinconsensus.h>
 #endif
@@ -16,11 +17,14 @@
 #include <script/script.h>
 #include <script/script_error.h>
 #include <script/script_execution_context.h>
+#include <script/sighashtype.h>
+#include <script/stackbufferpool.h>
 #include <script/standard.h>
 #include <streams.h>
 #include <tinyformat.h>
 #include <util/defer.h>
 #include <util/time.h>
+#include <validation.h>
 #include <version.h>
 
 #include <stdexcept>
@@ -46,6 +50,15 @@ static void VerifyNestedIfScript(benchmark::State &state) {
     }
 }
 
+struct FakeSignaureChecker final : ContextOptSignatureChecker {
+    bool VerifySignature(const ByteView &, const CPubKey &, const uint256 &) const override { return true; }
+    bool CheckSig(const ByteView &, const std::vector<uint8_t> &, const ByteView &, uint32_t,
+                  size_t *) const override { return true; }
+    bool CheckLockTime(const CScriptNum &) const override { return true; }
+    bool CheckSequence(const CScriptNum &) const override { return true; }
+    using ContextOptSignatureChecker::ContextOptSignatureChecker;
+};
+
 static void VerifyBlockScripts(bool reallyCheckSigs,
                                const uint32_t flags,
                                const std::vector<uint8_t> &blockdata, const std::vector<uint8_t> &coinsdata,
@@ -97,15 +110,6 @@ static void VerifyBlockScripts(bool reallyCheckSigs,
         }
     }
 
-    struct FakeSignaureChecker final : ContextOptSignatureChecker {
-        bool VerifySignature(const ByteView &, const CPubKey &, const uint256 &) const override { return true; }
-        bool CheckSig(const ByteView &, const std::vector<uint8_t> &, const ByteView &, uint32_t,
-                      size_t *) const override { return true; }
-        bool CheckLockTime(const CScriptNum &) const override { return true; }
-        bool CheckSequence(const CScriptNum &) const override { return true; }
-        using ContextOptSignatureChecker::ContextOptSignatureChecker;
-    };
-
     BENCHMARK_LOOP {
         size_t okct = 0;
         size_t txdataVecIdx = 0, coinsVecIdx = 0;
@@ -167,6 +171,219 @@ static void VerifyScripts_SigsChecks_Block556034(benchmark::State &state) {
     VerifyBlockScripts(true, flags_556034, benchmark::data::Get_block556034(), benchmark::data::Get_coins_spent_556034(), state);
 }
 
+// Verify the inputs of a block full of P2PKH spends signed with Schnorr signatures, in chunks of the size that
+// CCheckQueue takes at once, either one check at a time or with CScriptCheck::RunBatch()
+static void VerifySchnorrChecks(bool batch, benchmark::State &state) {
+    constexpr size_t N_TXS = 500, N_INPUTS_PER_TX = 2, CHUNK_SIZE = 128;
+    constexpr uint32_t flags = STANDARD_SCRIPT_VERIFY_FLAGS;
+
+    CKey key;
+    key.MakeNewKey(true);
+    const CPubKey pubkey = key.GetPubKey();
+    const CScript scriptPubKey = GetScriptForDestination(pubkey.GetID());
+    const SigHashType sigHashType = SigHashType().withFork();
+
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins(&coinsDummy);
+    std::vector<CTransactionRef> txs;
+    for (size_t i = 0; i < N_TXS; ++i) {
+        CMutableTransaction mtx;
+        for (size_t j = 0; j < N_INPUTS_PER_TX; ++j) {
+            const COutPoint outpoint(TxId(GetRandHash()), j);
+            mtx.vin.emplace_back(outpoint);
+            coins.AddCoin(outpoint, Coin(CTxOut(COIN, scriptPubKey), 1, false), false);
+        }
+        mtx.vout.emplace_back(int64_t(N_INPUTS_PER_TX) * COIN, scriptPubKey);
+        const auto contexts = ScriptExecutionContext::createForAllInputs(mtx, coins);
+        for (size_t j = 0; j < N_INPUTS_PER_TX; ++j) {
+            const uint256 sighash = SignatureHash(scriptPubKey, contexts[j], sigHashType, nullptr, flags).signatureHash;
+            std::vector<uint8_t> sig;
+            if (!key.SignSchnorr(sighash, sig)) {
+                throw std::runtime_error("Failed to sign");
+            }
+            sig.push_back(uint8_t(sigHashType.getRawSigHashType()));
+            mtx.vin[j].scriptSig = CScript() << sig << ToByteVector(pubkey);
+        }
+        txs.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+
+    std::vector<std::vector<CScriptCheck>> chunks(1);
+    for (const auto &tx : txs) {
+        const auto contexts = ScriptExecutionContext::createForAllInputs(*tx, coins);
+        const PrecomputedTransactionData txdata(contexts.at(0));
+        for (const auto &context : contexts) {
+            if (chunks.back().size() == CHUNK_SIZE) {
+                chunks.emplace_back();
+            }
+            chunks.back().emplace_back(context, flags, false, txdata);
+        }
+    }
+
+    BENCHMARK_LOOP {
+        for (auto &chunk : chunks) {
+            bool ok = true;
+            if (batch) {
+                ok = CScriptCheck::RunBatch(chunk);
+            } else {
+                for (auto &check : chunk) {
+                    ok = ok && check();
+                }
+            }
+            if (!ok) {
+                throw std::runtime_error("Schnorr signature check failed");
+            }
+        }
+    }
+}
+
+// 1000 Schnorr signatures verified one by one, like CCheckQueue did before batch verification
+static void VerifyScripts_Schnorr_OneByOne(benchmark::State &state) {
+    VerifySchnorrChecks(false, state);
+}
+
+// 1000 Schnorr signatures verified in batches of up to 128
+static void VerifyScripts_Schnorr_Batch(benchmark::State &state) {
+    VerifySchnorrChecks(true, state);
+}
+
+// Per-input cost of the script VM for a P2PKH spend (signature checking is skipped), either using the specialized
+// code VerifyScript() has for this template or using the generic interpreter
+static void VerifyP2PKHInput(bool generic, benchmark::State &state) {
+    constexpr uint32_t flags = STANDARD_SCRIPT_VERIFY_FLAGS;
+
+    CKey key;
+    key.MakeNewKey(true);
+    const CPubKey pubkey = key.GetPubKey();
+    const CScript scriptPubKey = GetScriptForDestination(pubkey.GetID());
+    const SigHashType sigHashType = SigHashType().withFork();
+
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins(&coinsDummy);
+    CMutableTransaction mtx;
+    const COutPoint outpoint(TxId(GetRandHash()), 0);
+    mtx.vin.emplace_back(outpoint);
+    coins.AddCoin(outpoint, Coin(CTxOut(COIN, scriptPubKey), 1, false), false);
+    mtx.vout.emplace_back(COIN, scriptPubKey);
+    const auto contexts = ScriptExecutionContext::createForAllInputs(mtx, coins);
+    const uint256 sighash = SignatureHash(scriptPubKey, contexts[0], sigHashType, nullptr, flags).signatureHash;
+    std::vector<uint8_t> sig;
+    if (!key.SignSchnorr(sighash, sig)) {
+        throw std::runtime_error("Failed to sign");
+    }
+    sig.push_back(uint8_t(sigHashType.getRawSigHashType()));
+    const CScript scriptSig = CScript() << sig << ToByteVector(pubkey);
+
+    const FakeSignaureChecker checker(contexts[0]);
+    BENCHMARK_LOOP {
+        ScriptExecutionMetrics metrics;
+        ScriptError serror;
+        const bool ok = generic ? VerifyScriptGeneric(scriptSig, scriptPubKey, flags, checker, metrics, &serror)
+                                : VerifyScript(scriptSig, scriptPubKey, flags, checker, metrics, &serror);
+        if (!ok) {
+            throw std::runtime_error(strprintf("Not ok: %s", ScriptErrorString(serror)));
+        }
+    }
+}
+
+static void VerifyScripts_P2PKH(benchmark::State &state) {
+    VerifyP2PKHInput(false, state);
+}
+
+static void VerifyScripts_P2PKH_Generic(benchmark::State &state) {
+    VerifyP2PKHInput(true, state);
+}
+
+// Per-input cost of the script VM for a 2-of-3 P2SH multisig spend (signature checking is skipped), either using the
+// specialized code VerifyScript() has for this template or using the generic interpreter
+static void VerifyP2SHMultisigInput(bool generic, benchmark::State &state) {
+    constexpr uint32_t flags = STANDARD_SCRIPT_VERIFY_FLAGS;
+
+    std::vector<CKey> keys(3);
+    std::vector<CPubKey> pubkeys;
+    for (auto &key : keys) {
+        key.MakeNewKey(true);
+        pubkeys.push_back(key.GetPubKey());
+    }
+    const CScript redeemScript = GetScriptForMultisig(2, pubkeys);
+    const CScript scriptPubKey = GetScriptForDestination(ScriptID(redeemScript, false /* p2sh_20 */));
+    const SigHashType sigHashType = SigHashType().withFork();
+
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins(&coinsDummy);
+    CMutableTransaction mtx;
+    const COutPoint outpoint(TxId(GetRandHash()), 0);
+    mtx.vin.emplace_back(outpoint);
+    coins.AddCoin(outpoint, Coin(CTxOut(COIN, scriptPubKey), 1, false), false);
+    mtx.vout.emplace_back(COIN, scriptPubKey);
+    const auto contexts = ScriptExecutionContext::createForAllInputs(mtx, coins);
+    const uint256 sighash = SignatureHash(redeemScript, contexts[0], sigHashType, nullptr, flags).signatureHash;
+    CScript scriptSig = CScript() << OP_0;
+    for (size_t i = 0; i < 2; ++i) {
+        std::vector<uint8_t> sig;
+        if (!keys[i].SignECDSA(sighash, sig)) {
+            throw std::runtime_error("Failed to sign");
+        }
+        sig.push_back(uint8_t(sigHashType.getRawSigHashType()));
+        scriptSig << sig;
+    }
+    scriptSig << ToByteVector(redeemScript);
+
+    const FakeSignaureChecker checker(contexts[0]);
+    BENCHMARK_LOOP {
+        ScriptExecutionMetrics metrics;
+        ScriptError serror;
+        const bool ok = generic ? VerifyScriptGeneric(scriptSig, scriptPubKey, flags, checker, metrics, &serror)
+                                : VerifyScript(scriptSig, scriptPubKey, flags, checker, metrics, &serror);
+        if (!ok) {
+            throw std::runtime_error(strprintf("Not ok: %s", ScriptErrorString(serror)));
+        }
+    }
+}
+
+static void VerifyScripts_P2SHMultisig(benchmark::State &state) {
+    VerifyP2SHMultisigInput(false, state);
+}
+
+static void VerifyScripts_P2SHMultisig_Generic(benchmark::State &state) {
+    VerifyP2SHMultisigInput(true, state);
+}
+
+// A batch of inputs whose scripts copy, compute and drop stack elements, as a script verification thread evaluates
+// them: either reusing the stack element buffers pooled by the previous inputs, or starting each input with an empty
+// pool (the interpreter then only reuses buffers within the input)
+static void VerifyStackOpsInputs(bool coldPool, benchmark::State &state) {
+    constexpr uint32_t flags = STANDARD_SCRIPT_VERIFY_FLAGS;
+    constexpr size_t nInputs = 100;
+
+    const CScript scriptSig = CScript() << OP_1;
+    CScript scriptPubKey;
+    for (int i = 0; i < 40; ++i) {
+        scriptPubKey << OP_DUP << OP_1ADD << OP_SWAP << OP_DROP;
+    }
+
+    const BaseSignatureChecker checker;
+    StackBufferPool &pool = StackBufferPool::Get();
+    BENCHMARK_LOOP {
+        for (size_t n = 0; n < nInputs; ++n) {
+            if (coldPool) {
+                pool.Clear();
+            }
+            ScriptError serror;
+            if (!VerifyScript(scriptSig, scriptPubKey, flags, checker, &serror)) {
+                throw std::runtime_error(strprintf("Not ok: %s", ScriptErrorString(serror)));
+            }
+        }
+    }
+}
+
+static void VerifyScripts_StackOps(benchmark::State &state) {
+    VerifyStackOpsInputs(false, state);
+}
+
+static void VerifyScripts_StackOps_ColdPool(benchmark::State &state) {
+    VerifyStackOpsInputs(true, state);
+}
+
 static void VerifyLoopScript(benchmark::State &state, int which, bool tightLoop) {
     constexpr uint32_t flags = STANDARD_SCRIPT_VERIFY_FLAGS | SCRIPT_64_BIT_INTEGERS | SCRIPT_NATIVE_INTROSPECTION
                                | SCRIPT_ENABLE_P2SH_32 | SCRIPT_ENABLE_TOKENS | SCRIPT_ENABLE_MAY2025
@@ -264,6 +481,28 @@ static void VerifyLoopScript(benchmark::State &state, int which, bool tightLoop)
                    << OP_0 << OP_UNTIL;
             break;
         }
+        case 9: {
+            // BigInt arithmetic mix on numbers that stay well within 64 bits: x = (x * 7 + 3) % 1000003
+            const auto modulus = ScriptBigInt::fromIntUnchecked(1000003_bi);
+            script << OP_1 << OP_BEGIN;
+            while (script.size() < finalScriptSize - 2) {
+                script << OP_7 << OP_MUL << OP_3 << OP_ADD << modulus << OP_MOD;
+                if (tightLoop) break; // use a tiny loop body with tightLoop -> rest of input will be padded with OP_NOP
+            }
+            script << OP_0 << OP_UNTIL;
+            break;
+        }
+        case 10: {
+            // BigInt arithmetic on numbers that go back and forth across 64 bits: x = x * 2^40 / 2^40 + 1
+            const auto bigNum = ScriptBigInt::fromIntUnchecked(BigInt(1) << 40u);
+            script << ScriptBigInt::fromIntUnchecked(9223372036854775000_bi) << OP_BEGIN;
+            while (script.size() < finalScriptSize - 2) {
+                script << bigNum << OP_MUL << bigNum << OP_DIV << OP_1ADD;
+                if (tightLoop) break; // use a tiny loop body with tightLoop -> rest of input will be padded with OP_NOP
+            }
+            script << OP_0 << OP_UNTIL;
+            break;
+        }
         default:
             assert(!"Unknown case in switch");
             break;
@@ -349,6 +588,8 @@ static void VerifyBigLoop_1ADD(benchmark::State &state) { VerifyLoopScript(state
 static void VerifyBigLoop_Mul_2(benchmark::State &state) { VerifyLoopScript(state, 3, false); }
 static void VerifyBigLoop_BigInt_Add(benchmark::State &state) { VerifyLoopScript(state, 4, false); }
 static void VerifyBigLoop_BigInt_1ADD(benchmark::State &state) { VerifyLoopScript(state, 5, false); }
+static void VerifyBigLoop_BigInt_MulAddMod(benchmark::State &state) { VerifyLoopScript(state, 9, false); }
+static void VerifyBigLoop_BigInt_MulDiv(benchmark::State &state) { VerifyLoopScript(state, 10, false); }
 static void VerifyBigLoop_Invoke_Spam(benchmark::State &state) { VerifyLoopScript(state, 6, false); }
 static void VerifyBigLoop_Invoke_1ADD(benchmark::State &state) { VerifyLoopScript(state, 7, false); }
 
@@ -358,6 +599,8 @@ static void VerifyTightLoop_1ADD(benchmark::State &state) { VerifyLoopScript(sta
 static void VerifyTightLoop_Mul_2(benchmark::State &state) { VerifyLoopScript(state, 3, true); }
 static void VerifyTightLoop_BigInt_Add(benchmark::State &state) { VerifyLoopScript(state, 4, true); }
 static void VerifyTightLoop_BigInt_1ADD(benchmark::State &state) { VerifyLoopScript(state, 5, true); }
+static void VerifyTightLoop_BigInt_MulAddMod(benchmark::State &state) { VerifyLoopScript(state, 9, true); }
+static void VerifyTightLoop_BigInt_MulDiv(benchmark::State &state) { VerifyLoopScript(state, 10, true); }
 static void VerifyTightLoop_Invoke_Spam(benchmark::State &state) { VerifyLoopScript(state, 6, true); }
 static void VerifyTightLoop_Invoke_1ADD(benchmark::State &state) { VerifyLoopScript(state, 7, true); }
 static void VerifyTightLoop_Invoke_BigFunc(benchmark::State &state) { VerifyLoopScript(state, 8, false); }
@@ -368,6 +611,8 @@ BENCHMARK(VerifyBigLoop_1ADD, 100);
 BENCHMARK(VerifyBigLoop_Mul_2, 100);
 BENCHMARK(VerifyBigLoop_BigInt_Add, 100);
 BENCHMARK(VerifyBigLoop_BigInt_1ADD, 100);
+BENCHMARK(VerifyBigLoop_BigInt_MulAddMod, 100);
+BENCHMARK(VerifyBigLoop_BigInt_MulDiv, 100);
 BENCHMARK(VerifyBigLoop_Invoke_Spam, 100);
 BENCHMARK(VerifyBigLoop_Invoke_1ADD, 100)
 
@@ -377,6 +622,8 @@ BENCHMARK(VerifyTightLoop_1ADD, 100);
 BENCHMARK(VerifyTightLoop_Mul_2, 100);
 BENCHMARK(VerifyTightLoop_BigInt_Add, 100);
 BENCHMARK(VerifyTightLoop_BigInt_1ADD, 100);
+BENCHMARK(VerifyTightLoop_BigInt_MulAddMod, 100);
+BENCHMARK(VerifyTightLoop_BigInt_MulDiv, 100);
 BENCHMARK(VerifyTightLoop_Invoke_Spam, 100);
 BENCHMARK(VerifyTightLoop_Invoke_1ADD, 100);
 BENCHMARK(VerifyTightLoop_Invoke_BigFunc, 100);
@@ -395,3 +642,19 @@ BENCHMARK(VerifyScripts_Block556034, 3);
 // measuring the script interpreter's own efficiency.
 BENCHMARK(VerifyScripts_SigsChecks_Block413567, 2);
 BENCHMARK(VerifyScripts_SigsChecks_Block556034, 1);
+
+// Schnorr signature checks in CScriptCheck, one by one versus batch verified
+BENCHMARK(VerifyScripts_Schnorr_OneByOne, 3);
+BENCHMARK(VerifyScripts_Schnorr_Batch, 3);
+
+// A single P2PKH input (without real sigchecks), via the P2PKH fast path versus the generic interpreter
+BENCHMARK(VerifyScripts_P2PKH, 100'000);
+BENCHMARK(VerifyScripts_P2PKH_Generic, 100'000);
+
+// A 2-of-3 P2SH multisig input (without real sigchecks), via the P2SH multisig fast path versus the generic interpreter
+BENCHMARK(VerifyScripts_P2SHMultisig, 100'000);
+BENCHMARK(VerifyScripts_P2SHMultisig_Generic, 100'000);
+
+// Inputs evaluated with the stack element buffers pooled by the previous inputs versus with an empty pool
+BENCHMARK(VerifyScripts_StackOps, 1'000);
+BENCHMARK(VerifyScripts_StackOps_ColdPool, 1'000);
@@ -0,0 +1,108 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <test/setup_common.h>
+#include <util/strencodings.h>
+#include <util/system.h>
+#include <validationinterface.h>
+#include <zmq/zmqnotificationinterface.h>
+
+#include <zmq.h>
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! Receive one multipart message. @returns the number of transactions in it.
+static size_t ReceiveTransactions(void *socket) {
+    size_t parts = 0;
+    int more = 0;
+    size_t moreSize = sizeof(more);
+    do {
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        const int rc = zmq_msg_recv(&msg, socket, 0);
+        assert(rc != -1);
+        zmq_msg_close(&msg);
+        ++parts;
+        zmq_getsockopt(socket, ZMQ_RCVMORE, &more, &moreSize);
+    } while (more);
+    // topic, transactions, sequence number
+    assert(parts >= 3);
+    return parts - 2;
+}
+
+/// Publish 10k rawtx notifications through the validation interface and the ZMQ publisher thread to a subscriber in
+/// the same process, with up to `batchSize` transactions per message.
+static void benchZMQPublishRawTx(benchmark::State &state, size_t batchSize) {
+    constexpr size_t NUM_TXS = 10'000;
+    const std::string address = "inproc://bench_zmq_rawtx";
+
+    std::vector<CTransactionRef> txs;
+    txs.reserve(NUM_TXS);
+    for (size_t i = 0; i < NUM_TXS; ++i) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(COutPoint(TxId(InsecureRand256()), 0), CScript() << std::vector<uint8_t>(100, 0xff));
+        tx.vout.emplace_back(1337 * SATOSHI, CScript() << OP_TRUE);
+        txs.push_back(MakeTransactionRef(tx));
+    }
+
+    gArgs.ForceSetArg("-zmqpubrawtx", address);
+    gArgs.ForceSetArg("-zmqtxbatchsize", i64tostr(batchSize));
+    gArgs.ForceSetArg("-zmqqueuesize", i64tostr(NUM_TXS));
+    std::unique_ptr<CZMQNotificationInterface> zmqInterface = CZMQNotificationInterface::Create();
+    gArgs.ClearArg("-zmqpubrawtx");
+    gArgs.ClearArg("-zmqtxbatchsize");
+    gArgs.ClearArg("-zmqqueuesize");
+    assert(zmqInterface);
+    RegisterValidationInterface(zmqInterface.get());
+
+    void *subscriber = zmq_socket(zmqInterface->GetContext(), ZMQ_SUB);
+    assert(subscriber);
+    // Don't let the subscriber side limit the queue, so that no message is dropped.
+    const int hwm = 0;
+    zmq_setsockopt(subscriber, ZMQ_RCVHWM, &hwm, sizeof(hwm));
+    zmq_setsockopt(subscriber, ZMQ_SUBSCRIBE, "", 0);
+    const int rc = zmq_connect(subscriber, address.c_str());
+    assert(rc == 0);
+
+    // Subscriptions take effect asynchronously; publish until the subscriber receives something, then drain.
+    zmq_pollitem_t item{subscriber, 0, ZMQ_POLLIN, 0};
+    do {
+        GetMainSignals().TransactionAddedToMempool(txs.front());
+    } while (zmq_poll(&item, 1, 100) == 0);
+    while (zmq_poll(&item, 1, 100) > 0) {
+        ReceiveTransactions(subscriber);
+    }
+
+    BENCHMARK_LOOP {
+        for (const CTransactionRef &tx : txs) {
+            GetMainSignals().TransactionAddedToMempool(tx);
+        }
+        for (size_t received = 0; received < NUM_TXS;) {
+            received += ReceiveTransactions(subscriber);
+        }
+    }
+
+    UnregisterValidationInterface(zmqInterface.get());
+    SyncWithValidationInterfaceQueue();
+    const int linger = 0;
+    zmq_setsockopt(subscriber, ZMQ_LINGER, &linger, sizeof(linger));
+    zmq_close(subscriber);
+    zmqInterface.reset();
+}
+
+static void ZMQPublishRawTx(benchmark::State &state) {
+    benchZMQPublishRawTx(state, 1);
+}
+static void ZMQPublishRawTxBatch100(benchmark::State &state) {
+    benchZMQPublishRawTx(state, 100);
+}
+
+BENCHMARK(ZMQPublishRawTx, 5);
+BENCHMARK(ZMQPublishRawTxBatch100, 5);
@@ -135,13 +135,17 @@ ReadStatus PartiallyDownloadedBlock::InitData(
     std::vector<bool> have_txn(txns_available.size());
     {
         LOCK(pool->cs);
-        for (auto &entry : pool->GetIndex()) {
-            uint64_t shortid = cmpctblock.GetShortID(entry.GetTx().GetHash());
+        // The short ids depend on the block, so they have to be computed for
+        // the whole mempool. Read the hashes from the mempool's contiguous
+        // array, and only visit the entries that match.
+        const std::vector<TxHash> &txHashes = pool->vTxHashes;
+        for (size_t i = 0; i < txHashes.size(); i++) {
+            uint64_t shortid = cmpctblock.GetShortID(txHashes[i]);
             std::unordered_map<uint64_t, uint32_t>::iterator idit =
                 shorttxids.find(shortid);
             if (idit != shorttxids.end()) {
                 if (!have_txn[idit->second]) {
-                    txns_available[idit->second] = entry.GetSharedTx();
+                    txns_available[idit->second] = pool->vTxHashesEntries[i]->GetSharedTx();
                     have_txn[idit->second] = true;
                     mempool_count++;
                 } else {
@@ -10,6 +10,8 @@
 #include <script/script.h>
 #include <streams.h>
 
+#include <mutex>
+
 /// SerType used to serialize parameters in GCS filter encoding.
 static constexpr int GCS_SER_TYPE = SER_NETWORK;
 
@@ -216,6 +218,37 @@ bool BlockFilterTypeByName(const std::string &name,
     return false;
 }
 
+const std::set<BlockFilterType> &AllBlockFilterTypes() {
+    static std::set<BlockFilterType> types;
+
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        for (const auto &entry : g_filter_types) {
+            types.insert(entry.first);
+        }
+    });
+
+    return types;
+}
+
+const std::string &ListBlockFilterTypes() {
+    static std::string type_list;
+
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        bool first = true;
+        for (const auto &entry : g_filter_types) {
+            if (!first) {
+                type_list += ", ";
+            }
+            type_list += entry.second;
+            first = false;
+        }
+    });
+
+    return type_list;
+}
+
 static GCSFilter::ElementSet BasicFilterElements(const CBlock &block,
                                                  const CBlockUndo &block_undo) {
     GCSFilter::ElementSet elements;
@@ -13,6 +13,7 @@
 #include <util/saltedhashers.h>
 
 #include <cstdint>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -97,6 +98,12 @@ const std::string &BlockFilterTypeName(BlockFilterType filter_type);
 bool BlockFilterTypeByName(const std::string &name,
                            BlockFilterType &filter_type);
 
+/** Get a list of known filter types. */
+const std::set<BlockFilterType> &AllBlockFilterTypes();
+
+/** Get a comma-separated list of known filter type names. */
+const std::string &ListBlockFilterTypes();
+
 /**
  * Complete block filter struct as defined in BIP 157. Serialization matches
  * payload of "cfilter" messages.
@@ -135,7 +142,7 @@ public:
     uint256 ComputeHeader(const uint256 &prev_header) const;
 
     template <typename Stream> void Serialize(Stream &s) const {
-        s << m_block_hash << static_cast<uint8_t>(m_filter_type)
+        s << static_cast<uint8_t>(m_filter_type) << m_block_hash
           << m_filter.GetEncoded();
     }
 
@@ -143,7 +150,7 @@ public:
         std::vector<uint8_t> encoded_filter;
         uint8_t filter_type;
 
-        s >> m_block_hash >> filter_type >> encoded_filter;
+        s >> filter_type >> m_block_hash >> encoded_filter;
 
         m_filter_type = static_cast<BlockFilterType>(filter_type);
 
@@ -8,54 +8,107 @@
 #include <sync.h>
 #include <tinyformat.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 
 #include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <utility>
 #include <vector>
 
 template <typename T> class CCheckQueueControl;
 
+/** Statistics about one CCheckQueue run, i.e. everything between the first
+ *  Add() and the Wait() that completes it (typically: one block). */
+struct CCheckQueueStats {
+    //! Number of checks that were processed (checks skipped after a failure
+    //! was found are included)
+    uint64_t nChecks{0};
+    //! Number of times a thread took a batch from another thread's queue
+    uint64_t nSteals{0};
+    //! Number of checks that were moved between threads by those steals
+    uint64_t nStolenChecks{0};
+    //! Time the master spent blocked in Wait(), after it ran out of checks to
+    //! take, until the last batch in flight on a worker was done
+    int64_t nMasterWaitMicros{0};
+};
+
 /**
  * Queue for verifications that have to be performed.
  * The verifications are represented by a type T, which must provide an
  * operator(), returning a bool. For optimal performance, T should be
- * efficiently move-constructible and move-assignable.
+ * efficiently move-constructible and move-assignable. If T also provides a
+ * static RunBatch(std::vector<T> &), the checks that a thread takes at once
+ * are handed to it together rather than run one by one.
  *
  * One thread (the master) is assumed to push batches of verifications onto the
  * queue, where they are processed by N-1 worker threads. When the master is
  * done adding work, it temporarily joins the worker pool as an N'th worker,
  * until all jobs are done.
+ *
+ * Every thread owns a deque of checks. Add() spreads the checks over the
+ * workers' deques, an owner takes work from the back of its own deque and a
+ * thread that runs dry steals from the front of another thread's deque. Each
+ * deque has its own mutex, so in the common case a thread only ever touches
+ * its own uncontended lock. The shared mutex and condition variables are only
+ * used to put idle threads to sleep and to wake them up again.
  */
 template <typename T> class CCheckQueue {
 private:
-    //! Mutex to protect the inner state
+    /** The checks owned by one thread (index 0 is the master). */
+    struct WorkQueue {
+        Mutex m_mutex;
+        std::deque<T> m_checks GUARDED_BY(m_mutex);
+    };
+
+    //! Mutex to protect the sleep/wakeup state below
     Mutex m_mutex;
 
     //! Worker threads block on this when out of work
     std::condition_variable m_worker_cv;
 
-    //! Master thread blocks on this when out of work
+    //! Master thread blocks on this while the last batches are finishing
     std::condition_variable m_master_cv;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue GUARDED_BY(m_mutex);
+    //! Per-thread queues. Only resized by StartWorkerThreads(), while no
+    //! worker thread is running.
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle GUARDED_BY(m_mutex){0};
+    //! Number of worker queues Add() distributes over (0: use the master's).
+    //! Only accessed by the master and by Start/StopWorkerThreads().
+    size_t m_num_workers{0};
 
-    //! The total number of workers (including the master).
-    int nTotal GUARDED_BY(m_mutex){0};
+    //! Round-robin position of the next Add() among the worker queues.
+    //! Only accessed by the master.
+    size_t m_next_queue{0};
 
-    //! The temporary evaluation result.
-    bool fAllOk GUARDED_BY(m_mutex){true};
+    //! Number of checks sitting in any of the queues (not yet taken).
+    std::atomic<int64_t> m_queued{0};
 
     /**
      * Number of verifications that haven't completed yet.
-     * This includes elements that are no longer queued, but still in the
-     * worker's own batches.
+     * This includes elements that are no longer queued, but still in some
+     * thread's batch.
      */
-    unsigned int nTodo GUARDED_BY(m_mutex){0};
+    std::atomic<int64_t> m_todo{0};
+
+    //! The temporary evaluation result.
+    std::atomic<bool> m_all_ok{true};
+
+    //! Number of worker threads that are (about to go) asleep on m_worker_cv.
+    std::atomic<int> m_idle{0};
+
+    //! Counters for the current run, see CCheckQueueStats.
+    std::atomic<uint64_t> m_stat_checks{0};
+    std::atomic<uint64_t> m_stat_steals{0};
+    std::atomic<uint64_t> m_stat_stolen_checks{0};
+
+    //! Statistics of the run completed by the last Wait().
+    //! Only accessed by the master.
+    CCheckQueueStats m_last_stats;
 
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
@@ -63,77 +116,102 @@ private:
     std::vector<std::thread> m_worker_threads;
     bool m_request_stop GUARDED_BY(m_mutex){false};
 
-    /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster) {
-        std::condition_variable& cond = fMaster ? m_master_cv : m_worker_cv;
-        std::vector<T> vChecks;
-        vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
-        do {
-            {
-                WAIT_LOCK(m_mutex, lock);
-                // first do the clean-up of the previous loop run (allowing us
-                // to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster) {
-                        // We processed the last element; inform the master it
-                        // can exit and return the result
-                        m_master_cv.notify_one();
-                    }
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty() && !m_request_stop) {
-                    if (fMaster && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
-                }
-                if (m_request_stop) {
-                    return false;
-                }
+    /**
+     * How many of the `size` checks in a queue to take at once: half of them,
+     * so the rest is left for thieves and all threads finish at approximately
+     * the same time, but no more than nBatchSize and at least one.
+     */
+    size_t BatchSize(size_t size) const {
+        return std::max<size_t>(1, std::min<size_t>(nBatchSize, size / 2));
+    }
 
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for
-                // increasingly smaller batches so all workers finish
-                // approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start
-                // helping.
-                // * Don't do batches smaller than 1 (duh), or larger than
-                // nBatchSize.
-                nNow = std::max(
-                    1U, std::min(nBatchSize, (unsigned int)queue.size() /
-                                                 (nTotal + nIdle + 1)));
-                for (unsigned int i = 0; i < nNow; i++) {
-                    // We want the lock on the mutex to be as short as possible,
-                    // move jobs from the global queue to the local batch
-                    // vector.  Assumption: moving is fast.
-                    vChecks.push_back(std::move(queue.back()));
-                    queue.pop_back();
+    /**
+     * Move a batch of checks into `batch`, preferably from queue `idx` (the
+     * caller's own), otherwise from one of the other queues.
+     * @returns false if all queues are empty.
+     */
+    bool Take(size_t idx, std::vector<T> &batch) {
+        {
+            WorkQueue &own = *m_queues[idx];
+            LOCK(own.m_mutex);
+            if (!own.m_checks.empty()) {
+                // Newest first: as the order of booleans doesn't matter, the
+                // owner uses its queue as a LIFO (stack)
+                for (size_t n = BatchSize(own.m_checks.size()); n > 0; --n) {
+                    batch.push_back(std::move(own.m_checks.back()));
+                    own.m_checks.pop_back();
+                }
+                m_queued -= int64_t(batch.size());
+                return true;
+            }
+        }
+        // Steal from the opposite end than the one the owner works on
+        for (size_t i = 1; i < m_queues.size(); ++i) {
+            WorkQueue &victim = *m_queues[(idx + i) % m_queues.size()];
+            LOCK(victim.m_mutex);
+            if (!victim.m_checks.empty()) {
+                for (size_t n = BatchSize(victim.m_checks.size()); n > 0; --n) {
+                    batch.push_back(std::move(victim.m_checks.front()));
+                    victim.m_checks.pop_front();
                 }
-                // Check whether we need to do work at all
-                fOk = fAllOk;
+                m_queued -= int64_t(batch.size());
+                m_stat_steals.fetch_add(1, std::memory_order_relaxed);
+                m_stat_stolen_checks.fetch_add(batch.size(), std::memory_order_relaxed);
+                return true;
             }
-            // execute work
-            for (T &check : vChecks) {
+        }
+        return false;
+    }
+
+    /** Run (or skip, if a check failed already) and destroy a batch. */
+    void Execute(std::vector<T> &batch) {
+        bool fOk = m_all_ok.load(std::memory_order_relaxed);
+        if constexpr (requires { { T::RunBatch(batch) } -> std::convertible_to<bool>; }) {
+            fOk = fOk && T::RunBatch(batch);
+        } else {
+            for (T &check : batch) {
                 if (fOk) {
                     fOk = check();
                 }
             }
-            vChecks.clear();
-        } while (true);
+        }
+        if (!fOk) {
+            m_all_ok.store(false, std::memory_order_relaxed);
+        }
+        const int64_t nNow = int64_t(batch.size());
+        m_stat_checks.fetch_add(nNow, std::memory_order_relaxed);
+        // The checks must be destroyed before they are reported as done
+        batch.clear();
+        if (m_todo.fetch_sub(nNow) == nNow) {
+            // We processed the last element; inform the master it can exit
+            // and return the result
+            LOCK(m_mutex);
+            m_master_cv.notify_one();
+        }
+    }
+
+    /** Internal function that does bulk of the verification work. */
+    void Loop(size_t idx) {
+        std::vector<T> vChecks;
+        vChecks.reserve(nBatchSize);
+        while (true) {
+            if (Take(idx, vChecks)) {
+                Execute(vChecks);
+                continue;
+            }
+            WAIT_LOCK(m_mutex, lock);
+            // Announce ourselves as idle before looking at m_queued one last
+            // time; Add() updates them in the opposite order, so one of us is
+            // guaranteed to see the other.
+            ++m_idle;
+            m_worker_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                return m_request_stop || m_queued.load() > 0;
+            });
+            --m_idle;
+            if (m_request_stop) {
+                return;
+            }
+        }
     }
 
 public:
@@ -142,44 +220,87 @@ public:
 
     //! Create a new check queue
     explicit CCheckQueue(unsigned int nBatchSizeIn)
-        : nBatchSize(nBatchSizeIn) {}
+        : nBatchSize(nBatchSizeIn) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
 
-    //! Create a pool of new worker threads.
-    void StartWorkerThreads(const int threads_num)
+    //! Create a pool of new worker threads, named `<thread_name_prefix>.<n>`.
+    void StartWorkerThreads(const int threads_num, const char *thread_name_prefix = "scriptch")
     {
-        {
-             LOCK(m_mutex);
-             nIdle = 0;
-             nTotal = 0;
-             fAllOk = true;
-         }
-         assert(m_worker_threads.empty());
-         for (int n = 0; n < threads_num; ++n) {
-             m_worker_threads.emplace_back([this, n]() {
-                 util::ThreadRename(strprintf("scriptch.%i", n));
-                 Loop(false /* worker thread */);
-             });
-         }
+        assert(m_worker_threads.empty());
+        m_all_ok = true;
+        // Queues are never removed, so checks that might already have been
+        // added are not lost.
+        while (m_queues.size() < size_t(std::max(threads_num, 0)) + 1) {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+        m_num_workers = std::max(threads_num, 0);
+        m_next_queue = 0;
+        for (int n = 0; n < threads_num; ++n) {
+            m_worker_threads.emplace_back([this, n, thread_name_prefix]() {
+                util::ThreadRename(strprintf("%s.%i", thread_name_prefix, n));
+                Loop(n + 1 /* worker thread */);
+            });
+        }
     }
 
     //! Wait until execution finishes, and return whether all evaluations were
     //! successful.
-    bool Wait() { return Loop(true /* master thread */); }
+    bool Wait() {
+        std::vector<T> vChecks;
+        vChecks.reserve(nBatchSize);
+        int64_t nWaitMicros = 0;
+        // Nothing is added while we are in here, so once Take() fails only
+        // the batches other threads are still working on remain.
+        while (Take(0 /* master */, vChecks)) {
+            Execute(vChecks);
+        }
+        if (m_todo.load() != 0) {
+            const Tic waitTime;
+            WAIT_LOCK(m_mutex, lock);
+            m_master_cv.wait(lock, [&] { return m_todo.load() == 0; });
+            nWaitMicros = waitTime.usec();
+        }
+        m_last_stats.nChecks = m_stat_checks.exchange(0);
+        m_last_stats.nSteals = m_stat_steals.exchange(0);
+        m_last_stats.nStolenChecks = m_stat_stolen_checks.exchange(0);
+        m_last_stats.nMasterWaitMicros = nWaitMicros;
+        // reset the status for new work later, and return the current status
+        return m_all_ok.exchange(true);
+    }
 
     //! Add a batch of checks to the queue
     void Add(std::vector<T> &vChecks) {
-        LOCK(m_mutex);
-        for (T &check : vChecks) {
-            queue.push_back(std::move(check));
+        if (vChecks.empty()) {
+            return;
         }
-        nTodo += vChecks.size();
-        if (vChecks.size() == 1) {
-            m_worker_cv.notify_one();
-        } else if (vChecks.size() > 1) {
-            m_worker_cv.notify_all();
+        // Account for all of them first, so the counter can't drop to zero
+        // while we are still distributing.
+        m_todo += int64_t(vChecks.size());
+        size_t nChunks = 0;
+        for (size_t begin = 0; begin < vChecks.size(); begin += nBatchSize, ++nChunks) {
+            const size_t end = std::min<size_t>(vChecks.size(), begin + nBatchSize);
+            WorkQueue &queue = *m_queues[m_num_workers ? 1 + m_next_queue++ % m_num_workers : 0];
+            m_queued += int64_t(end - begin);
+            LOCK(queue.m_mutex);
+            for (size_t i = begin; i < end; ++i) {
+                queue.m_checks.push_back(std::move(vChecks[i]));
+            }
+        }
+        if (m_idle.load() > 0) {
+            LOCK(m_mutex);
+            if (vChecks.size() == 1) {
+                m_worker_cv.notify_one();
+            } else {
+                m_worker_cv.notify_all();
+            }
         }
     }
 
+    //! Statistics of the last run completed by Wait(). Only meaningful to the
+    //! holder of m_control_mutex.
+    const CCheckQueueStats &GetLastRunStats() const { return m_last_stats; }
+
     //! Stop all of the worker threads.
     void StopWorkerThreads()
     {
@@ -189,6 +310,8 @@ public:
             t.join();
         }
         m_worker_threads.clear();
+        // Anything still queued is picked up by the master in Wait()
+        m_num_workers = 0;
         WITH_LOCK(m_mutex, m_request_stop = false);
     }
 
@@ -231,6 +354,11 @@ public:
         }
     }
 
+    //! Statistics of this run, valid after Wait(). Empty without a queue.
+    CCheckQueueStats GetStats() const {
+        return pqueue != nullptr && fDone ? pqueue->GetLastRunStats() : CCheckQueueStats{};
+    }
+
     ~CCheckQueueControl() {
         if (!fDone) {
             Wait();
@@ -27,6 +27,9 @@ bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
 CCoinsViewCursor *CCoinsView::Cursor(bool snapshot) const {
     return nullptr;
 }
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsView::CursorShards(size_t) const {
+    return {};
+}
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const {
     Coin coin;
     return GetCoin(outpoint, coin);
@@ -55,12 +58,17 @@ bool CCoinsViewBacked::BatchWrite(CCoinsMap &mapCoins,
 CCoinsViewCursor *CCoinsViewBacked::Cursor(bool snapshot) const {
     return base->Cursor(snapshot);
 }
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsViewBacked::CursorShards(size_t nShards) const {
+    return base->CursorShards(nShards);
+}
 size_t CCoinsViewBacked::EstimateSize() const {
     return base->EstimateSize();
 }
 
 CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn)
-    : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) {}
+    : CCoinsViewBacked(baseIn),
+      cacheCoins(0, SaltedOutpointHasher{}, CCoinsMap::key_equal{}, &m_cache_coins_memory_resource),
+      cachedCoinsUsage(0) {}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
     return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
@@ -127,6 +135,18 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin coin,
     cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
 }
 
+void CCoinsViewCache::EmplaceFetchedCoin(const COutPoint &outpoint, Coin &&coin) {
+    auto [it, inserted] = cacheCoins.try_emplace(outpoint, std::move(coin));
+    if (!inserted) {
+        return;
+    }
+    if (it->second.coin.IsSpent()) {
+        // Same as in FetchCoin(): the parent only has an empty entry.
+        it->second.flags = CCoinsCacheEntry::FRESH;
+    }
+    cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+}
+
 void AddCoins(CCoinsViewCache &cache, const CTransaction &tx, int nHeight,
               bool check) {
     bool fCoinbase = tx.IsCoinBase();
@@ -259,6 +279,7 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins,
 bool CCoinsViewCache::Flush() {
     bool fOk = base->BatchWrite(cacheCoins, hashBlock);
     cacheCoins.clear();
+    ReallocateCache();
     cachedCoinsUsage = 0;
     return fOk;
 }
@@ -271,6 +292,16 @@ void CCoinsViewCache::Uncache(const COutPoint &outpoint) {
     }
 }
 
+void CCoinsViewCache::ReallocateCache() {
+    // Cache should be empty when we're calling this.
+    assert(cacheCoins.size() == 0);
+    cacheCoins.~CCoinsMap();
+    m_cache_coins_memory_resource.~CCoinsMapMemoryResource();
+    ::new (&m_cache_coins_memory_resource) CCoinsMapMemoryResource{};
+    ::new (&cacheCoins)
+        CCoinsMap{0, SaltedOutpointHasher{}, CCoinsMap::key_equal{}, &m_cache_coins_memory_resource};
+}
+
 unsigned int CCoinsViewCache::GetCacheSize() const {
     return cacheCoins.size();
 }
@@ -11,10 +11,12 @@
 #include <memusage.h>
 #include <primitives/blockhash.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <util/saltedhashers.h>
 
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 
 /**
@@ -91,8 +93,25 @@ struct CCoinsCacheEntry {
         : coin(std::move(coinIn)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher>
-    CCoinsMap;
+/**
+ * PoolAllocator's MAX_BLOCK_SIZE_BYTES parameter here uses sizeof the data, and
+ * adds the size of 4 pointers. We do not know the exact node size used in the
+ * std::unordered_node implementation because it is implementation defined.
+ * Most implementations have an overhead of 1 or 2 pointers, so nodes can be
+ * connected in a linked list, and in some cases the hash value is stored as
+ * well. Using an additional sizeof(void*)*4 for MAX_BLOCK_SIZE_BYTES should
+ * thus be sufficient so that all implementations can allocate the nodes from
+ * the PoolAllocator.
+ */
+using CCoinsMap =
+    std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher, std::equal_to<COutPoint>,
+                       PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>,
+                                     sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) + sizeof(void *) * 4>>;
+
+using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
+
+//! The maximum number of cursors that CCoinsView::CursorShards() can split the state into
+static constexpr size_t MAX_CURSOR_SHARDS = 256;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor {
@@ -144,6 +163,11 @@ public:
     //! Get a cursor to iterate over the whole state
     virtual CCoinsViewCursor *Cursor(bool snapshot = false) const;
 
+    //! Get `nShards` (at most MAX_CURSOR_SHARDS) cursors over the same snapshot of the state, which together iterate
+    //! over the whole state. All coins of a transaction are in the same shard. Returns an empty vector if the view
+    //! cannot be iterated over in shards.
+    virtual std::vector<std::unique_ptr<CCoinsViewCursor>> CursorShards(size_t nShards) const;
+
     //! As we use CCoinsViews polymorphically, have a virtual destructor
     virtual ~CCoinsView() {}
 
@@ -165,6 +189,7 @@ public:
     void SetBackend(CCoinsView &viewIn);
     bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override;
     CCoinsViewCursor *Cursor(bool snapshot = false) const override;
+    std::vector<std::unique_ptr<CCoinsViewCursor>> CursorShards(size_t nShards) const override;
     size_t EstimateSize() const override;
 };
 
@@ -178,6 +203,11 @@ protected:
      * declared as "const".
      */
     mutable BlockHash hashBlock;
+    /**
+     * Backing memory for the nodes of cacheCoins. Must be declared before
+     * cacheCoins so that it outlives it.
+     */
+    mutable CCoinsMapMemoryResource m_cache_coins_memory_resource{};
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
@@ -229,6 +259,15 @@ public:
     void AddCoin(const COutPoint &outpoint, Coin coin,
                  bool potential_overwrite);
 
+    /**
+     * Insert a coin that was read from the backing view out-of-band (e.g. by a
+     * prefetch worker thread) as an unmodified cache entry, exactly as
+     * FetchCoin() would have done. Has no effect if the outpoint already has
+     * an entry in this cache, since that entry may be newer than what the
+     * backing view returned.
+     */
+    void EmplaceFetchedCoin(const COutPoint &outpoint, Coin &&coin);
+
     /**
      * Spend a coin. Pass moveto in order to get the deleted data.
      * If no unspent output exists for the passed outpoint, this call has no
@@ -250,6 +289,15 @@ public:
      */
     void Uncache(const COutPoint &outpoint);
 
+    /**
+     * Force a reallocation of the cache map. This is required when downsizing
+     * the cache because the map's allocator may be hanging onto a lot of
+     * memory despite having called .clear().
+     *
+     * See: https://stackoverflow.com/questions/42114044/how-to-release-unordered-map-memory
+     */
+    void ReallocateCache();
+
     //! Calculate the size of the cache (in number of transaction outputs)
     unsigned int GetCacheSize() const;
 
@@ -11,10 +11,16 @@
 #include <streams.h>
 #include <util/overflow.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 #include <utxosync/primitives.h>
 #include <validation.h> // for cs_main
 #include <version.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 namespace {
 
 // Helper used by AddCoinToMultiSet() and RemoveCoinFromMultiSet() below
@@ -166,9 +172,10 @@ static void FinalizeHash(MuHash3072 &mh, CoinStats &stats) {
     stats.multiSet = mh;
 }
 
+//! Feeds all coins that `cursor` iterates over to `stats` and `hash_obj`
 template <typename HashObj>
-static bool ComputeUTXOStats(CCoinsView &view, CCoinsViewCursor &cursor, CoinStats &stats, HashObj hash_obj,
-                             const std::function<void()> &interruption_point) {
+static bool ApplyCursor(CCoinsViewCursor &cursor, CoinStats &stats, HashObj &hash_obj,
+                        const std::function<void()> &interruption_point) {
     TxId prevkey;
     std::map<uint32_t, Coin> outputs;
     while (cursor.Valid()) {
@@ -194,6 +201,102 @@ static bool ComputeUTXOStats(CCoinsView &view, CCoinsViewCursor &cursor, CoinSta
         ApplyStats(stats, prevkey, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+template <typename HashObj>
+static bool ComputeUTXOStats(CCoinsView &view, CCoinsViewCursor &cursor, CoinStats &stats, HashObj hash_obj,
+                             const std::function<void()> &interruption_point) {
+    if (!ApplyCursor(cursor, stats, hash_obj, interruption_point)) {
+        return false;
+    }
+
+    FinalizeHash(hash_obj, stats);
+
+    stats.nDiskSize = view.EstimateSize();
+
+    return true;
+}
+
+static void CombineStats(CoinStats &stats, const CoinStats &other) {
+    stats.nTransactions += other.nTransactions;
+    stats.nTransactionOutputs += other.nTransactionOutputs;
+    stats.nBogoSize += other.nBogoSize;
+    if (other.nTotalAmount) {
+        stats.safeAddToTotalAmount(*other.nTotalAmount);
+    } else {
+        stats.nTotalAmount.reset();
+    }
+}
+
+static void CombineHash(std::nullptr_t, std::nullptr_t) {}
+static void CombineHash(ECMultiSet &ms, const ECMultiSet &other) { ms += other; }
+static void CombineHash(MuHash3072 &mh, const MuHash3072 &other) { mh *= other; }
+
+/// Multiset hashes don't depend on the order of the coins, so the shards can be hashed concurrently into separate
+/// accumulators, which are combined at the end. `nThreads - 1` worker threads are started, and the calling thread
+/// takes part in the work, so that it can honor `interruption_point`.
+template <typename HashObj>
+static bool ComputeUTXOStatsSharded(CCoinsView &view, const std::vector<std::unique_ptr<CCoinsViewCursor>> &shards,
+                                    CoinStats &stats, size_t nThreads,
+                                    const std::function<void()> &interruption_point) {
+    struct Accumulator {
+        CoinStats stats;
+        HashObj hash_obj{};
+        bool success{true};
+    };
+    std::vector<Accumulator> accumulators(nThreads);
+    std::atomic<size_t> nextShard{0};
+    std::atomic<bool> fAbort{false};
+    struct Aborted {};
+
+    auto work = [&](Accumulator &acc, const std::function<void()> &check) {
+        for (size_t n; !fAbort && (n = nextShard++) < shards.size();) {
+            if (!ApplyCursor(*shards[n], acc.stats, acc.hash_obj, check)) {
+                acc.success = false;
+                fAbort = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (size_t t = 1; t < nThreads; ++t) {
+        threads.emplace_back([&, t] {
+            util::ThreadRename("utxostats");
+            try {
+                work(accumulators[t], [&] {
+                    if (fAbort) {
+                        throw Aborted{};
+                    }
+                });
+            } catch (const Aborted &) {
+                accumulators[t].success = false;
+            }
+        });
+    }
+    auto joinAll = [&] {
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    };
+    try {
+        work(accumulators[0], interruption_point);
+    } catch (...) {
+        fAbort = true;
+        joinAll();
+        throw;
+    }
+    joinAll();
+
+    HashObj hash_obj{};
+    for (const Accumulator &acc : accumulators) {
+        if (!acc.success) {
+            return false;
+        }
+        CombineStats(stats, acc.stats);
+        CombineHash(hash_obj, acc.hash_obj);
+    }
 
     FinalizeHash(hash_obj, stats);
 
@@ -203,11 +306,39 @@ static bool ComputeUTXOStats(CCoinsView &view, CCoinsViewCursor &cursor, CoinSta
 }
 
 std::optional<CoinStats> ComputeUTXOStats(CCoinsView *view, const CoinStatsHashType hash_type,
-                                          const std::function<void()> &interruption_point) {
+                                          const std::function<void()> &interruption_point, size_t nThreads) {
     std::optional<CoinStats> ret;
 
     const bool success = [&]() -> bool {
         assert(view);
+        assert(nThreads > 0);
+
+        // The legacy serialized hash depends on the order of the coins, so it is always computed on a single thread.
+        if (nThreads > 1 && hash_type != CoinStatsHashType::HASH_SERIALIZED_3) {
+            // Use more shards than threads, so that a thread that got a sparse shard can take on another one
+            const auto shards = view->CursorShards(std::min(nThreads * 8, MAX_CURSOR_SHARDS));
+            if (!shards.empty()) {
+                const CBlockIndex *pindex =
+                        WITH_LOCK(::cs_main, return ::LookupBlockIndex(shards.front()->GetBestBlock()));
+                assert(pindex);
+
+                CoinStats &stats = ret.emplace(pindex->nHeight, pindex->GetBlockHash());
+
+                switch (hash_type) {
+                    case CoinStatsHashType::MUHASH_TESTING:
+                        return ComputeUTXOStatsSharded<MuHash3072>(*view, shards, stats, nThreads, interruption_point);
+                    case CoinStatsHashType::ECMH:
+                        return ComputeUTXOStatsSharded<ECMultiSet>(*view, shards, stats, nThreads, interruption_point);
+                    case CoinStatsHashType::NONE:
+                        return ComputeUTXOStatsSharded<std::nullptr_t>(*view, shards, stats, nThreads,
+                                                                       interruption_point);
+                    case CoinStatsHashType::HASH_SERIALIZED_3:
+                        break;
+                } // no default case, so the compiler can warn about missing cases
+                assert(false);
+            }
+        }
+
         std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
         assert(pcursor);
 
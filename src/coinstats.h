@@ -98,6 +98,10 @@ void AddCoinToMuHash(MuHash3072 &mh, const COutPoint &outpoint, const Coin &coin
 /// Removes a coin from the muhash `mh`. Pass-in an optional `scratchBuf` to reuse (to avoid repetitive reallocations)
 void RemoveCoinFromMuHash(MuHash3072 &mh, const COutPoint &outpoint, const Coin &coin, std::vector<uint8_t> *scratchBuf = nullptr);
 
-/// Calculate statistics about the unspent transaction output set
+/// The maximum number of threads that the RPC uses for ComputeUTXOStats(); reading the database stops scaling beyond
+static constexpr int MAX_UTXO_STATS_THREADS = 16;
+
+/// Calculate statistics about the unspent transaction output set. Unless the hash type is HASH_SERIALIZED_3, the set is
+/// split into shards that are processed on `nThreads` threads (including the calling thread), if the view supports it.
 std::optional<CoinStats> ComputeUTXOStats(CCoinsView *view, CoinStatsHashType hash_type,
-                                          const std::function<void()> &interruption_point);
+                                          const std::function<void()> &interruption_point, size_t nThreads = 1);
@@ -83,6 +83,9 @@ typedef char *sockopt_arg_type;
 // __APPLE__ poll is broke https://github.com/bitcoin/bitcoin/pull/14336#issuecomment-437384408
 #if defined(__linux__)
 #define USE_POLL
+// epoll keeps the sockets registered across iterations of the socket handler
+// and only reports the ones that are ready, see CConnman::SocketHandlerEpoll()
+#define USE_EPOLL
 #endif
 
 bool static inline IsSelectableSocket(const SOCKET& s) {
@@ -10,6 +10,8 @@
 #include <atomic>
 #include <cassert>
 #include <cstring>
+#include <tuple>
+#include <utility>
 
 #if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
 #if defined(USE_ASM)
@@ -23,16 +25,25 @@ namespace sha256d64_sse41 {
 void Transform_4way(uint8_t *out, const uint8_t *in);
 }
 
+namespace sha256_sse41 {
+void Transform_4way(uint32_t *s, const uint8_t *const chunks[4]);
+}
+
 namespace sha256d64_avx2 {
 void Transform_8way(uint8_t *out, const uint8_t *in);
 }
 
+namespace sha256_avx2 {
+void Transform_8way(uint32_t *s, const uint8_t *const chunks[8]);
+}
+
 namespace sha256d64_shani {
 void Transform_2way(uint8_t *out, const uint8_t *in);
 }
 
 namespace sha256_shani {
 void Transform(uint32_t *s, const uint8_t *chunk, size_t blocks);
+void Transform_2way(uint32_t *s, const uint8_t *const chunks[2]);
 }
 
 // Internal implementation code.
@@ -579,6 +590,11 @@ namespace sha256 {
 
 typedef void (*TransformType)(uint32_t *, const uint8_t *, size_t);
 typedef void (*TransformD64Type)(uint8_t *, const uint8_t *);
+/**
+ * Transforms N independent states by one 64-byte chunk each. Lane l has its state at s + 8 * l and its chunk at
+ * chunks[l].
+ */
+typedef void (*TransformMultiType)(uint32_t *, const uint8_t *const *);
 
 template <TransformType tr>
 void TransformD64Wrapper(uint8_t *out, const uint8_t *in) {
@@ -619,6 +635,9 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformMultiType TransformMulti_2way = nullptr;
+TransformMultiType TransformMulti_4way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -730,6 +749,27 @@ bool SelfTest() {
         }
     }
 
+    // Test the available multi-way transforms, by taking lane i from the state after i chunks to the state after i + 1
+    // chunks.
+    for (const auto &[tr, lanes] : {std::pair{TransformMulti_2way, 2}, {TransformMulti_4way, 4},
+                                    {TransformMulti_8way, 8}}) {
+        if (!tr) {
+            continue;
+        }
+        uint32_t states[64];
+        const uint8_t *chunks[8];
+        for (int i = 0; i < lanes; ++i) {
+            std::copy(result[i], result[i] + 8, states + 8 * i);
+            chunks[i] = data + 1 + 64 * i;
+        }
+        tr(states, chunks);
+        for (int i = 0; i < lanes; ++i) {
+            if (!std::equal(states + 8 * i, states + 8 * i + 8, result[i + 1])) {
+                return false;
+            }
+        }
+    }
+
     return true;
 }
 
@@ -781,6 +821,7 @@ std::string SHA256AutoDetect() {
         Transform = sha256_shani::Transform;
         TransformD64 = TransformD64Wrapper<sha256_shani::Transform>;
         TransformD64_2way = sha256d64_shani::Transform_2way;
+        TransformMulti_2way = sha256_shani::Transform_2way;
         ret = "shani(1way,2way)";
         have_sse4 = false; // Disable SSE4/AVX2;
         have_avx2 = false;
@@ -795,6 +836,7 @@ std::string SHA256AutoDetect() {
 #endif
 #if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformMulti_4way = sha256_sse41::Transform_4way;
         ret += ",sse41(4way)";
 #endif
     }
@@ -802,6 +844,7 @@ std::string SHA256AutoDetect() {
 #if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256_avx2::Transform_8way;
         ret += ",avx2(8way)";
     }
 #endif
@@ -896,3 +939,162 @@ void SHA256D64(uint8_t *out, const uint8_t *in, size_t blocks) {
         --blocks;
     }
 }
+
+namespace {
+/** A message being hashed on one lane of a multi-way transform. */
+struct MultiLane {
+    static constexpr size_t IDLE = size_t(-1);
+
+    //! The index of the message, or IDLE
+    size_t index = IDLE;
+    //! Whether the lane is hashing the digest of the message, for a double SHA-256
+    bool second = false;
+    //! The full chunks of the message, which are transformed in place
+    const uint8_t *data = nullptr;
+    size_t blocks = 0;
+    //! The padded remainder of the message, of one or two chunks
+    uint8_t tail[128];
+    size_t tailBlocks = 0;
+    size_t tailPos = 0;
+
+    void Start(Span<const uint8_t> msg) {
+        data = msg.data();
+        blocks = msg.size() / 64;
+        const size_t rem = msg.size() % 64;
+        if (rem) {
+            std::memcpy(tail, msg.data() + 64 * blocks, rem);
+        }
+        tailBlocks = rem < 56 ? 1 : 2;
+        tailPos = 0;
+        tail[rem] = 0x80;
+        std::memset(tail + rem + 1, 0, 64 * tailBlocks - 8 - rem - 1);
+        WriteBE64(tail + 64 * tailBlocks - 8, uint64_t(msg.size()) << 3);
+    }
+
+    //! @returns the next chunk to transform, or nullptr if the message is done
+    const uint8_t *Peek() const {
+        return blocks ? data : tailPos < tailBlocks ? tail + 64 * tailPos : nullptr;
+    }
+    void Advance() {
+        if (blocks) {
+            data += 64;
+            --blocks;
+        } else {
+            ++tailPos;
+        }
+    }
+};
+
+/**
+ * @returns the widest available multi-way transform that `busy` messages keep at least half busy, and its width, or
+ * (nullptr, 1) if hashing them one at a time is faster
+ */
+std::pair<TransformMultiType, size_t> PickTransformMulti(size_t busy) {
+    for (const auto &[tr, width] : {std::pair{TransformMulti_8way, size_t{8}}, {TransformMulti_4way, size_t{4}},
+                                    {TransformMulti_2way, size_t{2}}}) {
+        if (tr && busy >= 2 && width <= 2 * busy) {
+            return {tr, width};
+        }
+    }
+    return {nullptr, 1};
+}
+
+/**
+ * Hashes `count` messages on a multi-way transform, every lane taking the next message as soon as it is done with one.
+ * Once the messages run out, the lanes that are still busy move to narrower transforms, and finally finish one at a
+ * time.
+ */
+void SHA256MultiImpl(uint8_t *out, const Span<const uint8_t> *in, size_t count, bool fDouble) {
+    static const uint8_t IDLE_CHUNK[64] = {};
+    MultiLane lane[8];
+    uint32_t s[64];
+    size_t next = 0;
+
+    const auto startNext = [&](size_t l) {
+        if (next == count) {
+            lane[l].index = MultiLane::IDLE;
+            return;
+        }
+        lane[l].Start(in[next]);
+        lane[l].index = next++;
+        lane[l].second = false;
+        sha256::Initialize(s + 8 * l);
+    };
+    // Writes out the digest of lane l. @returns whether the lane goes on to hash the digest.
+    const auto finish = [&](size_t l) {
+        const uint32_t *state = s + 8 * l;
+        uint8_t digest[32];
+        const bool again = fDouble && !lane[l].second;
+        uint8_t *dst = again ? digest : out + 32 * lane[l].index;
+        for (size_t i = 0; i < 8; ++i) {
+            WriteBE32(dst + 4 * i, state[i]);
+        }
+        if (again) {
+            lane[l].Start(digest);
+            lane[l].second = true;
+            sha256::Initialize(s + 8 * l);
+        }
+        return again;
+    };
+
+    auto [tr, width] = PickTransformMulti(count);
+    for (size_t l = 0; l < width; ++l) {
+        startNext(l);
+    }
+    while (tr) {
+        size_t busy = 0;
+        for (size_t l = 0; l < width; ++l) {
+            while (lane[l].index != MultiLane::IDLE && !lane[l].Peek()) {
+                if (!finish(l)) {
+                    startNext(l);
+                }
+            }
+            busy += lane[l].index != MultiLane::IDLE;
+        }
+        if (next == count && (busy < 2 || width > 2 * busy)) {
+            // Move the busy lanes to the front, for a narrower transform or for finishing them one at a time
+            size_t front = 0;
+            for (size_t l = 0; l < width; ++l) {
+                if (lane[l].index != MultiLane::IDLE) {
+                    if (front != l) {
+                        lane[front] = lane[l];
+                        std::copy(s + 8 * l, s + 8 * l + 8, s + 8 * front);
+                        lane[l].index = MultiLane::IDLE;
+                    }
+                    ++front;
+                }
+            }
+            std::tie(tr, width) = PickTransformMulti(busy);
+            continue;
+        }
+
+        const uint8_t *chunks[8];
+        for (size_t l = 0; l < width; ++l) {
+            chunks[l] = lane[l].index != MultiLane::IDLE ? lane[l].Peek() : IDLE_CHUNK;
+        }
+        tr(s, chunks);
+        for (size_t l = 0; l < width; ++l) {
+            if (lane[l].index != MultiLane::IDLE) {
+                lane[l].Advance();
+            }
+        }
+    }
+
+    // Finish the last message, or hash all of them if there is no multi-way transform to use
+    while (lane[0].index != MultiLane::IDLE) {
+        Transform(s, lane[0].data, lane[0].blocks);
+        Transform(s, lane[0].tail + 64 * lane[0].tailPos, lane[0].tailBlocks - lane[0].tailPos);
+        if (!finish(0)) {
+            startNext(0);
+        }
+    }
+}
+} // namespace
+
+void SHA256Multi(uint8_t *out, const Span<const uint8_t> *in, size_t count) {
+    SHA256MultiImpl(out, in, count, false);
+}
+
+void SHA256DMulti(uint8_t *out, const Span<const uint8_t> *in, size_t count) {
+    SHA256MultiImpl(out, in, count, true);
+}
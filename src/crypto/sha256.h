@@ -43,3 +43,16 @@ std::string SHA256AutoDetect();
  * blocks:  the number of hashes to compute.
  */
 void SHA256D64(uint8_t *output, const uint8_t *input, size_t blocks);
+
+/**
+ * Compute the SHA-256 (SHA256Multi) or double SHA-256 (SHA256DMulti) of
+ * several independent messages of any length, interleaving them on the
+ * multi-way transforms that the CPU supports (2 lanes with SHA-NI, 4 with
+ * SSE4.1, 8 with AVX2). This is faster than hashing them one at a time from
+ * two messages on, and the more so the closer their lengths are.
+ * output:  pointer to a count*32 byte output buffer
+ * input:   pointer to the count messages
+ * count:   the number of messages
+ */
+void SHA256Multi(uint8_t *output, const Span<const uint8_t> *input, size_t count);
+void SHA256DMulti(uint8_t *output, const Span<const uint8_t> *input, size_t count);
@@ -441,4 +441,86 @@ void Transform_4way(uint8_t *out, const uint8_t *in) {
 }
 } // namespace sha256d64_sse41
 
+namespace sha256_sse41 {
+namespace {
+    using namespace sha256d64_sse41;
+
+    const uint32_t ROUND_K[64] = {
+        0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul,
+        0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul, 0xd807aa98ul, 0x12835b01ul,
+        0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul,
+        0xc19bf174ul, 0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul,
+        0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul, 0x983e5152ul,
+        0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul,
+        0x06ca6351ul, 0x14292967ul, 0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul,
+        0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+        0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul,
+        0xd6990624ul, 0xf40e3585ul, 0x106aa070ul, 0x19a4c116ul, 0x1e376c08ul,
+        0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful,
+        0x682e6ff3ul, 0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul,
+        0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+    };
+
+    /** Lane l of state word i is s[8 * l + i]. */
+    __m128i inline LoadState(const uint32_t *s, int i) {
+        return _mm_set_epi32(s[i], s[8 + i], s[16 + i], s[24 + i]);
+    }
+
+    inline void StoreState(uint32_t *s, int i, __m128i v) {
+        s[i] = _mm_extract_epi32(v, 3);
+        s[8 + i] = _mm_extract_epi32(v, 2);
+        s[16 + i] = _mm_extract_epi32(v, 1);
+        s[24 + i] = _mm_extract_epi32(v, 0);
+    }
+
+    __m128i inline ReadChunks(const uint8_t *const chunks[4], int offset) {
+        return _mm_set_epi32(ReadBE32(chunks[0] + offset), ReadBE32(chunks[1] + offset),
+                             ReadBE32(chunks[2] + offset), ReadBE32(chunks[3] + offset));
+    }
+
+    /** The message schedule word of round i, from the ring buffer w of the last 16 words. */
+    __m128i inline W(__m128i *w, int i) {
+        if (i < 16) {
+            return w[i];
+        }
+        return Inc(w[i & 15], sigma1(w[(i - 2) & 15]), w[(i - 7) & 15], sigma0(w[(i - 15) & 15]));
+    }
+} // namespace
+
+void Transform_4way(uint32_t *s, const uint8_t *const chunks[4]) {
+    __m128i a = LoadState(s, 0);
+    __m128i b = LoadState(s, 1);
+    __m128i c = LoadState(s, 2);
+    __m128i d = LoadState(s, 3);
+    __m128i e = LoadState(s, 4);
+    __m128i f = LoadState(s, 5);
+    __m128i g = LoadState(s, 6);
+    __m128i h = LoadState(s, 7);
+
+    __m128i w[16];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = ReadChunks(chunks, 4 * i);
+    }
+    for (int i = 0; i < 64; i += 8) {
+        Round(a, b, c, d, e, f, g, h, Add(K(ROUND_K[i]), W(w, i)));
+        Round(h, a, b, c, d, e, f, g, Add(K(ROUND_K[i + 1]), W(w, i + 1)));
+        Round(g, h, a, b, c, d, e, f, Add(K(ROUND_K[i + 2]), W(w, i + 2)));
+        Round(f, g, h, a, b, c, d, e, Add(K(ROUND_K[i + 3]), W(w, i + 3)));
+        Round(e, f, g, h, a, b, c, d, Add(K(ROUND_K[i + 4]), W(w, i + 4)));
+        Round(d, e, f, g, h, a, b, c, Add(K(ROUND_K[i + 5]), W(w, i + 5)));
+        Round(c, d, e, f, g, h, a, b, Add(K(ROUND_K[i + 6]), W(w, i + 6)));
+        Round(b, c, d, e, f, g, h, a, Add(K(ROUND_K[i + 7]), W(w, i + 7)));
+    }
+
+    StoreState(s, 0, Add(a, LoadState(s, 0)));
+    StoreState(s, 1, Add(b, LoadState(s, 1)));
+    StoreState(s, 2, Add(c, LoadState(s, 2)));
+    StoreState(s, 3, Add(d, LoadState(s, 3)));
+    StoreState(s, 4, Add(e, LoadState(s, 4)));
+    StoreState(s, 5, Add(f, LoadState(s, 5)));
+    StoreState(s, 6, Add(g, LoadState(s, 6)));
+    StoreState(s, 7, Add(h, LoadState(s, 7)));
+}
+} // namespace sha256_sse41
+
 #endif
@@ -301,17 +301,26 @@ public:
 
     CDBIterator *NewIterator(bool snapshot = false) {
         if (snapshot) {
-            std::shared_ptr<const leveldb::Snapshot> psnapshot{pdb->GetSnapshot(), [db=pdb](const leveldb::Snapshot *s){
-                db->ReleaseSnapshot(s);
-            }};
-            auto snapshot_iteroptions = iteroptions;
-            snapshot_iteroptions.snapshot = psnapshot.get();
-            return new CDBIterator(*this, pdb->NewIterator(snapshot_iteroptions), std::move(psnapshot));
+            return NewIterator(GetSnapshot());
         } else {
             return new CDBIterator(*this, pdb->NewIterator(iteroptions));
         }
     }
 
+    //! Take a snapshot of the current state of the database, which is released once the last reference to it is gone
+    std::shared_ptr<const leveldb::Snapshot> GetSnapshot() {
+        return {pdb->GetSnapshot(), [db=pdb](const leveldb::Snapshot *s){
+            db->ReleaseSnapshot(s);
+        }};
+    }
+
+    //! Iterate over `psnapshot`, so that several iterators can share the same consistent view of the database
+    CDBIterator *NewIterator(std::shared_ptr<const leveldb::Snapshot> psnapshot) {
+        auto snapshot_iteroptions = iteroptions;
+        snapshot_iteroptions.snapshot = psnapshot.get();
+        return new CDBIterator(*this, pdb->NewIterator(snapshot_iteroptions), std::move(psnapshot));
+    }
+
     /**
      * Return true if the database managed by this class contains no entries.
      */
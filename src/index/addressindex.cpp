@@ -0,0 +1,421 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <config.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <node/blockstorage.h>
+#include <txdb.h>
+#include <txmempool.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <algorithm>
+
+/* The index database holds two kinds of entries, both keyed by script hash first so that all entries of a script are
+ * adjacent:
+ *
+ * - History entries have the type [DB_HISTORY, uint256, uint32 (BE), uint32 (BE)] for the script hash, the block
+ *   height and the position of the transaction in the block, and the txid as value. The numbers are big-endian so
+ *   that the history of a script is read in chain order.
+ * - Unspent output entries have the type [DB_UTXO, uint256, COutPoint], and the output (without its scriptPubKey) and
+ *   the height that created it as value.
+ *
+ * The best block locator is written in the same batch as the entries of the block it points to, so that the database
+ * never holds entries past its best block, which a later rewind would not know about.
+ */
+namespace {
+
+inline constexpr uint8_t DB_HISTORY{'a'};
+inline constexpr uint8_t DB_UTXO{'u'};
+
+struct DBHistoryKey {
+    uint256 scripthash;
+    uint32_t height{0};
+    uint32_t tx_pos{0};
+
+    DBHistoryKey() = default;
+    DBHistoryKey(const uint256 &scripthash_in, uint32_t height_in, uint32_t tx_pos_in)
+        : scripthash(scripthash_in), height(height_in), tx_pos(tx_pos_in) {}
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        ser_writedata8(s, DB_HISTORY);
+        s << scripthash;
+        ser_writedata32be(s, height);
+        ser_writedata32be(s, tx_pos);
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_HISTORY) {
+            throw std::ios_base::failure("Invalid format for address index DB history key");
+        }
+        s >> scripthash;
+        height = ser_readdata32be(s);
+        tx_pos = ser_readdata32be(s);
+    }
+};
+
+struct DBUtxoKey {
+    uint256 scripthash;
+    COutPoint outpoint;
+
+    DBUtxoKey() = default;
+    DBUtxoKey(const uint256 &scripthash_in, const COutPoint &outpoint_in)
+        : scripthash(scripthash_in), outpoint(outpoint_in) {}
+
+    SERIALIZE_METHODS(DBUtxoKey, obj) {
+        uint8_t prefix;
+        SER_WRITE(obj, prefix = DB_UTXO);
+        READWRITE(prefix);
+        if (prefix != DB_UTXO) {
+            throw std::ios_base::failure("Invalid format for address index DB utxo key");
+        }
+
+        READWRITE(obj.scripthash, obj.outpoint);
+    }
+};
+
+struct DBUtxoVal {
+    uint32_t height{0};
+    /// The output with its scriptPubKey left out, since the key already identifies it.
+    CTxOut txout;
+
+    DBUtxoVal() = default;
+    DBUtxoVal(uint32_t height_in, const CTxOut &txout_in)
+        : height(height_in), txout(txout_in.nValue, CScript(), txout_in.tokenDataPtr) {}
+
+    SERIALIZE_METHODS(DBUtxoVal, obj) { READWRITE(VARINT(obj.height), obj.txout); }
+};
+
+} // namespace
+
+std::unique_ptr<AddressIndex> g_address_index;
+
+/**
+ * Access to the address index database (indexes/addressindex/)
+ */
+class AddressIndex::DB : public BaseIndex::DB {
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false)
+        : BaseIndex::DB(GetDataDir() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe) {}
+};
+
+/// The database changes that connecting a block makes.
+struct AddressIndex::BlockEntries {
+    std::vector<std::pair<DBHistoryKey, TxId>> history;
+    /// Outputs created by the block.
+    std::vector<std::pair<DBUtxoKey, DBUtxoVal>> created;
+    /// Outputs spent by the block, as they were before it spent them.
+    std::vector<std::pair<DBUtxoKey, DBUtxoVal>> spent;
+
+    void Write(CDBBatch &batch) const {
+        for (const auto &entry : history) {
+            batch.Write(entry.first, entry.second);
+        }
+        // Create all outputs before spending any: a transaction may spend an output of a transaction that comes later
+        // in the block.
+        for (const auto &entry : created) {
+            batch.Write(entry.first, entry.second);
+        }
+        for (const auto &entry : spent) {
+            batch.Erase(entry.first);
+        }
+    }
+
+    void Undo(CDBBatch &batch) const {
+        for (const auto &entry : history) {
+            batch.Erase(entry.first);
+        }
+        for (const auto &entry : spent) {
+            batch.Write(entry.first, entry.second);
+        }
+        for (const auto &entry : created) {
+            batch.Erase(entry.first);
+        }
+    }
+};
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex("addressindex", true), m_db(std::make_unique<AddressIndex::DB>(n_cache_size, f_memory, f_wipe)) {}
+
+AddressIndex::~AddressIndex() {}
+
+BaseIndex::DB &AddressIndex::GetDB() const {
+    return *m_db;
+}
+
+uint256 AddressIndex::GetScriptHash(const CScript &script) {
+    uint256 scripthash;
+    CSHA256().Write(script.data(), script.size()).Finalize(scripthash.begin());
+    return scripthash;
+}
+
+bool AddressIndex::BuildEntries(const CBlockIndex *pindex, const CBlock *block, BlockEntries &entries) const {
+    // The outputs of the genesis block cannot be spent, so it gets no entries.
+    if (pindex->nHeight == 0) {
+        return true;
+    }
+
+    CBlock block_read;
+    if (!block) {
+        if (!ReadBlockFromDisk(block_read, pindex, GetConfig().GetChainParams().GetConsensus())) {
+            return error("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString());
+        }
+        block = &block_read;
+    }
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s from disk", __func__,
+                     pindex->GetBlockHash().ToString());
+    }
+    if (block_undo.vtxundo.size() + 1 != block->vtx.size()) {
+        return error("%s: Undo data does not match block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    const uint32_t height = pindex->nHeight;
+    for (size_t i = 0; i < block->vtx.size(); ++i) {
+        const CTransaction &tx = *block->vtx[i];
+        const uint32_t tx_pos = i;
+
+        for (size_t n = 0; n < tx.vout.size(); ++n) {
+            const CTxOut &txout = tx.vout[n];
+            if (txout.scriptPubKey.IsUnspendable()) {
+                continue;
+            }
+            const uint256 scripthash = GetScriptHash(txout.scriptPubKey);
+            entries.history.emplace_back(DBHistoryKey(scripthash, height, tx_pos), tx.GetId());
+            entries.created.emplace_back(DBUtxoKey(scripthash, COutPoint(tx.GetId(), n)), DBUtxoVal(height, txout));
+        }
+
+        if (tx.IsCoinBase()) {
+            continue;
+        }
+        const CTxUndo &tx_undo = block_undo.vtxundo[i - 1];
+        if (tx_undo.vprevout.size() != tx.vin.size()) {
+            return error("%s: Undo data does not match transaction %s", __func__, tx.GetId().ToString());
+        }
+        for (size_t n = 0; n < tx.vin.size(); ++n) {
+            const Coin &coin = tx_undo.vprevout[n];
+            const uint256 scripthash = GetScriptHash(coin.GetTxOut().scriptPubKey);
+            entries.history.emplace_back(DBHistoryKey(scripthash, height, tx_pos), tx.GetId());
+            entries.spent.emplace_back(DBUtxoKey(scripthash, tx.vin[n].prevout),
+                                       DBUtxoVal(coin.GetHeight(), coin.GetTxOut()));
+        }
+    }
+    return true;
+}
+
+bool AddressIndex::WriteBlock(const CBlock &block, const CBlockIndex *pindex) {
+    BlockEntries entries;
+    if (!BuildEntries(pindex, &block, entries)) {
+        return false;
+    }
+
+    CDBBatch batch(*m_db);
+    entries.Write(batch);
+    m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return ::ChainActive().GetLocator(pindex)));
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::WriteBlocks(const std::vector<const CBlockIndex *> &pindexes) {
+    // Gathering the entries of a block does not depend on any other block, but they are written in chain order, since
+    // blocks spend outputs of earlier blocks.
+    return WriteBlocksInParallel<BlockEntries>(
+        pindexes,
+        [this](const CBlockIndex *pindex, BlockEntries &entries) { return BuildEntries(pindex, nullptr, entries); },
+        [this](const std::vector<const CBlockIndex *> &pindexes_in, const std::vector<BlockEntries> &entries) {
+            const size_t batch_size = gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+            CDBBatch batch(*m_db);
+            for (size_t i = 0; i < pindexes_in.size(); ++i) {
+                entries[i].Write(batch);
+                if (i + 1 == pindexes_in.size() || batch.SizeEstimate() > batch_size) {
+                    m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return ::ChainActive().GetLocator(pindexes_in[i])));
+                    if (!m_db->WriteBatch(batch)) {
+                        return error("%s: Failed to write entries of block %s", __func__,
+                                     pindexes_in[i]->GetBlockHash().ToString());
+                    }
+                    batch.Clear();
+                }
+            }
+            return true;
+        });
+}
+
+bool AddressIndex::Rewind(const CBlockIndex *current_tip, const CBlockIndex *new_tip,
+                          const CBlock *current_tip_block) {
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // Undo the blocks from the tip down, so that outputs created and spent by the rewound blocks end up erased.
+    CDBBatch batch(*m_db);
+    for (const CBlockIndex *pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        BlockEntries entries;
+        if (!BuildEntries(pindex, pindex == current_tip ? current_tip_block : nullptr, entries)) {
+            return error("%s: Failed to rewind %s past block %s", __func__, GetName(),
+                         pindex->GetBlockHash().ToString());
+        }
+        entries.Undo(batch);
+    }
+    m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return ::ChainActive().GetLocator(new_tip)));
+    if (!m_db->WriteBatch(batch)) {
+        return error("%s: Failed to rewind %s to block %s", __func__, GetName(), new_tip->GetBlockHash().ToString());
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip, current_tip_block);
+}
+
+bool AddressIndex::FindHistory(const uint256 &scripthash, std::vector<AddressHistoryEntry> &history_out) const {
+    history_out.clear();
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBHistoryKey(scripthash, 0, 0));
+    DBHistoryKey key;
+    while (db_it->Valid() && db_it->GetKey(key) && key.scripthash == scripthash) {
+        TxId txid;
+        if (!db_it->GetValue(txid)) {
+            return error("%s: unable to read value in address index for the transaction at height %d, position %d",
+                         __func__, key.height, key.tx_pos);
+        }
+        history_out.push_back({txid, static_cast<int>(key.height), key.tx_pos});
+        db_it->Next();
+    }
+    return true;
+}
+
+bool AddressIndex::FindUtxos(const uint256 &scripthash, std::vector<AddressUtxo> &utxos_out) const {
+    utxos_out.clear();
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBUtxoKey(scripthash, COutPoint(TxId(), 0)));
+    DBUtxoKey key;
+    while (db_it->Valid() && db_it->GetKey(key) && key.scripthash == scripthash) {
+        DBUtxoVal value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: unable to read value in address index for %s", __func__, key.outpoint.ToString());
+        }
+        utxos_out.push_back({key.outpoint, value.txout.nValue, std::move(value.txout.tokenDataPtr),
+                             static_cast<int>(value.height)});
+        db_it->Next();
+    }
+    return true;
+}
+
+void AddressIndex::TransactionAddedToMempool(const CTransactionRef &ptx) {
+    std::vector<uint256> scripthashes;
+    for (const CTxOut &txout : ptx->vout) {
+        if (!txout.scriptPubKey.IsUnspendable()) {
+            scripthashes.push_back(GetScriptHash(txout.scriptPubKey));
+        }
+    }
+    std::sort(scripthashes.begin(), scripthashes.end());
+    scripthashes.erase(std::unique(scripthashes.begin(), scripthashes.end()), scripthashes.end());
+    if (scripthashes.empty()) {
+        return;
+    }
+
+    LOCK(m_cs_mempool);
+    for (const uint256 &scripthash : scripthashes) {
+        m_mempool_txs[scripthash].insert(ptx->GetId());
+    }
+    m_mempool_scripthashes[ptx->GetId()] = std::move(scripthashes);
+}
+
+void AddressIndex::TransactionRemovedFromMempool(const CTransactionRef &ptx) {
+    LOCK(m_cs_mempool);
+    RemoveMempoolTx(ptx->GetId());
+}
+
+void AddressIndex::BlockConnected(const std::shared_ptr<const CBlock> &block, const CBlockIndex *pindex,
+                                  const std::vector<CTransactionRef> &txn_conflicted) {
+    BaseIndex::BlockConnected(block, pindex, txn_conflicted);
+
+    // Transactions that leave the mempool because of a block are not reported by TransactionRemovedFromMempool().
+    LOCK(m_cs_mempool);
+    for (const CTransactionRef &ptx : block->vtx) {
+        RemoveMempoolTx(ptx->GetId());
+    }
+    for (const CTransactionRef &ptx : txn_conflicted) {
+        RemoveMempoolTx(ptx->GetId());
+    }
+}
+
+void AddressIndex::RemoveMempoolTx(const TxId &txid) {
+    AssertLockHeld(m_cs_mempool);
+    const auto it = m_mempool_scripthashes.find(txid);
+    if (it == m_mempool_scripthashes.end()) {
+        return;
+    }
+    for (const uint256 &scripthash : it->second) {
+        const auto txs_it = m_mempool_txs.find(scripthash);
+        if (txs_it != m_mempool_txs.end() && txs_it->second.erase(txid) && txs_it->second.empty()) {
+            m_mempool_txs.erase(txs_it);
+        }
+    }
+    m_mempool_scripthashes.erase(it);
+}
+
+std::set<TxId> AddressIndex::GetMempoolTxs(const uint256 &scripthash) const {
+    LOCK(m_cs_mempool);
+    const auto it = m_mempool_txs.find(scripthash);
+    return it != m_mempool_txs.end() ? it->second : std::set<TxId>{};
+}
+
+std::vector<TxId> AddressIndex::FindMempoolHistory(const CTxMemPool &pool, const uint256 &scripthash,
+                                                   const std::vector<AddressUtxo> &confirmed_utxos) const {
+    const std::set<TxId> funding_txids = GetMempoolTxs(scripthash);
+    std::set<TxId> txids;
+
+    LOCK(pool.cs);
+    auto add_spender = [&](const COutPoint &outpoint) EXCLUSIVE_LOCKS_REQUIRED(pool.cs) {
+        if (const CTransaction *spender = pool.GetConflictTx(outpoint)) {
+            txids.insert(spender->GetId());
+        }
+    };
+    for (const AddressUtxo &utxo : confirmed_utxos) {
+        add_spender(utxo.outpoint);
+    }
+    for (const TxId &txid : funding_txids) {
+        // The overlay is updated from the validation interface queue, so it can lag behind the mempool.
+        const CTransactionRef tx = pool.get(txid);
+        if (!tx) {
+            continue;
+        }
+        txids.insert(txid);
+        for (size_t n = 0; n < tx->vout.size(); ++n) {
+            if (GetScriptHash(tx->vout[n].scriptPubKey) == scripthash) {
+                add_spender(COutPoint(txid, n));
+            }
+        }
+    }
+    return {txids.begin(), txids.end()};
+}
+
+void AddressIndex::ApplyMempool(const CTxMemPool &pool, const uint256 &scripthash,
+                                std::vector<AddressUtxo> &utxos) const {
+    const std::set<TxId> funding_txids = GetMempoolTxs(scripthash);
+
+    LOCK(pool.cs);
+    utxos.erase(std::remove_if(utxos.begin(), utxos.end(),
+                               [&](const AddressUtxo &utxo) EXCLUSIVE_LOCKS_REQUIRED(pool.cs) {
+                                   return pool.GetConflictTx(utxo.outpoint) != nullptr;
+                               }),
+                utxos.end());
+    for (const TxId &txid : funding_txids) {
+        const CTransactionRef tx = pool.get(txid);
+        if (!tx) {
+            continue;
+        }
+        for (size_t n = 0; n < tx->vout.size(); ++n) {
+            const CTxOut &txout = tx->vout[n];
+            const COutPoint outpoint(txid, n);
+            if (GetScriptHash(txout.scriptPubKey) == scripthash && !pool.GetConflictTx(outpoint)) {
+                utxos.push_back({outpoint, txout.nValue, txout.tokenDataPtr, 0});
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <amount.h>
+#include <index/base.h>
+#include <primitives/token.h>
+#include <primitives/transaction.h>
+#include <primitives/txid.h>
+#include <script/script.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/saltedhashers.h>
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class CTxMemPool;
+
+static constexpr bool DEFAULT_ADDRESSINDEX = false;
+
+/// A confirmed transaction that pays to or spends from a script, with its block height and its position in the block.
+struct AddressHistoryEntry {
+    TxId txid;
+    int height;
+    uint32_t tx_pos;
+};
+
+/// An unspent output paying to a script.
+struct AddressUtxo {
+    COutPoint outpoint;
+    Amount value;
+    token::OutputDataPtr tokenDataPtr;
+    /// Height of the block that created the output, or 0 for an output of a mempool transaction.
+    int height;
+};
+
+/**
+ * AddressIndex maps script hashes (the SHA256 of a scriptPubKey, as used by the Electrum protocol) to the history of
+ * confirmed transactions that pay to or spend from the script, and to its confirmed unspent outputs.
+ *
+ * History entries hold the txid along with the height and the position in the block of a transaction, so that
+ * listing the history of a script does not have to read any block. The genesis block and provably unspendable outputs
+ * are not indexed.
+ *
+ * Mempool transactions are kept out of the database. Instead, the index keeps an in-memory overlay of the mempool
+ * transactions that pay to each script, from which the mempool side of a script's history and unspent outputs is
+ * derived at query time.
+ */
+class AddressIndex final : public BaseIndex {
+    class DB;
+    const std::unique_ptr<DB> m_db;
+
+    struct BlockEntries;
+
+    /// Gather the index entries of `pindex`, reading the block from disk if `block` is null.
+    bool BuildEntries(const CBlockIndex *pindex, const CBlock *block, BlockEntries &entries) const;
+
+    mutable Mutex m_cs_mempool;
+    /// Mempool transactions by the script hashes they pay to.
+    std::unordered_map<uint256, std::set<TxId>, SaltedUint256Hasher> m_mempool_txs GUARDED_BY(m_cs_mempool);
+    /// The script hashes each transaction in m_mempool_txs pays to.
+    std::unordered_map<TxId, std::vector<uint256>, SaltedTxIdHasher> m_mempool_scripthashes GUARDED_BY(m_cs_mempool);
+
+    void RemoveMempoolTx(const TxId &txid) EXCLUSIVE_LOCKS_REQUIRED(m_cs_mempool);
+
+    /// Mempool transactions that pay to `scripthash`, according to the overlay.
+    std::set<TxId> GetMempoolTxs(const uint256 &scripthash) const;
+
+protected:
+    void TransactionAddedToMempool(const CTransactionRef &ptx) override;
+
+    void TransactionRemovedFromMempool(const CTransactionRef &ptx) override;
+
+    void BlockConnected(const std::shared_ptr<const CBlock> &block, const CBlockIndex *pindex,
+                        const std::vector<CTransactionRef> &txn_conflicted) override;
+
+    bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) override;
+
+    /// Gathers the entries of the batch in parallel, then writes them in order in batches of at most
+    /// -dbbatchsize bytes.
+    bool WriteBlocks(const std::vector<const CBlockIndex *> &pindexes) override;
+
+    /// Removes the entries of the blocks after `new_tip` and restores the outputs they spent.
+    bool Rewind(const CBlockIndex *current_tip, const CBlockIndex *new_tip,
+                const CBlock *current_tip_block) override;
+
+    BaseIndex::DB &GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AddressIndex() override;
+
+    /// The key under which the index files the outputs paying to `script`.
+    static uint256 GetScriptHash(const CScript &script);
+
+    /// Get the confirmed history of a script, ordered by height and position in the block.
+    bool FindHistory(const uint256 &scripthash, std::vector<AddressHistoryEntry> &history_out) const;
+
+    /// Get the confirmed unspent outputs of a script, ordered by outpoint.
+    bool FindUtxos(const uint256 &scripthash, std::vector<AddressUtxo> &utxos_out) const;
+
+    /// Get the mempool transactions that pay to a script or spend from it, given the confirmed unspent outputs of the
+    /// script.
+    std::vector<TxId> FindMempoolHistory(const CTxMemPool &pool, const uint256 &scripthash,
+                                         const std::vector<AddressUtxo> &confirmed_utxos) const;
+
+    /// Apply the mempool to the confirmed unspent outputs of a script: drop those spent by mempool transactions and
+    /// append the unspent outputs of mempool transactions that pay to the script.
+    void ApplyMempool(const CTxMemPool &pool, const uint256 &scripthash, std::vector<AddressUtxo> &utxos) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_address_index;
@@ -16,11 +16,20 @@
 #include <validation.h>
 #include <warnings.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+
 constexpr char DB_BEST_BLOCK = 'B';
 
 constexpr int64_t SYNC_LOG_INTERVAL = 30;           // seconds
 constexpr int64_t SYNC_LOCATOR_WRITE_INTERVAL = 30; // seconds
 
+/// Number of blocks per sync thread that ThreadSync() hands to WriteBlocks() at
+/// once, for indices with parallel sync.
+constexpr size_t SYNC_BLOCKS_PER_THREAD = 16;
+
 template <typename... Args>
 static void FatalError(const char *fmt, const Args &... args) {
     std::string strMessage = tfm::format(fmt, args...);
@@ -32,6 +41,117 @@ static void FatalError(const char *fmt, const Args &... args) {
     StartShutdown();
 }
 
+/// Runs one job of RunSyncJobs(), turning an exception into a failure so that it
+/// does not take down the thread.
+static bool RunSyncJob(const std::function<bool(size_t)> &job, size_t i,
+                       const std::string &name) {
+    try {
+        return job(i);
+    } catch (const std::exception &e) {
+        PrintExceptionContinue(&e, name.c_str());
+    } catch (...) {
+        PrintExceptionContinue(nullptr, name.c_str());
+    }
+    return false;
+}
+
+class BaseIndex::SyncWorkers {
+    const std::string m_name;
+
+    Mutex m_mutex;
+    //! Workers block on this while there is no job to run
+    std::condition_variable m_worker_cv;
+    //! Run() blocks on this while workers are still busy
+    std::condition_variable m_done_cv;
+
+    //! The jobs of the current Run(), or nullptr outside of Run()
+    const std::function<bool(size_t)> *m_job GUARDED_BY(m_mutex){nullptr};
+    size_t m_size GUARDED_BY(m_mutex){0};
+    //! Incremented by every Run(), so that workers take part in it only once
+    uint64_t m_generation GUARDED_BY(m_mutex){0};
+    //! Number of workers that are taking part in the current Run()
+    int m_busy GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::atomic<size_t> m_next{0};
+    std::atomic<bool> m_failed{false};
+
+    std::vector<std::thread> m_threads;
+
+    void DoJobs(const std::function<bool(size_t)> &job, size_t size) {
+        for (size_t i; !m_failed && (i = m_next++) < size;) {
+            if (!RunSyncJob(job, i, m_name)) {
+                m_failed = true;
+            }
+        }
+    }
+
+    void Loop() {
+        uint64_t generation = 0;
+        while (true) {
+            const std::function<bool(size_t)> *job;
+            size_t size;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_worker_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                    return m_stop || (m_job && m_generation != generation);
+                });
+                if (m_stop) {
+                    return;
+                }
+                generation = m_generation;
+                job = m_job;
+                size = m_size;
+                ++m_busy;
+            }
+            DoJobs(*job, size);
+            {
+                LOCK(m_mutex);
+                if (--m_busy == 0) {
+                    m_done_cv.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    SyncWorkers(const std::string &name, int n_threads) : m_name{name} {
+        for (int n = 0; n < n_threads; ++n) {
+            m_threads.emplace_back(util::TraceThread, m_name.c_str(), [this] { Loop(); });
+        }
+    }
+
+    ~SyncWorkers() {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_worker_cv.notify_all();
+        for (std::thread &thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+    bool Run(size_t n, const std::function<bool(size_t)> &job) {
+        m_next = 0;
+        m_failed = false;
+        {
+            LOCK(m_mutex);
+            m_job = &job;
+            m_size = n;
+            ++m_generation;
+        }
+        m_worker_cv.notify_all();
+        DoJobs(job, n);
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_busy == 0; });
+            // Workers that wake up only now must not pick up `job` anymore.
+            m_job = nullptr;
+        }
+        return !m_failed;
+    }
+};
+
 BaseIndex::DB::DB(const fs::path &path, size_t n_cache_size, bool f_memory,
                   bool f_wipe, bool f_obfuscate)
     : CDBWrapper(path, n_cache_size, f_memory, f_wipe, f_obfuscate) {}
@@ -49,8 +169,11 @@ void BaseIndex::DB::WriteBestBlock(CDBBatch &batch,
     batch.Write(DB_BEST_BLOCK, locator);
 }
 
-BaseIndex::BaseIndex(std::string_view index_name)
-    : m_name{index_name} {}
+BaseIndex::BaseIndex(std::string_view index_name, bool f_parallel_sync)
+    : m_name{index_name},
+      m_sync_threads{f_parallel_sync
+                         ? std::clamp(GetNumCores(), 1, MAX_INDEX_SYNC_THREADS)
+                         : 0} {}
 
 BaseIndex::~BaseIndex() {
     Interrupt();
@@ -67,7 +190,14 @@ bool BaseIndex::Init() {
     if (locator.IsNull()) {
         m_best_block_index = nullptr;
     } else {
-        m_best_block_index = FindForkInGlobalIndex(::ChainActive(), locator);
+        // Resume from the block the index was written up to, even if it is no
+        // longer in the active chain, so that ThreadSync() rewinds the index
+        // from there.
+        const CBlockIndex *locator_index =
+            LookupBlockIndex(locator.vHave.front());
+        m_best_block_index =
+            locator_index ? locator_index
+                          : FindForkInGlobalIndex(::ChainActive(), locator);
     }
     m_synced = m_best_block_index.load() == ::ChainActive().Tip();
     return true;
@@ -92,10 +222,9 @@ static const CBlockIndex *NextSyncBlock(const CBlockIndex *pindex_prev)
 void BaseIndex::ThreadSync() {
     const CBlockIndex *pindex = m_best_block_index.load();
     if (!m_synced) {
-        auto &consensus_params = GetConfig().GetChainParams().GetConsensus();
-
         int64_t last_log_time = 0;
         int64_t last_locator_write_time = 0;
+        std::vector<const CBlockIndex *> pindexes;
         while (true) {
             if (m_interrupt) {
                 m_best_block_index = pindex;
@@ -107,8 +236,30 @@ void BaseIndex::ThreadSync() {
                 return;
             }
 
+            // If the chain was reorganized past the last block written to the
+            // index, rewind it to the fork point first. Rewinding reads the
+            // stale blocks from disk, so it happens without holding cs_main.
+            const CBlockIndex *pindex_fork = WITH_LOCK(
+                cs_main, return pindex && !::ChainActive().Contains(pindex)
+                                    ? ::ChainActive().FindFork(pindex)
+                                    : nullptr);
+            if (pindex_fork) {
+                if (!Rewind(pindex, pindex_fork, nullptr)) {
+                    FatalError("%s: Failed to rewind index %s to a previous "
+                               "chain tip",
+                               __func__, GetName());
+                    return;
+                }
+                pindex = pindex_fork;
+            }
+
+            pindexes.clear();
             {
                 LOCK(cs_main);
+                if (pindex && !::ChainActive().Contains(pindex)) {
+                    // Reorganized again while rewinding.
+                    continue;
+                }
                 const CBlockIndex *pindex_next = NextSyncBlock(pindex);
                 if (!pindex_next) {
                     m_best_block_index = pindex;
@@ -117,35 +268,35 @@ void BaseIndex::ThreadSync() {
                     Commit();
                     break;
                 }
-                pindex = pindex_next;
+                const size_t batch_size = std::max<size_t>(GetSyncBatchSize(), 1);
+                do {
+                    pindexes.push_back(pindex_next);
+                    pindex_next = ::ChainActive().Next(pindex_next);
+                } while (pindex_next && pindexes.size() < batch_size);
             }
 
             int64_t current_time = GetTime();
             if (last_log_time + SYNC_LOG_INTERVAL < current_time) {
                 LogPrintf("Syncing %s with block chain from height %d\n",
-                          GetName(), pindex->nHeight);
+                          GetName(), pindexes.front()->nHeight);
                 last_log_time = current_time;
             }
 
-            if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL <
-                current_time) {
+            if (pindex && last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL <
+                              current_time) {
                 m_best_block_index = pindex;
                 last_locator_write_time = current_time;
                 // No need to handle errors in Commit. See rationale above.
                 Commit();
             }
 
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
-                FatalError("%s: Failed to read block %s from disk", __func__,
-                           pindex->GetBlockHash().ToString());
-                return;
-            }
-            if (!WriteBlock(block, pindex)) {
-                FatalError("%s: Failed to write block %s to index database",
-                           __func__, pindex->GetBlockHash().ToString());
+            if (!WriteBlocks(pindexes)) {
+                FatalError("%s: Failed to write blocks %s to %s to index database",
+                           __func__, pindexes.front()->GetBlockHash().ToString(),
+                           pindexes.back()->GetBlockHash().ToString());
                 return;
             }
+            pindex = pindexes.back();
         }
     }
 
@@ -154,6 +305,71 @@ void BaseIndex::ThreadSync() {
     } else {
         LogPrintf("%s is enabled\n", GetName());
     }
+
+    if (BlockUntilSyncedToCurrentChain()) {
+        std::vector<std::function<void()>> callbacks;
+        {
+            LOCK(m_synced_callbacks_mutex);
+            callbacks.swap(m_synced_callbacks);
+            m_synced_callbacks_done = true;
+        }
+        for (const auto &func : callbacks) {
+            func();
+        }
+    }
+}
+
+bool BaseIndex::WriteBlocks(const std::vector<const CBlockIndex *> &pindexes) {
+    const auto &consensus_params = GetConfig().GetChainParams().GetConsensus();
+    for (const CBlockIndex *pindex : pindexes) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__,
+                         pindex->GetBlockHash().ToString());
+        }
+        if (!WriteBlock(block, pindex)) {
+            return error("%s: Failed to write block %s to %s", __func__,
+                         pindex->GetBlockHash().ToString(), GetName());
+        }
+    }
+    return true;
+}
+
+size_t BaseIndex::GetSyncBatchSize() const {
+    return m_sync_threads > 0 ? m_sync_threads * SYNC_BLOCKS_PER_THREAD : 1;
+}
+
+bool BaseIndex::RunSyncJobs(int n_threads, size_t n,
+                            const std::function<bool(size_t)> &job) {
+    const size_t n_run_threads = std::min<size_t>(std::max(n_threads, 1), n);
+    if (n_run_threads <= 1) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!RunSyncJob(job, i, GetName())) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (!m_sync_workers || m_sync_workers->GetThreadCount() + 1 < n_run_threads) {
+        m_sync_workers.reset();
+        m_sync_workers = std::make_unique<SyncWorkers>(GetName(), n_threads - 1);
+    }
+    return m_sync_workers->Run(n, job);
+}
+
+bool BaseIndex::Rewind(const CBlockIndex *current_tip,
+                       const CBlockIndex *new_tip,
+                       const CBlock *current_tip_block) {
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // In the case of a reorg, ensure persisted block locator is not stale.
+    m_best_block_index = new_tip;
+    if (!Commit()) {
+        // If commit fails, revert the best block index to avoid corruption.
+        m_best_block_index = current_tip;
+        return false;
+    }
+    return true;
 }
 
 bool BaseIndex::Commit() {
@@ -203,6 +419,12 @@ void BaseIndex::BlockConnected(
                       best_block_index->GetBlockHash().ToString());
             return;
         }
+        if (best_block_index != pindex->pprev &&
+            !Rewind(best_block_index, pindex->pprev, nullptr)) {
+            FatalError("%s: Failed to rewind index %s to a previous chain tip",
+                       __func__, GetName());
+            return;
+        }
     }
 
     if (WriteBlock(*block, pindex)) {
@@ -214,6 +436,23 @@ void BaseIndex::BlockConnected(
     }
 }
 
+void BaseIndex::BlockDisconnected(const std::shared_ptr<const CBlock> &block) {
+    if (!m_synced) {
+        return;
+    }
+
+    const CBlockIndex *pindex = WITH_LOCK(cs_main, return LookupBlockIndex(block->GetHash()));
+    const CBlockIndex *best_block_index = m_best_block_index.load();
+    // The block may not have been indexed yet, see BlockConnected.
+    if (!pindex || pindex != best_block_index || !pindex->pprev) {
+        return;
+    }
+    if (!Rewind(best_block_index, pindex->pprev, block.get())) {
+        FatalError("%s: Failed to rewind index %s to a previous chain tip",
+                   __func__, GetName());
+    }
+}
+
 void BaseIndex::ChainStateFlushed(const CBlockLocator &locator) {
     if (!m_synced) {
         return;
@@ -264,11 +503,12 @@ bool BaseIndex::BlockUntilSyncedToCurrentChain() {
 
     {
         // Skip the queue-draining stuff if we know we're caught up with
-        // ::ChainActive().Tip().
+        // ::ChainActive().Tip(). An index that is ahead of the tip still has
+        // to process the disconnection of its stale blocks.
         LOCK(cs_main);
         const CBlockIndex *chain_tip = ::ChainActive().Tip();
         const CBlockIndex *best_block_index = m_best_block_index.load();
-        if (best_block_index->GetAncestor(chain_tip->nHeight) == chain_tip) {
+        if (best_block_index == chain_tip) {
             return true;
         }
     }
@@ -279,6 +519,17 @@ bool BaseIndex::BlockUntilSyncedToCurrentChain() {
     return true;
 }
 
+void BaseIndex::CallWhenSynced(std::function<void()> func) {
+    {
+        LOCK(m_synced_callbacks_mutex);
+        if (!m_synced_callbacks_done) {
+            m_synced_callbacks.push_back(std::move(func));
+            return;
+        }
+    }
+    func();
+}
+
 void BaseIndex::Interrupt() {
     m_interrupt();
 }
@@ -292,7 +543,10 @@ void BaseIndex::Start() {
         return;
     }
 
-    m_thread_sync = std::thread(util::TraceThread, GetName().c_str(), [this] { ThreadSync(); });
+    m_thread_sync = std::thread(util::TraceThread, GetName().c_str(), [this] {
+        ThreadSync();
+        m_sync_workers.reset();
+    });
 }
 
 void BaseIndex::Stop() {
@@ -8,15 +8,24 @@
 #include <dbwrapper.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <sync.h>
 #include <threadinterrupt.h>
 #include <uint256.h>
 #include <validationinterface.h>
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 class CBlockIndex;
 
+/// Maximum number of threads that an index with parallel sync uses to build
+/// its entries while it catches up with the block chain.
+static constexpr int MAX_INDEX_SYNC_THREADS = 8;
+
 /** Result type returned by BaseIndex::GetSummary() */
 struct IndexSummary {
     std::string name;
@@ -59,6 +68,21 @@ private:
     std::thread m_thread_sync;
     CThreadInterrupt m_interrupt;
 
+    /// Number of threads that WriteBlocksInParallel() builds entries on, or 0
+    /// if the index does not sync in parallel.
+    const int m_sync_threads;
+
+    /// Threads that help the sync thread in RunSyncJobs(). They are started on
+    /// first use and stopped when the sync thread exits.
+    class SyncWorkers;
+    std::unique_ptr<SyncWorkers> m_sync_workers;
+
+    /// Callbacks registered with CallWhenSynced(), and whether the sync thread
+    /// has already run them.
+    Mutex m_synced_callbacks_mutex;
+    std::vector<std::function<void()>> m_synced_callbacks GUARDED_BY(m_synced_callbacks_mutex);
+    bool m_synced_callbacks_done GUARDED_BY(m_synced_callbacks_mutex){false};
+
     /// Sync the index with the block index starting from the current best
     /// block. Intended to be run in its own thread, m_thread_sync, and can be
     /// interrupted with m_interrupt. Once the index gets in sync, the m_synced
@@ -84,6 +108,11 @@ protected:
                    const CBlockIndex *pindex,
                    const std::vector<CTransactionRef> &txn_conflicted) override;
 
+    /// Rewinds the index past a block that is disconnected from the active
+    /// chain, so that it does not serve entries of the stale block until the
+    /// next block is connected.
+    void BlockDisconnected(const std::shared_ptr<const CBlock> &block) override;
+
     void ChainStateFlushed(const CBlockLocator &locator) override;
 
     /// Initialize internal state from the database and block index.
@@ -94,17 +123,62 @@ protected:
         return true;
     }
 
+    /// Write index entries for a run of consecutive blocks while ThreadSync()
+    /// catches up with the active chain. The default implementation reads the
+    /// blocks from disk one at a time and hands them to WriteBlock(). Indices
+    /// with parallel sync override it with a call to WriteBlocksInParallel().
+    virtual bool WriteBlocks(const std::vector<const CBlockIndex *> &pindexes);
+
+    /// Maximum number of blocks that ThreadSync() passes to WriteBlocks() at
+    /// once.
+    virtual size_t GetSyncBatchSize() const;
+
+    /// Calls job(i) for every i in [0, n) on the sync thread and on up to
+    /// n_threads - 1 persistent worker threads, and waits for all of them.
+    /// Returns false if any job returned false or threw, in which case the
+    /// remaining jobs may not have run. Only to be used from WriteBlocks().
+    bool RunSyncJobs(int n_threads, size_t n,
+                     const std::function<bool(size_t)> &job);
+
+    /// Writes a batch of blocks for an index with parallel sync, whose entries
+    /// for a block do not depend on other blocks. build(pindex, entries) is
+    /// called for each block on up to m_sync_threads threads, then
+    /// write(pindexes, all_entries) writes them in chain order.
+    template <typename Entries, typename Build, typename Write>
+    bool WriteBlocksInParallel(const std::vector<const CBlockIndex *> &pindexes,
+                               Build build, Write write) {
+        std::vector<Entries> entries(pindexes.size());
+        return RunSyncJobs(m_sync_threads, pindexes.size(),
+                           [&](size_t i) {
+                               return build(pindexes[i], entries[i]);
+                           }) &&
+               write(pindexes, entries);
+    }
+
     /// Virtual method called internally by Commit that can be overridden to
     /// atomically commit more index state.
     virtual bool CommitInternal(CDBBatch &batch);
 
+    /// Rewind index to an earlier chain tip during a chain reorg. The tip must
+    /// be an ancestor of the current best block. current_tip_block is the
+    /// block of current_tip if the caller has it at hand, so that it does not
+    /// have to be read from disk again, or null. Called without cs_main held.
+    /// The default implementation only moves the best block back, which suits
+    /// indices whose entries for stale blocks are harmless.
+    virtual bool Rewind(const CBlockIndex *current_tip,
+                        const CBlockIndex *new_tip,
+                        const CBlock *current_tip_block);
+
     virtual DB &GetDB() const = 0;
 
     /// Get the name of the index for display in logs.
     const std::string &GetName() const { return m_name; }
 
 public:
-    explicit BaseIndex(std::string_view index_name);
+    /// Indices with f_parallel_sync build the entries of the blocks they catch
+    /// up with on several threads, see WriteBlocksInParallel().
+    explicit BaseIndex(std::string_view index_name,
+                       bool f_parallel_sync = false);
 
     /// Destructor interrupts sync thread if running and blocks until it exits.
     virtual ~BaseIndex();
@@ -116,6 +190,12 @@ public:
     /// not block and immediately returns false.
     bool BlockUntilSyncedToCurrentChain();
 
+    /// Calls `func` once the sync thread has caught up with the block chain
+    /// and BlockUntilSyncedToCurrentChain() returned true for it, or right
+    /// away if that has happened already. It is not called if the sync thread
+    /// is interrupted or fails before that.
+    void CallWhenSynced(std::function<void()> func);
+
     void Interrupt();
 
     /// Start initializes the sync state and registers the instance as a
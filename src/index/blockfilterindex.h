@@ -0,0 +1,123 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <blockfilter.h>
+#include <chain.h>
+#include <flatfile.h>
+#include <index/base.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/saltedhashers.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr const char *DEFAULT_BLOCKFILTERINDEX = "0";
+
+/// Interval between compact filter checkpoints. See BIP 157.
+static constexpr int CFCHECKPT_INTERVAL = 1000;
+
+/**
+ * BlockFilterIndex is used to store and retrieve block filters, hashes, and
+ * headers for a range of blocks by height. An index is constructed for each
+ * supported filter type with its own database (ie. filter data for different
+ * types are stored in separate databases).
+ *
+ * The filters themselves are appended to flat files (indexes/blockfilter/<type>/fltr?????.dat), and the database
+ * records, for every block ever connected to the main chain, the filter hash, the filter header and the position of
+ * the filter on disk.
+ *
+ * This index is used to serve BIP 157 net requests.
+ */
+class BlockFilterIndex final : public BaseIndex {
+    class DB;
+
+    const BlockFilterType m_filter_type;
+    const std::unique_ptr<DB> m_db;
+
+    FlatFilePos m_next_filter_pos;
+    const std::unique_ptr<FlatFileSeq> m_filter_fileseq;
+
+    bool ReadFilterFromDisk(const FlatFilePos &pos, BlockFilter &filter) const;
+    size_t WriteFilterToDisk(FlatFilePos &pos, const BlockFilter &filter);
+
+    /// Build the filter for `pindex`, reading the block and its undo data from disk if `block` is null.
+    bool BuildFilter(const CBlockIndex *pindex, const CBlock *block, BlockFilter &filter) const;
+
+    /// Append `filter`, the filter of `pindex`, to the filter files and record it in the database.
+    bool WriteFilter(const CBlockIndex *pindex, const BlockFilter &filter);
+
+    Mutex m_cs_headers_cache;
+    /// Cache of filter headers at checkpoint heights (see CFCHECKPT_INTERVAL), keyed by block hash.
+    std::unordered_map<BlockHash, uint256, SaltedUint256Hasher> m_headers_cache GUARDED_BY(m_cs_headers_cache);
+
+protected:
+    bool Init() override;
+
+    bool CommitInternal(CDBBatch &batch) override;
+
+    bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) override;
+
+    /// Builds the filters of the batch in parallel, then writes them in order.
+    bool WriteBlocks(const std::vector<const CBlockIndex *> &pindexes) override;
+
+    BaseIndex::DB &GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit BlockFilterIndex(BlockFilterType filter_type, size_t n_cache_size, bool f_memory = false,
+                              bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~BlockFilterIndex() override;
+
+    BlockFilterType GetFilterType() const { return m_filter_type; }
+
+    /// Get a single filter by block.
+    bool LookupFilter(const CBlockIndex *block_index, BlockFilter &filter_out) const;
+
+    /// Get a single filter header by block.
+    bool LookupFilterHeader(const CBlockIndex *block_index, uint256 &header_out);
+
+    /// Get a range of filters between two heights on a chain.
+    bool LookupFilterRange(int start_height, const CBlockIndex *stop_index,
+                           std::vector<BlockFilter> &filters_out) const;
+
+    /// Get a range of filter hashes between two heights on a chain.
+    bool LookupFilterHashRange(int start_height, const CBlockIndex *stop_index,
+                               std::vector<uint256> &hashes_out) const;
+};
+
+/**
+ * Get a block filter index by type. Returns nullptr if index has not been
+ * initialized or was already destroyed.
+ */
+BlockFilterIndex *GetBlockFilterIndex(BlockFilterType filter_type);
+
+/** Iterate over all running block filter indexes, invoking fn on each. */
+void ForEachBlockFilterIndex(std::function<void(BlockFilterIndex &)> fn);
+
+/**
+ * Initialize a block filter index for the given type if one does not already
+ * exist. Returns true if a new index is created and false if one has already
+ * been initialized.
+ */
+bool InitBlockFilterIndex(BlockFilterType filter_type, size_t n_cache_size, bool f_memory = false,
+                          bool f_wipe = false);
+
+/**
+ * Destroy the block filter index with the given type. Returns false if no such
+ * index exists. This just releases the allocated memory and closes the
+ * database connection, it does not delete the index data.
+ */
+bool DestroyBlockFilterIndex(BlockFilterType filter_type);
+
+/** Destroy all open block filter indexes. */
+void DestroyAllBlockFilterIndexes();
@@ -0,0 +1,171 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/spentindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <config.h>
+#include <dbwrapper.h>
+#include <node/blockstorage.h>
+#include <txdb.h>
+#include <util/system.h>
+#include <validation.h>
+
+/* The index database holds one entry per spent output, with the type [DB_SPENT, COutPoint] and the spending txid,
+ * input index and block height as value.
+ *
+ * The best block locator is written in the same batch as the entries of the block it points to, so that the database
+ * never holds entries past its best block, which a later rewind would not know about.
+ */
+namespace {
+
+inline constexpr uint8_t DB_SPENT{'s'};
+
+/// Number of blocks that ThreadSync() hands to WriteBlocks() at once.
+constexpr size_t SYNC_BATCH_BLOCKS = 128;
+
+struct DBKey {
+    COutPoint outpoint;
+
+    DBKey() = default;
+    explicit DBKey(const COutPoint &outpoint_in) : outpoint(outpoint_in) {}
+
+    SERIALIZE_METHODS(DBKey, obj) {
+        uint8_t prefix;
+        SER_WRITE(obj, prefix = DB_SPENT);
+        READWRITE(prefix);
+        if (prefix != DB_SPENT) {
+            throw std::ios_base::failure("Invalid format for spent index DB key");
+        }
+
+        READWRITE(obj.outpoint);
+    }
+};
+
+struct DBVal {
+    TxId txid;
+    uint32_t input_index{0};
+    uint32_t height{0};
+
+    DBVal() = default;
+    DBVal(const TxId &txid_in, uint32_t input_index_in, uint32_t height_in)
+        : txid(txid_in), input_index(input_index_in), height(height_in) {}
+
+    SERIALIZE_METHODS(DBVal, obj) { READWRITE(obj.txid, VARINT(obj.input_index), VARINT(obj.height)); }
+};
+
+void WriteEntries(CDBBatch &batch, const CBlock &block, uint32_t height) {
+    for (const CTransactionRef &tx : block.vtx) {
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+        for (size_t n = 0; n < tx->vin.size(); ++n) {
+            batch.Write(DBKey(tx->vin[n].prevout), DBVal(tx->GetId(), n, height));
+        }
+    }
+}
+
+void EraseEntries(CDBBatch &batch, const CBlock &block) {
+    for (const CTransactionRef &tx : block.vtx) {
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+        for (const CTxIn &txin : tx->vin) {
+            batch.Erase(DBKey(txin.prevout));
+        }
+    }
+}
+
+} // namespace
+
+std::unique_ptr<SpentIndex> g_spent_index;
+
+/**
+ * Access to the spent index database (indexes/spentindex/)
+ */
+class SpentIndex::DB : public BaseIndex::DB {
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false)
+        : BaseIndex::DB(GetDataDir() / "indexes" / "spentindex", n_cache_size, f_memory, f_wipe) {}
+};
+
+SpentIndex::SpentIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex("spentindex"), m_db(std::make_unique<SpentIndex::DB>(n_cache_size, f_memory, f_wipe)) {}
+
+SpentIndex::~SpentIndex() {}
+
+BaseIndex::DB &SpentIndex::GetDB() const {
+    return *m_db;
+}
+
+bool SpentIndex::WriteBlock(const CBlock &block, const CBlockIndex *pindex) {
+    CDBBatch batch(*m_db);
+    WriteEntries(batch, block, pindex->nHeight);
+    m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return ::ChainActive().GetLocator(pindex)));
+    return m_db->WriteBatch(batch);
+}
+
+bool SpentIndex::WriteBlocks(const std::vector<const CBlockIndex *> &pindexes) {
+    const Consensus::Params &consensus_params = GetConfig().GetChainParams().GetConsensus();
+    const size_t batch_size = gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+    CDBBatch batch(*m_db);
+    for (size_t i = 0; i < pindexes.size(); ++i) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindexes[i], consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__, pindexes[i]->GetBlockHash().ToString());
+        }
+        WriteEntries(batch, block, pindexes[i]->nHeight);
+        if (i + 1 == pindexes.size() || batch.SizeEstimate() > batch_size) {
+            m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return ::ChainActive().GetLocator(pindexes[i])));
+            if (!m_db->WriteBatch(batch)) {
+                return error("%s: Failed to write entries of block %s", __func__,
+                             pindexes[i]->GetBlockHash().ToString());
+            }
+            batch.Clear();
+        }
+    }
+    return true;
+}
+
+size_t SpentIndex::GetSyncBatchSize() const {
+    return SYNC_BATCH_BLOCKS;
+}
+
+bool SpentIndex::Rewind(const CBlockIndex *current_tip, const CBlockIndex *new_tip,
+                        const CBlock *current_tip_block) {
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // An output is spent at most once in a chain, so erasing the entries of the rewound blocks cannot touch the entry
+    // of a block that stays.
+    const Consensus::Params &consensus_params = GetConfig().GetChainParams().GetConsensus();
+    CDBBatch batch(*m_db);
+    for (const CBlockIndex *pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        if (pindex == current_tip && current_tip_block) {
+            EraseEntries(batch, *current_tip_block);
+            continue;
+        }
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to rewind %s past block %s", __func__, GetName(),
+                         pindex->GetBlockHash().ToString());
+        }
+        EraseEntries(batch, block);
+    }
+    m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return ::ChainActive().GetLocator(new_tip)));
+    if (!m_db->WriteBatch(batch)) {
+        return error("%s: Failed to rewind %s to block %s", __func__, GetName(), new_tip->GetBlockHash().ToString());
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip, current_tip_block);
+}
+
+bool SpentIndex::FindSpender(const COutPoint &outpoint, SpentIndexEntry &entry_out) const {
+    DBVal value;
+    if (!m_db->Read(DBKey(outpoint), value)) {
+        return false;
+    }
+    entry_out = {value.txid, value.input_index, static_cast<int>(value.height)};
+    return true;
+}
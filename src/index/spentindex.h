@@ -0,0 +1,61 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <index/base.h>
+#include <primitives/transaction.h>
+#include <primitives/txid.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+static constexpr bool DEFAULT_SPENTINDEX = false;
+
+/// The confirmed transaction input that spends an output.
+struct SpentIndexEntry {
+    TxId txid;
+    uint32_t input_index;
+    int height;
+};
+
+/**
+ * SpentIndex maps every output spent in the active chain to the transaction input that spends it, and the height of
+ * the block containing that transaction.
+ *
+ * The entries of a block are written in the same batch as the best block locator, and are removed again when the
+ * block is disconnected, so that the index never answers with a spender from a stale block.
+ */
+class SpentIndex final : public BaseIndex {
+    class DB;
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) override;
+
+    /// Reads the blocks one at a time, and writes their entries in batches of at most -dbbatchsize bytes.
+    bool WriteBlocks(const std::vector<const CBlockIndex *> &pindexes) override;
+
+    size_t GetSyncBatchSize() const override;
+
+    /// Removes the entries of the blocks after `new_tip`.
+    bool Rewind(const CBlockIndex *current_tip, const CBlockIndex *new_tip,
+                const CBlock *current_tip_block) override;
+
+    BaseIndex::DB &GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SpentIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~SpentIndex() override;
+
+    /// Look up the input that spends `outpoint`. Returns false if the output is not spent in the indexed chain.
+    bool FindSpender(const COutPoint &outpoint, SpentIndexEntry &entry_out) const;
+};
+
+/// The global spent output index. May be null.
+extern std::unique_ptr<SpentIndex> g_spent_index;
@@ -13,6 +13,7 @@
 #include <addrman.h>
 #include <amount.h>
 #include <banman.h>
+#include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -28,7 +29,10 @@
 #include <hash.h>
 #include <httprpc.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
+#include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <key.h>
@@ -64,6 +68,7 @@
 #include <util/system.h>
 #include <util/thread.h>
 #include <util/threadnames.h>
+#include <utxosync/backgroundvalidation.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <walletinitinterface.h>
@@ -83,6 +88,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <set>
 #include <thread>
 
 #ifdef ENABLE_WALLET
@@ -111,6 +117,9 @@ std::unique_ptr<BanMan> g_banman;
 
 static const char *const DEFAULT_ASMAP_FILENAME = "ip_asn.map";
 
+/// The block filter types enabled with -blockfilterindex
+static std::set<BlockFilterType> g_enabled_filter_types;
+
 /**
  * The PID file facilities.
  */
@@ -213,6 +222,13 @@ void Interrupt() {
     if (g_coin_stats_index) {
         g_coin_stats_index->Interrupt();
     }
+    if (g_address_index) {
+        g_address_index->Interrupt();
+    }
+    if (g_spent_index) {
+        g_spent_index->Interrupt();
+    }
+    ForEachBlockFilterIndex([](BlockFilterIndex &index) { index.Interrupt(); });
 }
 
 void Shutdown(NodeContext &node) {
@@ -253,6 +269,14 @@ void Shutdown(NodeContext &node) {
     if (g_coin_stats_index) {
         g_coin_stats_index->Stop();
     }
+    if (g_address_index) {
+        g_address_index->Stop();
+    }
+    if (g_spent_index) {
+        g_spent_index->Stop();
+    }
+    ForEachBlockFilterIndex([](BlockFilterIndex &index) { index.Stop(); });
+    utxosync::StopBackgroundValidation();
 
     StopTorControl();
 
@@ -274,6 +298,9 @@ void Shutdown(NodeContext &node) {
     g_connman.reset();
     g_banman.reset();
     g_txindex.reset();
+    g_address_index.reset();
+    g_spent_index.reset();
+    DestroyAllBlockFilterIndexes();
 
     if (::g_mempool.IsLoaded() &&
         gArgs.GetArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
@@ -550,6 +577,11 @@ void SetupServerArgs() {
                            "hours (default: %u)",
                            DEFAULT_MEMPOOL_EXPIRY_TASK_PERIOD),
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-mmapblockreads",
+                 strprintf("Read blocks through memory mappings of the block files, and serve raw blocks to peers "
+                           "straight from the mappings without copying them (default: %d)",
+                           DEFAULT_MMAP_BLOCK_READS),
+                 ArgsManager::ALLOW_BOOL, OptionsCategory::OPTIONS);
     gArgs.AddArg(
         "-minimumchainwork=<hex>",
         strprintf(
@@ -630,6 +662,21 @@ void SetupServerArgs() {
     gArgs.AddArg("-coinstatsindex",
                  strprintf("Maintain coinstats index used by the gettxoutsetinfo RPC (default: %u)", DEFAULT_COINSTATSINDEX),
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-addressindex",
+                 strprintf("Maintain an index of the transaction history and unspent outputs of every script, used by "
+                           "the getaddresshistory and getaddressutxos RPC calls (default: %u)",
+                           DEFAULT_ADDRESSINDEX),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-spentindex",
+                 strprintf("Maintain an index of the transaction inputs that spend confirmed outputs, used by the "
+                           "getspentby RPC call (default: %u)",
+                           DEFAULT_SPENTINDEX),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockfilterindex=<type>",
+                 strprintf("Maintain an index of compact filters by block (default: %s, values: %s).",
+                           DEFAULT_BLOCKFILTERINDEX, ListBlockFilterTypes()) +
+                     " If <type> is not supplied or if <type> = 1, indexes for all known types are enabled.",
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg(
         "-usecashaddr",
         strprintf("Use CashAddr address format for destination encoding "
@@ -729,6 +776,13 @@ void SetupServerArgs() {
                   "backward by this amount. (default: %u seconds)",
                   DEFAULT_MAX_TIME_ADJUSTMENT),
         ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    gArgs.AddArg(
+        "-msghandthreads=<n>",
+        strprintf("Set the number of threads that process peer messages, each "
+                  "peer always being serviced by the same thread (up to %d, 0 "
+                  "= auto, default: %d)",
+                  MAX_MSGHAND_THREADS, DEFAULT_MSGHAND_THREADS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     gArgs.AddArg("-onion=<ip:port>",
                  strprintf("Use separate SOCKS5 proxy to reach peers via Tor onion services (default: %s)", "-proxy"),
                  ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
@@ -740,6 +794,10 @@ void SetupServerArgs() {
                            "bloom filters (default: %d)",
                            DEFAULT_PEERBLOOMFILTERS),
                  ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-peerblockfilters",
+                 strprintf("Serve compact block filters to peers per BIP 157 (default: %u)",
+                           DEFAULT_PEERBLOCKFILTERS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     gArgs.AddArg("-port=<port>",
                  strprintf("Listen for connections on <port> (default: %u, "
                            "testnet: %u, testnet4: %u, scalenet: %u, chipnet: %u, regtest: %u)",
@@ -772,6 +830,14 @@ void SetupServerArgs() {
                   "the connection to it is dropped. (minimum: 1, default: %d)",
                   DEFAULT_PEER_CONNECT_TIMEOUT),
         ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::CONNECTION);
+#ifdef USE_EPOLL
+    gArgs.AddArg("-useepoll",
+                 strprintf("Use epoll instead of poll to wait for network socket events (default: %d)",
+                           DEFAULT_USE_EPOLL),
+                 ArgsManager::ALLOW_BOOL | ArgsManager::DEBUG_ONLY, OptionsCategory::CONNECTION);
+#else
+    hidden_args.emplace_back("-useepoll");
+#endif
     gArgs.AddArg(
         "-torcontrol=<ip>:<port>",
         strprintf(
@@ -861,6 +927,14 @@ void SetupServerArgs() {
     gArgs.AddArg("-zmqpubrawds=<address>",
                  "Enable publish raw double spend transaction in <address>", ArgsManager::ALLOW_ANY,
                  OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqqueuesize=<n>",
+                 strprintf("Maximum number of notifications waiting to be published. Further notifications are "
+                           "dropped until the queue drains (default: %u)", DEFAULT_ZMQ_QUEUE_SIZE),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqtxbatchsize=<n>",
+                 strprintf("Publish up to <n> waiting transactions in a single hashtx or rawtx message, with one "
+                           "message part per transaction (default: %u)", DEFAULT_ZMQ_TX_BATCH_SIZE),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
@@ -868,6 +942,8 @@ void SetupServerArgs() {
     hidden_args.emplace_back("-zmqpubrawtx=<address>");
     hidden_args.emplace_back("-zmqpubhashds=<address>");
     hidden_args.emplace_back("-zmqpubrawds=<address>");
+    hidden_args.emplace_back("-zmqqueuesize=<n>");
+    hidden_args.emplace_back("-zmqtxbatchsize=<n>");
 #endif
 
     gArgs.AddArg("-allowunconnectedmining",
@@ -1658,11 +1734,34 @@ bool AppInitParameterInteraction(Config &config) {
                 strprintf("Error creating index directory: %s", e.what()));
     }
 
-    // if using block pruning, then disallow txindex
+    // parse and validate enabled filter types
+    const std::string blockfilterindex_value = gArgs.GetArg("-blockfilterindex", DEFAULT_BLOCKFILTERINDEX);
+    if (blockfilterindex_value == "" || blockfilterindex_value == "1") {
+        g_enabled_filter_types = AllBlockFilterTypes();
+    } else if (blockfilterindex_value != "0") {
+        for (const std::string &name : gArgs.GetArgs("-blockfilterindex")) {
+            BlockFilterType filter_type;
+            if (!BlockFilterTypeByName(name, filter_type)) {
+                return InitError(strprintf(_("Unknown -blockfilterindex value %s."), name));
+            }
+            g_enabled_filter_types.insert(filter_type);
+        }
+    }
+
+    // if using block pruning, then disallow txindex, addressindex, spentindex and the block filter indexes
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
             return InitError(_("Prune mode is incompatible with -txindex."));
         }
+        if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
+            return InitError(_("Prune mode is incompatible with -addressindex."));
+        }
+        if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+            return InitError(_("Prune mode is incompatible with -spentindex."));
+        }
+        if (!g_enabled_filter_types.empty()) {
+            return InitError(_("Prune mode is incompatible with -blockfilterindex."));
+        }
     }
 
     // -bind and -whitebind can't be set when not listening
@@ -1742,6 +1841,7 @@ bool AppInitParameterInteraction(Config &config) {
     fCheckBlockIndex = gArgs.GetBoolArg("-checkblockindex",
                                         chainparams.DefaultConsistencyChecks());
     fCheckBlockReads = gArgs.GetBoolArg("-checkblockreads", chainparams.DefaultConsistencyChecks());
+    fMmapBlockReads = gArgs.GetBoolArg("-mmapblockreads", DEFAULT_MMAP_BLOCK_READS);
     fCheckpointsEnabled =
         gArgs.GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
     if (fCheckpointsEnabled) {
@@ -1986,6 +2086,13 @@ bool AppInitParameterInteraction(Config &config) {
         nLocalServices = ServiceFlags(nLocalServices | NODE_BLOOM);
     }
 
+    // NODE_CF is only signalled once the basic filters index is in sync, see
+    // AppInitMain().
+    if (gArgs.GetBoolArg("-peerblockfilters", DEFAULT_PEERBLOCKFILTERS) &&
+        g_enabled_filter_types.count(BlockFilterType::BASIC) != 1) {
+        return InitError(_("Cannot set -peerblockfilters without -blockfilterindex."));
+    }
+
     // Signal Bitcoin Cash support.
     // TODO: remove some time after the hardfork when no longer needed
     // to differentiate the network nodes.
@@ -2523,6 +2630,23 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
                                       ? nMaxTxIndexCache << 20
                                       : 0);
     nTotalCache -= nTxIndexCache;
+    const int64_t address_index_cache =
+        std::min(nTotalCache / 8, gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)
+                                      ? max_address_index_cache << 20
+                                      : 0);
+    nTotalCache -= address_index_cache;
+    const int64_t spent_index_cache =
+        std::min(nTotalCache / 8, gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)
+                                      ? max_spent_index_cache << 20
+                                      : 0);
+    nTotalCache -= spent_index_cache;
+    int64_t filter_index_cache = 0;
+    if (!g_enabled_filter_types.empty()) {
+        const size_t n_indexes = g_enabled_filter_types.size();
+        const int64_t max_cache = std::min(nTotalCache / 8, max_filter_index_cache << 20);
+        filter_index_cache = max_cache / n_indexes;
+        nTotalCache -= filter_index_cache * n_indexes;
+    }
     // use 25%-50% of the remainder for disk cache
     int64_t nCoinDBCache =
         std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23));
@@ -2539,6 +2663,19 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         LogPrintf("* Using %.1fMiB for transaction index database\n",
                   nTxIndexCache * (1.0 / 1024 / 1024));
     }
+    if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
+        LogPrintf("* Using %.1fMiB for address index database\n",
+                  address_index_cache * (1.0 / 1024 / 1024));
+    }
+    if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+        LogPrintf("* Using %.1fMiB for spent index database\n",
+                  spent_index_cache * (1.0 / 1024 / 1024));
+    }
+    for (BlockFilterType filter_type : g_enabled_filter_types) {
+        LogPrintf("* Using %.1fMiB for %s block filter index database\n",
+                  filter_index_cache * (1.0 / 1024 / 1024),
+                  BlockFilterTypeName(filter_type));
+    }
     LogPrintf("* Using %.1fMiB for chain state database\n",
               nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of "
@@ -2612,6 +2749,33 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
                     break;
                 }
 
+                // The blocks below a UTXO snapshot were never downloaded, so
+                // the chainstate can't be rebuilt from them, and the indexes
+                // can't be built at all.
+                if (pindexSnapshotBase && fReindexChainState) {
+                    strLoadError =
+                        _("The chainstate was loaded from a UTXO snapshot and "
+                          "cannot be rebuilt from the block files. Use "
+                          "-reindex to redownload the entire blockchain");
+                    break;
+                }
+                if (pindexSnapshotBase &&
+                    (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ||
+                     gArgs.GetBoolArg("-coinstatsindex",
+                                      DEFAULT_COINSTATSINDEX) ||
+                     gArgs.GetBoolArg("-addressindex",
+                                      DEFAULT_ADDRESSINDEX) ||
+                     gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ||
+                     !g_enabled_filter_types.empty())) {
+                    strLoadError =
+                        _("The chainstate was loaded from a UTXO snapshot, "
+                          "which is incompatible with -txindex, "
+                          "-coinstatsindex, -addressindex, -spentindex and "
+                          "-blockfilterindex. Use -reindex to redownload the "
+                          "entire blockchain");
+                    break;
+                }
+
                 // At this point blocktree args are consistent with what's on
                 // disk. If we're not mid-reindex (based on disk + args), add a
                 // genesis block on disk (otherwise we use the one already on
@@ -2753,6 +2917,22 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         g_coin_stats_index = std::make_unique<CoinStatsIndex>(/* cache size = */ 0, false, fReindex);
         g_coin_stats_index->Start();
     }
+    if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
+        g_address_index = std::make_unique<AddressIndex>(address_index_cache, false, fReindex);
+        g_address_index->Start();
+    }
+    if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+        g_spent_index = std::make_unique<SpentIndex>(spent_index_cache, false, fReindex);
+        g_spent_index->Start();
+    }
+    for (const BlockFilterType &filter_type : g_enabled_filter_types) {
+        InitBlockFilterIndex(filter_type, filter_index_cache, false, fReindex);
+        GetBlockFilterIndex(filter_type)->Start();
+    }
+    // Validate the history below the UTXO snapshot that the chainstate was loaded from, if any
+    if (!WITH_LOCK(cs_main, return utxosync::StartBackgroundValidation(config, false))) {
+        return InitError(_("Error opening the background chainstate"));
+    }
 
     // Step 9: load wallet
     for (const auto &client : node.chain_clients) {
@@ -2773,6 +2953,11 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
             PruneAndFlush();
         }
     }
+    if (WITH_LOCK(cs_main, return pindexSnapshotBase != nullptr)) {
+        LogPrintf("Unsetting NODE_NETWORK, the chainstate was loaded from a "
+                  "UTXO snapshot\n");
+        nLocalServices = ServiceFlags(nLocalServices & ~NODE_NETWORK);
+    }
 
     // Step 11: import blocks
     if (!CheckDiskSpace(GetDataDir())) {
@@ -2872,6 +3057,12 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
     connOptions.nMaxOutboundTimeframe = nMaxOutboundTimeframe;
     connOptions.nMaxOutboundLimit = nMaxOutboundLimit;
     connOptions.m_peer_connect_timeout = peer_connect_timeout;
+    connOptions.m_use_epoll = gArgs.GetBoolArg("-useepoll", DEFAULT_USE_EPOLL);
+    connOptions.nMsgHandThreads = gArgs.GetArg("-msghandthreads", DEFAULT_MSGHAND_THREADS);
+    if (connOptions.nMsgHandThreads <= 0) {
+        // -msghandthreads=0 means autodetect (one thread per core, up to AUTO_MAX_MSGHAND_THREADS)
+        connOptions.nMsgHandThreads = std::min(GetNumCores(), AUTO_MAX_MSGHAND_THREADS);
+    }
 
     for (const std::string &bind_arg : gArgs.GetArgs("-bind")) {
         CService bind_addr;
@@ -2938,6 +3129,14 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         return false;
     }
 
+    // Signal NODE_CF only once the basic filters index has caught up with the
+    // block chain, as filter requests it cannot answer yet are dropped.
+    if (gArgs.GetBoolArg("-peerblockfilters", DEFAULT_PEERBLOCKFILTERS)) {
+        GetBlockFilterIndex(BlockFilterType::BASIC)->CallWhenSynced([] {
+            g_connman->AddLocalServices(NODE_CF);
+        });
+    }
+
     // Step 13: finished
 
     SetRPCWarmupFinished();
@@ -7,6 +7,7 @@
 
 #include <indirectmap.h>
 #include <prevector.h>
+#include <support/allocators/pool.h>
 #include <util/heapoptional.h>
 
 #include <cstdlib>
@@ -152,6 +153,20 @@ inline size_t DynamicUsage(const std::unordered_map<X, Y, Hasher, Eq, A> &m) {
            MallocUsage(sizeof(void *) * m.bucket_count());
 }
 
+template <typename X, typename Y, typename Hasher, typename Eq, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+inline size_t DynamicUsage(
+    const std::unordered_map<X, Y, Hasher, Eq,
+                             PoolAllocator<std::pair<const X, Y>, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>> &m) {
+    // Nodes live in the chunks of the pool resource, so account for whole
+    // chunks (plus the std::list node tracking each chunk) rather than for
+    // individual nodes. This includes memory sitting in the free lists.
+    const auto *const pool_resource = m.get_allocator().resource();
+    const size_t estimated_list_node_size = MallocUsage(sizeof(void *) * 3);
+    const size_t usage_resource = estimated_list_node_size * pool_resource->NumAllocatedChunks();
+    const size_t usage_chunks = MallocUsage(pool_resource->ChunkSizeBytes()) * pool_resource->NumAllocatedChunks();
+    return usage_resource + usage_chunks + MallocUsage(sizeof(void *) * m.bucket_count());
+}
+
 // Some of our utility wrappers
 
 template <typename T>
@@ -104,9 +104,74 @@ static BlockAssembler::Options DefaultOptions(const Config &config, const CBlock
 }
 
 BlockAssembler::BlockAssembler(const Config &_config, const CTxMemPool &_mempool, const std::optional<Options> &options)
-    : config(_config), mempool(_mempool), chainparams(_config.GetChainParams()), overrideOptions(options),
+    : config(_config), mempool(_mempool), chainparams(_config.GetChainParams()), incremental(nullptr),
+      overrideOptions(options), fPrintPriority(gArgs.GetBoolArg("-printpriority", DEFAULT_PRINTPRIORITY))  {}
+
+BlockAssembler::BlockAssembler(const Config &_config, IncrementalBlockTemplate &_incremental,
+                               const std::optional<Options> &options)
+    : config(_config), mempool(_incremental.GetMemPool()), chainparams(_config.GetChainParams()),
+      incremental(&_incremental), overrideOptions(options),
       fPrintPriority(gArgs.GetBoolArg("-printpriority", DEFAULT_PRINTPRIORITY))  {}
 
+IncrementalBlockTemplate::IncrementalBlockTemplate(CTxMemPool &_mempool, size_t _nMaxPendingAdded)
+    : mempool(_mempool), nMaxPendingAdded(_nMaxPendingAdded) {
+    m_connNotifyEntryAdded = _mempool.NotifyEntryAdded.connect(
+        std::bind(&IncrementalBlockTemplate::TransactionAddedToMempool, this, std::placeholders::_1));
+    m_connNotifyEntryRemoved = _mempool.NotifyEntryRemoved.connect(
+        std::bind(&IncrementalBlockTemplate::TransactionRemovedFromMempool, this, std::placeholders::_1,
+                  std::placeholders::_2));
+}
+
+void IncrementalBlockTemplate::TransactionAddedToMempool(CTransactionRef tx) {
+    LOCK(cs);
+    if (!fValid) {
+        return;
+    }
+    if (pendingAdded.size() >= nMaxPendingAdded) {
+        // Selecting from the whole mempool is cheaper than replaying this many additions.
+        Invalidate();
+        return;
+    }
+    pendingAdded.push_back(tx->GetId());
+}
+
+void IncrementalBlockTemplate::TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason) {
+    LOCK(cs);
+    if (!fValid) {
+        return;
+    }
+    if (reason == MemPoolRemovalReason::BLOCK || reason == MemPoolRemovalReason::REORG) {
+        // The tip is about to change, which needs a new template anyway.
+        Invalidate();
+        return;
+    }
+    const auto it = entries.find(tx->GetId());
+    if (it == entries.end()) {
+        // Not selected; if it is still pending it will just not be found in the mempool.
+        return;
+    }
+    if (fFull) {
+        // The freed up space may fit transactions that were left out before.
+        Invalidate();
+        return;
+    }
+    const Entry &entry = it->second;
+    nBlockSize -= entry.txSize;
+    nBlockSigChecks -= entry.templateEntry.sigChecks;
+    nFees -= entry.templateEntry.fees;
+    feeRates.erase(feeRates.find(entry.feeRate));
+    entries.erase(it);
+}
+
+void IncrementalBlockTemplate::Invalidate() {
+    fValid = false;
+    pindexPrev = nullptr;
+    mapDeltas.clear();
+    entries.clear();
+    feeRates.clear();
+    pendingAdded.clear();
+}
+
 void BlockAssembler::resetBlock() {
     // Reserve space for coinbase tx.
     nBlockSize = 1000;
@@ -115,6 +180,9 @@ void BlockAssembler::resetBlock() {
     // These counters do not include coinbase tx.
     nBlockTx = 0;
     nFees = Amount::zero();
+
+    fBlockFull = false;
+    fTimedOut = false;
 }
 
 std::unique_ptr<CBlockTemplate>
@@ -179,11 +247,19 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSe
         nAddTxsTimeLimit = nTimeStart + static_cast<int64_t>(addTxsFrac * timeLimitSecs * 1e6);
     }
 
-    addTxs(nAddTxsTimeLimit);
+    // The incremental template is kept in canonical order, so it can only be used when that is the block's order.
+    const bool fCanonicalOrder = IsMagneticAnomalyEnabled(consensusParams, pindexPrev);
+    const bool fIncremental = incremental && fCanonicalOrder && updateIncremental(pindexPrev);
+    if (!fIncremental) {
+        addTxs(nAddTxsTimeLimit);
+        if (incremental && fCanonicalOrder) {
+            resetIncremental(pindexPrev);
+        }
+    }
 
     const int64_t nTime0 = GetTimeMicros();
 
-    if (IsMagneticAnomalyEnabled(consensusParams, pindexPrev)) {
+    if (fCanonicalOrder && !fIncremental) {
         // If magnetic anomaly is enabled, we make sure transaction are
         // canonically ordered.
         std::sort(std::begin(pblocktemplate->entries) + 1,
@@ -254,15 +330,18 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSe
     // Save time taken by addTxs() vs total time taken
     const int64_t elapsedAddTxs = nTime0 - nTimeStart;
     const int64_t elapsedTotal = nTime2 - nTimeStart;
-    // Adjust addTxsFrac based on elapsedAddTxs this run, using an EMA with alpha = 25% for non-tiny blocks
-    const double alpha = pblock->vtx.size() > 50 ? 0.25 : 0.05;
-    const double thisAddTxsFrac = elapsedTotal > 0 ? std::clamp(elapsedAddTxs / double(elapsedTotal), 0., 1.) : 0.;
-    addTxsFrac = addTxsFrac * (1. - alpha) + thisAddTxsFrac * alpha;
+    if (!fIncremental) {
+        // Adjust addTxsFrac based on elapsedAddTxs this run, using an EMA with alpha = 25% for non-tiny blocks.
+        // Incremental updates are left out, as they don't tell how long a full selection would take.
+        const double alpha = pblock->vtx.size() > 50 ? 0.25 : 0.05;
+        const double thisAddTxsFrac = elapsedTotal > 0 ? std::clamp(elapsedAddTxs / double(elapsedTotal), 0., 1.) : 0.;
+        addTxsFrac = addTxsFrac * (1. - alpha) + thisAddTxsFrac * alpha;
+    }
 
     LogPrint(BCLog::BENCH,
-             "CreateNewBlock() addTxs: %.2fms, "
+             "CreateNewBlock() %s: %.2fms, "
              "CTOR: %.2fms, validity: %.2fms (total %.2fms), addTxsFrac: %1.2f, timeLimitSecs: %1.3f\n",
-             0.001 * elapsedAddTxs,
+             fIncremental ? "incremental update" : "addTxs", 0.001 * elapsedAddTxs,
              0.001 * (nTime1 - nTime0), 0.001 * (nTime2 - nTime1),
              0.001 * elapsedTotal, addTxsFrac, timeLimitSecs);
 
@@ -393,6 +472,7 @@ void BlockAssembler::addTxs(int64_t nLimitTimePoint) {
 
         // Check whether the tx will exceed the block limits.
         if (!TestTx(iter->GetTxSize(), iter->GetSigChecks())) {
+            fBlockFull = true;
             ++nConsecutiveFailed;
             if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockSize > nMaxGeneratedBlockSize - 1000) {
                 // Give up if we're close to full and haven't succeeded in a while.
@@ -430,6 +510,128 @@ void BlockAssembler::addTxs(int64_t nLimitTimePoint) {
             }
         }
     }
+
+    if (TimedOut()) {
+        fTimedOut = true;
+    }
+}
+
+bool BlockAssembler::updateIncremental(const CBlockIndex *pindexPrev) {
+    LOCK(incremental->cs);
+    if (!incremental->fValid || incremental->pindexPrev != pindexPrev ||
+        incremental->nMaxGeneratedBlockSize != nMaxGeneratedBlockSize ||
+        incremental->nMaxGeneratedBlockSigChecks != nMaxGeneratedBlockSigChecks ||
+        incremental->blockMinFeeRate != blockMinFeeRate || incremental->mapDeltas != mempool.mapDeltas) {
+        return false;
+    }
+
+    // Look up the transactions that are still in the mempool, and process them in the order they were added, so that
+    // parents come before their children.
+    std::vector<CTxMemPool::txiter> added;
+    added.reserve(incremental->pendingAdded.size());
+    for (const TxId &txid : incremental->pendingAdded) {
+        if (auto it = mempool.mapTx.find(txid); it != mempool.mapTx.end()) {
+            added.push_back(it);
+        }
+    }
+    const auto entryIdLess = [](CTxMemPool::txiter a, CTxMemPool::txiter b) {
+        return a->GetEntryId() < b->GetEntryId();
+    };
+    std::sort(added.begin(), added.end(), entryIdLess);
+    // A transaction may have been removed and added again.
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+
+    nBlockSize = incremental->nBlockSize;
+    nBlockSigChecks = incremental->nBlockSigChecks;
+    nFees = incremental->nFees;
+    bool fFull = incremental->fFull;
+    std::vector<CTxMemPool::txiter> selected;
+    for (const CTxMemPool::txiter iter : added) {
+        if (incremental->entries.count(iter->GetTx().GetId())) {
+            continue;
+        }
+        const CFeeRate feeRate = iter->GetModifiedFeeRate();
+        if (feeRate < blockMinFeeRate) {
+            continue;
+        }
+        // Like addTxs(), only select transactions whose mempool parents are all selected.
+        const auto parents = mempool.GetMemPoolParents(iter);
+        if (!std::all_of(parents.begin(), parents.end(), [&](CTxMemPool::txiter parent) {
+                return incremental->entries.count(parent->GetTx().GetId()) ||
+                       std::binary_search(selected.begin(), selected.end(), parent, entryIdLess);
+            })) {
+            continue;
+        }
+        if (!TestTx(iter->GetTxSize(), iter->GetSigChecks())) {
+            if (!incremental->feeRates.empty() && *incremental->feeRates.begin() < feeRate) {
+                // It pays better than some transaction that got in, so a full selection would pick it.
+                resetBlock();
+                return false;
+            }
+            fFull = true;
+            continue;
+        }
+        if (!CheckTx(iter->GetTx())) {
+            continue;
+        }
+        nBlockSize += iter->GetTxSize();
+        nBlockSigChecks += iter->GetSigChecks();
+        nFees += iter->GetFee();
+        selected.push_back(iter);
+    }
+
+    // Nothing can fail from here on, so commit the additions to the template.
+    for (const CTxMemPool::txiter iter : selected) {
+        const CFeeRate feeRate = iter->GetModifiedFeeRate();
+        incremental->entries.emplace(
+            iter->GetTx().GetId(),
+            IncrementalBlockTemplate::Entry{{iter->GetSharedTx(), iter->GetFee(), iter->GetSigChecks()},
+                                            iter->GetTxSize(), feeRate});
+        incremental->feeRates.insert(feeRate);
+        if (fPrintPriority) {
+            LogPrintf("fee %s txid %s\n", feeRate.ToString(), iter->GetTx().GetId().ToString());
+        }
+    }
+    incremental->nBlockSize = nBlockSize;
+    incremental->nBlockSigChecks = nBlockSigChecks;
+    incremental->nFees = nFees;
+    incremental->fFull = fFull;
+    incremental->pendingAdded.clear();
+    ++incremental->nIncrementalUpdates;
+
+    pblocktemplate->entries.reserve(incremental->entries.size() + 1);
+    for (const auto &[txid, entry] : incremental->entries) {
+        pblocktemplate->entries.push_back(entry.templateEntry);
+    }
+    nBlockTx = incremental->entries.size();
+    return true;
+}
+
+void BlockAssembler::resetIncremental(const CBlockIndex *pindexPrev) {
+    LOCK(incremental->cs);
+    incremental->Invalidate();
+    ++incremental->nFullBuilds;
+    if (fTimedOut) {
+        // Transactions were left out that the template can't tell apart from ones it has seen and rejected.
+        return;
+    }
+    for (auto it = pblocktemplate->entries.begin() + 1; it != pblocktemplate->entries.end(); ++it) {
+        const auto mi = mempool.mapTx.find(it->tx->GetId());
+        assert(mi != mempool.mapTx.end());
+        const CFeeRate feeRate = mi->GetModifiedFeeRate();
+        incremental->entries.emplace(it->tx->GetId(), IncrementalBlockTemplate::Entry{*it, mi->GetTxSize(), feeRate});
+        incremental->feeRates.insert(feeRate);
+    }
+    incremental->fValid = true;
+    incremental->pindexPrev = pindexPrev;
+    incremental->nMaxGeneratedBlockSize = nMaxGeneratedBlockSize;
+    incremental->nMaxGeneratedBlockSigChecks = nMaxGeneratedBlockSigChecks;
+    incremental->blockMinFeeRate = blockMinFeeRate;
+    incremental->mapDeltas = mempool.mapDeltas;
+    incremental->nBlockSize = nBlockSize;
+    incremental->nBlockSigChecks = nBlockSigChecks;
+    incremental->nFees = nFees;
+    incremental->fFull = fBlockFull;
 }
 
 static
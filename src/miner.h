@@ -7,14 +7,19 @@
 #pragma once
 
 #include <primitives/block.h>
+#include <sync.h>
 #include <txmempool.h>
 
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
+#include <boost/signals2/connection.hpp>
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <optional>
+#include <set>
+#include <vector>
 
 class CBlockIndex;
 class CChainParams;
@@ -42,7 +47,91 @@ struct CBlockTemplate {
     std::vector<CBlockTemplateEntry> entries;
 };
 
+/**
+ * The transaction selection of the last block template, kept up to date with
+ * mempool additions and removals as they happen.
+ *
+ * A BlockAssembler constructed with an IncrementalBlockTemplate only selects
+ * transactions from the whole mempool if the chain tip, the block options or
+ * the fee prioritisations changed since the last template, or if a change
+ * can't be applied incrementally (e.g. space freed up in a full template, or a
+ * better paying transaction that doesn't fit). Otherwise it just applies the
+ * mempool changes that happened in the meantime.
+ *
+ * The template is only maintained once the chain has canonical transaction
+ * ordering, as that lets it keep the transactions sorted by txid as they come
+ * in.
+ */
+class IncrementalBlockTemplate {
+public:
+    //! Default number of mempool additions to queue up before the template is
+    //! dropped in favour of a selection from the whole mempool
+    static constexpr size_t DEFAULT_MAX_PENDING_ADDED = 100'000;
+
+    /// Invariant: `_mempool` must outlive this instance.
+    explicit IncrementalBlockTemplate(CTxMemPool &_mempool, size_t _nMaxPendingAdded = DEFAULT_MAX_PENDING_ADDED);
+
+    IncrementalBlockTemplate(const IncrementalBlockTemplate &) = delete;
+    IncrementalBlockTemplate &operator=(const IncrementalBlockTemplate &) = delete;
+
+    const CTxMemPool &GetMemPool() const { return mempool; }
+
+    //! Number of templates that were selected from the whole mempool
+    uint64_t GetFullBuilds() const { return WITH_LOCK(cs, return nFullBuilds); }
+    //! Number of templates that were updated from the previous one
+    uint64_t GetIncrementalUpdates() const { return WITH_LOCK(cs, return nIncrementalUpdates); }
+
+private:
+    friend class BlockAssembler;
+
+    struct Entry {
+        CBlockTemplateEntry templateEntry;
+        uint64_t txSize;
+        CFeeRate feeRate;
+    };
+
+    const CTxMemPool &mempool;
+    const size_t nMaxPendingAdded;
+
+    //! Taken after mempool.cs, as the mempool notifications are sent with it held.
+    mutable Mutex cs;
 
+    //! Whether the fields below describe a template that can be updated
+    bool fValid GUARDED_BY(cs){false};
+    const CBlockIndex *pindexPrev GUARDED_BY(cs){};
+    //! The BlockAssembler settings and fee deltas the template was built with
+    uint64_t nMaxGeneratedBlockSize GUARDED_BY(cs){};
+    uint64_t nMaxGeneratedBlockSigChecks GUARDED_BY(cs){};
+    CFeeRate blockMinFeeRate GUARDED_BY(cs);
+    std::map<TxId, Amount> mapDeltas GUARDED_BY(cs);
+
+    //! The selected transactions, in canonical (txid) order
+    std::map<TxId, Entry> entries GUARDED_BY(cs);
+    //! The modified feerates of all selected transactions
+    std::multiset<CFeeRate> feeRates GUARDED_BY(cs);
+    uint64_t nBlockSize GUARDED_BY(cs){};
+    uint64_t nBlockSigChecks GUARDED_BY(cs){};
+    Amount nFees GUARDED_BY(cs);
+    //! Whether a transaction was left out for lack of room in the block
+    bool fFull GUARDED_BY(cs){false};
+
+    //! Transactions added to the mempool since the template was last updated.
+    //! Holds at most nMaxPendingAdded entries: once that is exceeded, the
+    //! template is invalidated, as nobody asked for it in a long while.
+    std::vector<TxId> pendingAdded GUARDED_BY(cs);
+
+    uint64_t nFullBuilds GUARDED_BY(cs){};
+    uint64_t nIncrementalUpdates GUARDED_BY(cs){};
+
+    // Declared last, so that they are disconnected before anything else is destroyed
+    boost::signals2::scoped_connection m_connNotifyEntryAdded;
+    boost::signals2::scoped_connection m_connNotifyEntryRemoved;
+
+    void TransactionAddedToMempool(CTransactionRef tx);
+    void TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason);
+    //! Forget the template, so that the next one gets selected from the whole mempool
+    void Invalidate() EXCLUSIVE_LOCKS_REQUIRED(cs);
+};
 
 /** Generate a new block, without valid proof-of-work */
 class BlockAssembler {
@@ -77,9 +166,14 @@ private:
     int64_t nLockTimeCutoff{};
     int64_t nMedianTimePast{};
 
+    // Whether addTxs() left out a transaction for lack of room, or ran out of time
+    bool fBlockFull{};
+    bool fTimedOut{};
+
     const Config &config;
     const CTxMemPool &mempool;
     const CChainParams &chainparams;
+    IncrementalBlockTemplate *const incremental;
     /// If valid, options override for tests, otherwise we re-create options each call to CreateNewBlock().
     std::optional<Options> overrideOptions;
 
@@ -91,6 +185,10 @@ public:
     /// Invariant: `_config` and `_mempool` must be non-ephemeral objects and their lifetime must not be shorter than
     /// this instance's lifetime.
     BlockAssembler(const Config &_config, const CTxMemPool &_mempool, const std::optional<Options> &options = std::nullopt);
+    /// Assemble blocks from the mempool of `_incremental`, updating its template where possible instead of selecting
+    /// from the whole mempool. Invariant: `_incremental` must outlive this instance.
+    BlockAssembler(const Config &_config, IncrementalBlockTemplate &_incremental,
+                   const std::optional<Options> &options = std::nullopt);
 
     /**
      *  Construct a new block template with coinbase to scriptPubKeyIn
@@ -138,6 +236,19 @@ private:
 
     /// Check the transaction for finality, etc before adding to block
     bool CheckTx(const CTransaction &tx) const;
+
+    // Methods for maintaining the IncrementalBlockTemplate, if any.
+    /**
+     * Apply the mempool changes since the last template to the incremental
+     * template, and fill the block with its transactions.
+     * @returns false if the template can't be updated, in which case a full
+     *          rebuild is needed and nothing was changed.
+     */
+    bool updateIncremental(const CBlockIndex *pindexPrev)
+        EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
+    /** Replace the incremental template with the transactions selected by addTxs() */
+    void resetIncremental(const CBlockIndex *pindexPrev)
+        EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
 };
 
 /** Modify the extranonce in a block */
@@ -37,13 +37,19 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
 #include <limits>
 #include <optional>
 #include <type_traits>
 #include <unordered_map>
+#include <variant>
 
 // Dump addresses to peers.dat every 15 minutes (900s)
 static constexpr int DUMP_PEERS_INTERVAL = 15 * 60;
@@ -80,6 +86,14 @@ enum BindFlags {
 // The sleep time needs to be small to avoid new sockets stalling
 static const uint64_t SELECT_TIMEOUT_MILLISECONDS = 50;
 
+#ifdef USE_EPOLL
+// Maximum number of socket events to handle per epoll_wait() call
+static constexpr int EPOLL_MAX_EVENTS = 1024;
+// Tags the epoll data of listening sockets, whose lower bits are the index in
+// vhListenSocket. The data of connected sockets is the NodeId.
+static constexpr uint64_t EPOLL_LISTEN_SOCKET = uint64_t{1} << 63;
+#endif
+
 const static std::string NET_MESSAGE_TYPE_OTHER = "*other*";
 
 // SHA256("netgroup")[0:8]
@@ -736,7 +750,10 @@ size_t CConnman::SocketSendData(const NodeRef &pnode) const
     static_assert(std::numeric_limits<size_t>::max() >= static_cast<USendSizeT>(std::numeric_limits<SendSizeT>::max()),
                   "SendSizeT's maximum value must fit into a size_t");
 
-    for (const auto &data : pnode->vSendMsg) {
+    for (const auto &entry : pnode->vSendMsg) {
+        const Span<const uint8_t> data = std::visit([](const auto &bytes) {
+            return Span<const uint8_t>{bytes.data(), bytes.size()};
+        }, entry);
         assert(data.size() > pnode->nSendOffset);
         SendSizeT nBytes = 0;
 
@@ -1108,6 +1125,7 @@ void CConnman::AcceptConnection(const ListenSocket &hListenSocket) {
         inserted = mNodes.try_emplace(pnode->GetId(), pnode).second;
     }
     assert(inserted);
+    RegisterSocketEvents(pnode);
 }
 
 bool CConnman::AddConnection(const std::string& address) {
@@ -1414,6 +1432,13 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
 
 void CConnman::SocketHandler()
 {
+#ifdef USE_EPOLL
+    if (epollFd != -1) {
+        SocketHandlerEpoll();
+        return;
+    }
+#endif
+
     std::set<SOCKET> recv_set, send_set, error_set;
     SocketEvents(recv_set, send_set, error_set);
 
@@ -1448,9 +1473,6 @@ void CConnman::SocketHandler()
             return;
         }
 
-        //
-        // Receive
-        //
         bool recvSet = false;
         bool sendSet = false;
         bool errorSet = false;
@@ -1463,88 +1485,254 @@ void CConnman::SocketHandler()
             sendSet = send_set.count(pnode->hSocket) > 0;
             errorSet = error_set.count(pnode->hSocket) > 0;
         }
-        if (recvSet || errorSet) {
-            // typical socket buffer is 8K-64K
-            char pchBuf[0x10000];
-            int32_t nBytes = 0;
-            {
-                LOCK(pnode->cs_hSocket);
-                if (pnode->hSocket == INVALID_SOCKET) {
-                    continue;
-                }
-                nBytes =
-                    recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+        SocketHandlerConnected(pnode, recvSet || errorSet, sendSet, nodesToBan);
+
+        InactivityCheck(pnode);
+    }
+
+    // Process the node ban list
+    for (const auto& [pnode, rule] : nodesToBan) {
+        PeerRateLimitViolated(pnode, rule);
+    }
+}
+
+bool CConnman::SocketHandlerConnected(const NodeRef &pnode, bool fRecv, bool fSend,
+                                      std::vector<std::pair<NodeRef, PeerRateLimitRule>> &nodesToBan) {
+    bool fMoreToRecv = false;
+
+    //
+    // Receive
+    //
+    if (fRecv) {
+        // typical socket buffer is 8K-64K
+        char pchBuf[0x10000];
+        int32_t nBytes = 0;
+        {
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET) {
+                return false;
             }
-            if (nBytes > 0) {
-                bool notify = false;
-                if (!pnode->ReceiveMsgBytes(*config, pchBuf, nBytes, notify)) {
-                    pnode->CloseSocketDisconnect();
-                }
-                if (auto rule = RecordBytesRecv(nBytes, pnode)) {
-                    nodesToBan.emplace_back(pnode, rule.value());
-                }
-                if (notify) {
-                    size_t nSizeAdded = 0;
-                    auto it(pnode->vRecvMsg.begin());
-                    for (; it != pnode->vRecvMsg.end(); ++it) {
-                        if (!it->complete()) {
-                            break;
-                        }
-                        nSizeAdded +=
-                            it->vRecv.size() + CMessageHeader::HEADER_SIZE;
-                    }
-                    {
-                        LOCK(pnode->cs_vProcessMsg);
-                        pnode->vProcessMsg.splice(pnode->vProcessMsg.end(),
-                                                  pnode->vRecvMsg,
-                                                  pnode->vRecvMsg.begin(), it);
-                        pnode->nProcessQueueSize += nSizeAdded;
-                        pnode->fPauseRecv =
-                            pnode->nProcessQueueSize > nReceiveFloodSize;
+            nBytes =
+                recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+        }
+        if (nBytes > 0) {
+            fMoreToRecv = size_t(nBytes) == sizeof(pchBuf);
+            bool notify = false;
+            if (!pnode->ReceiveMsgBytes(*config, pchBuf, nBytes, notify)) {
+                pnode->CloseSocketDisconnect();
+            }
+            if (auto rule = RecordBytesRecv(nBytes, pnode)) {
+                nodesToBan.emplace_back(pnode, rule.value());
+            }
+            if (notify) {
+                size_t nSizeAdded = 0;
+                auto it(pnode->vRecvMsg.begin());
+                for (; it != pnode->vRecvMsg.end(); ++it) {
+                    if (!it->complete()) {
+                        break;
                     }
-                    WakeMessageHandler();
+                    nSizeAdded +=
+                        it->vRecv.size() + CMessageHeader::HEADER_SIZE;
                 }
-            } else if (nBytes == 0) {
-                // socket closed gracefully
+                {
+                    LOCK(pnode->cs_vProcessMsg);
+                    pnode->vProcessMsg.splice(pnode->vProcessMsg.end(),
+                                              pnode->vRecvMsg,
+                                              pnode->vRecvMsg.begin(), it);
+                    pnode->nProcessQueueSize += nSizeAdded;
+                    pnode->fPauseRecv =
+                        pnode->nProcessQueueSize > nReceiveFloodSize;
+                }
+                WakeMessageHandler(pnode->GetId());
+            }
+        } else if (nBytes == 0) {
+            // socket closed gracefully
+            if (!pnode->fDisconnect) {
+                LogPrint(BCLog::NET, "socket closed\n");
+            }
+            pnode->CloseSocketDisconnect();
+        } else if (nBytes < 0) {
+            // error
+            int nErr = WSAGetLastError();
+            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE &&
+                nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
                 if (!pnode->fDisconnect) {
-                    LogPrint(BCLog::NET, "socket closed\n");
+                    LogPrintf("socket recv error %s\n",
+                              NetworkErrorString(nErr));
                 }
                 pnode->CloseSocketDisconnect();
-            } else if (nBytes < 0) {
-                // error
-                int nErr = WSAGetLastError();
-                if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE &&
-                    nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
-                    if (!pnode->fDisconnect) {
-                        LogPrintf("socket recv error %s\n",
-                                  NetworkErrorString(nErr));
-                    }
-                    pnode->CloseSocketDisconnect();
-                }
             }
         }
+    }
 
-        //
-        // Send
-        //
-        if (sendSet) {
-            LOCK(pnode->cs_vSend);
-            size_t nBytes = SocketSendData(pnode);
-            if (nBytes) {
-                if (auto rule = RecordBytesSent(nBytes, pnode)) {
-                    nodesToBan.emplace_back(pnode, rule.value());
-                }
+    //
+    // Send
+    //
+    if (fSend) {
+        LOCK(pnode->cs_vSend);
+        size_t nBytes = SocketSendData(pnode);
+        if (nBytes) {
+            if (auto rule = RecordBytesSent(nBytes, pnode)) {
+                nodesToBan.emplace_back(pnode, rule.value());
             }
         }
+    }
 
-        InactivityCheck(pnode);
+    return fMoreToRecv;
+}
+
+void CConnman::RegisterSocketEvents(const NodeRef &pnode) {
+#ifdef USE_EPOLL
+    if (epollFd == -1) {
+        return;
+    }
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket == INVALID_SOCKET) {
+        return;
+    }
+    // Edge-triggered: epoll reports the socket when it becomes readable or
+    // writable, and SocketHandlerEpoll() keeps track of it until it is drained.
+    // Closing the socket unregisters it.
+    struct epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.u64 = pnode->GetId();
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, pnode->hSocket, &event) != 0) {
+        LogPrintf("socket epoll_ctl error %s, dropping peer=%d\n", NetworkErrorString(WSAGetLastError()),
+                  pnode->GetId());
+        pnode->fDisconnect = true;
+    }
+#endif
+}
+
+#ifdef USE_EPOLL
+void CConnman::SocketHandlerEpoll() {
+    // Whether a node can be serviced right now, without waiting for another socket event
+    auto canProgress = [](const NodeRef &pnode) {
+        const bool fSendQueued = WITH_LOCK(pnode->cs_vSend, return !pnode->vSendMsg.empty());
+        return (fSendQueued && pnode->fEpollSendReady) ||
+               ((!fSendQueued || pnode->fEpollHangup) && pnode->fEpollRecvReady && !pnode->fPauseRecv);
+    };
+
+    // Don't wait if some socket still has data to be received
+    const bool fWait = std::none_of(vEpollPending.begin(), vEpollPending.end(), canProgress);
+
+    std::array<struct epoll_event, EPOLL_MAX_EVENTS> events;
+    const int nEvents = epoll_wait(epollFd, events.data(), events.size(), fWait ? SELECT_TIMEOUT_MILLISECONDS : 0);
+
+    if (interruptNet) return;
+
+    if (nEvents < 0) {
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEINTR) {
+            LogPrintf("socket epoll_wait error %s\n", NetworkErrorString(nErr));
+            interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
+        }
+        return;
+    }
+
+    //
+    // Record which sockets became ready, and accept new connections
+    //
+    {
+        LOCK(cs_mNodes);
+        for (int i = 0; i < nEvents; ++i) {
+            const uint64_t data = events[i].data.u64;
+            if (data & EPOLL_LISTEN_SOCKET) {
+                continue;
+            }
+            auto it = mNodes.find(NodeId(data));
+            if (it == mNodes.end()) {
+                // the node was disconnected since
+                continue;
+            }
+            const NodeRef &pnode = it->second;
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) {
+                pnode->fEpollRecvReady = true;
+            }
+            if (events[i].events & (EPOLLRDHUP | EPOLLERR | EPOLLHUP)) {
+                pnode->fEpollHangup = true;
+            }
+            if (events[i].events & EPOLLOUT) {
+                pnode->fEpollSendReady = true;
+            }
+            if (!pnode->fEpollPending) {
+                pnode->fEpollPending = true;
+                vEpollPending.push_back(pnode);
+            }
+        }
     }
+    for (int i = 0; i < nEvents; ++i) {
+        const uint64_t data = events[i].data.u64;
+        if (data & EPOLL_LISTEN_SOCKET) {
+            AcceptConnection(vhListenSocket.at(data & ~EPOLL_LISTEN_SOCKET));
+        }
+    }
+
+    // Nodes to ban and the rule they violated
+    std::vector<std::pair<NodeRef, PeerRateLimitRule>> nodesToBan;
+
+    //
+    // Service each ready socket, like SocketHandler() does: drain the send
+    // queue before receiving more, and don't receive while paused
+    //
+    std::vector<NodeRef> vStillPending;
+    for (size_t i = 0; i < vEpollPending.size(); ++i) {
+        const NodeRef &pnode = vEpollPending[i];
+        if (interruptNet) {
+            vStillPending.insert(vStillPending.end(), vEpollPending.begin() + i, vEpollPending.end());
+            break;
+        }
+
+        const bool fSendQueued = WITH_LOCK(pnode->cs_vSend, return !pnode->vSendMsg.empty());
+        const bool fSend = fSendQueued && pnode->fEpollSendReady;
+        // A peer that hung up may never drain its send queue, so don't wait for that to see the end of the stream
+        const bool fRecv = (!fSendQueued || pnode->fEpollHangup) && pnode->fEpollRecvReady && !pnode->fPauseRecv;
+        if (fSend || fRecv) {
+            const bool fMoreToRecv = SocketHandlerConnected(pnode, fRecv, fSend, nodesToBan);
+            if (fRecv && !fMoreToRecv && !pnode->fEpollHangup) {
+                // A short read: epoll reports the socket again once more data arrives. A peer that hung up sends no
+                // more data, and isn't reported again, so keep receiving until recv() sees the end of the stream.
+                pnode->fEpollRecvReady = false;
+            }
+            if (fSend && WITH_LOCK(pnode->cs_vSend, return !pnode->vSendMsg.empty())) {
+                // The send buffer is full: epoll reports the socket again once there is room
+                pnode->fEpollSendReady = false;
+            }
+        }
+
+        // Nodes that have data left to receive stay pending, e.g. until they are unpaused
+        if (pnode->fEpollRecvReady && !pnode->fDisconnect) {
+            vStillPending.push_back(pnode);
+        } else {
+            pnode->fEpollPending = false;
+        }
+    }
+    vEpollPending.swap(vStillPending);
 
     // Process the node ban list
     for (const auto& [pnode, rule] : nodesToBan) {
         PeerRateLimitViolated(pnode, rule);
     }
+
+    // The inactivity timeouts are in seconds, so there is no need to check all
+    // nodes on every wakeup
+    const int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime != nLastInactivityCheck) {
+        nLastInactivityCheck = nTime;
+        std::vector<NodeRef> vNodesCopy;
+        {
+            LOCK(cs_mNodes);
+            vNodesCopy.reserve(mNodes.size());
+            for (const auto & [_, pnode] : mNodes) {
+                vNodesCopy.push_back(pnode);
+            }
+        }
+        for (const NodeRef &pnode : vNodesCopy) {
+            InactivityCheck(pnode);
+        }
+    }
 }
+#endif
 
 void CConnman::ThreadSocketHandler() {
     while (!interruptNet) {
@@ -1556,10 +1744,22 @@ void CConnman::ThreadSocketHandler() {
 
 void CConnman::WakeMessageHandler() {
     {
-        std::lock_guard<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = true;
+        LOCK(mutexMsgProc);
+        vMsgProcWake.assign(vMsgProcWake.size(), true);
+    }
+    condMsgProc.notify_all();
+}
+
+void CConnman::WakeMessageHandler(NodeId id) {
+    {
+        LOCK(mutexMsgProc);
+        if (vMsgProcWake.empty()) {
+            return;
+        }
+        vMsgProcWake[MessageHandlerForNode(id)] = true;
     }
-    condMsgProc.notify_one();
+    // All handler threads share the condition variable; the ones not woken go back to sleep.
+    condMsgProc.notify_all();
 }
 
 void CConnman::ThreadDNSAddressSeed() {
@@ -2022,16 +2222,21 @@ void CConnman::OpenNetworkConnection(const CAddress &addrConnect,
         inserted = mNodes.try_emplace(pnode->GetId(), pnode).second;
     }
     assert(inserted);
+    RegisterSocketEvents(pnode);
 }
 
-void CConnman::ThreadMessageHandler() {
+void CConnman::ThreadMessageHandler(const int nThread) {
     while (!flagInterruptMsgProc) {
+        // Only service the peers sharded to this thread, so that the messages of any one peer are always processed
+        // in order, by the same thread.
         std::vector<NodeRef> vNodesCopy;
         {
             LOCK(cs_mNodes);
-            vNodesCopy.reserve(mNodes.size());
-            for (const auto & [_, pnode] : mNodes) {
-                vNodesCopy.push_back(pnode);
+            vNodesCopy.reserve(mNodes.size() / nMsgHandThreads + 1);
+            for (const auto & [id, pnode] : mNodes) {
+                if (MessageHandlerForNode(id) == nThread) {
+                    vNodesCopy.push_back(pnode);
+                }
             }
         }
 
@@ -2112,10 +2317,12 @@ void CConnman::ThreadMessageHandler() {
                          __func__, nSleepFor.count() / 1e3, *shortenedIntervalDueToNodeId);
             }
             if (nSleepFor > 0us) {
-                condMsgProc.wait_for(lock, nSleepFor, [this] { return fMsgProcWake; });
+                condMsgProc.wait_for(lock, nSleepFor, [this, nThread]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) {
+                    return bool(vMsgProcWake[nThread]);
+                });
             }
         }
-        fMsgProcWake = false;
+        vMsgProcWake[nThread] = false;
     }
 }
 
@@ -2341,6 +2548,29 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
         return false;
     }
 
+#ifdef USE_EPOLL
+    if (connOptions.m_use_epoll) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd == -1) {
+            LogPrintf("Failed to create epoll instance (%s), falling back to poll\n",
+                      NetworkErrorString(WSAGetLastError()));
+        }
+        for (size_t i = 0; epollFd != -1 && i < vhListenSocket.size(); ++i) {
+            // Level-triggered, as AcceptConnection() only accepts one connection at a time
+            struct epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = EPOLL_LISTEN_SOCKET | i;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, vhListenSocket[i].socket, &event) != 0) {
+                LogPrintf("Failed to register listening socket with epoll (%s), falling back to poll\n",
+                          NetworkErrorString(WSAGetLastError()));
+                close(epollFd);
+                epollFd = -1;
+            }
+        }
+    }
+    LogPrintf("Using %s to wait for socket events\n", epollFd != -1 ? "epoll" : "poll");
+#endif
+
     for (const auto &strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
     }
@@ -2387,7 +2617,7 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
 
     {
         LOCK(mutexMsgProc);
-        fMsgProcWake = false;
+        vMsgProcWake.assign(nMsgHandThreads, false);
     }
 
     // Send and receive from sockets, accept connections
@@ -2418,7 +2648,12 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     }
 
     // Process messages
-    threadMessageHandler = std::thread(util::TraceThread, "msghand", [this] { ThreadMessageHandler(); });
+    LogPrintf("Using %d message handler thread%s\n", nMsgHandThreads, nMsgHandThreads == 1 ? "" : "s");
+    for (int i = 0; i < nMsgHandThreads; ++i) {
+        threadMessageHandlers.emplace_back([this, i, name = i == 0 ? std::string("msghand") : strprintf("msghand.%d", i)] {
+            util::TraceThread(name.c_str(), [this, i] { ThreadMessageHandler(i); });
+        });
+    }
 
     // Dump network addresses
     scheduler.scheduleEvery(
@@ -2468,9 +2703,12 @@ void CConnman::Interrupt() {
 }
 
 void CConnman::Stop() {
-    if (threadMessageHandler.joinable()) {
-        threadMessageHandler.join();
+    for (std::thread &thread : threadMessageHandlers) {
+        if (thread.joinable()) {
+            thread.join();
+        }
     }
+    threadMessageHandlers.clear();
     if (threadOpenConnections.joinable()) {
         threadOpenConnections.join();
     }
@@ -2502,6 +2740,14 @@ void CConnman::Stop() {
         }
     }
 
+#ifdef USE_EPOLL
+    vEpollPending.clear();
+    if (epollFd != -1) {
+        close(epollFd);
+        epollFd = -1;
+    }
+#endif
+
     mNodes.clear();
     vNodesDisconnected.clear();
     vhListenSocket.clear();
@@ -2866,35 +3112,67 @@ bool CConnman::NodeFullyConnected(const NodeRef &pnode) {
     return pnode && pnode->fSuccessfullyConnected && !pnode->fDisconnect;
 }
 
-void CConnman::PushMessage(const NodeRef &pnode, CSerializedNetMsg &&msg) {
-    size_t nMessageSize = msg.data.size();
-    size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
-    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", SanitizeString(msg.m_type.c_str()), nMessageSize,
-             pnode->GetId());
-
+std::vector<uint8_t> CConnman::SerializeHeader(const std::string &msgType, Span<const uint8_t> payload) const {
     std::vector<uint8_t> serializedHeader;
     serializedHeader.reserve(CMessageHeader::HEADER_SIZE);
-    uint256 hash = Hash(Span{msg.data}.first(nMessageSize));
-    CMessageHeader hdr(config->GetChainParams().NetMagic(), msg.m_type.c_str(), nMessageSize);
+    uint256 hash = Hash(payload);
+    CMessageHeader hdr(config->GetChainParams().NetMagic(), msgType.c_str(), payload.size());
     std::memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
+    return serializedHeader;
+}
+
+void CConnman::PushMessage(const NodeRef &pnode, CSerializedNetMsg &&msg) {
+    const Span<const uint8_t> payload = msg.Payload();
+    size_t nMessageSize = payload.size();
+    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", SanitizeString(msg.m_type.c_str()), nMessageSize,
+             pnode->GetId());
+
+    std::vector<uint8_t> serializedHeader = SerializeHeader(msg.m_type, payload);
+    SendQueueEntry payloadEntry;
+    if (!msg.m_shared_data.empty()) {
+        payloadEntry = std::move(msg.m_shared_data);
+    } else {
+        payloadEntry = std::move(msg.data);
+    }
+    EnqueueMessage(pnode, msg.m_type, nMessageSize, std::move(serializedHeader), std::move(payloadEntry));
+}
+
+void CConnman::PushMessage(const NodeRef &pnode, const CSharedNetMsg &msg) {
+    assert(!msg.empty());
+    LogPrint(BCLog::NET, "sending %s (%d bytes, shared) peer=%d\n", SanitizeString(msg.m_type.c_str()),
+             msg.m_payload.size(), pnode->GetId());
+    EnqueueMessage(pnode, msg.m_type, msg.m_payload.size(), msg.m_header, msg.m_payload);
+}
+
+CSharedNetMsg CConnman::MakeSharedMessage(CSerializedNetMsg &&msg) const {
+    // The header (and thus the payload checksum) is the same for all peers: compute it only this once
+    CSharedNetMsg ret;
+    ret.m_header = SharedByteSpan(SerializeHeader(msg.m_type, msg.Payload()));
+    ret.m_payload = msg.m_shared_data.empty() ? SharedByteSpan(std::move(msg.data)) : std::move(msg.m_shared_data);
+    ret.m_type = std::move(msg.m_type);
+    return ret;
+}
 
+void CConnman::EnqueueMessage(const NodeRef &pnode, const std::string &msgType, size_t nMessageSize,
+                              SendQueueEntry &&header, SendQueueEntry &&payload) {
+    const size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
     size_t nBytesSent = 0;
     {
         LOCK(pnode->cs_vSend);
         bool optimisticSend(pnode->vSendMsg.empty());
 
         // log total amount of bytes per message type
-        pnode->mapSendBytesPerMsgType[msg.m_type] += nTotalSize;
+        pnode->mapSendBytesPerMsgType[msgType] += nTotalSize;
         pnode->nSendSize += nTotalSize;
 
         if (pnode->nSendSize > nSendBufferMaxSize) {
             pnode->fPauseSend = true;
         }
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
+        pnode->vSendMsg.push_back(std::move(header));
         if (nMessageSize) {
-            pnode->vSendMsg.push_back(std::move(msg.data));
+            pnode->vSendMsg.push_back(std::move(payload));
         }
 
         // If write queue empty, attempt "optimistic write"
@@ -26,7 +26,9 @@
 #include <sync.h>
 #include <threadinterrupt.h>
 #include <uint256.h>
+#include <util/mappedfile.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -35,6 +37,8 @@
 #include <map>
 #include <memory>
 #include <thread>
+#include <variant>
+#include <vector>
 
 #ifndef WIN32
 #include <arpa/inet.h>
@@ -104,6 +108,14 @@ static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER = 1 * 1000;
+/** Default for -useepoll */
+static const bool DEFAULT_USE_EPOLL = true;
+/** Default for -msghandthreads (0 = auto) */
+static const int DEFAULT_MSGHAND_THREADS = 0;
+/** Number of message handler threads used by -msghandthreads=0, at most */
+static const int AUTO_MAX_MSGHAND_THREADS = 4;
+/** Maximum number of message handler threads */
+static const int MAX_MSGHAND_THREADS = 16;
 
 struct AddedNodeInfo {
     std::string strAddedNode;
@@ -125,8 +137,42 @@ struct CSerializedNetMsg {
 
     std::vector<uint8_t> data;
     std::string m_type;
+    //! If not empty, the payload to send instead of `data`. It goes into the
+    //! send queue as-is, without being copied (e.g. a raw block that lives in
+    //! a memory-mapped block file).
+    SharedByteSpan m_shared_data;
+
+    //! The payload to send
+    Span<const uint8_t> Payload() const {
+        return m_shared_data.empty() ? Span<const uint8_t>{data} : m_shared_data.span();
+    }
+};
+
+/**
+ * A message that many peers are sent (e.g. a relayed block or transaction),
+ * serialized only once: its header, including the payload checksum, is also
+ * computed just once, and the send queues of all the peers share the same
+ * immutable header and payload buffers. Cheap to copy.
+ * Create with CConnman::MakeSharedMessage().
+ */
+class CSharedNetMsg {
+    std::string m_type;
+    SharedByteSpan m_header;
+    SharedByteSpan m_payload;
+
+    friend class CConnman;
+
+public:
+    CSharedNetMsg() = default;
+
+    bool empty() const { return m_header.empty(); }
+    const std::string &Type() const { return m_type; }
+    Span<const uint8_t> Payload() const { return m_payload.span(); }
 };
 
+//! A message header or payload in the send queue of a CNode; payloads (and headers) may be shared between nodes
+using SendQueueEntry = std::variant<std::vector<uint8_t>, SharedByteSpan>;
+
 using NodeRef = std::shared_ptr<CNode>;
 using NodeCRef = std::shared_ptr<const CNode>; //! unused; maybe should be used in some places for const-correctness
 
@@ -161,6 +207,10 @@ public:
         std::vector<CService> vBinds;
         std::vector<CService> onion_binds;
         bool m_use_addrman_outgoing = true;
+        //! Wait for socket events with epoll, where available, instead of poll/select
+        bool m_use_epoll = DEFAULT_USE_EPOLL;
+        //! Number of message handler threads; every peer is always serviced by the same one
+        int nMsgHandThreads = 1;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
         std::vector<bool> m_asmap;
@@ -181,6 +231,7 @@ public:
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
         m_peer_connect_timeout = connOptions.m_peer_connect_timeout;
+        nMsgHandThreads = std::clamp(connOptions.nMsgHandThreads, 1, MAX_MSGHAND_THREADS);
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
@@ -226,6 +277,10 @@ public:
     bool ForNode(NodeId id, std::function<bool(NodeRef pnode)> func, bool fullyConnectedOnly = true) const;
 
     void PushMessage(const NodeRef &pnode, CSerializedNetMsg &&msg);
+    //! Push a message that was made with MakeSharedMessage(), without copying it
+    void PushMessage(const NodeRef &pnode, const CSharedNetMsg &msg);
+    //! @returns `msg` with its header computed, ready to be pushed to any number of peers
+    CSharedNetMsg MakeSharedMessage(CSerializedNetMsg &&msg) const;
 
     template <typename Callable> void ForEachNode(Callable &&func) const {
         LOCK(cs_mNodes);
@@ -295,6 +350,11 @@ public:
 
     ServiceFlags GetLocalServices() const;
 
+    //! Start offering `services` to peers that connect from now on.
+    void AddLocalServices(ServiceFlags services) {
+        nLocalServices = ServiceFlags(nLocalServices | services);
+    }
+
     //! set the max outbound target in bytes.
     void SetMaxOutboundTarget(uint64_t limit);
     uint64_t GetMaxOutboundTarget();
@@ -328,6 +388,8 @@ public:
     unsigned int GetReceiveFloodSize() const;
 
     void WakeMessageHandler();
+    //! Wakes only the message handler thread that services the given peer
+    void WakeMessageHandler(NodeId id);
 
     /**
      * Attempts to obfuscate tx time through exponentially distributed emitting.
@@ -362,7 +424,9 @@ private:
     void AddOneShot(const std::string &strDest);
     void ProcessOneShot();
     void ThreadOpenConnections(std::vector<std::string> connect);
-    void ThreadMessageHandler();
+    void ThreadMessageHandler(int nThread);
+    //! Returns the index of the message handler thread that services the given peer
+    int MessageHandlerForNode(NodeId id) const { return id % nMsgHandThreads; }
     void AcceptConnection(const ListenSocket &hListenSocket);
     // Disconnect and either discourage or ban the specified node. Whether or not to ban, and the ban time depends on
     // the given PeerRateLimitRule's configured ban time.
@@ -373,6 +437,18 @@ private:
     bool GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void SocketHandler();
+    /**
+     * Receive from and/or send to the socket of a connected node.
+     * @returns true if the receive filled the buffer, so that more data may be waiting on the socket.
+     */
+    bool SocketHandlerConnected(const NodeRef &pnode, bool fRecv, bool fSend,
+                                std::vector<std::pair<NodeRef, PeerRateLimitRule>> &nodesToBan);
+    //! Watch the socket of a node that was just added to mNodes for events, if the epoll backend is in use
+    void RegisterSocketEvents(const NodeRef &pnode);
+#ifdef USE_EPOLL
+    //! SocketHandler() for the epoll backend, which only visits the sockets that are ready
+    void SocketHandlerEpoll();
+#endif
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
 
@@ -395,6 +471,11 @@ private:
 
     NodeId GetNewNodeId();
 
+    //! @returns the serialized message header (which includes the checksum of the payload)
+    std::vector<uint8_t> SerializeHeader(const std::string &msgType, Span<const uint8_t> payload) const;
+    //! Append a message's (already serialized) header and payload to the send queue of `pnode`
+    void EnqueueMessage(const NodeRef &pnode, const std::string &msgType, size_t nMessageSize,
+                        SendQueueEntry &&header, SendQueueEntry &&payload);
     size_t SocketSendData(const NodeRef &pnode) const;
     void DumpAddresses();
 
@@ -474,7 +555,7 @@ private:
     std::map<uint64_t, CachedAddrResponse> m_addr_response_caches GUARDED_BY(cs_addr_response_caches);
 
     /** Services this instance offers */
-    ServiceFlags nLocalServices;
+    std::atomic<ServiceFlags> nLocalServices;
 
     std::unique_ptr<CSemaphore> semOutbound;
     std::unique_ptr<CSemaphore> semAddnode;
@@ -491,8 +572,11 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake;
+    /** Number of message handler threads. Peers are sharded across them by id. */
+    int nMsgHandThreads{1};
+
+    /** flags for waking the message processor, one per message handler thread. */
+    std::vector<bool> vMsgProcWake GUARDED_BY(mutexMsgProc);
 
     std::condition_variable condMsgProc;
     Mutex mutexMsgProc;
@@ -500,11 +584,20 @@ private:
 
     CThreadInterrupt interruptNet;
 
+#ifdef USE_EPOLL
+    //! The epoll instance all sockets are registered with, or -1 to use SocketEvents() instead
+    int epollFd{-1};
+    //! Nodes that epoll reported ready and that may still be received from. Only used by the SocketHandler thread.
+    std::vector<NodeRef> vEpollPending;
+    //! When InactivityCheck() last ran over all nodes. Only used by the SocketHandler thread.
+    int64_t nLastInactivityCheck{0};
+#endif
+
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
+    std::vector<std::thread> threadMessageHandlers;
 
     /**
      * Flag for deciding to connect to an extra outbound peer, in excess of
@@ -707,7 +800,9 @@ public:
     // Offset inside the first vSendMsg already sent.
     size_t nSendOffset{0};
     uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
-    std::deque<std::vector<uint8_t>> vSendMsg GUARDED_BY(cs_vSend);
+    //! Queued message headers and payloads; payloads may be shared with other
+    //! nodes' queues (see CSerializedNetMsg::m_shared_data).
+    std::deque<SendQueueEntry> vSendMsg GUARDED_BY(cs_vSend);
     mutable RecursiveMutex cs_vSend;
     RecursiveMutex cs_hSocket;
     RecursiveMutex cs_vRecv;
@@ -814,8 +909,10 @@ public:
     std::atomic<int> nStartingHeight{-1};
 
     // flood relay
-    std::vector<CAddress> vAddrToSend;
-    CRollingBloomFilter addrKnown;
+    //! Other peers' message handler threads push to vAddrToSend (see RelayAddress), hence the lock
+    Mutex cs_addrSend;
+    std::vector<CAddress> vAddrToSend GUARDED_BY(cs_addrSend);
+    CRollingBloomFilter addrKnown GUARDED_BY(cs_addrSend);
     bool fGetAddr{false};
     std::chrono::microseconds m_next_addr_send GUARDED_BY(cs_sendProcessing){0};
     std::chrono::microseconds m_next_local_addr_send GUARDED_BY(cs_sendProcessing){0};
@@ -892,6 +989,18 @@ private:
     NetPermissionFlags m_permissionFlags{PF_NONE};
     // Used only by SocketHandler thread
     std::list<CNetMessage> vRecvMsg;
+#ifdef USE_EPOLL
+    // Used only by SocketHandler thread: whether hSocket was reported readable
+    // (writable) by epoll and hasn't been drained (filled) since, and whether
+    // the node is in CConnman::vEpollPending
+    bool fEpollRecvReady{false};
+    bool fEpollSendReady{false};
+    bool fEpollPending{false};
+    // Used only by SocketHandler thread: whether epoll reported that the peer
+    // hung up or that the socket errored. Edge-triggered epoll reports that
+    // only once, so the socket stays readable until recv() sees the end.
+    bool fEpollHangup{false};
+#endif
 
     mutable RecursiveMutex cs_addrName;
     std::string addrName GUARDED_BY(cs_addrName);
@@ -920,6 +1029,7 @@ public:
     void SetAddrLocal(const CService &addrLocalIn);
 
     void AddAddressKnown(const CAddress &_addr) {
+        LOCK(cs_addrSend);
         addrKnown.insert(_addr.GetKey());
     }
 
@@ -932,6 +1042,7 @@ public:
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
+        LOCK(cs_addrSend);
         if (_addr.IsValid() && !addrKnown.contains(_addr.GetKey()) && addr_format_supported) {
             if (vAddrToSend.size() >= MAX_ADDR_TO_SEND) {
                 vAddrToSend[insecure_rand.randrange(vAddrToSend.size())] =
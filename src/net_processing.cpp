@@ -11,6 +11,7 @@
 #include <addrman.h>
 #include <arith_uint256.h>
 #include <banman.h>
+#include <blockfilter.h>
 #include <blockencodings.h>
 #include <blockvalidity.h>
 #include <chain.h>
@@ -21,6 +22,7 @@
 #include <dsproof/storage.h>
 #include <extversion.h>
 #include <hash.h>
+#include <index/blockfilterindex.h>
 #include <merkleblock.h>
 #include <net.h>
 #include <netbase.h>
@@ -38,8 +40,10 @@
 #include <txmempool.h>
 #include <ui_interface.h>
 #include <util/moneystr.h>
+#include <util/saltedhashers.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <utxosync/backgroundvalidation.h>
 #include <validation.h>
 #include <validationinterface.h>
 
@@ -52,6 +56,7 @@
 #include <stdexcept>
 #include <type_traits>
 #include <typeinfo>
+#include <unordered_set>
 
 #if defined(NDEBUG)
 #error "Bitcoin cannot be compiled without assertions."
@@ -112,6 +117,13 @@ static constexpr auto NONPREF_PEER_TX_DELAY = std::chrono::seconds{2};
 static constexpr auto OVERLOADED_PEER_TX_DELAY = std::chrono::seconds{2};
 /** How long to wait before downloading a transaction from an additional peer. */
 static constexpr auto GETDATA_TX_INTERVAL = std::chrono::seconds{60}; // 1 minute
+/**
+ * Maximum number of consecutive TX messages from a peer that are accepted to the mempool as one batch, and their
+ * maximum total size. A batch takes the turn of a single message in the round-robin over peers, so it is kept within
+ * about the cost of one large standard transaction.
+ */
+static constexpr size_t MAX_TX_MESSAGES_PER_BATCH = 8;
+static constexpr size_t MAX_TX_BATCH_BYTES = MAX_STANDARD_TX_SIZE;
 /**
  * Limit to avoid sending big packets. Not used in processing incoming GETDATA
  * for compatibility.
@@ -120,6 +132,10 @@ static const unsigned int MAX_GETDATA_SZ = 1000;
 
 /// How many non standard orphan do we consider from a node before ignoring it.
 static constexpr uint32_t MAX_NON_STANDARD_ORPHAN_PER_NODE = 5;
+/** Maximum number of compact filters that may be requested with one getcfilters. See BIP 157. */
+static constexpr uint32_t MAX_GETCFILTERS_SIZE = 1000;
+/** Maximum number of cf hashes that may be requested with one getcfheaders. See BIP 157. */
+static constexpr uint32_t MAX_GETCFHEADERS_SIZE = 2000;
 
 namespace internal {
 RecursiveMutex g_cs_orphans;
@@ -215,7 +231,12 @@ int g_outbound_peers_with_protect_from_disconnect GUARDED_BY(cs_main) = 0;
 std::atomic<int64_t> g_last_tip_update(0);
 
 /** Relay map. */
-typedef std::map<uint256, CTransactionRef> MapRelay;
+struct RelayEntry {
+    CTransactionRef tx;
+    //! The TX message, serialized upon the first request and then shared by all the peers that request it
+    CSharedNetMsg msg;
+};
+typedef std::map<uint256, RelayEntry> MapRelay;
 MapRelay mapRelay GUARDED_BY(cs_main);
 /**
  * Expiration-time ordered list of (expire time, relay map entry) pairs,
@@ -804,6 +825,54 @@ static void FindNextBlocksToDownload(NodeId nodeid, unsigned int count,
     }
 }
 
+/**
+ * Update vBlocks to contain up to `count` more blocks below the base of the
+ * UTXO snapshot that the chainstate was loaded from, which the background
+ * validation of its history needs next, and which the peer can provide. Only
+ * called with the room left after FindNextBlocksToDownload(), so these never
+ * hold up the active chain.
+ */
+static void FindNextBackgroundBlocksToDownload(
+    NodeId nodeid, unsigned int count,
+    std::vector<const CBlockIndex *> &vBlocks)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    const CBlockIndex *pindexBase = pindexSnapshotBase;
+    if (count == 0 || !pindexBase || !utxosync::g_background_validation) {
+        return;
+    }
+
+    CNodeState *state = State(nodeid);
+    assert(state != nullptr);
+    if (state->pindexBestKnownBlock == nullptr ||
+        state->pindexBestKnownBlock->GetAncestor(pindexBase->nHeight) !=
+            pindexBase) {
+        return;
+    }
+
+    // Stay within BLOCK_DOWNLOAD_WINDOW of the validated history, like
+    // FindNextBlocksToDownload() does for the active chain.
+    const int nHeight = utxosync::g_background_validation->GetHeight() + 1;
+    const int nWindowEnd =
+        std::min(nHeight + int(BLOCK_DOWNLOAD_WINDOW), pindexBase->nHeight);
+    if (nHeight > nWindowEnd) {
+        return;
+    }
+    std::vector<const CBlockIndex *> vToFetch(nWindowEnd - nHeight + 1);
+    vToFetch.back() = pindexBase->GetAncestor(nWindowEnd);
+    for (size_t i = vToFetch.size() - 1; i > 0; --i) {
+        vToFetch[i - 1] = vToFetch[i]->pprev;
+    }
+    for (const CBlockIndex *pindex : vToFetch) {
+        if (!pindex->nStatus.hasData() &&
+            !IsBlockRequested(pindex->GetBlockHash())) {
+            vBlocks.push_back(pindex);
+            if (--count == 0) {
+                return;
+            }
+        }
+    }
+}
+
 } // namespace
 
 // This function is used for testing the stale tip eviction logic, see
@@ -1210,6 +1279,26 @@ static std::shared_ptr<const CBlock>
 static std::shared_ptr<const CBlockHeaderAndShortTxIDs>
     most_recent_compact_block GUARDED_BY(cs_most_recent_block);
 static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
+//! The CMPCTBLOCK message for most_recent_compact_block, shared by all the peers it is sent to
+static CSharedNetMsg most_recent_compact_block_msg GUARDED_BY(cs_most_recent_block);
+//! The BLOCK message for most_recent_block, serialized upon the first request (see GetRecentBlockMessage())
+static CSharedNetMsg most_recent_block_msg GUARDED_BY(cs_most_recent_block);
+
+/**
+ * @returns the BLOCK message for `pblock`. If that is still the most recent block, the message is serialized only
+ * once for all the peers that request it.
+ */
+static CSharedNetMsg GetRecentBlockMessage(const CConnman &connman, const std::shared_ptr<const CBlock> &pblock) {
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    LOCK(cs_most_recent_block);
+    if (most_recent_block != pblock) {
+        return connman.MakeSharedMessage(msgMaker.Make(NetMsgType::BLOCK, *pblock));
+    }
+    if (most_recent_block_msg.empty()) {
+        most_recent_block_msg = connman.MakeSharedMessage(msgMaker.Make(NetMsgType::BLOCK, *pblock));
+    }
+    return most_recent_block_msg;
+}
 
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
@@ -1220,6 +1309,8 @@ void PeerLogicValidation::NewPoWValidBlock(
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblock =
         std::make_shared<const CBlockHeaderAndShortTxIDs>(*pblock);
     const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    // Serialize the compact block only once, for all the peers we announce it to
+    const CSharedNetMsg cmpctblockMsg = connman->MakeSharedMessage(msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
 
     LOCK(cs_main);
 
@@ -1236,13 +1327,13 @@ void PeerLogicValidation::NewPoWValidBlock(
         most_recent_block_hash = hashBlock;
         most_recent_block = pblock;
         most_recent_compact_block = pcmpctblock;
+        most_recent_compact_block_msg = cmpctblockMsg;
+        most_recent_block_msg = {};
     }
 
-    connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker,
-                          &hashBlock](const NodeRef &pnode) {
+    connman->ForEachNode([this, &cmpctblockMsg, pindex, &hashBlock](const NodeRef &pnode) {
         AssertLockHeld(cs_main);
 
-        // TODO: Avoid the repeated-serialization here
         if (pnode->nVersion < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect) {
             return;
         }
@@ -1255,8 +1346,7 @@ void PeerLogicValidation::NewPoWValidBlock(
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n",
                      "PeerLogicValidation::NewPoWValidBlock",
                      hashBlock.ToString(), pnode->GetId());
-            connman->PushMessage(
-                pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+            connman->PushMessage(pnode, cmpctblockMsg);
             state.pindexBestHeaderSent = pindex;
         }
     });
@@ -1466,11 +1556,11 @@ static void ProcessGetBlockData(const Config &config, const NodeRef &pfrom,
 
     bool send = false;
     std::shared_ptr<const CBlock> a_recent_block;
-    std::shared_ptr<const CBlockHeaderAndShortTxIDs> a_recent_compact_block;
+    CSharedNetMsg a_recent_compact_block_msg;
     {
         LOCK(cs_most_recent_block);
         a_recent_block = most_recent_block;
-        a_recent_compact_block = most_recent_compact_block;
+        a_recent_compact_block_msg = most_recent_compact_block_msg;
     }
 
     bool need_activate_chain = false;
@@ -1555,23 +1645,26 @@ static void ProcessGetBlockData(const Config &config, const NodeRef &pfrom,
             pblock = a_recent_block;
         }
 
-        auto make_raw_block_message = [&pblock, &pindex, &config, &msgMaker] {
-            CSerializedNetMsg msg;
+        auto push_raw_block_message = [&pblock, &pindex, &config, &msgMaker, &connman, &pfrom] {
             if (pblock) {
                 // pblock points to the recent block already in memory, so just use it rather than reading from disk
-                msg = msgMaker.Make(NetMsgType::BLOCK, *pblock);
-            } else {
-                // read the raw block data from disk and send it directly to network
-                msg.m_type = NetMsgType::BLOCK;
-                if (!ReadRawBlockFromDisk(msg.data, pindex, config.GetChainParams(), SER_NETWORK, msgMaker.nVersion)) {
-                    assert(!"cannot load raw block data from disk");
-                }
+                // (it gets serialized only once, for all the peers that request it)
+                connman->PushMessage(pfrom, GetRecentBlockMessage(*connman, pblock));
+                return;
+            }
+            // read the raw block data from disk and send it directly to network (with -mmapblockreads, the
+            // message refers to the memory-mapped block file instead of holding a copy of the data)
+            CSerializedNetMsg msg;
+            msg.m_type = NetMsgType::BLOCK;
+            if (!ReadRawBlockFromDisk(msg.m_shared_data, pindex, config.GetChainParams(), SER_NETWORK,
+                                      msgMaker.nVersion)) {
+                assert(!"cannot load raw block data from disk");
             }
-            return msg;
+            connman->PushMessage(pfrom, std::move(msg));
         };
 
         if (inv.type == MSG_BLOCK) {
-            connman->PushMessage(pfrom, make_raw_block_message());
+            push_raw_block_message();
         } else {
             auto ensure_pblock = [&pblock, &pindex, &consensusParams]() -> const CBlock & {
                 // Read block from disk if not already in memory and deserialize to transform it to
@@ -1632,12 +1725,17 @@ static void ProcessGetBlockData(const Config &config, const NodeRef &pfrom,
                 if (CanDirectFetch(consensusParams) &&
                     pindex->nHeight >=
                         ::ChainActive().Height() - MAX_CMPCTBLOCK_DEPTH) {
-                    CBlockHeaderAndShortTxIDs cmpctblock(ensure_pblock());
-                    connman->PushMessage(
-                        pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK,
-                                            cmpctblock));
+                    if (pblock && !a_recent_compact_block_msg.empty()) {
+                        // the recent block, whose compact block we already serialized
+                        connman->PushMessage(pfrom, a_recent_compact_block_msg);
+                    } else {
+                        CBlockHeaderAndShortTxIDs cmpctblock(ensure_pblock());
+                        connman->PushMessage(
+                            pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK,
+                                                cmpctblock));
+                    }
                 } else {
-                    connman->PushMessage(pfrom, make_raw_block_message());
+                    push_raw_block_message();
                 }
             }
         }
@@ -1694,7 +1792,11 @@ static void ProcessGetData(const Config &config, const NodeRef &pfrom, CConnman
                 case MSG_TX:
                     // Send stream from relay memory
                     if (auto mi = mapRelay.find(inv.hash); mi != mapRelay.end()) {
-                        connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::TX, *mi->second));
+                        RelayEntry &entry = mi->second;
+                        if (entry.msg.empty()) {
+                            entry.msg = connman->MakeSharedMessage(msgMaker.Make(nSendFlags, NetMsgType::TX, *entry.tx));
+                        }
+                        connman->PushMessage(pfrom, entry.msg);
                         found = true;
                     } else if (pfrom->timeLastMempoolReq) {
                         auto txinfo = g_mempool.info(TxId(inv.hash));
@@ -1782,6 +1884,199 @@ static void SendBlockTransactions(const CBlock &block,
     connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::BLOCKTXN, resp));
 }
 
+/**
+ * Validates a request for block filters (getcfilters, getcfheaders or
+ * getcfcheckpt) and looks up the block and the filter index it refers to.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ *
+ * @param[in]   pfrom           The peer that we received the request from
+ * @param[in]   chain_params    Chain parameters
+ * @param[in]   filter_type     The filter type the request is for. Must be
+ *                              basic filters.
+ * @param[in]   start_height    The start height for the request
+ * @param[in]   stop_hash       The stop_hash for the request
+ * @param[in]   max_height_diff The maximum number of items permitted to
+ *                              request, as specified in BIP 157
+ * @param[out]  stop_index      The CBlockIndex for the stop_hash block, if the
+ *                              request can be serviced.
+ * @param[out]  filter_index    The filter index, if the request can be
+ *                              serviced.
+ * @return                      True if the request can be serviced.
+ */
+static bool PrepareBlockFilterRequest(const NodeRef &pfrom, const CChainParams &chain_params,
+                                      BlockFilterType filter_type, uint32_t start_height,
+                                      const BlockHash &stop_hash, uint32_t max_height_diff,
+                                      const CBlockIndex *&stop_index, BlockFilterIndex *&filter_index) {
+    const bool supported_filter_type =
+        filter_type == BlockFilterType::BASIC && (pfrom->GetLocalServices() & NODE_CF);
+    if (!supported_filter_type) {
+        LogPrint(BCLog::NET, "peer %d requested unsupported block filter type: %d\n", pfrom->GetId(),
+                 static_cast<uint8_t>(filter_type));
+        pfrom->fDisconnect = true;
+        return false;
+    }
+
+    {
+        LOCK(cs_main);
+        stop_index = LookupBlockIndex(stop_hash);
+
+        // Check that the stop block exists and the peer would be allowed to
+        // fetch it.
+        if (!stop_index || !BlockRequestAllowed(stop_index, chain_params.GetConsensus())) {
+            LogPrint(BCLog::NET, "peer %d requested invalid block hash: %s\n", pfrom->GetId(),
+                     stop_hash.ToString());
+            pfrom->fDisconnect = true;
+            return false;
+        }
+    }
+
+    const uint32_t stop_height = stop_index->nHeight;
+    if (start_height > stop_height) {
+        LogPrint(BCLog::NET,
+                 "peer %d sent invalid getcfilters/getcfheaders with start height %d and stop height %d\n",
+                 pfrom->GetId(), start_height, stop_height);
+        pfrom->fDisconnect = true;
+        return false;
+    }
+    if (stop_height - start_height >= max_height_diff) {
+        LogPrint(BCLog::NET, "peer %d requested too many cfilters/cfheaders: %d / %d\n", pfrom->GetId(),
+                 stop_height - start_height + 1, max_height_diff);
+        pfrom->fDisconnect = true;
+        return false;
+    }
+
+    filter_index = GetBlockFilterIndex(filter_type);
+    if (!filter_index) {
+        LogPrint(BCLog::NET, "Filter index for supported type %s not found\n", BlockFilterTypeName(filter_type));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Handle a cfilters request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ */
+static void ProcessGetCFilters(const NodeRef &pfrom, CDataStream &vRecv, const CChainParams &chain_params,
+                               CConnman *connman) {
+    uint8_t filter_type_ser;
+    uint32_t start_height;
+    BlockHash stop_hash;
+
+    vRecv >> filter_type_ser >> start_height >> stop_hash;
+
+    const BlockFilterType filter_type = static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chain_params, filter_type, start_height, stop_hash, MAX_GETCFILTERS_SIZE,
+                                   stop_index, filter_index)) {
+        return;
+    }
+
+    std::vector<BlockFilter> filters;
+    if (!filter_index->LookupFilterRange(start_height, stop_index, filters)) {
+        LogPrint(BCLog::NET, "Failed to find block filter in index: filter_type=%s, start_height=%d, stop_hash=%s\n",
+                 BlockFilterTypeName(filter_type), start_height, stop_hash.ToString());
+        return;
+    }
+
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    for (const auto &filter : filters) {
+        connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CFILTER, filter));
+    }
+}
+
+/**
+ * Handle a cfheaders request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ */
+static void ProcessGetCFHeaders(const NodeRef &pfrom, CDataStream &vRecv, const CChainParams &chain_params,
+                                CConnman *connman) {
+    uint8_t filter_type_ser;
+    uint32_t start_height;
+    BlockHash stop_hash;
+
+    vRecv >> filter_type_ser >> start_height >> stop_hash;
+
+    const BlockFilterType filter_type = static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chain_params, filter_type, start_height, stop_hash, MAX_GETCFHEADERS_SIZE,
+                                   stop_index, filter_index)) {
+        return;
+    }
+
+    uint256 prev_header;
+    if (start_height > 0) {
+        const CBlockIndex *const prev_block = stop_index->GetAncestor(static_cast<int>(start_height - 1));
+        if (!filter_index->LookupFilterHeader(prev_block, prev_header)) {
+            LogPrint(BCLog::NET, "Failed to find block filter header in index: filter_type=%s, block_hash=%s\n",
+                     BlockFilterTypeName(filter_type), prev_block->GetBlockHash().ToString());
+            return;
+        }
+    }
+
+    std::vector<uint256> filter_hashes;
+    if (!filter_index->LookupFilterHashRange(start_height, stop_index, filter_hashes)) {
+        LogPrint(BCLog::NET,
+                 "Failed to find block filter hashes in index: filter_type=%s, start_height=%d, stop_hash=%s\n",
+                 BlockFilterTypeName(filter_type), start_height, stop_hash.ToString());
+        return;
+    }
+
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CFHEADERS, filter_type_ser, stop_index->GetBlockHash(),
+                                              prev_header, filter_hashes));
+}
+
+/**
+ * Handle a getcfcheckpt request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ */
+static void ProcessGetCFCheckPt(const NodeRef &pfrom, CDataStream &vRecv, const CChainParams &chain_params,
+                                CConnman *connman) {
+    uint8_t filter_type_ser;
+    BlockHash stop_hash;
+
+    vRecv >> filter_type_ser >> stop_hash;
+
+    const BlockFilterType filter_type = static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chain_params, filter_type, /*start_height=*/0, stop_hash,
+                                   /*max_height_diff=*/std::numeric_limits<uint32_t>::max(), stop_index,
+                                   filter_index)) {
+        return;
+    }
+
+    std::vector<uint256> headers(stop_index->nHeight / CFCHECKPT_INTERVAL);
+
+    // Populate headers.
+    const CBlockIndex *block_index = stop_index;
+    for (int i = headers.size() - 1; i >= 0; i--) {
+        const int height = (i + 1) * CFCHECKPT_INTERVAL;
+        block_index = block_index->GetAncestor(height);
+
+        if (!filter_index->LookupFilterHeader(block_index, headers[i])) {
+            LogPrint(BCLog::NET, "Failed to find block filter header in index: filter_type=%s, block_hash=%s\n",
+                     BlockFilterTypeName(filter_type), block_index->GetBlockHash().ToString());
+            return;
+        }
+    }
+
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CFCHECKPT, filter_type_ser, stop_index->GetBlockHash(),
+                                              headers));
+}
+
 static bool ProcessHeadersMessage(const Config &config, const NodeRef &pfrom,
                                   CConnman *connman,
                                   const std::vector<CBlockHeader> &headers,
@@ -2202,11 +2497,212 @@ static void ProcessBlockFromNode(const Config &config, const NodeRef &pfrom, con
     }
 }
 
+/**
+ * Handle the outcome of the attempt to accept `ptx`, received from `pfrom`, to the mempool: relay it and look for its
+ * orphans if it was accepted, keep it as an orphan if it has missing inputs, and reject it otherwise.
+ */
+static void ProcessTxAcceptResult(const Config &config, const NodeRef &pfrom, const CTransactionRef &ptx,
+                                  bool fAccepted, bool fMissingInputs, const CValidationState &state, uint64_t entryId,
+                                  CConnman *connman, bool enable_bip61, TxRequestTracker &txrequest)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main, internal::g_cs_orphans) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(internal::g_cs_orphans);
+
+    const CTransaction &tx = *ptx;
+    const TxId &txid = tx.GetId();
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+
+    if (fAccepted) {
+        g_mempool.check(pcoinsTip.get());
+        // As this version of the transaction was acceptable, we can forget about any
+        // requests for it.
+        txrequest.ForgetTxId(tx.GetId());
+        RelayTransaction(tx, connman, entryId);
+        for (size_t i = 0; i < tx.vout.size(); ++i) {
+            auto it_by_prev = internal::mapOrphanTransactionsByPrev.find(COutPoint(txid, i));
+            if (it_by_prev != internal::mapOrphanTransactionsByPrev.end()) {
+                for (const auto &elem : it_by_prev->second) {
+                    pfrom->orphan_work_set.insert(elem->first);
+                }
+            }
+        }
+
+        pfrom->nLastTXTime = GetTime();
+
+        LogPrint(BCLog::MEMPOOL,
+                 "AcceptToMemoryPool: peer=%d: accepted %s "
+                 "(poolsz %u txn, %u kB)\n",
+                 pfrom->GetId(), tx.GetId().ToString(), g_mempool.size(),
+                 g_mempool.DynamicMemoryUsage() / 1000);
+
+        // Recursively process any orphan transactions that depended on this one
+        ProcessOrphanTx(config, connman, pfrom->orphan_work_set);
+
+    } else if (fMissingInputs) {
+        // It may be the case that the orphans parents have all been
+        // rejected.
+        bool fRejectedParents = false;
+        for (const CTxIn &txin : tx.vin) {
+            if (recentRejects->contains(txin.prevout.GetTxId())) {
+                fRejectedParents = true;
+                break;
+            }
+        }
+        if (!fRejectedParents) {
+            const auto current_time = GetTime<std::chrono::microseconds>();
+
+            for (const CTxIn &txin : tx.vin) {
+                // FIXME: MSG_TX should use a TxHash, not a TxId.
+                const TxId _txid = txin.prevout.GetTxId();
+                CInv _inv(MSG_TX, _txid);
+                pfrom->AddInventoryKnown(_inv);
+                if (!AlreadyHave(_inv)) {
+                    AddTxAnnouncement(txrequest, *pfrom, _txid, current_time);
+                }
+            }
+            internal::AddOrphanTx(ptx, pfrom->GetId());
+
+            // Once added to the orphan pool, a tx is considered AlreadyHave, and we shouldn't request it anymore.
+            txrequest.ForgetTxId(tx.GetId());
+
+            // DoS prevention: do not allow mapOrphanTransactions to grow
+            // unbounded
+            unsigned int nMaxOrphanTx = (unsigned int)std::max(
+                int64_t(0), gArgs.GetArg("-maxorphantx",
+                                         DEFAULT_MAX_ORPHAN_TRANSACTIONS));
+            unsigned int nEvicted = internal::LimitOrphanTxSize(nMaxOrphanTx);
+            if (nEvicted > 0) {
+                LogPrint(BCLog::MEMPOOL,
+                         "mapOrphan overflow, removed %u tx\n", nEvicted);
+            }
+        } else {
+            LogPrint(BCLog::MEMPOOL,
+                     "not keeping orphan with rejected parents %s\n",
+                     tx.GetId().ToString());
+            // We will continue to reject this tx since it has rejected
+            // parents so avoid re-requesting it from other peers.
+            recentRejects->insert(tx.GetId());
+            txrequest.ForgetTxId(tx.GetId());
+        }
+    } else {
+        if (!state.CorruptionPossible()) {
+            assert(recentRejects);
+            recentRejects->insert(tx.GetId());
+            txrequest.ForgetTxId(tx.GetId());
+            if (RecursiveDynamicUsage(*ptx) < 100000) {
+                AddToCompactExtraTransactions(ptx);
+            }
+        }
+
+        if (pfrom->HasPermission(PF_FORCERELAY)) {
+            // Always relay transactions received from whitelisted peers,
+            // even if they were already in the mempool or rejected from it
+            // due to policy, allowing the node to function as a gateway for
+            // nodes hidden behind it.
+            //
+            // Never relay transactions that we would assign a non-zero DoS
+            // score for, as we expect peers to do the same with us in that
+            // case.
+            int nDoS = 0;
+            if (!state.IsInvalid(nDoS) || nDoS == 0) {
+                LogPrintf("Force relaying tx %s from whitelisted peer=%d\n",
+                          tx.GetId().ToString(), pfrom->GetId());
+                RelayTransaction(tx, connman, entryId);
+            } else {
+                LogPrintf("Not relaying invalid transaction %s from "
+                          "whitelisted peer=%d (%s)\n",
+                          tx.GetId().ToString(), pfrom->GetId(),
+                          FormatStateMessage(state));
+            }
+        }
+    }
+
+    // If a tx has been detected by recentRejects, we will have reached
+    // this point and the tx will have been ignored. Because we haven't run
+    // the tx through AcceptToMemoryPool, we won't have computed a DoS
+    // score for it or determined exactly why we consider it invalid.
+    //
+    // This means we won't penalize any peer subsequently relaying a DoSy
+    // tx (even if we penalized the first peer who gave it to us) because
+    // we have to account for recentRejects showing false positives. In
+    // other words, we shouldn't penalize a peer if we aren't *sure* they
+    // submitted a DoSy tx.
+    //
+    // Note that recentRejects doesn't just record DoSy or invalid
+    // transactions, but any tx not accepted by the mempool, which may be
+    // due to node policy (vs. consensus). So we can't blanket penalize a
+    // peer simply for relaying a tx that our recentRejects has caught,
+    // regardless of false positives.
+
+    int nDoS = 0;
+    if (state.IsInvalid(nDoS)) {
+        LogPrint(BCLog::MEMPOOLREJ,
+                 "%s from peer=%d was not accepted: %s\n",
+                 tx.GetHash().ToString(), pfrom->GetId(),
+                 FormatStateMessage(state));
+        // Never send AcceptToMemoryPool's internal codes over P2P.
+        if (enable_bip61 && state.GetRejectCode() > 0 &&
+            state.GetRejectCode() < REJECT_INTERNAL) {
+            connman->PushMessage(
+                pfrom, msgMaker.Make(NetMsgType::REJECT, std::string(NetMsgType::TX),
+                                     uint8_t(state.GetRejectCode()),
+                                     state.GetRejectReason().substr(
+                                         0, MAX_REJECT_MESSAGE_LENGTH),
+                                     txid));
+        }
+        if (nDoS > 0) {
+            Misbehaving(pfrom, nDoS, state.GetRejectReason());
+        }
+    }
+}
+
+/**
+ * Accept the transactions of a run of TX messages from `pfrom` to the mempool together (see
+ * AcceptToMemoryPoolBatch()), and handle the outcome for each of them as ProcessMessage() does for a single one.
+ */
+static void ProcessTxBatch(const Config &config, const NodeRef &pfrom, const std::vector<CTransactionRef> &txs,
+                           CConnman *connman, bool enable_bip61, TxRequestTracker &txrequest) {
+    LOCK2(cs_main, internal::g_cs_orphans);
+
+    std::vector<MempoolAcceptBatchEntry> entries;
+    entries.reserve(txs.size());
+    // The index into entries of every transaction in txs, or nullopt for those that are not submitted at all
+    std::vector<std::optional<size_t>> entryIndex(txs.size());
+    std::unordered_set<TxId, SaltedTxIdHasher> seen;
+    const int64_t nAcceptTime = GetTime();
+    for (size_t i = 0; i < txs.size(); ++i) {
+        const TxId &txid = txs[i]->GetId();
+        txrequest.ReceivedResponse(pfrom->GetId(), txid);
+        if (seen.insert(txid).second && !AlreadyHave(CInv(MSG_TX, txid))) {
+            entryIndex[i] = entries.size();
+            entries.emplace_back(txs[i], nAcceptTime);
+        }
+    }
+
+    AcceptToMemoryPoolBatch(config, g_mempool, entries, false /* bypass_limits */, Amount::zero() /* nAbsurdFee */);
+
+    for (size_t i = 0; i < txs.size(); ++i) {
+        if (entryIndex[i]) {
+            const MempoolAcceptBatchEntry &entry = entries[*entryIndex[i]];
+            ProcessTxAcceptResult(config, pfrom, txs[i], entry.fAccepted, entry.fMissingInputs, entry.state,
+                                  entry.entryId, connman, enable_bip61, txrequest);
+        } else {
+            ProcessTxAcceptResult(config, pfrom, txs[i], false, false, CValidationState(), 0, connman, enable_bip61,
+                                  txrequest);
+        }
+    }
+}
+
+/**
+ * Process a single message from `pfrom`. If `txBatch` is given, a TX message
+ * only has its transaction appended to it, to be handed to ProcessTxBatch().
+ */
 static bool ProcessMessage(const Config &config, const NodeRef &pfrom,
                            const std::string &msg_type, CDataStream &vRecv,
                            int64_t nTimeReceived, CConnman *connman,
                            const std::atomic<bool> &interruptMsgProc,
-                           bool enable_bip61, TxRequestTracker &txrequest) {
+                           bool enable_bip61, TxRequestTracker &txrequest,
+                           std::vector<CTransactionRef> *txBatch = nullptr) {
     const CChainParams &chainparams = config.GetChainParams();
     LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n",
              SanitizeString(msg_type), vRecv.size(), pfrom->GetId());
@@ -2917,6 +3413,21 @@ static bool ProcessMessage(const Config &config, const NodeRef &pfrom,
         return true;
     }
 
+    if (msg_type == NetMsgType::GETCFILTERS) {
+        ProcessGetCFilters(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
+    if (msg_type == NetMsgType::GETCFHEADERS) {
+        ProcessGetCFHeaders(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
+    if (msg_type == NetMsgType::GETCFCHECKPT) {
+        ProcessGetCFCheckPt(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
     if (msg_type == NetMsgType::GETBLOCKTXN) {
         BlockTransactionsRequest req;
         vRecv >> req;
@@ -3068,6 +3579,11 @@ static bool ProcessMessage(const Config &config, const NodeRef &pfrom,
         const CInv inv(MSG_TX, txid);
         pfrom->AddInventoryKnown(inv);
 
+        if (txBatch) {
+            txBatch->push_back(ptx);
+            return true;
+        }
+
         LOCK2(cs_main, internal::g_cs_orphans);
 
         bool fMissingInputs = false;
@@ -3076,151 +3592,12 @@ static bool ProcessMessage(const Config &config, const NodeRef &pfrom,
         txrequest.ReceivedResponse(pfrom->GetId(), txid);
 
         uint64_t entryId{};
-        if (!AlreadyHave(inv) &&
-            AcceptToMemoryPool(config, g_mempool, state, ptx, &fMissingInputs,
-                               false /* bypass_limits */,
-                               Amount::zero() /* nAbsurdFee */, false /* test_accept */, &entryId)) {
-            g_mempool.check(pcoinsTip.get());
-            // As this version of the transaction was acceptable, we can forget about any
-            // requests for it.
-            txrequest.ForgetTxId(tx.GetId());
-            RelayTransaction(tx, connman, entryId);
-            for (size_t i = 0; i < tx.vout.size(); ++i) {
-                auto it_by_prev = internal::mapOrphanTransactionsByPrev.find(COutPoint(txid, i));
-                if (it_by_prev != internal::mapOrphanTransactionsByPrev.end()) {
-                    for (const auto &elem : it_by_prev->second) {
-                        pfrom->orphan_work_set.insert(elem->first);
-                    }
-                }
-            }
-
-            pfrom->nLastTXTime = GetTime();
-
-            LogPrint(BCLog::MEMPOOL,
-                     "AcceptToMemoryPool: peer=%d: accepted %s "
-                     "(poolsz %u txn, %u kB)\n",
-                     pfrom->GetId(), tx.GetId().ToString(), g_mempool.size(),
-                     g_mempool.DynamicMemoryUsage() / 1000);
-
-            // Recursively process any orphan transactions that depended on this one
-            ProcessOrphanTx(config, connman, pfrom->orphan_work_set);
-
-        } else if (fMissingInputs) {
-            // It may be the case that the orphans parents have all been
-            // rejected.
-            bool fRejectedParents = false;
-            for (const CTxIn &txin : tx.vin) {
-                if (recentRejects->contains(txin.prevout.GetTxId())) {
-                    fRejectedParents = true;
-                    break;
-                }
-            }
-            if (!fRejectedParents) {
-                const auto current_time = GetTime<std::chrono::microseconds>();
-
-                for (const CTxIn &txin : tx.vin) {
-                    // FIXME: MSG_TX should use a TxHash, not a TxId.
-                    const TxId _txid = txin.prevout.GetTxId();
-                    CInv _inv(MSG_TX, _txid);
-                    pfrom->AddInventoryKnown(_inv);
-                    if (!AlreadyHave(_inv)) {
-                        AddTxAnnouncement(txrequest, *pfrom, _txid, current_time);
-                    }
-                }
-                internal::AddOrphanTx(ptx, pfrom->GetId());
-
-                // Once added to the orphan pool, a tx is considered AlreadyHave, and we shouldn't request it anymore.
-                txrequest.ForgetTxId(tx.GetId());
-
-                // DoS prevention: do not allow mapOrphanTransactions to grow
-                // unbounded
-                unsigned int nMaxOrphanTx = (unsigned int)std::max(
-                    int64_t(0), gArgs.GetArg("-maxorphantx",
-                                             DEFAULT_MAX_ORPHAN_TRANSACTIONS));
-                unsigned int nEvicted = internal::LimitOrphanTxSize(nMaxOrphanTx);
-                if (nEvicted > 0) {
-                    LogPrint(BCLog::MEMPOOL,
-                             "mapOrphan overflow, removed %u tx\n", nEvicted);
-                }
-            } else {
-                LogPrint(BCLog::MEMPOOL,
-                         "not keeping orphan with rejected parents %s\n",
-                         tx.GetId().ToString());
-                // We will continue to reject this tx since it has rejected
-                // parents so avoid re-requesting it from other peers.
-                recentRejects->insert(tx.GetId());
-                txrequest.ForgetTxId(tx.GetId());
-            }
-        } else {
-            if (!state.CorruptionPossible()) {
-                assert(recentRejects);
-                recentRejects->insert(tx.GetId());
-                txrequest.ForgetTxId(tx.GetId());
-                if (RecursiveDynamicUsage(*ptx) < 100000) {
-                    AddToCompactExtraTransactions(ptx);
-                }
-            }
-
-            if (pfrom->HasPermission(PF_FORCERELAY)) {
-                // Always relay transactions received from whitelisted peers,
-                // even if they were already in the mempool or rejected from it
-                // due to policy, allowing the node to function as a gateway for
-                // nodes hidden behind it.
-                //
-                // Never relay transactions that we would assign a non-zero DoS
-                // score for, as we expect peers to do the same with us in that
-                // case.
-                int nDoS = 0;
-                if (!state.IsInvalid(nDoS) || nDoS == 0) {
-                    LogPrintf("Force relaying tx %s from whitelisted peer=%d\n",
-                              tx.GetId().ToString(), pfrom->GetId());
-                    RelayTransaction(tx, connman, entryId);
-                } else {
-                    LogPrintf("Not relaying invalid transaction %s from "
-                              "whitelisted peer=%d (%s)\n",
-                              tx.GetId().ToString(), pfrom->GetId(),
-                              FormatStateMessage(state));
-                }
-            }
-        }
-
-        // If a tx has been detected by recentRejects, we will have reached
-        // this point and the tx will have been ignored. Because we haven't run
-        // the tx through AcceptToMemoryPool, we won't have computed a DoS
-        // score for it or determined exactly why we consider it invalid.
-        //
-        // This means we won't penalize any peer subsequently relaying a DoSy
-        // tx (even if we penalized the first peer who gave it to us) because
-        // we have to account for recentRejects showing false positives. In
-        // other words, we shouldn't penalize a peer if we aren't *sure* they
-        // submitted a DoSy tx.
-        //
-        // Note that recentRejects doesn't just record DoSy or invalid
-        // transactions, but any tx not accepted by the mempool, which may be
-        // due to node policy (vs. consensus). So we can't blanket penalize a
-        // peer simply for relaying a tx that our recentRejects has caught,
-        // regardless of false positives.
-
-        int nDoS = 0;
-        if (state.IsInvalid(nDoS)) {
-            LogPrint(BCLog::MEMPOOLREJ,
-                     "%s from peer=%d was not accepted: %s\n",
-                     tx.GetHash().ToString(), pfrom->GetId(),
-                     FormatStateMessage(state));
-            // Never send AcceptToMemoryPool's internal codes over P2P.
-            if (enable_bip61 && state.GetRejectCode() > 0 &&
-                state.GetRejectCode() < REJECT_INTERNAL) {
-                connman->PushMessage(
-                    pfrom, msgMaker.Make(NetMsgType::REJECT, msg_type,
-                                         uint8_t(state.GetRejectCode()),
-                                         state.GetRejectReason().substr(
-                                             0, MAX_REJECT_MESSAGE_LENGTH),
-                                         inv.hash));
-            }
-            if (nDoS > 0) {
-                Misbehaving(pfrom, nDoS, state.GetRejectReason());
-            }
-        }
+        const bool fAccepted = !AlreadyHave(inv) &&
+                               AcceptToMemoryPool(config, g_mempool, state, ptx, &fMissingInputs,
+                                                  false /* bypass_limits */, Amount::zero() /* nAbsurdFee */,
+                                                  false /* test_accept */, &entryId);
+        ProcessTxAcceptResult(config, pfrom, ptx, fAccepted, fMissingInputs, state, entryId, connman, enable_bip61,
+                              txrequest);
         return true;
     }
 
@@ -3694,7 +4071,7 @@ static bool ProcessMessage(const Config &config, const NodeRef &pfrom,
         }
         pfrom->fSentAddr = true;
 
-        pfrom->vAddrToSend.clear();
+        WITH_LOCK(pfrom->cs_addrSend, pfrom->vAddrToSend.clear());
         std::vector<CAddress> vAddr;
         if (pfrom->HasPermission(PF_ADDR)) {
             vAddr = connman->GetAddresses(MAX_ADDR_TO_SEND, MAX_PCT_ADDR_TO_SEND);
@@ -4054,91 +4431,105 @@ bool PeerLogicValidation::ProcessMessages(const Config &config, NodeRef pfrom, s
         if (pfrom->vProcessMsg.empty()) {
             return false;
         }
-        // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg,
-                    pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -=
-            msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
+        // Just take one message, or a run of transactions that are accepted
+        // to the mempool together
+        const bool fTxRun = pfrom->vProcessMsg.front().hdr.GetCommand() == NetMsgType::TX;
+        size_t nBatchBytes = 0;
+        do {
+            nBatchBytes += pfrom->vProcessMsg.front().vRecv.size();
+            msgs.splice(msgs.end(), pfrom->vProcessMsg,
+                        pfrom->vProcessMsg.begin());
+            pfrom->nProcessQueueSize -=
+                msgs.back().vRecv.size() + CMessageHeader::HEADER_SIZE;
+        } while (fTxRun && msgs.size() < MAX_TX_MESSAGES_PER_BATCH && !pfrom->vProcessMsg.empty() &&
+                 pfrom->vProcessMsg.front().hdr.GetCommand() == NetMsgType::TX &&
+                 nBatchBytes + pfrom->vProcessMsg.front().vRecv.size() <= MAX_TX_BATCH_BYTES);
         pfrom->fPauseRecv =
             pfrom->nProcessQueueSize > connman->GetReceiveFloodSize();
         fMoreWork = !pfrom->vProcessMsg.empty();
     }
-    CNetMessage &msg(msgs.front());
 
-    msg.SetVersion(pfrom->GetRecvVersion());
+    std::vector<CTransactionRef> txBatch;
+    for (CNetMessage &msg : msgs) {
+        msg.SetVersion(pfrom->GetRecvVersion());
 
-    // Scan for message start
-    if (memcmp(std::begin(msg.hdr.pchMessageStart),
-               std::begin(chainparams.NetMagic()),
-               CMessageHeader::MESSAGE_START_SIZE) != 0) {
-        LogPrint(BCLog::NET,
-                 "PROCESSMESSAGE: INVALID MESSAGESTART %s peer=%d\n",
-                 SanitizeString(msg.hdr.GetCommand()), pfrom->GetId());
+        // Scan for message start
+        if (memcmp(std::begin(msg.hdr.pchMessageStart),
+                   std::begin(chainparams.NetMagic()),
+                   CMessageHeader::MESSAGE_START_SIZE) != 0) {
+            LogPrint(BCLog::NET,
+                     "PROCESSMESSAGE: INVALID MESSAGESTART %s peer=%d\n",
+                     SanitizeString(msg.hdr.GetCommand()), pfrom->GetId());
 
-        // Make sure we discourage and disconnect where that come from
-        if (m_banman) {
-            m_banman->Discourage(pfrom->addr);
-        }
-        connman->DisconnectNode(pfrom->addr);
+            // Make sure we discourage and disconnect where that come from
+            if (m_banman) {
+                m_banman->Discourage(pfrom->addr);
+            }
+            connman->DisconnectNode(pfrom->addr);
 
-        pfrom->fDisconnect = true;
-        return false;
-    }
+            pfrom->fDisconnect = true;
+            return false;
+        }
 
-    // Read header
-    CMessageHeader &hdr = msg.hdr;
-    if (!hdr.IsValid(config)) {
-        LogPrint(BCLog::NET, "PROCESSMESSAGE: ERRORS IN HEADER %s peer=%d\n",
-                 SanitizeString(hdr.GetCommand()), pfrom->GetId());
-        return fMoreWork;
-    }
-    std::string msg_type = hdr.GetCommand();
+        // Read header
+        CMessageHeader &hdr = msg.hdr;
+        if (!hdr.IsValid(config)) {
+            LogPrint(BCLog::NET, "PROCESSMESSAGE: ERRORS IN HEADER %s peer=%d\n",
+                     SanitizeString(hdr.GetCommand()), pfrom->GetId());
+            continue;
+        }
+        std::string msg_type = hdr.GetCommand();
 
-    // Message size
-    unsigned int nMessageSize = hdr.nMessageSize;
+        // Message size
+        unsigned int nMessageSize = hdr.nMessageSize;
 
-    // Checksum
-    CDataStream &vRecv = msg.vRecv;
-    const uint256 &hash = msg.GetMessageHash();
-    if (std::memcmp(hash.data(), hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) != 0) {
-        LogPrint(BCLog::NET, "%s(%s, %u bytes): CHECKSUM ERROR expected %s was %s from peer=%d\n", __func__,
-                 SanitizeString(msg_type), nMessageSize, HexStr(Span{hash}.first(CMessageHeader::CHECKSUM_SIZE)),
-                 HexStr(hdr.pchChecksum), pfrom->GetId());
-        if (m_banman) {
-            m_banman->Discourage(pfrom->addr);
+        // Checksum
+        CDataStream &vRecv = msg.vRecv;
+        const uint256 &hash = msg.GetMessageHash();
+        if (std::memcmp(hash.data(), hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) != 0) {
+            LogPrint(BCLog::NET, "%s(%s, %u bytes): CHECKSUM ERROR expected %s was %s from peer=%d\n", __func__,
+                     SanitizeString(msg_type), nMessageSize, HexStr(Span{hash}.first(CMessageHeader::CHECKSUM_SIZE)),
+                     HexStr(hdr.pchChecksum), pfrom->GetId());
+            if (m_banman) {
+                m_banman->Discourage(pfrom->addr);
+            }
+            connman->DisconnectNode(pfrom->addr);
+            return fMoreWork;
         }
-        connman->DisconnectNode(pfrom->addr);
-        return fMoreWork;
-    }
 
-    // Process message
-    bool fRet = false;
-    try {
-        fRet = ProcessMessage(config, pfrom, msg_type, vRecv, msg.nTime,
-                              connman, interruptMsgProc, m_enable_bip61, m_txrequest);
-        if (interruptMsgProc) {
-            return false;
-        }
+        // Process message
+        bool fRet = false;
+        try {
+            fRet = ProcessMessage(config, pfrom, msg_type, vRecv, msg.nTime, connman, interruptMsgProc,
+                                  m_enable_bip61, m_txrequest, msgs.size() > 1 ? &txBatch : nullptr);
+            if (interruptMsgProc) {
+                return false;
+            }
 
-        if (!pfrom->vRecvGetData.empty()) {
-            fMoreWork = true;
+            if (!pfrom->vRecvGetData.empty()) {
+                fMoreWork = true;
+            }
+        } catch (const std::exception& e) {
+            if (m_enable_bip61) {
+                connman->PushMessage(pfrom, CNetMsgMaker(INIT_PROTO_VERSION)
+                                                .Make(NetMsgType::REJECT, msg_type, REJECT_MALFORMED,
+                                                      std::string("error parsing message")));
+            }
+            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg_type),
+                     nMessageSize, e.what(), typeid(e).name());
+        } catch (...) {
+            LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg_type),
+                     nMessageSize);
         }
-    } catch (const std::exception& e) {
-        if (m_enable_bip61) {
-            connman->PushMessage(pfrom, CNetMsgMaker(INIT_PROTO_VERSION)
-                                            .Make(NetMsgType::REJECT, msg_type, REJECT_MALFORMED,
-                                                  std::string("error parsing message")));
+
+        if (!fRet) {
+            LogPrint(BCLog::NET, "%s(%s, %u bytes) FAILED peer=%d\n", __func__,
+                     SanitizeString(msg_type), nMessageSize, pfrom->GetId());
         }
-        LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg_type),
-                 nMessageSize, e.what(), typeid(e).name());
-    } catch (...) {
-        LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg_type),
-                 nMessageSize);
     }
 
-    if (!fRet) {
-        LogPrint(BCLog::NET, "%s(%s, %u bytes) FAILED peer=%d\n", __func__,
-                 SanitizeString(msg_type), nMessageSize, pfrom->GetId());
+    if (!txBatch.empty()) {
+        ProcessTxBatch(config, pfrom, txBatch, connman, m_enable_bip61, m_txrequest);
     }
 
     LOCK(cs_main);
@@ -4411,6 +4802,7 @@ bool PeerLogicValidation::SendMessages(const Config &config, NodeRef pto,
     //
     if (pto->m_next_addr_send < current_time) {
         pto->m_next_addr_send = PoissonNextSend(current_time, AVG_ADDRESS_BROADCAST_INTERVAL);
+        LOCK(pto->cs_addrSend);
         std::vector<CAddress> vAddr;
         vAddr.reserve(pto->vAddrToSend.size());
 
@@ -4588,12 +4980,8 @@ bool PeerLogicValidation::SendMessages(const Config &config, NodeRef pto,
                 {
                     LOCK(cs_most_recent_block);
                     if (most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                        CBlockHeaderAndShortTxIDs cmpctblock(
-                            *most_recent_block);
-                        connman->PushMessage(
-                            pto,
-                            msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK,
-                                          cmpctblock));
+                        // serialized once in NewPoWValidBlock(), for all peers
+                        connman->PushMessage(pto, most_recent_compact_block_msg);
                         fGotBlockFromCache = true;
                     }
                 }
@@ -4837,7 +5225,7 @@ bool PeerLogicValidation::SendMessages(const Config &config, NodeRef pto,
                         vRelayExpiration.pop_front();
                     }
 
-                    auto ret = mapRelay.emplace(txid, txinfo.tx);
+                    auto ret = mapRelay.emplace(txid, RelayEntry{txinfo.tx, {}});
                     if (ret.second) {
                         vRelayExpiration.emplace_back(nNow + 15 * 60 * 1000000, ret.first);
                     }
@@ -4947,6 +5335,11 @@ bool PeerLogicValidation::SendMessages(const Config &config, NodeRef pto,
         FindNextBlocksToDownload(pto->GetId(),
                                  MAX_BLOCKS_IN_TRANSIT_PER_PEER - state.vBlocksInFlight.size(),
                                  vToDownload, staller, consensusParams);
+        if (!pto->m_limited_node) {
+            FindNextBackgroundBlocksToDownload(
+                pto->GetId(), MAX_BLOCKS_IN_TRANSIT_PER_PEER - state.vBlocksInFlight.size() - vToDownload.size(),
+                vToDownload);
+        }
         for (const CBlockIndex *pindex : vToDownload) {
             vGetData.emplace_back(MSG_BLOCK, pindex->GetBlockHash());
             MarkBlockAsInFlight(config, pto->GetId(), pindex->GetBlockHash(),
@@ -5002,8 +5395,9 @@ bool PeerLogicValidation::SendMessages(const Config &config, NodeRef pto,
         if (nNow > pto->nextSendTimeFeeFilter) {
             static CFeeRate default_feerate =
                 CFeeRate(DEFAULT_MIN_RELAY_TX_FEE_PER_KB);
-            static FeeFilterRounder filterRounder(default_feerate);
-            Amount filterToSend = filterRounder.round(currentFilter);
+            static Mutex cs_filterRounder;
+            static FeeFilterRounder filterRounder GUARDED_BY(cs_filterRounder){default_feerate};
+            Amount filterToSend = WITH_LOCK(cs_filterRounder, return filterRounder.round(currentFilter));
             filterToSend = std::max(filterToSend, ::minRelayTxFee.GetFeePerK());
 
             if (filterToSend != pto->lastSentFeeFilter) {
@@ -49,6 +49,9 @@ static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
 /** Default for BIP61 (sending reject messages) */
 static constexpr bool DEFAULT_ENABLE_BIP61 = true;
 
+/** Default for -peerblockfilters, serving BIP 157 compact block filters to peers */
+static constexpr bool DEFAULT_PEERBLOCKFILTERS = false;
+
 /** Maximum number of outstanding CMPCTBLOCK requests for the same block. */
 static constexpr unsigned int MAX_CMPCTBLOCKS_INFLIGHT_PER_BLOCK = 3;
 
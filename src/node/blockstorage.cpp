@@ -10,6 +10,7 @@
 #include <clientversion.h>
 #include <config.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <dsproof/dsproof.h>
 #include <flatfile.h>
 #include <fs.h>
@@ -23,14 +24,18 @@
 #include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <limits>
+#include <list>
 
 std::atomic_bool fImporting(false);
 std::atomic_bool fReindex(false);
 bool fHavePruned GUARDED_BY(cs_main) = false;
 bool fPruneMode = false;
+const CBlockIndex *pindexSnapshotBase GUARDED_BY(cs_main) = nullptr;
 uint64_t nPruneTarget = 0;
 bool fCheckBlockReads = false;
+bool fMmapBlockReads = DEFAULT_MMAP_BLOCK_READS;
 
 RecursiveMutex cs_LastBlockFile;
 std::vector<CBlockFileInfo> vinfoBlockFile GUARDED_BY(cs_LastBlockFile);
@@ -53,7 +58,12 @@ static FlatFileSeq BlockFileSeq();
 static FlatFileSeq UndoFileSeq();
 
 bool IsBlockPruned(const CBlockIndex *pblockindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
-    return fHavePruned && !pblockindex->nStatus.hasData() && pblockindex->nTx > 0;
+    return (fHavePruned || IsBlockFromSnapshot(pblockindex)) && !pblockindex->nStatus.hasData()
+           && pblockindex->nTx > 0;
+}
+
+bool IsBlockFromSnapshot(const CBlockIndex *pblockindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    return pindexSnapshotBase && pindexSnapshotBase->GetAncestor(pblockindex->nHeight) == pblockindex;
 }
 
 // If we're using -prune with -reindex, then delete block files that will be
@@ -209,7 +219,10 @@ uint64_t CalculateCurrentUsage() {
     return retval;
 }
 
+static void ForgetMappedBlockFiles(const std::set<int> &setFiles);
+
 void UnlinkPrunedFiles(const std::set<int> &setFilesToPrune) {
+    ForgetMappedBlockFiles(setFilesToPrune);
     for (const int i : setFilesToPrune) {
         FlatFilePos pos(i, 0);
         fs::remove(BlockFileSeq().FileName(pos));
@@ -239,6 +252,87 @@ static fs::path GetBlockPosFilename(const FlatFilePos &pos) {
     return BlockFileSeq().FileName(pos);
 }
 
+static Mutex cs_mappedBlockFiles;
+/** Memory-mapped block files by file number, most recently used first (-mmapblockreads). */
+static std::list<std::pair<int, std::shared_ptr<const MappedFile>>> listMappedBlockFiles GUARDED_BY(cs_mappedBlockFiles);
+
+/**
+ * Get a memory mapping of block file `nFile` that covers at least its first `nMinSize` bytes. The block file that is
+ * currently being written to keeps growing, so a cached mapping that is too short is replaced by a new one (views
+ * into the old one keep it alive until they are gone).
+ * @returns nullptr if the file can't be mapped or is too short.
+ */
+static std::shared_ptr<const MappedFile> GetMappedBlockFile(int nFile, uint64_t nMinSize) {
+    LOCK(cs_mappedBlockFiles);
+    for (auto it = listMappedBlockFiles.begin(); it != listMappedBlockFiles.end(); ++it) {
+        if (it->first != nFile) {
+            continue;
+        }
+        if (it->second->size() >= nMinSize) {
+            listMappedBlockFiles.splice(listMappedBlockFiles.begin(), listMappedBlockFiles, it);
+            return it->second;
+        }
+        listMappedBlockFiles.erase(it);
+        break;
+    }
+    auto file = MappedFile::Open(BlockFileSeq().FileName(FlatFilePos(nFile, 0)));
+    if (!file || file->size() < nMinSize) {
+        return nullptr;
+    }
+    listMappedBlockFiles.emplace_front(nFile, file);
+    if (listMappedBlockFiles.size() > MAX_MAPPED_BLOCK_FILES) {
+        listMappedBlockFiles.pop_back();
+    }
+    return file;
+}
+
+/** Drop the cached mappings of block files that are about to be deleted. */
+static void ForgetMappedBlockFiles(const std::set<int> &setFiles) {
+    LOCK(cs_mappedBlockFiles);
+    listMappedBlockFiles.remove_if([&setFiles](const auto &entry) { return setFiles.count(entry.first) > 0; });
+}
+
+/**
+ * Locate the block at `blockPos` in its memory-mapped block file, and check the block size (and the disk magic, if
+ * `diskMagic` is not nullptr) that precede it.
+ *
+ * @returns false on error. Otherwise `rawBlockOut` is a view of the serialized block, or empty if the block file
+ *          could not be mapped, in which case the caller should fall back to regular file reads.
+ */
+static bool ReadMappedBlock(SharedByteSpan &rawBlockOut, const FlatFilePos &blockPos,
+                            const CMessageHeader::MessageMagic *diskMagic) {
+    constexpr size_t headerSize = CMessageHeader::MESSAGE_START_SIZE + sizeof(uint32_t);
+    rawBlockOut = {};
+    if (blockPos.nPos < headerSize) {
+        return error("%s: invalid block position %s", __func__, blockPos.ToString());
+    }
+    auto file = GetMappedBlockFile(blockPos.nFile, blockPos.nPos);
+    if (!file) {
+        LogPrint(BCLog::BENCH, "%s: failed to map block file for %s, falling back to regular reads\n", __func__,
+                 blockPos.ToString());
+        return true;
+    }
+
+    const uint8_t *header = file->data().data() + blockPos.nPos - headerSize;
+    // verify disk magic to validate block position inside the file
+    if (diskMagic && !std::equal(diskMagic->begin(), diskMagic->end(), header)) {
+        return error("%s: block DiskMagic verification failed for %s", __func__, blockPos.ToString());
+    }
+    // check the block size for sanity
+    const uint32_t blockSize = ReadLE32(header + CMessageHeader::MESSAGE_START_SIZE);
+    if (blockSize < BLOCK_HEADER_SIZE || blockSize > MAX_CONSENSUS_BLOCK_SIZE) {
+        return error("%s: block size verification failed for %s", __func__, blockPos.ToString());
+    }
+    const uint64_t blockEnd = uint64_t{blockPos.nPos} + blockSize;
+    if (file->size() < blockEnd && !(file = GetMappedBlockFile(blockPos.nFile, blockEnd))) {
+        return error("%s: block data extends beyond the end of the block file for %s", __func__, blockPos.ToString());
+    }
+
+    const Span<const uint8_t> data = file->data().subspan(blockPos.nPos, blockSize);
+    rawBlockOut = SharedByteSpan(std::move(file), data);
+    return true;
+}
+
 static bool FindBlockPos(FlatFilePos &pos, unsigned int nAddSize, unsigned int nHeight, uint64_t nTime,
                          bool fKnown = false) {
     LOCK(cs_LastBlockFile);
@@ -376,20 +470,36 @@ bool ReadBlockFromDisk(CBlock &block, const FlatFilePos &pos, const Consensus::P
                        const std::optional<BlockHash> &expectedHash) {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull()) {
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s",
-                     pos.ToString());
+    SharedByteSpan mappedBlock;
+    if (fMmapBlockReads && !ReadMappedBlock(mappedBlock, pos, nullptr)) {
+        return false;
     }
 
-    // Read block
-    try {
-        // Note that `filein` is moved-from beyond this point
-        BufferedReader(std::move(filein)) >> block;
-    } catch (const std::exception &e) {
-        return error("%s: Deserialize or I/O error - %s at %s", __func__,
-                     e.what(), pos.ToString());
+    if (!mappedBlock.empty()) {
+        // Deserialize straight from the mapped block file
+        try {
+            const Span<const uint8_t> data = mappedBlock.span();
+            GenericVectorReader(SER_DISK, CLIENT_VERSION, data, 0) >> block;
+        } catch (const std::exception &e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__,
+                         e.what(), pos.ToString());
+        }
+    } else {
+        // Open history file to read
+        CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull()) {
+            return error("ReadBlockFromDisk: OpenBlockFile failed for %s",
+                         pos.ToString());
+        }
+
+        // Read block
+        try {
+            // Note that `filein` is moved-from beyond this point
+            BufferedReader(std::move(filein)) >> block;
+        } catch (const std::exception &e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__,
+                         e.what(), pos.ToString());
+        }
     }
 
     const auto blockHash = block.GetHash();
@@ -483,6 +593,48 @@ std::optional<uint64_t> ReadBlockSizeFromDisk(const CBlockIndex *pindex, const C
     return blockSize;
 }
 
+/**
+ * -checkblockreads: ensure that `rawBlock`, as read from disk for `pindex`, deserializes to the expected block and
+ * re-serializes to the same bytes with the caller's `nType` and `nVersion`.
+ */
+static bool CheckRawBlockRead(Span<const uint8_t> rawBlock, const CBlockIndex *pindex, const FlatFilePos &blockPos,
+                              int nType, int nVersion) {
+    // This is normally only enabled for regtest and is provided in order to guarantee additional sanity checks
+    // when returning raw blocks in this manner. For real networks, we prefer the performance benefit of not
+    // deserializing and not doing these slower checks here.
+    Tic elapsed;
+    CBlock block;
+    std::vector<uint8_t> rawBlock2;
+    rawBlock2.reserve(rawBlock.size());
+
+    try {
+        GenericVectorReader(nType, nVersion, rawBlock, 0) >> block;
+        CVectorWriter(nType, nVersion, rawBlock2, 0) << block;
+    } catch (const std::exception &e) {
+        return error("%s: Consistency check failed; ser/deser error for block data for %s, exception was: %s",
+                     __func__, blockPos.ToString(), e.what());
+    }
+
+    // Ensure the block, when re-serialized with nType and nVersion matches what we had on disk. This defends
+    // against block serialization being sensitive to the caller's nType/nVersion flags. Block serialization
+    // should always be the same irrespective of flags provided, otherwise this ReadRawBlockFromDisk() function
+    // cannot be used and caller should be using ReadBlockFromDisk() instead (see net_processing.cpp where this
+    // function is called).
+    if (!std::equal(rawBlock.begin(), rawBlock.end(), rawBlock2.begin(), rawBlock2.end())) {
+        return error("%s: Consistency check failed; block raw data mismatches re-serialized version for block %s at"
+                     " %s, nType: %i, nVersion: %i", __func__, pindex->ToString(), blockPos.ToString(), nType,
+                     nVersion);
+    }
+    // Check the header (detects possible corruption; unlikely)
+    if (block.GetHash() != pindex->GetBlockHash()) {
+        return error("%s: Consistency check failed; GetHash() doesn't match index for %s at %s",
+                     __func__, pindex->ToString(), blockPos.ToString());
+    }
+    LogPrint(BCLog::BENCH, "%s: checks passed for block %s (%i bytes) in %s msec\n", __func__,
+             block.GetHash().ToString(), rawBlock2.size(), elapsed.msecStr());
+    return true;
+}
+
 bool ReadRawBlockFromDisk(std::vector<uint8_t> &rawBlock, const CBlockIndex *pindex,
                           const CChainParams &chainParams, int nType, int nVersion) {
     uint64_t blockSize;
@@ -502,42 +654,40 @@ bool ReadRawBlockFromDisk(std::vector<uint8_t> &rawBlock, const CBlockIndex *pin
                      __func__, blockPos.ToString(), e.what());
     }
 
-    if (fCheckBlockReads) {
-        // This is normally only enabled for regtest and is provided in order to guarantee additional sanity checks
-        // when returning raw blocks in this manner. For real networks, we prefer the performance benefit of not
-        // deserializing and not doing these slower checks here.
-        Tic elapsed;
-        CBlock block;
-        std::vector<uint8_t> rawBlock2;
-        rawBlock2.reserve(rawBlock.size());
+    if (fCheckBlockReads && !CheckRawBlockRead(rawBlock, pindex, blockPos, nType, nVersion)) {
+        return false;
+    }
 
-        try {
-            VectorReader(nType, nVersion, rawBlock, 0) >> block;
-            CVectorWriter(nType, nVersion, rawBlock2, 0) << block;
-        } catch (const std::exception &e) {
-            return error("%s: Consistency check failed; ser/deser error for block data for %s, exception was: %s",
-                         __func__, blockPos.ToString(), e.what());
-        }
+    return true;
+}
 
-        // Ensure the block, when re-serialized with nType and nVersion matches what we had on disk. This defends
-        // against block serialization being sensitive to the caller's nType/nVersion flags. Block serialization
-        // should always be the same irrespective of flags provided, otherwise this ReadRawBlockFromDisk() function
-        // cannot be used and caller should be using ReadBlockFromDisk() instead (see net_processing.cpp where this
-        // function is called).
-        if (rawBlock != rawBlock2) {
-            return error("%s: Consistency check failed; block raw data mismatches re-serialized version for block %s at"
-                         " %s, nType: %i, nVersion: %i", __func__, pindex->ToString(), blockPos.ToString(), nType,
-                         nVersion);
+bool ReadRawBlockFromDisk(SharedByteSpan &rawBlock, const CBlockIndex *pindex,
+                          const CChainParams &chainParams, int nType, int nVersion) {
+    rawBlock = {};
+    if (fMmapBlockReads) {
+        const FlatFilePos blockPos = WITH_LOCK(cs_main, return pindex->GetBlockPos());
+        if (blockPos.IsNull()) {
+            return error("%s: Block file missing for block %s (height: %i)", __func__,
+                         pindex->GetBlockHash().ToString(), pindex->nHeight);
         }
-        // Check the header (detects possible corruption; unlikely)
-        if (block.GetHash() != pindex->GetBlockHash()) {
-            return error("%s: Consistency check failed; GetHash() doesn't match index for %s at %s",
-                         __func__, pindex->ToString(), blockPos.ToString());
+        if (!ReadMappedBlock(rawBlock, blockPos, &chainParams.DiskMagic())) {
+            return false;
+        }
+        if (!rawBlock.empty()) {
+            if (fCheckBlockReads && !CheckRawBlockRead(rawBlock.span(), pindex, blockPos, nType, nVersion)) {
+                rawBlock = {};
+                return false;
+            }
+            return true;
         }
-        LogPrint(BCLog::BENCH, "%s: checks passed for block %s (%i bytes) in %s msec\n", __func__,
-                 block.GetHash().ToString(), rawBlock2.size(), elapsed.msecStr());
     }
 
+    // Not mapped: read into a buffer that rawBlock takes ownership of
+    std::vector<uint8_t> buffer;
+    if (!ReadRawBlockFromDisk(buffer, pindex, chainParams, nType, nVersion)) {
+        return false;
+    }
+    rawBlock = SharedByteSpan(std::move(buffer));
     return true;
 }
 
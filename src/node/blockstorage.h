@@ -8,6 +8,7 @@
 #include <fs.h>
 #include <primitives/blockhash.h>
 #include <sync.h>
+#include <util/mappedfile.h>
 
 #include <atomic>
 #include <cstddef>
@@ -30,6 +31,10 @@ struct Params;
 
 /** Default for -stopafterblockimport */
 static constexpr bool DEFAULT_STOPAFTERBLOCKIMPORT = false;
+/** Default for -mmapblockreads */
+static constexpr bool DEFAULT_MMAP_BLOCK_READS = false;
+/** Maximum number of blk?????.dat files kept memory-mapped at once with -mmapblockreads */
+static constexpr size_t MAX_MAPPED_BLOCK_FILES = 16;
 
 /** The pre-allocation chunk size for blk?????.dat files (since 0.8) */
 static constexpr unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
@@ -48,9 +53,13 @@ extern std::atomic_bool fReindex;
 extern bool fHavePruned GUARDED_BY(cs_main);
 /** True if we're running in -prune mode. */
 extern bool fPruneMode;
+/** The base block of the UTXO snapshot that the chainstate was loaded from, if any (see utxosync/snapshot.h). */
+extern const CBlockIndex *pindexSnapshotBase GUARDED_BY(cs_main);
 /** Number of MiB of block files that we're trying to stay below. */
 extern uint64_t nPruneTarget;
 extern bool fCheckBlockReads;
+/** If true, blocks are read through memory mappings of the block files rather than with fread(). */
+extern bool fMmapBlockReads;
 extern RecursiveMutex cs_LastBlockFile;
 extern std::vector<CBlockFileInfo> vinfoBlockFile GUARDED_BY(cs_LastBlockFile);
 extern int nLastBlockFile GUARDED_BY(cs_LastBlockFile);
@@ -60,6 +69,9 @@ extern std::set<int> setDirtyFileInfo GUARDED_BY(cs_LastBlockFile);
 
 //! Check whether the block associated with this index entry is pruned or not.
 bool IsBlockPruned(const CBlockIndex *pblockindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+//! Check whether the block associated with this index entry is covered by the UTXO snapshot the chainstate was loaded
+//! from, so that we may never have had its data.
+bool IsBlockFromSnapshot(const CBlockIndex *pblockindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 void CleanupBlockRevFiles();
 
@@ -91,6 +103,13 @@ bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus
  * `nType` and `nVersion` parameters are used for `-checkblockreads` sanity checking of the serialized data. */
 bool ReadRawBlockFromDisk(std::vector<uint8_t> &rawBlock, const CBlockIndex *pindex, const CChainParams &chainParams,
                           int nType, int nVersion);
+/**
+ * Like the above, but without copying the block data if possible: with -mmapblockreads, `rawBlock` is a view straight
+ * into the memory-mapped block file, which stays mapped for as long as the view (or a copy of it) exists. Otherwise
+ * the data is read from disk into a buffer owned by `rawBlock`.
+ */
+bool ReadRawBlockFromDisk(SharedByteSpan &rawBlock, const CBlockIndex *pindex, const CChainParams &chainParams,
+                          int nType, int nVersion);
 
 /**
  *  Read just the block size for a given block. This is done by examining the on-disk block file data and is a
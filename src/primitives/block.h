@@ -63,7 +63,9 @@ public:
 
     SERIALIZE_METHODS(CBlock, obj) {
         READWRITEAS(CBlockHeader, obj);
-        READWRITE(obj.vtx);
+        SER_WRITE(obj, s << obj.vtx);
+        // Compute the txids together rather than one at a time
+        SER_READ(obj, UnserializeTransactions(s, obj.vtx));
     }
 
     void SetNull() {
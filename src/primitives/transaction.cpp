@@ -6,7 +6,9 @@
 
 #include <primitives/transaction.h>
 
+#include <crypto/sha256.h>
 #include <hash.h>
+#include <streams.h>
 #include <tinyformat.h>
 #include <util/strencodings.h>
 
@@ -105,6 +107,9 @@ CTransaction::CTransaction(const CMutableTransaction &tx)
 CTransaction::CTransaction(CMutableTransaction &&tx)
     : vin(std::move(tx.vin)), vout(std::move(tx.vout)), nVersion(tx.nVersion),
       nLockTime(tx.nLockTime), hash(ComputeHash()) {}
+CTransaction::CTransaction(CMutableTransaction &&tx, const TxHash &txhash)
+    : vin(std::move(tx.vin)), vout(std::move(tx.vout)), nVersion(tx.nVersion),
+      nLockTime(tx.nLockTime), hash(txhash) {}
 
 Amount CTransaction::GetValueOut() const {
     Amount nValueOut = Amount::zero();
@@ -137,3 +142,26 @@ std::string CTransaction::ToString(bool fVerbose) const {
     }
     return str;
 }
+
+size_t UnserializeTransactions(Span<const uint8_t> bytes, int nType, int nVersion, std::vector<CTransactionRef> &vtx) {
+    GenericVectorReader reader(nType, nVersion, bytes, 0);
+    const uint64_t nTxs = ReadCompactSize(reader);
+    std::vector<CMutableTransaction> txs;
+    std::vector<Span<const uint8_t>> preimages;
+    while (txs.size() < nTxs) {
+        const size_t begin = reader.GetPos();
+        reader >> txs.emplace_back();
+        preimages.push_back(bytes.subspan(begin, reader.GetPos() - begin));
+    }
+
+    std::vector<uint256> hashes(txs.size());
+    if (!txs.empty()) {
+        SHA256DMulti(hashes[0].begin(), preimages.data(), preimages.size());
+    }
+    vtx.clear();
+    vtx.reserve(txs.size());
+    for (size_t i = 0; i < txs.size(); ++i) {
+        vtx.push_back(std::make_shared<const CTransaction>(std::move(txs[i]), TxHash(hashes[i])));
+    }
+    return reader.GetPos();
+}
@@ -14,6 +14,7 @@
 #include <serialize.h>
 
 #include <algorithm>
+#include <concepts>
 #include <utility> // for std::move
 
 static const int SERIALIZE_TRANSACTION = 0x00;
@@ -263,6 +264,12 @@ public:
     /** Convert a CMutableTransaction into a CTransaction. */
     explicit CTransaction(const CMutableTransaction &tx);
     explicit CTransaction(CMutableTransaction &&tx);
+    /**
+     * Convert a CMutableTransaction that the caller hashed already (see
+     * UnserializeTransactions()). `txhash` must be the double SHA-256 of its
+     * serialization.
+     */
+    CTransaction(CMutableTransaction &&tx, const TxHash &txhash);
 
     /**
      * We prevent copy assignment & construction to enforce use of
@@ -393,6 +400,26 @@ static inline CTransactionRef MakeTransactionRef(Tx &&txIn) {
     return std::make_shared<const CTransaction>(std::forward<Tx>(txIn));
 }
 
+/**
+ * Deserialize a vector of transactions from the beginning of `bytes`, computing their hashes from the bytes they were
+ * parsed from with SHA256DMulti() at the end instead of one at a time. @returns the number of bytes read.
+ */
+size_t UnserializeTransactions(Span<const uint8_t> bytes, int nType, int nVersion, std::vector<CTransactionRef> &vtx);
+
+/**
+ * Deserialize a vector of transactions like `s >> vtx`. Streams that read from memory have their buffer parsed
+ * directly by the function above, other streams have each transaction hashed as it is read.
+ */
+template <typename Stream>
+void UnserializeTransactions(Stream &s, std::vector<CTransactionRef> &vtx) {
+    if constexpr (requires { { s.data() } -> std::convertible_to<const void *>; }) {
+        const Span<const uint8_t> bytes(reinterpret_cast<const uint8_t *>(s.data()), s.size());
+        s.ignore(UnserializeTransactions(bytes, s.GetType(), s.GetVersion(), vtx));
+    } else {
+        s >> vtx;
+    }
+}
+
 /// A class that wraps a pointer to either a CTransaction or a
 /// CMutableTransaction and presents a uniform view of the minimal
 /// intersection of both classes' exposed data.
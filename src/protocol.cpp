@@ -50,6 +50,12 @@ const char *const GETBLOCKTXN = "getblocktxn";
 const char *const BLOCKTXN = "blocktxn";
 const char *const EXTVERSION = "extversion";
 const char *const DSPROOF = "dsproof-beta";
+const char *const GETCFILTERS = "getcfilters";
+const char *const CFILTER = "cfilter";
+const char *const GETCFHEADERS = "getcfheaders";
+const char *const CFHEADERS = "cfheaders";
+const char *const GETCFCHECKPT = "getcfcheckpt";
+const char *const CFCHECKPT = "cfcheckpt";
 
 bool IsBlockLike(const std::string &msg_type) {
     return msg_type == NetMsgType::BLOCK ||
@@ -70,7 +76,8 @@ static const std::vector<std::string> allNetMessageTypesVec{{
     NetMsgType::PONG,        NetMsgType::NOTFOUND,   NetMsgType::FILTERLOAD,  NetMsgType::FILTERADD,
     NetMsgType::FILTERCLEAR, NetMsgType::REJECT,     NetMsgType::SENDHEADERS, NetMsgType::FEEFILTER,
     NetMsgType::SENDCMPCT,   NetMsgType::CMPCTBLOCK, NetMsgType::GETBLOCKTXN, NetMsgType::BLOCKTXN,
-    NetMsgType::EXTVERSION,  NetMsgType::DSPROOF,
+    NetMsgType::EXTVERSION,  NetMsgType::DSPROOF,    NetMsgType::GETCFILTERS, NetMsgType::CFILTER,
+    NetMsgType::GETCFHEADERS, NetMsgType::CFHEADERS, NetMsgType::GETCFCHECKPT, NetMsgType::CFCHECKPT,
 }};
 
 CMessageHeader::CMessageHeader(const MessageMagic &pchMessageStartIn) {
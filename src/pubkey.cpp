@@ -6,13 +6,19 @@
 
 #include <pubkey.h>
 
+#include <schnorrbatch.h>
 #include <secp256k1.h>
 #include <secp256k1_recovery.h>
 #include <secp256k1_schnorr.h>
 
+#include <algorithm>
+#include <array>
+
 namespace {
 /* Global secp256k1_context object used for verification. */
 secp256k1_context *secp256k1_context_verify = nullptr;
+/* Precomputed tables for SchnorrBatchVerifier, created along with secp256k1_context_verify. */
+schnorrbatch_context *schnorrbatch_context_verify = nullptr;
 } // namespace
 
 /**
@@ -331,6 +337,81 @@ bool CPubKey::CheckLowS(const std::span<const uint8_t> &vchSig) {
                                                  nullptr, &sig));
 }
 
+struct SchnorrBatchVerifier::Entry {
+    secp256k1_pubkey pubkey;
+    uint256 hash;
+    std::array<uint8_t, 64> sig;
+};
+
+SchnorrBatchVerifier::SchnorrBatchVerifier() = default;
+SchnorrBatchVerifier::~SchnorrBatchVerifier() = default;
+
+bool SchnorrBatchVerifier::Add(const CPubKey &pubkey, const uint256 &hash, const std::span<const uint8_t> &vchSig) {
+    if (!pubkey.IsValid() || vchSig.size() != 64) {
+        return false;
+    }
+    Entry &entry = entries.emplace_back();
+    if (!secp256k1_ec_pubkey_parse(secp256k1_context_verify, &entry.pubkey, pubkey.data(), pubkey.size())) {
+        entries.pop_back();
+        return false;
+    }
+    entry.hash = hash;
+    std::copy(vchSig.begin(), vchSig.end(), entry.sig.begin());
+    return true;
+}
+
+size_t SchnorrBatchVerifier::size() const {
+    return entries.size();
+}
+
+void SchnorrBatchVerifier::resize(size_t n) {
+    assert(n <= entries.size());
+    entries.resize(n);
+}
+
+void SchnorrBatchVerifier::clear() {
+    entries.clear();
+}
+
+bool SchnorrBatchVerifier::Verify() const {
+    if (entries.empty()) {
+        return true;
+    }
+    std::vector<const uint8_t *> sigs, msgs;
+    std::vector<const secp256k1_pubkey *> pubkeys;
+    sigs.reserve(entries.size());
+    msgs.reserve(entries.size());
+    pubkeys.reserve(entries.size());
+    for (const Entry &entry : entries) {
+        sigs.push_back(entry.sig.data());
+        msgs.push_back(entry.hash.data());
+        pubkeys.push_back(&entry.pubkey);
+    }
+    // Scratch space for the multi-multiplication, which is kept per thread and only grows to what the largest batch
+    // needs, up to a limit beyond which libsecp256k1 splits the batch up
+    static constexpr size_t MAX_SCRATCH_SIZE = 8 << 20;
+    struct Scratch {
+        secp256k1_scratch_space *space = nullptr;
+        size_t size = 0;
+        ~Scratch() {
+            if (space) {
+                secp256k1_scratch_space_destroy(secp256k1_context_no_precomp, space);
+            }
+        }
+    };
+    thread_local Scratch scratch;
+    const size_t needed = std::min(schnorrbatch_scratch_size(entries.size()), MAX_SCRATCH_SIZE);
+    if (needed > scratch.size) {
+        if (scratch.space) {
+            secp256k1_scratch_space_destroy(secp256k1_context_no_precomp, scratch.space);
+        }
+        scratch.space = secp256k1_scratch_space_create(secp256k1_context_no_precomp, needed);
+        scratch.size = scratch.space ? needed : 0;
+    }
+    return schnorrbatch_verify(schnorrbatch_context_verify, scratch.space, sigs.data(), msgs.data(), pubkeys.data(),
+                               entries.size());
+}
+
 /* static */ int ECCVerifyHandle::refcount = 0;
 
 ECCVerifyHandle::ECCVerifyHandle() {
@@ -339,6 +420,9 @@ ECCVerifyHandle::ECCVerifyHandle() {
         secp256k1_context_verify =
             secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
         assert(secp256k1_context_verify != nullptr);
+        assert(schnorrbatch_context_verify == nullptr);
+        schnorrbatch_context_verify = schnorrbatch_context_create();
+        assert(schnorrbatch_context_verify != nullptr);
     }
     refcount++;
 }
@@ -349,5 +433,8 @@ ECCVerifyHandle::~ECCVerifyHandle() {
         assert(secp256k1_context_verify != nullptr);
         secp256k1_context_destroy(secp256k1_context_verify);
         secp256k1_context_verify = nullptr;
+        assert(schnorrbatch_context_verify != nullptr);
+        schnorrbatch_context_destroy(schnorrbatch_context_verify);
+        schnorrbatch_context_verify = nullptr;
     }
 }
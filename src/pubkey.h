@@ -225,6 +225,33 @@ struct CExtPubKey {
     }
 };
 
+/**
+ * Collects Schnorr signatures to verify them all at once, which is considerably faster than verifying them one by one
+ * with CPubKey::VerifySchnorr(), but only tells whether all of them are valid.
+ */
+class SchnorrBatchVerifier {
+    struct Entry;
+    std::vector<Entry> entries;
+
+public:
+    SchnorrBatchVerifier();
+    ~SchnorrBatchVerifier();
+
+    /**
+     * Add a Schnorr signature (=64 bytes) to the batch. Returns false, and adds nothing, if the public key is not
+     * fully valid, or if the signature is not 64 bytes: VerifySchnorr() would fail right away for those.
+     */
+    bool Add(const CPubKey &pubkey, const uint256 &hash, const std::span<const uint8_t> &vchSig);
+
+    size_t size() const;
+    /// Forget the signatures that were added after the first `n`
+    void resize(size_t n);
+    void clear();
+
+    /// Returns whether all the signatures that were added are valid, true if there are none
+    bool Verify() const;
+};
+
 /**
  * Users of this module must hold an ECCVerifyHandle. The constructor and
  * destructor of these are not allowed to run in parallel, though.
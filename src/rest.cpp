@@ -220,7 +220,7 @@ static bool rest_block(const Config &config, HTTPRequest *req,
 
     const BlockHash hash(rawHash);
 
-    std::vector<uint8_t> rawBlock;
+    SharedByteSpan rawBlock;
     CBlockIndex *pblockindex = nullptr;
     CBlockIndex *tip = nullptr;
     {
@@ -245,12 +245,12 @@ static bool rest_block(const Config &config, HTTPRequest *req,
     switch (rf) {
         case RetFormat::BINARY: {
             req->WriteHeader("Content-Type", "application/octet-stream");
-            req->WriteReply(HTTP_OK, rawBlock);
+            req->WriteReply(HTTP_OK, rawBlock.span());
             return true;
         }
 
         case RetFormat::HEX: {
-            std::string strHex = HexStr(rawBlock) + "\n";
+            std::string strHex = HexStr(rawBlock.span()) + "\n";
             req->WriteHeader("Content-Type", "text/plain");
             req->WriteReply(HTTP_OK, strHex);
             return true;
@@ -258,7 +258,8 @@ static bool rest_block(const Config &config, HTTPRequest *req,
 
         case RetFormat::JSON: {
             CBlock block;
-            VectorReader(SER_NETWORK, PROTOCOL_VERSION, rawBlock, 0) >> block;
+            const Span<const uint8_t> data = rawBlock.span();
+            GenericVectorReader(SER_NETWORK, PROTOCOL_VERSION, data, 0) >> block;
             UniValue::Object objBlock = blockToJSON(config, block, tip, pblockindex, txOptions);
             std::string strJSON = UniValue::stringify(objBlock) + "\n";
             req->WriteHeader("Content-Type", "application/json");
@@ -660,6 +661,72 @@ static bool rest_getutxos(const std::any& context, Config &config, HTTPRequest *
     }
 }
 
+/// Reply with the result of an index RPC, turning its errors into HTTP errors.
+static bool rest_index_rpc(const std::any& context, Config &config, HTTPRequest *req, RetFormat rf,
+                           UniValue::Array &&params, UniValue (*rpc_fn)(const Config &, const JSONRPCRequest &)) {
+    switch (rf) {
+        case RetFormat::JSON: {
+            JSONRPCRequest jsonRequest;
+            jsonRequest.context = context;
+            jsonRequest.params = std::move(params);
+            UniValue result;
+            try {
+                result = rpc_fn(config, jsonRequest);
+            } catch (const JSONRPCError &e) {
+                if (e.code == RPC_INVALID_ADDRESS_OR_KEY || e.code == RPC_INVALID_PARAMETER) {
+                    return RESTERR(req, HTTP_BAD_REQUEST, e.message);
+                }
+                if (e.code == RPC_MISC_ERROR) {
+                    return RESTERR(req, HTTP_NOT_FOUND, e.message);
+                }
+                return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, e.message);
+            }
+            std::string strJSON = UniValue::stringify(result) + "\n";
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strJSON);
+            return true;
+        }
+        default: {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           "output format not found (available: json)");
+        }
+    }
+}
+
+/// Serve an address index RPC (getaddresshistory or getaddressutxos) for the address or script hash in the URI.
+static bool rest_address(const std::any& context, Config &config, HTTPRequest *req, const std::string &strURIPart,
+                         UniValue (*rpc_fn)(const Config &, const JSONRPCRequest &)) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string address;
+    const RetFormat rf = ParseDataFormat(address, strURIPart);
+    UniValue::Array params;
+    params.emplace_back(std::move(address));
+    return rest_index_rpc(context, config, req, rf, std::move(params), rpc_fn);
+}
+
+/// Serve getspentby for the outpoint (<txid>-<n>) in the URI.
+static bool rest_spentby(const std::any& context, Config &config, HTTPRequest *req, const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    const size_t sep = param.find('-');
+    int32_t nOutput;
+    if (sep == std::string::npos || !ParseInt32(param.substr(sep + 1), &nOutput)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+    }
+    UniValue::Array params;
+    params.reserve(2);
+    params.emplace_back(param.substr(0, sep));
+    params.emplace_back(nOutput);
+    return rest_index_rpc(context, config, req, rf, std::move(params), getspentby);
+}
+
 static const struct {
     const char *prefix;
     bool (*handler)(const std::any& context, Config &config, HTTPRequest *req,
@@ -677,6 +744,15 @@ static const struct {
     {"/rest/mempool/contents", rest_mempool_contents},
     {"/rest/headers/", rest_headers},
     {"/rest/getutxos", rest_getutxos},
+    {"/rest/addresshistory/", [](const std::any& context, Config &config, HTTPRequest *req,
+                                 const std::string &strReq) {
+        return rest_address(context, config, req, strReq, getaddresshistory);
+    }},
+    {"/rest/addressutxos/",   [](const std::any& context, Config &config, HTTPRequest *req,
+                                 const std::string &strReq) {
+        return rest_address(context, config, req, strReq, getaddressutxos);
+    }},
+    {"/rest/spentby/", rest_spentby},
 };
 
 void StartREST(const std::any& context) {
@@ -7,6 +7,7 @@
 #include <rpc/blockchain.h>
 
 #include <amount.h>
+#include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -18,7 +19,10 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <hash.h>
+#include <index/addressindex.h>
+#include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <node/blockstorage.h>
@@ -29,6 +33,7 @@
 #include <rpc/server_util.h>
 #include <rpc/util.h>
 #include <script/descriptor.h>
+#include <shutdown.h>
 #include <software_outdated.h>
 #include <streams.h>
 #include <sync.h>
@@ -39,6 +44,9 @@
 #include <util/defer.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <util/threadnames.h>
+#include <utxosync/backgroundvalidation.h>
+#include <utxosync/snapshot.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <warnings.h>
@@ -52,6 +60,7 @@
 #include <mutex>
 #include <optional>
 #include <string_view>
+#include <thread>
 
 struct CUpdatedBlock {
     uint256 hash;
@@ -489,29 +498,22 @@ static std::string EntryDescriptionString() {
            "       ... ]\n";
 }
 
-static UniValue::Object entryToJSON(const CTxMemPool &pool, const CTxMemPoolEntry &e)
-    EXCLUSIVE_LOCKS_REQUIRED(pool.cs) {
-    AssertLockHeld(pool.cs);
-
+static UniValue::Object entryToJSON(const CTxMemPoolSnapshot::Entry &e) {
     UniValue::Object info;
     info.reserve(5);
 
     UniValue::Object fees;
     fees.reserve(2);
-    fees.emplace_back("base", ValueFromAmount(e.GetFee()));
-    fees.emplace_back("modified", ValueFromAmount(e.GetModifiedFee()));
+    fees.emplace_back("base", ValueFromAmount(e.fee));
+    fees.emplace_back("modified", ValueFromAmount(e.modifiedFee));
 
     info.emplace_back("fees", std::move(fees));
-    info.emplace_back("size", e.GetTxSize());
-    info.emplace_back("time", e.GetTime());
-
-    const CTransaction &tx = e.GetTx();
+    info.emplace_back("size", e.size);
+    info.emplace_back("time", e.time);
 
     std::set<std::string> setDepends;
-    for (const CTxIn &txin : tx.vin) {
-        if (pool.exists(txin.prevout.GetTxId())) {
-            setDepends.insert(txin.prevout.GetTxId().ToString());
-        }
+    for (const TxId &parent : e.depends) {
+        setDepends.insert(parent.ToString());
     }
     UniValue::Array depends;
     depends.reserve(setDepends.size());
@@ -521,39 +523,49 @@ static UniValue::Object entryToJSON(const CTxMemPool &pool, const CTxMemPoolEntr
     info.emplace_back("depends", std::move(depends));
 
     UniValue::Array spent;
-    const CTxMemPool::txiter &it = pool.mapTx.find(tx.GetId());
-    const CTxMemPool::setEntries &setChildren = pool.GetMemPoolChildren(it);
-    spent.reserve(setChildren.size());
-    for (CTxMemPool::txiter childiter : setChildren) {
-        spent.emplace_back(childiter->GetTx().GetId().ToString());
+    spent.reserve(e.spentBy.size());
+    for (const TxId &child : e.spentBy) {
+        spent.emplace_back(child.ToString());
     }
     info.emplace_back("spentby", std::move(spent));
 
     return info;
 }
 
-UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose) {
+static UniValue EntriesToJSON(const std::vector<const CTxMemPoolSnapshot::Entry *> &entries, bool verbose) {
     if (verbose) {
         UniValue::Object ret;
-        LOCK(pool.cs);
-        ret.reserve(pool.mapTx.size());
-        for (const CTxMemPoolEntry &e : pool.mapTx) {
-            const uint256 &txid = e.GetTx().GetId();
-            ret.emplace_back(txid.ToString(), entryToJSON(pool, e));
+        ret.reserve(entries.size());
+        for (const CTxMemPoolSnapshot::Entry *e : entries) {
+            ret.emplace_back(e->txid.ToString(), entryToJSON(*e));
         }
         return ret;
     }
 
-    std::vector<uint256> vtxids;
-    pool.queryHashes(vtxids);
     UniValue::Array ret;
-    ret.reserve(vtxids.size());
-    for (const uint256 &txid : vtxids) {
-        ret.emplace_back(txid.ToString());
+    ret.reserve(entries.size());
+    for (const CTxMemPoolSnapshot::Entry *e : entries) {
+        ret.emplace_back(e->txid.ToString());
     }
     return ret;
 }
 
+UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose) {
+    // Work from a snapshot so that building the (potentially huge) reply does
+    // not hold up the mempool.
+    const auto snapshot = pool.GetSnapshot();
+    return EntriesToJSON(snapshot->GetEntriesByEntryId(), verbose);
+}
+
+static const CTxMemPoolSnapshot::Entry &GetSnapshotEntry(const CTxMemPoolSnapshot &snapshot, const TxId &txid) {
+    const CTxMemPoolSnapshot::Entry *entry = snapshot.Find(txid);
+    if (!entry) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
+                           "Transaction not in mempool");
+    }
+    return *entry;
+}
+
 static UniValue getrawmempool(const Config &config,
                               const JSONRPCRequest &request) {
     if (request.fHelp || request.params.size() > 1) {
@@ -625,34 +637,9 @@ static UniValue getmempoolancestors(const Config &config,
 
     TxId txid(ParseHashV(request.params[0], "parameter 1"));
 
-    LOCK(g_mempool.cs);
-
-    CTxMemPool::txiter it = g_mempool.mapTx.find(txid);
-    if (it == g_mempool.mapTx.end()) {
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
-                           "Transaction not in mempool");
-    }
-
-    CTxMemPool::setEntries setAncestors;
-    g_mempool.CalculateMemPoolAncestors(*it, setAncestors, false);
-
-    if (!fVerbose) {
-        UniValue::Array ret;
-        ret.reserve(setAncestors.size());
-        for (CTxMemPool::txiter ancestorIt : setAncestors) {
-            ret.emplace_back(ancestorIt->GetTx().GetId().ToString());
-        }
-        return ret;
-    }
-
-    UniValue::Object ret;
-    ret.reserve(setAncestors.size());
-    for (CTxMemPool::txiter ancestorIt : setAncestors) {
-        const CTxMemPoolEntry &e = *ancestorIt;
-        const TxId &_txid = e.GetTx().GetId();
-        ret.emplace_back(_txid.ToString(), entryToJSON(::g_mempool, e));
-    }
-    return ret;
+    const auto snapshot = g_mempool.GetSnapshot();
+    const CTxMemPoolSnapshot::Entry &entry = GetSnapshotEntry(*snapshot, txid);
+    return EntriesToJSON(snapshot->GetAncestors(entry), fVerbose);
 }
 
 static UniValue getmempooldescendants(const Config &config,
@@ -691,36 +678,9 @@ static UniValue getmempooldescendants(const Config &config,
 
     TxId txid(ParseHashV(request.params[0], "parameter 1"));
 
-    LOCK(g_mempool.cs);
-
-    CTxMemPool::txiter it = g_mempool.mapTx.find(txid);
-    if (it == g_mempool.mapTx.end()) {
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
-                           "Transaction not in mempool");
-    }
-
-    CTxMemPool::setEntries setDescendants;
-    g_mempool.CalculateDescendants(it, setDescendants);
-    // CTxMemPool::CalculateDescendants will include the given tx
-    setDescendants.erase(it);
-
-    if (!fVerbose) {
-        UniValue::Array ret;
-        ret.reserve(setDescendants.size());
-        for (CTxMemPool::txiter descendantIt : setDescendants) {
-            ret.emplace_back(descendantIt->GetTx().GetId().ToString());
-        }
-        return ret;
-    }
-
-    UniValue::Object ret;
-    ret.reserve(setDescendants.size());
-    for (CTxMemPool::txiter descendantIt : setDescendants) {
-        const CTxMemPoolEntry &e = *descendantIt;
-        const TxId &_txid = e.GetTx().GetId();
-        ret.emplace_back(_txid.ToString(), entryToJSON(::g_mempool, e));
-    }
-    return ret;
+    const auto snapshot = g_mempool.GetSnapshot();
+    const CTxMemPoolSnapshot::Entry &entry = GetSnapshotEntry(*snapshot, txid);
+    return EntriesToJSON(snapshot->GetDescendants(entry), fVerbose);
 }
 
 static UniValue getmempoolentry(const Config &config,
@@ -744,16 +704,8 @@ static UniValue getmempoolentry(const Config &config,
 
     TxId txid(ParseHashV(request.params[0], "parameter 1"));
 
-    LOCK(g_mempool.cs);
-
-    CTxMemPool::txiter it = g_mempool.mapTx.find(txid);
-    if (it == g_mempool.mapTx.end()) {
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
-                           "Transaction not in mempool");
-    }
-
-    const CTxMemPoolEntry &e = *it;
-    return entryToJSON(::g_mempool, e);
+    const auto snapshot = g_mempool.GetSnapshot();
+    return entryToJSON(GetSnapshotEntry(*snapshot, txid));
 }
 
 static UniValue getblockhash(const Config &config,
@@ -902,6 +854,83 @@ static UniValue getblockheader(const Config &config,
     return blockheaderToJSON(config, tip, pindex);
 }
 
+static UniValue getblockfilter(const Config &config,
+                               const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2) {
+        throw std::runtime_error(
+            RPCHelpMan{"getblockfilter",
+                "\nRetrieve a BIP 157 content filter for a particular block.\n",
+                {
+                    {"blockhash", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The hash of the block"},
+                    {"filtertype", RPCArg::Type::STR, /* opt */ true, /* default_val */ "basic", "The type name of the filter"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "{\n"
+            "  \"filter\" : \"hex\",            (string) the hex-encoded filter data\n"
+            "  \"header\" : \"hex\"             (string) the hex-encoded filter header\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\" \"basic\"") +
+            HelpExampleRpc("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\", \"basic\""));
+    }
+
+    const BlockHash block_hash(ParseHashV(request.params[0], "blockhash"));
+    std::string filtertype_name = "basic";
+    if (!request.params[1].isNull()) {
+        filtertype_name = request.params[1].get_str();
+    }
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(filtertype_name, filtertype)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown filtertype");
+    }
+
+    BlockFilterIndex *index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Index is not enabled for filtertype " + filtertype_name);
+    }
+
+    const CBlockIndex *block_index;
+    bool block_was_connected;
+    {
+        LOCK(cs_main);
+        block_index = LookupBlockIndex(block_hash);
+        if (!block_index) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+        block_was_connected = block_index->IsValid(BlockValidity::SCRIPTS);
+    }
+
+    const bool index_ready = index->BlockUntilSyncedToCurrentChain();
+
+    BlockFilter filter;
+    uint256 filter_header;
+    if (!index->LookupFilter(block_index, filter) || !index->LookupFilterHeader(block_index, filter_header)) {
+        RPCErrorCode err_code;
+        std::string errmsg = "Filter not found.";
+
+        if (!block_was_connected) {
+            err_code = RPC_INVALID_ADDRESS_OR_KEY;
+            errmsg += " Block was not connected to active chain.";
+        } else if (!index_ready) {
+            err_code = RPC_MISC_ERROR;
+            errmsg += " Block filters are still in the process of being indexed.";
+        } else {
+            err_code = RPC_INTERNAL_ERROR;
+            errmsg += " This error is unexpected and indicates index corruption.";
+        }
+
+        throw JSONRPCError(err_code, errmsg);
+    }
+
+    UniValue::Object ret;
+    ret.reserve(2);
+    ret.emplace_back("filter", HexStr(filter.GetEncodedFilter()));
+    ret.emplace_back("header", filter_header.GetHex());
+    return ret;
+}
+
 /// Helper for the below Read*Block*() functions
 template <typename BlockReadFunc>
 void GenericReadBlockHelper(const BlockReadFunc &readFunc) {
@@ -940,8 +969,8 @@ static CBlock ReadBlockChecked(const Config &config, const CBlockIndex *pblockin
 
 /// Lock-free -- will throw if block not found or was pruned, etc. Guaranteed to return valid bytes or fail.
 /// Like the above function but does no sanity checking on the block. Just returns the bytes it read from disk.
-static std::vector<uint8_t> ReadRawBlockUnchecked(const Config &config, const CBlockIndex *pblockindex) {
-    std::vector<uint8_t> rawBlock;
+static SharedByteSpan ReadRawBlockUnchecked(const Config &config, const CBlockIndex *pblockindex) {
+    SharedByteSpan rawBlock;
     GenericReadBlockHelper([&]{
         return ReadRawBlockFromDisk(rawBlock, pblockindex, config.GetChainParams(), SER_NETWORK,
                                     PROTOCOL_VERSION);
@@ -949,6 +978,227 @@ static std::vector<uint8_t> ReadRawBlockUnchecked(const Config &config, const CB
     return rawBlock;
 }
 
+/// Parse the "address" argument of the address index RPCs, which is either a cash address or a script hash.
+static uint256 ParseAddressOrScriptHash(const Config &config, const UniValue &param) {
+    const std::string &str = param.get_str();
+    if (str.size() == 64 && IsHex(str)) {
+        return ParseHashV(param, "address");
+    }
+    const CTxDestination dest = DecodeDestination(str, config.GetChainParams());
+    if (!IsValidDestination(dest)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address or script hash: " + str);
+    }
+    return AddressIndex::GetScriptHash(GetScriptForDestination(dest));
+}
+
+/// Get the address index once it has caught up with the active chain. Throws if it is disabled or still syncing.
+static const AddressIndex &GetSyncedAddressIndex() {
+    if (!g_address_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled. Use -addressindex to enable it.");
+    }
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           strprintf("Unable to get data because addressindex is still syncing. Current height: %d",
+                                     g_address_index->GetSummary().best_block_height));
+    }
+    return *g_address_index;
+}
+
+/// Get the confirmed unspent outputs of a script from the address index, or throw.
+static std::vector<AddressUtxo> FindAddressUtxos(const AddressIndex &index, const uint256 &scripthash) {
+    std::vector<AddressUtxo> utxos;
+    if (!index.FindUtxos(scripthash, utxos)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the unspent outputs from the address index");
+    }
+    return utxos;
+}
+
+UniValue getaddresshistory(const Config &config, const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2) {
+        throw std::runtime_error(
+            RPCHelpMan{"getaddresshistory",
+                "\nReturns the transactions that pay to or spend from an address. Requires -addressindex.\n"
+                "Confirmed transactions come first, in the order of the chain, followed by mempool transactions.\n",
+                {
+                    {"address", RPCArg::Type::STR, /* opt */ false, /* default_val */ "", "The address, or the hex-encoded script hash (the reversed SHA256 of the output script, as used by the Electrum protocol)"},
+                    {"include_mempool", RPCArg::Type::BOOL, /* opt */ true, /* default_val */ "true", "Whether to include mempool transactions"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\" : \"hex\",           (string) The transaction id\n"
+            "    \"height\" : n              (numeric) The height of the block containing the transaction, or 0 for a mempool transaction\n"
+            "  },\n"
+            "  ...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getaddresshistory", "\"bitcoincash:qq5lh6vcfn3f9hxrxxqs2tspqprxwysfrq5a3xzuu5\"") +
+            HelpExampleRpc("getaddresshistory", "\"bitcoincash:qq5lh6vcfn3f9hxrxxqs2tspqprxwysfrq5a3xzuu5\", false"));
+    }
+
+    const AddressIndex &index = GetSyncedAddressIndex();
+    const uint256 scripthash = ParseAddressOrScriptHash(config, request.params[0]);
+    const bool include_mempool = request.params[1].isNull() || request.params[1].get_bool();
+
+    std::vector<AddressHistoryEntry> history;
+    if (!index.FindHistory(scripthash, history)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the history from the address index");
+    }
+    UniValue::Array ret;
+    ret.reserve(history.size());
+    for (const AddressHistoryEntry &history_entry : history) {
+        UniValue::Object entry;
+        entry.reserve(2);
+        entry.emplace_back("txid", history_entry.txid.GetHex());
+        entry.emplace_back("height", history_entry.height);
+        ret.emplace_back(std::move(entry));
+    }
+
+    if (include_mempool) {
+        // The mempool overlay of the index is updated from the validation interface queue.
+        SyncWithValidationInterfaceQueue();
+        const std::vector<AddressUtxo> utxos = FindAddressUtxos(index, scripthash);
+        for (const TxId &txid : index.FindMempoolHistory(::g_mempool, scripthash, utxos)) {
+            UniValue::Object entry;
+            entry.reserve(2);
+            entry.emplace_back("txid", txid.GetHex());
+            entry.emplace_back("height", 0);
+            ret.emplace_back(std::move(entry));
+        }
+    }
+
+    return ret;
+}
+
+UniValue getaddressutxos(const Config &config, const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2) {
+        throw std::runtime_error(
+            RPCHelpMan{"getaddressutxos",
+                "\nReturns the unspent outputs that pay to an address. Requires -addressindex.\n",
+                {
+                    {"address", RPCArg::Type::STR, /* opt */ false, /* default_val */ "", "The address, or the hex-encoded script hash (the reversed SHA256 of the output script, as used by the Electrum protocol)"},
+                    {"include_mempool", RPCArg::Type::BOOL, /* opt */ true, /* default_val */ "true", "Whether to leave out outputs spent by mempool transactions and add the outputs of mempool transactions"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\" : \"hex\",           (string) The transaction id\n"
+            "    \"vout\" : n,               (numeric) The output index\n"
+            "    \"amount\" : x.xxx,         (numeric) The output value in " + CURRENCY_UNIT + "\n"
+            "    \"height\" : n,             (numeric) The height of the block that created the output, or 0 for a mempool transaction\n"
+            "    \"tokenData\" : {...}       (json object) CashToken data, only present if the output has a token\n"
+            "  },\n"
+            "  ...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getaddressutxos", "\"bitcoincash:qq5lh6vcfn3f9hxrxxqs2tspqprxwysfrq5a3xzuu5\"") +
+            HelpExampleRpc("getaddressutxos", "\"bitcoincash:qq5lh6vcfn3f9hxrxxqs2tspqprxwysfrq5a3xzuu5\", false"));
+    }
+
+    const AddressIndex &index = GetSyncedAddressIndex();
+    const uint256 scripthash = ParseAddressOrScriptHash(config, request.params[0]);
+    const bool include_mempool = request.params[1].isNull() || request.params[1].get_bool();
+
+    if (include_mempool) {
+        // The mempool overlay of the index is updated from the validation interface queue.
+        SyncWithValidationInterfaceQueue();
+    }
+    std::vector<AddressUtxo> utxos = FindAddressUtxos(index, scripthash);
+    if (include_mempool) {
+        index.ApplyMempool(::g_mempool, scripthash, utxos);
+    }
+
+    UniValue::Array ret;
+    ret.reserve(utxos.size());
+    for (const AddressUtxo &utxo : utxos) {
+        UniValue::Object entry;
+        entry.reserve(4u + bool(utxo.tokenDataPtr));
+        entry.emplace_back("txid", utxo.outpoint.GetTxId().GetHex());
+        entry.emplace_back("vout", utxo.outpoint.GetN());
+        entry.emplace_back("amount", ValueFromAmount(utxo.value));
+        entry.emplace_back("height", utxo.height);
+        if (utxo.tokenDataPtr) {
+            entry.emplace_back("tokenData", TokenDataToUniv(*utxo.tokenDataPtr));
+        }
+        ret.emplace_back(std::move(entry));
+    }
+    return ret;
+}
+
+UniValue getspentby(const Config &config, const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() < 2 || request.params.size() > 3) {
+        throw std::runtime_error(
+            RPCHelpMan{"getspentby",
+                "\nReturns the transaction input that spends an output. Requires -spentindex.\n",
+                {
+                    {"txid", RPCArg::Type::STR, /* opt */ false, /* default_val */ "", "The transaction id"},
+                    {"n", RPCArg::Type::NUM, /* opt */ false, /* default_val */ "", "vout number"},
+                    {"include_mempool", RPCArg::Type::BOOL, /* opt */ true, /* default_val */ "true", "Whether to look for a spender in the mempool if the output is not spent in the active chain"},
+                }}
+                .ToString() +
+            "\nResult (null if the output is not spent):\n"
+            "{\n"
+            "  \"txid\" : \"hex\",           (string) The id of the spending transaction\n"
+            "  \"vin\" : n,                (numeric) The index of the spending input\n"
+            "  \"height\" : n,             (numeric) The height of the block containing the spending transaction, or 0 for a mempool transaction\n"
+            "  \"blockhash\" : \"hex\"       (string, optional) The hash of that block\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getspentby", "\"txid\" 1") +
+            HelpExampleRpc("getspentby", "\"txid\", 1"));
+    }
+
+    if (!g_spent_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Spent index is not enabled. Use -spentindex to enable it.");
+    }
+
+    const TxId txid(ParseHashV(request.params[0], "txid"));
+    const int n = request.params[1].get_int();
+    if (n < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, vout must be positive");
+    }
+    const COutPoint outpoint(txid, n);
+    const bool include_mempool = request.params[2].isNull() || request.params[2].get_bool();
+
+    if (!g_spent_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           strprintf("Unable to get data because spentindex is still syncing. Current height: %d",
+                                     g_spent_index->GetSummary().best_block_height));
+    }
+
+    SpentIndexEntry entry;
+    if (g_spent_index->FindSpender(outpoint, entry)) {
+        const CBlockIndex *pindex = WITH_LOCK(cs_main, return ::ChainActive()[entry.height]);
+        UniValue::Object ret;
+        ret.reserve(3u + bool(pindex));
+        ret.emplace_back("txid", entry.txid.GetHex());
+        ret.emplace_back("vin", entry.input_index);
+        ret.emplace_back("height", entry.height);
+        if (pindex) {
+            ret.emplace_back("blockhash", pindex->GetBlockHash().GetHex());
+        }
+        return ret;
+    }
+
+    if (include_mempool) {
+        LOCK(g_mempool.cs);
+        if (const CTransaction *spender = g_mempool.GetConflictTx(outpoint)) {
+            const auto it = std::find_if(spender->vin.begin(), spender->vin.end(),
+                                         [&](const CTxIn &txin) { return txin.prevout == outpoint; });
+            UniValue::Object ret;
+            ret.reserve(3);
+            ret.emplace_back("txid", spender->GetId().GetHex());
+            ret.emplace_back("vin", it - spender->vin.begin());
+            ret.emplace_back("height", 0);
+            return ret;
+        }
+    }
+
+    return UniValue();
+}
+
 static UniValue getblock(const Config &config, const JSONRPCRequest &request) {
     if (request.fHelp || request.params.size() < 1 ||
         request.params.size() > 3) {
@@ -1098,7 +1348,7 @@ static UniValue getblock(const Config &config, const JSONRPCRequest &request) {
 
     if (verbosity <= 0) {
         const auto rawBlock = ReadRawBlockUnchecked(config, pblockindex);
-        return HexStr(rawBlock);
+        return HexStr(rawBlock.span());
     }
 
     const CBlock block = ReadBlockChecked(config, pblockindex);
@@ -1197,7 +1447,7 @@ static std::optional<CoinStats> GetUTXOStats(CCoinsView *view, const CoinStatsHa
     // best block.
     CHECK_NONFATAL(!pindex || pindex->GetBlockHash() == view->GetBestBlock());
 
-    return ComputeUTXOStats(view, ht, interruption_point);
+    return ComputeUTXOStats(view, ht, interruption_point, std::clamp(GetNumCores(), 1, MAX_UTXO_STATS_THREADS));
 }
 
 static CoinStatsHashType ParseHashType(const std::string_view ht) {
@@ -1537,6 +1787,10 @@ UniValue getblockchaininfo(const Config &config,
             "pruning is enabled (only present if pruning is enabled)\n"
             "  \"prune_target_size\": xxxxxx,  (numeric) the target size "
             "used by pruning (only present if automatic pruning is enabled)\n"
+            "  \"snapshot_base_height\": xxxxxx, (numeric) the height of the "
+            "UTXO snapshot that the chainstate was loaded from (only present until the history below it is validated)\n"
+            "  \"background_validation_height\": xxxxxx, (numeric) the height "
+            "up to which the history below the UTXO snapshot has been validated (only present until it is complete)\n"
             "  \"upgrade_status\": {           (json object) details about the next scheduled upgrade\n"
             "      \"name\": \"...\",                            (string) human-readable upgrade name\n"
             "      \"mempool_activated\": true|false,          (boolean) whether the upgrade has activated for the mempool\n"
@@ -1560,7 +1814,7 @@ UniValue getblockchaininfo(const Config &config,
     const CBlockIndex *tip = ::ChainActive().Tip();
     bool automatic_pruning = fPruneMode && gArgs.GetArg("-prune", 0) != 1;
     UniValue::Object obj;
-    obj.reserve(fPruneMode ? automatic_pruning ? 16 : 15 : 13);
+    obj.reserve((fPruneMode ? automatic_pruning ? 16 : 15 : 13) + (pindexSnapshotBase ? 2 : 0));
 
     obj.emplace_back("chain", config.GetChainParams().NetworkIDString());
     obj.emplace_back("blocks", ::ChainActive().Height());
@@ -1589,6 +1843,12 @@ UniValue getblockchaininfo(const Config &config,
         }
     }
 
+    if (pindexSnapshotBase) {
+        obj.emplace_back("snapshot_base_height", pindexSnapshotBase->nHeight);
+        obj.emplace_back("background_validation_height",
+                         utxosync::g_background_validation ? utxosync::g_background_validation->GetHeight() : -1);
+    }
+
     // "upgrade_status" sub-dictionary
     {
         const auto &consensus = config.GetChainParams().GetConsensus();
@@ -2547,46 +2807,359 @@ static UniValue savemempool(const Config &config,
     return UniValue();
 }
 
-//! Search for a given set of pubkey scripts and tokens
-static bool FindScriptPubKeysAndTokens(std::atomic<int> &scan_progress,
-                                       const std::atomic<bool> &should_abort,
-                                       int64_t &count, CCoinsViewCursor *cursor,
-                                       const std::set<CScript> &needles,
-                                       const std::set<token::Id> &tokenIds,
-                                       std::map<COutPoint, Coin> &out_results,
-                                       std::function<void()>& interruption_point) {
+static UniValue dumputxoset(const Config &config,
+                            const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            RPCHelpMan{"dumputxoset",
+                "\nWrites the unspent transaction output set at the chain tip to a file, as a UTXO snapshot that another "
+                "node can be bootstrapped from with loadutxoset.\n",
+                {
+                    {"path", RPCArg::Type::STR, /* opt */ false, /* default_val */ "", "The path of the snapshot file (either absolute or relative to the data directory)"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "{\n"
+            "  \"coins_written\" : n,        (numeric) The number of coins written\n"
+            "  \"base_hash\" : \"hash\",       (string) The hash of the block that the snapshot was taken at\n"
+            "  \"base_height\" : n,          (numeric) The height of that block\n"
+            "  \"ecmh\" : \"hash\",            (string) The ECMultiSet hash of the coins (as reported by gettxoutsetinfo \"ecmh\")\n"
+            "  \"path\" : \"path\",            (string) The absolute path of the snapshot file\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("dumputxoset", "\"utxo.dat\"") +
+            HelpExampleRpc("dumputxoset", "\"utxo.dat\""));
+    }
+
+    const fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    // Write to a temporary file first, so that a file at `path` is always complete
+    const fs::path temppath = path.string() + ".incomplete";
+    if (fs::exists(path)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, path.string() + " already exists. If you are sure this is what you "
+                                                                  "want, move it out of the way first");
+    }
+
+    const size_t nThreads = std::clamp(GetNumCores(), 1, utxosync::MAX_SNAPSHOT_THREADS);
+    utxosync::SnapshotMetadata metadata;
+    metadata.netMagic = config.GetChainParams().NetMagic();
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    {
+        LOCK(cs_main);
+        FlushStateToDisk();
+        // Use more shards than threads, so that a thread that got a sparse shard can take on another one
+        cursors = pcoinsdbview->CursorShards(std::min(nThreads * 8, MAX_CURSOR_SHARDS));
+        const CBlockIndex *pindex = LookupBlockIndex(cursors.front()->GetBestBlock());
+        assert(pindex);
+        metadata.baseBlockHash = pindex->GetBlockHash();
+        metadata.baseHeight = pindex->nHeight;
+        metadata.nChainTx = pindex->GetChainTxCount();
+        metadata.ablaState = pindex->GetAblaStateOpt();
+    }
+
+    FILE *filestr = fsbridge::fopen(temppath, "wb");
+    if (!filestr) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Unable to open " + temppath.string() + " for writing");
+    }
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    utxosync::SnapshotSummary summary;
+    try {
+        NodeContext& node = EnsureAnyNodeContext(request.context);
+        summary = utxosync::DumpSnapshot(file, metadata, cursors, nThreads, node.rpc_interruption_point);
+        if (!FileCommit(file.Get())) {
+            throw std::runtime_error("FileCommit failed");
+        }
+        file.fclose();
+        if (!RenameOver(temppath, path)) {
+            throw std::runtime_error("Unable to rename " + temppath.string());
+        }
+    } catch (const UniValue &) {
+        // Interrupted
+        file.fclose();
+        fs::remove(temppath);
+        throw;
+    } catch (const std::exception &e) {
+        file.fclose();
+        fs::remove(temppath);
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to write the UTXO snapshot: %s", e.what()));
+    }
+
+    UniValue::Object ret;
+    ret.reserve(5);
+    ret.emplace_back("coins_written", summary.nCoins);
+    ret.emplace_back("base_hash", metadata.baseBlockHash.GetHex());
+    ret.emplace_back("base_height", metadata.baseHeight);
+    ret.emplace_back("ecmh", summary.ecmhHash.GetHex());
+    ret.emplace_back("path", path.string());
+    return ret;
+}
+
+//! Held while loadutxoset loads a snapshot into the utxosync::SNAPSHOT_CHAINSTATE_DIR database
+static std::mutex g_utxosetload;
+
+static UniValue loadutxoset(const Config &config,
+                            const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() != 2) {
+        throw std::runtime_error(
+            RPCHelpMan{"loadutxoset",
+                "\nLoads a UTXO snapshot written by dumputxoset into the chainstate, and makes the block it was taken at "
+                "the chain tip. The blocks below it are downloaded and validated in the background afterwards, and the "
+                "node shuts down if they do not lead to the same coins. Until then, the coins are trusted, so only load "
+                "snapshots from a trusted source, and pass the hash obtained from a trusted node (with gettxoutsetinfo "
+                "\"ecmh\" at the snapshot block) as expected_hash. The snapshot is read and verified before it "
+                "replaces the chainstate.\n"
+                "This is only possible while the chain tip is the genesis block, once the header of the snapshot block "
+                "is known, and without -txindex, -coinstatsindex, -addressindex, -spentindex and -blockfilterindex. "
+                "The node does not advertise NODE_NETWORK after a restart until the background validation is "
+                "complete.\n",
+                {
+                    {"path", RPCArg::Type::STR, /* opt */ false, /* default_val */ "", "The path of the snapshot file (either absolute or relative to the data directory)"},
+                    {"expected_hash", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The expected ECMultiSet hash of the coins"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "{\n"
+            "  \"coins_loaded\" : n,         (numeric) The number of coins loaded\n"
+            "  \"base_hash\" : \"hash\",       (string) The hash of the block that the snapshot was taken at\n"
+            "  \"base_height\" : n,          (numeric) The height of that block\n"
+            "  \"ecmh\" : \"hash\",            (string) The ECMultiSet hash of the coins\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("loadutxoset", "\"utxo.dat\" \"<ecmh>\"") +
+            HelpExampleRpc("loadutxoset", "\"utxo.dat\", \"<ecmh>\""));
+    }
+
+    const fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    const uint256 expectedHash = ParseHashV(request.params[1], "expected_hash");
+    bool block_filter_index{false};
+    ForEachBlockFilterIndex([&block_filter_index](BlockFilterIndex &) { block_filter_index = true; });
+    if (g_txindex || g_coin_stats_index || g_address_index || g_spent_index || block_filter_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Loading a UTXO snapshot is incompatible with -txindex, -coinstatsindex, "
+                                           "-addressindex, -spentindex and -blockfilterindex");
+    }
+
+    FILE *filestr = fsbridge::fopen(path, "rb");
+    if (!filestr) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Unable to open " + path.string());
+    }
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    utxosync::SnapshotMetadata metadata;
+    try {
+        file >> metadata;
+    } catch (const std::exception &e) {
+        throw JSONRPCError(RPC_DESERIALIZATION_ERROR, strprintf("Unable to read the UTXO snapshot: %s", e.what()));
+    }
+    const Consensus::Params &consensusParams = config.GetChainParams().GetConsensus();
+    if (metadata.netMagic != config.GetChainParams().NetMagic()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "The UTXO snapshot is for a different network");
+    }
+
+    // Checked before the snapshot is loaded, so that a wrong snapshot fails early, and again once cs_main is taken
+    // for activating the snapshot, as things may have changed meanwhile
+    auto CheckSnapshotBlock = [&]() EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+        CBlockIndex *pindex = LookupBlockIndex(metadata.baseBlockHash);
+        if (!pindex || pindex->nHeight != metadata.baseHeight) {
+            throw JSONRPCError(RPC_MISC_ERROR, strprintf("The header of the snapshot block %s is not known yet",
+                                                         metadata.baseBlockHash.GetHex()));
+        }
+        if (pindex->nStatus.isInvalid()) {
+            throw JSONRPCError(RPC_MISC_ERROR, "The snapshot block is invalid");
+        }
+        if (IsUpgrade10Enabled(consensusParams, pindex) != metadata.ablaState.has_value()
+            || (metadata.ablaState && !metadata.ablaState->IsValid(consensusParams.ablaConfig))) {
+            throw JSONRPCError(RPC_MISC_ERROR, "The UTXO snapshot has a bad ABLA state");
+        }
+        if (::ChainActive().Height() != 0) {
+            throw JSONRPCError(RPC_MISC_ERROR, "A UTXO snapshot can only be loaded while the chain tip is the genesis "
+                                               "block");
+        }
+        return pindex;
+    };
+    WITH_LOCK(cs_main, CheckSnapshotBlock());
+
+    std::unique_lock<std::mutex> loadLock(g_utxosetload, std::try_to_lock);
+    if (!loadLock.owns_lock()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "A UTXO snapshot is already being loaded");
+    }
+
+    // Load and verify the snapshot into a database of its own, without holding cs_main
+    const size_t nThreads = std::clamp(GetNumCores(), 1, utxosync::MAX_SNAPSHOT_THREADS);
+    NodeContext &node = EnsureAnyNodeContext(request.context);
+    const auto interruption_point = [&node] {
+        if (ShutdownRequested()) {
+            throw JSONRPCError(RPC_CLIENT_NOT_CONNECTED, "Shutting down");
+        }
+        node.rpc_interruption_point();
+    };
+    // Whatever is left of the staging database once its files are moved or the load failed
+    Defer removeStaging([] {
+        boost::system::error_code ec;
+        fs::remove_all(GetDataDir() / utxosync::SNAPSHOT_CHAINSTATE_DIR, ec);
+    });
+    utxosync::SnapshotSummary summary;
+    {
+        CCoinsViewDB staging(utxosync::SNAPSHOT_COINS_DB_CACHE, false, true, utxosync::SNAPSHOT_CHAINSTATE_DIR);
+        try {
+            summary = utxosync::LoadSnapshot(file, metadata, staging, nThreads, expectedHash, interruption_point);
+        } catch (const UniValue &) {
+            throw;
+        } catch (const std::exception &e) {
+            throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to load the UTXO snapshot: %s", e.what()));
+        }
+    }
+
+    // Swap in the loaded coins
+    {
+        LOCK(cs_main);
+        CBlockIndex *pindex = CheckSnapshotBlock();
+        FlushStateToDisk();
+        if (!pcoinsdbview->ReplaceWith(utxosync::SNAPSHOT_CHAINSTATE_DIR)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to replace the chainstate with the UTXO snapshot");
+        }
+        if (!ActivateSnapshotChainstate(config, pindex, metadata.nChainTx, metadata.ablaState, summary.ecmhHash)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to activate the chainstate loaded from the UTXO snapshot");
+        }
+        if (!utxosync::StartBackgroundValidation(config, /* fWipe = */ true)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to start validating the history below the UTXO snapshot");
+        }
+    }
+
+    // Connect any blocks we already have on top of the snapshot
+    CValidationState state;
+    if (!ActivateBestChain(config, state)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, FormatStateMessage(state));
+    }
+
+    UniValue::Object ret;
+    ret.reserve(4);
+    ret.emplace_back("coins_loaded", summary.nCoins);
+    ret.emplace_back("base_hash", metadata.baseBlockHash.GetHex());
+    ret.emplace_back("base_height", metadata.baseHeight);
+    ret.emplace_back("ecmh", summary.ecmhHash.GetHex());
+    return ret;
+}
+
+bool ScanTxOutNeedles::Matches(const CTxOut &txout) const {
+    return scriptPubKeys.count(txout.scriptPubKey)
+           || (txout.tokenDataPtr && tokenIds.count(txout.tokenDataPtr->GetId()));
+}
+
+//! @returns the position of `txid` in the key space of the coins database, from 0 to 65535
+static uint32_t ScanPosition(const TxId &txid) {
+    return 0x100 * *txid.begin() + *(txid.begin() + 1);
+}
+
+bool FindScriptPubKeysAndTokens(std::atomic<int> &scan_progress, const std::atomic<bool> &should_abort,
+                                int64_t &count, const std::vector<std::unique_ptr<CCoinsViewCursor>> &cursors,
+                                const ScanTxOutNeedles &needles, std::map<COutPoint, Coin> &out_results,
+                                const std::function<void()> &interruption_point, size_t nThreads) {
+    assert(nThreads > 0);
     scan_progress = 0;
     count = 0;
-    while (cursor->Valid()) {
-        COutPoint key;
-        Coin coin;
-        if (!cursor->GetKey(key) || !cursor->GetValue(coin)) {
-            return false;
-        }
-        if (++count % 8192 == 0) {
-            interruption_point();
-            if (should_abort) {
-                // allow to abort the scan via the abort reference
-                return false;
+
+    struct Worker {
+        int64_t count{};
+        std::map<COutPoint, Coin> results;
+        bool success{true};
+    };
+    std::vector<Worker> workers(std::min(nThreads, cursors.size()));
+    std::atomic<size_t> nextCursor{0};
+    std::atomic<bool> fAbort{false};
+    // Sum of the key space that has been scanned, out of 65536, summed over all cursors
+    std::atomic<uint32_t> scanned{0};
+
+    auto work = [&](Worker &worker, bool isCallingThread) {
+        for (size_t n; (n = nextCursor++) < cursors.size();) {
+            if (should_abort || fAbort || ShutdownRequested()) {
+                worker.success = false;
+                fAbort = true;
+                return;
             }
+            // The key space of the shard, as split up by CCoinsViewDB::CursorShards(); the progress is accounted over
+            // all of it, including the ranges before the first and after the last coin of the shard.
+            const uint32_t shardBegin = n * 0x100 / cursors.size() * 0x100;
+            const uint32_t shardEnd = (n + 1) * 0x100 / cursors.size() * 0x100;
+            uint32_t lastPosition = shardBegin;
+            auto advance = [&](uint32_t position) {
+                if (position <= lastPosition) {
+                    return;
+                }
+                const int progress = int((scanned += position - lastPosition) * 100.0 / 65536.0 + 0.5);
+                lastPosition = position;
+                // Other workers may have got further since, so never move the progress backwards
+                for (int current = scan_progress; current < progress;) {
+                    if (scan_progress.compare_exchange_weak(current, progress)) {
+                        break;
+                    }
+                }
+            };
+            CCoinsViewCursor &cursor = *cursors[n];
+            while (cursor.Valid()) {
+                COutPoint key;
+                Coin coin;
+                if (!cursor.GetKey(key) || !cursor.GetValue(coin)) {
+                    worker.success = false;
+                    fAbort = true;
+                    return;
+                }
+                if (++worker.count % 8192 == 0) {
+                    if (isCallingThread && interruption_point) {
+                        interruption_point();
+                    }
+                    if (should_abort || fAbort || ShutdownRequested()) {
+                        // allow to abort the scan via the abort reference
+                        worker.success = false;
+                        fAbort = true;
+                        return;
+                    }
+                }
+                if (worker.count % 256 == 0) {
+                    // update progress reference every 256 item
+                    advance(ScanPosition(key.GetTxId()));
+                }
+                if (needles.Matches(coin.GetTxOut())) {
+                    worker.results.emplace(key, std::move(coin));
+                }
+                cursor.Next();
+            }
+            advance(shardEnd);
         }
-        if (count % 256 == 0) {
-            // update progress reference every 256 item
-            const TxId &txid = key.GetTxId();
-            uint32_t high = 0x100 * *txid.begin() + *(txid.begin() + 1);
-            scan_progress = int(high * 100.0 / 65536.0 + 0.5);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < workers.size(); ++t) {
+        threads.emplace_back([&, t] {
+            util::ThreadRename("scantxoutset");
+            work(workers[t], false);
+        });
+    }
+    auto joinAll = [&] {
+        for (std::thread &thread : threads) {
+            thread.join();
         }
-        const CTxOut &txout = coin.GetTxOut();
-        if (needles.count(txout.scriptPubKey)
-                || (txout.tokenDataPtr && tokenIds.count(txout.tokenDataPtr->GetId()))) {
-            out_results.emplace(key, coin);
+    };
+    try {
+        if (!workers.empty()) {
+            work(workers.front(), true);
         }
-        cursor->Next();
+    } catch (...) {
+        fAbort = true;
+        joinAll();
+        throw;
     }
-    scan_progress = 100;
-    return true;
+    joinAll();
+
+    bool success = true;
+    for (Worker &worker : workers) {
+        count += worker.count;
+        success &= worker.success;
+        out_results.merge(worker.results);
+    }
+    return success;
 }
 
+//! The maximum number of threads that scantxoutset uses; reading the database stops scaling beyond
+static constexpr int MAX_SCAN_TXOUTSET_THREADS = 16;
+
 /** RAII object to prevent concurrency issue when scanning the txout set */
 static std::mutex g_utxosetscan;
 static std::atomic<int> g_scan_progress;
@@ -2737,8 +3310,7 @@ static UniValue scantxoutset(const Config &config,
                 RPC_INVALID_PARAMETER,
                 "Scan already in progress, use action \"abort\" or \"status\"");
         }
-        std::set<CScript> needles;
-        std::set<token::Id> tokenIds;
+        ScanTxOutNeedles needles;
         Amount total_in = Amount::zero();
 
         // loop through the scan objects
@@ -2775,7 +3347,7 @@ static UniValue scantxoutset(const Config &config,
                 // failed to Parse using "Descriptor" subsystem, try our custom "tok(<category>)" syntax as well
                 if (auto optTok = ParseTokenScanObject(desc_str)) {
                     // matched a tok(<category>) spec
-                    tokenIds.insert(std::move(*optTok));
+                    needles.tokenIds.insert(std::move(*optTok));
                     continue;
                 } else {
                     throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Invalid descriptor '%s'", desc_str));
@@ -2793,7 +3365,7 @@ static UniValue scantxoutset(const Config &config,
                             "Cannot derive script without private keys: '%s'",
                             desc_str));
                 }
-                needles.insert(scripts.begin(), scripts.end());
+                needles.scriptPubKeys.insert(scripts.begin(), scripts.end());
             }
         }
 
@@ -2802,16 +3374,21 @@ static UniValue scantxoutset(const Config &config,
         g_should_abort_scan = false;
         g_scan_progress = 0;
         int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
+        const size_t nThreads = std::clamp(GetNumCores(), 1, MAX_SCAN_TXOUTSET_THREADS);
+        std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
         {
             LOCK(cs_main);
             FlushStateToDisk();
-            pcursor = std::unique_ptr<CCoinsViewCursor>(pcoinsdbview->Cursor());
-            assert(pcursor);
+            // Use more shards than threads, so that a thread that got a sparse shard can take on another one
+            cursors = pcoinsdbview->CursorShards(std::min(nThreads * 8, MAX_CURSOR_SHARDS));
+            if (cursors.empty()) {
+                cursors.emplace_back(pcoinsdbview->Cursor());
+            }
+            assert(cursors.front());
         }
         NodeContext& node = EnsureAnyNodeContext(request.context);
-        bool const res = FindScriptPubKeysAndTokens(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles,
-                                                    tokenIds, coins, node.rpc_interruption_point);
+        bool const res = FindScriptPubKeysAndTokens(g_scan_progress, g_should_abort_scan, count, cursors, needles,
+                                                    coins, node.rpc_interruption_point, nThreads);
         UniValue::Array unspents;
         unspents.reserve(coins.size());
 
@@ -3057,10 +3634,15 @@ static const ContextFreeRPCCommand commands[] = {
     //  category            name                      actor (function)        argNames
     //  ------------------- ------------------------  ----------------------  ----------
     { "blockchain",         "finalizeblock",          finalizeblock,          {"blockhash"} },
+    { "blockchain",         "dumputxoset",            dumputxoset,            {"path"} },
     { "blockchain",         "getbestblockhash",       getbestblockhash,       {} },
     { "blockchain",         "getblock",               getblock,               {"blockhash","verbosity|verbose","patterns"} },
     { "blockchain",         "getblockchaininfo",      getblockchaininfo,      {} },
     { "blockchain",         "getblockcount",          getblockcount,          {} },
+    { "blockchain",         "getaddresshistory",      getaddresshistory,      {"address", "include_mempool"} },
+    { "blockchain",         "getaddressutxos",        getaddressutxos,        {"address", "include_mempool"} },
+    { "blockchain",         "getspentby",             getspentby,             {"txid", "n", "include_mempool"} },
+    { "blockchain",         "getblockfilter",         getblockfilter,         {"blockhash", "filtertype"} },
     { "blockchain",         "getblockhash",           getblockhash,           {"height"} },
     { "blockchain",         "getblockheader",         getblockheader,         {"blockhash|hash_or_height","verbose"} },
     { "blockchain",         "getblockstats",          getblockstats,          {"hash_or_height","stats"} },
@@ -3076,6 +3658,7 @@ static const ContextFreeRPCCommand commands[] = {
     { "blockchain",         "gettxout",               gettxout,               {"txid","n","include_mempool"} },
     { "blockchain",         "gettxoutsetinfo",        gettxoutsetinfo,        {"hash_type", "hash_or_height", "use_index"} },
     { "blockchain",         "invalidateblock",        invalidateblock,        {"blockhash"} },
+    { "blockchain",         "loadutxoset",            loadutxoset,            {"path", "expected_hash"} },
     { "blockchain",         "parkblock",              parkblock,              {"blockhash"} },
     { "blockchain",         "preciousblock",          preciousblock,          {"blockhash"} },
     { "blockchain",         "pruneblockchain",        pruneblockchain,        {"height"} },
@@ -5,11 +5,20 @@
 #pragma once
 
 #include <amount.h>
+#include <coins.h>
 #include <core_io.h>
+#include <primitives/token.h>
+#include <script/script.h>
 #include <sync.h>
 #include <univalue.h>
+#include <util/saltedhashers.h>
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_set>
 #include <vector>
 
 extern RecursiveMutex cs_main;
@@ -22,6 +31,9 @@ class JSONRPCRequest;
 namespace abla { class State; }
 
 UniValue getblockchaininfo(const Config &config, const JSONRPCRequest &request);
+UniValue getaddresshistory(const Config &config, const JSONRPCRequest &request);
+UniValue getaddressutxos(const Config &config, const JSONRPCRequest &request);
+UniValue getspentby(const Config &config, const JSONRPCRequest &request);
 
 static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
 
@@ -52,5 +64,24 @@ UniValue::Object blockheaderToJSON(const Config &config, const CBlockIndex *tip,
 /** ABLA state to JSON */
 UniValue::Object ablaStateToJSON(const Config &config, const abla::State &ablaState);
 
+/** The pubkey scripts and token categories that scantxoutset searches for */
+struct ScanTxOutNeedles {
+    std::unordered_set<CScript, ByteVectorHash> scriptPubKeys;
+    std::unordered_set<token::Id, SaltedUint256Hasher> tokenIds;
+
+    bool Matches(const CTxOut &txout) const;
+};
+
+/**
+ * Search the coins that `cursors` iterate over for `needles`, on up to `nThreads` threads (including the calling
+ * thread, which calls `interruption_point`). The cursors should be the shards of CCoinsView::CursorShards() (or a
+ * single cursor over all coins), as `scan_progress` accounts for the key space of each shard as it is finished.
+ * Returns false if the scan failed, or was aborted via `should_abort` or a shutdown request.
+ */
+bool FindScriptPubKeysAndTokens(std::atomic<int> &scan_progress, const std::atomic<bool> &should_abort,
+                                int64_t &count, const std::vector<std::unique_ptr<CCoinsViewCursor>> &cursors,
+                                const ScanTxOutNeedles &needles, std::map<COutPoint, Coin> &out_results,
+                                const std::function<void()> &interruption_point, size_t nThreads);
+
 /** Used by getblockstats to get feerates at different percentiles by weight  */
 void CalculatePercentilesBySize(Amount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<Amount, int64_t>>& scores, int64_t total_size);
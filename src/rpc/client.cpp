@@ -117,6 +117,10 @@ static const CRPCConvertParam vRPCConvertParams[] = {
     {"converttopsbt", 1, "permitsigdata"},
     {"gettxout", 1, "n"},
     {"gettxout", 2, "include_mempool"},
+    {"getaddresshistory", 1, "include_mempool"},
+    {"getaddressutxos", 1, "include_mempool"},
+    {"getspentby", 1, "n"},
+    {"getspentby", 2, "include_mempool"},
     {"gettxoutsetinfo", 1, "hash_or_height"},
     {"gettxoutsetinfo", 2, "use_index"},
     {"gettxoutproof", 0, "txids"},
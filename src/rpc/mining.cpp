@@ -517,6 +517,8 @@ static UniValue getblocktemplatecommon(bool fLight, const Config &config, const
     static std::unique_ptr<CBlockTemplate> pblocktemplate;
     static std::unique_ptr<LightResult> plightresult; // fLight mode only, cached result associated with pblocktemplate
     static bool fIgnoreCache = false;
+    // Keeps the transaction selection up to date with the mempool in between calls
+    static IncrementalBlockTemplate incrementalTemplate(g_mempool);
     bool fNewTip = (pindexPrev && pindexPrev != ::ChainActive().Tip());
     if (pindexPrev != ::ChainActive().Tip() || fIgnoreCache || ignoreCacheOverride ||
         (g_mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast &&
@@ -549,7 +551,8 @@ static UniValue getblocktemplatecommon(bool fLight, const Config &config, const
         CScript scriptDummy = CScript() << OP_TRUE;
         const CBlockIndex *pindexMinedTip{};
         pblocktemplate =
-            BlockAssembler(config, g_mempool).CreateNewBlock(scriptDummy, timeLimitSecs, checkValidity, &pindexMinedTip);
+            BlockAssembler(config, incrementalTemplate)
+                .CreateNewBlock(scriptDummy, timeLimitSecs, checkValidity, &pindexMinedTip);
         plightresult.reset();
         if (!pblocktemplate) {
             throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
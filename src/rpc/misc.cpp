@@ -9,7 +9,10 @@
 #include <config.h>
 #include <core_io.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
+#include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <logging.h>
@@ -598,6 +601,18 @@ static UniValue getindexinfo(const Config &, const JSONRPCRequest &request) {
         ExtendResult(SummaryToJSON(g_coin_stats_index->GetSummary()));
     }
 
+    if (g_address_index) {
+        ExtendResult(SummaryToJSON(g_address_index->GetSummary()));
+    }
+
+    if (g_spent_index) {
+        ExtendResult(SummaryToJSON(g_spent_index->GetSummary()));
+    }
+
+    ForEachBlockFilterIndex([&](const BlockFilterIndex &index) {
+        ExtendResult(SummaryToJSON(index.GetSummary()));
+    });
+
     return result;
 }
 // clang-format off
@@ -0,0 +1,200 @@
+/* Copyright (c) 2026 The Bitcoin developers
+ * Distributed under the MIT software license, see the accompanying
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php. */
+
+/* Built as part of the secp256k1 target (see src/CMakeLists.txt), with its configuration, flags and include paths,
+ * like src/secp256k1/src/secp256k1.c, whose internals it uses. */
+
+#include "include/secp256k1.h"
+
+#include "util.h"
+#include "num_impl.h"
+#include "field_impl.h"
+#include "scalar_impl.h"
+#include "group_impl.h"
+#include "ecmult_impl.h"
+#include "ecmult_gen_impl.h"
+#include "eckey_impl.h"
+#include "hash_impl.h"
+#include "scratch_impl.h"
+#include "modules/schnorr/schnorr_impl.h"
+
+#include "schnorrbatch.h"
+
+struct schnorrbatch_context_struct {
+    secp256k1_ecmult_context ecmult_ctx;
+    void *prealloc;
+};
+
+static void schnorrbatch_error_callback_fn(const char *str, void *data) {
+    (void)data;
+    fprintf(stderr, "[schnorrbatch] internal consistency check failed: %s\n", str);
+    abort();
+}
+
+static const secp256k1_callback schnorrbatch_error_callback = {
+    schnorrbatch_error_callback_fn,
+    NULL
+};
+
+schnorrbatch_context *schnorrbatch_context_create(void) {
+    void *prealloc;
+    schnorrbatch_context *ctx = (schnorrbatch_context *)malloc(sizeof(schnorrbatch_context));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->prealloc = malloc(SECP256K1_ECMULT_CONTEXT_PREALLOCATED_SIZE);
+    if (ctx->prealloc == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    prealloc = ctx->prealloc;
+    secp256k1_ecmult_context_init(&ctx->ecmult_ctx);
+    secp256k1_ecmult_context_build(&ctx->ecmult_ctx, &prealloc);
+    return ctx;
+}
+
+void schnorrbatch_context_destroy(schnorrbatch_context *ctx) {
+    if (ctx != NULL) {
+        secp256k1_ecmult_context_clear(&ctx->ecmult_ctx);
+        free(ctx->prealloc);
+        free(ctx);
+    }
+}
+
+size_t schnorrbatch_scratch_size(size_t n_sigs) {
+    /* Mirrors the choice of secp256k1_ecmult_multi_var(): R_i and P_i are two points per signature. */
+    const size_t n_points = 2 * n_sigs;
+    if (n_points >= ECMULT_PIPPENGER_THRESHOLD) {
+        return secp256k1_pippenger_scratch_size(n_points, secp256k1_pippenger_bucket_window(n_points)) +
+               PIPPENGER_SCRATCH_OBJECTS * ALIGNMENT;
+    }
+    return secp256k1_strauss_scratch_size(n_points) + STRAUSS_SCRATCH_OBJECTS * ALIGNMENT;
+}
+
+/** Like secp256k1_pubkey_load(), which is private to secp256k1.c. */
+static int schnorrbatch_pubkey_load(secp256k1_ge *ge, const secp256k1_pubkey *pubkey) {
+    if (sizeof(secp256k1_ge_storage) == 64) {
+        secp256k1_ge_storage s;
+        memcpy(&s, &pubkey->data[0], sizeof(s));
+        secp256k1_ge_from_storage(ge, &s);
+    } else {
+        secp256k1_fe x, y;
+        secp256k1_fe_set_b32(&x, pubkey->data);
+        secp256k1_fe_set_b32(&y, pubkey->data + 32);
+        secp256k1_ge_set_xy(ge, &x, &y);
+    }
+    return !secp256k1_fe_is_zero(&ge->x);
+}
+
+typedef struct {
+    const unsigned char *const *sig64;
+    const unsigned char *const *msg32;
+    const secp256k1_pubkey *const *pubkeys;
+    unsigned char seed[32];
+} schnorrbatch_data;
+
+/**
+ * The random coefficient a_i of the i-th signature. a_0 is 1, which does not weaken the batch as long as all the
+ * others are unpredictable.
+ */
+static void schnorrbatch_coefficient(secp256k1_scalar *a, const unsigned char *seed32, size_t i) {
+    secp256k1_sha256 sha;
+    unsigned char buf[32];
+    int j;
+
+    if (i == 0) {
+        secp256k1_scalar_set_int(a, 1);
+        return;
+    }
+
+    for (j = 0; j < 8; j++) {
+        buf[j] = (unsigned char)(((uint64_t)i) >> (8 * j));
+    }
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, seed32, 32);
+    secp256k1_sha256_write(&sha, buf, 8);
+    secp256k1_sha256_finalize(&sha, buf);
+    secp256k1_scalar_set_b32(a, buf, NULL);
+}
+
+/**
+ * Point 2i is R_i with the coefficient a_i, point 2i+1 is P_i with a_i * e_i. Fails, and with it the whole batch, if
+ * r_i is not the x coordinate of a point.
+ */
+static int schnorrbatch_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
+    const schnorrbatch_data *data = (const schnorrbatch_data *)cbdata;
+    const size_t i = idx / 2;
+    secp256k1_fe rx;
+    secp256k1_scalar e;
+
+    schnorrbatch_coefficient(sc, data->seed, i);
+    if (idx % 2 == 0) {
+        if (!secp256k1_fe_set_b32(&rx, data->sig64[i])) {
+            return 0;
+        }
+        return secp256k1_ge_set_xquad(pt, &rx);
+    }
+
+    if (!schnorrbatch_pubkey_load(pt, data->pubkeys[i]) || secp256k1_ge_is_infinity(pt)) {
+        return 0;
+    }
+    secp256k1_schnorr_compute_e(&e, data->sig64[i], pt, data->msg32[i]);
+    secp256k1_scalar_mul(sc, sc, &e);
+    return 1;
+}
+
+/**
+ * Every signature is valid iff R_i + e_i * P_i - s_i * G == 0 (see schnorr_impl.h), so with overwhelming probability
+ * all of them are iff sum(a_i * R_i + a_i * e_i * P_i) - sum(a_i * s_i) * G == 0 for random a_i, which is a single
+ * multi-multiplication.
+ */
+int schnorrbatch_verify(const schnorrbatch_context *ctx, secp256k1_scratch_space *scratch,
+                        const unsigned char *const *sig64, const unsigned char *const *msg32,
+                        const secp256k1_pubkey *const *pubkeys, size_t n_sigs) {
+    schnorrbatch_data data;
+    secp256k1_sha256 sha;
+    secp256k1_scalar s, a, sum;
+    secp256k1_gej r;
+    size_t i;
+    int overflow;
+
+    if (n_sigs == 0) {
+        return 1;
+    }
+    if (ctx == NULL || sig64 == NULL || msg32 == NULL || pubkeys == NULL || n_sigs > SIZE_MAX / 2) {
+        return 0;
+    }
+
+    /* Derive the coefficients from everything that is verified, so that invalid signatures cannot be crafted to
+     * cancel each other out. */
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_sha256_write(&sha, sig64[i], 64);
+        secp256k1_sha256_write(&sha, msg32[i], 32);
+        secp256k1_sha256_write(&sha, pubkeys[i]->data, sizeof(pubkeys[i]->data));
+    }
+    secp256k1_sha256_finalize(&sha, data.seed);
+
+    secp256k1_scalar_set_int(&sum, 0);
+    for (i = 0; i < n_sigs; i++) {
+        overflow = 0;
+        secp256k1_scalar_set_b32(&s, sig64[i] + 32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+        schnorrbatch_coefficient(&a, data.seed, i);
+        secp256k1_scalar_mul(&s, &s, &a);
+        secp256k1_scalar_add(&sum, &sum, &s);
+    }
+    secp256k1_scalar_negate(&sum, &sum);
+
+    data.sig64 = sig64;
+    data.msg32 = msg32;
+    data.pubkeys = pubkeys;
+    if (!secp256k1_ecmult_multi_var(&schnorrbatch_error_callback, &ctx->ecmult_ctx, scratch, &r, &sum,
+                                    schnorrbatch_callback, &data, 2 * n_sigs)) {
+        return 0;
+    }
+    return secp256k1_gej_is_infinity(&r);
+}
@@ -0,0 +1,58 @@
+/* Copyright (c) 2026 The Bitcoin developers
+ * Distributed under the MIT software license, see the accompanying
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php. */
+
+#ifndef BITCOIN_SCHNORRBATCH_H
+#define BITCOIN_SCHNORRBATCH_H
+
+#include <secp256k1.h>
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Batch verification of the Schnorr signatures of libsecp256k1's schnorr module. It needs the multi-multiplication
+ * of libsecp256k1, which is not part of its API, so it is built together with the library (with its configuration),
+ * but kept out of the subtree.
+ */
+
+/** Opaque data structure that holds the precomputed tables for schnorrbatch_verify(). */
+typedef struct schnorrbatch_context_struct schnorrbatch_context;
+
+/** Create a context (about 1 MiB, takes a few milliseconds). Returns NULL if out of memory. */
+SECP256K1_API schnorrbatch_context *schnorrbatch_context_create(void);
+
+/** Destroy a context created by schnorrbatch_context_create(). */
+SECP256K1_API void schnorrbatch_context_destroy(schnorrbatch_context *ctx);
+
+/**
+ * The size of a scratch space (see secp256k1_scratch_space_create()) that is large enough to verify a batch of n_sigs
+ * signatures with a single multi-multiplication. Smaller ones work as well, but split the batch up.
+ */
+SECP256K1_API size_t schnorrbatch_scratch_size(size_t n_sigs);
+
+/**
+ * Verify a batch of signatures created by secp256k1_schnorr_sign, all at once. This is considerably faster than
+ * verifying them one by one, but tells only whether all of them are correct, not which ones are not.
+ * Returns: 1: all signatures are correct (also if n_sigs is 0)
+ *          0: at least one signature is incorrect, or the scratch space is too small for a single point
+ * Args:    ctx:     a context created by schnorrbatch_context_create()
+ *          scratch: scratch space used for the multi-multiplication (can be NULL, which gives no speedup over
+ *                   verifying one by one), see schnorrbatch_scratch_size()
+ * In:      sig64:   array of pointers to the n_sigs 64-byte signatures
+ *          msg32:   array of pointers to the n_sigs 32-byte message hashes
+ *          pubkeys: array of pointers to the n_sigs public keys
+ *          n_sigs:  the number of signatures
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int schnorrbatch_verify(
+    const schnorrbatch_context *ctx, secp256k1_scratch_space *scratch, const unsigned char *const *sig64,
+    const unsigned char *const *msg32, const secp256k1_pubkey *const *pubkeys, size_t n_sigs) SECP256K1_ARG_NONNULL(1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BITCOIN_SCHNORRBATCH_H */
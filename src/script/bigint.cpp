@@ -91,6 +91,11 @@ auto UIntToULWordSpan(UInt *u, size_t count = 1u) /* -> Span<[const] ULWord> */
     return BytesToULWordSpan(Span<Byte>{reinterpret_cast<Byte *>(u), sizeof(UInt) * count});
 }
 
+// The absolute value of `x`, which always fits in an uint64_t (unlike in an int64_t for INT64_MIN)
+uint64_t AbsU64(int64_t x) {
+    return x < 0 ? uint64_t{0} - static_cast<uint64_t>(x) : static_cast<uint64_t>(x);
+}
+
 } // namespace
 
 struct BigInt::Impl : mpz_class {
@@ -113,6 +118,9 @@ struct BigInt::Impl : mpz_class {
      *  @post - this instance will store the value represented by inbuf.
      */
     void importWords(Span<const ULWord> inbuf);
+
+    /// Assign an int64_t, which does not fit in a long on LLP64 platforms such as Windows
+    void setInt64(int64_t x);
 };
 
 size_t BigInt::Impl::exportWords(Span<ULWord> outbuf) const {
@@ -131,33 +139,56 @@ void BigInt::Impl::importWords(Span<const ULWord> inbuf) {
     }
 }
 
-// Implicitly creates an instance on first use
+void BigInt::Impl::setInt64(int64_t x) {
+    if (NumFits<long>(x)) {
+        // This branch is always taken on LP64 platforms
+        base() = static_cast<long>(x);
+        return;
+    }
+    const uint64_t le_ux = SwapIfBigEndianHost(AbsU64(x), true);
+    importWords(UIntToULWordSpan(&le_ux));
+    if (x < 0) mpz_neg(get_mpz_t(), get_mpz_t());
+}
+
+// Promotes the inline value to m_p on first use
 BigInt::Impl &BigInt::p() {
-    if (!m_p) m_p = std::make_unique<Impl>();
+    if (!m_p) {
+        m_p = std::make_unique<Impl>();
+        if (m_small) m_p->setInt64(m_small);
+        m_small = 0;
+    }
     return *m_p;
 }
 
-/* static */ const BigInt::Impl BigInt::sharedZero;
+const BigInt::Impl &BigInt::p(Impl &tmp) const {
+    if (m_p) return *m_p;
+    tmp.setInt64(m_small);
+    return tmp;
+}
 
-const BigInt::Impl &BigInt::p() const noexcept {
-    if (!m_p) return sharedZero;
-    return *m_p;
+void BigInt::normalize() noexcept {
+    if (!m_p) return;
+    if (const auto val = getIntImpl<int64_t>()) {
+        m_small = *val;
+        m_p.reset();
+    }
 }
 
 BigInt::BigInt() noexcept {}
 BigInt::~BigInt() {} // we need to define this here due to pimpl idiom
 
 /* -- Move and copy -- */
-BigInt::BigInt(BigInt &&o) noexcept : m_p(std::move(o.m_p)) {}
+BigInt::BigInt(BigInt &&o) noexcept : m_small(std::exchange(o.m_small, 0)), m_p(std::move(o.m_p)) {}
 
-BigInt::BigInt(const BigInt &o) {
+BigInt::BigInt(const BigInt &o) : m_small(o.m_small) {
     if (o.m_p) m_p = std::make_unique<Impl>(*o.m_p);
 }
 
 BigInt &BigInt::operator=(BigInt &&o) noexcept {
     if (this != &o) {
-        // swap pointers, then re-initialize `o` to empty
+        // swap values, then re-initialize `o` to empty
         swap(o);
+        o.m_small = 0;
         if (o.m_p) o.m_p.reset();
     }
     return *this;
@@ -165,15 +196,21 @@ BigInt &BigInt::operator=(BigInt &&o) noexcept {
 
 BigInt &BigInt::operator=(const BigInt &o) {
     if (this != &o) {
-        if (o.m_p) p().base() = o.m_p->base();
-        else m_p.reset();
+        if (o.m_p) {
+            if (m_p) m_p->base() = o.m_p->base();
+            else m_p = std::make_unique<Impl>(*o.m_p);
+            m_small = 0;
+        } else {
+            m_p.reset();
+            m_small = o.m_small;
+        }
     }
     return *this;
 }
 
 /* static */
 void BigInt::swap(BigInt &o) noexcept {
-    // swap pointers
+    std::swap(m_small, o.m_small);
     m_p.swap(o.m_p);
 }
 
@@ -187,14 +224,13 @@ void BigInt::setIntImpl(I x) {
     constexpr bool issigned = std::is_signed_v<I>;
     using Int = std::conditional_t<issigned, I, std::make_signed_t<I>>;
     using UInt = std::make_unsigned_t<Int>;
-    using TargetType = std::conditional_t<issigned, long, unsigned long>;
-    if (NumFits<TargetType>(x)) {
-        // This branch is normally taken unless `Int` is `int128_t` or we are on on LLP64 platforms such as Windows
-        if (x) p().base() = static_cast<TargetType>(x);
-        else m_p.reset(); // clear (logically equivalent to 0)
+    if (std::in_range<int64_t>(x)) {
+        // This branch is normally taken unless `x` is an uint64_t above INT64_MAX, or a 128-bit int
+        m_p.reset();
+        m_small = static_cast<int64_t>(x);
         return;
     }
-    // This code-path may be taken sometimes on LLP64 platforms such as Windows, or if `Int` is int128_t
+    // The value doesn't fit inline, so it goes to m_p:
     // 1. Convert `x` to `UInt` (dropping any sign if `issigned == true`)
     // 2. Ensure little endian (if applicable)
     // 3. Assign to self using the `mpz_import` function which can read raw little endian data
@@ -223,6 +259,7 @@ void BigInt::setIntImpl(I x) {
     }
 
     // import in word-sized chunks
+    m_small = 0;
     p().importWords(UIntToULWordSpan(&std::as_const(le_ux)));
 
     // lastly, negate if `x` was negative
@@ -243,11 +280,15 @@ template <typename I>
 std::optional<I> BigInt::getIntImpl() const noexcept {
     static_assert(std::is_integral_v<I>);
     EnsureIntAtLeast64Bits<I>();
+    constexpr bool issigned = std::is_signed_v<I>;
     if (!m_p) {
-        // we are a default-constructed instance, return 0
-        return static_cast<I>(0);
+        // fast path -- the value is inline
+        if (!issigned && m_small < 0) {
+            // negative values unsupported in the unsigned case
+            return std::nullopt;
+        }
+        return static_cast<I>(m_small);
     }
-    constexpr bool issigned = std::is_signed_v<I>;
     if constexpr (issigned) {
         if (m_p->fits_slong_p()) {
             // fast path -- taken on LP64 platforms if the stored value is small enough
@@ -315,19 +356,27 @@ auto BigInt::getUInt128() const noexcept -> std::optional<uint128_t> { return ge
 #endif
 
 size_t BigInt::absValNumBits() const noexcept {
-    if (!m_p) return 1u; // empty/0 has 1 bit as per our API docs (which matches libgmp)
+    if (!m_p) {
+        // 0 has 1 bit as per our API docs (which matches libgmp)
+        return m_small ? std::bit_width(AbsU64(m_small)) : 1u;
+    }
     return mpz_sizeinbase(m_p->get_mpz_t(), 2);
 }
 
 int BigInt::sign() const noexcept {
-    const int val = !m_p ? 0 : mpz_sgn(m_p->get_mpz_t());
+    if (!m_p) return (m_small > 0) - (m_small < 0);
+    const int val = mpz_sgn(m_p->get_mpz_t());
     return std::clamp(val, -1, 1);
 }
 
 BigInt BigInt::abs() const {
     BigInt ret;
-    if (m_p) {
-        mpz_abs(ret.p().get_mpz_t(), m_p->get_mpz_t());
+    if (!m_p && m_small != std::numeric_limits<int64_t>::min()) {
+        ret.m_small = m_small < 0 ? -m_small : m_small;
+    } else {
+        Impl tmp;
+        mpz_abs(ret.p().get_mpz_t(), p(tmp).get_mpz_t());
+        ret.normalize();
     }
     return ret;
 }
@@ -341,52 +390,73 @@ BigInt BigInt::sqrt() const {
         throw std::domain_error("Attempted to take the square root of a negative value");
     } else if (sgn > 0) {
         // Positive, nonzero, actually do some work.
-        mpz_sqrt(ret.p().get_mpz_t(), p().get_mpz_t());
+        Impl tmp;
+        mpz_sqrt(ret.p().get_mpz_t(), p(tmp).get_mpz_t());
+        ret.normalize();
     } // else: For 0 we return a default-constructed BigInt (== 0).
     return ret;
 }
 
 BigInt BigInt::pow(unsigned long power) const {
     BigInt ret;
-    if (m_p) {
-        mpz_pow_ui(ret.p().get_mpz_t(), m_p->get_mpz_t(), power);
+    if (sign() != 0) {
+        Impl tmp;
+        mpz_pow_ui(ret.p().get_mpz_t(), p(tmp).get_mpz_t(), power);
+        ret.normalize();
     } else if (!power) {
         // anything to the 0 power is 1, including 0^0
         ret = 1;
-    } // else: 0 if !m_p && power != 0
+    } // else: 0 if we are 0 && power != 0
     return ret;
 }
 
 BigInt BigInt::powMod(const BigInt &exp, const BigInt &mod) const {
     BigInt ret;
-    if (!mod.m_p || mod.sign() == 0) {
+    if (mod.sign() == 0) {
         throw std::invalid_argument("A zero `mod` argument was provided to BigInt::powMod");
     }
     if (exp.sign() < 0) {
         // Even though it's possible to use a negative exponent with mpz_powm in some cases, we won't support it.
         throw std::invalid_argument("A negative `exp` argument was provided to BigInt::powMod");
     }
+    Impl tmpBase, tmpExp, tmpMod;
     mpz_powm(ret.p().get_mpz_t(), // result
-             p().get_mpz_t(), // base
-             exp.p().get_mpz_t(), // exp
-             mod.m_p->get_mpz_t()); // mod
+             p(tmpBase).get_mpz_t(), // base
+             exp.p(tmpExp).get_mpz_t(), // exp
+             mod.p(tmpMod).get_mpz_t()); // mod
+    ret.normalize();
     return ret;
 }
 
 BigInt BigInt::mathModulo(const BigInt &o) const {
-    if (!o.m_p || o.sign() == 0) throw std::invalid_argument("A zero `mod` argument was provided to BigInt::mathModulo");
+    if (o.sign() == 0) throw std::invalid_argument("A zero `mod` argument was provided to BigInt::mathModulo");
     BigInt ret;
-    if (m_p) {
-        mpz_mod(ret.p().get_mpz_t(), m_p->get_mpz_t(), o.m_p->get_mpz_t());
+    if (sign() != 0) {
+        Impl tmp, tmpO;
+        mpz_mod(ret.p().get_mpz_t(), p(tmp).get_mpz_t(), o.p(tmpO).get_mpz_t());
+        ret.normalize();
     }
     return ret;
 }
 
 std::vector<uint8_t> BigInt::serializeAbsVal(bool *neg) const {
     std::vector<uint8_t> ret;
+    serializeAbsVal(ret, neg);
+    return ret;
+}
+
+void BigInt::serializeAbsVal(std::vector<uint8_t> &ret, bool *neg) const {
+    ret.clear();
     const int sgn = sign();
-    if (sgn != 0) { // sign of 0 means value is 0, so if 0, we do nothing and return empty vector, otherwise do export
-        assert(m_p != nullptr);
+    if (sgn != 0 && !m_p) {
+        // fast path -- the value is inline, write out the bytes of its absolute value
+        uint64_t absval = AbsU64(m_small);
+        const size_t nbytes = absValNumBytes();
+        ret.reserve(nbytes + 1u); // reserve 1 extra in case caller needs to push 0x00 or 0x80
+        for (size_t i = 0; i < nbytes; ++i, absval >>= 8u) {
+            ret.push_back(static_cast<uint8_t>(absval & 0xffu));
+        }
+    } else if (sgn != 0) { // sign of 0 means value is 0, so if 0, we do nothing and return empty vector, otherwise do export
         const size_t nbytes = absValNumBytes();
         const size_t expectedCount = (nbytes + (ULSz-1u)) / ULSz;
         ret.reserve(std::max(expectedCount * ULSz, nbytes + 1u)); // reserve 1 extra in case caller needs to push 0x00 or 0x80
@@ -397,12 +467,17 @@ std::vector<uint8_t> BigInt::serializeAbsVal(bool *neg) const {
         ret.resize(nbytes); // shrink to exact byte size (possibly trims trailing high order zeroes)
     }
     if (neg) *neg = sgn < 0;
-    return ret;
 }
 
 std::vector<uint8_t> BigInt::serialize() const {
+    std::vector<uint8_t> ret;
+    serialize(ret);
+    return ret;
+}
+
+void BigInt::serialize(std::vector<uint8_t> &ret) const {
     bool neg;
-    auto ret = serializeAbsVal(&neg);
+    serializeAbsVal(ret, &neg);
     if (!ret.empty()) {
         if (ret.back() & 0x80u) {
             ret.push_back(neg ? 0x80u : 0x00u);
@@ -410,24 +485,28 @@ std::vector<uint8_t> BigInt::serialize() const {
             ret.back() |= 0x80u;
         }
     }
-    return ret;
 }
 
 void BigInt::unserialize(Span<const uint8_t> b) {
     if (b.empty() || (b.size() == 1 && (b.back() == 0x00u || b.back() == 0x80u))) {
         // empty vector, or zero or "negative zero" all map to 0.
-        m_p.reset(); // null Impl is logcally equivalent to 0
+        m_p.reset();
+        m_small = 0;
         return;
     }
 
     TellGCC(!b.empty()); // needed to suppress false positive warnings on newer GCC triggered by below code block
 
     const bool neg = b.back() & 0x80u; // save sign bit
-    if (b.size() == 1) {
-        // fast-path for tiny single-byte ints
-        long val = static_cast<long>(b.back() & 0x7fu); // take value without sign bit
-        if (neg) val = -val; // apply sign, if any
-        p().base() = val;
+    if (b.size() <= sizeof(int64_t)) {
+        // fast-path for ints of up to 8 bytes, which always fit inline since the top bit is the sign bit
+        uint64_t absval = b.back() & 0x7fu; // take value without sign bit
+        for (size_t i = b.size() - 1u; i-- > 0u;) {
+            absval = (absval << 8u) | b[i];
+        }
+        m_p.reset();
+        m_small = static_cast<int64_t>(absval);
+        if (neg) m_small = -m_small; // apply sign, if any
         return;
     }
     std::vector<uint8_t> tmp;
@@ -452,18 +531,30 @@ void BigInt::unserialize(Span<const uint8_t> b) {
     assert(sz > 0u && 0 == sz % ULSz); // The above code block ensured this predicate
 
     // Import in terms of unsigned-long sized words (this is faster than doing it byte-wise)
+    m_small = 0;
     p().importWords(BytesToULWordSpan(data));
 
     // Apply sign
     if (neg) {
         negate();
     }
+    // Non-minimal encodings may have more than 8 bytes for a small value
+    normalize();
 }
 
 void BigInt::negate() noexcept {
-    if (m_p && sign() != 0) {
+    if (!m_p) {
+        if (m_small != std::numeric_limits<int64_t>::min()) {
+            m_small = -m_small;
+            return;
+        }
+        // -INT64_MIN doesn't fit inline, so promote it first
+        p();
+    }
+    if (sign() != 0) {
         // negate by assigning the -mpz back to self. gmp supports input and output args being the same reference.
         mpz_neg(m_p->get_mpz_t(), m_p->get_mpz_t());
+        normalize();
     }
 }
 
@@ -472,10 +563,14 @@ int BigInt::compareImpl(IntType x) const {
     constexpr bool issigned = std::is_signed_v<IntType>;
     using TargetType = std::conditional_t<issigned, long, unsigned long>;
     if (!m_p) {
-        // short-circuit for a default-constructed or moved-from instance
-        if (constexpr IntType zero{}; x == zero) return 0;
-        else if (x > zero) return -1; // we are zero and x is positive, so we are smaller
-        return 1; // we are null (zero) and x is negative, so we are larger
+        // fast path -- the value is inline
+        if (std::in_range<int64_t>(x)) {
+            const auto val = static_cast<int64_t>(x);
+            return (m_small > val) - (m_small < val);
+        }
+        // `x` doesn't fit in an int64_t, so it is larger than us if positive, or smaller if negative
+        if (constexpr IntType zero{}; x > zero) return -1;
+        return 1;
     }
     if (NumFits<TargetType>(x)) {
         int val;
@@ -490,6 +585,8 @@ int BigInt::compareImpl(IntType x) const {
 }
 
 int BigInt::compare(const BigInt &o) const {
+    if (!m_p && !o.m_p) return (m_small > o.m_small) - (m_small < o.m_small);
+    // A value in m_p never fits in an int64_t, so it has a larger magnitude than any inline value
     if (!m_p) return -o.sign();
     else if (!o.m_p) return sign();
     const int val = mpz_cmp(m_p->get_mpz_t(), o.m_p->get_mpz_t());
@@ -505,33 +602,36 @@ int BigInt::compare(uint128_t x) const { return compareImpl(x); }
 #endif
 
 BigInt &BigInt::operator+=(const BigInt &o) {
-    if (o.m_p) {
-        p().base() += o.m_p->base();
-    }
+    if (!o.m_p) return applyArithOp(ArithOpType::Add, o.m_small);
+    p().base() += o.m_p->base();
+    normalize();
     return *this;
 }
 
 BigInt &BigInt::operator-=(const BigInt &o) {
-    if (o.m_p) {
-        p().base() -= o.m_p->base();
-    }
+    if (!o.m_p) return applyArithOp(ArithOpType::Sub, o.m_small);
+    p().base() -= o.m_p->base();
+    normalize();
     return *this;
 }
 
 BigInt &BigInt::operator*=(const BigInt &o) {
-    if (o.m_p) {
+    if (!o.m_p) return applyArithOp(ArithOpType::Mul, o.m_small);
+    if (sign() != 0) {
         p().base() *= o.m_p->base();
-    } else {
-        // set to 0
-        m_p.reset();
+        normalize();
     }
     return *this;
 }
 
 BigInt &BigInt::operator/=(const BigInt &o) {
-    if (!o.m_p || o == 0) throw std::invalid_argument("Attempted division by 0 in BigInt::operator/=");
+    if (!o.m_p) {
+        if (!o.m_small) throw std::invalid_argument("Attempted division by 0 in BigInt::operator/=");
+        return applyArithOp(ArithOpType::Div, o.m_small);
+    }
     // libgmpxx operator/= is the same as C++ normal division, so we just use that
     p().base() /= o.m_p->base();
+    normalize();
     return *this;
 }
 
@@ -550,14 +650,41 @@ BigInt &BigInt::applyArithOp(const ArithOpType op, const I x) {
             [[fallthrough]];
         case Mul:
             // If we are 0, or if x is 1 and we are not doing mod then no-op; bail early
-            if (!m_p || !sign() || (op != Mod && x == I{1})) return *this;
+            if (!sign() || (op != Mod && x == I{1})) return *this;
             // If multiplying by 0, or modding by 1, just set us to zero and bail early to save cycles
             else if ((!x && op == Mul) || (x == I{1} && op == Mod)) {
                 m_p.reset(); // clearing m_p is logically equivalent to 0
+                m_small = 0;
                 return *this;
             }
             break;
     }
+    if (!m_p && std::in_range<int64_t>(x)) {
+        // fast path -- both operands fit in an int64_t, so do it natively unless it overflows
+        const auto val = static_cast<int64_t>(x);
+        int64_t result{};
+        bool overflow{};
+        switch (op) {
+            case Add: overflow = __builtin_add_overflow(m_small, val, &result); break;
+            case Sub: overflow = __builtin_sub_overflow(m_small, val, &result); break;
+            case Mul: overflow = __builtin_mul_overflow(m_small, val, &result); break;
+            case Div:
+                // INT64_MIN / -1 is the only quotient that overflows
+                overflow = val == -1 && m_small == std::numeric_limits<int64_t>::min();
+                if (!overflow) result = m_small / val;
+                break;
+            case Mod:
+                // INT64_MIN % -1 is undefined in C++, but the remainder of anything divided by -1 is 0
+                overflow = false;
+                result = val == -1 ? 0 : m_small % val;
+                break;
+        }
+        if (!overflow) {
+            m_small = result;
+            return *this;
+        }
+        // overflowed, fall through to doing it with libgmp
+    }
     using LongOrULong = std::conditional_t<std::is_signed_v<I>, long, unsigned long>;
     if (NumFits<LongOrULong>(x)) {
         // `x` fits inside (unsigned) long; this branch taken on most platforms (LP64)
@@ -569,15 +696,21 @@ BigInt &BigInt::applyArithOp(const ArithOpType op, const I x) {
             case Mul: mpz *= static_cast<LongOrULong>(x); break;
             case Mod: mpz %= static_cast<LongOrULong>(x); break;
         }
+        normalize();
     } else {
-        // `x` doesn't fit. Must cast to BigInt (slower). This branch may be taken on LLP64 (Windows).
+        // `x` doesn't fit. Must do it with libgmp on both sides (slower). This branch may be taken on LLP64 (Windows).
+        Impl tmp;
+        const BigInt bx(x);
+        const mpz_class &o = bx.p(tmp).base();
+        mpz_class &mpz = p().base();
         switch (op) {
-            case Add: this->operator+=(BigInt(x)); break;
-            case Sub: this->operator-=(BigInt(x)); break;
-            case Div: this->operator/=(BigInt(x)); break;
-            case Mul: this->operator*=(BigInt(x)); break;
-            case Mod: this->operator%=(BigInt(x)); break;
+            case Add: mpz += o; break;
+            case Sub: mpz -= o; break;
+            case Div: mpz /= o; break;
+            case Mul: mpz *= o; break;
+            case Mod: mpz %= o; break;
         }
+        normalize();
     }
     return *this;
 }
@@ -594,46 +727,77 @@ BigInt &BigInt::operator/=(unsigned long long x) { return applyArithOp(ArithOpTy
 BigInt &BigInt::operator%=(unsigned long long x) { return applyArithOp(ArithOpType::Mod, x); }
 
 BigInt &BigInt::operator%=(const BigInt &o) {
-    if (!o.m_p || o == 0) throw std::invalid_argument("Attempted modulo by 0 in BigInt::operator%=");
+    if (!o.m_p) {
+        if (!o.m_small) throw std::invalid_argument("Attempted modulo by 0 in BigInt::operator%=");
+        return applyArithOp(ArithOpType::Mod, o.m_small);
+    }
     // libgmpxx operator%= is the same as C++ normal modulus, so we just use that
     p().base() %= o.m_p->base();
+    normalize();
     return *this;
 }
 
+// For the bitwise ops, libgmp behaves as if the values were in two's complement, just like int64_t does
+
 BigInt &BigInt::operator|=(const BigInt &o) {
-    if (o.m_p) {
-        p().base() |= o.m_p->base();
+    if (!m_p && !o.m_p) {
+        m_small |= o.m_small;
+    } else {
+        Impl tmp;
+        p().base() |= o.p(tmp).base();
+        normalize();
     }
     return *this;
 }
 
 BigInt &BigInt::operator&=(const BigInt &o) {
-    if (o.m_p) {
-        p().base() &= o.m_p->base();
+    if (!m_p && !o.m_p) {
+        m_small &= o.m_small;
     } else {
-        // o is 0, so we become 0.
-        m_p.reset();
+        Impl tmp;
+        p().base() &= o.p(tmp).base();
+        normalize();
     }
     return *this;
 }
 
 BigInt &BigInt::operator^=(const BigInt &o) {
-    if (o.m_p) {
-        p().base() ^= o.m_p->base();
+    if (!m_p && !o.m_p) {
+        m_small ^= o.m_small;
+    } else {
+        Impl tmp;
+        p().base() ^= o.p(tmp).base();
+        normalize();
     }
     return *this;
 }
 
-BigInt &BigInt::operator++() { ++p().base(); return *this; }
-BigInt &BigInt::operator--() { --p().base(); return *this; }
+BigInt &BigInt::operator++() { return applyArithOp(ArithOpType::Add, 1LL); }
+BigInt &BigInt::operator--() { return applyArithOp(ArithOpType::Sub, 1LL); }
 
 BigInt &BigInt::operator<<=(unsigned long x) {
-    p().base() <<= x;
+    if (!m_p && x < 63u) {
+        // fast path -- shift natively unless it overflows
+        if (int64_t result; !__builtin_mul_overflow(m_small, int64_t{1} << x, &result)) {
+            m_small = result;
+            return *this;
+        }
+    }
+    if (sign() != 0) {
+        p().base() <<= x;
+        normalize();
+    }
     return *this;
 }
 
 BigInt &BigInt::operator>>=(unsigned long x) {
+    if (!m_p) {
+        // Like libgmp, an arithmetic shift, which rounds towards negative infinity
+        m_small >>= std::min(x, 63ul);
+        return *this;
+    }
     p().base() >>= x;
+    normalize();
     return *this;
 }
 
@@ -645,14 +809,16 @@ std::string BigInt::ToString(const int base) const {
         throw std::invalid_argument(strprintf("Unsupported `base` argument to BigInt::ToString: %i", base));
     }
     std::string ret;
-    if (!m_p) {
+    if (sign() == 0) {
         // short-circuit return 0, which is the same in all bases
         ret.assign(1u, '0');
         return ret;
     }
-    const size_t nbytes = mpz_sizeinbase(m_p->get_mpz_t(), abase) + 2u; // from libgmp: +1 for possible sign and +1 for nul byte
+    Impl tmp;
+    const Impl &impl = p(tmp);
+    const size_t nbytes = mpz_sizeinbase(impl.get_mpz_t(), abase) + 2u; // from libgmp: +1 for possible sign and +1 for nul byte
     ret.resize(nbytes, '\0');
-    const char *const r = mpz_get_str(ret.data(), base, m_p->get_mpz_t());
+    const char *const r = mpz_get_str(ret.data(), base, impl.get_mpz_t());
     if (!r) {
         // This should never happen; gmp returns nullptr to indicate argument errors. Throw to indicate failure in case
         // different versions of libgmp behave differently w.r.t. the `base` arg.
@@ -674,6 +840,8 @@ std::optional<BigInt> BigInt::FromString(const char *const str, const unsigned b
         if (ret->p().set_str(str, base) != 0) {
             // an error occurred, reset the optional
             ret.reset();
+        } else {
+            ret->normalize();
         }
     }
     return ret;
@@ -681,16 +849,17 @@ std::optional<BigInt> BigInt::FromString(const char *const str, const unsigned b
 
 BigInt::BigInt(const char *const str, const unsigned base /* = 0 */) {
     if (auto opt = FromString(str, base)) {
-        // steal the `m_p` from *opt
-        m_p = std::move(opt->m_p);
+        // steal the value from *opt
+        *this = std::move(*opt);
     } else {
-        // oops, parse failure. Do nothing. We have no `m_p` but that's ok, we are 0 without an `m_p`.
+        // oops, parse failure. Do nothing. We are default-constructed, that is, 0.
     }
 }
 
 // ostream support
 std::ostream &operator<<(std::ostream &s, const BigInt &bi) {
-    return s << bi.p().base();
+    BigInt::Impl tmp;
+    return s << bi.p(tmp).base();
 }
 
 
@@ -728,13 +897,16 @@ void BigInt::InsecureRand::reseed(unsigned long s) {
 
 BigInt BigInt::InsecureRand::randRange(const BigInt &max) {
     BigInt ret;
-    ret.p().base() = p->gmpRand.get_z_range(max.p());
+    BigInt::Impl tmp;
+    ret.p().base() = p->gmpRand.get_z_range(max.p(tmp));
+    ret.normalize();
     return ret;
 }
 
 BigInt BigInt::InsecureRand::randBitCount(unsigned long n) {
     BigInt ret;
     ret.p().base() = p->gmpRand.get_z_bits(n);
+    ret.normalize();
     return ret;
 }
 
@@ -20,24 +20,25 @@
 #include <vector>
 
 /*
- * Arbitrary precision integer class. Supports most common arithmetic ops. This is implemented using the
- * pimpl idiom and is backed by libgmp.
+ * Arbitrary precision integer class. Supports most common arithmetic ops. Values that fit in an int64_t are stored
+ * inline and operated on natively, with overflow checks; larger values use the pimpl idiom and are backed by libgmp.
  *
  * Serialization is compatible with the `CScriptNum` (script number) format but unlike `CScriptNum`, serialized
  * numbers may be arbitrarily long.
  *
- * Default constructed instances do no allocations and occupy no extra space besides a nullptr.
- * Assigning values to this class may do some allocations, however.
+ * Instances whose value fits in an int64_t do no allocations. Values that do not fit are promoted to libgmp, which
+ * allocates, and results are moved back inline as soon as they fit again.
  */
 class BigInt {
     struct Impl;
-    std::unique_ptr<Impl> m_p; ///< We use the pimpl idiom for this class to hide implementation details
-    Impl &p(); // will construct m_p if one doesn't exist, and return it, or return existing m_p
-    const Impl &p() const noexcept; // returns a reference to m_p (if m_p is not null), or a ref to the static sharedZero
-    static const Impl sharedZero;
+    int64_t m_small{}; ///< The value if m_p is null, that is, if it fits in an int64_t
+    std::unique_ptr<Impl> m_p; ///< The value if it doesn't fit in m_small, using the pimpl idiom to hide libgmp
+    Impl &p(); // will promote the value to m_p if m_p doesn't exist, and return it, or return existing m_p
+    const Impl &p(Impl &tmp) const; // returns m_p if it exists, otherwise assigns the inline value to `tmp` and returns it
+    void normalize() noexcept; // moves the value back to m_small if m_p exists but the value fits in an int64_t
 
 public:
-    /// Default-construct with value 0. Does no allocations and occupies no extra space besides a nullptr.
+    /// Default-construct with value 0. Does no allocations.
     BigInt() noexcept;
 
     /// Destructor needs to be defined in .cpp file due to pimpl idiom
@@ -145,6 +146,8 @@ public:
 
     /// Returns a "minimally encoded" VM format representation (e.g. CScriptNum format).
     std::vector<uint8_t> serialize() const;
+    /// Like above, but writes to `out`, reusing its existing capacity (if any).
+    void serialize(std::vector<uint8_t> &out) const;
 
     /// Inverse of above, assign to this instance from VM representation.
     void unserialize(Span<const uint8_t> bytes);
@@ -334,6 +337,7 @@ private:
     /// Like serialize() above but does't have the quirky CScriptNum sign bit/byte. Returns just the raw little-endian
     /// absolute value, optionally setting `*neg` to true/false to indicate sign.
     std::vector<uint8_t> serializeAbsVal(bool *neg = nullptr) const;
+    void serializeAbsVal(std::vector<uint8_t> &ret, bool *neg) const;
 
     // Internal templated helpers
     template<typename I> std::optional<I> getIntImpl() const noexcept;
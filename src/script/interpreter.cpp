@@ -15,9 +15,12 @@
 #include <script/script.h>
 #include <script/script_flags.h>
 #include <script/sigencoding.h>
+#include <script/stackbufferpool.h>
+#include <streams.h>
 #include <tinyformat.h>
 #include <uint256.h>
 #include <util/bitmanip.h>
+#include <util/defer.h>
 
 #include <limits>
 #include <list>
@@ -44,10 +47,12 @@ bool CastToBool(const valtype &vch) {
  */
 #define stacktop(i) (stack.at(stack.size() + (i)))
 #define altstacktop(i) (altstack.at(altstack.size() + (i)))
-static inline void popstack(std::vector<valtype> &stack) {
+
+static inline void popstack(std::vector<valtype> &stack, StackBufferPool &pool) {
     if (stack.empty()) {
         throw std::runtime_error("popstack(): stack empty");
     }
+    pool.Recycle(std::move(stack.back()));
     stack.pop_back();
 }
 
@@ -356,6 +361,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
     using FunctionTable = std::map<valtype, const valtype>;
     FunctionTable functionTable;
 
+    StackBufferPool &pool = StackBufferPool::Get();
     std::vector<valtype> altstack;
     set_error(serror, ScriptError::UNKNOWN);
     int nOpCount = 0; /* Only used iff chipVmLimitsEnabled == false */
@@ -464,7 +470,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                         case OP_16: {
                             // ( -- value)
                             auto const bn = CScriptNum::fromIntUnchecked(int(opcode) - int(OP_1 - 1));
-                            stack.push_back(bn.getvch());
+                            stack.push_back(pool.Serialize(bn));
                             metrics.TallyPushOp(stack.back().size());
                             // The result of these opcodes should always be the
                             // minimal way to push the data they push, so no need
@@ -607,8 +613,8 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             }
 
                             // consume args
-                            popstack(stack);
-                            popstack(stack);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
                             // tally additional op cost: byte size of the function's code
                             metrics.TallyPushOp(it->second.size());
                         } break;
@@ -633,7 +639,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(serror, ScriptError::INVOKED_UNDEFINED_FUNCTION);
                             }
 
-                            popstack(stack);
+                            popstack(stack, pool);
                             evalStack.pushFrame(it->second); // MAX_SCRIPT_SIZE check done by pushFrame
                             // Tell enclosing code to pause evaluating the current script; and begin this frame's script
                             newEvalFrameWasPushed = true;
@@ -668,7 +674,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 if (opcode == OP_NOTIF) {
                                     fValue = !fValue;
                                 }
-                                popstack(stack);
+                                popstack(stack, pool);
                             }
                             curFrame.processIf(fValue);
                         } break;
@@ -696,7 +702,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                     return set_error(serror, ScriptError::INVALID_STACK_OPERATION);
                                 }
                                 fValue = CastToBool(stacktop(-1));
-                                popstack(stack);
+                                popstack(stack, pool);
                             }
                             if ( ! fValue) {
                                 // This branch is only taken if fExec is true and if the test condition was false.
@@ -730,7 +736,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             }
                             bool fValue = CastToBool(stacktop(-1));
                             if (fValue) {
-                                popstack(stack);
+                                popstack(stack, pool);
                             } else {
                                 return set_error(serror, ScriptError::VERIFY);
                             }
@@ -749,7 +755,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
                             altstack.push_back(std::move(stacktop(-1)));
-                            popstack(stack);
+                            popstack(stack, pool);
                             // Intentional: no tallying is done to metrics.TallyPushOp()
                         } break;
 
@@ -761,7 +767,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             }
                             stack.push_back(std::move(altstacktop(-1)));
                             metrics.TallyPushOp(stack.back().size());
-                            popstack(altstack);
+                            popstack(altstack, pool);
                         } break;
 
                         case OP_2DROP: {
@@ -770,8 +776,8 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            popstack(stack);
-                            popstack(stack);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
                         } break;
 
                         case OP_2DUP: {
@@ -780,8 +786,8 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            valtype vch1 = stacktop(-2);
-                            valtype vch2 = stacktop(-1);
+                            valtype vch1 = pool.Copy(stacktop(-2));
+                            valtype vch2 = pool.Copy(stacktop(-1));
                             stack.push_back(std::move(vch1));
                             metrics.TallyPushOp(stack.back().size());
                             stack.push_back(std::move(vch2));
@@ -794,9 +800,9 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            valtype vch1 = stacktop(-3);
-                            valtype vch2 = stacktop(-2);
-                            valtype vch3 = stacktop(-1);
+                            valtype vch1 = pool.Copy(stacktop(-3));
+                            valtype vch2 = pool.Copy(stacktop(-2));
+                            valtype vch3 = pool.Copy(stacktop(-1));
                             stack.push_back(std::move(vch1));
                             metrics.TallyPushOp(stack.back().size());
                             stack.push_back(std::move(vch2));
@@ -811,8 +817,8 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            valtype vch1 = stacktop(-4);
-                            valtype vch2 = stacktop(-3);
+                            valtype vch1 = pool.Copy(stacktop(-4));
+                            valtype vch2 = pool.Copy(stacktop(-3));
                             stack.push_back(std::move(vch1));
                             metrics.TallyPushOp(stack.back().size());
                             stack.push_back(std::move(vch2));
@@ -851,8 +857,8 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            valtype vch = stacktop(-1);
-                            if (CastToBool(vch)) {
+                            if (CastToBool(stacktop(-1))) {
+                                valtype vch = pool.Copy(stacktop(-1));
                                 stack.push_back(std::move(vch));
                                 metrics.TallyPushOp(stack.back().size());
                             }
@@ -861,7 +867,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                         case OP_DEPTH: {
                             // -- stacksize
                             auto const bn = CScriptNum::fromIntUnchecked(stack.size());
-                            stack.push_back(bn.getvch());
+                            stack.push_back(pool.Serialize(bn));
                             metrics.TallyPushOp(stack.back().size());
                         } break;
 
@@ -870,7 +876,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             if (stack.size() < 1) {
                                 return set_error(serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            popstack(stack);
+                            popstack(stack, pool);
                         } break;
 
                         case OP_DUP: {
@@ -879,7 +885,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            valtype vch = stacktop(-1);
+                            valtype vch = pool.Copy(stacktop(-1));
                             stack.push_back(std::move(vch));
                             metrics.TallyPushOp(stack.back().size());
                         } break;
@@ -890,6 +896,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
+                            pool.Recycle(std::move(stacktop(-2)));
                             stack.erase(stack.end() - 2);
                         } break;
 
@@ -899,7 +906,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(
                                     serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            valtype vch = stacktop(-2);
+                            valtype vch = pool.Copy(stacktop(-2));
                             stack.push_back(std::move(vch));
                             metrics.TallyPushOp(stack.back().size());
                         } break;
@@ -912,7 +919,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(serror, ScriptError::INVALID_STACK_OPERATION);
                             }
                             int64_t const n = CScriptNum(stacktop(-1), fRequireMinimal, maxIntegerSizeLegacy).getint64();
-                            popstack(stack);
+                            popstack(stack, pool);
                             if (n < 0 || uint64_t(n) >= stack.size()) {
                                 return set_error(serror, ScriptError::INVALID_STACK_OPERATION);
                             }
@@ -926,7 +933,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             } else {
                                 // The OP_PICK case must do a copy, but at least we save on not having to erase in the
                                 // middle and thus we don't have to slide everything over by 1 (hence extraCost = 0).
-                                vch = *it;
+                                vch = pool.Copy(*it);
                             }
                             stack.push_back(std::move(vch)); // move-construct to save on copying
                             metrics.TallyPushOp(stack.back().size());
@@ -958,7 +965,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             if (stack.size() < 2) {
                                 return set_error(serror, ScriptError::INVALID_STACK_OPERATION);
                             }
-                            valtype vch = stacktop(-1);
+                            valtype vch = pool.Copy(stacktop(-1));
                             metrics.TallyPushOp(vch.size());
                             stack.insert(stack.end() - 2, std::move(vch));
                         } break;
@@ -969,7 +976,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(serror, ScriptError::INVALID_STACK_OPERATION);
                             }
                             auto const bn = CScriptNum::fromIntUnchecked(stacktop(-1).size());
-                            stack.push_back(bn.getvch());
+                            stack.push_back(pool.Serialize(bn));
                             metrics.TallyPushOp(stack.back().size());
                         } break;
 
@@ -1016,7 +1023,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             metrics.TallyOp(vch1.size());
 
                             // And pop vch2.
-                            popstack(stack);
+                            popstack(stack, pool);
                         } break;
 
                         case OP_INVERT: {
@@ -1052,13 +1059,13 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 // (numerically, 0x01 == 0x0001 == 0x000001)
                                 // if (opcode == OP_NOTEQUAL)
                                 //    fEqual = !fEqual;
-                                popstack(stack);
-                                popstack(stack);
-                                stack.push_back(fEqual ? vchTrue : vchFalse);
+                                popstack(stack, pool);
+                                popstack(stack, pool);
+                                stack.push_back(pool.Copy(fEqual ? vchTrue : vchFalse));
                                 metrics.TallyPushOp(stack.back().size());
                                 if (opcode == OP_EQUALVERIFY) {
                                     if (fEqual) {
-                                        popstack(stack);
+                                        popstack(stack, pool);
                                     } else {
                                         return set_error(serror, ScriptError::EQUALVERIFY);
                                     }
@@ -1117,8 +1124,8 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                     assert(!"invalid opcode");
                                     break;
                             }
-                            popstack(stack);
-                            auto vch = bn.getvch();
+                            popstack(stack, pool);
+                            auto vch = pool.Serialize(bn);
                             // belt-and-suspenders check (BigInt case only)
                             if (UsesBigInt && vch.size() > maxScriptElementSize) {
                                 return set_error(serror, invalidNumberRangeError);
@@ -1252,10 +1259,10 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
 
                             metrics.TallyOp(quadraticOpCost); // is 0 for most opcodes except: MUL, MOD, DIV
 
-                            popstack(stack); // invalidates: vch1 and vch2
-                            popstack(stack);
+                            popstack(stack, pool); // invalidates: vch1 and vch2
+                            popstack(stack, pool);
                             {
-                                auto vch = bn.getvch();
+                                auto vch = pool.Serialize(bn);
                                 // Belt-and-suspenders check that we aren't overflowing the push limit in the BigInt case
                                 if (UsesBigInt && vch.size() > maxScriptElementSize) {
                                     return set_error(serror, invalidNumberRangeError);
@@ -1266,7 +1273,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
 
                             if (opcode == OP_NUMEQUALVERIFY) {
                                 if (CastToBool(stacktop(-1))) {
-                                    popstack(stack);
+                                    popstack(stack, pool);
                                 } else {
                                     return set_error(serror, ScriptError::NUMEQUALVERIFY);
                                 }
@@ -1302,7 +1309,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
 
                                 uint64_t const nbits = static_cast<uint64_t>(i32bits); // prefer uint64_t for below code
 
-                                popstack(stack); // consume nbits; numeric argument is now the topmost stack item
+                                popstack(stack, pool); // consume nbits; numeric argument is now the topmost stack item
 
                                 if (nbits == 0) {
                                     // If nbits == 0 the number already on the stack can remain, saving cycles, however we
@@ -1311,7 +1318,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 } else {
                                     // nbits > 0, we must do actual work
                                     ScriptNumType num(stacktop(-1), fRequireMinimal, maxIntegerSize);
-                                    popstack(stack); // consume numeric argument
+                                    popstack(stack, pool); // consume numeric argument
 
                                     bool valid{};
                                     if (opcode == OP_LSHIFTNUM) {
@@ -1327,7 +1334,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                         return set_error(serror, invalidNumberRangeError);
                                     }
 
-                                    valtype vch = num.getvch();
+                                    valtype vch = pool.Serialize(num);
                                     // Ensure result respects size limits; this check is redundant with the above code
                                     // block, but is here for belt-and-suspenders.
                                     if (vch.size() > maxScriptElementSize) {
@@ -1350,10 +1357,10 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             ScriptNumType const bn3(stacktop(-1), fRequireMinimal, maxIntegerSize);
 
                             bool fValue = (bn2 <= bn1 && bn1 < bn3);
-                            popstack(stack);
-                            popstack(stack);
-                            popstack(stack);
-                            stack.push_back(fValue ? vchTrue : vchFalse);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
+                            stack.push_back(pool.Copy(fValue ? vchTrue : vchFalse));
                             metrics.TallyPushOp(stack.back().size());
                         } break;
 
@@ -1396,7 +1403,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 isTwoRoundHashOp = true;
                             }
                             metrics.TallyHashOp(vch.size(), isTwoRoundHashOp);
-                            popstack(stack);
+                            popstack(stack, pool);
                             stack.push_back(std::move(vchHash));
                             metrics.TallyPushOp(stack.back().size());
                         } break;
@@ -1443,13 +1450,13 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 }
                             }
 
-                            popstack(stack);
-                            popstack(stack);
-                            stack.push_back(fSuccess ? vchTrue : vchFalse);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
+                            stack.push_back(pool.Copy(fSuccess ? vchTrue : vchFalse));
                             metrics.TallyPushOp(stack.back().size());
                             if (opcode == OP_CHECKSIGVERIFY) {
                                 if (fSuccess) {
-                                    popstack(stack);
+                                    popstack(stack, pool);
                                 } else {
                                     return set_error(serror, ScriptError::CHECKSIGVERIFY);
                                 }
@@ -1489,14 +1496,14 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 }
                             }
 
-                            popstack(stack);
-                            popstack(stack);
-                            popstack(stack);
-                            stack.push_back(fSuccess ? vchTrue : vchFalse);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
+                            stack.push_back(pool.Copy(fSuccess ? vchTrue : vchFalse));
                             metrics.TallyPushOp(stack.back().size());
                             if (opcode == OP_CHECKDATASIGVERIFY) {
                                 if (fSuccess) {
-                                    popstack(stack);
+                                    popstack(stack, pool);
                                 } else {
                                     return set_error(serror, ScriptError::CHECKDATASIGVERIFY);
                                 }
@@ -1717,14 +1724,14 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
 
                             // Clean up stack of all arguments
                             for (size_t i = 0; i < idxDummy; i++) {
-                                popstack(stack);
+                                popstack(stack, pool);
                             }
 
-                            stack.push_back(fSuccess ? vchTrue : vchFalse);
+                            stack.push_back(pool.Copy(fSuccess ? vchTrue : vchFalse));
                             metrics.TallyPushOp(stack.back().size());
                             if (opcode == OP_CHECKMULTISIGVERIFY) {
                                 if (fSuccess) {
-                                    popstack(stack);
+                                    popstack(stack, pool);
                                 } else {
                                     return set_error(serror, ScriptError::CHECKMULTISIGVERIFY);
                                 }
@@ -1745,7 +1752,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(serror, ScriptError::PUSH_SIZE);
                             }
                             vch1.insert(vch1.end(), vch2.begin(), vch2.end());
-                            popstack(stack);
+                            popstack(stack, pool);
                             metrics.TallyPushOp(stack.back().size());
                         } break;
 
@@ -1799,7 +1806,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(serror, ScriptError::PUSH_SIZE);
                             }
 
-                            popstack(stack);
+                            popstack(stack, pool);
                             valtype &rawnum = stacktop(-1);
 
                             // Try to see if we can fit that number in the number of byte requested.
@@ -1875,8 +1882,8 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                             }
                             valtype data = std::move(stacktop(-2));
 
-                            popstack(stack);
-                            popstack(stack);
+                            popstack(stack, pool);
+                            popstack(stack, pool);
 
                             // Note: If bit shifting exceeds the number of bits in `data`, that's ok, `bitShiftBlob`
                             // returns quickly, having zeroed-out `data` in that case.
@@ -1914,7 +1921,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 //  Operations
                                 case OP_INPUTINDEX: {
                                     auto const bn = CScriptNum::fromInt(context->inputIndex()).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
                                 case OP_ACTIVEBYTECODE: {
                                     // Subset of script starting at the most recent code separator (if any)
@@ -1926,19 +1933,19 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 } break;
                                 case OP_TXVERSION: {
                                     auto const bn = CScriptNum::fromInt(context->tx().nVersion()).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
                                 case OP_TXINPUTCOUNT: {
                                     auto const bn = CScriptNum::fromInt(context->tx().vin().size()).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
                                 case OP_TXOUTPUTCOUNT: {
                                     auto const bn = CScriptNum::fromInt(context->tx().vout().size()).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
                                 case OP_TXLOCKTIME: {
                                     auto const bn = CScriptNum::fromInt(context->tx().nLockTime()).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
                                 default: {
                                     assert(!"invalid opcode");
@@ -1982,7 +1989,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                 return set_error(serror, ScriptError::INVALID_STACK_OPERATION);
                             }
                             auto const index = CScriptNum(stacktop(-1), fRequireMinimal, maxIntegerSizeLegacy).getint64();
-                            popstack(stack); // consume element
+                            popstack(stack, pool); // consume element
 
                             auto is_valid_input_index = [&] {
                                 if (index < 0 || uint64_t(index) >= context->tx().vin().size()) {
@@ -2023,7 +2030,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                         return set_error(serror, ScriptError::LIMITED_CONTEXT_NO_SIBLING_INFO);
                                     }
                                     auto const bn = CScriptNum::fromInt(context->coinAmount(index) / SATOSHI).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
 
                                 case OP_UTXOBYTECODE: {
@@ -2058,7 +2065,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                     }
                                     auto const& input = context->tx().vin()[index];
                                     auto const bn = CScriptNum::fromInt(input.prevout.GetN()).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
 
                                 case OP_INPUTBYTECODE: {
@@ -2078,7 +2085,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                     }
                                     auto const& input = context->tx().vin()[index];
                                     auto const bn = CScriptNum::fromInt(input.nSequence).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
 
                                 case OP_OUTPUTVALUE: {
@@ -2087,7 +2094,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                     }
                                     auto const& output = context->tx().vout()[index];
                                     auto const bn = CScriptNum::fromInt(output.nValue / SATOSHI).value();
-                                    stack.push_back(bn.getvch());
+                                    stack.push_back(pool.Serialize(bn));
                                 } break;
 
                                 case OP_OUTPUTBYTECODE: {
@@ -2171,7 +2178,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                         // push the amount as a CScriptNum amount. Note it can be zero for NFT-only
                                         // tokens, in which case an empty vector {} will be pushed.
                                         auto const bn = CScriptNum::fromInt(pdata->GetAmount().getint64()).value();
-                                        stack.push_back(bn.getvch());
+                                        stack.push_back(pool.Serialize(bn));
                                     }
                                 } break;
 
@@ -2232,7 +2239,7 @@ bool EvalScriptImpl(std::vector<valtype> &stack, const CScript &initialScript, u
                                         // push the amount as a CScriptNum amount. Note it can be zero for NFT-only
                                         // tokens, in which case an empty vector {} will be pushed.
                                         auto const bn = CScriptNum::fromInt(pdata->GetAmount().getint64()).value();
-                                        stack.push_back(bn.getvch());
+                                        stack.push_back(pool.Serialize(bn));
                                     }
                                 } break;
 
@@ -2419,49 +2426,111 @@ public:
     }
 };
 
-uint256 GetPrevoutHash(const ScriptExecutionContext &context) {
-    CHashWriter ss(SER_GETHASH, 0);
+template <typename Stream>
+void SerializePrevouts(Stream &s, const ScriptExecutionContext &context) {
     for (const auto &txin : context.tx().vin()) {
-        ss << txin.prevout;
+        s << txin.prevout;
     }
-    return ss.GetHash();
 }
 
-uint256 GetSequenceHash(const ScriptExecutionContext &context) {
-    CHashWriter ss(SER_GETHASH, 0);
+template <typename Stream>
+void SerializeSequences(Stream &s, const ScriptExecutionContext &context) {
     for (const auto &txin : context.tx().vin()) {
-        ss << txin.nSequence;
+        s << txin.nSequence;
     }
-    return ss.GetHash();
 }
 
-uint256 GetOutputsHash(const ScriptExecutionContext &context) {
-    CHashWriter ss(SER_GETHASH, 0);
+template <typename Stream>
+void SerializeOutputs(Stream &s, const ScriptExecutionContext &context) {
     for (const auto &txout : context.tx().vout()) {
-        ss << txout;
+        s << txout;
     }
-    return ss.GetHash();
 }
 
-uint256 GetUtxosHash(const ScriptExecutionContext &context) {
+template <typename Stream>
+void SerializeUtxos(Stream &s, const ScriptExecutionContext &context) {
     assert(!context.isLimited());
     const size_t nInputs = context.tx().vin().size();
-    CHashWriter ss(SER_GETHASH, 0);
     for (size_t i = 0; i < nInputs; ++i) {
         const Coin &coin = context.coin(i);
-        ss << coin.GetTxOut();
+        s << coin.GetTxOut();
     }
+}
+
+uint256 GetPrevoutHash(const ScriptExecutionContext &context) {
+    CHashWriter ss(SER_GETHASH, 0);
+    SerializePrevouts(ss, context);
+    return ss.GetHash();
+}
+
+uint256 GetSequenceHash(const ScriptExecutionContext &context) {
+    CHashWriter ss(SER_GETHASH, 0);
+    SerializeSequences(ss, context);
+    return ss.GetHash();
+}
+
+uint256 GetOutputsHash(const ScriptExecutionContext &context) {
+    CHashWriter ss(SER_GETHASH, 0);
+    SerializeOutputs(ss, context);
+    return ss.GetHash();
+}
+
+uint256 GetUtxosHash(const ScriptExecutionContext &context) {
+    CHashWriter ss(SER_GETHASH, 0);
+    SerializeUtxos(ss, context);
     return ss.GetHash();
 }
 
 } // namespace
 
+//! PopulateFromContext() hashes the preimages together only if they take at most this many bytes altogether
+static constexpr size_t MAX_BATCHED_PREIMAGES_SIZE = 1 << 16;
+
 void PrecomputedTransactionData::PopulateFromContext(const ScriptExecutionContext &context) {
-    hashPrevouts = GetPrevoutHash(context);
-    hashSequence = GetSequenceHash(context);
-    hashOutputs = GetOutputsHash(context);
-    if (!context.isLimited()) {
-        hashUtxos = GetUtxosHash(context);
+    const bool fUtxos = !context.isLimited();
+    // The prevouts and sequences take a fixed size per input, the outputs and the coins have to be measured
+    CSizeComputer varSize(0);
+    SerializeOutputs(varSize, context);
+    if (fUtxos) {
+        SerializeUtxos(varSize, context);
+    }
+    if (context.tx().vin().size() * (36 + 4) + varSize.size() > MAX_BATCHED_PREIMAGES_SIZE) {
+        // Too large to be worth buffering, so hash each one while serializing it
+        hashPrevouts = GetPrevoutHash(context);
+        hashSequence = GetSequenceHash(context);
+        hashOutputs = GetOutputsHash(context);
+        if (fUtxos) {
+            hashUtxos = GetUtxosHash(context);
+        } else {
+            hashUtxos.reset();
+        }
+        populated = true;
+        return;
+    }
+
+    // Serialize the (up to) four preimages first, so that they are hashed together rather than one at a time
+    std::vector<uint8_t> data[4];
+    {
+        CVectorWriter prevouts(SER_GETHASH, 0, data[0], 0);
+        SerializePrevouts(prevouts, context);
+        CVectorWriter sequences(SER_GETHASH, 0, data[1], 0);
+        SerializeSequences(sequences, context);
+        CVectorWriter outputs(SER_GETHASH, 0, data[2], 0);
+        SerializeOutputs(outputs, context);
+        if (fUtxos) {
+            CVectorWriter utxos(SER_GETHASH, 0, data[3], 0);
+            SerializeUtxos(utxos, context);
+        }
+    }
+    const Span<const uint8_t> preimages[4] = {data[0], data[1], data[2], data[3]};
+    uint256 hashes[4];
+    SHA256DMulti(hashes[0].begin(), preimages, fUtxos ? 4 : 3);
+
+    hashPrevouts = hashes[0];
+    hashSequence = hashes[1];
+    hashOutputs = hashes[2];
+    if (fUtxos) {
+        hashUtxos = hashes[3];
     } else {
         hashUtxos.reset();
     }
@@ -2704,8 +2773,254 @@ bool EvalScript(std::vector<valtype> &stack, const CScript &script, uint32_t fla
     }
 }
 
-bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, uint32_t flags, const BaseSignatureChecker &checker,
-                  ScriptExecutionMetrics &metricsOut, ScriptError *serror) {
+/**
+ * Specialized verification of a spend of a P2PKH output (OP_DUP OP_HASH160 <hash> OP_EQUALVERIFY OP_CHECKSIG), which
+ * accounts for the bulk of the inputs we validate, that skips the general-purpose interpreter loop.
+ *
+ * Returns std::nullopt, leaving `metrics` untouched, if the input is not of the exact shape handled here (a scriptSig
+ * consisting of two data pushes that EvalScript() would accept, whose pubkey matches the hash) or if it fails in some
+ * way other than a bad signature; the caller must then fall back to the generic interpreter, which will report the
+ * precise error. Otherwise returns what evaluating scriptSig and then scriptPubKey with EvalScript() would have
+ * returned, with `metrics` and `serror` updated identically.
+ */
+static std::optional<bool> VerifyP2PKH(const CScript &scriptSig, const CScript &scriptPubKey, uint32_t flags,
+                                       const BaseSignatureChecker &checker, ScriptExecutionMetrics &metrics,
+                                       ScriptError *serror) {
+    assert(scriptPubKey.IsPayToPubKeyHash());
+    if (scriptSig.size() > MAX_SCRIPT_SIZE) {
+        return std::nullopt;
+    }
+    bool const chipVmLimitsEnabled = (flags & SCRIPT_ENABLE_MAY2025) != 0;
+    size_t const maxScriptElementSize = chipVmLimitsEnabled ? may2025::MAX_SCRIPT_ELEMENT_SIZE
+                                                            : MAX_SCRIPT_ELEMENT_SIZE_LEGACY;
+
+    // scriptSig: <sig> <pubkey>
+    StackBufferPool &pool = StackBufferPool::Get();
+    valtype vchSig = pool.Take(), vchPubKey = pool.Take();
+    Defer recycleBuffers([&pool, &vchSig, &vchPubKey] {
+        pool.Recycle(std::move(vchSig));
+        pool.Recycle(std::move(vchPubKey));
+    });
+    const uint8_t *pc = scriptSig.data(), * const pend = scriptSig.data() + scriptSig.size();
+    opcodetype opcodeSig, opcodePubKey;
+    if (!GetScriptOp(pc, pend, opcodeSig, &vchSig) || opcodeSig > OP_PUSHDATA4
+            || !GetScriptOp(pc, pend, opcodePubKey, &vchPubKey) || opcodePubKey > OP_PUSHDATA4 || pc != pend
+            || vchSig.size() > maxScriptElementSize || vchPubKey.size() > maxScriptElementSize) {
+        return std::nullopt;
+    }
+    if ((flags & SCRIPT_VERIFY_MINIMALDATA)
+            && (!CheckMinimalPush(vchSig, opcodeSig) || !CheckMinimalPush(vchPubKey, opcodePubKey))) {
+        return std::nullopt;
+    }
+
+    // OP_DUP OP_HASH160 <hash> OP_EQUALVERIFY
+    uint160 pubKeyHash;
+    CHash160().Write(vchPubKey).Finalize(pubKeyHash);
+    if (!std::equal(pubKeyHash.begin(), pubKeyHash.end(), scriptPubKey.begin() + 3)) {
+        return std::nullopt;
+    }
+
+    // OP_CHECKSIG: encoding errors and empty signatures are left to the generic interpreter; neither involves
+    // checking a signature so falling back is cheap.
+    if (vchSig.empty() || !CheckTransactionSignatureEncoding(vchSig, flags, nullptr)
+            || !CheckPubKeyEncoding(vchPubKey, flags, nullptr)) {
+        return std::nullopt;
+    }
+
+    // Tally the metrics exactly as EvalScript() would, in the same order: 7 opcodes, the 2 pushes of the scriptSig,
+    // then OP_DUP's copy of the pubkey, the 20-byte results of OP_HASH160 and the <hash> push, and the `true` left
+    // by OP_EQUALVERIFY before it pops it.
+    ScriptExecutionMetrics m = metrics;
+    m.TallyOp(may2025::OPCODE_COST * 7u);
+    m.TallyPushOp(vchSig.size());
+    m.TallyPushOp(vchPubKey.size());
+    m.TallyPushOp(vchPubKey.size());
+    m.TallyHashOp(vchPubKey.size(), true);
+    m.TallyPushOp(uint160::size() * 2u + 1u);
+    // The interpreter checks the VM limits after each opcode. Since the metrics only ever increase, if we are within
+    // the limits before OP_CHECKSIG then so were all of the preceding opcodes. Otherwise let the interpreter figure out
+    // which opcode tripped which limit.
+    if (chipVmLimitsEnabled && (m.IsOverOpCostLimit(flags) || m.IsOverHashItersLimit())) {
+        return std::nullopt;
+    }
+
+    const auto cleanedUp = CleanupScriptCode(ByteView{scriptPubKey}, vchSig, flags);
+    size_t bytesHashed{};
+    bool fSuccess;
+    try {
+        fSuccess = checker.CheckSig(vchSig, vchPubKey, cleanedUp.scriptCode, flags, &bytesHashed);
+    } catch (...) {
+        return set_error(serror, ScriptError::UNKNOWN);
+    }
+    m.TallySigChecks(1);
+    if (bytesHashed) {
+        m.TallyHashOp(bytesHashed, true);
+    }
+    if (!fSuccess) {
+        if (flags & SCRIPT_VERIFY_NULLFAIL) {
+            return set_error(serror, ScriptError::SIG_NULLFAIL);
+        }
+        // Only reachable with non-standard flags; not worth duplicating the remaining error handling for.
+        return std::nullopt;
+    }
+    m.TallyPushOp(1u); // OP_CHECKSIG pushes `true`
+    if (chipVmLimitsEnabled) {
+        if (m.IsOverOpCostLimit(flags)) {
+            return set_error(serror, ScriptError::OP_COST);
+        }
+        if (m.IsOverHashItersLimit()) {
+            return set_error(serror, ScriptError::TOO_MANY_HASH_ITERS);
+        }
+    }
+
+    metrics = m;
+    return true;
+}
+
+/// @returns true if `script` is a bare multisig template: OP_m <pubkeys> OP_n OP_CHECKMULTISIG
+static bool IsMultisigTemplate(const valtype &script) {
+    if (script.size() < 3 || script.back() != OP_CHECKMULTISIG || script.front() < OP_1 || script.front() > OP_16) {
+        return false;
+    }
+    const uint8_t *pc = script.data() + 1, * const pend = script.data() + script.size() - 2;
+    for (opcodetype opcode; pc < pend;) {
+        if (!GetScriptOp(pc, pend, opcode, nullptr) || (opcode != CPubKey::COMPRESSED_PUBLIC_KEY_SIZE && opcode != CPubKey::PUBLIC_KEY_SIZE)) {
+            return false;
+        }
+    }
+    return pc == pend && *pend >= OP_1 && *pend <= OP_16;
+}
+
+/**
+ * Specialized evaluation of the scriptSig and the scriptPubKey of a spend of a P2SH output (OP_HASH160 <hash> OP_EQUAL,
+ * or OP_HASH256 <hash> OP_EQUAL if `p2sh_32`) whose redeem script is a multisig template, which accounts for most of
+ * the P2SH inputs we validate. The data pushes of the scriptSig are parsed directly into `stack` and the hash of the
+ * redeem script is checked, skipping the general-purpose interpreter loop for both scripts and the copy of the stack
+ * between them. The redeem script itself is left to EvalScript(), which implements OP_CHECKMULTISIG.
+ *
+ * Returns false, leaving `stack` and `metrics` untouched, if the input is not of the exact shape handled here (a
+ * scriptSig consisting of data pushes that EvalScript() would accept, the last of which is a multisig redeem script
+ * matching the hash) or if a VM limit is hit; the caller must then fall back to the generic interpreter. Otherwise
+ * returns true, with the redeem script in `redeemScript`, the rest of the pushes in `stack`, and `metrics` updated as
+ * evaluating scriptSig and scriptPubKey with EvalScript() would have.
+ */
+static bool PrepareP2SHMultisig(const CScript &scriptSig, const CScript &scriptPubKey, bool p2sh_32, uint32_t flags,
+                                std::vector<valtype> &stack, CScript &redeemScript, ScriptExecutionMetrics &metrics) {
+    assert(stack.empty());
+    if (scriptSig.size() > MAX_SCRIPT_SIZE) {
+        return false;
+    }
+    bool const chipVmLimitsEnabled = (flags & SCRIPT_ENABLE_MAY2025) != 0;
+    size_t const maxScriptElementSize = chipVmLimitsEnabled ? may2025::MAX_SCRIPT_ELEMENT_SIZE
+                                                            : MAX_SCRIPT_ELEMENT_SIZE_LEGACY;
+
+    // scriptSig: <args...> <redeemScript>
+    StackBufferPool &pool = StackBufferPool::Get();
+    auto fallBack = [&stack, &pool] {
+        for (auto &vch : stack) {
+            pool.Recycle(std::move(vch));
+        }
+        stack.clear();
+        return false;
+    };
+    ScriptExecutionMetrics m = metrics;
+    const uint8_t *pc = scriptSig.data(), * const pend = scriptSig.data() + scriptSig.size();
+    while (pc < pend) {
+        valtype vch = pool.Take();
+        opcodetype opcode;
+        if (!GetScriptOp(pc, pend, opcode, &vch) || opcode > OP_PUSHDATA4 || vch.size() > maxScriptElementSize
+                || ((flags & SCRIPT_VERIFY_MINIMALDATA) && !CheckMinimalPush(vch, opcode))) {
+            pool.Recycle(std::move(vch));
+            return fallBack();
+        }
+        m.TallyOp(may2025::OPCODE_COST);
+        m.TallyPushOp(vch.size());
+        stack.push_back(std::move(vch));
+    }
+    // OP_HASH160 / OP_HASH256 leaves the hash on the stack, next to the <hash> push
+    if (stack.empty() || stack.size() + 1 > MAX_STACK_SIZE || !IsMultisigTemplate(stack.back())) {
+        return fallBack();
+    }
+
+    // OP_HASH160 <hash> OP_EQUAL / OP_HASH256 <hash> OP_EQUAL
+    const valtype &vchRedeemScript = stack.back();
+    const size_t hashSize = p2sh_32 ? uint256::size() : uint160::size();
+    valtype hash(hashSize);
+    if (p2sh_32) {
+        CHash256().Write(vchRedeemScript).Finalize(hash);
+    } else {
+        CHash160().Write(vchRedeemScript).Finalize(hash);
+    }
+    if (!std::equal(hash.begin(), hash.end(), scriptPubKey.begin() + 2)) {
+        return fallBack();
+    }
+
+    // Tally the metrics of the scriptPubKey as EvalScript() would: 3 opcodes, then the hash, the pushes of its result
+    // and of <hash>, and the `true` left by OP_EQUAL. As in VerifyP2PKH(), being within the VM limits at the end means
+    // that every opcode was.
+    m.TallyOp(may2025::OPCODE_COST * 3u);
+    m.TallyHashOp(vchRedeemScript.size(), true);
+    m.TallyPushOp(hashSize * 2u + 1u);
+    if (chipVmLimitsEnabled && (m.IsOverOpCostLimit(flags) || m.IsOverHashItersLimit())) {
+        return fallBack();
+    }
+
+    redeemScript.assign(vchRedeemScript.begin(), vchRedeemScript.end());
+    popstack(stack, pool);
+    metrics = m;
+    return true;
+}
+
+/**
+ * The checks VerifyScript() performs once both scripts have been evaluated successfully, leaving `finalStackSize`
+ * elements on the stack.
+ */
+static bool VerifyScriptFinish(const CScript &scriptSig, size_t finalStackSize, uint32_t flags,
+                               const ScriptExecutionMetrics &metrics, ScriptExecutionMetrics &metricsOut,
+                               ScriptError *serror) {
+    // The CLEANSTACK check is only performed after potential P2SH evaluation,
+    // as the non-P2SH evaluation of a P2SH script will obviously not result in
+    // a clean stack (the P2SH inputs remain). The same holds for witness
+    // evaluation.
+    if ((flags & SCRIPT_VERIFY_CLEANSTACK) != 0) {
+        // Disallow CLEANSTACK without P2SH, as otherwise a switch
+        // CLEANSTACK->P2SH+CLEANSTACK would be possible, which is not a
+        // softfork (and P2SH should be one).
+        assert((flags & SCRIPT_VERIFY_P2SH) != 0);
+        if (finalStackSize != 1) {
+            return set_error(serror, ScriptError::CLEANSTACK);
+        }
+    }
+
+    if (flags & SCRIPT_VERIFY_INPUT_SIGCHECKS) {
+        // This limit is intended for standard use, and is based on an
+        // examination of typical and historical standard uses.
+        // - allowing P2SH ECDSA multisig with compressed keys, which at an
+        // extreme (1-of-15) may have 15 SigChecks in ~590 bytes of scriptSig.
+        // - allowing Bare ECDSA multisig, which at an extreme (1-of-3) may have
+        // 3 sigchecks in ~72 bytes of scriptSig.
+        // - Since the size of an input is 41 bytes + length of scriptSig, then
+        // the most dense possible inputs satisfying this rule would be:
+        //   2 sigchecks and 26 bytes: 1/33.50 sigchecks/byte.
+        //   3 sigchecks and 69 bytes: 1/36.66 sigchecks/byte.
+        // The latter can be readily done with 1-of-3 bare multisignatures,
+        // however the former is not practically doable with standard scripts,
+        // so the practical density limit is 1/36.66.
+        static_assert(std::in_range<int>(MAX_SCRIPT_SIZE), "overflow sanity check on max script size");
+        static_assert(std::numeric_limits<int>::max() / 43 / 3 > MAX_OPS_PER_SCRIPT_LEGACY,
+                      "overflow sanity check on maximum possible sigchecks from sig+redeem+pub scripts");
+        if (static_cast<int>(scriptSig.size()) < metrics.GetSigChecks() * 43 - 60) {
+            return set_error(serror, ScriptError::INPUT_SIGCHECKS);
+        }
+    }
+
+    metricsOut = metrics;
+    return set_success(serror);
+}
+
+static bool VerifyScriptImpl(const CScript &scriptSig, const CScript &scriptPubKey, uint32_t flags,
+                             const BaseSignatureChecker &checker, ScriptExecutionMetrics &metricsOut,
+                             ScriptError *serror, bool allowFastPath) {
     set_error(serror, ScriptError::UNKNOWN);
 
     // If FORKID is enabled, we also ensure strict encoding.
@@ -2725,16 +3040,49 @@ bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, uint32_
         metrics.SetScriptLimits(flags, scriptSig.size());
     }
 
+    StackBufferPool &pool = StackBufferPool::Get();
+    // Shrink this thread's pool back to its idle size once done with this input.
+    Defer trimPool([&pool] { pool.Trim(); });
+
+    bool p2sh_32{};
+    const bool is_p2sh = flags & SCRIPT_VERIFY_P2SH && scriptPubKey.IsPayToScriptHash(flags, nullptr, &p2sh_32);
+
+    if (allowFastPath && scriptPubKey.IsPayToPubKeyHash()) {
+        if (const auto result = VerifyP2PKH(scriptSig, scriptPubKey, flags, checker, metrics, serror)) {
+            if (!*result) {
+                // serror is set
+                return false;
+            }
+            // A successful P2PKH evaluation leaves just the `true` from OP_CHECKSIG on the stack
+            return VerifyScriptFinish(scriptSig, 1, flags, metrics, metricsOut, serror);
+        }
+    }
+
     std::vector<valtype> stack, stackCopy;
+    if (allowFastPath && is_p2sh) {
+        CScript redeemScript;
+        if (PrepareP2SHMultisig(scriptSig, scriptPubKey, p2sh_32, flags, stack, redeemScript, metrics)) {
+            if ( ! EvalScript(stack, redeemScript, flags, checker, metrics, serror)) {
+                // serror is set
+                return false;
+            }
+            if (stack.empty() || !CastToBool(stack.back())) {
+                return set_error(serror, ScriptError::EVAL_FALSE);
+            }
+            return VerifyScriptFinish(scriptSig, stack.size(), flags, metrics, metricsOut, serror);
+        }
+    }
+
     if ( ! EvalScript(stack, scriptSig, flags, checker, metrics, serror)) {
         // serror is set
         return false;
     }
-    bool p2sh_32{};
-    const bool is_p2sh = flags & SCRIPT_VERIFY_P2SH && scriptPubKey.IsPayToScriptHash(flags, nullptr, &p2sh_32);
     if (is_p2sh) {
         // For p2sh, take a copy of the scriptSig resultant stack now; we will need it later for the second evaluation.
-        stackCopy = stack;
+        stackCopy.reserve(stack.size());
+        for (const auto &vch : stack) {
+            stackCopy.push_back(pool.Copy(vch));
+        }
     }
     if ( ! EvalScript(stack, scriptPubKey, flags, checker, metrics, serror)) {
         // serror is set
@@ -2760,7 +3108,7 @@ bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, uint32_
         assert(!stack.empty());
 
         const CScript pubKey2(stack.back().begin(), stack.back().end());
-        popstack(stack);
+        popstack(stack, pool);
 
         // Bail out early if SCRIPT_DISALLOW_SEGWIT_RECOVERY is not set, the
         // redeem script is a p2sh_20 segwit program, and it was the only item
@@ -2785,42 +3133,15 @@ bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, uint32_
         }
     }
 
-    // The CLEANSTACK check is only performed after potential P2SH evaluation,
-    // as the non-P2SH evaluation of a P2SH script will obviously not result in
-    // a clean stack (the P2SH inputs remain). The same holds for witness
-    // evaluation.
-    if ((flags & SCRIPT_VERIFY_CLEANSTACK) != 0) {
-        // Disallow CLEANSTACK without P2SH, as otherwise a switch
-        // CLEANSTACK->P2SH+CLEANSTACK would be possible, which is not a
-        // softfork (and P2SH should be one).
-        assert((flags & SCRIPT_VERIFY_P2SH) != 0);
-        if (stack.size() != 1) {
-            return set_error(serror, ScriptError::CLEANSTACK);
-        }
-    }
+    return VerifyScriptFinish(scriptSig, stack.size(), flags, metrics, metricsOut, serror);
+}
 
-    if (flags & SCRIPT_VERIFY_INPUT_SIGCHECKS) {
-        // This limit is intended for standard use, and is based on an
-        // examination of typical and historical standard uses.
-        // - allowing P2SH ECDSA multisig with compressed keys, which at an
-        // extreme (1-of-15) may have 15 SigChecks in ~590 bytes of scriptSig.
-        // - allowing Bare ECDSA multisig, which at an extreme (1-of-3) may have
-        // 3 sigchecks in ~72 bytes of scriptSig.
-        // - Since the size of an input is 41 bytes + length of scriptSig, then
-        // the most dense possible inputs satisfying this rule would be:
-        //   2 sigchecks and 26 bytes: 1/33.50 sigchecks/byte.
-        //   3 sigchecks and 69 bytes: 1/36.66 sigchecks/byte.
-        // The latter can be readily done with 1-of-3 bare multisignatures,
-        // however the former is not practically doable with standard scripts,
-        // so the practical density limit is 1/36.66.
-        static_assert(std::in_range<int>(MAX_SCRIPT_SIZE), "overflow sanity check on max script size");
-        static_assert(std::numeric_limits<int>::max() / 43 / 3 > MAX_OPS_PER_SCRIPT_LEGACY,
-                      "overflow sanity check on maximum possible sigchecks from sig+redeem+pub scripts");
-        if (static_cast<int>(scriptSig.size()) < metrics.GetSigChecks() * 43 - 60) {
-            return set_error(serror, ScriptError::INPUT_SIGCHECKS);
-        }
-    }
+bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, uint32_t flags, const BaseSignatureChecker &checker,
+                  ScriptExecutionMetrics &metricsOut, ScriptError *serror) {
+    return VerifyScriptImpl(scriptSig, scriptPubKey, flags, checker, metricsOut, serror, true);
+}
 
-    metricsOut = metrics;
-    return set_success(serror);
+bool VerifyScriptGeneric(const CScript &scriptSig, const CScript &scriptPubKey, uint32_t flags,
+                         const BaseSignatureChecker &checker, ScriptExecutionMetrics &metricsOut, ScriptError *serror) {
+    return VerifyScriptImpl(scriptSig, scriptPubKey, flags, checker, metricsOut, serror, false);
 }
@@ -137,6 +137,15 @@ bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, uint32_
     return VerifyScript(scriptSig, scriptPubKey, flags, checker, dummymetrics, serror);
 }
 
+/**
+ * Like VerifyScript(), but always runs both scripts through the general-purpose interpreter, even for the standard
+ * templates (currently P2PKH) that VerifyScript() verifies with specialized code. Exported for use by tests, fuzzers
+ * and benchmarks, to check the specialized code against the interpreter.
+ */
+bool VerifyScriptGeneric(const CScript &scriptSig, const CScript &scriptPubKey, uint32_t flags,
+                         const BaseSignatureChecker &checker, ScriptExecutionMetrics &metricsOut,
+                         ScriptError *serror = nullptr);
+
 struct FindAndDeleteResult {
     size_t nFound = 0;
     CScript replacementScript; // this should only be used if nFound > 0
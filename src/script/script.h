@@ -837,14 +837,23 @@ public:
     {}
 
     std::vector<uint8_t> getvch() const { return serialize(value_); }
+    /// Like above, but writes to `out`, reusing its existing capacity (if any).
+    void getvch(std::vector<uint8_t> &out) const { serialize(value_, out); }
 
     static
     std::vector<uint8_t> serialize(int64_t value) {
+        std::vector<uint8_t> result;
+        serialize(value, result);
+        return result;
+    }
+
+    static
+    void serialize(int64_t value, std::vector<uint8_t> &result) {
+        result.clear();
         if (value == 0) {
-            return {};
+            return;
         }
 
-        std::vector<uint8_t> result;
         const bool neg = value < 0;
         // NB: -INT64_MIN in 2's complement is UB, so we must guard against it here.
         uint64_t absvalue = neg && validRange(value) ? -value : value;
@@ -867,8 +876,6 @@ public:
         } else if (neg) {
             result.back() |= 0x80;
         }
-
-        return result;
     }
 
 private:
@@ -927,6 +934,7 @@ public:
     {}
 
     std::vector<uint8_t> getvch() const { return value_.serialize(); }
+    void getvch(std::vector<uint8_t> &out) const { value_.serialize(out); }
 
     /// Returns the underlying BigInt; the returned BigInt is not guaranteed to be in valid consensus-legal range
     /// for pushing to the stack (a situation which may occur in tests).
@@ -1010,6 +1018,7 @@ public:
     }
 
     std::vector<uint8_t> getvch() const { return std::visit([](const auto &num){ return num.getvch(); }, var); }
+    void getvch(std::vector<uint8_t> &out) const { std::visit([&out](const auto &num){ num.getvch(out); }, var); }
 
     [[nodiscard]] bool safeAddInPlace(const FastBigNum &o) {
         return doInPlaceSafeArithOp(o, &CScriptNum::safeAdd, &ScriptBigInt::safeAddInPlace, &ScriptBigInt::safeAddInPlace);
@@ -11,7 +11,6 @@
 #include <script/sigcache.h>
 #include <sync.h>
 #include <util/system.h>
-#include <validation.h>
 
 /**
  * In future if many more values are added, it should be considered to
@@ -69,8 +68,10 @@ public:
     }
 };
 
+//! The cache does not synchronize concurrent inserts itself
+static Mutex cs_scriptExecutionCache;
 static CuckooCache::cache<ScriptCacheElement, ScriptCacheHasher>
-    scriptExecutionCache;
+    scriptExecutionCache GUARDED_BY(cs_scriptExecutionCache);
 static uint256 scriptExecutionCacheNonce(GetRandHash());
 
 void InitScriptExecutionCache() {
@@ -81,7 +82,7 @@ void InitScriptExecutionCache() {
                           gArgs.GetArg("-maxscriptcachesize", DEFAULT_MAX_SCRIPT_CACHE_SIZE)),
                  MAX_MAX_SCRIPT_CACHE_SIZE) *
         (size_t(1) << 20);
-    size_t nElems = scriptExecutionCache.setup_bytes(nMaxCacheSize);
+    size_t nElems = WITH_LOCK(cs_scriptExecutionCache, return scriptExecutionCache.setup_bytes(nMaxCacheSize));
     LogPrintf("Using %zu MiB out of %zu requested for script execution cache, "
               "able to store %zu elements\n",
               (nElems * sizeof(uint256)) >> 20, nMaxCacheSize >> 20, nElems);
@@ -104,21 +105,14 @@ ScriptCacheKey::ScriptCacheKey(const CTransaction &tx, uint32_t flags) {
 }
 
 bool IsKeyInScriptCache(ScriptCacheKey key, bool erase, int &nSigChecksOut) {
-    // TODO: Remove this requirement by making CuckooCache not require external
-    // locks
-    AssertLockHeld(cs_main);
-
     ScriptCacheElement elem(key, 0);
-    bool ret = scriptExecutionCache.get(elem, erase);
+    bool ret = WITH_LOCK(cs_scriptExecutionCache, return scriptExecutionCache.get(elem, erase));
     nSigChecksOut = elem.nSigChecks;
     return ret;
 }
 
 void AddKeyInScriptCache(ScriptCacheKey key, int nSigChecks) {
-    // TODO: Remove this requirement by making CuckooCache not require external
-    // locks
-    AssertLockHeld(cs_main);
-
     ScriptCacheElement elem(key, nSigChecks);
+    LOCK(cs_scriptExecutionCache);
     scriptExecutionCache.insert(elem);
 }
@@ -113,7 +113,39 @@ bool CachingTransactionSignatureChecker::IsCached(const ByteView &vchSig, const
 }
 
 bool CachingTransactionSignatureChecker::VerifySignature(const ByteView &vchSig, const CPubKey &pubkey, const uint256 &sighash) const {
+    if (deferred && vchSig.size() == 64) {
+        const uint256 entry = signatureCache.ComputeEntry(sighash, vchSig, pubkey);
+        if (signatureCache.Get(entry, !store)) {
+            return true;
+        }
+        if (!deferred->batch.Add(pubkey, sighash, vchSig)) {
+            return false;
+        }
+        if (store) {
+            deferred->cacheEntries.emplace_back(deferred->batch.size(), entry);
+        }
+        return true;
+    }
     return RunMemoizedCheck(vchSig, pubkey, sighash, store, [&] {
         return TransactionSignatureChecker::VerifySignature(vchSig, pubkey, sighash);
     });
 }
+
+void DeferredSignatures::resize(size_t n) {
+    batch.resize(n);
+    while (!cacheEntries.empty() && cacheEntries.back().first > n) {
+        cacheEntries.pop_back();
+    }
+}
+
+bool DeferredSignatures::Verify() {
+    const bool ret = batch.Verify();
+    if (ret) {
+        for (const auto &[_, entry] : cacheEntries) {
+            signatureCache.Set(entry);
+        }
+    }
+    batch.clear();
+    cacheEntries.clear();
+    return ret;
+}
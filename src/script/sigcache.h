@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <pubkey.h>
 #include <script/interpreter.h>
 
+#include <utility>
 #include <vector>
 
 // DoS prevention: limit cache size to 32MB (over 1000000 entries on 64-bit
@@ -17,8 +19,6 @@ static constexpr int64_t DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 // Maximum sig cache size allowed
 static constexpr int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
 
-class CPubKey;
-
 /**
  * We're hashing a nonce into the entries themselves, so we don't need extra
  * blinding in the set hash computation.
@@ -39,17 +39,42 @@ public:
     }
 };
 
+/**
+ * The Schnorr signatures whose verification a CachingTransactionSignatureChecker deferred: it assumes them to be
+ * valid, so whatever the checks that ran with it concluded only holds if Verify() succeeds.
+ */
+class DeferredSignatures {
+    SchnorrBatchVerifier batch;
+    //! Signature cache entries to store once the batch is verified, with the size of the batch when they were added
+    std::vector<std::pair<size_t, uint256>> cacheEntries;
+
+public:
+    size_t size() const { return batch.size(); }
+    /// Forget the signatures that were deferred after the first `n`
+    void resize(size_t n);
+    /// Verify all the deferred signatures at once, store them in the signature cache if requested, and clear
+    bool Verify();
+
+    friend class CachingTransactionSignatureChecker;
+};
+
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker {
 private:
     bool store;
+    DeferredSignatures *deferred;
 
     bool IsCached(const ByteView &vchSig, const CPubKey &vchPubKey, const uint256 &sighash) const;
 
 public:
+    /**
+     * If `deferredIn` is given, Schnorr signatures that are not in the signature cache are added to it rather than
+     * verified, and assumed to be valid.
+     */
     CachingTransactionSignatureChecker(const ScriptExecutionContext &contextIn, bool storeIn,
-                                       PrecomputedTransactionData &txdataIn)
+                                       PrecomputedTransactionData &txdataIn,
+                                       DeferredSignatures *deferredIn = nullptr)
         : TransactionSignatureChecker(contextIn, txdataIn),
-          store(storeIn) {}
+          store(storeIn), deferred(deferredIn) {}
 
     bool VerifySignature(const ByteView &vchSig,
                          const CPubKey &vchPubKey,
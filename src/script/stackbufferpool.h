@@ -0,0 +1,98 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <script/container_types.h>
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Per-thread free list of stack element buffers.
+ *
+ * Nearly every opcode pops one or more elements and pushes a new one, so without recycling each evaluation performs a
+ * heap allocation and a free per stack element. Elements popped by the interpreter hand their buffer to this pool, and
+ * the results of numeric ops as well as copies (OP_DUP, OP_PICK, etc) draw from it, so that in steady state a script
+ * verification thread (such as a CCheckQueue worker) reuses the same few buffers input after input. The pool is
+ * bounded, and is trimmed back down to a small idle size at the end of each VerifyScript() call.
+ */
+class StackBufferPool {
+public:
+    static constexpr size_t MAX_BUFFERS = 1'000, MAX_BYTES = 1'000'000; ///< upper bound while evaluating
+    static constexpr size_t MAX_BUFFERS_IDLE = 64, MAX_BYTES_IDLE = 64 * 1024; ///< upper bound kept between inputs
+
+private:
+    std::vector<valtype> buffers;
+    size_t nBytes = 0; ///< sum of the capacities of `buffers`
+
+public:
+    /// Take ownership of the buffer of `vch` (if it has one and there is room in the pool). `vch` is left empty.
+    void Recycle(valtype &&vch) noexcept {
+        const size_t cap = vch.capacity();
+        if (cap == 0 || buffers.size() >= MAX_BUFFERS || nBytes + cap > MAX_BYTES) {
+            return;
+        }
+        try {
+            if (buffers.capacity() == 0) buffers.reserve(MAX_BUFFERS_IDLE);
+            buffers.push_back(std::move(vch));
+        } catch (const std::bad_alloc &) {
+            return;
+        }
+        nBytes += cap;
+    }
+
+    /// Returns an empty element, reusing a pooled buffer if one is available.
+    valtype Take() noexcept {
+        if (buffers.empty()) {
+            return {};
+        }
+        valtype ret = std::move(buffers.back());
+        buffers.pop_back();
+        nBytes -= ret.capacity();
+        ret.clear();
+        return ret;
+    }
+
+    /// Returns a copy of `vch`, reusing a pooled buffer if one is available.
+    valtype Copy(const valtype &vch) {
+        valtype ret = Take();
+        ret.assign(vch.begin(), vch.end());
+        return ret;
+    }
+
+    /// Returns the serialized form of script number `num`, reusing a pooled buffer if one is available.
+    template <typename ScriptNum>
+    valtype Serialize(const ScriptNum &num) {
+        valtype ret = Take();
+        num.getvch(ret);
+        return ret;
+    }
+
+    /// Release buffers until the pool is back within its idle bounds.
+    void Trim() noexcept {
+        while (!buffers.empty() && (buffers.size() > MAX_BUFFERS_IDLE || nBytes > MAX_BYTES_IDLE)) {
+            nBytes -= buffers.back().capacity();
+            buffers.pop_back();
+        }
+    }
+
+    /// Release all pooled buffers.
+    void Clear() noexcept {
+        buffers.clear();
+        nBytes = 0;
+    }
+
+    /// The number of pooled buffers
+    size_t GetCount() const noexcept { return buffers.size(); }
+    /// The sum of the capacities of the pooled buffers
+    size_t GetBytes() const noexcept { return nBytes; }
+
+    static StackBufferPool &Get() noexcept {
+        thread_local StackBufferPool pool;
+        return pool;
+    }
+};
@@ -183,6 +183,8 @@ public:
 
     size_t size() const { return m_data.size() - m_pos; }
     bool empty() const { return m_data.size() == m_pos; }
+    //! The size() unread bytes
+    auto data() const { return m_data.data() + m_pos; }
 
     void read(char *dst, size_t n) {
         if (n == 0) {
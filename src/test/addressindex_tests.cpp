@@ -0,0 +1,257 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <config.h>
+#include <consensus/validation.h>
+#include <key.h>
+#include <policy/policy.h>
+#include <script/interpreter.h>
+#include <script/sighashtype.h>
+#include <script/standard.h>
+#include <txmempool.h>
+#include <util/time.h>
+#include <validation.h>
+#include <validationinterface.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+static void WaitForSync(AddressIndex &index) {
+    constexpr int64_t timeout_ms = 10 * 1000;
+    const int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+static std::vector<AddressHistoryEntry> FindHistory(const AddressIndex &index, const uint256 &scripthash) {
+    std::vector<AddressHistoryEntry> history;
+    BOOST_CHECK(index.FindHistory(scripthash, history));
+    return history;
+}
+
+static std::vector<AddressUtxo> FindUtxos(const AddressIndex &index, const uint256 &scripthash) {
+    std::vector<AddressUtxo> utxos;
+    BOOST_CHECK(index.FindUtxos(scripthash, utxos));
+    return utxos;
+}
+
+static bool HasUtxo(const std::vector<AddressUtxo> &utxos, const COutPoint &outpoint) {
+    return std::any_of(utxos.begin(), utxos.end(), [&](const AddressUtxo &utxo) { return utxo.outpoint == outpoint; });
+}
+
+BOOST_FIXTURE_TEST_CASE(addressindex_sync_reorg_and_mempool, TestChain100Setup) {
+    AddressIndex index(1 << 20, true);
+
+    const CScript coinbase_script = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    const CScript p2pkh_script = GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+    const uint256 coinbase_hash = AddressIndex::GetScriptHash(coinbase_script);
+    const uint256 p2pkh_hash = AddressIndex::GetScriptHash(p2pkh_script);
+
+    // Nothing should be found in the index before it is started.
+    BOOST_CHECK(FindHistory(index, coinbase_hash).empty());
+    BOOST_CHECK(FindUtxos(index, coinbase_hash).empty());
+    BOOST_CHECK(!index.BlockUntilSyncedToCurrentChain());
+
+    index.Start();
+    WaitForSync(index);
+
+    // Every block of the test chain pays its coinbase to coinbase_script.
+    std::vector<AddressHistoryEntry> history = FindHistory(index, coinbase_hash);
+    BOOST_REQUIRE_EQUAL(history.size(), m_coinbase_txns.size());
+    for (size_t i = 0; i < history.size(); ++i) {
+        BOOST_CHECK(history[i].txid == m_coinbase_txns[i]->GetId());
+        BOOST_CHECK_EQUAL(history[i].height, int(i + 1));
+        BOOST_CHECK_EQUAL(history[i].tx_pos, 0U);
+    }
+    std::vector<AddressUtxo> utxos = FindUtxos(index, coinbase_hash);
+    BOOST_REQUIRE_EQUAL(utxos.size(), m_coinbase_txns.size());
+    for (const auto &txn : m_coinbase_txns) {
+        BOOST_CHECK(HasUtxo(utxos, COutPoint(txn->GetId(), 0)));
+    }
+
+    // Spend the first coinbase to p2pkh_script.
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(m_coinbase_txns[0]->GetId(), 0);
+    spend.vout.resize(1);
+    spend.vout[0].nValue = 11 * CENT;
+    spend.vout[0].scriptPubKey = p2pkh_script;
+    {
+        std::vector<uint8_t> vchSig;
+        const uint256 hash = SignatureHash(coinbase_script, ScriptExecutionContext{0, m_coinbase_txns[0]->vout[0], spend},
+                                           SigHashType().withFork(), nullptr, STANDARD_SCRIPT_VERIFY_FLAGS).signatureHash;
+        BOOST_REQUIRE(coinbaseKey.SignECDSA(hash, vchSig));
+        vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+        spend.vin[0].scriptSig << vchSig;
+    }
+    const TxId spend_id = spend.GetId();
+    const COutPoint spend_out(spend_id, 0);
+
+    auto to_mempool = [](const CMutableTransaction &tx) {
+        LOCK(cs_main);
+        CValidationState state;
+        return AcceptToMemoryPool(GetConfig(), g_mempool, state, MakeTransactionRef(tx), nullptr /* pfMissingInputs */,
+                                  true /* bypass_limits */, Amount::zero() /* nAbsurdFee */);
+    };
+
+    // In the mempool, the spend shows up in the history of both scripts, and moves the output between them.
+    BOOST_REQUIRE(to_mempool(spend));
+    SyncWithValidationInterfaceQueue();
+    utxos = FindUtxos(index, coinbase_hash);
+    BOOST_CHECK(index.FindMempoolHistory(g_mempool, coinbase_hash, utxos) == std::vector<TxId>{spend_id});
+    index.ApplyMempool(g_mempool, coinbase_hash, utxos);
+    BOOST_CHECK_EQUAL(utxos.size(), m_coinbase_txns.size() - 1);
+    BOOST_CHECK(!HasUtxo(utxos, spend.vin[0].prevout));
+
+    BOOST_CHECK(FindHistory(index, p2pkh_hash).empty());
+    utxos = FindUtxos(index, p2pkh_hash);
+    BOOST_CHECK(utxos.empty());
+    BOOST_CHECK(index.FindMempoolHistory(g_mempool, p2pkh_hash, utxos) == std::vector<TxId>{spend_id});
+    index.ApplyMempool(g_mempool, p2pkh_hash, utxos);
+    BOOST_REQUIRE_EQUAL(utxos.size(), 1U);
+    BOOST_CHECK(utxos[0].outpoint == spend_out);
+    BOOST_CHECK_EQUAL(utxos[0].value, 11 * CENT);
+    BOOST_CHECK_EQUAL(utxos[0].height, 0);
+
+    // Once mined, the spend moves from the overlay to the database.
+    const CBlock block = CreateAndProcessBlock({spend}, coinbase_script);
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    SyncWithValidationInterfaceQueue();
+    const int spend_height = WITH_LOCK(cs_main, return ::ChainActive().Height());
+    BOOST_REQUIRE_EQUAL(block.vtx.size(), 2U);
+
+    history = FindHistory(index, p2pkh_hash);
+    BOOST_REQUIRE_EQUAL(history.size(), 1U);
+    BOOST_CHECK(history[0].txid == spend_id);
+    BOOST_CHECK_EQUAL(history[0].height, spend_height);
+    BOOST_CHECK_EQUAL(history[0].tx_pos, 1U);
+    utxos = FindUtxos(index, p2pkh_hash);
+    BOOST_CHECK(index.FindMempoolHistory(g_mempool, p2pkh_hash, utxos).empty());
+    BOOST_REQUIRE_EQUAL(utxos.size(), 1U);
+    BOOST_CHECK(utxos[0].outpoint == spend_out);
+    BOOST_CHECK_EQUAL(utxos[0].height, spend_height);
+
+    // The new coinbase and the spend both touch coinbase_script.
+    BOOST_CHECK_EQUAL(FindHistory(index, coinbase_hash).size(), m_coinbase_txns.size() + 2);
+    utxos = FindUtxos(index, coinbase_hash);
+    BOOST_CHECK_EQUAL(utxos.size(), m_coinbase_txns.size());
+    BOOST_CHECK(!HasUtxo(utxos, spend.vin[0].prevout));
+    BOOST_CHECK(HasUtxo(utxos, COutPoint(block.vtx[0]->GetId(), 0)));
+
+    // Reorganize the spend block away. The index rewinds as soon as the block is disconnected, and the spend returns
+    // to the mempool.
+    {
+        const CBlockIndex *tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+        CValidationState state;
+        BOOST_REQUIRE(InvalidateBlock(GetConfig(), state, const_cast<CBlockIndex *>(tip)));
+        BOOST_REQUIRE(ActivateBestChain(GetConfig(), state));
+    }
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK(g_mempool.exists(spend_id));
+    BOOST_CHECK(FindHistory(index, p2pkh_hash).empty());
+    utxos = FindUtxos(index, p2pkh_hash);
+    BOOST_CHECK(utxos.empty());
+    BOOST_CHECK(index.FindMempoolHistory(g_mempool, p2pkh_hash, utxos) == std::vector<TxId>{spend_id});
+
+    // Dropping the spend from the mempool drops it from the overlay.
+    g_mempool.removeRecursive(CTransaction(spend));
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK(index.FindMempoolHistory(g_mempool, p2pkh_hash, utxos).empty());
+    BOOST_CHECK(index.FindMempoolHistory(g_mempool, coinbase_hash, FindUtxos(index, coinbase_hash)).empty());
+
+    const CScript other_script = CScript() << OP_TRUE;
+    const CBlock other_block = CreateAndProcessBlock({}, other_script);
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK(WITH_LOCK(cs_main, return ::ChainActive().Tip()->GetBlockHash()) == other_block.GetHash());
+    BOOST_CHECK(FindHistory(index, p2pkh_hash).empty());
+
+    BOOST_CHECK_EQUAL(FindHistory(index, coinbase_hash).size(), m_coinbase_txns.size());
+    utxos = FindUtxos(index, coinbase_hash);
+    BOOST_CHECK_EQUAL(utxos.size(), m_coinbase_txns.size());
+    BOOST_CHECK(HasUtxo(utxos, spend.vin[0].prevout));
+    BOOST_CHECK(!HasUtxo(utxos, COutPoint(block.vtx[0]->GetId(), 0)));
+    BOOST_CHECK_EQUAL(FindUtxos(index, AddressIndex::GetScriptHash(other_script)).size(), 1U);
+
+    // A transaction that spends an output created in the same block. With canonical transaction ordering the spender
+    // may come first, which must not leave the spent output behind.
+    const CScript chain_script = CScript() << OP_3;
+    const uint256 chain_hash = AddressIndex::GetScriptHash(chain_script);
+    CMutableTransaction parent;
+    parent.nVersion = 1;
+    parent.vin.resize(1);
+    parent.vin[0].prevout = COutPoint(m_coinbase_txns[1]->GetId(), 0);
+    parent.vout.resize(1);
+    parent.vout[0].nValue = 10 * CENT;
+    parent.vout[0].scriptPubKey = chain_script;
+    {
+        std::vector<uint8_t> vchSig;
+        const uint256 hash = SignatureHash(coinbase_script, ScriptExecutionContext{0, m_coinbase_txns[1]->vout[0], parent},
+                                           SigHashType().withFork(), nullptr, STANDARD_SCRIPT_VERIFY_FLAGS).signatureHash;
+        BOOST_REQUIRE(coinbaseKey.SignECDSA(hash, vchSig));
+        vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+        parent.vin[0].scriptSig << vchSig;
+    }
+    CMutableTransaction child;
+    child.nVersion = 1;
+    child.vin.resize(1);
+    child.vin[0].prevout = COutPoint(parent.GetId(), 0);
+    child.vout.resize(1);
+    child.vout[0].nValue = 9 * CENT;
+    child.vout[0].scriptPubKey = chain_script;
+    // Pad the transaction to the minimum transaction size.
+    child.vout.emplace_back(CTxOut(Amount::zero(), CScript() << OP_RETURN << std::vector<uint8_t>(50)));
+
+    CreateAndProcessBlock({parent, child}, other_script);
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK_EQUAL(FindHistory(index, chain_hash).size(), 2U);
+    utxos = FindUtxos(index, chain_hash);
+    BOOST_REQUIRE_EQUAL(utxos.size(), 1U);
+    BOOST_CHECK(utxos[0].outpoint == COutPoint(child.GetId(), 0));
+
+    // Reorganize the last block away while the index is stopped. Its sync thread rewinds it when it is restarted.
+    index.Stop();
+    {
+        const CBlockIndex *tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+        CValidationState state;
+        BOOST_REQUIRE(InvalidateBlock(GetConfig(), state, const_cast<CBlockIndex *>(tip)));
+        BOOST_REQUIRE(ActivateBestChain(GetConfig(), state));
+    }
+    CreateAndProcessBlock({}, other_script);
+    index.Start();
+    WaitForSync(index);
+    BOOST_CHECK(FindHistory(index, chain_hash).empty());
+    BOOST_CHECK(FindUtxos(index, chain_hash).empty());
+
+    // An index built from scratch over the final chain agrees with the one that followed it.
+    index.Stop();
+    AddressIndex fresh_index(1 << 20, true);
+    fresh_index.Start();
+    WaitForSync(fresh_index);
+    for (const uint256 &scripthash : {coinbase_hash, p2pkh_hash, chain_hash}) {
+        BOOST_CHECK_EQUAL(FindHistory(fresh_index, scripthash).size(), FindHistory(index, scripthash).size());
+        BOOST_CHECK_EQUAL(FindUtxos(fresh_index, scripthash).size(), FindUtxos(index, scripthash).size());
+    }
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    fresh_index.Stop();
+
+    scheduler.stop();
+    schedulerThread.join();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1040,6 +1040,76 @@ BOOST_AUTO_TEST_CASE(compare) {
     }
 }
 
+#if HAVE_INT128
+// Values that fit in an int64_t are stored inline, others in libgmp. Check the results of operations whose operands
+// and results are on either side of that boundary against native 128-bit arithmetic.
+BOOST_AUTO_TEST_CASE(inline_boundary) {
+    FastRandomContext ctx;
+    constexpr int128_t i64min = std::numeric_limits<int64_t>::min(), i64max = std::numeric_limits<int64_t>::max();
+    std::vector<int128_t> vals{0, 1, -1, 2, -2, 3, i64min, i64max, i64min + 1, i64max - 1, i64min - 1, i64max + 1,
+                               -i64min, int128_t{1} << 32, -(int128_t{1} << 32)};
+    for (int i = 0; i < 20; ++i) {
+        vals.push_back(int64_t(ctx.rand64()));
+        vals.push_back(i64max + 1 + int128_t(ctx.randrange(1024)));
+        vals.push_back(i64min - 1 - int128_t(ctx.randrange(1024)));
+        vals.push_back(int128_t(ctx.rand64() >> ctx.randrange(64)) * (ctx.randbool() ? 1 : -1));
+    }
+
+    for (const int128_t a : vals) {
+        const BigInt ba(a);
+        BOOST_CHECK_EQUAL(ba, a);
+        BOOST_CHECK_EQUAL(-ba, -a);
+        BOOST_CHECK_EQUAL(ba.abs(), a < 0 ? -a : a);
+        BOOST_CHECK_EQUAL(ba.getInt().has_value(), a >= i64min && a <= i64max);
+        BOOST_CHECK_EQUAL(ba + 1, a + 1);
+        BOOST_CHECK_EQUAL(ba - 1, a - 1);
+        BigInt b(ba);
+        BOOST_CHECK_EQUAL(++b, a + 1);
+        BOOST_CHECK_EQUAL(--b, a);
+        --b;
+        BOOST_CHECK_EQUAL(b, a - 1);
+        BigInt unser;
+        unser.unserialize(ba.serialize());
+        BOOST_CHECK_EQUAL(unser, a);
+        BOOST_CHECK_EQUAL(BigInt(ba.ToString()), a);
+        for (const unsigned long n : {0ul, 1ul, 31ul, 62ul, 63ul, 64ul, 100ul}) {
+            BOOST_CHECK_EQUAL(ba >> n, n < 127u ? a >> n : (a < 0 ? -1 : 0));
+            if (a == 0 || (n <= 62u && a >= -(int128_t{1} << 64) && a <= int128_t{1} << 64)) {
+                BOOST_CHECK_EQUAL(ba << n, a * (int128_t{1} << n));
+            }
+        }
+        for (const int128_t o : vals) {
+            const BigInt bo(o);
+            BOOST_TEST_CONTEXT("a: " << ba << ", o: " << bo) {
+                BOOST_CHECK_EQUAL(ba.compare(bo), (a > o) - (a < o));
+                BOOST_CHECK_EQUAL(ba + bo, a + o);
+                BOOST_CHECK_EQUAL(ba - bo, a - o);
+                BOOST_CHECK_EQUAL(ba * bo, a * o);
+                BOOST_CHECK_EQUAL(ba & bo, a & o);
+                BOOST_CHECK_EQUAL(ba | bo, a | o);
+                BOOST_CHECK_EQUAL(ba ^ bo, a ^ o);
+                if (o != 0) {
+                    BOOST_CHECK_EQUAL(ba / bo, a / o);
+                    BOOST_CHECK_EQUAL(ba % bo, a % o);
+                    BOOST_CHECK_EQUAL(ba.mathModulo(bo), ((a % o) + (o < 0 ? -o : o)) % (o < 0 ? -o : o));
+                }
+                if (o >= i64min && o <= i64max) {
+                    const int64_t o64 = static_cast<int64_t>(o);
+                    BOOST_CHECK_EQUAL(ba.compare(o64), (a > o) - (a < o));
+                    BOOST_CHECK_EQUAL(ba + o64, a + o);
+                    BOOST_CHECK_EQUAL(ba - o64, a - o);
+                    BOOST_CHECK_EQUAL(ba * o64, a * o);
+                    if (o != 0) {
+                        BOOST_CHECK_EQUAL(ba / o64, a / o);
+                        BOOST_CHECK_EQUAL(ba % o64, a % o);
+                    }
+                }
+            }
+        }
+    }
+}
+#endif
+
 enum WhichTestVectors {
     TV_DEFAULT = 0, // from bigint_test_vectors.json
 
@@ -260,4 +260,66 @@ BOOST_FIXTURE_TEST_CASE(check_read_raw_block_from_disk, TestChain100Setup) {
     }
 }
 
+// Check that ReadRawBlockFromDisk() with -mmapblockreads returns the same data as the regular read, that the data it
+// returns stays valid, and that it picks up changes to the block files that happen after they were mapped.
+BOOST_FIXTURE_TEST_CASE(check_read_raw_block_from_disk_mmap, TestChain100Setup) {
+    const bool orig_fCheckBlockReads = fCheckBlockReads;
+    const bool orig_fMmapBlockReads = fMmapBlockReads;
+    fCheckBlockReads = true;
+    fMmapBlockReads = true;
+    Defer d([&]{
+        fCheckBlockReads = orig_fCheckBlockReads;
+        fMmapBlockReads = orig_fMmapBlockReads;
+    });
+    const auto &chainParams = GetConfig().GetChainParams();
+    const CBlockIndex *pindex;
+    FlatFilePos blockPos;
+    WITH_LOCK(cs_main, ((pindex = ::ChainActive().Tip()), (blockPos = pindex->GetBlockPos())));
+
+    std::vector<uint8_t> rawBlock;
+    BOOST_REQUIRE(ReadRawBlockFromDisk(rawBlock, pindex, chainParams, SER_DISK, CLIENT_VERSION));
+    SharedByteSpan mappedBlock;
+    BOOST_REQUIRE(ReadRawBlockFromDisk(mappedBlock, pindex, chainParams, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(mappedBlock.span() == Span<const uint8_t>{rawBlock});
+
+    CBlock block;
+    BOOST_REQUIRE(ReadBlockFromDisk(block, pindex, chainParams.GetConsensus()));
+    BOOST_CHECK(block.GetHash() == pindex->GetBlockHash());
+
+    // Mess up the on-disk magic; the mapping sees the change
+    CAutoFile file(OpenBlockFile(blockPos, false), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+    CMessageHeader::MessageMagic origMagic;
+    unsigned int origBlockSize;
+    const long headerPos = long(blockPos.nPos) - long(sizeof(origMagic) + sizeof(origBlockSize));
+    BOOST_REQUIRE(0 == std::fseek(file.Get(), headerPos, SEEK_SET));
+    file >> origMagic >> origBlockSize;
+    auto badMagic = origMagic;
+    std::reverse(badMagic.begin(), badMagic.end());
+    BOOST_REQUIRE(0 == std::fseek(file.Get(), headerPos, SEEK_SET));
+    file << badMagic;
+    BOOST_REQUIRE(0 == std::fflush(file.Get()));
+    SharedByteSpan mappedBlock2;
+    BOOST_REQUIRE(!ReadRawBlockFromDisk(mappedBlock2, pindex, chainParams, SER_DISK, CLIENT_VERSION));
+    BOOST_REQUIRE(mappedBlock2.empty());
+    // Restore the on-disk magic; should work again
+    BOOST_REQUIRE(0 == std::fseek(file.Get(), headerPos, SEEK_SET));
+    file << origMagic;
+    BOOST_REQUIRE(0 == std::fflush(file.Get()));
+    BOOST_REQUIRE(ReadRawBlockFromDisk(mappedBlock2, pindex, chainParams, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(mappedBlock2.span() == Span<const uint8_t>{rawBlock});
+
+    // A block appended to the block file after it was mapped can be read, too
+    const CBlock newBlock = CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    const CBlockIndex *pindexNew = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_REQUIRE(pindexNew->GetBlockHash() == newBlock.GetHash());
+    BOOST_REQUIRE(ReadRawBlockFromDisk(mappedBlock2, pindexNew, chainParams, SER_DISK, CLIENT_VERSION));
+    std::vector<uint8_t> rawNewBlock;
+    BOOST_REQUIRE(ReadRawBlockFromDisk(rawNewBlock, pindexNew, chainParams, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(mappedBlock2.span() == Span<const uint8_t>{rawNewBlock});
+
+    // The view obtained first is still valid
+    BOOST_CHECK(mappedBlock.span() == Span<const uint8_t>{rawBlock});
+}
+
 BOOST_AUTO_TEST_SUITE_END()
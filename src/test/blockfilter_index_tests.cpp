@@ -0,0 +1,295 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/blockfilterindex.h>
+
+#include <blockfilter.h>
+#include <chainparams.h>
+#include <config.h>
+#include <consensus/validation.h>
+#include <node/blockstorage.h>
+#include <script/standard.h>
+#include <undo.h>
+#include <util/system.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(blockfilter_index_tests, BasicTestingSetup)
+
+static bool ComputeFilter(BlockFilterType filter_type, const CBlockIndex *block_index, BlockFilter &filter) {
+    CBlock block;
+    if (!ReadBlockFromDisk(block, block_index, Params().GetConsensus())) {
+        return false;
+    }
+
+    CBlockUndo block_undo;
+    if (block_index->nHeight > 0 && !UndoReadFromDisk(block_undo, block_index)) {
+        return false;
+    }
+
+    filter = BlockFilter(filter_type, block, block_undo);
+    return true;
+}
+
+static bool CheckFilterLookups(BlockFilterIndex &filter_index, const CBlockIndex *block_index,
+                               uint256 &last_header) {
+    BlockFilter expected_filter;
+    if (!ComputeFilter(filter_index.GetFilterType(), block_index, expected_filter)) {
+        BOOST_ERROR("ComputeFilter failed on block " << block_index->nHeight);
+        return false;
+    }
+
+    BlockFilter filter;
+    uint256 filter_header;
+    std::vector<BlockFilter> filters;
+    std::vector<uint256> filter_hashes;
+
+    BOOST_CHECK(filter_index.LookupFilter(block_index, filter));
+    BOOST_CHECK(filter_index.LookupFilterHeader(block_index, filter_header));
+    BOOST_CHECK(filter_index.LookupFilterRange(block_index->nHeight, block_index, filters));
+    BOOST_CHECK(filter_index.LookupFilterHashRange(block_index->nHeight, block_index, filter_hashes));
+
+    BOOST_REQUIRE_EQUAL(filters.size(), 1U);
+    BOOST_REQUIRE_EQUAL(filter_hashes.size(), 1U);
+
+    BOOST_CHECK_EQUAL(filter.GetHash(), expected_filter.GetHash());
+    BOOST_CHECK_EQUAL(filter_header, expected_filter.ComputeHeader(last_header));
+    BOOST_CHECK_EQUAL(filters[0].GetHash(), expected_filter.GetHash());
+    BOOST_CHECK_EQUAL(filter_hashes[0], expected_filter.GetHash());
+
+    last_header = filter_header;
+    return true;
+}
+
+static void WaitForSync(BlockFilterIndex &filter_index) {
+    constexpr int64_t timeout_ms = 10 * 1000;
+    const int64_t time_start = GetTimeMillis();
+    while (!filter_index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, TestChain100Setup) {
+    BlockFilterIndex filter_index(BlockFilterType::BASIC, 1 << 20, true);
+
+    uint256 last_header;
+
+    // Filter should not be found in the index before it is started.
+    {
+        LOCK(cs_main);
+
+        BlockFilter filter;
+        uint256 filter_header;
+        std::vector<BlockFilter> filters;
+        std::vector<uint256> filter_hashes;
+
+        for (const CBlockIndex *block_index = ::ChainActive().Genesis(); block_index != nullptr;
+             block_index = ::ChainActive().Next(block_index)) {
+            BOOST_CHECK(!filter_index.LookupFilter(block_index, filter));
+            BOOST_CHECK(!filter_index.LookupFilterHeader(block_index, filter_header));
+            BOOST_CHECK(!filter_index.LookupFilterRange(block_index->nHeight, block_index, filters));
+            BOOST_CHECK(!filter_index.LookupFilterHashRange(block_index->nHeight, block_index, filter_hashes));
+        }
+    }
+
+    // BlockUntilSyncedToCurrentChain should return false before index is started.
+    BOOST_CHECK(!filter_index.BlockUntilSyncedToCurrentChain());
+
+    // Callbacks registered with CallWhenSynced() run once the index has caught up.
+    std::atomic<int> synced_calls{0};
+    filter_index.CallWhenSynced([&] { ++synced_calls; });
+
+    filter_index.Start();
+    WaitForSync(filter_index);
+    {
+        constexpr int64_t timeout_ms = 10 * 1000;
+        const int64_t time_start = GetTimeMillis();
+        while (synced_calls == 0) {
+            BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+            MilliSleep(10);
+        }
+    }
+    filter_index.CallWhenSynced([&] { ++synced_calls; });
+    BOOST_CHECK_EQUAL(synced_calls, 2);
+
+    // Check that filter index has all blocks that were in the chain before it started.
+    {
+        LOCK(cs_main);
+        for (const CBlockIndex *block_index = ::ChainActive().Genesis(); block_index != nullptr;
+             block_index = ::ChainActive().Next(block_index)) {
+            CheckFilterLookups(filter_index, block_index, last_header);
+        }
+    }
+
+    // Range lookups over the whole chain agree with the single lookups.
+    {
+        const CBlockIndex *tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+        std::vector<BlockFilter> filters;
+        std::vector<uint256> filter_hashes;
+        BOOST_CHECK(filter_index.LookupFilterRange(0, tip, filters));
+        BOOST_CHECK(filter_index.LookupFilterHashRange(0, tip, filter_hashes));
+        BOOST_REQUIRE_EQUAL(filters.size(), size_t(tip->nHeight + 1));
+        BOOST_REQUIRE_EQUAL(filter_hashes.size(), filters.size());
+        for (size_t i = 0; i < filters.size(); ++i) {
+            BOOST_CHECK_EQUAL(filters[i].GetHash(), filter_hashes[i]);
+            BOOST_CHECK_EQUAL(filters[i].GetBlockHash(), tip->GetAncestor(i)->GetBlockHash());
+        }
+    }
+
+    // Check that new blocks get indexed.
+    const CScript coinbase_script_pub_key = GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+    for (int i = 0; i < 10; i++) {
+        const CBlock block = CreateAndProcessBlock({}, coinbase_script_pub_key);
+        BOOST_CHECK(filter_index.BlockUntilSyncedToCurrentChain());
+
+        const CBlockIndex *block_index = WITH_LOCK(cs_main, return LookupBlockIndex(block.GetHash()));
+        BOOST_REQUIRE(block_index);
+        CheckFilterLookups(filter_index, block_index, last_header);
+    }
+
+    // Reorganize the last two blocks away. The filters of the stale blocks must remain available after the blocks
+    // of the new chain have taken over their heights.
+    const CBlockIndex *stale_tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    const CBlockIndex *stale_base = stale_tip->pprev;
+    BlockFilter stale_tip_filter, stale_base_filter;
+    BOOST_REQUIRE(filter_index.LookupFilter(stale_tip, stale_tip_filter));
+    BOOST_REQUIRE(filter_index.LookupFilter(stale_base, stale_base_filter));
+    {
+        CValidationState state;
+        BOOST_REQUIRE(InvalidateBlock(GetConfig(), state, const_cast<CBlockIndex *>(stale_base)));
+        BOOST_REQUIRE(ActivateBestChain(GetConfig(), state));
+    }
+
+    const CBlockIndex *fork_point = stale_base->pprev;
+    BOOST_REQUIRE(filter_index.LookupFilterHeader(fork_point, last_header));
+    const CScript other_script_pub_key = CScript() << OP_TRUE;
+    for (int i = 0; i < 3; i++) {
+        const CBlock block = CreateAndProcessBlock({}, other_script_pub_key);
+        BOOST_CHECK(filter_index.BlockUntilSyncedToCurrentChain());
+
+        const CBlockIndex *block_index = WITH_LOCK(cs_main, return LookupBlockIndex(block.GetHash()));
+        BOOST_REQUIRE(block_index);
+        CheckFilterLookups(filter_index, block_index, last_header);
+    }
+
+    BlockFilter filter;
+    BOOST_CHECK(filter_index.LookupFilter(stale_tip, filter));
+    BOOST_CHECK_EQUAL(filter.GetHash(), stale_tip_filter.GetHash());
+    BOOST_CHECK(filter_index.LookupFilter(stale_base, filter));
+    BOOST_CHECK_EQUAL(filter.GetHash(), stale_base_filter.GetHash());
+
+    // Range lookups follow the chain of the stop block, on either side of the fork.
+    std::vector<uint256> filter_hashes;
+    BOOST_CHECK(filter_index.LookupFilterHashRange(fork_point->nHeight, stale_tip, filter_hashes));
+    BOOST_REQUIRE_EQUAL(filter_hashes.size(), 3U);
+    BOOST_CHECK_EQUAL(filter_hashes[1], stale_base_filter.GetHash());
+    BOOST_CHECK_EQUAL(filter_hashes[2], stale_tip_filter.GetHash());
+
+    const CBlockIndex *tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_CHECK(filter_index.LookupFilterHashRange(fork_point->nHeight, tip, filter_hashes));
+    BOOST_REQUIRE_EQUAL(filter_hashes.size(), 4U);
+    BOOST_CHECK(filter_hashes[1] != stale_base_filter.GetHash());
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    filter_index.Stop();
+
+    scheduler.stop();
+    schedulerThread.join();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+namespace {
+/// Bare index that exposes the sync workers that BlockFilterIndex builds its filters on.
+class SyncJobsTestIndex : public BaseIndex {
+    const std::unique_ptr<BaseIndex::DB> m_db;
+
+protected:
+    BaseIndex::DB &GetDB() const override { return *m_db; }
+
+public:
+    SyncJobsTestIndex()
+        : BaseIndex("syncjobstestindex"),
+          m_db(std::make_unique<BaseIndex::DB>(GetDataDir() / "indexes" / "syncjobstestindex", 1 << 20, true)) {}
+
+    using BaseIndex::RunSyncJobs;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(blockfilter_index_sync_jobs) {
+    SyncJobsTestIndex index;
+
+    // Every job runs exactly once, on however many threads, and the workers are reused across runs.
+    for (const int n_threads : {1, 4, 2, 4}) {
+        for (const size_t n : {0, 1, 3, 100}) {
+            std::vector<std::atomic<int>> calls(n);
+            BOOST_CHECK(index.RunSyncJobs(n_threads, n, [&](size_t i) {
+                ++calls[i];
+                return true;
+            }));
+            for (const auto &c : calls) {
+                BOOST_CHECK_EQUAL(c, 1);
+            }
+        }
+    }
+
+    // A failing or throwing job fails the run without taking down its thread.
+    for (const int n_threads : {1, 4}) {
+        BOOST_CHECK(!index.RunSyncJobs(n_threads, 100, [](size_t i) { return i != 50; }));
+        BOOST_CHECK(!index.RunSyncJobs(n_threads, 100, [](size_t i) -> bool {
+            if (i == 50) throw std::runtime_error("job failed");
+            return true;
+        }));
+        BOOST_CHECK(index.RunSyncJobs(n_threads, 100, [](size_t) { return true; }));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blockfilter_index_init_destroy) {
+    BlockFilterIndex *filter_index;
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index == nullptr);
+
+    BOOST_CHECK(InitBlockFilterIndex(BlockFilterType::BASIC, 1 << 20, true, false));
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index != nullptr);
+    BOOST_CHECK(filter_index->GetFilterType() == BlockFilterType::BASIC);
+
+    // Initialize returns false if index already exists.
+    BOOST_CHECK(!InitBlockFilterIndex(BlockFilterType::BASIC, 1 << 20, true, false));
+
+    int iter_count = 0;
+    ForEachBlockFilterIndex([&iter_count](BlockFilterIndex &) { iter_count++; });
+    BOOST_CHECK_EQUAL(iter_count, 1);
+
+    BOOST_CHECK(DestroyBlockFilterIndex(BlockFilterType::BASIC));
+
+    // Destroy returns false because index was already destroyed.
+    BOOST_CHECK(!DestroyBlockFilterIndex(BlockFilterType::BASIC));
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index == nullptr);
+
+    // Reinitialize index.
+    BOOST_CHECK(InitBlockFilterIndex(BlockFilterType::BASIC, 1 << 20, true, false));
+
+    DestroyAllBlockFilterIndexes();
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
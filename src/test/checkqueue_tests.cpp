@@ -210,6 +210,42 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_Catches_Failure) {
     }
     fail_queue->StopWorkerThreads();
 }
+
+/** Test that the per-run statistics add up and are reset between runs */
+BOOST_AUTO_TEST_CASE(test_CheckQueue_Stats) {
+    auto queue = std::make_unique<Correct_Queue>(QUEUE_BATCH_SIZE);
+    queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+    for (const size_t count : {0, 1, 1000, 100000}) {
+        FakeCheckCheckCompletion::n_calls = 0;
+        CCheckQueueControl<FakeCheckCheckCompletion> control(queue.get());
+        std::vector<FakeCheckCheckCompletion> vChecks(count);
+        control.Add(vChecks);
+        BOOST_REQUIRE(control.Wait());
+        const CCheckQueueStats stats = control.GetStats();
+        BOOST_CHECK_EQUAL(FakeCheckCheckCompletion::n_calls, count);
+        BOOST_CHECK_EQUAL(stats.nChecks, count);
+        BOOST_CHECK_LE(stats.nSteals, stats.nStolenChecks);
+        BOOST_CHECK_LE(stats.nStolenChecks, count);
+        BOOST_CHECK_GE(stats.nMasterWaitMicros, 0);
+    }
+    queue->StopWorkerThreads();
+
+    // Without worker threads the master runs everything from its own queue
+    {
+        FakeCheckCheckCompletion::n_calls = 0;
+        CCheckQueueControl<FakeCheckCheckCompletion> control(queue.get());
+        BOOST_CHECK_EQUAL(control.GetStats().nChecks, 0U);
+        std::vector<FakeCheckCheckCompletion> vChecks(1000);
+        control.Add(vChecks);
+        BOOST_REQUIRE(control.Wait());
+        const CCheckQueueStats stats = control.GetStats();
+        BOOST_CHECK_EQUAL(FakeCheckCheckCompletion::n_calls, 1000U);
+        BOOST_CHECK_EQUAL(stats.nChecks, 1000U);
+        BOOST_CHECK_EQUAL(stats.nSteals, 0U);
+        BOOST_CHECK_EQUAL(stats.nMasterWaitMicros, 0);
+    }
+}
+
 // Test that a block validation which fails does not interfere with
 // future blocks, ie, the bad state is cleared.
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Recovers_From_Failure) {
@@ -625,7 +625,8 @@ void GetCoinMapEntry(const CCoinsMap &map, Amount &value, char &flags) {
 }
 
 void WriteCoinViewEntry(CCoinsView &view, const Amount value, char flags) {
-    CCoinsMap map;
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map{0, CCoinsMap::hasher{}, CCoinsMap::key_equal{}, &resource};
     InsertCoinMapEntry(map, value, flags);
     BOOST_CHECK(view.BatchWrite(map, BlockHash()));
 }
@@ -696,6 +697,39 @@ BOOST_AUTO_TEST_CASE(coin_access) {
     CheckAccessCoin(VALUE1, VALUE2, VALUE2, DIRTY | FRESH, DIRTY | FRESH);
 }
 
+static void CheckEmplaceFetchedCoin(const Amount fetched_value, const Amount cache_value,
+                                    const Amount expected_value, char cache_flags,
+                                    char expected_flags) {
+    SingleEntryCacheTest test(ABSENT, cache_value, cache_flags);
+    Coin coin;
+    SetCoinValue(fetched_value, coin);
+    test.cache.EmplaceFetchedCoin(OUTPOINT, std::move(coin));
+    test.cache.SelfTest();
+
+    Amount result_value;
+    char result_flags;
+    GetCoinMapEntry(test.cache.map(), result_value, result_flags);
+    BOOST_CHECK_EQUAL(result_value, expected_value);
+    BOOST_CHECK_EQUAL(result_flags, expected_flags);
+}
+
+BOOST_AUTO_TEST_CASE(coin_emplace_fetched) {
+    /* Check EmplaceFetchedCoin behavior, inserting a coin that was fetched
+     * from the base view out-of-band, and checking the resulting entry in the
+     * cache. Existing entries must never be overwritten.
+     *
+     *                      Fetched Cache   Result  Cache        Result
+     *                      Value   Value   Value   Flags        Flags
+     */
+    CheckEmplaceFetchedCoin(PRUNED, ABSENT, PRUNED, NO_ENTRY, FRESH);
+    CheckEmplaceFetchedCoin(VALUE1, ABSENT, VALUE1, NO_ENTRY, 0);
+    for (const char cache_flags : FLAGS) {
+        CheckEmplaceFetchedCoin(VALUE1, PRUNED, PRUNED, cache_flags, cache_flags);
+        CheckEmplaceFetchedCoin(VALUE1, VALUE2, VALUE2, cache_flags, cache_flags);
+        CheckEmplaceFetchedCoin(PRUNED, VALUE2, VALUE2, cache_flags, cache_flags);
+    }
+}
+
 static void CheckSpendCoin(Amount base_value, Amount cache_value,
                            Amount expected_value, char cache_flags,
                            char expected_flags) {
@@ -0,0 +1,109 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinstats.h>
+
+#include <coins.h>
+#include <script/script.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+BOOST_FIXTURE_TEST_SUITE(coinstats_tests, TestingSetup)
+
+//! @returns an in-memory coins database with `nTxs` random transactions of 1 to 3 outputs, at the genesis block
+static std::unique_ptr<CCoinsViewDB> MakeCoinsDB(size_t nTxs) {
+    auto db = std::make_unique<CCoinsViewDB>(1 << 20, true, true);
+    CCoinsViewCache cache(db.get());
+    for (size_t i = 0; i < nTxs; ++i) {
+        const TxId txid(InsecureRand256());
+        for (uint32_t n = 0, nOutputs = 1 + InsecureRandRange(3); n < nOutputs; ++n) {
+            const CTxOut txout(int64_t(1 + InsecureRandRange(1000)) * SATOSHI,
+                               CScript() << std::vector<uint8_t>(InsecureRandRange(40), 0x51));
+            cache.AddCoin(COutPoint(txid, n), Coin(txout, 1 + InsecureRandRange(100), InsecureRandBool()), false);
+        }
+    }
+    cache.SetBestBlock(WITH_LOCK(cs_main, return ::ChainActive().Genesis()->GetBlockHash()));
+    BOOST_REQUIRE(cache.Flush());
+    return db;
+}
+
+BOOST_AUTO_TEST_CASE(cursor_shards) {
+    const auto db = MakeCoinsDB(2000);
+    std::unique_ptr<CCoinsViewCursor> cursor(db->Cursor());
+    size_t nCoins = 0;
+    for (; cursor->Valid(); cursor->Next()) {
+        ++nCoins;
+    }
+
+    for (const size_t nShards : {size_t{1}, size_t{3}, size_t{64}, MAX_CURSOR_SHARDS}) {
+        const auto shards = db->CursorShards(nShards);
+        BOOST_REQUIRE_EQUAL(shards.size(), nShards);
+        size_t nShardCoins = 0;
+        uint8_t prevFirstByte = 0;
+        for (const auto &shard : shards) {
+            BOOST_CHECK(shard->GetBestBlock() == db->GetBestBlock());
+            for (; shard->Valid(); shard->Next()) {
+                COutPoint key;
+                BOOST_REQUIRE(shard->GetKey(key));
+                // The shards follow each other without overlap
+                BOOST_CHECK_GE(key.GetTxId().data()[0], prevFirstByte);
+                prevFirstByte = key.GetTxId().data()[0];
+                ++nShardCoins;
+            }
+        }
+        BOOST_CHECK_EQUAL(nShardCoins, nCoins);
+    }
+
+    // A view without a database cannot be sharded
+    CCoinsView dummy;
+    BOOST_CHECK(dummy.CursorShards(4).empty());
+}
+
+BOOST_AUTO_TEST_CASE(sharded_stats_match_single_thread) {
+    for (const size_t nTxs : {0, 1, 3000}) {
+        const auto db = MakeCoinsDB(nTxs);
+        for (const auto hashType : {CoinStatsHashType::NONE, CoinStatsHashType::HASH_SERIALIZED_3,
+                                    CoinStatsHashType::MUHASH_TESTING, CoinStatsHashType::ECMH}) {
+            const auto expected = ComputeUTXOStats(db.get(), hashType, {}, 1);
+            BOOST_REQUIRE(expected);
+            BOOST_CHECK_EQUAL(expected->nTransactions, nTxs);
+            for (const size_t nThreads : {2, 3, 8}) {
+                const auto stats = ComputeUTXOStats(db.get(), hashType, {}, nThreads);
+                BOOST_REQUIRE(stats);
+                BOOST_CHECK_EQUAL(stats->nHeight, expected->nHeight);
+                BOOST_CHECK(stats->hashBlock == expected->hashBlock);
+                BOOST_CHECK(stats->hashSerialized == expected->hashSerialized);
+                BOOST_CHECK_EQUAL(stats->nTransactions, expected->nTransactions);
+                BOOST_CHECK_EQUAL(stats->nTransactionOutputs, expected->nTransactionOutputs);
+                BOOST_CHECK_EQUAL(stats->nBogoSize, expected->nBogoSize);
+                BOOST_CHECK(stats->nTotalAmount == expected->nTotalAmount);
+                BOOST_CHECK_EQUAL(stats->multiSet.index(), expected->multiSet.index());
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sharded_stats_interruption) {
+    const auto db = MakeCoinsDB(3000);
+    for (const size_t nThreads : {1, 4}) {
+        size_t nCalls = 0;
+        BOOST_CHECK_THROW(ComputeUTXOStats(db.get(), CoinStatsHashType::ECMH,
+                                           [&] {
+                                               if (++nCalls == 100) {
+                                                   throw std::runtime_error("interrupted");
+                                               }
+                                           },
+                                           nThreads),
+                          std::runtime_error);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -722,6 +722,30 @@ BOOST_AUTO_TEST_CASE(sha256d64) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256_multi) {
+    // Lengths around the padding boundaries, mixed with random ones so that the lanes finish at different times
+    static const size_t LENGTHS[] = {0, 1, 32, 55, 56, 63, 64, 65, 119, 120, 127, 128, 1000};
+    for (size_t count = 0; count <= 20; ++count) {
+        std::vector<std::vector<uint8_t>> msgs(count);
+        std::vector<Span<const uint8_t>> spans;
+        for (auto &msg : msgs) {
+            const size_t len = InsecureRandBool() ? LENGTHS[InsecureRandRange(std::size(LENGTHS))]
+                                                  : InsecureRandRange(300);
+            msg = g_insecure_rand_ctx.randbytes(len);
+            spans.emplace_back(msg);
+        }
+        std::vector<uint8_t> single(32 * count), multi(32 * count), doubleSingle(32 * count), doubleMulti(32 * count);
+        for (size_t i = 0; i < count; ++i) {
+            CSHA256().Write(msgs[i]).Finalize(Span{single}.subspan(32 * i, 32));
+            CHash256().Write(msgs[i]).Finalize(Span{doubleSingle}.subspan(32 * i, 32));
+        }
+        SHA256Multi(multi.data(), spans.data(), count);
+        SHA256DMulti(doubleMulti.data(), spans.data(), count);
+        BOOST_CHECK(single == multi);
+        BOOST_CHECK(doubleSingle == doubleMulti);
+    }
+}
+
 static void TestSHA3_256(const std::string &input, const std::string &output) {
     const auto in_bytes = ParseHex(input);
     const auto out_bytes = ParseHex(output);
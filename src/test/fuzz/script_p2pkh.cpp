@@ -0,0 +1,77 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <hash.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <script/script_error.h>
+#include <script/script_flags.h>
+#include <script/script_metrics.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <test/fuzz/util.h>
+#include <test/fuzz/util/script.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Differential fuzzer for the P2PKH fast path of VerifyScript(): it must agree with the generic interpreter on the
+ * result, the error, and (upon success) the metrics.
+ */
+void test_one_input(Span<const uint8_t> buffer) {
+    FuzzedDataProvider provider(buffer.data(), buffer.size());
+
+    uint32_t flags = provider.ConsumeIntegral<uint32_t>();
+    if (flags & SCRIPT_VERIFY_CLEANSTACK) {
+        // CLEANSTACK without P2SH is forbidden by an assert
+        flags |= SCRIPT_VERIFY_P2SH;
+    }
+
+    const auto sig = ConsumeSignature(provider);
+    const auto pubkey = ConsumePubKey(provider);
+
+    CScript scriptSig;
+    switch (provider.ConsumeIntegralInRange(0, 3)) {
+        case 0:
+            scriptSig = ConsumePush(provider, sig) + ConsumePush(provider, pubkey);
+            break;
+        case 1: {
+            const auto raw = ConsumeRandomLengthByteVector(provider, 1200);
+            scriptSig = CScript(raw.begin(), raw.end());
+        } break;
+        default:
+            scriptSig = CScript() << sig << pubkey;
+            break;
+    }
+
+    uint160 hash = Hash160(pubkey);
+    if (provider.ConsumeIntegralInRange(0, 15) == 0) {
+        // Hash mismatch (OP_EQUALVERIFY fails)
+        auto bytes = provider.ConsumeBytes<uint8_t>(uint160::size());
+        bytes.resize(uint160::size());
+        hash = uint160(bytes);
+    }
+    const CScript scriptPubKey = CScript() << OP_DUP << OP_HASH160 << ToByteVector(hash) << OP_EQUALVERIFY
+                                           << OP_CHECKSIG;
+    assert(scriptPubKey.IsPayToPubKeyHash());
+
+    const FuzzedSignatureChecker checker(provider.ConsumeBool(), provider.ConsumeIntegralInRange(0, 31) == 0,
+                                         provider.ConsumeIntegralInRange<size_t>(0, 200'000));
+
+    ScriptExecutionMetrics metrics, metricsGeneric;
+    ScriptError serror, serrorGeneric;
+    const bool ret = VerifyScript(scriptSig, scriptPubKey, flags, checker, metrics, &serror);
+    const bool retGeneric = VerifyScriptGeneric(scriptSig, scriptPubKey, flags, checker, metricsGeneric, &serrorGeneric);
+
+    assert(ret == retGeneric);
+    assert(serror == serrorGeneric);
+    if (ret) {
+        assert(metrics.GetSigChecks() == metricsGeneric.GetSigChecks());
+        assert(metrics.GetBaseOpCost() == metricsGeneric.GetBaseOpCost());
+        assert(metrics.GetHashDigestIterations() == metricsGeneric.GetHashDigestIterations());
+        assert(metrics.GetCompositeOpCost(flags) == metricsGeneric.GetCompositeOpCost(flags));
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <hash.h>
+#include <pubkey.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <script/script_error.h>
+#include <script/script_flags.h>
+#include <script/script_metrics.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <test/fuzz/util.h>
+#include <test/fuzz/util/script.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Differential fuzzer for the P2SH multisig fast path of VerifyScript(): it must agree with the generic interpreter on
+ * the result, the error, and (upon success) the metrics.
+ */
+void test_one_input(Span<const uint8_t> buffer) {
+    FuzzedDataProvider provider(buffer.data(), buffer.size());
+
+    uint32_t flags = provider.ConsumeIntegral<uint32_t>();
+    if (flags & SCRIPT_VERIFY_CLEANSTACK) {
+        // CLEANSTACK without P2SH is forbidden by an assert
+        flags |= SCRIPT_VERIFY_P2SH;
+    }
+
+    // Redeem script: OP_m <pubkeys> OP_n OP_CHECKMULTISIG, or (rarely) arbitrary bytes
+    CScript redeemScript;
+    const int nKeys = provider.ConsumeIntegralInRange(1, 16);
+    const int nRequired = provider.ConsumeIntegralInRange(1, nKeys);
+    if (provider.ConsumeIntegralInRange(0, 15) == 0) {
+        const auto raw = ConsumeRandomLengthByteVector(provider, 600);
+        redeemScript = CScript(raw.begin(), raw.end());
+    } else {
+        redeemScript << CScript::EncodeOP_N(nRequired);
+        for (int i = 0; i < nKeys; ++i) {
+            auto pubkey = ConsumePubKey(provider);
+            // The template only has room for pubkeys of valid lengths; anything else falls back to the interpreter
+            if (provider.ConsumeBool()) {
+                pubkey.resize(pubkey.size() == CPubKey::PUBLIC_KEY_SIZE ? CPubKey::PUBLIC_KEY_SIZE
+                                                                        : CPubKey::COMPRESSED_PUBLIC_KEY_SIZE);
+            }
+            redeemScript << pubkey;
+        }
+        redeemScript << CScript::EncodeOP_N(nKeys) << OP_CHECKMULTISIG;
+    }
+    const std::vector<uint8_t> vchRedeemScript(redeemScript.begin(), redeemScript.end());
+
+    // Dummy element: empty (ECDSA mode) or a checkbits bitfield (Schnorr mode)
+    std::vector<uint8_t> dummy;
+    if (provider.ConsumeBool()) {
+        dummy = provider.ConsumeBytes<uint8_t>(provider.ConsumeIntegralInRange(1, 3));
+    }
+
+    CScript scriptSig;
+    switch (provider.ConsumeIntegralInRange(0, 3)) {
+        case 0:
+            scriptSig = ConsumePush(provider, dummy);
+            for (int i = 0; i < nRequired; ++i) {
+                scriptSig += ConsumePush(provider, ConsumeSignature(provider));
+            }
+            scriptSig += ConsumePush(provider, vchRedeemScript);
+            break;
+        case 1: {
+            const auto raw = ConsumeRandomLengthByteVector(provider, 1200);
+            scriptSig = CScript(raw.begin(), raw.end());
+        } break;
+        default:
+            scriptSig << dummy;
+            for (int i = 0; i < nRequired; ++i) {
+                scriptSig << ConsumeSignature(provider);
+            }
+            scriptSig << vchRedeemScript;
+            break;
+    }
+
+    const bool p2sh_32 = provider.ConsumeBool();
+    std::vector<uint8_t> hash = p2sh_32 ? ToByteVector(Hash(vchRedeemScript)) : ToByteVector(Hash160(vchRedeemScript));
+    if (provider.ConsumeIntegralInRange(0, 15) == 0) {
+        // Hash mismatch (OP_EQUAL fails)
+        hash = provider.ConsumeBytes<uint8_t>(hash.size());
+        hash.resize(p2sh_32 ? uint256::size() : uint160::size());
+    }
+    const CScript scriptPubKey = CScript() << (p2sh_32 ? OP_HASH256 : OP_HASH160) << hash << OP_EQUAL;
+
+    const FuzzedSignatureChecker checker(provider.ConsumeBool(), provider.ConsumeIntegralInRange(0, 31) == 0,
+                                         provider.ConsumeIntegralInRange<size_t>(0, 200'000));
+
+    ScriptExecutionMetrics metrics, metricsGeneric;
+    ScriptError serror, serrorGeneric;
+    const bool ret = VerifyScript(scriptSig, scriptPubKey, flags, checker, metrics, &serror);
+    const bool retGeneric = VerifyScriptGeneric(scriptSig, scriptPubKey, flags, checker, metricsGeneric, &serrorGeneric);
+
+    assert(ret == retGeneric);
+    assert(serror == serrorGeneric);
+    if (ret) {
+        assert(metrics.GetSigChecks() == metricsGeneric.GetSigChecks());
+        assert(metrics.GetBaseOpCost() == metricsGeneric.GetBaseOpCost());
+        assert(metrics.GetHashDigestIterations() == metricsGeneric.GetHashDigestIterations());
+        assert(metrics.GetCompositeOpCost(flags) == metricsGeneric.GetCompositeOpCost(flags));
+    }
+}
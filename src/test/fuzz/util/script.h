@@ -0,0 +1,89 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/util.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/** Signature checker whose verdict (and reported sighash preimage size) is decided up-front by the fuzzer. */
+class FuzzedSignatureChecker final : public BaseSignatureChecker {
+    const bool result;
+    const bool throws;
+    const size_t bytesHashed;
+
+public:
+    FuzzedSignatureChecker(bool resultIn, bool throwsIn, size_t bytesHashedIn)
+        : result(resultIn), throws(throwsIn), bytesHashed(bytesHashedIn) {}
+
+    bool CheckSig(const ByteView &, const std::vector<uint8_t> &, const ByteView &, uint32_t,
+                  size_t *pnBytesHashed) const override {
+        if (throws) {
+            throw std::runtime_error("FuzzedSignatureChecker");
+        }
+        if (pnBytesHashed) {
+            *pnBytesHashed = bytesHashed;
+        }
+        return result;
+    }
+};
+
+inline std::vector<uint8_t> ConsumeSignature(FuzzedDataProvider &provider) {
+    switch (provider.ConsumeIntegralInRange(0, 2)) {
+        case 0: {
+            // Schnorr-sized, with a (possibly) valid sighash type byte
+            auto sig = provider.ConsumeBytes<uint8_t>(64);
+            sig.resize(64);
+            sig.push_back(provider.PickValueInArray<uint8_t>({0x41, 0x43, 0xc1, 0x01, 0x00}));
+            return sig;
+        }
+        case 1:
+            return {};
+        default:
+            return ConsumeRandomLengthByteVector(provider, 600);
+    }
+}
+
+inline std::vector<uint8_t> ConsumePubKey(FuzzedDataProvider &provider) {
+    if (provider.ConsumeBool()) {
+        // Compressed pubkey encoding
+        auto pubkey = provider.ConsumeBytes<uint8_t>(33);
+        pubkey.resize(33);
+        pubkey[0] = provider.ConsumeBool() ? 0x02 : 0x03;
+        return pubkey;
+    }
+    return ConsumeRandomLengthByteVector(provider, 600);
+}
+
+/** Returns a push of `data` that is not necessarily minimally encoded. */
+inline CScript ConsumePush(FuzzedDataProvider &provider, const std::vector<uint8_t> &data) {
+    CScript script;
+    switch (provider.ConsumeIntegralInRange(0, 3)) {
+        case 0:
+            if (data.size() <= 0xff) {
+                script.push_back(OP_PUSHDATA1);
+                script.push_back(data.size());
+                break;
+            }
+            [[fallthrough]];
+        case 1:
+            if (data.size() <= 0xffff) {
+                script.push_back(OP_PUSHDATA2);
+                script.push_back(data.size() & 0xff);
+                script.push_back(data.size() >> 8);
+                break;
+            }
+            [[fallthrough]];
+        default:
+            return CScript() << data;
+    }
+    script.insert(script.end(), data.begin(), data.end());
+    return script;
+}
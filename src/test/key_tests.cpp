@@ -331,4 +331,54 @@ BOOST_AUTO_TEST_CASE(key_signature_tests) {
     BOOST_CHECK(found_small);
 }
 
+
+BOOST_AUTO_TEST_CASE(schnorr_batch_verify) {
+    // Enough signatures for both of the multi-multiplication algorithms
+    constexpr size_t COUNT = 120;
+    std::vector<CPubKey> pubkeys;
+    std::vector<uint256> hashes;
+    std::vector<std::vector<uint8_t>> sigs;
+    for (size_t i = 0; i < COUNT; ++i) {
+        CKey key;
+        key.MakeNewKey(i % 2 == 0);
+        pubkeys.push_back(key.GetPubKey());
+        hashes.push_back(InsecureRand256());
+        BOOST_CHECK(key.SignSchnorr(hashes.back(), sigs.emplace_back()));
+    }
+
+    SchnorrBatchVerifier batch;
+    // An empty batch is valid
+    BOOST_CHECK(batch.Verify());
+    for (size_t n : std::vector<size_t>{1, 2, 10, 43, 44, 79, 80, COUNT}) {
+        batch.clear();
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK(batch.Add(pubkeys[i], hashes[i], sigs[i]));
+        }
+        BOOST_CHECK_EQUAL(batch.size(), n);
+        BOOST_CHECK(batch.Verify());
+
+        // A single bad signature, message or key fails the batch
+        const size_t pos = InsecureRandRange(n);
+        std::vector<uint8_t> badSig = sigs[pos];
+        badSig[InsecureRandRange(64)] ^= 1 + InsecureRandRange(255);
+        const uint256 badHash = InsecureRand256();
+        const CPubKey &otherKey = pubkeys[(pos + 1) % COUNT];
+        for (int bad = 0; bad < 3; ++bad) {
+            batch.resize(pos);
+            BOOST_CHECK(batch.Add(bad == 2 ? otherKey : pubkeys[pos], bad == 1 ? badHash : hashes[pos],
+                                  bad == 0 ? badSig : sigs[pos]));
+            for (size_t i = pos + 1; i < n; ++i) {
+                BOOST_CHECK(batch.Add(pubkeys[i], hashes[i], sigs[i]));
+            }
+            BOOST_CHECK(!batch.Verify());
+        }
+    }
+
+    // Signatures that are not 64 bytes and invalid keys are not added
+    batch.clear();
+    BOOST_CHECK(!batch.Add(pubkeys[0], hashes[0], std::vector<uint8_t>(65)));
+    BOOST_CHECK(!batch.Add(CPubKey(), hashes[0], sigs[0]));
+    BOOST_CHECK_EQUAL(batch.size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
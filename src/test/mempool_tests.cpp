@@ -107,6 +107,277 @@ BOOST_AUTO_TEST_CASE(MempoolRemoveTest) {
     BOOST_CHECK_EQUAL(testPool.size(), 0UL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolSnapshotTest) {
+    // Test CTxMemPool::GetSnapshot functionality
+
+    TestMemPoolEntryHelper entry;
+    // Parent transaction with three children, one of which has a grand-child:
+    CMutableTransaction txParent;
+    txParent.vin.resize(1);
+    txParent.vin[0].scriptSig = CScript() << OP_11;
+    txParent.vout.resize(3);
+    for (int i = 0; i < 3; i++) {
+        txParent.vout[i].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txParent.vout[i].nValue = 33000 * SATOSHI;
+    }
+    CMutableTransaction txChild[3];
+    for (int i = 0; i < 3; i++) {
+        txChild[i].vin.resize(1);
+        txChild[i].vin[0].scriptSig = CScript() << OP_11;
+        txChild[i].vin[0].prevout = COutPoint(txParent.GetId(), i);
+        txChild[i].vout.resize(1);
+        txChild[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txChild[i].vout[0].nValue = 11000 * SATOSHI;
+    }
+    CMutableTransaction txGrandChild;
+    txGrandChild.vin.resize(1);
+    txGrandChild.vin[0].scriptSig = CScript() << OP_11;
+    txGrandChild.vin[0].prevout = COutPoint(txChild[0].GetId(), 0);
+    txGrandChild.vout.resize(1);
+    txGrandChild.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    txGrandChild.vout[0].nValue = 11000 * SATOSHI;
+
+    const auto txids = [](const std::vector<const CTxMemPoolSnapshot::Entry *> &entries) {
+        std::vector<TxId> ret;
+        for (const auto *e : entries) {
+            ret.push_back(e->txid);
+        }
+        return ret;
+    };
+
+    CTxMemPool testPool;
+    LOCK2(cs_main, testPool.cs);
+
+    const auto empty = testPool.GetSnapshot();
+    BOOST_CHECK(empty->empty());
+    // Nothing changed, so the same snapshot is handed out again
+    BOOST_CHECK_EQUAL(testPool.GetSnapshot(), empty);
+
+    testPool.addUnchecked(entry.Fee(10000 * SATOSHI).Time(1234).FromTx(txParent));
+    for (int i = 0; i < 3; i++) {
+        testPool.addUnchecked(entry.FromTx(txChild[i]));
+    }
+    testPool.addUnchecked(entry.FromTx(txGrandChild));
+
+    const auto snapshot = testPool.GetSnapshot();
+    BOOST_CHECK(snapshot != empty);
+    BOOST_CHECK(empty->empty());
+    BOOST_CHECK_EQUAL(snapshot->size(), 5U);
+    BOOST_CHECK_EQUAL(testPool.GetSnapshot(), snapshot);
+
+    const std::vector<TxId> expectedOrder{txParent.GetId(), txChild[0].GetId(), txChild[1].GetId(),
+                                          txChild[2].GetId(), txGrandChild.GetId()};
+    BOOST_CHECK(txids(snapshot->GetEntriesByEntryId()) == expectedOrder);
+
+    const CTxMemPoolSnapshot::Entry *parent = snapshot->Find(txParent.GetId());
+    BOOST_REQUIRE(parent);
+    BOOST_CHECK_EQUAL(parent->fee, 10000 * SATOSHI);
+    BOOST_CHECK_EQUAL(parent->modifiedFee, 10000 * SATOSHI);
+    BOOST_CHECK_EQUAL(parent->size, CTransaction(txParent).GetTotalSize());
+    BOOST_CHECK_EQUAL(parent->time, 1234);
+    BOOST_CHECK(parent->depends.empty());
+    BOOST_CHECK(parent->spentBy == std::vector<TxId>(expectedOrder.begin() + 1, expectedOrder.end() - 1));
+    BOOST_CHECK(txids(snapshot->GetDescendants(*parent)) ==
+                std::vector<TxId>(expectedOrder.begin() + 1, expectedOrder.end()));
+    BOOST_CHECK(snapshot->GetAncestors(*parent).empty());
+
+    const CTxMemPoolSnapshot::Entry *grandChild = snapshot->Find(txGrandChild.GetId());
+    BOOST_REQUIRE(grandChild);
+    BOOST_CHECK(grandChild->depends == std::vector<TxId>{txChild[0].GetId()});
+    BOOST_CHECK(txids(snapshot->GetAncestors(*grandChild)) ==
+                std::vector<TxId>({txParent.GetId(), txChild[0].GetId()}));
+    BOOST_CHECK(snapshot->GetDescendants(*grandChild).empty());
+
+    BOOST_CHECK(!snapshot->Find(TxId(InsecureRand256())));
+
+    // Removing a child is reflected in a new snapshot, while the old one stays as it was
+    testPool.removeRecursive(CTransaction(txChild[1]));
+    testPool.PrioritiseTransaction(txParent.GetId(), 5000 * SATOSHI);
+    const auto snapshot2 = testPool.GetSnapshot();
+    BOOST_CHECK(snapshot2 != snapshot);
+    BOOST_CHECK_EQUAL(snapshot->size(), 5U);
+    BOOST_CHECK_EQUAL(snapshot->Find(txParent.GetId())->spentBy.size(), 3U);
+    BOOST_CHECK(snapshot->Find(txChild[1].GetId()));
+    BOOST_CHECK_EQUAL(snapshot2->size(), 4U);
+    BOOST_CHECK(!snapshot2->Find(txChild[1].GetId()));
+    const CTxMemPoolSnapshot::Entry *parent2 = snapshot2->Find(txParent.GetId());
+    BOOST_REQUIRE(parent2);
+    BOOST_CHECK(parent2->spentBy == std::vector<TxId>({txChild[0].GetId(), txChild[2].GetId()}));
+    BOOST_CHECK_EQUAL(parent2->fee, 10000 * SATOSHI);
+    BOOST_CHECK_EQUAL(parent2->modifiedFee, 15000 * SATOSHI);
+    // Entries that did not change are shared with the previous snapshot, even if their shard was rebuilt
+    BOOST_CHECK_EQUAL(snapshot2->Find(txChild[0].GetId()), snapshot->Find(txChild[0].GetId()));
+
+    // The changes of a batch are published together, once the batch is closed
+    {
+        CTxMemPool::SnapshotBatch batch(testPool);
+        testPool.removeRecursive(CTransaction(txChild[2]));
+        testPool.PrioritiseTransaction(txChild[0].GetId(), 1000 * SATOSHI);
+        BOOST_CHECK_EQUAL(testPool.GetSnapshot(), snapshot2);
+    }
+    const auto snapshotBatched = testPool.GetSnapshot();
+    BOOST_CHECK(snapshotBatched != snapshot2);
+    BOOST_CHECK_EQUAL(snapshotBatched->size(), 3U);
+    BOOST_CHECK(!snapshotBatched->Find(txChild[2].GetId()));
+    BOOST_CHECK_EQUAL(snapshotBatched->Find(txChild[0].GetId())->modifiedFee, 11000 * SATOSHI);
+    BOOST_CHECK_EQUAL(testPool.GetSnapshot(), snapshotBatched);
+
+    // Incremental snapshots must match the pool exactly, also across many changes
+    std::vector<CMutableTransaction> txs(300);
+    for (size_t i = 0; i < txs.size(); ++i) {
+        txs[i].vin.resize(1);
+        txs[i].vin[0].scriptSig = CScript() << OP_11;
+        txs[i].vin[0].prevout = i % 3 == 0 ? COutPoint(TxId(InsecureRand256()), 0) : COutPoint(txs[i - 1].GetId(), 0);
+        txs[i].vout.resize(1);
+        txs[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txs[i].vout[0].nValue = 1000 * SATOSHI;
+        testPool.addUnchecked(entry.FromTx(txs[i]));
+        if (i % 7 == 0) {
+            testPool.GetSnapshot();
+        }
+        if (i % 11 == 0) {
+            testPool.removeRecursive(CTransaction(txs[i / 2]));
+        }
+    }
+    const auto snapshot3 = testPool.GetSnapshot();
+    BOOST_CHECK_EQUAL(snapshot3->size(), testPool.size());
+    for (const CTxMemPoolEntry &e : testPool.mapTx) {
+        const CTxMemPoolSnapshot::Entry *se = snapshot3->Find(e.GetTx().GetId());
+        BOOST_REQUIRE(se);
+        BOOST_CHECK_EQUAL(se->entryId, e.GetEntryId());
+        const auto it = testPool.mapTx.find(e.GetTx().GetId());
+        BOOST_CHECK_EQUAL(se->depends.size(), testPool.GetMemPoolParents(it).size());
+        std::vector<TxId> children;
+        for (CTxMemPool::txiter child : testPool.GetMemPoolChildren(it)) {
+            children.push_back(child->GetTx().GetId());
+        }
+        BOOST_CHECK(se->spentBy == children);
+    }
+
+    testPool.clear();
+    BOOST_CHECK(testPool.GetSnapshot()->empty());
+}
+
+//! Check the links of all entries in `pool` against their inputs
+static void CheckMempoolLinks(const CTxMemPool &pool) EXCLUSIVE_LOCKS_REQUIRED(pool.cs) {
+    for (CTxMemPool::txiter it = pool.mapTx.begin(); it != pool.mapTx.end(); ++it) {
+        // Parents are exactly the in-mempool txs spent by it, in entry id order.
+        CTxMemPool::setEntries expectedParents;
+        for (const CTxIn &txin : it->GetTx().vin) {
+            if (const auto parent = pool.GetIter(txin.prevout.GetTxId())) {
+                expectedParents.insert(*parent);
+            }
+        }
+        const auto parents = pool.GetMemPoolParents(it);
+        BOOST_CHECK_EQUAL(parents.size(), expectedParents.size());
+        BOOST_CHECK(std::equal(parents.begin(), parents.end(), expectedParents.begin(), expectedParents.end()));
+        // ... and each of them lists it as a child.
+        for (CTxMemPool::txiter parent : parents) {
+            const auto children = pool.GetMemPoolChildren(parent);
+            BOOST_CHECK(std::find(children.begin(), children.end(), it) != children.end());
+        }
+        uint64_t lastEntryId = 0;
+        for (CTxMemPool::txiter child : pool.GetMemPoolChildren(it)) {
+            BOOST_CHECK_GT(child->GetEntryId(), lastEntryId);
+            lastEntryId = child->GetEntryId();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MempoolLinksTest) {
+    // Test the parent/child links kept with each mempool entry
+
+    TestMemPoolEntryHelper entry;
+    // Parent transaction with five children, four of which are spent by a
+    // single grand-child:
+    CMutableTransaction txParent;
+    txParent.vin.resize(1);
+    txParent.vin[0].scriptSig = CScript() << OP_11;
+    txParent.vout.resize(5);
+    for (int i = 0; i < 5; i++) {
+        txParent.vout[i].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txParent.vout[i].nValue = 33000 * SATOSHI;
+    }
+    CMutableTransaction txChild[5];
+    for (int i = 0; i < 5; i++) {
+        txChild[i].vin.resize(1);
+        txChild[i].vin[0].scriptSig = CScript() << OP_11;
+        txChild[i].vin[0].prevout = COutPoint(txParent.GetId(), i);
+        txChild[i].vout.resize(1);
+        txChild[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txChild[i].vout[0].nValue = 11000 * SATOSHI;
+    }
+    CMutableTransaction txGrandChild;
+    txGrandChild.vin.resize(4);
+    for (int i = 0; i < 4; i++) {
+        txGrandChild.vin[i].scriptSig = CScript() << OP_11;
+        txGrandChild.vin[i].prevout = COutPoint(txChild[i].GetId(), 0);
+    }
+    txGrandChild.vout.resize(1);
+    txGrandChild.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    txGrandChild.vout[0].nValue = 40000 * SATOSHI;
+
+    CTxMemPool testPool;
+    LOCK2(cs_main, testPool.cs);
+    const size_t emptyUsage = testPool.DynamicMemoryUsage();
+
+    testPool.addUnchecked(entry.FromTx(txParent));
+    // Add the children out of txid order, the links are sorted by entry id.
+    for (int i : {3, 0, 4, 1, 2}) {
+        testPool.addUnchecked(entry.FromTx(txChild[i]));
+    }
+    testPool.addUnchecked(entry.FromTx(txGrandChild));
+    BOOST_CHECK_EQUAL(testPool.size(), 7UL);
+
+    CheckMempoolLinks(testPool);
+
+    const auto parentIt = testPool.mapTx.find(txParent.GetId());
+    BOOST_CHECK_EQUAL(testPool.GetMemPoolChildren(parentIt).size(), 5UL);
+    BOOST_CHECK(testPool.GetMemPoolParents(parentIt).empty());
+    const auto grandChildIt = testPool.mapTx.find(txGrandChild.GetId());
+    BOOST_CHECK_EQUAL(testPool.GetMemPoolParents(grandChildIt).size(), 4UL);
+    CTxMemPool::setEntries ancestors;
+    testPool.CalculateMemPoolAncestors(*grandChildIt, ancestors, false);
+    BOOST_CHECK_EQUAL(ancestors.size(), 5UL);
+    CTxMemPool::setEntries descendants;
+    testPool.CalculateDescendants(parentIt, descendants);
+    BOOST_CHECK_EQUAL(descendants.size(), 7UL);
+
+    // Entries copied from another pool get links to their new neighbours.
+    {
+        CTxMemPool copyPool;
+        LOCK(copyPool.cs);
+        const auto &index = testPool.mapTx.get<entry_id>();
+        for (auto it = index.begin(); it != index.end(); ++it) {
+            copyPool.addUnchecked(CTxMemPoolEntry(*it));
+        }
+        CheckMempoolLinks(copyPool);
+        for (CTxMemPool::txiter it = copyPool.mapTx.begin(); it != copyPool.mapTx.end(); ++it) {
+            for (CTxMemPool::txiter child : copyPool.GetMemPoolChildren(it)) {
+                BOOST_CHECK(&*child == &*copyPool.mapTx.find(child->GetTx().GetId()));
+            }
+        }
+        BOOST_CHECK_EQUAL(copyPool.DynamicMemoryUsage(), testPool.DynamicMemoryUsage());
+    }
+
+    // Removing a child takes the grand-child along, and unlinks both.
+    testPool.removeRecursive(CTransaction(txChild[2]));
+    BOOST_CHECK_EQUAL(testPool.size(), 5UL);
+    BOOST_CHECK_EQUAL(testPool.GetMemPoolChildren(parentIt).size(), 4UL);
+    CheckMempoolLinks(testPool);
+
+    // Confirming the parent leaves the remaining children without parents.
+    testPool.removeForBlock({MakeTransactionRef(txParent)});
+    BOOST_CHECK_EQUAL(testPool.size(), 4UL);
+    CheckMempoolLinks(testPool);
+
+    for (int i : {0, 1, 3, 4}) {
+        testPool.removeRecursive(CTransaction(txChild[i]));
+    }
+    BOOST_CHECK_EQUAL(testPool.size(), 0UL);
+    BOOST_CHECK_EQUAL(testPool.DynamicMemoryUsage(), emptyUsage);
+}
+
 BOOST_AUTO_TEST_CASE(MempoolClearTest) {
     // Test CTxMemPool::clear functionality
 
@@ -522,7 +793,7 @@ struct TestMemPoolWithAncestryChecker : CTxMemPool
             if (!counted.insert(candidate).second) {
                 continue;
             }
-            const setEntries &parents = GetMemPoolParents(candidate);
+            const auto parents = GetMemPoolParents(candidate);
             if (parents.size() == 0) {
                 setEntries descendants;
                 CalculateDescendants(candidate, descendants);
@@ -736,6 +736,161 @@ BOOST_AUTO_TEST_CASE(BlockAssembler_construction) {
     }
 }
 
+//! A transaction spending `prevouts`, big enough to meet the minimum transaction size
+static CMutableTransaction MakeTx(const std::vector<COutPoint> &prevouts, uint8_t tag) {
+    CMutableTransaction tx;
+    for (const COutPoint &prevout : prevouts) {
+        tx.vin.emplace_back(prevout, CScript() << std::vector<uint8_t>(50, tag));
+    }
+    tx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+    return tx;
+}
+
+static std::vector<TxId> TemplateTxIds(const CBlockTemplate &blocktemplate) {
+    std::vector<TxId> txids;
+    for (size_t i = 1; i < blocktemplate.block.vtx.size(); ++i) {
+        txids.push_back(blocktemplate.block.vtx[i]->GetId());
+    }
+    return txids;
+}
+
+BOOST_FIXTURE_TEST_CASE(CreateNewBlock_incremental, TestChain100Setup) {
+    const Config &config = GetConfig();
+    const CScript scriptPubKey = CScript() << OP_TRUE;
+    BlockAssembler::Options options;
+    options.blockMinFeeRate = blockMinFeeRate;
+
+    LOCK2(cs_main, g_mempool.cs);
+    IncrementalBlockTemplate incremental(g_mempool);
+    uint64_t nFullBuilds = 0, nIncrementalUpdates = 0;
+
+    // The incrementally maintained template must always match one selected from the whole mempool.
+    auto CheckTemplate = [&](bool fExpectIncremental) EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_mempool.cs) {
+        const auto blocktemplate = BlockAssembler(config, incremental, options).CreateNewBlock(scriptPubKey, 0, false);
+        const auto expected = BlockAssembler(config, g_mempool, options).CreateNewBlock(scriptPubKey, 0, false);
+        BOOST_CHECK(TemplateTxIds(*blocktemplate) == TemplateTxIds(*expected));
+        BOOST_CHECK_EQUAL(blocktemplate->block.vtx[0]->GetValueOut(), expected->block.vtx[0]->GetValueOut());
+        ++(fExpectIncremental ? nIncrementalUpdates : nFullBuilds);
+        BOOST_CHECK_EQUAL(incremental.GetFullBuilds(), nFullBuilds);
+        BOOST_CHECK_EQUAL(incremental.GetIncrementalUpdates(), nIncrementalUpdates);
+        return TemplateTxIds(*blocktemplate);
+    };
+    auto Add = [](const CMutableTransaction &tx, int64_t fee) EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_mempool.cs) {
+        const CTransactionRef ptx = MakeTransactionRef(tx);
+        g_mempool.addUnchecked(TestMemPoolEntryHelper().Fee(fee * SATOSHI).FromTx(ptx));
+        return ptx;
+    };
+    auto Contains = [](const std::vector<TxId> &txids, const CTransactionRef &tx) {
+        return std::find(txids.begin(), txids.end(), tx->GetId()) != txids.end();
+    };
+
+    // Independent transactions, a chain, and a child of a transaction below the minimum feerate.
+    uint8_t tag = 0;
+    for (int i = 0; i < 10; ++i) {
+        Add(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 1000 + 100 * i);
+    }
+    const CTransactionRef a = Add(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 2000);
+    const CTransactionRef b = Add(MakeTx({COutPoint(a->GetId(), 0)}, ++tag), 5000);
+    const CTransactionRef c = Add(MakeTx({COutPoint(b->GetId(), 0)}, ++tag), 500);
+    const CTransactionRef freeTx = Add(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 0);
+    const CTransactionRef freeChild = Add(MakeTx({COutPoint(freeTx->GetId(), 0)}, ++tag), 10000);
+    auto txids = CheckTemplate(false);
+    BOOST_CHECK_EQUAL(txids.size(), 13);
+    BOOST_CHECK(!Contains(txids, freeChild));
+
+    // Additions are applied to the existing template.
+    const CTransactionRef d = Add(MakeTx({COutPoint(c->GetId(), 0), COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 3000);
+    const CTransactionRef freeGrandChild = Add(MakeTx({COutPoint(freeChild->GetId(), 0)}, ++tag), 10000);
+    const CTransactionRef e = Add(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 1000);
+    txids = CheckTemplate(true);
+    BOOST_CHECK(Contains(txids, d));
+    BOOST_CHECK(Contains(txids, e));
+    BOOST_CHECK(!Contains(txids, freeGrandChild));
+
+    // So are removals, as long as all transactions fit.
+    g_mempool.removeRecursive(*b, MemPoolRemovalReason::CONFLICT);
+    txids = CheckTemplate(true);
+    BOOST_CHECK(!Contains(txids, c));
+    BOOST_CHECK(!Contains(txids, d));
+
+    // A transaction removed and added again.
+    g_mempool.removeRecursive(*e, MemPoolRemovalReason::CONFLICT);
+    Add(CMutableTransaction(*e), 1000);
+    txids = CheckTemplate(true);
+    BOOST_CHECK(Contains(txids, e));
+
+    // Prioritisation changes the selection from the whole mempool.
+    g_mempool.PrioritiseTransaction(freeTx->GetId(), 10000 * SATOSHI);
+    txids = CheckTemplate(false);
+    BOOST_CHECK(Contains(txids, freeGrandChild));
+    txids = CheckTemplate(true);
+
+    // So does a new block.
+    g_mempool.removeForBlock({a});
+    CheckTemplate(false);
+
+    // Make the block fit only three of the (equally sized) transactions below.
+    g_mempool.clear();
+    std::vector<CTransactionRef> txs;
+    for (int i = 0; i < 5; ++i) {
+        txs.push_back(Add(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 1000 * (i + 2)));
+    }
+    options.nMaxGeneratedBlockSize = 1000 + 3 * txs[0]->GetTotalSize() + 1;
+    txids = CheckTemplate(false);
+    BOOST_CHECK_EQUAL(txids.size(), 3);
+    BOOST_CHECK(!Contains(txids, txs[0]));
+    BOOST_CHECK(!Contains(txids, txs[1]));
+
+    // A transaction paying less than all selected ones doesn't fit, and needs no new selection.
+    Add(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 1000);
+    CheckTemplate(true);
+    // A transaction paying more does.
+    const CTransactionRef best = Add(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, ++tag), 100000);
+    txids = CheckTemplate(false);
+    BOOST_CHECK(Contains(txids, best));
+    BOOST_CHECK(!Contains(txids, txs[2]));
+    // Removing a selected transaction from a full block makes room for one that was left out.
+    g_mempool.removeRecursive(*best, MemPoolRemovalReason::CONFLICT);
+    txids = CheckTemplate(false);
+    BOOST_CHECK(Contains(txids, txs[2]));
+}
+
+BOOST_FIXTURE_TEST_CASE(CreateNewBlock_incremental_pending_limit, TestChain100Setup) {
+    const Config &config = GetConfig();
+    const CScript scriptPubKey = CScript() << OP_TRUE;
+
+    LOCK2(cs_main, g_mempool.cs);
+    IncrementalBlockTemplate incremental(g_mempool, 3);
+    auto Add = [](uint8_t tag) EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_mempool.cs) {
+        g_mempool.addUnchecked(
+            TestMemPoolEntryHelper().Fee(1000 * SATOSHI).FromTx(MakeTx({COutPoint(TxId(InsecureRand256()), 0)}, tag)));
+    };
+    auto Create = [&]() EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_mempool.cs) {
+        return TemplateTxIds(*BlockAssembler(config, incremental).CreateNewBlock(scriptPubKey, 0, false));
+    };
+
+    uint8_t tag = 0;
+    Add(++tag);
+    BOOST_CHECK_EQUAL(Create().size(), 1);
+    BOOST_CHECK_EQUAL(incremental.GetFullBuilds(), 1);
+
+    // Up to the limit, the additions are applied to the template.
+    for (int i = 0; i < 3; ++i) {
+        Add(++tag);
+    }
+    BOOST_CHECK_EQUAL(Create().size(), 4);
+    BOOST_CHECK_EQUAL(incremental.GetFullBuilds(), 1);
+    BOOST_CHECK_EQUAL(incremental.GetIncrementalUpdates(), 1);
+
+    // Past it, the template is dropped and selected from the whole mempool again.
+    for (int i = 0; i < 4; ++i) {
+        Add(++tag);
+    }
+    BOOST_CHECK_EQUAL(Create().size(), 8);
+    BOOST_CHECK_EQUAL(incremental.GetFullBuilds(), 2);
+    BOOST_CHECK_EQUAL(incremental.GetIncrementalUpdates(), 1);
+}
+
 BOOST_AUTO_TEST_CASE(TestCBlockTemplateEntry) {
     CTransactionRef txRef = MakeTransactionRef();
     CBlockTemplateEntry txEntry(txRef, 1 * SATOSHI, 10);
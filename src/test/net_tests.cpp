@@ -10,6 +10,8 @@
 #include <config.h>
 #include <hash.h>
 #include <netbase.h>
+#include <netmessagemaker.h>
+#include <scheduler.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
@@ -20,9 +22,13 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
 #include <ios>
 #include <memory>
 #include <string>
+#include <thread>
+#include <variant>
+#include <vector>
 
 class CAddrManSerializationMock : public CAddrMan {
 public:
@@ -77,6 +83,161 @@ private:
     uint64_t nMaxBlockSize;
 };
 
+//! Keeps the nodes it is told about, and drops all messages they send
+class NodeCollectingMessageProcessor final : public NetEventsInterface {
+public:
+    bool ProcessMessages(const Config &, NodeRef pnode, std::atomic<bool> &) override {
+        LOCK(pnode->cs_vProcessMsg);
+        pnode->vProcessMsg.clear();
+        pnode->nProcessQueueSize = 0;
+        pnode->fPauseRecv = false;
+        return false;
+    }
+    bool SendMessages(const Config &, NodeRef, std::atomic<bool> &) override { return false; }
+    void InitializeNode(const Config &, NodeRef pnode) override {
+        LOCK(cs);
+        nodes.push_back(pnode);
+    }
+    void FinalizeNode(const Config &, NodeId, bool &) override {}
+    bool IsPerPeerRateLimitingTemporarilySuppressed() const override { return true; }
+
+    NodeRef GetNode() {
+        LOCK(cs);
+        return nodes.empty() ? NodeRef{} : nodes.front();
+    }
+    void Clear() {
+        LOCK(cs);
+        nodes.clear();
+    }
+
+private:
+    Mutex cs;
+    std::vector<NodeRef> nodes GUARDED_BY(cs);
+};
+
+/**
+ * Start a CConnman listening on loopback, connect to it, and move a few MB in
+ * each direction, so that the socket buffers fill up and the socket handler
+ * has to wait for the sockets to become readable and writable again.
+ */
+static void CheckSocketHandlerTransfers(bool useEpoll) {
+    const Config &config = GetConfig();
+
+    // Find a free port
+    SOCKET hSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    BOOST_REQUIRE(hSocket != INVALID_SOCKET);
+    struct sockaddr_in sockaddr{};
+    sockaddr.sin_family = AF_INET;
+    sockaddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(sockaddr);
+    BOOST_REQUIRE_EQUAL(bind(hSocket, reinterpret_cast<struct sockaddr *>(&sockaddr), len), 0);
+    BOOST_REQUIRE_EQUAL(getsockname(hSocket, reinterpret_cast<struct sockaddr *>(&sockaddr), &len), 0);
+    CloseSocket(hSocket);
+    const CService service(CNetAddr(sockaddr.sin_addr), ntohs(sockaddr.sin_port));
+
+    NodeCollectingMessageProcessor msgproc;
+    CScheduler scheduler;
+    auto connman = std::make_unique<CConnman>(config, 0x1337, 0x1337);
+    CConnman::Options options;
+    options.nMaxConnections = 8;
+    options.m_msgproc = &msgproc;
+    // Lets Interrupt() wake the -addnode thread
+    options.nMaxAddnode = 1;
+    options.nReceiveFloodSize = 1000 * DEFAULT_MAXRECEIVEBUFFER;
+    options.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    options.vBinds.push_back(service);
+    options.m_use_addrman_outgoing = false;
+    options.m_use_epoll = useEpoll;
+    gArgs.ForceSetArg("-dnsseed", "0");
+    const bool started = connman->Start(scheduler, options);
+    gArgs.ClearArg("-dnsseed");
+    BOOST_REQUIRE(started);
+
+    hSocket = CreateSocket(service);
+    BOOST_REQUIRE(hSocket != INVALID_SOCKET);
+    BOOST_REQUIRE(ConnectSocketDirectly(service, hSocket, DEFAULT_CONNECT_TIMEOUT, false));
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    const auto waitFor = [&](auto &&condition) {
+        while (!condition()) {
+            BOOST_REQUIRE(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    // Receive: many small messages, more than fit in the socket buffers
+    std::vector<uint8_t> message;
+    {
+        const std::vector<uint8_t> payload(8, 0x42);
+        const uint256 hash = Hash(payload);
+        CMessageHeader hdr(config.GetChainParams().NetMagic(), NetMsgType::PING, payload.size());
+        std::memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+        CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, message, 0, hdr};
+        message.insert(message.end(), payload.begin(), payload.end());
+    }
+    std::vector<uint8_t> inbound;
+    while (inbound.size() < 4 * 1024 * 1024) {
+        inbound.insert(inbound.end(), message.begin(), message.end());
+    }
+    const uint64_t nRecvBefore = connman->GetTotalBytesRecv();
+    for (size_t sent = 0; sent < inbound.size();) {
+        const auto nBytes = send(hSocket, reinterpret_cast<const char *>(inbound.data() + sent),
+                                 inbound.size() - sent, 0);
+        if (nBytes > 0) {
+            sent += nBytes;
+        } else {
+            BOOST_REQUIRE_EQUAL(WSAGetLastError(), WSAEWOULDBLOCK);
+            BOOST_REQUIRE(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    waitFor([&] { return connman->GetTotalBytesRecv() - nRecvBefore >= inbound.size(); });
+    BOOST_CHECK_EQUAL(connman->GetTotalBytesRecv() - nRecvBefore, inbound.size());
+
+    // Send: a few large messages while the peer doesn't read, so that they
+    // queue up behind a full socket buffer
+    waitFor([&] { return bool(msgproc.GetNode()); });
+    const NodeRef pnode = msgproc.GetNode();
+    const std::vector<uint8_t> payload(1024 * 1024, 0x23);
+    constexpr size_t NUM_MESSAGES = 32;
+    for (size_t i = 0; i < NUM_MESSAGES; ++i) {
+        connman->PushMessage(pnode, CNetMsgMaker(INIT_PROTO_VERSION).Make("big", payload));
+    }
+    BOOST_CHECK(WITH_LOCK(pnode->cs_vSend, return !pnode->vSendMsg.empty()));
+    const size_t nExpected = NUM_MESSAGES * (CMessageHeader::HEADER_SIZE + GetSerializeSize(payload));
+    size_t nReceived = 0;
+    std::vector<char> buf(0x10000);
+    while (nReceived < nExpected) {
+        const auto nBytes = recv(hSocket, buf.data(), buf.size(), 0);
+        if (nBytes > 0) {
+            nReceived += nBytes;
+        } else {
+            BOOST_REQUIRE(nBytes < 0);
+            BOOST_REQUIRE_EQUAL(WSAGetLastError(), WSAEWOULDBLOCK);
+            BOOST_REQUIRE(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    BOOST_CHECK_EQUAL(nReceived, nExpected);
+    BOOST_CHECK(WITH_LOCK(pnode->cs_vSend, return pnode->vSendMsg.empty()));
+
+    // The peer going away is noticed, also when it hangs up right after
+    // sending some data, so that both are reported by the same socket event
+    BOOST_REQUIRE_EQUAL(size_t(send(hSocket, reinterpret_cast<const char *>(message.data()), message.size(), 0)),
+                        message.size());
+#ifdef WIN32
+    BOOST_REQUIRE_EQUAL(shutdown(hSocket, SD_SEND), 0);
+#else
+    BOOST_REQUIRE_EQUAL(shutdown(hSocket, SHUT_WR), 0);
+#endif
+    waitFor([&] { return bool(pnode->fDisconnect); });
+    CloseSocket(hSocket);
+
+    connman->Interrupt();
+    connman->Stop();
+    msgproc.Clear();
+}
+
 static CDataStream AddrmanToStream(CAddrManSerializationMock &_addrman) {
     CDataStream ssPeersIn(SER_DISK, CLIENT_VERSION);
     ssPeersIn << Params().DiskMagic();
@@ -739,4 +900,70 @@ BOOST_AUTO_TEST_CASE(ipv4_peer_with_ipv6_addrMe_test) {
     BOOST_CHECK(1);
 }
 
+BOOST_AUTO_TEST_CASE(shared_message) {
+    const Config &config = GetConfig();
+    CConnman connman(config, 0x1337, 0x1337);
+    CConnman::Options options;
+    options.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    connman.Init(options);
+
+    const CAddress addr(CService(CNetAddr(in_addr{htonl(0x0a000001)}), 7777), NODE_NETWORK);
+    std::vector<NodeRef> nodes;
+    for (NodeId id = 0; id < 3; ++id) {
+        nodes.push_back(CNode::Make({}, id, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", true));
+    }
+    const auto queued = [](const NodeRef &pnode) {
+        LOCK(pnode->cs_vSend);
+        std::vector<uint8_t> bytes;
+        for (const auto &entry : pnode->vSendMsg) {
+            std::visit([&bytes](const auto &data) { bytes.insert(bytes.end(), data.data(), data.data() + data.size()); },
+                       entry);
+        }
+        return bytes;
+    };
+
+    const std::vector<uint8_t> payload(1000, 0x42);
+    const CNetMsgMaker msgMaker(INIT_PROTO_VERSION);
+    const CSharedNetMsg msg = connman.MakeSharedMessage(msgMaker.Make(NetMsgType::TX, payload));
+    BOOST_CHECK(!msg.empty());
+    BOOST_CHECK_EQUAL(msg.Type(), NetMsgType::TX);
+    BOOST_CHECK_EQUAL(msg.Payload().size(), GetSerializeSize(payload));
+
+    // A shared message goes onto the wire exactly like a regular one
+    connman.PushMessage(nodes[0], msgMaker.Make(NetMsgType::TX, payload));
+    connman.PushMessage(nodes[1], msg);
+    connman.PushMessage(nodes[2], msg);
+    BOOST_CHECK(queued(nodes[1]) == queued(nodes[0]));
+    BOOST_CHECK(queued(nodes[2]) == queued(nodes[0]));
+    BOOST_CHECK_EQUAL(nodes[1]->nSendSize, nodes[0]->nSendSize);
+
+    // ... but without being copied
+    LOCK2(nodes[1]->cs_vSend, nodes[2]->cs_vSend);
+    BOOST_REQUIRE_EQUAL(nodes[1]->vSendMsg.size(), 2);
+    BOOST_REQUIRE_EQUAL(nodes[2]->vSendMsg.size(), 2);
+    for (size_t i = 0; i < 2; ++i) {
+        const auto *entry1 = std::get_if<SharedByteSpan>(&nodes[1]->vSendMsg[i]);
+        const auto *entry2 = std::get_if<SharedByteSpan>(&nodes[2]->vSendMsg[i]);
+        BOOST_REQUIRE(entry1 && entry2);
+        BOOST_CHECK(entry1->data() == entry2->data());
+    }
+    BOOST_CHECK(std::get<SharedByteSpan>(nodes[1]->vSendMsg[1]).data() == msg.Payload().data());
+}
+
+BOOST_AUTO_TEST_CASE(socket_handler_poll) {
+    // CConnman keeps peers.dat in the data directory
+    SetDataDir("socket_handler");
+    ClearDatadirCache();
+    CheckSocketHandlerTransfers(false);
+}
+
+#ifdef USE_EPOLL
+BOOST_AUTO_TEST_CASE(socket_handler_epoll) {
+    // CConnman keeps peers.dat in the data directory
+    SetDataDir("socket_handler");
+    ClearDatadirCache();
+    CheckSocketHandlerTransfers(true);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coins.h>
+#include <memusage.h>
+#include <support/allocators/pool.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(pool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(basic_allocating) {
+    auto resource = PoolResource<8, 8>(1024);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+    BOOST_CHECK_EQUAL(resource.ChunkSizeBytes(), 1024U);
+
+    // first chunk is already allocated, so this is served from the chunk
+    void *block = resource.Allocate(8, 8);
+    BOOST_CHECK(block != nullptr);
+
+    // freeing and allocating the same size again hands out the same block
+    resource.Deallocate(block, 8, 8);
+    void *b = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(b, block);
+    resource.Deallocate(b, 8, 8);
+
+    // a smaller request rounds up to the same size class and reuses the block
+    void *b1 = resource.Allocate(1, 1);
+    BOOST_CHECK_EQUAL(b1, block);
+    resource.Deallocate(b1, 1, 1);
+
+    // blocks that are too large or over-aligned bypass the pool
+    void *big = resource.Allocate(16, 8);
+    BOOST_CHECK(big != nullptr);
+    resource.Deallocate(big, 16, 8);
+    void *aligned = resource.Allocate(8, 16);
+    BOOST_CHECK(aligned != nullptr);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(aligned) % 16, 0U);
+    resource.Deallocate(aligned, 8, 16);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+
+    // exhaust the first chunk: 1024 / 8 = 128 blocks, then a second chunk is
+    // needed
+    std::vector<void *> blocks;
+    for (size_t i = 0; i < 129; ++i) {
+        blocks.push_back(resource.Allocate(8, 8));
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+    for (void *p : blocks) {
+        resource.Deallocate(p, 8, 8);
+    }
+    // memory is kept around in the free lists until the resource dies
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(random_allocations) {
+    struct PtrSizeAlignment {
+        void *ptr;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    // makes a bunch of random allocations and gives all of them back in random
+    // order.
+    auto resource = PoolResource<128, 8>(65536);
+    std::vector<PtrSizeAlignment> ptr_size_alignment{};
+    for (size_t i = 0; i < 1000; ++i) {
+        // make it a bit more likely to allocate than deallocate
+        if (ptr_size_alignment.empty() || InsecureRandRange(4) != 0) {
+            // allocate a random item
+            const size_t alignment = size_t{1} << InsecureRandRange(8); // 1, 2, ..., 128
+            const size_t size = (InsecureRandRange(200) / alignment + 1) * alignment; // multiple of alignment
+            void *ptr = resource.Allocate(size, alignment);
+            BOOST_CHECK(ptr != nullptr);
+            BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(ptr) % alignment, 0U);
+            // fill the memory to detect overlapping blocks
+            std::memset(ptr, int(i & 0xff), size);
+            ptr_size_alignment.push_back({ptr, size, alignment});
+        } else {
+            // randomly deallocate one item
+            auto &x = ptr_size_alignment[InsecureRandRange(ptr_size_alignment.size())];
+            resource.Deallocate(x.ptr, x.bytes, x.alignment);
+            x = ptr_size_alignment.back();
+            ptr_size_alignment.pop_back();
+        }
+    }
+
+    // deallocate all the rest
+    for (auto const &x : ptr_size_alignment) {
+        resource.Deallocate(x.ptr, x.bytes, x.alignment);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(memusage_test) {
+    auto std_map = std::unordered_map<int, int>{};
+
+    using Map = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                   PoolAllocator<std::pair<const int, int>, sizeof(std::pair<const int, int>) +
+                                                                                sizeof(void *) * 4>>;
+    auto resource = Map::allocator_type::ResourceType(1024);
+
+    {
+        auto resource_map = Map{0, std::hash<int>{}, std::equal_to<int>{}, &resource};
+
+        // can't have the same resource usage
+        BOOST_CHECK(memusage::DynamicUsage(std_map) != memusage::DynamicUsage(resource_map));
+
+        for (size_t i = 0; i < 10000; ++i) {
+            std_map[i];
+            resource_map[i];
+        }
+
+        // Eventually the resource_map should have a much lower memory usage
+        // because it has less malloc overhead
+        BOOST_CHECK_LE(memusage::DynamicUsage(resource_map), memusage::DynamicUsage(std_map) * 90 / 100);
+
+        // erasing keeps the nodes in the free lists, chunks are not released
+        const size_t chunks = resource.NumAllocatedChunks();
+        resource_map.clear();
+        BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), chunks);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(coins_cache_reallocate) {
+    CCoinsView base;
+    CCoinsViewCache cache(&base);
+    const size_t usage_empty = cache.DynamicMemoryUsage();
+
+    for (uint32_t i = 0; i < 20000; ++i) {
+        CTxOut txout(int64_t(i + 1) * SATOSHI, CScript() << OP_TRUE);
+        cache.AddCoin(COutPoint(TxId(InsecureRand256()), i), Coin(std::move(txout), 1, false), false);
+    }
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 20000U);
+    BOOST_CHECK_GT(cache.DynamicMemoryUsage(), usage_empty);
+
+    // Flush() hands the entries to the (dummy) base and gives the pooled
+    // memory back, so the cache shrinks back to its initial footprint.
+    cache.Flush();
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), usage_empty);
+
+    // the cache is still usable afterwards
+    const COutPoint outpoint(TxId(InsecureRand256()), 0);
+    cache.AddCoin(outpoint, Coin(CTxOut(SATOSHI, CScript() << OP_TRUE), 1, false), false);
+    BOOST_CHECK(cache.HaveCoinInCache(outpoint));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
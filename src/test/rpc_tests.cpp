@@ -22,9 +22,13 @@
 #include <univalue.h>
 
 #include <rpc/blockchain.h>
+#include <txdb.h>
 
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <map>
+#include <set>
 #include <thread>
 #include <vector>
 
@@ -700,4 +704,66 @@ BOOST_AUTO_TEST_CASE(rpc_submitblock_parallel) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(rpc_scantxoutset_sharded) {
+    // Fill an in-memory coins database with coins, and look for every 50th of their scripts and one token
+    CCoinsViewDB db(1 << 20, true, true);
+    ScanTxOutNeedles needles;
+    std::set<COutPoint> expected;
+    {
+        CCoinsViewCache cache(&db);
+        for (uint32_t i = 0; i < 5000; ++i) {
+            const COutPoint outpoint(TxId(InsecureRand256()), i % 3);
+            CTxOut txout(int64_t(1 + i) * SATOSHI, CScript() << OP_DUP << OP_HASH160 << ToByteVector(InsecureRand256())
+                                                            << OP_EQUALVERIFY << OP_CHECKSIG);
+            if (i % 50 == 0) {
+                needles.scriptPubKeys.insert(txout.scriptPubKey);
+                expected.insert(outpoint);
+            } else if (i == 1001) {
+                const token::Id id(InsecureRand256());
+                txout.tokenDataPtr.emplace(id, token::SafeAmount::fromInt(1000).value());
+                needles.tokenIds.insert(id);
+                expected.insert(outpoint);
+            }
+            cache.AddCoin(outpoint, Coin(txout, 1, false), false);
+        }
+        cache.SetBestBlock(BlockHash(InsecureRand256()));
+        BOOST_REQUIRE(cache.Flush());
+    }
+    // Needles that match nothing
+    for (int i = 0; i < 100; ++i) {
+        needles.scriptPubKeys.insert(CScript() << OP_RETURN << ToByteVector(InsecureRand256()));
+    }
+
+    std::atomic<int> progress;
+    const std::atomic<bool> shouldAbort{false};
+    for (const size_t nShards : {size_t{0}, size_t{1}, size_t{5}, size_t{64}}) {
+        for (const size_t nThreads : {1, 4}) {
+            std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+            if (nShards == 0) {
+                cursors.emplace_back(db.Cursor());
+            } else {
+                cursors = db.CursorShards(nShards);
+            }
+            int64_t count = 0;
+            std::map<COutPoint, Coin> results;
+            BOOST_CHECK(FindScriptPubKeysAndTokens(progress, shouldAbort, count, cursors, needles, results, [] {},
+                                                   nThreads));
+            BOOST_CHECK_EQUAL(count, 5000);
+            BOOST_CHECK_EQUAL(progress, 100);
+            BOOST_REQUIRE_EQUAL(results.size(), expected.size());
+            for (const auto &[outpoint, coin] : results) {
+                BOOST_CHECK(expected.count(outpoint));
+                BOOST_CHECK(needles.Matches(coin.GetTxOut()));
+            }
+        }
+    }
+
+    // An aborted scan fails
+    const std::atomic<bool> abort{true};
+    const auto cursors = db.CursorShards(4);
+    int64_t count = 0;
+    std::map<COutPoint, Coin> results;
+    BOOST_CHECK(!FindScriptPubKeysAndTokens(progress, abort, count, cursors, needles, results, [] {}, 2));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
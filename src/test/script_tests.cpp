@@ -165,6 +165,23 @@ static void DoTest(const CScript &scriptPubKey, const CScript &scriptSig,
                             std::string(FormatScriptError(scriptError)) +
                             " expected: " + message);
 
+    // The specialized code VerifyScript() uses for standard templates must agree with the generic interpreter,
+    // including on the metrics.
+    {
+        ScriptExecutionMetrics metrics, metricsGeneric;
+        ScriptError errFast, errGeneric;
+        const TransactionSignatureChecker checker(contexts[0]);
+        const bool ret = VerifyScript(scriptSig, scriptPubKey, flags, checker, metrics, &errFast);
+        const bool retGeneric = VerifyScriptGeneric(scriptSig, scriptPubKey, flags, checker, metricsGeneric,
+                                                    &errGeneric);
+        BOOST_CHECK_MESSAGE(ret == retGeneric && errFast == errGeneric, "generic interpreter mismatch: " + message);
+        if (ret && retGeneric) {
+            BOOST_CHECK_EQUAL(metrics.GetSigChecks(), metricsGeneric.GetSigChecks());
+            BOOST_CHECK_EQUAL(metrics.GetBaseOpCost(), metricsGeneric.GetBaseOpCost());
+            BOOST_CHECK_EQUAL(metrics.GetHashDigestIterations(), metricsGeneric.GetHashDigestIterations());
+        }
+    }
+
     // Verify that removing flags from a passing test or adding flags to a
     // failing test does not change the result, except for some special flags.
     for (int i = 0; i < 16; ++i) {
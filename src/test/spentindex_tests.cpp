@@ -0,0 +1,132 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/spentindex.h>
+
+#include <config.h>
+#include <consensus/validation.h>
+#include <key.h>
+#include <policy/policy.h>
+#include <script/interpreter.h>
+#include <script/sighashtype.h>
+#include <script/standard.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(spentindex_tests)
+
+static void WaitForSync(SpentIndex &index) {
+    constexpr int64_t timeout_ms = 10 * 1000;
+    const int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(spentindex_sync_and_reorg, TestChain100Setup) {
+    SpentIndex index(1 << 20, true);
+
+    const CScript coinbase_script = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    // Let the second coinbase mature.
+    CreateAndProcessBlock({}, coinbase_script);
+
+    // Spend the first two coinbases in a block, with the second input of the transaction spending the second one.
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(2);
+    spend.vin[0].prevout = COutPoint(m_coinbase_txns[0]->GetId(), 0);
+    spend.vin[1].prevout = COutPoint(m_coinbase_txns[1]->GetId(), 0);
+    spend.vout.resize(1);
+    spend.vout[0].nValue = 11 * CENT;
+    spend.vout[0].scriptPubKey = GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+    for (size_t i = 0; i < spend.vin.size(); ++i) {
+        std::vector<uint8_t> vchSig;
+        const ScriptExecutionContext context{unsigned(i), m_coinbase_txns[i]->vout[0], spend};
+        const uint256 hash = SignatureHash(coinbase_script, context, SigHashType().withFork(), nullptr,
+                                           STANDARD_SCRIPT_VERIFY_FLAGS).signatureHash;
+        BOOST_REQUIRE(coinbaseKey.SignECDSA(hash, vchSig));
+        vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+        spend.vin[i].scriptSig << vchSig;
+    }
+    CreateAndProcessBlock({spend}, coinbase_script);
+    const CBlockIndex *spend_block = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+
+    // Nothing should be found in the index before it is started.
+    SpentIndexEntry entry;
+    BOOST_CHECK(!index.FindSpender(spend.vin[0].prevout, entry));
+    BOOST_CHECK(!index.BlockUntilSyncedToCurrentChain());
+
+    index.Start();
+    WaitForSync(index);
+
+    for (uint32_t n = 0; n < spend.vin.size(); ++n) {
+        BOOST_REQUIRE(index.FindSpender(spend.vin[n].prevout, entry));
+        BOOST_CHECK(entry.txid == spend.GetId());
+        BOOST_CHECK_EQUAL(entry.input_index, n);
+        BOOST_CHECK_EQUAL(entry.height, spend_block->nHeight);
+    }
+    BOOST_CHECK(!index.FindSpender(COutPoint(m_coinbase_txns[2]->GetId(), 0), entry));
+    BOOST_CHECK(!index.FindSpender(COutPoint(spend.GetId(), 0), entry));
+
+    // New blocks get indexed.
+    CMutableTransaction spend2;
+    spend2.nVersion = 1;
+    spend2.vin.resize(1);
+    spend2.vin[0].prevout = COutPoint(m_coinbase_txns[2]->GetId(), 0);
+    spend2.vout.resize(1);
+    spend2.vout[0].nValue = 11 * CENT;
+    spend2.vout[0].scriptPubKey = coinbase_script;
+    {
+        std::vector<uint8_t> vchSig;
+        const ScriptExecutionContext context{0, m_coinbase_txns[2]->vout[0], spend2};
+        const uint256 hash = SignatureHash(coinbase_script, context, SigHashType().withFork(), nullptr,
+                                           STANDARD_SCRIPT_VERIFY_FLAGS).signatureHash;
+        BOOST_REQUIRE(coinbaseKey.SignECDSA(hash, vchSig));
+        vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+        spend2.vin[0].scriptSig << vchSig;
+    }
+    CreateAndProcessBlock({spend2}, coinbase_script);
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    BOOST_REQUIRE(index.FindSpender(spend2.vin[0].prevout, entry));
+    BOOST_CHECK(entry.txid == spend2.GetId());
+    BOOST_CHECK_EQUAL(entry.height, spend_block->nHeight + 1);
+
+    // Disconnecting the blocks removes their entries right away, and connecting them again restores the entries.
+    {
+        CValidationState state;
+        BOOST_REQUIRE(InvalidateBlock(GetConfig(), state, const_cast<CBlockIndex *>(spend_block)));
+        BOOST_REQUIRE(ActivateBestChain(GetConfig(), state));
+    }
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(!index.FindSpender(spend.vin[0].prevout, entry));
+    BOOST_CHECK(!index.FindSpender(spend.vin[1].prevout, entry));
+    BOOST_CHECK(!index.FindSpender(spend2.vin[0].prevout, entry));
+
+    {
+        WITH_LOCK(cs_main, ResetBlockFailureFlags(const_cast<CBlockIndex *>(spend_block)));
+        CValidationState state;
+        BOOST_REQUIRE(ActivateBestChain(GetConfig(), state));
+    }
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    BOOST_REQUIRE(index.FindSpender(spend.vin[1].prevout, entry));
+    BOOST_CHECK_EQUAL(entry.input_index, 1U);
+    BOOST_REQUIRE(index.FindSpender(spend2.vin[0].prevout, entry));
+    BOOST_CHECK(entry.txid == spend2.GetId());
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    index.Stop();
+
+    scheduler.stop();
+    schedulerThread.join();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
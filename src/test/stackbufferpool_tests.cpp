@@ -0,0 +1,66 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <script/stackbufferpool.h>
+
+#include <script/script.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(stackbufferpool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(stack_buffer_pool) {
+    StackBufferPool pool;
+    BOOST_CHECK_EQUAL(pool.Take().capacity(), 0u);
+
+    // Recycled buffers are handed back out, for numbers as well as for copies
+    valtype vch(100, 0x42);
+    const uint8_t *data = vch.data();
+    const size_t cap = vch.capacity();
+    pool.Recycle(std::move(vch));
+    pool.Recycle(valtype{}); // nothing to pool
+    BOOST_CHECK_EQUAL(pool.GetCount(), 1u);
+    BOOST_CHECK_EQUAL(pool.GetBytes(), cap);
+    const auto num = ScriptBigInt::fromIntUnchecked(-1234567);
+    valtype serialized = pool.Serialize(num);
+    BOOST_CHECK(serialized.data() == data);
+    BOOST_CHECK(serialized == num.getvch());
+    BOOST_CHECK_EQUAL(pool.GetCount(), 0u);
+    BOOST_CHECK_EQUAL(pool.GetBytes(), 0u);
+    pool.Recycle(std::move(serialized));
+    const valtype src(50, 0x07);
+    const valtype copy = pool.Copy(src);
+    BOOST_CHECK(copy.data() == data);
+    BOOST_CHECK(copy == src);
+
+    // While evaluating, the pool is bounded by the number of buffers...
+    for (size_t i = 0; i < StackBufferPool::MAX_BUFFERS + 10; ++i) {
+        pool.Recycle(valtype(8));
+    }
+    BOOST_CHECK_EQUAL(pool.GetCount(), StackBufferPool::MAX_BUFFERS);
+    BOOST_CHECK_LE(pool.GetBytes(), StackBufferPool::MAX_BYTES);
+    // ... and Trim() brings it back down to its idle bounds
+    pool.Trim();
+    BOOST_CHECK_EQUAL(pool.GetCount(), StackBufferPool::MAX_BUFFERS_IDLE);
+    BOOST_CHECK_LE(pool.GetBytes(), StackBufferPool::MAX_BYTES_IDLE);
+
+    // ... as well as by the number of bytes, and buffers larger than the idle byte bound are released by Trim()
+    StackBufferPool large;
+    const size_t largeCap = valtype(100'000).capacity();
+    for (size_t i = 0; i < 20; ++i) {
+        large.Recycle(valtype(100'000));
+    }
+    BOOST_CHECK_EQUAL(large.GetCount(), StackBufferPool::MAX_BYTES / largeCap);
+    BOOST_CHECK_LE(large.GetBytes(), StackBufferPool::MAX_BYTES);
+    large.Trim();
+    BOOST_CHECK_EQUAL(large.GetCount(), 0u);
+    BOOST_CHECK_EQUAL(large.GetBytes(), 0u);
+    large.Recycle(valtype(1'000));
+    large.Trim();
+    BOOST_CHECK_EQUAL(large.GetCount(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -36,6 +36,8 @@
 #include <univalue.h>
 
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
 
 BOOST_FIXTURE_TEST_SUITE(transaction_tests, BasicTestingSetup)
@@ -511,6 +513,117 @@ BOOST_AUTO_TEST_CASE(test_big_transaction) {
     scriptcheckqueue.StopWorkerThreads();
 }
 
+namespace {
+//! A transaction whose inputs are signed with Schnorr signatures, and the CScriptChecks of its inputs
+struct SchnorrSpend {
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins{&coinsDummy};
+    CTransactionRef tx;
+    std::vector<CScriptCheck> checks;
+};
+} // namespace
+
+/**
+ * Spend `nInputs` P2PKH coins, except that the signature of input `badInput` is wrong, and it spends a
+ * `<pubkey> OP_CHECKSIG OP_NOT` coin if `fNot` is set.
+ */
+static std::unique_ptr<SchnorrSpend> MakeSchnorrSpend(const CKey &key, size_t nInputs, uint32_t flags,
+                                                      std::optional<size_t> badInput = std::nullopt,
+                                                      bool fNot = false, CheckInputsLimiter *pLimiter = nullptr) {
+    auto spend = std::make_unique<SchnorrSpend>();
+    const CPubKey pubkey = key.GetPubKey();
+    const SigHashType sigHashType = SigHashType().withFork();
+    CMutableTransaction mtx;
+    std::vector<CScript> scriptPubKeys;
+    for (size_t i = 0; i < nInputs; ++i) {
+        const COutPoint outpoint(TxId(InsecureRand256()), 0);
+        const CScript &scriptPubKey = scriptPubKeys.emplace_back(
+            i == badInput && fNot ? CScript() << ToByteVector(pubkey) << OP_CHECKSIG << OP_NOT
+                                  : GetScriptForDestination(pubkey.GetID()));
+        mtx.vin.emplace_back(outpoint);
+        spend->coins.AddCoin(outpoint, Coin(CTxOut(COIN, scriptPubKey), 1, false), false);
+    }
+    mtx.vout.emplace_back(int64_t(nInputs) * COIN, CScript() << OP_1);
+
+    const auto contexts = ScriptExecutionContext::createForAllInputs(mtx, spend->coins);
+    for (size_t i = 0; i < nInputs; ++i) {
+        std::vector<uint8_t> sig;
+        const uint256 sighash = SignatureHash(scriptPubKeys[i], contexts[i], sigHashType, nullptr, flags).signatureHash;
+        BOOST_REQUIRE(key.SignSchnorr(sighash, sig));
+        if (i == badInput) {
+            sig[InsecureRandRange(sig.size())] ^= 1 + InsecureRandRange(255);
+        }
+        sig.push_back(uint8_t(sigHashType.getRawSigHashType()));
+        mtx.vin[i].scriptSig = CScript() << sig;
+        if (!(i == badInput && fNot)) {
+            mtx.vin[i].scriptSig << ToByteVector(pubkey);
+        }
+    }
+    spend->tx = MakeTransactionRef(std::move(mtx));
+
+    const auto txContexts = ScriptExecutionContext::createForAllInputs(*spend->tx, spend->coins);
+    const PrecomputedTransactionData txdata(txContexts.at(0));
+    for (const auto &context : txContexts) {
+        spend->checks.emplace_back(context, flags, false, txdata, nullptr, pLimiter);
+    }
+    return spend;
+}
+
+BOOST_AUTO_TEST_CASE(test_schnorr_batch) {
+    CKey key;
+    key.MakeNewKey(true);
+    constexpr size_t N_INPUTS = 40;
+    constexpr uint32_t flags = STANDARD_SCRIPT_VERIFY_FLAGS;
+    static_assert(flags & SCRIPT_VERIFY_NULLFAIL);
+
+    // All signatures are valid
+    {
+        const auto spend = MakeSchnorrSpend(key, N_INPUTS, flags);
+        BOOST_CHECK(CScriptCheck::RunBatch(spend->checks));
+        for (auto &check : spend->checks) {
+            BOOST_CHECK(check());
+        }
+        std::vector<CScriptCheck> none;
+        BOOST_CHECK(CScriptCheck::RunBatch(none));
+    }
+
+    // A single bad signature fails the batch, wherever it is
+    for (const size_t badInput : {size_t{0}, size_t{17}, N_INPUTS - 1}) {
+        const auto spend = MakeSchnorrSpend(key, N_INPUTS, flags, badInput);
+        BOOST_CHECK(!CScriptCheck::RunBatch(spend->checks));
+        for (size_t i = 0; i < N_INPUTS; ++i) {
+            BOOST_CHECK_EQUAL(spend->checks[i](), i != badInput);
+        }
+        BOOST_CHECK(spend->checks[badInput].GetScriptError() == ScriptError::SIG_NULLFAIL);
+    }
+
+    // A bad signature that OP_NOT turns into success is only allowed without NULLFAIL, in which case nothing of that
+    // script is deferred
+    {
+        const auto spend = MakeSchnorrSpend(key, N_INPUTS, flags, 5, true);
+        BOOST_CHECK(!CScriptCheck::RunBatch(spend->checks));
+        BOOST_CHECK(!spend->checks[5]());
+    }
+    {
+        const auto spend = MakeSchnorrSpend(key, N_INPUTS, flags & ~SCRIPT_VERIFY_NULLFAIL, 5, true);
+        BOOST_CHECK(CScriptCheck::RunBatch(spend->checks));
+        BOOST_CHECK(spend->checks[5]());
+    }
+
+    // The sigchecks are counted just like when running the checks one by one
+    for (const int64_t nLimit : {int64_t(N_INPUTS), int64_t(N_INPUTS) - 1}) {
+        CheckInputsLimiter batchLimiter(nLimit), limiter(nLimit);
+        const auto batchSpend = MakeSchnorrSpend(key, N_INPUTS, flags, std::nullopt, false, &batchLimiter);
+        const auto spend = MakeSchnorrSpend(key, N_INPUTS, flags, std::nullopt, false, &limiter);
+        bool fOk = true;
+        for (auto &check : spend->checks) {
+            fOk = fOk && check();
+        }
+        BOOST_CHECK_EQUAL(CScriptCheck::RunBatch(batchSpend->checks), fOk);
+        BOOST_CHECK_EQUAL(fOk, nLimit == int64_t(N_INPUTS));
+    }
+}
+
 SignatureData CombineSignatures(const CMutableTransaction &input1,
                                 const CMutableTransaction &input2,
                                 const CTransactionRef tx, ScriptExecutionContextOpt context = {}) {
@@ -6,6 +6,8 @@
 #include <index/txindex.h>
 
 #include <chainparams.h>
+#include <config.h>
+#include <consensus/validation.h>
 #include <script/standard.h>
 #include <util/system.h>
 #include <util/time.h>
@@ -83,4 +85,60 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup) {
     // Rest of shutdown sequence and destructors happen in ~TestingSetup()
 }
 
+BOOST_FIXTURE_TEST_CASE(txindex_reorg, TestChain100Setup) {
+    TxIndex txindex(1 << 20, true);
+    txindex.Start();
+
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!txindex.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+
+    CTransactionRef tx_disk;
+    BlockHash block_hash;
+    const CScript coinbase_script_pub_key =
+        GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+    const CBlock stale_block = CreateAndProcessBlock({}, coinbase_script_pub_key);
+    CBlockIndex *const stale_index =
+        WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_CHECK(txindex.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(txindex.GetSummary().best_block_hash == stale_index->GetBlockHash());
+
+    // Disconnecting the tip moves the best block of the index back right away,
+    // rather than when the next block is connected.
+    {
+        CValidationState state;
+        BOOST_REQUIRE(InvalidateBlock(GetConfig(), state, stale_index));
+        BOOST_REQUIRE(ActivateBestChain(GetConfig(), state));
+    }
+    BOOST_CHECK(txindex.BlockUntilSyncedToCurrentChain());
+    IndexSummary summary = txindex.GetSummary();
+    BOOST_CHECK(summary.best_block_hash == stale_index->pprev->GetBlockHash());
+    BOOST_CHECK_EQUAL(summary.best_block_height, stale_index->nHeight - 1);
+
+    // The transactions of the stale block are still found, as before.
+    BOOST_CHECK(txindex.FindTx(stale_block.vtx[0]->GetId(), block_hash, tx_disk));
+    BOOST_CHECK(block_hash == stale_index->GetBlockHash());
+
+    // A block of the other chain gets indexed on top of the rewound tip.
+    const CBlock &block = CreateAndProcessBlock(
+        {}, CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG);
+    BOOST_CHECK(txindex.BlockUntilSyncedToCurrentChain());
+    summary = txindex.GetSummary();
+    BOOST_CHECK(summary.best_block_hash == block.GetHash());
+    BOOST_CHECK_EQUAL(summary.best_block_height, stale_index->nHeight);
+    BOOST_CHECK(txindex.FindTx(block.vtx[0]->GetId(), block_hash, tx_disk));
+    BOOST_CHECK(block_hash == block.GetHash());
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    txindex.Stop();
+
+    scheduler.stop();
+    schedulerThread.join();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
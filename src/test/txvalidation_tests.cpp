@@ -6,8 +6,11 @@
 #include <amount.h>
 #include <config.h>
 #include <consensus/validation.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <script/script.h>
+#include <script/sighashtype.h>
 #include <test/setup_common.h>
 #include <txmempool.h>
 #include <validation.h>
@@ -112,4 +115,88 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_reject_dup_txin, TestChain100Setup) {
     }
 }
 
+/**
+ * Create a 1-input-1-output transaction that spends a P2PK output of `key`
+ * back to the same script.
+ */
+static CTransactionRef SignedSpend(const CKey &key, const CTransaction &prevTx, uint32_t n, const Amount fee) {
+    const CTxOut &prevTxOut = prevTx.vout[n];
+    CMutableTransaction tx;
+    tx.nVersion = 1;
+    tx.vin.emplace_back(COutPoint(prevTx.GetId(), n));
+    tx.vout.emplace_back(prevTxOut.nValue - fee, prevTxOut.scriptPubKey);
+
+    std::vector<uint8_t> vchSig;
+    const uint256 hash = SignatureHash(prevTxOut.scriptPubKey, ScriptExecutionContext{0, prevTxOut, tx},
+                                       SigHashType().withFork(), nullptr, STANDARD_SCRIPT_VERIFY_FLAGS).signatureHash;
+    BOOST_CHECK(key.SignSchnorr(hash, vchSig));
+    vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+    tx.vin[0].scriptSig << vchSig;
+    return MakeTransactionRef(tx);
+}
+
+/**
+ * Ensure that AcceptToMemoryPoolBatch() accepts chains submitted out of order,
+ * and rejects duplicates and conflicts within the batch just like
+ * AcceptToMemoryPool() would.
+ */
+BOOST_FIXTURE_TEST_CASE(tx_mempool_accept_batch, TestChain100Setup) {
+    const Amount fee = 1000 * SATOSHI;
+    // Mature the second coinbase.
+    CreateAndProcessBlock({}, CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG);
+
+    // A chain a -> b -> c, an independent d, and e which conflicts with a.
+    const CTransactionRef a = SignedSpend(coinbaseKey, *m_coinbase_txns[0], 0, fee);
+    const CTransactionRef b = SignedSpend(coinbaseKey, *a, 0, fee);
+    const CTransactionRef c = SignedSpend(coinbaseKey, *b, 0, fee);
+    const CTransactionRef d = SignedSpend(coinbaseKey, *m_coinbase_txns[1], 0, fee);
+    const CTransactionRef e = SignedSpend(coinbaseKey, *m_coinbase_txns[0], 0, 2 * fee);
+    // Spends an output that doesn't exist (yet).
+    CMutableTransaction orphan(*d);
+    orphan.vin[0].prevout = COutPoint(TxId(InsecureRand256()), 0);
+
+    LOCK(cs_main);
+    const unsigned int initialPoolSize = g_mempool.size();
+
+    std::vector<MempoolAcceptBatchEntry> entries;
+    for (const CTransactionRef &tx : {c, b, a, a, e, d, MakeTransactionRef(orphan)}) {
+        entries.emplace_back(tx, GetTime());
+    }
+    AcceptToMemoryPoolBatch(GetConfig(), g_mempool, entries, false /* bypass_limits */,
+                            Amount::zero() /* nAbsurdFee */);
+
+    // c, b, a
+    for (size_t i = 0; i < 3; ++i) {
+        BOOST_CHECK(entries[i].fAccepted);
+        BOOST_CHECK(entries[i].state.IsValid());
+        BOOST_CHECK(!entries[i].fMissingInputs);
+        BOOST_CHECK(entries[i].entryId != 0);
+        BOOST_CHECK(g_mempool.exists(entries[i].tx->GetId()));
+    }
+    // Dependencies determine the order of insertion, not the batch order.
+    BOOST_CHECK(entries[2].entryId < entries[1].entryId);
+    BOOST_CHECK(entries[1].entryId < entries[0].entryId);
+
+    // The second a
+    BOOST_CHECK(!entries[3].fAccepted);
+    BOOST_CHECK_EQUAL(entries[3].state.GetRejectReason(), "txn-already-in-mempool");
+    BOOST_CHECK_EQUAL(entries[3].entryId, 0U);
+
+    // e lost against a, which came first.
+    BOOST_CHECK(!entries[4].fAccepted);
+    BOOST_CHECK_EQUAL(entries[4].state.GetRejectReason(), "txn-mempool-conflict");
+    BOOST_CHECK(!g_mempool.exists(e->GetId()));
+
+    // d
+    BOOST_CHECK(entries[5].fAccepted);
+    BOOST_CHECK(g_mempool.exists(d->GetId()));
+
+    // The orphan
+    BOOST_CHECK(!entries[6].fAccepted);
+    BOOST_CHECK(entries[6].fMissingInputs);
+    BOOST_CHECK(entries[6].state.IsValid());
+
+    BOOST_CHECK_EQUAL(g_mempool.size(), initialPoolSize + 4);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
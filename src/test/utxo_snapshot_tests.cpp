@@ -0,0 +1,225 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <utxosync/snapshot.h>
+
+#include <chainparams.h>
+#include <clientversion.h>
+#include <coins.h>
+#include <coinstats.h>
+#include <fs.h>
+#include <primitives/token.h>
+#include <script/script.h>
+#include <streams.h>
+#include <txdb.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(utxo_snapshot_tests, TestingSetup)
+
+//! @returns an in-memory coins database with `nTxs` random transactions of 1 to 3 outputs, one of them with a token
+static std::unique_ptr<CCoinsViewDB> MakeCoinsDB(size_t nTxs, const BlockHash &hashBestBlock) {
+    auto db = std::make_unique<CCoinsViewDB>(1 << 20, true, true);
+    CCoinsViewCache cache(db.get());
+    for (size_t i = 0; i < nTxs; ++i) {
+        const TxId txid(InsecureRand256());
+        for (uint32_t n = 0, nOutputs = 1 + InsecureRandRange(3); n < nOutputs; ++n) {
+            CTxOut txout(int64_t(1 + InsecureRandRange(1000)) * SATOSHI,
+                         CScript() << std::vector<uint8_t>(InsecureRandRange(40), 0x51));
+            if (i == 0) {
+                txout.tokenDataPtr.emplace(token::Id{InsecureRand256()}, token::SafeAmount::fromIntUnchecked(1000));
+            }
+            cache.AddCoin(COutPoint(txid, n), Coin(txout, 1 + InsecureRandRange(100), InsecureRandBool()), false);
+        }
+    }
+    cache.SetBestBlock(hashBestBlock);
+    BOOST_REQUIRE(cache.Flush());
+    return db;
+}
+
+using CoinTuple = std::tuple<COutPoint, CTxOut, uint32_t, bool>;
+
+static std::vector<CoinTuple> GetCoins(const CCoinsViewDB &db) {
+    std::vector<CoinTuple> coins;
+    std::unique_ptr<CCoinsViewCursor> cursor(db.Cursor());
+    for (; cursor->Valid(); cursor->Next()) {
+        COutPoint outpoint;
+        Coin coin;
+        BOOST_REQUIRE(cursor->GetKey(outpoint) && cursor->GetValue(coin));
+        coins.emplace_back(outpoint, coin.GetTxOut(), coin.GetHeight(), coin.IsCoinBase());
+    }
+    return coins;
+}
+
+static utxosync::SnapshotMetadata MakeMetadata(const CCoinsViewDB &db) {
+    utxosync::SnapshotMetadata metadata;
+    metadata.netMagic = Params().NetMagic();
+    metadata.baseBlockHash = db.GetBestBlock();
+    metadata.baseHeight = 1;
+    metadata.nChainTx = 2;
+    return metadata;
+}
+
+static utxosync::SnapshotSummary Dump(const CCoinsViewDB &db, const fs::path &path, size_t nShards,
+                                      size_t nThreads) {
+    CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+    return utxosync::DumpSnapshot(file, MakeMetadata(db), db.CursorShards(nShards), nThreads, {});
+}
+
+static utxosync::SnapshotSummary Load(CCoinsViewDB &db, const fs::path &path, size_t nThreads,
+                                      const uint256 &expectedHash,
+                                      const std::function<void()> &interruption_point = {}) {
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+    utxosync::SnapshotMetadata metadata;
+    file >> metadata;
+    BOOST_CHECK(metadata.netMagic == Params().NetMagic());
+    return utxosync::LoadSnapshot(file, metadata, db, nThreads, expectedHash, interruption_point);
+}
+
+static void CheckEmpty(const CCoinsViewDB &db, const BlockHash &hashBestBlock) {
+    BOOST_CHECK(GetCoins(db).empty());
+    BOOST_CHECK(db.GetBestBlock() == hashBestBlock);
+    BOOST_CHECK(db.GetHeadBlocks().empty());
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_roundtrip) {
+    const fs::path path = GetDataDir() / "utxo.dat";
+    // ComputeUTXOStats() needs the best block of the source to be in the block index
+    const BlockHash genesis = Params().GetConsensus().hashGenesisBlock;
+    for (const size_t nTxs : {0, 1, 5000}) {
+        const auto src = MakeCoinsDB(nTxs, genesis);
+        const auto stats = ComputeUTXOStats(src.get(), CoinStatsHashType::ECMH, {});
+        BOOST_REQUIRE(stats);
+
+        for (const auto &[nShards, nThreads] : {std::pair<size_t, size_t>{1, 1}, {16, 3}, {MAX_CURSOR_SHARDS, 8}}) {
+            const auto dumped = Dump(*src, path, nShards, nThreads);
+            BOOST_CHECK_EQUAL(dumped.nCoins, stats->nTransactionOutputs);
+            BOOST_CHECK(dumped.ecmhHash == stats->hashSerialized);
+
+            for (const size_t nLoadThreads : {1, 4}) {
+                const auto dst = MakeCoinsDB(0, BlockHash(InsecureRand256()));
+                const auto loaded = Load(*dst, path, nLoadThreads, stats->hashSerialized);
+                BOOST_CHECK_EQUAL(loaded.nCoins, dumped.nCoins);
+                BOOST_CHECK(loaded.ecmhHash == dumped.ecmhHash);
+                BOOST_CHECK(dst->GetBestBlock() == src->GetBestBlock());
+                BOOST_CHECK(dst->GetHeadBlocks().empty());
+                BOOST_CHECK(GetCoins(*dst) == GetCoins(*src));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_rejected) {
+    const fs::path path = GetDataDir() / "utxo.dat";
+    const BlockHash genesis = Params().GetConsensus().hashGenesisBlock;
+    const auto src = MakeCoinsDB(3000, BlockHash(InsecureRand256()));
+    const uint256 hash = Dump(*src, path, 8, 2).ecmhHash;
+
+    // Wrong expected hash
+    {
+        const auto dst = MakeCoinsDB(0, genesis);
+        BOOST_CHECK_THROW(Load(*dst, path, 2, uint256(InsecureRand256())), std::runtime_error);
+        CheckEmpty(*dst, genesis);
+    }
+
+    // Interrupted after the first group of chunks
+    {
+        const auto dst = MakeCoinsDB(0, genesis);
+        int nCalls = 0;
+        const auto interrupt = [&nCalls] {
+            if (++nCalls > 1) {
+                throw std::runtime_error("interrupted");
+            }
+        };
+        BOOST_CHECK_THROW(Load(*dst, path, 1, hash, interrupt), std::runtime_error);
+        BOOST_CHECK_EQUAL(nCalls, 2);
+        CheckEmpty(*dst, genesis);
+    }
+
+    // The database must be empty
+    {
+        const auto dst = MakeCoinsDB(1, genesis);
+        const auto coins = GetCoins(*dst);
+        BOOST_CHECK_THROW(Load(*dst, path, 2, hash), std::runtime_error);
+        BOOST_CHECK(GetCoins(*dst) == coins);
+        BOOST_CHECK(dst->GetBestBlock() == genesis);
+    }
+
+    // Corrupt a byte of the coins, or truncate the file
+    std::vector<uint8_t> data;
+    {
+        CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+        data.resize(fs::file_size(path));
+        file.read(reinterpret_cast<char *>(data.data()), data.size());
+    }
+    const std::vector<uint8_t> corrupted = [&] {
+        auto ret = data;
+        ret[ret.size() / 2] ^= 0x01;
+        return ret;
+    }();
+    const std::vector<uint8_t> truncated(data.begin(), data.begin() + data.size() * 3 / 4);
+    for (const auto &bad : {corrupted, truncated}) {
+        {
+            CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+            file.write(reinterpret_cast<const char *>(bad.data()), bad.size());
+        }
+        const auto dst = MakeCoinsDB(0, genesis);
+        BOOST_CHECK_THROW(Load(*dst, path, 3, hash), std::exception);
+        CheckEmpty(*dst, genesis);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_replace_chainstate) {
+    const fs::path path = GetDataDir() / "utxo.dat";
+    const auto src = MakeCoinsDB(500, BlockHash(InsecureRand256()));
+    const uint256 hash = Dump(*src, path, 4, 2).ecmhHash;
+
+    CCoinsViewDB chainstate(1 << 20, false, true, "chainstate_replaced");
+    {
+        CCoinsViewCache cache(&chainstate);
+        cache.AddCoin(COutPoint(TxId(InsecureRand256()), 0), Coin(CTxOut(SATOSHI, CScript() << OP_TRUE), 1, false),
+                      false);
+        cache.SetBestBlock(BlockHash(InsecureRand256()));
+        BOOST_REQUIRE(cache.Flush());
+    }
+    {
+        CCoinsViewDB staging(utxosync::SNAPSHOT_COINS_DB_CACHE, false, true, utxosync::SNAPSHOT_CHAINSTATE_DIR);
+        Load(staging, path, 2, hash);
+    }
+
+    const BlockHash oldBestBlock = chainstate.GetBestBlock();
+    {
+        // Not while a cursor still iterates over the database, which is left as it was
+        const std::unique_ptr<CCoinsViewCursor> cursor(chainstate.Cursor());
+        BOOST_CHECK(!chainstate.ReplaceWith(utxosync::SNAPSHOT_CHAINSTATE_DIR));
+        BOOST_CHECK(chainstate.GetBestBlock() == oldBestBlock);
+    }
+    // Nor if there is nothing to replace it with
+    BOOST_CHECK(!chainstate.ReplaceWith("chainstate_missing"));
+    BOOST_CHECK(chainstate.GetBestBlock() == oldBestBlock);
+
+    BOOST_REQUIRE(chainstate.ReplaceWith(utxosync::SNAPSHOT_CHAINSTATE_DIR));
+    BOOST_CHECK(!fs::exists(GetDataDir() / utxosync::SNAPSHOT_CHAINSTATE_DIR));
+    BOOST_CHECK(!fs::exists(GetDataDir() / "chainstate_replaced.old"));
+    BOOST_CHECK(chainstate.GetBestBlock() == src->GetBestBlock());
+    BOOST_CHECK(GetCoins(chainstate) == GetCoins(*src));
+
+    // In-memory databases have no files to replace
+    const auto mem = MakeCoinsDB(1, BlockHash(InsecureRand256()));
+    BOOST_CHECK(!mem->ReplaceWith(utxosync::SNAPSHOT_CHAINSTATE_DIR));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,7 +16,9 @@
 #include <util/system.h>
 #include <util/vector.h>
 
+#include <cassert>
 #include <cstdint>
+#include <tuple>
 
 static const char DB_COIN = 'C';
 static const char DB_COINS = 'c';
@@ -28,6 +30,7 @@ static const char DB_HEAD_BLOCKS = 'H';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
+static const char DB_SNAPSHOT_BASE = 'S';
 
 namespace {
 
@@ -46,20 +49,61 @@ struct CoinEntry {
 };
 } // namespace
 
-CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe)
-    : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe, true) {}
+CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe,
+                           const std::string &dirName)
+    : m_path(GetDataDir() / dirName), m_cache_size(nCacheSize),
+      m_is_memory(fMemory),
+      db(std::make_unique<CDBWrapper>(m_path, nCacheSize, fMemory, fWipe,
+                                      true)) {}
+
+bool CCoinsViewDB::ReplaceWith(const std::string &dirName) {
+    if (m_is_memory) {
+        return error("%s: an in-memory database cannot be replaced", __func__);
+    }
+    if (m_open_cursors > 0) {
+        return error("%s: the database still has open cursors", __func__);
+    }
+    const fs::path path = GetDataDir() / dirName;
+    const fs::path oldPath = m_path.string() + ".old";
+    bool fSuccess = false;
+    // The database has to be closed before its directory can be moved
+    db.reset();
+    try {
+        // Left over if a previous replacement was interrupted
+        fs::remove_all(oldPath);
+        fs::rename(m_path, oldPath);
+        try {
+            fs::rename(path, m_path);
+            fSuccess = true;
+        } catch (const fs::filesystem_error &e) {
+            error("%s: unable to move %s to %s: %s", __func__, path.string(), m_path.string(), e.what());
+            fs::rename(oldPath, m_path);
+        }
+    } catch (const fs::filesystem_error &e) {
+        error("%s: unable to move %s aside: %s", __func__, m_path.string(), e.what());
+    }
+    db = std::make_unique<CDBWrapper>(m_path, m_cache_size, false, false, true);
+    if (fSuccess) {
+        try {
+            fs::remove_all(oldPath);
+        } catch (const fs::filesystem_error &e) {
+            LogPrintf("%s: unable to remove %s: %s\n", __func__, oldPath.string(), e.what());
+        }
+    }
+    return fSuccess;
+}
 
 bool CCoinsViewDB::GetCoin(const COutPoint &outpoint, Coin &coin) const {
-    return db.Read(CoinEntry(&outpoint), coin);
+    return db->Read(CoinEntry(&outpoint), coin);
 }
 
 bool CCoinsViewDB::HaveCoin(const COutPoint &outpoint) const {
-    return db.Exists(CoinEntry(&outpoint));
+    return db->Exists(CoinEntry(&outpoint));
 }
 
 BlockHash CCoinsViewDB::GetBestBlock() const {
     BlockHash hashBestChain;
-    if (!db.Read(DB_BEST_BLOCK, hashBestChain)) {
+    if (!db->Read(DB_BEST_BLOCK, hashBestChain)) {
         return BlockHash();
     }
     return hashBestChain;
@@ -67,14 +111,14 @@ BlockHash CCoinsViewDB::GetBestBlock() const {
 
 std::vector<BlockHash> CCoinsViewDB::GetHeadBlocks() const {
     std::vector<BlockHash> vhashHeadBlocks;
-    if (!db.Read(DB_HEAD_BLOCKS, vhashHeadBlocks)) {
+    if (!db->Read(DB_HEAD_BLOCKS, vhashHeadBlocks)) {
         return std::vector<BlockHash>();
     }
     return vhashHeadBlocks;
 }
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
-    CDBBatch batch(db);
+    CDBBatch batch(*db);
     size_t count = 0;
     size_t changed = 0;
     size_t batch_size =
@@ -115,7 +159,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
         if (batch.SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n",
                      batch.SizeEstimate() * (1.0 / 1048576.0));
-            db.WriteBatch(batch);
+            db->WriteBatch(batch);
             batch.Clear();
             if (crash_simulate) {
                 static FastRandomContext rng;
@@ -133,7 +177,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
 
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n",
              batch.SizeEstimate() * (1.0 / 1048576.0));
-    bool ret = db.WriteBatch(batch);
+    bool ret = db->WriteBatch(batch);
     LogPrint(BCLog::COINDB,
              "Committed %u changed transaction outputs (out of "
              "%u) to coin database...\n",
@@ -142,7 +186,70 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
 }
 
 size_t CCoinsViewDB::EstimateSize() const {
-    return db.EstimateSize(DB_COIN, char(DB_COIN + 1));
+    return db->EstimateSize(DB_COIN, char(DB_COIN + 1));
+}
+
+bool CCoinsViewDB::BeginBulkLoad(const BlockHash &hashBlock) {
+    assert(!hashBlock.IsNull());
+    if (std::unique_ptr<CCoinsViewCursor> pcursor(Cursor()); pcursor->Valid()) {
+        return error("%s: the coins database is not empty", __func__);
+    }
+
+    // Same as the first batch of BatchWrite(): if the load is interrupted, the
+    // node notices at startup that it cannot replay the blocks up to hashBlock
+    // and asks for -reindex-chainstate.
+    CDBBatch batch(*db);
+    batch.Erase(DB_BEST_BLOCK);
+    batch.Write(DB_HEAD_BLOCKS, Vector(hashBlock, GetBestBlock()));
+    return db->WriteBatch(batch, true);
+}
+
+bool CCoinsViewDB::BulkLoadCoins(const std::vector<std::pair<COutPoint, Coin>> &coins) {
+    CDBBatch batch(*db);
+    const size_t batch_size =
+        (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+    for (const auto &[outpoint, coin] : coins) {
+        batch.Write(CoinEntry(&outpoint), coin);
+        if (batch.SizeEstimate() > batch_size) {
+            if (!db->WriteBatch(batch)) {
+                return false;
+            }
+            batch.Clear();
+        }
+    }
+    return db->WriteBatch(batch);
+}
+
+bool CCoinsViewDB::EndBulkLoad(const BlockHash &hashBlock, bool fSuccess) {
+    const std::vector<BlockHash> old_heads = GetHeadBlocks();
+    if (old_heads.size() != 2 || old_heads[0] != hashBlock) {
+        return error("%s: no bulk load to %s in progress", __func__,
+                     hashBlock.ToString());
+    }
+
+    CDBBatch batch(*db);
+    if (!fSuccess) {
+        // The database was empty before, so erase every coin
+        const size_t batch_size =
+            (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+        std::unique_ptr<CCoinsViewCursor> pcursor(Cursor());
+        for (COutPoint outpoint; pcursor->GetKey(outpoint); pcursor->Next()) {
+            batch.Erase(CoinEntry(&outpoint));
+            if (batch.SizeEstimate() > batch_size) {
+                if (!db->WriteBatch(batch)) {
+                    return false;
+                }
+                batch.Clear();
+            }
+        }
+    }
+
+    const BlockHash &hashBestBlock = fSuccess ? hashBlock : old_heads[1];
+    batch.Erase(DB_HEAD_BLOCKS);
+    if (!hashBestBlock.IsNull()) {
+        batch.Write(DB_BEST_BLOCK, hashBestBlock);
+    }
+    return db->WriteBatch(batch, true);
 }
 
 CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe)
@@ -170,25 +277,35 @@ bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
 
 CCoinsViewCursor *CCoinsViewDB::Cursor(bool snapshot) const {
     CCoinsViewDBCursor *i = new CCoinsViewDBCursor(
-        const_cast<CDBWrapper &>(db).NewIterator(snapshot), GetBestBlock());
-    /**
-     * It seems that there are no "const iterators" for LevelDB. Since we only
-     * need read operations on it, use a const-cast to get around that
-     * restriction.
-     */
+        m_open_cursors, db->NewIterator(snapshot), GetBestBlock());
     i->pcursor->Seek(DB_COIN);
     // Cache key of first record
-    if (i->pcursor->Valid()) {
-        CoinEntry entry(&i->keyTmp.second);
-        i->pcursor->GetKey(entry);
-        i->keyTmp.first = entry.key;
-    } else {
-        // Make sure Valid() and GetKey() return false
-        i->keyTmp.first = 0;
-    }
+    i->CacheKey();
     return i;
 }
 
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsViewDB::CursorShards(size_t nShards) const {
+    assert(nShards > 0 && nShards <= MAX_CURSOR_SHARDS);
+    const auto psnapshot = db->GetSnapshot();
+    const BlockHash hashBestBlock = GetBestBlock();
+
+    std::vector<std::unique_ptr<CCoinsViewCursor>> shards;
+    shards.reserve(nShards);
+    for (size_t n = 0; n < nShards; ++n) {
+        const unsigned begin = n * 256 / nShards;
+        const unsigned end = (n + 1) * 256 / nShards;
+        std::unique_ptr<CCoinsViewDBCursor> i{new CCoinsViewDBCursor(m_open_cursors, db->NewIterator(psnapshot),
+                                                                     hashBestBlock, end)};
+        uint256 firstTxId;
+        firstTxId.data()[0] = begin;
+        const COutPoint first(TxId(firstTxId), 0);
+        i->pcursor->Seek(CoinEntry(&first));
+        i->CacheKey();
+        shards.push_back(std::move(i));
+    }
+    return shards;
+}
+
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const {
     // Return cached key
     if (keyTmp.first == DB_COIN) {
@@ -212,8 +329,13 @@ bool CCoinsViewDBCursor::Valid() const {
 
 void CCoinsViewDBCursor::Next() {
     pcursor->Next();
+    CacheKey();
+}
+
+void CCoinsViewDBCursor::CacheKey() {
     CoinEntry entry(&keyTmp.second);
-    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
+    if (!pcursor->Valid() || !pcursor->GetKey(entry)
+        || (entry.key == DB_COIN && keyTmp.second.GetTxId().data()[0] >= shardEnd)) {
         // Invalidate cached key after last record so that Valid() and GetKey()
         // return false
         keyTmp.first = 0;
@@ -254,6 +376,24 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
+bool CBlockTreeDB::WriteSnapshotBase(const BlockHash &hash,
+                                     const uint256 &ecmh) {
+    return Write(DB_SNAPSHOT_BASE, std::make_pair(hash, ecmh), true);
+}
+
+bool CBlockTreeDB::ReadSnapshotBase(BlockHash &hash, uint256 &ecmh) {
+    std::pair<BlockHash, uint256> snapshotBase;
+    if (!Read(DB_SNAPSHOT_BASE, snapshotBase)) {
+        return false;
+    }
+    std::tie(hash, ecmh) = snapshotBase;
+    return true;
+}
+
+bool CBlockTreeDB::EraseSnapshotBase() {
+    return Erase(DB_SNAPSHOT_BASE, true);
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(
     const Consensus::Params &params,
     std::function<CBlockIndex *(const BlockHash &)> insertBlockIndex) {
@@ -362,7 +502,7 @@ public:
  * Currently implemented: from the per-tx utxo model (0.8..0.14.x) to per-txout.
  */
 bool CCoinsViewDB::Upgrade() {
-    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    std::unique_ptr<CDBIterator> pcursor(db->NewIterator());
     pcursor->Seek(std::make_pair(DB_COINS, uint256()));
     if (!pcursor->Valid()) {
         return true;
@@ -373,7 +513,7 @@ bool CCoinsViewDB::Upgrade() {
     LogPrintfToBeContinued("[0%%]...");
     uiInterface.ShowProgress(_("Upgrading UTXO database"), 0, true);
     size_t batch_size = 1 << 24;
-    CDBBatch batch(db);
+    CDBBatch batch(*db);
     int reportDone = 0;
     std::pair<uint8_t, uint256> key;
     std::pair<uint8_t, uint256> prev_key = {DB_COINS, uint256()};
@@ -418,17 +558,17 @@ bool CCoinsViewDB::Upgrade() {
 
         batch.Erase(key);
         if (batch.SizeEstimate() > batch_size) {
-            db.WriteBatch(batch);
+            db->WriteBatch(batch);
             batch.Clear();
-            db.CompactRange(prev_key, key);
+            db->CompactRange(prev_key, key);
             prev_key = key;
         }
 
         pcursor->Next();
     }
 
-    db.WriteBatch(batch);
-    db.CompactRange({DB_COINS, uint256()}, key);
+    db->WriteBatch(batch);
+    db->CompactRange({DB_COINS, uint256()}, key);
     uiInterface.ShowProgress("", 100, false);
     LogPrintf("[%s].\n", ShutdownRequested() ? "CANCELLED" : "DONE");
     return !ShutdownRequested();
@@ -10,8 +10,10 @@
 #include <coins.h>
 #include <dbwrapper.h>
 #include <flatfile.h>
+#include <fs.h>
 #include <primitives/block.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -43,17 +45,31 @@ static const int64_t nMaxBlockDBCache = 2;
 // a meaningful difference:
 // https://github.com/bitcoin/bitcoin/pull/8273#issuecomment-229601991
 static const int64_t nMaxTxIndexCache = 1024;
+//! Max memory allocated to all block filter index caches combined in MiB.
+static const int64_t max_filter_index_cache = 1024;
+//! Max memory allocated to the address index cache (MiB)
+static const int64_t max_address_index_cache = 1024;
+//! Max memory allocated to the spent index cache (MiB)
+static const int64_t max_spent_index_cache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
 
 /** CCoinsView backed by the coin database (chainstate/) */
 class CCoinsViewDB final : public CCoinsView {
 protected:
-    CDBWrapper db;
+    const fs::path m_path;
+    const size_t m_cache_size;
+    const bool m_is_memory;
+    //! Only null while ReplaceWith() swaps the database files
+    std::unique_ptr<CDBWrapper> db;
+    //! Number of CCoinsViewDBCursor instances that iterate over db
+    mutable std::atomic<int> m_open_cursors{0};
 
 public:
+    //! `dirName` is the directory of the database within the data directory
     explicit CCoinsViewDB(size_t nCacheSize, bool fMemory = false,
-                          bool fWipe = false);
+                          bool fWipe = false,
+                          const std::string &dirName = "chainstate");
 
     bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
@@ -61,17 +77,41 @@ public:
     std::vector<BlockHash> GetHeadBlocks() const override;
     bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override;
     CCoinsViewCursor *Cursor(bool snapshot = false) const override;
+    //! Shards are ranges of the first byte of the txid, which is the leading byte of the database key
+    std::vector<std::unique_ptr<CCoinsViewCursor>> CursorShards(size_t nShards) const override;
 
     //! Attempt to update from an older database format.
     //! Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
+
+    /**
+     * Bulk loading of a UTXO snapshot (see utxosync/snapshot.h) into this database, which must not contain any coins.
+     * BeginBulkLoad() marks the database as being in transition to `hashBlock`, BulkLoadCoins() writes the coins (in
+     * batches which should be sorted by outpoint, so that LevelDB can append them efficiently), and EndBulkLoad()
+     * marks the database as consistent with `hashBlock`. If `fSuccess` is false, EndBulkLoad() erases the coins
+     * loaded so far and goes back to the previous best block instead.
+     */
+    bool BeginBulkLoad(const BlockHash &hashBlock);
+    bool BulkLoadCoins(const std::vector<std::pair<COutPoint, Coin>> &coins);
+    bool EndBulkLoad(const BlockHash &hashBlock, bool fSuccess);
+
+    /**
+     * Replace this database with the one in the directory `dirName` of the data directory, which must not be open,
+     * e.g. a snapshot that was bulk loaded into a database of its own. The directory of this database is moved aside,
+     * the new one is moved in its place, and the old one is only deleted once that worked; otherwise it is put back.
+     *
+     * The database is closed meanwhile, so the caller must make sure that nothing reads from or writes to it, e.g. by
+     * holding cs_main for pcoinsdbview, and must not hold any cursor of it (fails if it does). Not possible for
+     * in-memory databases.
+     */
+    bool ReplaceWith(const std::string &dirName);
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
 class CCoinsViewDBCursor : public CCoinsViewCursor {
 public:
-    ~CCoinsViewDBCursor() {}
+    ~CCoinsViewDBCursor() { --openCursors; }
 
     bool GetKey(COutPoint &key) const override;
     bool GetValue(Coin &coin) const override;
@@ -81,10 +121,20 @@ public:
     void Next() override;
 
 private:
-    CCoinsViewDBCursor(CDBIterator *pcursorIn, const BlockHash &hashBlockIn)
-        : CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
+    CCoinsViewDBCursor(std::atomic<int> &openCursorsIn, CDBIterator *pcursorIn, const BlockHash &hashBlockIn,
+                       unsigned shardEndIn = 256)
+        : CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn), shardEnd(shardEndIn), openCursors(openCursorsIn) {
+        ++openCursors;
+    }
+    //! Caches the key of the record that pcursor points at
+    void CacheKey();
+
     std::unique_ptr<CDBIterator> pcursor;
     std::pair<char, COutPoint> keyTmp;
+    //! The iteration ends before the first txid whose first byte is at least this (256: at the end of the coins)
+    const unsigned shardEnd;
+    //! CCoinsViewDB::m_open_cursors
+    std::atomic<int> &openCursors;
 
     friend class CCoinsViewDB;
 };
@@ -104,6 +154,11 @@ public:
     bool IsReindexing() const;
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
+    //! The base block of the UTXO snapshot that the chainstate was loaded from, if any, and the ECMH of its coins.
+    //! It is erased once the history below the base has been validated.
+    bool WriteSnapshotBase(const BlockHash &hash, const uint256 &ecmh);
+    bool ReadSnapshotBase(BlockHash &hash, uint256 &ecmh);
+    bool EraseSnapshotBase();
     bool LoadBlockIndexGuts(
         const Consensus::Params &params,
         std::function<CBlockIndex *(const BlockHash &)> insertBlockIndex);
@@ -84,7 +84,9 @@ void CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntr
         // If we're not searching for parents, we require this to be an entry in
         // the mempool already.
         txiter it = mapTx.iterator_to(entry);
-        parentHashes = GetMemPoolParents(it);
+        for (txiter piter : GetMemPoolParents(it)) {
+            parentHashes.insert(piter);
+        }
     }
 
     while (!parentHashes.empty()) {
@@ -93,8 +95,7 @@ void CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntr
         setAncestors.insert(stageit);
         parentHashes.erase(parentHashes.begin());
 
-        const setEntries &setMemPoolParents = GetMemPoolParents(stageit);
-        for (txiter phash : setMemPoolParents) {
+        for (txiter phash : GetMemPoolParents(stageit)) {
             // If this is a new ancestor, add it.
             if (!algo::contains(setAncestors, phash)) {
                 parentHashes.insert(phash);
@@ -110,24 +111,24 @@ void CTxMemPool::UpdateParentsOf(bool add, txiter it) {
     }
 }
 
-void CTxMemPool::UpdateChildrenForRemoval(txiter it) {
-    const setEntries &setMemPoolChildren = GetMemPoolChildren(it);
-    for (txiter updateIt : setMemPoolChildren) {
-        UpdateParent(updateIt, it, false);
-    }
-}
-
 void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove) {
+    // Every link list that points to removed entries is filtered once, rather
+    // than erasing the links one at a time, which would be quadratic for an
+    // entry that loses many of its children (or parents) at once.
+    setEntries parents, children;
     for (txiter removeIt : entriesToRemove) {
-        // Note that UpdateParentsOf severs the child links that point to
-        // removeIt in the mapLinks entries for the parents of removeIt.
-        UpdateParentsOf(false, removeIt);
+        for (txiter piter : GetMemPoolParents(removeIt)) {
+            parents.insert(piter);
+        }
+        for (txiter citer : GetMemPoolChildren(removeIt)) {
+            children.insert(citer);
+        }
     }
-    // After updating all the parent links, we can now sever the link between
-    // each transaction being removed and any mempool children (ie, update
-    // setMemPoolParents for each direct child of a transaction being removed).
-    for (txiter removeIt : entriesToRemove) {
-        UpdateChildrenForRemoval(removeIt);
+    for (txiter piter : parents) {
+        RemoveLinksTo(piter, piter->children, entriesToRemove);
+    }
+    for (txiter citer : children) {
+        RemoveLinksTo(citer, citer->parents, entriesToRemove);
     }
 }
 
@@ -162,6 +163,8 @@ void CTxMemPool::AddTransactionsUpdated(unsigned int n) {
 }
 
 uint64_t CTxMemPool::addUnchecked(CTxMemPoolEntry &&entry) {
+    SnapshotBatch batch(*this);
+
     // get a guaranteed unique id (in case tests re-use the same object)
     entry.SetEntryId(nextEntryId++);
 
@@ -172,6 +175,11 @@ uint64_t CTxMemPool::addUnchecked(CTxMemPoolEntry &&entry) {
         entry.UpdateFeeDelta(feeDelta);
     }
 
+    // Start out without links; an entry copied from another pool would still
+    // refer to the entries there.
+    entry.parents = CTxMemPoolEntry::Links();
+    entry.children = CTxMemPoolEntry::Links();
+
     NotifyEntryAdded(entry.GetSharedTx());
 
     // Add to memory pool without checking anything.
@@ -182,13 +190,15 @@ uint64_t CTxMemPool::addUnchecked(CTxMemPoolEntry &&entry) {
     // Sanity check: We should always end up inserting at the end of the entry_id index
     assert(&*mapTx.get<entry_id>().rbegin() == &*newit);
 
-    mapLinks.try_emplace(newit);
-
     // Update cachedInnerUsage to include contained transaction's usage.
     // (When we update the entry for in-mempool parents, memory usage will be
     // further updated.)
     cachedInnerUsage += entry.DynamicMemoryUsage();
 
+    newit->vTxHashesIdx = vTxHashes.size();
+    vTxHashes.push_back(newit->GetTx().GetHash());
+    vTxHashesEntries.push_back(newit);
+
     const CTransaction &tx = newit->GetTx();
     std::set<TxId> setParentTransactions;
     for (const CTxIn &in : tx.vin) {
@@ -204,12 +214,34 @@ uint64_t CTxMemPool::addUnchecked(CTxMemPoolEntry &&entry) {
         UpdateParent(newit, pit, true);
     }
     UpdateParentsOf(true, newit);
+    MarkSnapshotDirty(tx.GetId());
 
     nTransactionsUpdated++;
     totalTxSize += entry.GetTxSize();
     return newit->GetEntryId();
 }
 
+/**
+ * Give back the memory of a vector that is at most half full, but keep room to
+ * grow by half again. Shrinking to fit would make a mempool that hovers around
+ * the same size reallocate on every other addition and removal. An empty
+ * vector gives back all of it.
+ */
+template <typename T> static void ShrinkWithHysteresis(std::vector<T> &v) {
+    static constexpr size_t MIN_CAPACITY = 64;
+    if (v.empty()) {
+        std::vector<T>().swap(v);
+        return;
+    }
+    if (v.capacity() <= MIN_CAPACITY || v.capacity() < 2 * v.size()) {
+        return;
+    }
+    std::vector<T> shrunk;
+    shrunk.reserve(std::max(v.size() + v.size() / 2, MIN_CAPACITY));
+    shrunk.assign(v.begin(), v.end());
+    v.swap(shrunk);
+}
+
 void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
     NotifyEntryRemoved(it->GetSharedTx(), reason);
     if (it->HasDsp()) {
@@ -221,13 +253,21 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
         mapNextTx.erase(txin.prevout);
     }
 
+    // Move the last transaction hash into the place of the removed one
+    if (const size_t idx = it->vTxHashesIdx; idx != vTxHashes.size() - 1) {
+        vTxHashes[idx] = vTxHashes.back();
+        vTxHashesEntries[idx] = vTxHashesEntries.back();
+        vTxHashesEntries[idx]->vTxHashesIdx = idx;
+    }
+    vTxHashes.pop_back();
+    vTxHashesEntries.pop_back();
+    ShrinkWithHysteresis(vTxHashes);
+    ShrinkWithHysteresis(vTxHashesEntries);
+
     totalTxSize -= it->GetTxSize();
     cachedInnerUsage -= it->DynamicMemoryUsage();
-    if (const auto linksiter = mapLinks.find(it); linksiter != mapLinks.end()) {
-        cachedInnerUsage -= memusage::DynamicUsage(linksiter->second.parents) +
-                            memusage::DynamicUsage(linksiter->second.children);
-        mapLinks.erase(linksiter);
-    }
+    cachedInnerUsage -= memusage::DynamicUsage(it->parents) + memusage::DynamicUsage(it->children);
+    MarkSnapshotDirty(it->GetTx().GetId());
     mapTx.erase(it);
     nTransactionsUpdated++;
 }
@@ -252,8 +292,7 @@ void CTxMemPool::CalculateDescendants(txiter entryit,
         setDescendants.insert(it);
         stage.erase(stage.begin());
 
-        const setEntries &setChildren = GetMemPoolChildren(it);
-        for (txiter childiter : setChildren) {
+        for (txiter childiter : GetMemPoolChildren(it)) {
             if (!algo::contains(setDescendants, childiter)) {
                 stage.insert(childiter);
             }
@@ -265,6 +304,7 @@ void CTxMemPool::removeRecursive(const CTransaction &origTx,
                                  MemPoolRemovalReason reason) {
     // Remove transaction from memory pool.
     LOCK(cs);
+    SnapshotBatch batch(*this);
     setEntries txToRemove;
     txiter origit = mapTx.find(origTx.GetId());
     if (origit != mapTx.end()) {
@@ -294,6 +334,7 @@ void CTxMemPool::removeRecursive(const CTransaction &origTx,
 void CTxMemPool::removeConflicts(const CTransaction &tx) {
     // Remove transactions which depend on inputs of tx, recursively
     AssertLockHeld(cs);
+    SnapshotBatch batch(*this);
     for (const CTxIn &txin : tx.vin) {
         auto it = mapNextTx.find(txin.prevout);
         if (it != mapNextTx.end()) {
@@ -312,6 +353,7 @@ void CTxMemPool::removeConflicts(const CTransaction &tx) {
  */
 void CTxMemPool::removeForBlock(const std::vector<CTransactionRef> &vtx) {
     LOCK(cs);
+    SnapshotBatch batch(*this);
 
     if (mapTx.empty() && mapDeltas.empty()) {
         // fast-path for IBD and/or when mempool is empty; there is no need to
@@ -346,8 +388,9 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef> &vtx) {
 }
 
 void CTxMemPool::_clear(bool clearDspOrphans /*= true*/) {
-    mapLinks.clear();
     mapTx.clear();
+    vTxHashes.clear();
+    vTxHashesEntries.clear();
     mapNextTx.clear();
     totalTxSize = 0;
     cachedInnerUsage = 0;
@@ -355,11 +398,13 @@ void CTxMemPool::_clear(bool clearDspOrphans /*= true*/) {
     blockSinceLastRollingFeeBump = false;
     rollingMinimumFeeRate = 0;
     m_dspStorage->clear(clearDspOrphans);
+    MarkSnapshotAllDirty();
     ++nTransactionsUpdated;
 }
 
 void CTxMemPool::clear(bool clearDspOrphans /*= true*/) {
     LOCK(cs);
+    SnapshotBatch batch(*this);
     _clear(clearDspOrphans);
 }
 
@@ -396,15 +441,16 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const {
     const int64_t spendheight = GetSpendHeight(mempoolDuplicate);
 
     std::list<const CTxMemPoolEntry *> waitingOnDependants;
+    assert(vTxHashes.size() == mapTx.size());
+    assert(vTxHashesEntries.size() == mapTx.size());
     for (txiter it = mapTx.begin(); it != mapTx.end(); ++it) {
         checkTotal += it->GetTxSize();
+        assert(vTxHashesEntries.at(it->vTxHashesIdx) == it);
+        assert(vTxHashes[it->vTxHashesIdx] == it->GetTx().GetHash());
         innerUsage += it->DynamicMemoryUsage();
         const CTransaction &tx = it->GetTx();
-        auto linksiter = mapLinks.find(it);
-        assert(linksiter != mapLinks.end());
-        const TxLinks &links = linksiter->second;
-        innerUsage += memusage::DynamicUsage(links.parents) +
-                      memusage::DynamicUsage(links.children);
+        innerUsage += memusage::DynamicUsage(it->parents) +
+                      memusage::DynamicUsage(it->children);
         bool fDependsWait = false;
         setEntries setParentCheck;
         for (const CTxIn &txin : tx.vin) {
@@ -428,7 +474,8 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const {
             assert(it3->first == &txin.prevout);
             assert(it3->second == &tx);
         }
-        assert(setParentCheck == GetMemPoolParents(it));
+        const auto parents = GetMemPoolParents(it);
+        assert(std::equal(setParentCheck.begin(), setParentCheck.end(), parents.begin(), parents.end()));
         // Verify ancestor state is correct.
         setEntries setAncestors;
         CalculateMemPoolAncestors(*it, setAncestors);
@@ -447,7 +494,8 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const {
             assert(childit != mapTx.end());
             setChildrenCheck.insert(childit);
         }
-        assert(setChildrenCheck == GetMemPoolChildren(it));
+        const auto children = GetMemPoolChildren(it);
+        assert(std::equal(setChildrenCheck.begin(), setChildrenCheck.end(), children.begin(), children.end()));
 
         if (fDependsWait) {
             waitingOnDependants.push_back(&(*it));
@@ -552,11 +600,13 @@ void CTxMemPool::PrioritiseTransaction(const TxId &txid,
                                        const Amount nFeeDelta) {
     {
         LOCK(cs);
+        SnapshotBatch batch(*this);
         Amount &delta = mapDeltas[txid];
         delta += nFeeDelta;
         txiter it = mapTx.find(txid);
         if (it != mapTx.end()) {
             mapTx.modify(it, update_fee_delta(delta));
+            MarkSnapshotDirty(txid);
             ++nTransactionsUpdated;
         }
     }
@@ -643,12 +693,14 @@ size_t CTxMemPool::DynamicMemoryUsage() const {
                mapTx.size() +
            memusage::DynamicUsage(mapNextTx) +
            memusage::DynamicUsage(mapDeltas) +
-           memusage::DynamicUsage(mapLinks) +
+           memusage::DynamicUsage(vTxHashes) +
+           memusage::DynamicUsage(vTxHashesEntries) +
            cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveStaged(const setEntries &stage, MemPoolRemovalReason reason) {
     AssertLockHeld(cs);
+    SnapshotBatch batch(*this);
     UpdateForRemoveFromMempool(stage);
     for (txiter it : stage) {
         removeUnchecked(it, reason);
@@ -657,6 +709,7 @@ void CTxMemPool::RemoveStaged(const setEntries &stage, MemPoolRemovalReason reas
 
 size_t CTxMemPool::Expire(int64_t time, bool fast /* = true */) {
     LOCK(cs);
+    SnapshotBatch batch(*this);
 
     setEntries stage;
     auto const& index = mapTx.get<entry_id>();
@@ -673,6 +726,8 @@ size_t CTxMemPool::Expire(int64_t time, bool fast /* = true */) {
 }
 
 void CTxMemPool::LimitSize(size_t limit, unsigned long age) {
+    LOCK(cs);
+    SnapshotBatch batch(*this);
     auto expired = Expire(GetTime() - age, /* fast */ true);
     if (expired != 0) {
         LogPrint(BCLog::MEMPOOL, "Expired %i transactions from the memory pool\n", expired);
@@ -685,40 +740,260 @@ void CTxMemPool::LimitSize(size_t limit, unsigned long age) {
     }
 }
 
-// NB: The pointer type is only used for template overload selection and never dereferenced so this is safe.
-inline constexpr size_t setEntriesIncrementalUsage =
-        memusage::IncrementalDynamicUsage(static_cast<CTxMemPool::setEntries *>(nullptr));
+//! Insert `entry` into `links`, keeping them sorted by entry id. @returns false if it was already there.
+static bool AddLink(CTxMemPoolEntry::Links &links, const CTxMemPoolEntry &entry) {
+    const uint64_t entryId = entry.GetEntryId();
+    // New links almost always go to the end, as the entry ids of the mempool
+    // only ever increase.
+    if (links.empty() || links.back()->GetEntryId() < entryId) {
+        links.push_back(&entry);
+        return true;
+    }
+    const auto it = std::lower_bound(links.begin(), links.end(), entryId,
+                                     [](const CTxMemPoolEntry *e, uint64_t id) { return e->GetEntryId() < id; });
+    if (*it == &entry) {
+        return false;
+    }
+    links.insert(it, &entry);
+    return true;
+}
+
+//! Remove `entry` from `links`. @returns false if it wasn't there.
+static bool RemoveLink(CTxMemPoolEntry::Links &links, const CTxMemPoolEntry &entry) {
+    const auto it = std::lower_bound(links.begin(), links.end(), entry.GetEntryId(),
+                                     [](const CTxMemPoolEntry *e, uint64_t id) { return e->GetEntryId() < id; });
+    if (it == links.end() || *it != &entry) {
+        return false;
+    }
+    links.erase(it);
+    return true;
+}
 
 void CTxMemPool::UpdateChild(txiter entry, txiter child, bool add) {
-    if (add && mapLinks[entry].children.insert(child).second) {
-        cachedInnerUsage += setEntriesIncrementalUsage;
-    } else if (!add && mapLinks[entry].children.erase(child)) {
-        cachedInnerUsage -= setEntriesIncrementalUsage;
+    CTxMemPoolEntry::Links &children = entry->children;
+    const size_t usageBefore = memusage::DynamicUsage(children);
+    if (add ? AddLink(children, *child) : RemoveLink(children, *child)) {
+        cachedInnerUsage = cachedInnerUsage - usageBefore + memusage::DynamicUsage(children);
+        MarkSnapshotDirty(entry->GetTx().GetId());
+    }
+}
+
+void CTxMemPool::RemoveLinksTo(txiter entry, CTxMemPoolEntry::Links &links, const setEntries &removed) {
+    const size_t usageBefore = memusage::DynamicUsage(links);
+    const auto end = std::remove_if(links.begin(), links.end(), [&](const CTxMemPoolEntry *link) {
+        return removed.count(mapTx.iterator_to(*link));
+    });
+    if (end != links.end()) {
+        links.erase(end, links.end());
+        cachedInnerUsage = cachedInnerUsage - usageBefore + memusage::DynamicUsage(links);
+        MarkSnapshotDirty(entry->GetTx().GetId());
     }
 }
 
 void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add) {
-    if (add && mapLinks[entry].parents.insert(parent).second) {
-        cachedInnerUsage += setEntriesIncrementalUsage;
-    } else if (!add && mapLinks[entry].parents.erase(parent)) {
-        cachedInnerUsage -= setEntriesIncrementalUsage;
+    CTxMemPoolEntry::Links &parents = entry->parents;
+    const size_t usageBefore = memusage::DynamicUsage(parents);
+    if (add ? AddLink(parents, *parent) : RemoveLink(parents, *parent)) {
+        cachedInnerUsage = cachedInnerUsage - usageBefore + memusage::DynamicUsage(parents);
+        MarkSnapshotDirty(entry->GetTx().GetId());
+    }
+}
+
+void CTxMemPool::MarkSnapshotDirty(const TxId &txid) {
+    if (!m_snapshotInUse) {
+        return;
+    }
+    // Changes outside of a batch would not be published until the next one
+    assert(m_snapshotBatchDepth > 0);
+    ++m_snapshotMutations;
+    if (m_snapshotAllDirty) {
+        return;
+    }
+    if (m_snapshotDirty.size() >= std::max<size_t>(mapTx.size(), 1024)) {
+        // Rebuilding everything is about as cheap by now, and this bounds the
+        // memory used for tracking the changes of a large batch.
+        MarkSnapshotAllDirty();
+        return;
+    }
+    m_snapshotDirty.insert(txid);
+}
+
+void CTxMemPool::MarkSnapshotAllDirty() {
+    ++m_snapshotMutations;
+    m_snapshotAllDirty = true;
+    m_snapshotDirty.clear();
+}
+
+CTxMemPool::SnapshotBatch::SnapshotBatch(CTxMemPool &poolIn) : pool(poolIn) {
+    AssertLockHeld(pool.cs);
+    ++pool.m_snapshotBatchDepth;
+}
+
+CTxMemPool::SnapshotBatch::~SnapshotBatch() {
+    AssertLockHeld(pool.cs);
+    if (--pool.m_snapshotBatchDepth == 0 && pool.m_snapshotInUse) {
+        pool.PublishSnapshot();
     }
 }
 
-const CTxMemPool::setEntries &
+std::shared_ptr<const CTxMemPoolSnapshot> CTxMemPool::GetSnapshot() const {
+    if (auto snapshot = std::atomic_load(&m_snapshot)) {
+        return snapshot;
+    }
+    LOCK(cs);
+    if (!m_snapshotInUse) {
+        m_snapshotInUse = true;
+        PublishSnapshot();
+    }
+    return std::atomic_load(&m_snapshot);
+}
+
+void CTxMemPool::PublishSnapshot() const {
+    AssertLockHeld(cs);
+    const auto prev = std::atomic_load(&m_snapshot);
+    if (prev && prev->GetVersion() == m_snapshotMutations) {
+        return;
+    }
+
+    using Shard = CTxMemPoolSnapshot::Shard;
+    constexpr size_t NUM_SHARDS = CTxMemPoolSnapshot::NUM_SHARDS;
+    const auto compareTxId = [](const std::shared_ptr<const CTxMemPoolSnapshot::Entry> &a,
+                                const std::shared_ptr<const CTxMemPoolSnapshot::Entry> &b) {
+        return a->txid < b->txid;
+    };
+
+    const auto makeEntry = [this](txiter it) EXCLUSIVE_LOCKS_REQUIRED(cs) {
+        auto entry = std::make_shared<CTxMemPoolSnapshot::Entry>();
+        entry->txid = it->GetTx().GetId();
+        entry->entryId = it->GetEntryId();
+        entry->fee = it->GetFee();
+        entry->modifiedFee = it->GetModifiedFee();
+        entry->size = it->GetTxSize();
+        entry->time = it->GetTime();
+        entry->depends.reserve(it->parents.size());
+        for (const CTxMemPoolEntry *parent : it->parents) {
+            entry->depends.push_back(parent->GetTx().GetId());
+        }
+        entry->spentBy.reserve(it->children.size());
+        for (const CTxMemPoolEntry *child : it->children) {
+            entry->spentBy.push_back(child->GetTx().GetId());
+        }
+        return std::shared_ptr<const CTxMemPoolSnapshot::Entry>(std::move(entry));
+    };
+
+    auto snapshot = std::make_shared<CTxMemPoolSnapshot>();
+    snapshot->nVersion = m_snapshotMutations;
+    snapshot->nSize = mapTx.size();
+
+    if (!prev || m_snapshotAllDirty) {
+        std::array<Shard, NUM_SHARDS> shards;
+        for (txiter it = mapTx.begin(); it != mapTx.end(); ++it) {
+            shards[CTxMemPoolSnapshot::GetShardIndex(it->GetTx().GetId())].push_back(makeEntry(it));
+        }
+        for (size_t i = 0; i < NUM_SHARDS; ++i) {
+            std::sort(shards[i].begin(), shards[i].end(), compareTxId);
+            snapshot->shards[i] = std::make_shared<const Shard>(std::move(shards[i]));
+        }
+    } else {
+        // Share all clean shards with the previous snapshot, and rebuild only
+        // the ones that contain a txid that was added, removed or modified.
+        snapshot->shards = prev->shards;
+        std::array<std::vector<TxId>, NUM_SHARDS> dirtyByShard;
+        for (const TxId &txid : m_snapshotDirty) {
+            dirtyByShard[CTxMemPoolSnapshot::GetShardIndex(txid)].push_back(txid);
+        }
+        for (size_t i = 0; i < NUM_SHARDS; ++i) {
+            std::vector<TxId> &dirty = dirtyByShard[i];
+            if (dirty.empty()) {
+                continue;
+            }
+            std::sort(dirty.begin(), dirty.end());
+            const Shard &oldShard = *prev->shards[i];
+            Shard shard;
+            shard.reserve(oldShard.size() + dirty.size());
+            for (const auto &entry : oldShard) {
+                if (!std::binary_search(dirty.begin(), dirty.end(), entry->txid)) {
+                    // Unchanged entries are shared with the previous snapshot
+                    shard.push_back(entry);
+                }
+            }
+            for (const TxId &txid : dirty) {
+                if (auto it = mapTx.find(txid); it != mapTx.end()) {
+                    shard.push_back(makeEntry(it));
+                }
+            }
+            std::sort(shard.begin(), shard.end(), compareTxId);
+            snapshot->shards[i] = std::make_shared<const Shard>(std::move(shard));
+        }
+    }
+    m_snapshotDirty.clear();
+    m_snapshotAllDirty = false;
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const CTxMemPoolSnapshot>(std::move(snapshot)));
+}
+
+const CTxMemPoolSnapshot::Entry *CTxMemPoolSnapshot::Find(const TxId &txid) const {
+    const Shard &shard = *shards[GetShardIndex(txid)];
+    auto it = std::lower_bound(shard.begin(), shard.end(), txid,
+                               [](const std::shared_ptr<const Entry> &entry, const TxId &id) { return entry->txid < id; });
+    if (it == shard.end() || (*it)->txid != txid) {
+        return nullptr;
+    }
+    return it->get();
+}
+
+std::vector<const CTxMemPoolSnapshot::Entry *> CTxMemPoolSnapshot::GetEntriesByEntryId() const {
+    std::vector<const Entry *> ret;
+    ret.reserve(nSize);
+    for (const auto &shard : shards) {
+        for (const auto &entry : *shard) {
+            ret.push_back(entry.get());
+        }
+    }
+    std::sort(ret.begin(), ret.end(), [](const Entry *a, const Entry *b) { return a->entryId < b->entryId; });
+    return ret;
+}
+
+std::vector<const CTxMemPoolSnapshot::Entry *>
+CTxMemPoolSnapshot::Walk(const Entry &start, std::vector<TxId> Entry::*links) const {
+    std::vector<const Entry *> ret;
+    std::set<TxId> seen{start.txid};
+    std::vector<const Entry *> todo{&start};
+    while (!todo.empty()) {
+        const Entry *entry = todo.back();
+        todo.pop_back();
+        for (const TxId &txid : entry->*links) {
+            if (!seen.insert(txid).second) {
+                continue;
+            }
+            if (const Entry *linked = Find(txid)) {
+                ret.push_back(linked);
+                todo.push_back(linked);
+            }
+        }
+    }
+    std::sort(ret.begin(), ret.end(), [](const Entry *a, const Entry *b) { return a->entryId < b->entryId; });
+    return ret;
+}
+
+std::vector<const CTxMemPoolSnapshot::Entry *> CTxMemPoolSnapshot::GetAncestors(const Entry &entry) const {
+    return Walk(entry, &Entry::depends);
+}
+
+std::vector<const CTxMemPoolSnapshot::Entry *> CTxMemPoolSnapshot::GetDescendants(const Entry &entry) const {
+    return Walk(entry, &Entry::spentBy);
+}
+
+CTxMemPool::LinkedEntries
 CTxMemPool::GetMemPoolParents(txiter entry) const {
     assert(entry != mapTx.end());
-    auto it = mapLinks.find(entry);
-    assert(it != mapLinks.end());
-    return it->second.parents;
+    return {mapTx, entry->parents};
 }
 
-const CTxMemPool::setEntries &
+CTxMemPool::LinkedEntries
 CTxMemPool::GetMemPoolChildren(txiter entry) const {
     assert(entry != mapTx.end());
-    auto it = mapLinks.find(entry);
-    assert(it != mapLinks.end());
-    return it->second.children;
+    return {mapTx, entry->children};
 }
 
 CTransactionRef CTxMemPool::addDoubleSpendProof(const DoubleSpendProof &proof, const std::optional<txiter> &optIter) {
@@ -1016,6 +1291,7 @@ void CTxMemPool::trackPackageRemoved(const CFeeRate &rate) {
 void CTxMemPool::TrimToSize(size_t sizelimit,
                             std::vector<COutPoint> *pvNoSpendsRemaining) {
     LOCK(cs);
+    SnapshotBatch batch(*this);
 
     unsigned nTxnRemoved = 0;
     CFeeRate maxFeeRateRemoved(Amount::zero());
@@ -1271,30 +1547,29 @@ void DisconnectedBlockTransactions::updateMempoolForReorg(const Config &config,
         // Iterate disconnectpool in reverse, so that we add transactions back to
         // the mempool starting with the earliest transaction that had been
         // previously seen in a block.
+        std::vector<MempoolAcceptBatchEntry> entries;
+        entries.reserve(queuedTx.size());
         for (const CTransactionRef &tx : reverse_iterate(queuedTx.get<insertion_order>())) {
             if (tx->IsCoinBase())
                 continue;
             // restore saved PrioritiseTransaction state and nAcceptTime
             const auto ptxInfo = getTxInfo(tx);
-            bool hasFeeDelta = false;
             if (ptxInfo && ptxInfo->feeDelta != Amount::zero()) {
                 // manipulate mapDeltas directly (faster than calling PrioritiseTransaction)
                 LOCK(g_mempool.cs);
                 g_mempool.mapDeltas[tx->GetId()] = ptxInfo->feeDelta;
-                hasFeeDelta = true;
             }
-            // ignore validation errors in resurrected transactions
-            CValidationState stateDummy;
-            bool ok = AcceptToMemoryPoolWithTime(config, g_mempool, stateDummy, tx,
-                                                 nullptr /* pfMissingInputs */,
-                                                 ptxInfo ? ptxInfo->time : GetTime() /* nAcceptTime */,
-                                                 true /* bypass_limits */,
-                                                 Amount::zero() /* nAbsurdFee */,
-                                                 false /* test_accept */);
-            if (!ok && hasFeeDelta) {
+            entries.emplace_back(tx, ptxInfo ? ptxInfo->time : GetTime() /* nAcceptTime */);
+        }
+        // ignore validation errors in resurrected transactions
+        AcceptToMemoryPoolBatch(config, g_mempool, entries, true /* bypass_limits */,
+                                Amount::zero() /* nAbsurdFee */);
+        for (const MempoolAcceptBatchEntry &entry : entries) {
+            if (const auto ptxInfo = getTxInfo(entry.tx);
+                    !entry.fAccepted && ptxInfo && ptxInfo->feeDelta != Amount::zero()) {
                 // tx not accepted: undo mapDelta insertion from above
                 LOCK(g_mempool.cs);
-                g_mempool.mapDeltas.erase(tx->GetId());
+                g_mempool.mapDeltas.erase(entry.tx->GetId());
             }
         }
     }
@@ -11,6 +11,7 @@
 #include <core_memusage.h>
 #include <dsproof/dspid.h>
 #include <indirectmap.h>
+#include <prevector.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <span.h>
@@ -23,12 +24,17 @@
 #include <boost/multi_index_container.hpp>
 #include <boost/signals2/signal.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
 #include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -74,6 +80,15 @@ class CTxMemPool;
  */
 
 class CTxMemPoolEntry {
+public:
+    /**
+     * The in-mempool parents or children of an entry, sorted by entry id. Most
+     * transactions have at most two of either, which fit without a heap
+     * allocation. Maintained by CTxMemPool, see CTxMemPool::GetMemPoolParents().
+     */
+    using Links = prevector<2, const CTxMemPoolEntry *>;
+
+private:
     //! Unique identifier -- used for topological sorting
     uint64_t entryId = 0;
 
@@ -102,6 +117,15 @@ class CTxMemPoolEntry {
     //! class copy constructible.
     DspIdPtr dspIdPtr;
 
+    //! Mutable because mapTx only hands out const entries; only ever modified
+    //! by CTxMemPool (with its cs held) once the entry is in mapTx.
+    mutable Links parents;
+    mutable Links children;
+    //! Position of this entry in CTxMemPool::vTxHashes
+    mutable size_t vTxHashesIdx = 0;
+
+    friend class CTxMemPool;
+
 public:
     CTxMemPoolEntry(const CTransactionRef &_tx, const Amount _nFee,
                     int64_t _nTime,
@@ -223,6 +247,67 @@ struct TxMempoolInfo {
     uint64_t entryId{};
 };
 
+/**
+ * An immutable, versioned copy of the parts of the mempool that RPC and REST
+ * readers are interested in (see CTxMemPool::GetSnapshot).
+ *
+ * Entries are spread over a fixed number of shards by txid. When the mempool
+ * publishes a new snapshot, only the shards that saw changes since the
+ * previous one are rebuilt; all others are shared with the previous snapshot.
+ * A rebuilt shard still shares its unchanged entries with the previous one,
+ * so that publishing costs a pointer copy per entry of a dirty shard rather
+ * than a copy of the entry and its link vectors.
+ * Readers hold on to a snapshot via shared_ptr, so an old snapshot (and any
+ * shard only it references) is freed once its last reader is done with it.
+ */
+class CTxMemPoolSnapshot {
+public:
+    struct Entry {
+        TxId txid;
+        uint64_t entryId{};
+        Amount fee;
+        Amount modifiedFee;
+        size_t size{};
+        int64_t time{};
+        //! In-mempool parents, in no particular order
+        std::vector<TxId> depends;
+        //! In-mempool children, ordered by entry id
+        std::vector<TxId> spentBy;
+    };
+
+    static constexpr size_t NUM_SHARDS = 256;
+    //! A shard is kept sorted by txid
+    using Shard = std::vector<std::shared_ptr<const Entry>>;
+
+    //! The mutation count of the mempool this snapshot was taken at
+    uint64_t GetVersion() const { return nVersion; }
+    size_t size() const { return nSize; }
+    bool empty() const { return nSize == 0; }
+
+    //! @returns nullptr if `txid` was not in the mempool
+    const Entry *Find(const TxId &txid) const;
+
+    //! @returns all entries, in mempool acceptance order (entry id)
+    std::vector<const Entry *> GetEntriesByEntryId() const;
+
+    //! @returns all in-mempool ancestors of `entry` (excluding itself), in acceptance order
+    std::vector<const Entry *> GetAncestors(const Entry &entry) const;
+
+    //! @returns all in-mempool descendants of `entry` (excluding itself), in acceptance order
+    std::vector<const Entry *> GetDescendants(const Entry &entry) const;
+
+    static size_t GetShardIndex(const TxId &txid) { return txid.GetUint64(0) % NUM_SHARDS; }
+
+private:
+    friend class CTxMemPool;
+
+    uint64_t nVersion{};
+    size_t nSize{};
+    std::array<std::shared_ptr<const Shard>, NUM_SHARDS> shards;
+
+    std::vector<const Entry *> Walk(const Entry &entry, std::vector<TxId> Entry::*links) const;
+};
+
 /**
  * Reason why a transaction was removed from the mempool, this is passed to the
  * notification signal.
@@ -380,6 +465,15 @@ public:
 
     using txiter = indexed_transaction_set::nth_index<0>::type::const_iterator;
 
+    /**
+     * The hashes of all transactions in mapTx, in no particular order, with
+     * their entries at the same positions in vTxHashesEntries. Kept as
+     * contiguous arrays so that compact block reconstruction can compute the
+     * short ids of the whole mempool without visiting every entry.
+     */
+    std::vector<TxHash> vTxHashes GUARDED_BY(cs);
+    std::vector<txiter> vTxHashesEntries GUARDED_BY(cs);
+
     struct CompareIteratorByEntryId {
         bool operator()(const txiter &a, const txiter &b) const {
             return a->GetEntryId() < b->GetEntryId();
@@ -387,9 +481,49 @@ public:
     };
     using setEntries = std::set<txiter, CompareIteratorByEntryId>;
 
-    const setEntries &GetMemPoolParents(txiter entry) const
+    /**
+     * A view of the in-mempool parents or children of an entry, iterating as
+     * txiters in entry id order (like a setEntries would). It is invalidated
+     * by any change to the mempool.
+     */
+    class LinkedEntries {
+        const indexed_transaction_set *pmapTx;
+        const CTxMemPoolEntry::Links *plinks;
+
+    public:
+        class const_iterator {
+            const indexed_transaction_set *pmapTx;
+            CTxMemPoolEntry::Links::const_iterator it;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = txiter;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const txiter *;
+            using reference = txiter;
+
+            const_iterator(const indexed_transaction_set &mapTxIn, CTxMemPoolEntry::Links::const_iterator itIn)
+                : pmapTx(&mapTxIn), it(itIn) {}
+
+            txiter operator*() const { return pmapTx->iterator_to(**it); }
+            const_iterator &operator++() { ++it; return *this; }
+            const_iterator operator++(int) { const_iterator copy = *this; ++it; return copy; }
+            bool operator==(const const_iterator &other) const { return it == other.it; }
+            bool operator!=(const const_iterator &other) const { return it != other.it; }
+        };
+
+        LinkedEntries(const indexed_transaction_set &mapTxIn, const CTxMemPoolEntry::Links &linksIn)
+            : pmapTx(&mapTxIn), plinks(&linksIn) {}
+
+        const_iterator begin() const { return {*pmapTx, plinks->begin()}; }
+        const_iterator end() const { return {*pmapTx, plinks->end()}; }
+        size_t size() const { return plinks->size(); }
+        bool empty() const { return plinks->empty(); }
+    };
+
+    LinkedEntries GetMemPoolParents(txiter entry) const
         EXCLUSIVE_LOCKS_REQUIRED(cs);
-    const setEntries &GetMemPoolChildren(txiter entry) const
+    LinkedEntries GetMemPoolChildren(txiter entry) const
         EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     /**
@@ -491,18 +625,47 @@ private:
     //! Helper function for getDoubleSpendProof_common and others
     DspDescendants getDspDescendantsForIter(txiter) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
-    struct TxLinks {
-        setEntries parents;
-        setEntries children;
-    };
+    void UpdateParent(txiter entry, txiter parent, bool add) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void UpdateChild(txiter entry, txiter child, bool add) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //! The most recently published snapshot. Written with std::atomic_store (with cs held) and read with
+    //! std::atomic_load, see GetSnapshot()
+    mutable std::shared_ptr<const CTxMemPoolSnapshot> m_snapshot;
+    //! Bumped for every change that is visible in a snapshot
+    mutable uint64_t m_snapshotMutations GUARDED_BY(cs){0};
+    //! Set by the first GetSnapshot() call; until then changes are not tracked
+    mutable bool m_snapshotInUse GUARDED_BY(cs){false};
+    //! Txids whose snapshot entries are out of date
+    mutable std::unordered_set<TxId, SaltedTxIdHasher> m_snapshotDirty GUARDED_BY(cs);
+    //! If set, the next snapshot is built from scratch and m_snapshotDirty is ignored
+    mutable bool m_snapshotAllDirty GUARDED_BY(cs){true};
+    //! Number of SnapshotBatch objects alive
+    int m_snapshotBatchDepth GUARDED_BY(cs){0};
+
+    void MarkSnapshotDirty(const TxId &txid) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void MarkSnapshotAllDirty() EXCLUSIVE_LOCKS_REQUIRED(cs);
+    //! Rebuild the shards that saw changes since the last snapshot, and publish the result
+    void PublishSnapshot() const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
-    using txlinksMap = std::map<txiter, TxLinks, CompareIteratorByEntryId>;
-    txlinksMap mapLinks;
+public:
+    /**
+     * Groups changes to the mempool, so that they are published to
+     * GetSnapshot() readers together, once the outermost batch is closed.
+     * Every method that changes the mempool opens one of its own; callers that
+     * make many changes in a row (like AcceptToMemoryPoolBatch()) can open one
+     * around all of them. cs must be held for the whole lifetime of a batch.
+     */
+    class SnapshotBatch {
+        CTxMemPool &pool;
 
-    void UpdateParent(txiter entry, txiter parent, bool add);
-    void UpdateChild(txiter entry, txiter child, bool add);
+    public:
+        explicit SnapshotBatch(CTxMemPool &poolIn) EXCLUSIVE_LOCKS_REQUIRED(poolIn.cs);
+        ~SnapshotBatch();
+
+        SnapshotBatch(const SnapshotBatch &) = delete;
+        SnapshotBatch &operator=(const SnapshotBatch &) = delete;
+    };
 
-public:
     indirectmap<COutPoint, const CTransaction *> mapNextTx GUARDED_BY(cs);
     std::map<TxId, Amount> mapDeltas;
 
@@ -604,7 +767,7 @@ public:
      * Try to calculate all in-mempool ancestors of entry.
      *  (these are all calculated including the tx itself)
      * fSearchForParents = whether to search a tx's vin for in-mempool parents,
-     * or look up parents from mapLinks. Must be true for entries not in the
+     * or use the parent links of the entry. Must be true for entries not in the
      * mempool.
      */
     void CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntries &setAncestors,
@@ -673,6 +836,17 @@ public:
 
     CTransactionRef get(const TxId &txid) const;
     TxMempoolInfo info(const TxId &txid) const;
+
+    /**
+     * Get an immutable snapshot of the mempool, for readers that would rather
+     * not hold `cs` while they work through it (RPC, REST).
+     *
+     * The snapshot is published by the writers, at the end of every
+     * SnapshotBatch, so this only loads the pointer. The one exception is the
+     * very first call, which takes `cs` to build the initial snapshot; changes
+     * are not tracked before anyone asks for a snapshot.
+     */
+    std::shared_ptr<const CTxMemPoolSnapshot> GetSnapshot() const;
     std::vector<TxMempoolInfo> infoAll() const;
 
     CFeeRate estimateFee() const;
@@ -685,18 +859,19 @@ public:
 
 private:
     /**
-     * Update parents of `it` to add/remove it as a child transaction (updates mapLinks).
+     * Update parents of `it` to add/remove it as a child transaction (updates their links).
      */
     void UpdateParentsOf(bool add, txiter it)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
     /**
      * For each transaction being removed, sever links between parents
-     * and children in mapLinks
+     * and children
      */
     void UpdateForRemoveFromMempool(const setEntries &entriesToRemove)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
-    /** Sever link between specified transaction and direct children. */
-    void UpdateChildrenForRemoval(txiter entry) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    /** Drop the links of `entry` (its parents or children) that point to an entry of `removed`. */
+    void RemoveLinksTo(txiter entry, CTxMemPoolEntry::Links &links, const setEntries &removed)
+        EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     /**
      * Before calling removeUnchecked for a given transaction,
@@ -0,0 +1,74 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <fs.h>
+#include <span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * A read-only memory mapping of a whole file.
+ *
+ * The mapping is shared with the page cache, so data that is written to the
+ * file later on (within the mapped size) becomes visible through the mapping
+ * as well. Files that grow beyond the mapped size need to be mapped again.
+ *
+ * Instances are always handed out as shared pointers, so that views into the
+ * mapping (see SharedByteSpan) can keep it alive.
+ */
+class MappedFile {
+    const uint8_t *m_data{nullptr};
+    size_t m_size{0};
+
+    MappedFile(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+public:
+    /**
+     * Map the file at `path` read-only.
+     * @returns nullptr if the file can't be opened or mapped, if it is empty,
+     *          or if memory mapping is not supported on this platform.
+     */
+    static std::shared_ptr<const MappedFile> Open(const fs::path &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    Span<const uint8_t> data() const { return {m_data, m_size}; }
+    size_t size() const { return m_size; }
+};
+
+/**
+ * A read-only view of bytes that shares ownership of the storage they live in,
+ * e.g. a block inside a MappedFile. The bytes stay valid for as long as the
+ * view, or any copy of it, exists.
+ */
+class SharedByteSpan {
+    std::shared_ptr<const void> m_owner;
+    Span<const uint8_t> m_span;
+
+public:
+    SharedByteSpan() = default;
+    SharedByteSpan(std::shared_ptr<const void> owner, Span<const uint8_t> span)
+        : m_owner(std::move(owner)), m_span(span) {}
+
+    //! Take ownership of a plain byte vector (costs one allocation, but no copy).
+    explicit SharedByteSpan(std::vector<uint8_t> &&bytes) {
+        auto owner = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+        m_span = Span<const uint8_t>{*owner};
+        m_owner = std::move(owner);
+    }
+
+    Span<const uint8_t> span() const { return m_span; }
+    const uint8_t *data() const { return m_span.data(); }
+    size_t size() const { return m_span.size(); }
+    bool empty() const { return m_span.empty(); }
+};
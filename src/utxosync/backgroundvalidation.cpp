@@ -0,0 +1,237 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <utxosync/backgroundvalidation.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <coinstats.h>
+#include <config.h>
+#include <consensus/validation.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <shutdown.h>
+#include <tinyformat.h>
+#include <txdb.h>
+#include <util/system.h>
+#include <util/threadnames.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+namespace utxosync {
+
+std::unique_ptr<BackgroundValidation> g_background_validation GUARDED_BY(cs_main);
+
+//! The directory of the background chainstate, in the data directory
+static const char *const BACKGROUND_CHAINSTATE_DIR = "chainstate_background";
+//! Interval (in seconds) between progress log lines
+static constexpr int64_t LOG_INTERVAL = 30;
+
+namespace {
+struct Interrupted {};
+} // namespace
+
+BackgroundValidation::BackgroundValidation(const CBlockIndex *pindexBase, const uint256 &ecmh,
+                                           size_t cache_usage)
+    : m_base(pindexBase), m_ecmh(ecmh), m_cache_usage(cache_usage) {}
+
+BackgroundValidation::~BackgroundValidation() {
+    Stop();
+}
+
+bool BackgroundValidation::Start(const Config &config, bool fWipe) {
+    m_coinsdb = std::make_unique<CCoinsViewDB>(BACKGROUND_COINS_DB_CACHE, false, fWipe, BACKGROUND_CHAINSTATE_DIR);
+    if (!m_coinsdb->GetHeadBlocks().empty()) {
+        // A flush was interrupted; rather than replaying it, start over
+        LogPrintf("Background chainstate is inconsistent, starting the validation of the UTXO snapshot history over\n");
+        m_coinsdb.reset();
+        m_coinsdb = std::make_unique<CCoinsViewDB>(BACKGROUND_COINS_DB_CACHE, false, true, BACKGROUND_CHAINSTATE_DIR);
+    }
+    m_coins = std::make_unique<CCoinsViewCache>(m_coinsdb.get());
+
+    {
+        LOCK(cs_main);
+        if (const BlockHash hashBestBlock = m_coins->GetBestBlock(); !hashBestBlock.IsNull()) {
+            m_tip = LookupBlockIndex(hashBestBlock);
+            if (!m_tip || m_base->GetAncestor(m_tip->nHeight) != m_tip) {
+                return error("%s: the background chainstate at %s is not on the chain of the UTXO snapshot", __func__,
+                             hashBestBlock.ToString());
+            }
+            m_height = m_tip->nHeight;
+        }
+    }
+    LogPrintf("Validating the history below the UTXO snapshot at height %d, from height %d\n", m_base->nHeight,
+              m_height + 1);
+
+    m_thread = std::thread([this, &config] {
+        util::ThreadRename("bgvalidation");
+        ThreadValidate(config);
+    });
+    return true;
+}
+
+void BackgroundValidation::Stop() {
+    m_interrupt();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool BackgroundValidation::Flush() {
+    // The block index, which records the block data and undo data of the background chainstate's blocks, must not
+    // fall behind it. This also flushes the active chainstate, but that one is rather small after loading a snapshot.
+    FlushStateToDisk();
+    return m_coins->Flush();
+}
+
+void BackgroundValidation::ThreadValidate(const Config &config) {
+    // Validating the history can take hours, let it yield to everything else
+    ScheduleBatchPriority();
+
+    const Consensus::Params &params = config.GetChainParams().GetConsensus();
+    int64_t nLastLog = 0;
+    int64_t nLastFlush = GetTime();
+    while (!m_interrupt) {
+        if (m_tip == m_base) {
+            Complete();
+            return;
+        }
+        const CBlockIndex *pindex = m_base->GetAncestor(m_height + 1);
+        // Let the active chain catch up first, and wait for the block to be downloaded
+        if (IsInitialBlockDownload() || !WITH_LOCK(cs_main, return pindex->nStatus.hasData())) {
+            m_interrupt.sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, params)) {
+            AbortNode(strprintf("Failed to read block %s from disk", pindex->GetBlockHash().ToString()));
+            return;
+        }
+        {
+            // The ABLA state of the base came with the snapshot; connecting the base recomputes it
+            const std::optional<abla::State> ablaState = WITH_LOCK(cs_main, return pindex->GetAblaStateOpt());
+            CBlockIndex *const pindexConnect = WITH_LOCK(cs_main, return LookupBlockIndex(pindex->GetBlockHash()));
+            CValidationState state;
+            // Only takes cs_main for the block index, so that the active chain is not held up for the scripts
+            if (!ConnectBlockInBackground(config, block, state, pindexConnect, *m_coins, *m_coinsdb)) {
+                if (state.IsError()) {
+                    // AbortNode() was called already
+                    return;
+                }
+                AbortNode(strprintf("Block %s at height %d below the UTXO snapshot is invalid: %s",
+                                    pindex->GetBlockHash().ToString(), pindex->nHeight, FormatStateMessage(state)),
+                          _("The UTXO snapshot that the chainstate was loaded from is not on a valid chain. Restart "
+                            "with -reindex to rebuild the chainstate from the blocks."));
+                return;
+            }
+            if (pindex == m_base && WITH_LOCK(cs_main, return pindex->GetAblaStateOpt()) != ablaState) {
+                AbortNode("The ABLA state of the UTXO snapshot does not match the validated chain",
+                          _("The UTXO snapshot that the chainstate was loaded from is invalid. Restart with -reindex to "
+                            "rebuild the chainstate from the blocks."));
+                return;
+            }
+        }
+        m_tip = pindex;
+        m_height = pindex->nHeight;
+
+        const int64_t nNow = GetTime();
+        if (nLastLog + LOG_INTERVAL < nNow) {
+            LogPrintf("Validating the history below the UTXO snapshot: height %d of %d\n", m_height, m_base->nHeight);
+            nLastLog = nNow;
+        }
+        if (m_coins->DynamicMemoryUsage() > m_cache_usage || nLastFlush + DATABASE_WRITE_INTERVAL < nNow) {
+            if (!Flush()) {
+                AbortNode("Failed to write to the background chainstate");
+                return;
+            }
+            nLastFlush = nNow;
+        }
+    }
+
+    if (!Flush()) {
+        LogPrintf("%s: failed to write to the background chainstate\n", __func__);
+    }
+}
+
+void BackgroundValidation::Complete() {
+    if (!Flush()) {
+        AbortNode("Failed to write to the background chainstate");
+        return;
+    }
+    LogPrintf("Validated the history below the UTXO snapshot, checking the coins at height %d\n", m_height);
+    std::optional<CoinStats> stats;
+    try {
+        stats = ComputeUTXOStats(m_coinsdb.get(), CoinStatsHashType::ECMH, [this] {
+            if (m_interrupt) {
+                throw Interrupted();
+            }
+        }, std::clamp(GetNumCores(), 1, MAX_UTXO_STATS_THREADS));
+    } catch (const Interrupted &) {
+        // Checked again at the next start
+        return;
+    }
+    if (!stats) {
+        AbortNode("Failed to read the background chainstate");
+        return;
+    }
+    if (stats->hashSerialized != m_ecmh) {
+        AbortNode(strprintf("The coins of the UTXO snapshot at %s do not match the validated chain (ECMH %s, expected "
+                            "%s)", m_base->GetBlockHash().ToString(), stats->hashSerialized.ToString(),
+                            m_ecmh.ToString()),
+                  _("The UTXO snapshot that the chainstate was loaded from is invalid. Restart with -reindex to "
+                    "rebuild the chainstate from the blocks."));
+        return;
+    }
+
+    {
+        LOCK(cs_main);
+        if (!pblocktree->EraseSnapshotBase()) {
+            AbortNode("Failed to write to the block index database");
+            return;
+        }
+        pindexSnapshotBase = nullptr;
+    }
+    m_coins.reset();
+    m_coinsdb.reset();
+    fs::remove_all(GetDataDir() / BACKGROUND_CHAINSTATE_DIR);
+    LogPrintf("The UTXO snapshot at height %d is valid, the whole chain has been validated\n", m_base->nHeight);
+}
+
+bool StartBackgroundValidation(const Config &config, bool fWipe) {
+    AssertLockHeld(cs_main);
+    assert(!g_background_validation);
+    BlockHash hashBase;
+    uint256 ecmh;
+    if (!pindexSnapshotBase || !pblocktree->ReadSnapshotBase(hashBase, ecmh)) {
+        if (const fs::path path = GetDataDir() / BACKGROUND_CHAINSTATE_DIR; fs::exists(path)) {
+            LogPrintf("Removing the background chainstate, as there is no UTXO snapshot to validate\n");
+            fs::remove_all(path);
+        }
+        return true;
+    }
+    assert(hashBase == pindexSnapshotBase->GetBlockHash());
+
+    // Give it half of the coins cache of the active chainstate, which hardly uses it right after loading a snapshot
+    g_background_validation = std::make_unique<BackgroundValidation>(pindexSnapshotBase, ecmh, nCoinCacheUsage / 2);
+    if (!g_background_validation->Start(config, fWipe)) {
+        g_background_validation.reset();
+        return false;
+    }
+    return true;
+}
+
+void StopBackgroundValidation() {
+    std::unique_ptr<BackgroundValidation> background = WITH_LOCK(cs_main, return std::move(g_background_validation));
+    if (background) {
+        background->Stop();
+    }
+}
+
+} // namespace utxosync
@@ -0,0 +1,88 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <sync.h>
+#include <threadinterrupt.h>
+#include <uint256.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+class CBlockIndex;
+class CCoinsViewCache;
+class CCoinsViewDB;
+class Config;
+
+extern RecursiveMutex cs_main;
+
+namespace utxosync {
+
+/// The LevelDB cache of the background chainstate
+static constexpr size_t BACKGROUND_COINS_DB_CACHE = 16 << 20;
+
+/**
+ * Validates the history below a UTXO snapshot (see snapshot.h), while the node runs on the chainstate that was loaded
+ * from it.
+ *
+ * The blocks from the genesis block up to the snapshot base are downloaded once there is room besides the blocks that
+ * the active chain needs (see FindNextBackgroundBlocksToDownload() in net_processing.cpp), and connected to a second
+ * chainstate (the "chainstate_background" directory) on a low priority thread, one block per cs_main acquisition.
+ * Once the base is reached, the ECMH of that chainstate is compared with the one of the snapshot. If they match, the
+ * snapshot base is forgotten and the node is an ordinary full node again. If they don't, or if a block of the history
+ * is invalid, the active chainstate cannot be trusted and the node shuts down.
+ */
+class BackgroundValidation {
+public:
+    BackgroundValidation(const CBlockIndex *pindexBase, const uint256 &ecmh, size_t cache_usage);
+    /// Interrupts the validation thread, if running, and waits for it to exit
+    ~BackgroundValidation();
+
+    /// Opens the background chainstate, wiping it if `fWipe` is set or if it is not consistent, and starts the
+    /// validation thread
+    bool Start(const Config &config, bool fWipe);
+    /// Stops the validation thread and flushes the background chainstate
+    void Stop();
+
+    const CBlockIndex *GetBase() const { return m_base; }
+    /// @returns the height up to which the history has been validated, or -1 if not even the genesis block has been
+    int GetHeight() const { return m_height; }
+
+private:
+    const CBlockIndex *const m_base;
+    //! The ECMH of the snapshot's coins
+    const uint256 m_ecmh;
+    const size_t m_cache_usage;
+
+    std::unique_ptr<CCoinsViewDB> m_coinsdb;
+    std::unique_ptr<CCoinsViewCache> m_coins;
+    //! The last block connected to m_coins; only used by the validation thread
+    const CBlockIndex *m_tip{nullptr};
+    std::atomic<int> m_height{-1};
+
+    std::thread m_thread;
+    CThreadInterrupt m_interrupt;
+
+    void ThreadValidate(const Config &config);
+    /// Writes the block index and then the background chainstate to disk
+    bool Flush();
+    /// Checks the background chainstate at the snapshot base against the snapshot
+    void Complete();
+};
+
+/// Set while the history below a UTXO snapshot is being validated
+extern std::unique_ptr<BackgroundValidation> g_background_validation GUARDED_BY(cs_main);
+
+/**
+ * Start validating the history below the UTXO snapshot that the chainstate was loaded from (see pindexSnapshotBase),
+ * if any. `fWipe` must be set when the snapshot was just loaded, so that nothing is left of an earlier background
+ * chainstate. If there is no snapshot, a leftover background chainstate is deleted.
+ */
+bool StartBackgroundValidation(const Config &config, bool fWipe) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+/// Stop the background validation started by StartBackgroundValidation(), if any
+void StopBackgroundValidation() LOCKS_EXCLUDED(cs_main);
+
+} // namespace utxosync
@@ -0,0 +1,226 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <utxosync/snapshot.h>
+
+#include <coins.h>
+#include <ec_multiset.h>
+#include <logging.h>
+#include <streams.h>
+#include <sync.h>
+#include <txdb.h>
+#include <util/threadnames.h>
+#include <utxosync/primitives.h>
+#include <version.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace utxosync {
+
+namespace {
+
+/// Runs `work(t)` for each t in [0, nThreads), with t == 0 on the calling thread. `fAbort` is set as soon as one of
+/// them throws, and the first exception is rethrown after all of them are done.
+template <typename Func>
+void RunOnThreads(size_t nThreads, std::atomic<bool> &fAbort, const char *name, Func &&work) {
+    std::exception_ptr error;
+    Mutex cs_error;
+    auto run = [&](size_t t) {
+        try {
+            work(t);
+        } catch (...) {
+            fAbort = true;
+            LOCK(cs_error);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (size_t t = 1; t < nThreads; ++t) {
+        threads.emplace_back([&, t] {
+            util::ThreadRename(name);
+            run(t);
+        });
+    }
+    run(0);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/// Orders outpoints like their database keys: by the bytes of the txid, then by output index
+bool CoinKeyLess(const std::pair<COutPoint, Coin> &a, const std::pair<COutPoint, Coin> &b) {
+    const int cmp = std::memcmp(a.first.GetTxId().data(), b.first.GetTxId().data(), TxId::size());
+    return cmp < 0 || (cmp == 0 && a.first.GetN() < b.first.GetN());
+}
+
+struct Chunk {
+    uint64_t nCoins{};
+    std::vector<uint8_t> data;
+    ECMultiSet ecmh;
+    std::vector<std::pair<COutPoint, Coin>> coins;
+};
+
+/// Deserializes and hashes the coins of `chunk`, and sorts them by outpoint
+void ParseChunk(Chunk &chunk) {
+    VectorReader reader(SER_NETWORK, PROTOCOL_VERSION, chunk.data, 0);
+    chunk.ecmh.Clear();
+    chunk.coins.clear();
+    chunk.coins.reserve(chunk.nCoins);
+    for (uint64_t i = 0; i < chunk.nCoins; ++i) {
+        const size_t begin = reader.GetPos();
+        UTXO utxo;
+        reader >> utxo;
+        chunk.ecmh.Add(Span<const uint8_t>{chunk.data}.subspan(begin, reader.GetPos() - begin));
+        chunk.coins.emplace_back(utxo.outPoint, std::move(utxo.coin));
+    }
+    if (!reader.empty()) {
+        throw std::ios_base::failure("Unexpected data at the end of a UTXO snapshot chunk");
+    }
+    // Chunks written by DumpSnapshot() are already sorted
+    if (!std::is_sorted(chunk.coins.begin(), chunk.coins.end(), CoinKeyLess)) {
+        std::sort(chunk.coins.begin(), chunk.coins.end(), CoinKeyLess);
+    }
+}
+
+} // namespace
+
+SnapshotSummary DumpSnapshot(CAutoFile &file, const SnapshotMetadata &metadata,
+                             const std::vector<std::unique_ptr<CCoinsViewCursor>> &cursors, size_t nThreads,
+                             const std::function<void()> &interruption_point) {
+    assert(nThreads > 0);
+    file << metadata;
+
+    Mutex cs_file;
+    SnapshotSummary summary;
+    ECMultiSet ecmh;
+    std::atomic<size_t> nextCursor{0};
+    std::atomic<bool> fAbort{false};
+
+    RunOnThreads(nThreads, fAbort, "dumputxoset", [&](size_t t) {
+        Chunk chunk;
+        auto writeChunk = [&] {
+            if (chunk.nCoins == 0) {
+                return;
+            }
+            LOCK(cs_file);
+            WriteCompactSize(file, chunk.nCoins);
+            file << chunk.data;
+            summary.nCoins += chunk.nCoins;
+            ecmh += chunk.ecmh;
+            chunk.nCoins = 0;
+            chunk.data.clear();
+            chunk.ecmh.Clear();
+        };
+
+        COutPoint outpoint;
+        Coin coin;
+        for (size_t n; !fAbort && (n = nextCursor++) < cursors.size();) {
+            for (CCoinsViewCursor &cursor = *cursors[n]; cursor.Valid() && !fAbort; cursor.Next()) {
+                if (t == 0 && interruption_point) {
+                    interruption_point();
+                }
+                if (!cursor.GetKey(outpoint) || !cursor.GetValue(coin)) {
+                    throw std::runtime_error("Unable to read the UTXO set");
+                }
+                const size_t begin = chunk.data.size();
+                CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, chunk.data, begin) << UTXOShallowCRef(outpoint, coin);
+                chunk.ecmh.Add(Span<const uint8_t>{chunk.data}.subspan(begin));
+                if (++chunk.nCoins == SNAPSHOT_CHUNK_COINS || chunk.data.size() >= SNAPSHOT_CHUNK_SIZE) {
+                    writeChunk();
+                }
+            }
+            // Don't let chunks span shards, so that each of them stays sorted
+            writeChunk();
+        }
+    });
+
+    WriteCompactSize(file, 0);
+    summary.ecmhHash = ecmh.GetHash();
+    file << summary;
+    return summary;
+}
+
+SnapshotSummary LoadSnapshot(CAutoFile &file, const SnapshotMetadata &metadata, CCoinsViewDB &coinsdb,
+                             size_t nThreads, const uint256 &expectedHash,
+                             const std::function<void()> &interruption_point) {
+    assert(nThreads > 0);
+    if (!coinsdb.BeginBulkLoad(metadata.baseBlockHash)) {
+        throw std::runtime_error("Unable to prepare the coins database for loading a snapshot");
+    }
+
+    try {
+        SnapshotSummary summary;
+        ECMultiSet ecmh;
+        std::vector<Chunk> chunks(nThreads);
+        for (bool fEnd = false; !fEnd;) {
+            if (interruption_point) {
+                interruption_point();
+            }
+            // Read a chunk for each thread, parse them concurrently, then write them out in order
+            size_t nChunks = 0;
+            for (; nChunks < chunks.size(); ++nChunks) {
+                Chunk &chunk = chunks[nChunks];
+                chunk.nCoins = ReadCompactSize(file, false);
+                if (chunk.nCoins == 0) {
+                    fEnd = true;
+                    break;
+                }
+                file >> chunk.data;
+                // Every coin takes up dozens of bytes, this just bounds the allocation in ParseChunk()
+                if (chunk.nCoins > chunk.data.size()) {
+                    throw std::ios_base::failure("Bad coin count in UTXO snapshot chunk");
+                }
+            }
+
+            std::atomic<bool> fAbort{false};
+            RunOnThreads(std::max<size_t>(nChunks, 1), fAbort, "loadutxoset", [&](size_t t) {
+                if (t < nChunks) {
+                    ParseChunk(chunks[t]);
+                }
+            });
+
+            for (size_t n = 0; n < nChunks; ++n) {
+                Chunk &chunk = chunks[n];
+                if (!coinsdb.BulkLoadCoins(chunk.coins)) {
+                    throw std::runtime_error("Unable to write to the coins database");
+                }
+                summary.nCoins += chunk.nCoins;
+                ecmh += chunk.ecmh;
+            }
+            LogPrint(BCLog::COINDB, "Loaded %u coins from UTXO snapshot\n", summary.nCoins);
+        }
+        summary.ecmhHash = ecmh.GetHash();
+
+        SnapshotSummary expected;
+        file >> expected;
+        if (summary.nCoins != expected.nCoins || summary.ecmhHash != expected.ecmhHash) {
+            throw std::runtime_error("The coins in the UTXO snapshot do not match its summary (corrupt file?)");
+        }
+        if (summary.ecmhHash != expectedHash) {
+            throw std::runtime_error("The UTXO snapshot does not have the expected hash");
+        }
+        if (!coinsdb.EndBulkLoad(metadata.baseBlockHash, true)) {
+            throw std::runtime_error("Unable to write to the coins database");
+        }
+        return summary;
+    } catch (...) {
+        coinsdb.EndBulkLoad(metadata.baseBlockHash, false);
+        throw;
+    }
+}
+
+} // namespace utxosync
@@ -0,0 +1,110 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <consensus/abla.h>
+#include <primitives/blockhash.h>
+#include <protocol.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class CAutoFile;
+class CCoinsViewCursor;
+class CCoinsViewDB;
+
+/**
+ * UTXO snapshots: a chainstate written out in the utxosync serialization (see primitives.h), so that a new node can
+ * load it instead of validating the whole history.
+ *
+ * File layout:
+ *  1. SnapshotMetadata
+ *  2. Chunks of coins. Each chunk is a CompactSize coin count followed by the serialized coins as a byte vector
+ *     (CompactSize length + bytes), so that a reader can hand whole chunks to other threads without parsing them.
+ *     The coins within a chunk are sorted by outpoint (in database key order), the chunks are in no particular order.
+ *  3. An empty chunk (coin count 0), marking the end of the coins.
+ *  4. SnapshotSummary, which commits to all the coins. The ECMH is the same as the one reported by gettxoutsetinfo
+ *     with hash_type "ecmh", so a snapshot may be checked against the hash obtained from a trusted node.
+ */
+namespace utxosync {
+
+/// The header of a UTXO snapshot file
+struct SnapshotMetadata {
+    static constexpr std::array<uint8_t, 5> MAGIC{{'u', 't', 'x', 'o', 0xff}};
+    static constexpr uint16_t VERSION = 1;
+
+    //! The network the snapshot is for
+    CMessageHeader::MessageMagic netMagic{};
+    //! The block the snapshot was taken at
+    BlockHash baseBlockHash;
+    int32_t baseHeight{};
+    //! The number of transactions in the chain up to and including the base block
+    uint64_t nChainTx{};
+    //! The ABLA state of the base block, if ABLA was active at it
+    std::optional<abla::State> ablaState;
+
+    SERIALIZE_METHODS(SnapshotMetadata, obj) {
+        std::array<uint8_t, MAGIC.size()> magic = MAGIC;
+        uint16_t version = VERSION;
+        READWRITE(magic, version);
+        if (magic != MAGIC) {
+            throw std::ios_base::failure("Not a UTXO snapshot file");
+        }
+        if (version != VERSION) {
+            throw std::ios_base::failure("Unsupported UTXO snapshot version");
+        }
+        READWRITE(obj.netMagic, obj.baseBlockHash, obj.baseHeight, obj.nChainTx, obj.ablaState);
+    }
+};
+
+/// The trailer of a UTXO snapshot file
+struct SnapshotSummary {
+    uint64_t nCoins{};
+    //! ECMultiSet hash of the serialized coins
+    uint256 ecmhHash;
+
+    SERIALIZE_METHODS(SnapshotSummary, obj) { READWRITE(obj.nCoins, obj.ecmhHash); }
+};
+
+/// DumpSnapshot() starts a new chunk after this many coins, or this many bytes
+static constexpr size_t SNAPSHOT_CHUNK_COINS = 65536;
+static constexpr size_t SNAPSHOT_CHUNK_SIZE = 4 << 20;
+/// The maximum number of threads that the RPCs use for dumping and loading snapshots
+static constexpr int MAX_SNAPSHOT_THREADS = 16;
+/// loadutxoset loads a snapshot into a coins database in this directory of the data directory, without holding
+/// cs_main, and only then replaces the chainstate with it
+static constexpr const char *SNAPSHOT_CHAINSTATE_DIR = "chainstate_snapshot";
+/// The cache size of that database, which is only written to in large batches
+static constexpr size_t SNAPSHOT_COINS_DB_CACHE = 16 << 20;
+
+/**
+ * Write `metadata` and the coins that `cursors` iterate over (see CCoinsView::CursorShards()) to `file`. The shards are
+ * serialized and hashed on `nThreads` threads (including the calling thread, which also calls `interruption_point`).
+ * Throws on error.
+ */
+SnapshotSummary DumpSnapshot(CAutoFile &file, const SnapshotMetadata &metadata,
+                             const std::vector<std::unique_ptr<CCoinsViewCursor>> &cursors, size_t nThreads,
+                             const std::function<void()> &interruption_point);
+
+/**
+ * Read the coins of a snapshot from `file`, which must be positioned right after the metadata, into `coinsdb`, which
+ * must not contain any coins. The chunks are deserialized, hashed and sorted on `nThreads` threads (including the
+ * calling thread, which also calls `interruption_point` between groups of chunks), and written to the database in
+ * large sorted batches. The database is only marked as consistent with the base block if the coins match the summary
+ * of the file and `expectedHash`. Otherwise, or if `interruption_point` throws, the loaded coins are erased again, and
+ * an exception is thrown.
+ */
+SnapshotSummary LoadSnapshot(CAutoFile &file, const SnapshotMetadata &metadata, CCoinsViewDB &coinsdb,
+                             size_t nThreads, const uint256 &expectedHash,
+                             const std::function<void()> &interruption_point);
+
+} // namespace utxosync
@@ -53,6 +53,7 @@
 #include <util/string.h>
 #include <util/system.h>
 #include <util/time.h>
+#include <utxosync/backgroundvalidation.h>
 #include <validationinterface.h>
 #include <warnings.h>
 
@@ -63,9 +64,11 @@
 #include <iterator>
 #include <limits>
 #include <list>
+#include <memory>
 #include <optional>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 
 #define MICRO 0.000001
@@ -170,8 +173,10 @@ public:
                                      CCoinsViewCache &view);
     bool ConnectBlock(const CBlock &block, CValidationState &state,
                       CBlockIndex *pindex, CCoinsViewCache &view,
+                      CCoinsViewCache &coinsCache, const CCoinsView &coinsDB,
                       const CChainParams &params,
-                      BlockValidationOptions options, bool fJustCheck = false)
+                      BlockValidationOptions options, bool fJustCheck = false,
+                      UniqueLock<RecursiveMutex> *lockMain = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     // Block disconnection on our pcoinsTip:
@@ -199,6 +204,11 @@ public:
 
     bool ReplayBlocks(const Consensus::Params &params, CCoinsView *view);
     bool LoadGenesisBlock(const CChainParams &chainparams);
+    bool ActivateSnapshot(const Config &config, CBlockIndex *pindexBase,
+                          uint64_t nChainTx,
+                          const std::optional<abla::State> &ablaState,
+                          const uint256 &ecmh)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     void PruneBlockIndexCandidates();
 
@@ -362,7 +372,8 @@ bool TestLockPointValidity(const LockPoints *lp) {
 }
 
 bool CheckSequenceLocks(const CTxMemPool &pool, const CTransaction &tx,
-                        int flags, LockPoints *lp, bool useExistingLockPoints) {
+                        int flags, LockPoints *lp, bool useExistingLockPoints,
+                        const CCoinsView *coinsView) {
     AssertLockHeld(cs_main);
     AssertLockHeld(pool.cs);
 
@@ -386,12 +397,15 @@ bool CheckSequenceLocks(const CTxMemPool &pool, const CTransaction &tx,
     } else {
         // pcoinsTip contains the UTXO set for ::ChainActive().Tip()
         CCoinsViewMemPool viewMemPool(pcoinsTip.get(), pool);
+        if (!coinsView) {
+            coinsView = &viewMemPool;
+        }
         std::vector<int> prevheights;
         prevheights.resize(tx.vin.size());
         for (size_t txinIndex = 0; txinIndex < tx.vin.size(); txinIndex++) {
             const CTxIn &txin = tx.vin[txinIndex];
             Coin coin;
-            if (!viewMemPool.GetCoin(txin.prevout, coin)) {
+            if (!coinsView->GetCoin(txin.prevout, coin)) {
                 return error("%s: Missing input", __func__);
             }
             if (coin.GetHeight() == MEMPOOL_HEIGHT) {
@@ -481,31 +495,68 @@ static bool CheckInputsFromMempoolAndCache(
     return CheckInputs(tx, state, view, true, flags, cacheSigStore, true, txdata, nSigChecksOut);
 }
 
-static bool
-AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
-                         CValidationState &state, const CTransactionRef &ptx,
-                         bool *pfMissingInputs, int64_t nAcceptTime,
-                         bool bypass_limits, const Amount nAbsurdFee,
-                         std::vector<COutPoint> &coins_to_uncache,
-                         bool test_accept, uint64_t *pEntryId) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+namespace {
+/**
+ * A transaction on its way through the stages of mempool acceptance:
+ * PreChecks(), PolicyScriptChecks() and Finalize(). AcceptToMemoryPoolWorker()
+ * runs the stages back to back for one transaction, AcceptToMemoryPoolBatch()
+ * runs each of them for a whole round of transactions before moving on.
+ */
+struct MempoolAcceptWorkspace {
+    MempoolAcceptWorkspace(const CTransactionRef &ptxIn, int64_t nAcceptTimeIn, CValidationState &stateIn,
+                           std::vector<COutPoint> &coins_to_uncacheIn)
+        : ptx(ptxIn), nAcceptTime(nAcceptTimeIn), state(stateIn), coins_to_uncache(coins_to_uncacheIn) {}
+
+    const CTransactionRef ptx;
+    const int64_t nAcceptTime;
+    CValidationState &state;
+    std::vector<COutPoint> &coins_to_uncache;
+    bool fMissingInputs = false;
+
+    //! GetNextBlockScriptFlags() | STANDARD_SCRIPT_VERIFY_FLAGS
+    uint32_t scriptVerifyFlags{};
+    //! Will be block flags (without standard flags)
+    uint32_t nextBlockScriptVerifyFlags{};
+    //! always empty in test_accept mode
+    std::list<std::pair<DspId, NodeId>> rescuedDSPOrphans;
+
+    //! Holds all coins spent by ptx after PreChecks() (with a detached backend)
+    CCoinsView dummy;
+    CCoinsViewCache view{&dummy};
+    LockPoints lp;
+    Amount nFees = Amount::zero();
+    //! nFees including any fee deltas from PrioritiseTransaction
+    Amount nModifiedFees = Amount::zero();
+    bool fSpendsCoinbase = false;
+
+    PrecomputedTransactionData txdata;
+    int nSigChecksStandard{};
+    //! Only used by the parallel script verification of AcceptToMemoryPoolBatch()
+    TxSigCheckLimiter policySigChecks;
+    //! Where the script checks of AcceptToMemoryPoolBatch() report to
+    ScriptCheckOutcome scriptCheckOutcome;
+    //! Set if PolicyScriptChecks() need not be run again
+    bool fPolicyScriptsVerified = false;
+};
+} // namespace
+
+/**
+ * First stage of mempool acceptance: context-free, contextual and policy
+ * checks, conflict detection, and the lookup of all coins spent by the
+ * transaction via `coinsBackend`. Everything but script verification.
+ */
+static bool PreChecks(const Config &config, CTxMemPool &pool, MempoolAcceptWorkspace &ws, CCoinsView &coinsBackend,
+                      bool bypass_limits, const Amount nAbsurdFee, bool test_accept)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs) {
     AssertLockHeld(cs_main);
+    AssertLockHeld(pool.cs);
 
     const Consensus::Params &consensusParams =
         config.GetChainParams().GetConsensus();
 
-    const CTransaction &tx = *ptx;
+    const CTransaction &tx = *ws.ptx;
     const TxId txid = tx.GetId();
-
-    // mempool "read lock" (held through
-    // GetMainSignals().TransactionAddedToMempool())
-    LOCK(pool.cs);
-
-    if (pfMissingInputs) {
-        *pfMissingInputs = false;
-    }
-    if (pEntryId) {
-        *pEntryId = 0;
-    }
+    CValidationState &state = ws.state;
 
     // Coinbase is only valid in a block, not as a loose transaction.
     if (!CheckRegularTransaction(tx, state)) {
@@ -513,10 +564,10 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
         return false;
     }
 
-    uint32_t nextBlockScriptVerifyFlags; // will be block flags (without standard flags)
     // Validate input scripts against standard script flags: GetNextBlockScriptFlags() | STANDARD_SCRIPT_VERIFY_FLAGS
-    const uint32_t scriptVerifyFlags = GetMemPoolScriptFlags(consensusParams, ::ChainActive().Tip(),
-                                                             &nextBlockScriptVerifyFlags);
+    ws.scriptVerifyFlags = GetMemPoolScriptFlags(consensusParams, ::ChainActive().Tip(),
+                                                 &ws.nextBlockScriptVerifyFlags);
+    const uint32_t scriptVerifyFlags = ws.scriptVerifyFlags;
 
     // Rather not work on nonstandard transactions (unless -testnet)
     if (std::string reason; fRequireStandard && !IsStandardTx(tx, reason, scriptVerifyFlags)) {
@@ -541,14 +592,12 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
         return state.Invalid(false, REJECT_DUPLICATE, "txn-already-in-mempool");
     }
 
-    std::list<std::pair<DspId, NodeId>> rescuedDSPOrphans; //! always empty in test_accept mode
-
     // Check for conflicts with in-memory transactions
     for (const CTxIn &txin : tx.vin) {
         if (!test_accept && DoubleSpendProof::IsEnabled()) {
             // add existing DSProof orphans (if any) to the rescued set
-            rescuedDSPOrphans.splice(rescuedDSPOrphans.end(),
-                                     pool.doubleSpendProofStorage()->findOrphans(txin.prevout));
+            ws.rescuedDSPOrphans.splice(ws.rescuedDSPOrphans.end(),
+                                        pool.doubleSpendProofStorage()->findOrphans(txin.prevout));
         }
         auto itConflicting = pool.mapNextTx.find(txin.prevout);
         if (itConflicting != pool.mapNextTx.end()) {
@@ -595,145 +644,161 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
         }
     }
 
-    {
-        CCoinsView dummy;
-        CCoinsViewCache view(&dummy);
-
-        LockPoints lp;
-        CCoinsViewMemPool viewMemPool(pcoinsTip.get(), pool);
-        view.SetBackend(viewMemPool);
+    CCoinsViewCache &view = ws.view;
+    view.SetBackend(coinsBackend);
 
-        // Do all inputs exist?
-        for (const CTxIn &txin : tx.vin) {
-            if (!pcoinsTip->HaveCoinInCache(txin.prevout)) {
-                coins_to_uncache.push_back(txin.prevout);
-            }
-
-            if (!view.HaveCoin(txin.prevout)) {
-                // Are inputs missing because we already have the tx?
-                for (size_t out = 0; out < tx.vout.size(); out++) {
-                    // Optimistically just do efficient check of cache for
-                    // outputs.
-                    if (pcoinsTip->HaveCoinInCache(COutPoint(txid, out))) {
-                        return state.Invalid(false, REJECT_DUPLICATE,
-                                             "txn-already-known");
-                    }
+    // Do all inputs exist?
+    for (const CTxIn &txin : tx.vin) {
+        if (!pcoinsTip->HaveCoinInCache(txin.prevout)) {
+            ws.coins_to_uncache.push_back(txin.prevout);
+        }
+
+        if (!view.HaveCoin(txin.prevout)) {
+            // Are inputs missing because we already have the tx?
+            for (size_t out = 0; out < tx.vout.size(); out++) {
+                // Optimistically just do efficient check of cache for
+                // outputs.
+                if (pcoinsTip->HaveCoinInCache(COutPoint(txid, out))) {
+                    return state.Invalid(false, REJECT_DUPLICATE,
+                                         "txn-already-known");
                 }
+            }
 
-                // Otherwise assume this might be an orphan tx for which we just
-                // haven't seen parents yet.
-                if (pfMissingInputs) {
-                    *pfMissingInputs = true;
-                }
+            // Otherwise assume this might be an orphan tx for which we just
+            // haven't seen parents yet.
+            ws.fMissingInputs = true;
 
-                // fMissingInputs and !state.IsInvalid() is used to detect this
-                // condition, don't set state.Invalid()
-                return false;
-            }
+            // fMissingInputs and !state.IsInvalid() is used to detect this
+            // condition, don't set state.Invalid()
+            return false;
         }
+    }
 
-        // Are the actual inputs available?
-        if (!view.HaveInputs(tx)) {
-            return state.Invalid(false, REJECT_DUPLICATE,
-                                 "bad-txns-inputs-spent");
-        }
+    // Are the actual inputs available?
+    if (!view.HaveInputs(tx)) {
+        return state.Invalid(false, REJECT_DUPLICATE,
+                             "bad-txns-inputs-spent");
+    }
 
-        // Bring the best block into scope.
-        view.GetBestBlock();
+    // Bring the best block into scope.
+    view.GetBestBlock();
 
-        // We have all inputs cached now, so switch back to dummy, so we don't
-        // need to keep lock on mempool.
-        view.SetBackend(dummy);
+    // We have all inputs cached now, so switch back to dummy, so we don't
+    // need to keep lock on mempool.
+    view.SetBackend(ws.dummy);
 
-        // Only accept BIP68 sequence locked transactions that can be mined in
-        // the next block; we don't want our mempool filled up with transactions
-        // that can't be mined yet. Must keep pool.cs for this unless we change
-        // CheckSequenceLocks to take a CoinsViewCache instead of create its
-        // own.
-        if (!CheckSequenceLocks(pool, tx, STANDARD_LOCKTIME_VERIFY_FLAGS,
-                                &lp)) {
-            return state.DoS(0, false, REJECT_NONSTANDARD, "non-BIP68-final");
-        }
+    // Only accept BIP68 sequence locked transactions that can be mined in the
+    // next block; we don't want our mempool filled up with transactions that
+    // can't be mined yet. The coins are taken from our view, which has them
+    // all cached by now.
+    if (!CheckSequenceLocks(pool, tx, STANDARD_LOCKTIME_VERIFY_FLAGS,
+                            &ws.lp, false /* useExistingLockPoints */, &view)) {
+        return state.DoS(0, false, REJECT_NONSTANDARD, "non-BIP68-final");
+    }
 
-        Amount nFees = Amount::zero();
-        if (!Consensus::CheckTxInputs(tx, state, view, GetSpendHeight(view),
-                                      nFees)) {
-            return error("%s: Consensus::CheckTxInputs: %s, %s", __func__,
-                         tx.GetId().ToString(), FormatStateMessage(state));
-        }
+    Amount &nFees = ws.nFees;
+    if (!Consensus::CheckTxInputs(tx, state, view, GetSpendHeight(view),
+                                  nFees)) {
+        return error("%s: Consensus::CheckTxInputs: %s, %s", __func__,
+                     tx.GetId().ToString(), FormatStateMessage(state));
+    }
 
-        // Check for non-standard pay-to-script-hash in inputs
-        if (fRequireStandard &&
-            !AreInputsStandard(tx, view, nextBlockScriptVerifyFlags)) {
-            return state.Invalid(false, REJECT_NONSTANDARD,
-                                 "bad-txns-nonstandard-inputs");
-        }
+    // Check for non-standard pay-to-script-hash in inputs
+    if (fRequireStandard &&
+        !AreInputsStandard(tx, view, ws.nextBlockScriptVerifyFlags)) {
+        return state.Invalid(false, REJECT_NONSTANDARD,
+                             "bad-txns-nonstandard-inputs");
+    }
 
-        // nModifiedFees includes any fee deltas from PrioritiseTransaction
-        Amount nModifiedFees = nFees;
-        pool.ApplyDelta(txid, nModifiedFees);
+    // nModifiedFees includes any fee deltas from PrioritiseTransaction
+    Amount &nModifiedFees = ws.nModifiedFees;
+    nModifiedFees = nFees;
+    pool.ApplyDelta(txid, nModifiedFees);
 
-        // Keep track of transactions that spend a coinbase, which we re-scan
-        // during reorgs to ensure COINBASE_MATURITY is still met.
-        bool fSpendsCoinbase = false;
-        for (const CTxIn &txin : tx.vin) {
-            const Coin &coin = view.AccessCoin(txin.prevout);
-            if (coin.IsCoinBase()) {
-                fSpendsCoinbase = true;
-                break;
-            }
+    // Keep track of transactions that spend a coinbase, which we re-scan
+    // during reorgs to ensure COINBASE_MATURITY is still met.
+    for (const CTxIn &txin : tx.vin) {
+        const Coin &coin = view.AccessCoin(txin.prevout);
+        if (coin.IsCoinBase()) {
+            ws.fSpendsCoinbase = true;
+            break;
         }
+    }
 
-        unsigned int nSize = tx.GetTotalSize();
+    unsigned int nSize = tx.GetTotalSize();
 
-        // No transactions are allowed below minRelayTxFee except from
-        // disconnected blocks.
-        // Do not change this to use virtualsize without coordinating a network
-        // policy upgrade.
-        if (!bypass_limits && nModifiedFees < minRelayTxFee.GetFee(nSize)) {
-            return state.DoS(0, false, REJECT_INSUFFICIENTFEE,
-                             "min relay fee not met");
-        }
-
-        if (nAbsurdFee != Amount::zero() && nFees > nAbsurdFee) {
-            return state.Invalid(false, REJECT_HIGHFEE, "absurdly-high-fee",
-                                 strprintf("%d > %d", nFees, nAbsurdFee));
-        }
+    // No transactions are allowed below minRelayTxFee except from
+    // disconnected blocks.
+    // Do not change this to use virtualsize without coordinating a network
+    // policy upgrade.
+    if (!bypass_limits && nModifiedFees < minRelayTxFee.GetFee(nSize)) {
+        return state.DoS(0, false, REJECT_INSUFFICIENTFEE,
+                         "min relay fee not met");
+    }
 
-        // Check token spends (if any) are within consensus
-        {
-            int64_t firstTokenBlockHeight;
-            if (scriptVerifyFlags & SCRIPT_ENABLE_TOKENS) { // Assumption: this can only be true if Upgrade9 activated
-                // First block to actually use token rules is 1 + activation block
-                firstTokenBlockHeight = 1 + GetUpgrade9ActivationHeight(consensusParams);
-            } else {
-                // not activated yet -- far future
-                firstTokenBlockHeight = std::numeric_limits<int64_t>::max();
-            }
+    if (nAbsurdFee != Amount::zero() && nFees > nAbsurdFee) {
+        return state.Invalid(false, REJECT_HIGHFEE, "absurdly-high-fee",
+                             strprintf("%d > %d", nFees, nAbsurdFee));
+    }
 
-            if ( ! CheckTxTokens(tx, state, view, scriptVerifyFlags, firstTokenBlockHeight)) {
-                // State filled-in by CheckTxTokens
-                return false;
-            }
+    // Check token spends (if any) are within consensus
+    {
+        int64_t firstTokenBlockHeight;
+        if (scriptVerifyFlags & SCRIPT_ENABLE_TOKENS) { // Assumption: this can only be true if Upgrade9 activated
+            // First block to actually use token rules is 1 + activation block
+            firstTokenBlockHeight = 1 + GetUpgrade9ActivationHeight(consensusParams);
+        } else {
+            // not activated yet -- far future
+            firstTokenBlockHeight = std::numeric_limits<int64_t>::max();
         }
 
-        int nSigChecksStandard;
-        PrecomputedTransactionData txdata;
-        if (!CheckInputs(tx, state, view, true, scriptVerifyFlags, true, false, txdata, nSigChecksStandard)) {
-            // State filled in by CheckInputs.
+        if ( ! CheckTxTokens(tx, state, view, scriptVerifyFlags, firstTokenBlockHeight)) {
+            // State filled-in by CheckTxTokens
             return false;
         }
+    }
+
+    return true;
+}
 
-        CTxMemPoolEntry entry(ptx, nFees, nAcceptTime, fSpendsCoinbase, nSigChecksStandard, lp);
+/**
+ * Second stage of mempool acceptance: verify the input scripts against the
+ * standard script flags.
+ */
+static bool PolicyScriptChecks(MempoolAcceptWorkspace &ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    AssertLockHeld(cs_main);
+
+    // State filled in by CheckInputs.
+    return CheckInputs(*ws.ptx, ws.state, ws.view, true, ws.scriptVerifyFlags, true, false, ws.txdata,
+                       ws.nSigChecksStandard);
+}
+
+/**
+ * Last stage of mempool acceptance: the mempool fee floor, script
+ * verification against the next block's consensus flags, and (unless
+ * test_accept) the actual insertion into the mempool.
+ */
+static bool Finalize(const Config &config, CTxMemPool &pool, MempoolAcceptWorkspace &ws, bool bypass_limits,
+                     bool test_accept, uint64_t *pEntryId) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(pool.cs);
+
+    const CTransactionRef &ptx = ws.ptx;
+    const CTransaction &tx = *ptx;
+    const TxId txid = tx.GetId();
+    CValidationState &state = ws.state;
+
+    {
+        CTxMemPoolEntry entry(ptx, ws.nFees, ws.nAcceptTime, ws.fSpendsCoinbase, ws.nSigChecksStandard, ws.lp);
 
         unsigned int nVirtualSize = entry.GetTxVirtualSize();
 
         Amount mempoolRejectFee = pool.GetMinFee(config.GetMaxMemPoolSize()).GetFee(nVirtualSize);
         if (!bypass_limits && mempoolRejectFee > Amount::zero() &&
-            nModifiedFees < mempoolRejectFee) {
+            ws.nModifiedFees < mempoolRejectFee) {
             return state.DoS(
                 0, false, REJECT_INSUFFICIENTFEE, "mempool min fee not met",
-                false, strprintf("%d < %d", nModifiedFees, mempoolRejectFee));
+                false, strprintf("%d < %d", ws.nModifiedFees, mempoolRejectFee));
         }
 
         // Check again against the next block's script verification flags
@@ -748,9 +813,9 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
         // invalid blocks (using TestBlockValidity), however allowing such
         // transactions into the mempool can be exploited as a DoS attack.
         int nSigChecksConsensus;
-        if (!CheckInputsFromMempoolAndCache(tx, state, view, pool,
-                                            nextBlockScriptVerifyFlags, true,
-                                            txdata, nSigChecksConsensus)) {
+        if (!CheckInputsFromMempoolAndCache(tx, state, ws.view, pool,
+                                            ws.nextBlockScriptVerifyFlags, true,
+                                            ws.txdata, nSigChecksConsensus)) {
             // This can occur under some circumstances, if the node receives an
             // unrequested tx which is invalid due to new consensus rules not
             // being activated yet (during IBD).
@@ -759,7 +824,7 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
                          __func__, txid.ToString(), FormatStateMessage(state));
         }
 
-        if (nSigChecksStandard != nSigChecksConsensus) {
+        if (ws.nSigChecksStandard != nSigChecksConsensus) {
             // We can't accept this transaction as we've used the standard count
             // for the mempool/mining, but the consensus count will be enforced
             // in validation (we don't want to produce bad block templates).
@@ -810,6 +875,7 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
     GetMainSignals().TransactionAddedToMempool(ptx);
 
     // Handle double spend proof orphans (if any)
+    auto &rescuedDSPOrphans = ws.rescuedDSPOrphans;
     if (!rescuedDSPOrphans.empty()) {
         std::vector<NodeId> badProofNodeIds;
         for (auto it = rescuedDSPOrphans.begin(); it != rescuedDSPOrphans.end(); ++it) {
@@ -858,6 +924,39 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
     return true;
 }
 
+static bool
+AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
+                         CValidationState &state, const CTransactionRef &ptx,
+                         bool *pfMissingInputs, int64_t nAcceptTime,
+                         bool bypass_limits, const Amount nAbsurdFee,
+                         std::vector<COutPoint> &coins_to_uncache,
+                         bool test_accept, uint64_t *pEntryId) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    AssertLockHeld(cs_main);
+
+    // mempool "read lock" (held through
+    // GetMainSignals().TransactionAddedToMempool())
+    LOCK(pool.cs);
+    // Publish the addition and any trimming that comes with it at once
+    CTxMemPool::SnapshotBatch snapshotBatch(pool);
+
+    if (pfMissingInputs) {
+        *pfMissingInputs = false;
+    }
+    if (pEntryId) {
+        *pEntryId = 0;
+    }
+
+    MempoolAcceptWorkspace ws(ptx, nAcceptTime, state, coins_to_uncache);
+    CCoinsViewMemPool viewMemPool(pcoinsTip.get(), pool);
+    const bool accepted = PreChecks(config, pool, ws, viewMemPool, bypass_limits, nAbsurdFee, test_accept) &&
+                          PolicyScriptChecks(ws) &&
+                          Finalize(config, pool, ws, bypass_limits, test_accept, pEntryId);
+    if (pfMissingInputs) {
+        *pfMissingInputs = ws.fMissingInputs;
+    }
+    return accepted;
+}
+
 /**
  * (try to) add transaction to memory pool with a specified acceptance time.
  */
@@ -895,6 +994,184 @@ bool AcceptToMemoryPool(const Config &config, CTxMemPool &pool,
                                       test_accept, pEntryId);
 }
 
+namespace {
+/**
+ * Makes the transactions of an AcceptToMemoryPoolBatch() round that passed
+ * PreChecks() look like mempool transactions to the ones after them in the
+ * same round, so that chains of unconfirmed transactions need not be split
+ * over as many rounds as they are long.
+ */
+class CCoinsViewBatch : public CCoinsViewBacked {
+    std::unordered_map<TxId, CTransactionRef, SaltedTxIdHasher> m_txs;
+
+public:
+    explicit CCoinsViewBatch(CCoinsView *baseIn) : CCoinsViewBacked(baseIn) {}
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override {
+        if (auto it = m_txs.find(outpoint.GetTxId()); it != m_txs.end()) {
+            const CTransaction &tx = *it->second;
+            if (outpoint.GetN() < tx.vout.size()) {
+                coin = Coin(tx.vout[outpoint.GetN()], MEMPOOL_HEIGHT, false);
+                return true;
+            }
+            return false;
+        }
+        return base->GetCoin(outpoint, coin);
+    }
+
+    void AddTx(const CTransactionRef &ptx) { m_txs.emplace(ptx->GetId(), ptx); }
+    bool HaveTx(const TxId &txid) const { return m_txs.count(txid) != 0; }
+};
+
+/** Upper bound on the number of transactions AcceptToMemoryPoolBatch() works on at a time. */
+constexpr size_t MAX_BATCH_ROUND_SIZE = 256;
+} // namespace
+
+static void RunPolicyScriptChecks(std::vector<CScriptCheck> &vChecks);
+
+/**
+ * @returns true if the PreChecks() verdict for `ws` may have been invalidated
+ * by an earlier transaction in the same round: it was a duplicate, it
+ * conflicted, or it spent the outputs of a transaction that did not make it
+ * into the mempool after all.
+ */
+static bool NeedsAnotherRound(const CTxMemPool &pool, const MempoolAcceptWorkspace &ws,
+                              const CCoinsViewBatch &batchView) EXCLUSIVE_LOCKS_REQUIRED(pool.cs) {
+    AssertLockHeld(pool.cs);
+
+    const CTransaction &tx = *ws.ptx;
+    if (pool.exists(tx.GetId())) {
+        return true;
+    }
+    for (const CTxIn &txin : tx.vin) {
+        if (pool.mapNextTx.count(txin.prevout)) {
+            return true;
+        }
+        if (batchView.HaveTx(txin.prevout.GetTxId()) && !pool.exists(txin.prevout.GetTxId())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AcceptToMemoryPoolBatch(const Config &config, CTxMemPool &pool, std::vector<MempoolAcceptBatchEntry> &entries,
+                             bool bypass_limits, const Amount nAbsurdFee) {
+    AssertLockHeld(cs_main);
+
+    std::vector<std::vector<COutPoint>> coins_to_uncache(entries.size());
+    {
+        LOCK(pool.cs);
+        // Readers of the mempool snapshot get to see the whole batch at once
+        CTxMemPool::SnapshotBatch snapshotBatch(pool);
+
+        std::deque<size_t> pending;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            pending.push_back(i);
+        }
+        // Transactions with missing inputs are tried again once everything
+        // else is done, if anything was accepted in the meantime.
+        std::vector<size_t> missingInputs;
+        bool acceptedSinceMissing = false;
+
+        while (!pending.empty()) {
+            const size_t roundSize = std::min(pending.size(), MAX_BATCH_ROUND_SIZE);
+            const std::vector<size_t> round(pending.begin(), pending.begin() + roundSize);
+            pending.erase(pending.begin(), pending.begin() + roundSize);
+
+            CCoinsViewMemPool viewMemPool(pcoinsTip.get(), pool);
+            CCoinsViewBatch batchView(&viewMemPool);
+            std::vector<std::pair<size_t, std::unique_ptr<MempoolAcceptWorkspace>>> passed;
+            passed.reserve(round.size());
+
+            // Stage 1, serial: everything up to script verification.
+            for (const size_t i : round) {
+                MempoolAcceptBatchEntry &entry = entries[i];
+                entry.state = CValidationState();
+                auto ws = std::make_unique<MempoolAcceptWorkspace>(entry.tx, entry.nAcceptTime, entry.state,
+                                                                   coins_to_uncache[i]);
+                if (!PreChecks(config, pool, *ws, batchView, bypass_limits, nAbsurdFee, false /* test_accept */)) {
+                    entry.fMissingInputs = ws->fMissingInputs;
+                    if (entry.fMissingInputs) {
+                        missingInputs.push_back(i);
+                    }
+                    continue;
+                }
+                entry.fMissingInputs = false;
+                batchView.AddTx(entry.tx);
+                passed.emplace_back(i, std::move(ws));
+            }
+
+            // Stage 2, parallel: PolicyScriptChecks() for the whole round,
+            // with the checks of each transaction reporting to its workspace.
+            std::vector<CScriptCheck> vChecks;
+            std::vector<MempoolAcceptWorkspace *> checked;
+            for (auto &[i, ws] : passed) {
+                CValidationState stateDummy;
+                int nSigChecksCached = 0;
+                std::vector<CScriptCheck> txChecks;
+                if (!CheckInputs(*ws->ptx, stateDummy, ws->view, true, ws->scriptVerifyFlags, true, false,
+                                 ws->txdata, nSigChecksCached, ws->policySigChecks, nullptr, &txChecks)) {
+                    continue;
+                }
+                if (txChecks.empty()) {
+                    // Script cache hit
+                    ws->nSigChecksStandard = nSigChecksCached;
+                    ws->fPolicyScriptsVerified = true;
+                    continue;
+                }
+                for (CScriptCheck &check : txChecks) {
+                    check.ReportTo(ws->scriptCheckOutcome);
+                    vChecks.push_back(std::move(check));
+                }
+                checked.push_back(ws.get());
+            }
+            RunPolicyScriptChecks(vChecks);
+            for (MempoolAcceptWorkspace *ws : checked) {
+                if (!ws->scriptCheckOutcome.fFailed) {
+                    ws->nSigChecksStandard = ws->scriptCheckOutcome.nSigChecks;
+                    ws->fPolicyScriptsVerified = true;
+                }
+            }
+
+            // Stage 3, serial: the insertion into the mempool. Transactions
+            // that failed stage 2 go through PolicyScriptChecks() again, which
+            // fills in their state with the reason.
+            std::vector<size_t> retry;
+            for (auto &[i, ws] : passed) {
+                if (NeedsAnotherRound(pool, *ws, batchView)) {
+                    retry.push_back(i);
+                    continue;
+                }
+                MempoolAcceptBatchEntry &entry = entries[i];
+                entry.fAccepted = (ws->fPolicyScriptsVerified || PolicyScriptChecks(*ws)) &&
+                                  Finalize(config, pool, *ws, bypass_limits, false /* test_accept */, &entry.entryId);
+                acceptedSinceMissing |= entry.fAccepted;
+            }
+
+            pending.insert(pending.begin(), retry.begin(), retry.end());
+            if (pending.empty() && acceptedSinceMissing && !missingInputs.empty()) {
+                pending.assign(missingInputs.begin(), missingInputs.end());
+                missingInputs.clear();
+                acceptedSinceMissing = false;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!entries[i].fAccepted) {
+            for (const COutPoint &outpoint : coins_to_uncache[i]) {
+                pcoinsTip->Uncache(outpoint);
+            }
+        }
+    }
+
+    // After we've (potentially) uncached entries, ensure our coins cache is
+    // still within its size limits
+    CValidationState stateDummy;
+    FlushStateToDisk(config.GetChainParams(), stateDummy,
+                     FlushStateMode::PERIODIC);
+}
+
 /**
  * Find a transaction with the given txid in a block.
  * Returns index of `txid` in the block if found or a nullopt if not found.
@@ -1221,15 +1498,16 @@ void UpdateCoins(CCoinsViewCache &view, const CTransaction &tx, int nHeight) {
     AddCoins(view, tx, nHeight);
 }
 
-bool CScriptCheck::operator()() {
+bool CScriptCheck::VerifyScript(DeferredSignatures *deferred) {
     assert(bool(context));
     assert(bool(context->tx().constantTx()));
 
-    if ( ! VerifyScript(context->scriptSig(), context->coinScriptPubKey(), nFlags,
-                        CachingTransactionSignatureChecker(*context, cacheStore, txdata),
-                        metrics, &error)) {
-        return false;
-    }
+    return ::VerifyScript(context->scriptSig(), context->coinScriptPubKey(), nFlags,
+                          CachingTransactionSignatureChecker(*context, cacheStore, txdata, deferred),
+                          metrics, &error);
+}
+
+bool CScriptCheck::ConsumeSigChecks() {
     if ((pTxLimitSigChecks &&
          !pTxLimitSigChecks->consume_and_check(metrics.GetSigChecks())) ||
         (pBlockLimitSigChecks &&
@@ -1243,6 +1521,65 @@ bool CScriptCheck::operator()() {
     return true;
 }
 
+bool CScriptCheck::Report(bool fOk) {
+    if (!pOutcome) {
+        return fOk;
+    }
+    if (fOk) {
+        pOutcome->nSigChecks += metrics.GetSigChecks();
+    } else {
+        pOutcome->fFailed = true;
+    }
+    return true;
+}
+
+bool CScriptCheck::operator()() {
+    return Report(VerifyScript(nullptr) && ConsumeSigChecks());
+}
+
+bool CScriptCheck::RunBatch(std::vector<CScriptCheck> &checks) {
+    DeferredSignatures deferred;
+    std::vector<size_t> deferring;
+    // Only checks that report to an outcome can fail without failing the batch
+    std::vector<bool> verified(checks.size(), true);
+    for (size_t i = 0; i < checks.size(); ++i) {
+        CScriptCheck &check = checks[i];
+        // Without NULLFAIL, scripts may legitimately contain bad signatures, which would make the batch fail
+        const bool fDefer = check.nFlags & SCRIPT_VERIFY_NULLFAIL;
+        const size_t nDeferred = deferred.size();
+        if (!check.VerifyScript(fDefer ? &deferred : nullptr)) {
+            // A deferred signature may be what made it fail, so only running it without deferring tells
+            deferred.resize(nDeferred);
+            if (!fDefer || !check.VerifyScript(nullptr)) {
+                if (!check.pOutcome) {
+                    return false;
+                }
+                verified[i] = false;
+            }
+        } else if (deferred.size() > nDeferred) {
+            deferring.push_back(i);
+        }
+    }
+    if (!deferred.Verify()) {
+        // At least one of the signatures is bad, so one of the checks that deferred them must fail
+        for (const size_t i : deferring) {
+            if (!checks[i].VerifyScript(nullptr)) {
+                if (!checks[i].pOutcome) {
+                    return false;
+                }
+                verified[i] = false;
+            }
+        }
+    }
+    // The sigchecks are counted by the interpreter, no matter whether the signatures were deferred
+    for (size_t i = 0; i < checks.size(); ++i) {
+        if (!checks[i].Report(verified[i] && checks[i].ConsumeSigChecks())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 int GetSpendHeight(const CCoinsViewCache &inputs) {
     LOCK(cs_main);
     CBlockIndex *pindexPrev = LookupBlockIndex(inputs.GetBestBlock());
@@ -1256,7 +1593,6 @@ bool CheckInputs(const CTransaction &tx, CValidationState &state,
                  TxSigCheckLimiter &txLimitSigChecks,
                  CheckInputsLimiter *pBlockLimitSigChecks,
                  std::vector<CScriptCheck> *pvChecks) {
-    AssertLockHeld(cs_main);
     assert(!tx.IsCoinBase());
 
     if (pvChecks) {
@@ -1475,14 +1811,128 @@ DisconnectResult ApplyBlockUndo(CBlockUndo &&blockUndo, const CBlock &block, con
 
 static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
 
+namespace {
+/** One block input to be read from the coins database by a prefetch worker. */
+struct PrefetchedCoin {
+    COutPoint outpoint;
+    Coin coin;
+    bool found = false;
+
+    explicit PrefetchedCoin(const COutPoint &outpointIn) : outpoint(outpointIn) {}
+};
+
+/**
+ * Closure representing one coin lookup for the input prefetch queue. The
+ * result is written to a slot owned by the thread that queued the work, so no
+ * locking is needed beyond what the coins database does internally.
+ */
+class CCoinsPrefetchCheck {
+    const CCoinsView *pdb{};
+    PrefetchedCoin *pslot{};
+
+public:
+    CCoinsPrefetchCheck() = default;
+    CCoinsPrefetchCheck(const CCoinsView &db, PrefetchedCoin &slot) : pdb(&db), pslot(&slot) {}
+
+    bool operator()() {
+        try {
+            pslot->found = pdb->GetCoin(pslot->outpoint, pslot->coin);
+        } catch (const std::exception &) {
+            // Leave it to the serial connect loop to run into (and properly
+            // report) the database error.
+            pslot->found = false;
+        }
+        return true;
+    }
+};
+} // namespace
+
+static CCheckQueue<CCoinsPrefetchCheck> coinsprefetchqueue(16);
+//! Number of coinsprefetchqueue worker threads, 0 disables prefetching.
+static std::atomic<int> nCoinsPrefetchThreads{0};
+
+/**
+ * Run the script checks of a round of AcceptToMemoryPoolBatch() on the script
+ * check threads, or on the calling thread if there are none. Each check reports
+ * to the workspace of its transaction, so the queue itself never fails.
+ */
+static void RunPolicyScriptChecks(std::vector<CScriptCheck> &vChecks) {
+    if (vChecks.empty()) {
+        return;
+    }
+    CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+    control.Add(vChecks);
+    control.Wait();
+}
+
 void StartScriptCheckWorkerThreads(int threads_num) {
     scriptcheckqueue.StartWorkerThreads(threads_num);
+    coinsprefetchqueue.StartWorkerThreads(threads_num, "prefetch");
+    nCoinsPrefetchThreads = threads_num;
 }
 
 void StopScriptCheckWorkerThreads() {
+    nCoinsPrefetchThreads = 0;
+    coinsprefetchqueue.StopWorkerThreads();
     scriptcheckqueue.StopWorkerThreads();
 }
 
+/**
+ * Warm `coinsCache` with the coins spent by `block` that are neither in `view`
+ * nor in `coinsCache` yet, so that the serial loop in ConnectBlock() does not
+ * stall on one cold coins database read after another. `view` must be
+ * `coinsCache` or a view on top of it, and `coinsDB` the database below it.
+ * The reads are spread over the prefetch worker threads, and the results are
+ * inserted into `coinsCache` on the calling thread once all of them are done.
+ *
+ * This is purely a cache warming step: entries that are absent from
+ * `coinsCache` are by definition unmodified relative to the database, so
+ * inserting them as clean entries does not change the state any view
+ * represents.
+ *
+ * @returns the number of coins that were looked up in the database.
+ */
+static size_t PrefetchBlockInputs(const CBlock &block, const CCoinsViewCache &view, CCoinsViewCache &coinsCache,
+                                  const CCoinsView &coinsDB) {
+    if (nCoinsPrefetchThreads <= 0) {
+        return 0;
+    }
+
+    std::vector<PrefetchedCoin> slots;
+    for (const auto &ptx : block.vtx) {
+        if (ptx->IsCoinBase()) {
+            continue;
+        }
+        for (const auto &txin : ptx->vin) {
+            // Outputs created earlier in this block are already in `view`
+            if (!view.HaveCoinInCache(txin.prevout) && !coinsCache.HaveCoinInCache(txin.prevout)) {
+                slots.emplace_back(txin.prevout);
+            }
+        }
+    }
+    if (slots.empty()) {
+        return 0;
+    }
+
+    {
+        std::vector<CCoinsPrefetchCheck> vChecks;
+        vChecks.reserve(slots.size());
+        for (auto &slot : slots) {
+            vChecks.emplace_back(coinsDB, slot);
+        }
+        CCheckQueueControl<CCoinsPrefetchCheck> control(&coinsprefetchqueue);
+        control.Add(vChecks);
+        control.Wait();
+    }
+
+    for (auto &slot : slots) {
+        if (slot.found) {
+            coinsCache.EmplaceFetchedCoin(slot.outpoint, std::move(slot.coin));
+        }
+    }
+    return slots.size();
+}
+
 int32_t ComputeBlockVersion(const CBlockIndex *pindexPrev,
                             const Consensus::Params &params) {
     return VERSIONBITS_TOP_BITS;
@@ -1620,7 +2070,9 @@ static void MaintainAblaState(const Consensus::Params &consensusParams, const CB
 static int64_t nTimeCheck = 0;
 static int64_t nTimeForks = 0;
 static int64_t nTimeVerify = 0;
+static int64_t nTimeQueueWait = 0;
 static int64_t nTimeConnect = 0;
+static int64_t nTimePrefetch = 0;
 static int64_t nTimeIndex = 0;
 static int64_t nTimeCallbacks = 0;
 static int64_t nTimeTotal = 0;
@@ -1631,12 +2083,23 @@ static int64_t nBlocksTotal = 0;
  * represented by coins. Validity checks that depend on the UTXO set are also
  * done; ConnectBlock() can fail if those validity checks fail (among other
  * reasons).
+ *
+ * `coinsCache` and `coinsDB` are the coins cache that `view` is built on (or
+ * `view` itself) and the database below it, which the inputs of the block are
+ * prefetched from.
+ *
+ * If `lockMain` (the caller's lock on cs_main) is given, cs_main is released
+ * while the transactions are connected and their scripts are verified. The
+ * caller must be the only user of `view` then.
  */
 bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
                                CBlockIndex *pindex, CCoinsViewCache &view,
+                               CCoinsViewCache &coinsCache,
+                               const CCoinsView &coinsDB,
                                const CChainParams &params,
                                BlockValidationOptions options,
-                               bool fJustCheck) {
+                               bool fJustCheck,
+                               UniqueLock<RecursiveMutex> *lockMain) {
     AssertLockHeld(cs_main);
     assert(pindex);
     assert(*pindex->phashBlock == block.GetHash());
@@ -1817,8 +2280,18 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
     CBlockUndo blockundo;
     blockundo.vtxundo.resize(block.vtx.size() - 1);
 
-    CCheckQueueControl<CScriptCheck> control(fScriptChecks ? &scriptcheckqueue
-                                                           : nullptr);
+    // From here on until the scripts are verified only `view` and the block
+    // index entries of the block and its ancestors are used. The pprev,
+    // heights and times of those never change (SequenceLocks() relies on
+    // that), so cs_main can be released if the caller allows it. The script
+    // check queue is released before cs_main is taken again, as every other
+    // user of the queue holds cs_main while waiting for it.
+    std::optional<UniqueLock<RecursiveMutex>::reverse_lock> unlockMain;
+    if (lockMain) {
+        unlockMain.emplace(*lockMain, "cs_main", __FILE__, __LINE__);
+    }
+    std::optional<CCheckQueueControl<CScriptCheck>> control;
+    control.emplace(fScriptChecks ? &scriptcheckqueue : nullptr);
 
     // Add all outputs
     try {
@@ -1839,6 +2312,12 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
             REJECT_INVALID, "tx-duplicate");
     }
 
+    // Pull all the coins this block spends in from the coins database in
+    // parallel, instead of one by one in the loop below.
+    const int64_t nTimePrefetchStart = GetTimeMicros();
+    const size_t nPrefetched = PrefetchBlockInputs(block, view, coinsCache, coinsDB);
+    const int64_t nTimePrefetchEnd = GetTimeMicros();
+
     int64_t firstTokenBlockHeight;
     if (flags & SCRIPT_ENABLE_TOKENS) { // Assumption: this can only be true if Upgrade9 is activated for pindex->pprev
         // First block to actually use token rules is 1 + activation block
@@ -1928,7 +2407,7 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
                          tx.GetId().ToString(), FormatStateMessage(state));
         }
 
-        control.Add(vChecks);
+        control->Add(vChecks);
 
         // Note: this must execute in the same iteration as CheckTxInputs (not
         // in a separate loop) in order to detect double spends. However,
@@ -1940,14 +2419,6 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
     }
 
     int64_t nTime3 = GetTimeMicros();
-    nTimeConnect += nTime3 - nTime2;
-    LogPrint(BCLog::BENCH,
-             "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) "
-             "[%.2fs (%.2fms/blk)]\n",
-             (unsigned)block.vtx.size(), MILLI * (nTime3 - nTime2),
-             MILLI * (nTime3 - nTime2) / block.vtx.size(),
-             nInputs <= 1 ? 0 : MILLI * (nTime3 - nTime2) / (nInputs - 1),
-             nTimeConnect * MICRO, nTimeConnect * MILLI / nBlocksTotal);
 
     Amount blockReward =
         nFees + GetBlockSubsidy(pindex->nHeight, consensusParams);
@@ -1959,12 +2430,29 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
                          REJECT_INVALID, "bad-cb-amount");
     }
 
-    if (!control.Wait()) {
+    if (!control->Wait()) {
         return state.DoS(100, false, REJECT_INVALID, "blk-bad-inputs", false,
                          "parallel script check failed");
     }
 
     int64_t nTime4 = GetTimeMicros();
+    const CCheckQueueStats queueStats = control->GetStats();
+    control.reset();
+    unlockMain.reset();
+
+    // The bench counters are only updated under cs_main
+    nTimePrefetch += nTimePrefetchEnd - nTimePrefetchStart;
+    LogPrint(BCLog::BENCH, "      - Prefetch %u inputs: %.2fms [%.2fs (%.2fms/blk)]\n",
+             nPrefetched, MILLI * (nTimePrefetchEnd - nTimePrefetchStart), nTimePrefetch * MICRO,
+             nTimePrefetch * MILLI / nBlocksTotal);
+    nTimeConnect += nTime3 - nTime2;
+    LogPrint(BCLog::BENCH,
+             "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) "
+             "[%.2fs (%.2fms/blk)]\n",
+             (unsigned)block.vtx.size(), MILLI * (nTime3 - nTime2),
+             MILLI * (nTime3 - nTime2) / block.vtx.size(),
+             nInputs <= 1 ? 0 : MILLI * (nTime3 - nTime2) / (nInputs - 1),
+             nTimeConnect * MICRO, nTimeConnect * MILLI / nBlocksTotal);
     nTimeVerify += nTime4 - nTime2;
     LogPrint(
         BCLog::BENCH,
@@ -1972,6 +2460,11 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
         nInputs - 1, MILLI * (nTime4 - nTime2),
         nInputs <= 1 ? 0 : MILLI * (nTime4 - nTime2) / (nInputs - 1),
         nTimeVerify * MICRO, nTimeVerify * MILLI / nBlocksTotal);
+    nTimeQueueWait += queueStats.nMasterWaitMicros;
+    LogPrint(BCLog::BENCH,
+             "      - Script check queue: %u checks, %u steals (%u checks), wait %.2fms [%.2fs (%.2fms/blk)]\n",
+             queueStats.nChecks, queueStats.nSteals, queueStats.nStolenChecks,
+             MILLI * queueStats.nMasterWaitMicros, nTimeQueueWait * MICRO, nTimeQueueWait * MILLI / nBlocksTotal);
 
     if (fJustCheck) {
         return true;
@@ -2537,7 +3030,8 @@ bool CChainState::ConnectTip(const Config &config, CValidationState &state,
              (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO);
     {
         CCoinsViewCache view(pcoinsTip.get());
-        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, params,
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view,
+                               *pcoinsTip, *pcoinsdbview, params,
                                BlockValidationOptions(config));
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
@@ -3489,6 +3983,18 @@ CBlockIndex *CChainState::AddToBlockIndex(const CBlockHeader &block) {
 void CChainState::ReceivedBlockTransactions(const CBlock &block,
                                             CBlockIndex *pindexNew,
                                             const FlatFilePos &pos) {
+    if (IsBlockFromSnapshot(pindexNew)) {
+        // Downloaded for validating the history below a UTXO snapshot. The
+        // block was linked (with a placeholder transaction count) when the
+        // snapshot was activated, so only record where its data is.
+        pindexNew->nFile = pos.nFile;
+        pindexNew->nDataPos = pos.nPos;
+        pindexNew->nUndoPos = 0;
+        pindexNew->nStatus = pindexNew->nStatus.withData();
+        setDirtyBlockIndex.insert(pindexNew);
+        return;
+    }
+
     pindexNew->nTx = block.vtx.size();
     pindexNew->nChainTx = 0;
     pindexNew->nFile = pos.nFile;
@@ -4159,8 +4665,10 @@ bool CChainState::AcceptBlock(const Config &config,
     // last minute so we can make sure everything is ready to be reorged if
     // needed.
     if (gArgs.GetBoolArg("-parkdeepreorg", DEFAULT_PARK_DEEP_REORG)) {
+        // Blocks of the active chain (below a UTXO snapshot) don't reorg it.
         const CBlockIndex *pindexFork = m_chain.FindFork(pindex);
-        if (pindexFork && pindexFork->nHeight + 1 < m_chain.Height()) {
+        if (pindexFork && pindexFork != pindex &&
+            pindexFork->nHeight + 1 < m_chain.Height()) {
             LogPrintf("Park block %s as it would cause a deep reorg.\n",
                       pindex->GetBlockHash().ToString());
             pindex->nStatus = pindex->nStatus.withParked();
@@ -4279,7 +4787,8 @@ bool TestBlockValidity(CValidationState &state, const CChainParams &params,
                      FormatStateMessage(state));
     }
 
-    if (!g_chainstate.ConnectBlock(block, state, &indexDummy, viewNew, params,
+    if (!g_chainstate.ConnectBlock(block, state, &indexDummy, viewNew,
+                                   *pcoinsTip, *pcoinsdbview, params,
                                    validationOptions, true)) {
         return false;
     }
@@ -4325,6 +4834,24 @@ void PruneOneBlockFile(const int fileNumber) {
     setDirtyFileInfo.insert(fileNumber);
 }
 
+/**
+ * Lower the height up to which block files may be pruned, so that the blocks
+ * that the validation of the history below a UTXO snapshot still needs are
+ * kept.
+ */
+static unsigned int ApplySnapshotPruneLock(unsigned int nLastBlockWeCanPrune)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    if (!pindexSnapshotBase) {
+        return nLastBlockWeCanPrune;
+    }
+    const int nValidatedHeight =
+        utxosync::g_background_validation
+            ? utxosync::g_background_validation->GetHeight()
+            : -1;
+    return std::min<int64_t>(nLastBlockWeCanPrune,
+                             std::max(nValidatedHeight, 0));
+}
+
 /**
  * Calculate the block/rev files to delete based on height specified by user
  * with RPC command pruneblockchain
@@ -4340,9 +4867,9 @@ static void FindFilesToPruneManual(std::set<int> &setFilesToPrune,
 
     // last block to prune is the lesser of (user-specified height,
     // MIN_BLOCKS_TO_KEEP from the tip)
-    unsigned int nLastBlockWeCanPrune =
+    unsigned int nLastBlockWeCanPrune = ApplySnapshotPruneLock(
         std::min((unsigned)nManualPruneHeight,
-                 ::ChainActive().Tip()->nHeight - MIN_BLOCKS_TO_KEEP);
+                 ::ChainActive().Tip()->nHeight - MIN_BLOCKS_TO_KEEP));
     int count = 0;
     for (int fileNumber = 0; fileNumber < nLastBlockFile; fileNumber++) {
         if (vinfoBlockFile[fileNumber].nSize == 0 ||
@@ -4399,8 +4926,8 @@ static void FindFilesToPrune(std::set<int> &setFilesToPrune,
         return;
     }
 
-    unsigned int nLastBlockWeCanPrune =
-        ::ChainActive().Tip()->nHeight - MIN_BLOCKS_TO_KEEP;
+    unsigned int nLastBlockWeCanPrune = ApplySnapshotPruneLock(
+        ::ChainActive().Tip()->nHeight - MIN_BLOCKS_TO_KEEP);
     uint64_t nCurrentUsage = CalculateCurrentUsage();
     // We don't check to prune until after we've allocated new space for files,
     // so we should leave a buffer under our target to account for another
@@ -4616,6 +5143,18 @@ static bool LoadBlockIndexDB(const Config &config)
             "LoadBlockIndexDB(): Block files have previously been pruned\n");
     }
 
+    // Check whether the chainstate was loaded from a UTXO snapshot
+    BlockHash hashSnapshotBase;
+    if (uint256 ecmh; pblocktree->ReadSnapshotBase(hashSnapshotBase, ecmh)) {
+        pindexSnapshotBase = LookupBlockIndex(hashSnapshotBase);
+        if (!pindexSnapshotBase) {
+            return error("%s: UTXO snapshot base block %s is missing from the block database", __func__,
+                         hashSnapshotBase.ToString());
+        }
+        LogPrintf("LoadBlockIndexDB(): Chainstate was loaded from a UTXO snapshot at height %d\n",
+                  pindexSnapshotBase->nHeight);
+    }
+
     // Check whether we need to continue reindexing
     if (pblocktree->IsReindexing()) {
         fReindex = true;
@@ -4640,6 +5179,10 @@ static bool VerifyAblaStateForChain(const Config &config, CChain &chain) EXCLUSI
     const bool doSlowCheck = gArgs.GetBoolArg("-check-abla", DEFAULT_ABLA_SLOW_CHECKS);
     const CBlockIndex *pbase = chain[GetUpgrade10ActivationHeight(consensus)];
     assert(pbase != nullptr);
+    if (pindexSnapshotBase && chain.Contains(pindexSnapshotBase) && pindexSnapshotBase->nHeight > pbase->nHeight) {
+        // The blocks below a UTXO snapshot were never downloaded; its base got its ABLA state from the snapshot
+        pbase = pindexSnapshotBase;
+    }
     LogPrintf("%s: Verifying %i %s have correct ABLA state%s ...\n",
               __func__, ptip->nHeight - pbase->nHeight + 1, doSlowCheck ? "blocks" : "block headers",
               doSlowCheck ? " (thorough checks requested)" : "");
@@ -4805,11 +5348,15 @@ bool CVerifyDB::VerifyDB(const Config &config, CCoinsView *coinsview,
             break;
         }
 
-        if (fPruneMode && !pindex->nStatus.hasData()) {
-            // If pruning, only go back as far as we have data.
+        if ((fPruneMode && !pindex->nStatus.hasData()) ||
+            (IsBlockFromSnapshot(pindex) && !pindex->nStatus.hasUndo())) {
+            // If pruning, only go back as far as we have data. Below a UTXO
+            // snapshot, only go back as far as the history was validated.
             LogPrintf("VerifyDB(): block verification stopping at height %d "
-                      "(pruning, no data)\n",
-                      pindex->nHeight);
+                      "(%s)\n",
+                      pindex->nHeight,
+                      IsBlockFromSnapshot(pindex) ? "UTXO snapshot"
+                                                  : "pruning, no data");
             break;
         }
 
@@ -4899,7 +5446,8 @@ bool CVerifyDB::VerifyDB(const Config &config, CCoinsView *coinsview,
                     "VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s",
                     pindex->nHeight, pindex->GetBlockHash().ToString());
             }
-            if (!g_chainstate.ConnectBlock(block, state, pindex, coins, params,
+            if (!g_chainstate.ConnectBlock(block, state, pindex, coins, coins,
+                                           *coinsview, params,
                                            BlockValidationOptions(config))) {
                 return error("VerifyDB(): *** found unconnectable block at %d, "
                              "hash=%s (%s)",
@@ -5085,6 +5633,7 @@ void UnloadBlockIndex(const Config &config) {
 
     mapBlockIndex.clear();
     fHavePruned = false;
+    pindexSnapshotBase = nullptr;
 
     g_chainstate.UnloadBlockIndex();
 }
@@ -5145,6 +5694,133 @@ bool LoadGenesisBlock(const CChainParams &chainparams) {
     return g_chainstate.LoadGenesisBlock(chainparams);
 }
 
+bool CChainState::ActivateSnapshot(const Config &config,
+                                   CBlockIndex *pindexBase, uint64_t nChainTx,
+                                   const std::optional<abla::State> &ablaState,
+                                   const uint256 &ecmh) {
+    AssertLockHeld(cs_main);
+    const Consensus::Params &consensusParams =
+        config.GetChainParams().GetConsensus();
+
+    if (pcoinsdbview->GetBestBlock() != pindexBase->GetBlockHash()) {
+        return error("%s: the coins database is not at the snapshot base",
+                     __func__);
+    }
+    if (IsUpgrade10Enabled(consensusParams, pindexBase) !=
+            ablaState.has_value() ||
+        (ablaState && !ablaState->IsValid(consensusParams.ablaConfig))) {
+        return error("%s: bad ABLA state for the snapshot base", __func__);
+    }
+
+    std::vector<CBlockIndex *> vChain(pindexBase->nHeight + 1);
+    for (CBlockIndex *pindex = pindexBase; pindex; pindex = pindex->pprev) {
+        vChain[pindex->nHeight] = pindex;
+    }
+
+    // The ancestors of the base are treated like pruned blocks: they have
+    // transactions (a placeholder count, except for the base, which makes up
+    // the snapshot's nChainTx) and are valid, but their data is missing.
+    for (CBlockIndex *pindex : vChain) {
+        const uint64_t nPrevChainTx =
+            pindex->pprev ? pindex->pprev->nChainTx : 0;
+        if (pindex->nTx == 0) {
+            pindex->nTx = pindex == pindexBase && nChainTx > nPrevChainTx + 1
+                              ? nChainTx - nPrevChainTx
+                              : 1;
+        }
+        pindex->nChainTx = nPrevChainTx + pindex->nTx;
+        pindex->RaiseValidity(BlockValidity::SCRIPTS);
+        setDirtyBlockIndex.insert(pindex);
+
+        // Blocks of this chain which we do have are linked now
+        auto range = mapBlocksUnlinked.equal_range(pindex->pprev);
+        while (range.first != range.second) {
+            if (range.first->second == pindex) {
+                range.first = mapBlocksUnlinked.erase(range.first);
+            } else {
+                ++range.first;
+            }
+        }
+    }
+    if (ablaState) {
+        pindexBase->SetAblaStateOpt(ablaState);
+    }
+
+    pindexSnapshotBase = pindexBase;
+    if (!pblocktree->WriteSnapshotBase(pindexBase->GetBlockHash(), ecmh)) {
+        return error("%s: failed to write to the block index database",
+                     __func__);
+    }
+
+    const CBlockIndex *pindexOldTip = m_chain.Tip();
+    g_mempool.clear();
+    pcoinsTip->SetBestBlock(pindexBase->GetBlockHash());
+    m_chain.SetTip(pindexBase);
+    UpdateTip(config, pindexBase);
+
+    // Link the blocks we already have on top of the base, like
+    // ReceivedBlockTransactions() does.
+    std::deque<CBlockIndex *> queue{pindexBase};
+    while (!queue.empty()) {
+        CBlockIndex *pindex = queue.front();
+        queue.pop_front();
+        if (pindex != pindexBase) {
+            pindex->nChainTx = pindex->pprev->nChainTx + pindex->nTx;
+            if (pindex->nSequenceId == 0) {
+                pindex->nSequenceId = nBlockSequenceId++;
+            }
+        }
+        if (!setBlockIndexCandidates.value_comp()(pindex, m_chain.Tip())) {
+            setBlockIndexCandidates.insert(pindex);
+        }
+        auto range = mapBlocksUnlinked.equal_range(pindex);
+        for (auto it = range.first; it != range.second; ++it) {
+            queue.push_back(it->second);
+        }
+        mapBlocksUnlinked.erase(range.first, range.second);
+    }
+    PruneBlockIndexCandidates();
+
+    CValidationState state;
+    if (!FlushStateToDisk(config.GetChainParams(), state,
+                          FlushStateMode::ALWAYS)) {
+        return false;
+    }
+    CheckBlockIndex(consensusParams);
+
+    const bool fInitialDownload = IsInitialBlockDownload();
+    GetMainSignals().UpdatedBlockTip(pindexBase, pindexOldTip,
+                                     fInitialDownload);
+    uiInterface.NotifyBlockTip(fInitialDownload, pindexBase);
+    return true;
+}
+
+bool ActivateSnapshotChainstate(const Config &config, CBlockIndex *pindex,
+                                uint64_t nChainTx,
+                                const std::optional<abla::State> &ablaState,
+                                const uint256 &ecmh) {
+    return g_chainstate.ActivateSnapshot(config, pindex, nChainTx, ablaState,
+                                         ecmh);
+}
+
+bool ConnectBlockInBackground(const Config &config, const CBlock &block,
+                              CValidationState &state, CBlockIndex *pindex,
+                              CCoinsViewCache &view, const CCoinsView &coinsDB) {
+    AssertLockNotHeld(cs_main);
+    const BlockValidationOptions options(config);
+    // Check the merkle root and the transactions before taking cs_main, so
+    // that ConnectBlock() finds the block checked already. If they are
+    // invalid, ConnectBlock() checks them again to report that.
+    CValidationState checkState;
+    CheckBlock(block, checkState, config.GetChainParams().GetConsensus(),
+               options);
+
+    WAIT_LOCK(cs_main, lock);
+    return g_chainstate.ConnectBlock(block, state, pindex, view, view, coinsDB,
+                                     config.GetChainParams(), options,
+                                     false /* fJustCheck */, &lock);
+}
+
 void LoadExternalBlockFile(const Config &config, FILE *fileIn,
                            FlatFilePos *dbp) {
     // Map of disk positions for blocks with unknown parent (only used for
@@ -5335,6 +6011,10 @@ void CChainState::CheckBlockIndex(const Consensus::Params &consensusParams) {
     // There is only one index entry with parent nullptr.
     assert(rangeGenesis.first == rangeGenesis.second);
 
+    // The blocks below the base of a UTXO snapshot are missing their data,
+    // just like pruned blocks.
+    const bool fMissingDataAllowed = fHavePruned || pindexSnapshotBase != nullptr;
+
     // Iterate over the entire block tree, using depth-first search.
     // Along the way, remember whether there are blocks on the path from genesis
     // block being explored which are the first to have certain properties.
@@ -5408,7 +6088,7 @@ void CChainState::CheckBlockIndex(const Consensus::Params &consensusParams) {
         // VALID_TRANSACTIONS is equivalent to nTx > 0 for all nodes (whether or
         // not pruning has occurred). HAVE_DATA is only equivalent to nTx > 0
         // (or VALID_TRANSACTIONS) if no pruning has occurred.
-        if (!fHavePruned) {
+        if (!fMissingDataAllowed) {
             // If we've never pruned, then HAVE_DATA should be equivalent to nTx
             // > 0
             assert(pindex->nStatus.hasData() == (pindex->nTx > 0));
@@ -5526,8 +6206,8 @@ void CChainState::CheckBlockIndex(const Consensus::Params &consensusParams) {
             pindexFirstMissing != nullptr) {
             // We HAVE_DATA for this block, have received data for all parents
             // at some point, but we're currently missing data for some parent.
-            // We must have pruned.
-            assert(fHavePruned);
+            // We must have pruned (or loaded a UTXO snapshot).
+            assert(fMissingDataAllowed);
             // This block may have entered mapBlocksUnlinked if:
             //  - it has a descendant that at some point had more work than the
             //    tip, and
@@ -5617,6 +6297,9 @@ void CChainState::CheckBlockIndex(const Consensus::Params &consensusParams) {
 
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
 
+//! Number of mempool.dat transactions handed to AcceptToMemoryPoolBatch() at a time
+static const size_t LOAD_MEMPOOL_BATCH_SIZE = 1000;
+
 bool LoadMempool(const Config &config, CTxMemPool &pool) {
     Tic start;
 
@@ -5645,6 +6328,28 @@ bool LoadMempool(const Config &config, CTxMemPool &pool) {
 
         uint64_t num;
         file >> num;
+        std::vector<MempoolAcceptBatchEntry> batch;
+        const auto acceptBatch = [&] {
+            LOCK(cs_main);
+            AcceptToMemoryPoolBatch(config, pool, batch, false /* bypass_limits */,
+                                    Amount::zero() /* nAbsurdFee */);
+            for (const MempoolAcceptBatchEntry &entry : batch) {
+                if (entry.state.IsValid()) {
+                    ++count;
+                } else {
+                    // mempool may contain the transaction already, e.g. from
+                    // wallet(s) having loaded it while we were processing
+                    // mempool transactions; consider these as valid, instead of
+                    // failed, but mark them as 'already there'
+                    if (pool.exists(entry.tx->GetId())) {
+                        ++already_there;
+                    } else {
+                        ++failed;
+                    }
+                }
+            }
+            batch.clear();
+        };
         while (num--) {
             CTransactionRef tx;
             int64_t nTime;
@@ -5657,25 +6362,10 @@ bool LoadMempool(const Config &config, CTxMemPool &pool) {
             if (amountdelta != Amount::zero()) {
                 pool.PrioritiseTransaction(tx->GetId(), amountdelta);
             }
-            CValidationState state;
             if (nTime + nExpiryTimeout > nNow) {
-                LOCK(cs_main);
-                AcceptToMemoryPoolWithTime(
-                    config, pool, state, tx, nullptr /* pfMissingInputs */,
-                    nTime, false /* bypass_limits */,
-                    Amount::zero() /* nAbsurdFee */, false /* test_accept */);
-                if (state.IsValid()) {
-                    ++count;
-                } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetId())) {
-                        ++already_there;
-                    } else {
-                        ++failed;
-                    }
+                batch.emplace_back(std::move(tx), nTime);
+                if (batch.size() >= LOAD_MEMPOOL_BATCH_SIZE) {
+                    acceptBatch();
                 }
             } else {
                 ++expired;
@@ -5685,6 +6375,7 @@ bool LoadMempool(const Config &config, CTxMemPool &pool) {
                 return false;
             }
         }
+        acceptBatch();
         std::map<TxId, Amount> mapDeltas;
         file >> mapDeltas;
 
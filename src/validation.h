@@ -51,6 +51,7 @@ class CScriptCheck;
 class CTxMemPool;
 class CTxUndo;
 class CValidationState;
+class DeferredSignatures;
 
 struct FlatFilePos;
 struct ChainTxData;
@@ -337,9 +338,33 @@ bool LoadChainTip(const Config &config) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
  */
 void UnloadBlockIndex(const Config &config);
 
-/** Run instances of script checking worker threads */
+/**
+ * Make `pindex` the tip of the active chain, after a UTXO snapshot based at it was loaded into the coins database (see
+ * utxosync/snapshot.h). Its ancestors are marked as valid without their data, as if they had been pruned, until they
+ * are validated in the background (see utxosync/backgroundvalidation.h). `nChainTx` and `ablaState` come from the
+ * snapshot metadata, `ecmh` is the hash of its coins.
+ */
+bool ActivateSnapshotChainstate(const Config &config, CBlockIndex *pindex, uint64_t nChainTx,
+                                const std::optional<abla::State> &ablaState, const uint256 &ecmh)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+/**
+ * Connect `block` (at `pindex`) to `view`, which must be at its parent, without touching the active chain. Used for
+ * validating the history below a UTXO snapshot. `coinsDB` is the database below `view`, which the inputs of the block
+ * are prefetched from into `view`. cs_main is only held while the block is looked at in the context of the block
+ * index, not while its transactions are connected and their scripts verified, so `view` must not be shared.
+ */
+bool ConnectBlockInBackground(const Config &config, const CBlock &block, CValidationState &state, CBlockIndex *pindex,
+                              CCoinsViewCache &view, const CCoinsView &coinsDB) LOCKS_EXCLUDED(cs_main);
+
+/**
+ * Run instances of script checking worker threads, along with the same number
+ * of threads that prefetch block inputs from the coins database before
+ * ConnectBlock() spends them, and of threads that verify the scripts of
+ * AcceptToMemoryPoolBatch() rounds.
+ */
 void StartScriptCheckWorkerThreads(int threads_num);
-/** Stop all of the script checking worker threads */
+/** Stop all of the script checking and input prefetch worker threads */
 void StopScriptCheckWorkerThreads();
 
 /**
@@ -428,6 +453,35 @@ AcceptToMemoryPoolWithTime(const Config &config, CTxMemPool &pool,
                            bool test_accept = false, uint64_t *pEntryId = nullptr)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/** One transaction submitted to AcceptToMemoryPoolBatch(), and its outcome. */
+struct MempoolAcceptBatchEntry {
+    CTransactionRef tx;
+    int64_t nAcceptTime;
+    CValidationState state;
+    //! Same meaning as the pfMissingInputs out param of AcceptToMemoryPool()
+    bool fMissingInputs = false;
+    bool fAccepted = false;
+    //! The mempool entry id if accepted, 0 otherwise
+    uint64_t entryId = 0;
+
+    MempoolAcceptBatchEntry(CTransactionRef txIn, int64_t nAcceptTimeIn)
+        : tx(std::move(txIn)), nAcceptTime(nAcceptTimeIn) {}
+};
+
+/**
+ * (try to) add a number of transactions to the memory pool at once.
+ *
+ * Gives the same results as calling AcceptToMemoryPoolWithTime() for each of
+ * `entries` in order, except that transactions may also spend the outputs of
+ * later transactions in `entries`: those that failed for missing inputs are
+ * retried as long as that makes progress. The scripts of the transactions are
+ * verified in parallel, one transaction per worker thread at a time.
+ */
+void AcceptToMemoryPoolBatch(const Config &config, CTxMemPool &pool,
+                             std::vector<MempoolAcceptBatchEntry> &entries,
+                             bool bypass_limits, const Amount nAbsurdFee)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /** Convert CValidationState to a human-readable message for logging */
 std::string FormatStateMessage(const CValidationState &state);
 
@@ -504,8 +558,7 @@ bool CheckInputs(const CTransaction &tx, CValidationState &state,
                  PrecomputedTransactionData &txdata /* in/out param */, int &nSigChecksOut,
                  TxSigCheckLimiter &txLimitSigChecks,
                  CheckInputsLimiter *pBlockLimitSigChecks,
-                 std::vector<CScriptCheck> *pvChecks)
-    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+                 std::vector<CScriptCheck> *pvChecks);
 
 /**
  * Handy shortcut to full fledged CheckInputs call.
@@ -513,8 +566,7 @@ bool CheckInputs(const CTransaction &tx, CValidationState &state,
 inline bool
 CheckInputs(const CTransaction &tx, CValidationState &state, const CCoinsViewCache &view, bool fScriptChecks,
             const uint32_t flags, bool sigCacheStore, bool scriptCacheStore, PrecomputedTransactionData &txdata /* in/out param */,
-            int &nSigChecksOut)
-    EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+            int &nSigChecksOut) {
     TxSigCheckLimiter nSigChecksTxLimiter;
     return CheckInputs(tx, state, view, fScriptChecks, flags, sigCacheStore,
                        scriptCacheStore, txdata, nSigChecksOut, nSigChecksTxLimiter, nullptr, nullptr);
@@ -548,14 +600,29 @@ bool TestLockPointValidity(const LockPoints *lp)
  * calculated and the hash of the block needed for calculation or skips the
  * calculation and uses the LockPoints passed in for evaluation. The LockPoints
  * should not be considered valid if CheckSequenceLocks returns false.
+ * The coins spent by `tx` are looked up in `coinsView` if given, and in the
+ * mempool and the UTXO set otherwise.
  *
  * See consensus/consensus.h for flag definitions.
  */
 bool CheckSequenceLocks(const CTxMemPool &pool, const CTransaction &tx,
                         int flags, LockPoints *lp = nullptr,
-                        bool useExistingLockPoints = false)
+                        bool useExistingLockPoints = false,
+                        const CCoinsView *coinsView = nullptr)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Where the script checks of one transaction report their outcome when they are
+ * run on the script check queue outside of a block, e.g. for mempool acceptance:
+ * a failing check then only marks its transaction as failed, instead of failing
+ * the whole queue.
+ */
+struct ScriptCheckOutcome {
+    std::atomic<bool> fFailed{false};
+    //! Sigchecks of the checks that succeeded
+    std::atomic<int> nSigChecks{0};
+};
+
 /**
  * Closure representing one script verification.
  * Note that this stores references to the spending transaction.
@@ -574,6 +641,14 @@ class CScriptCheck {
     PrecomputedTransactionData txdata{};
     TxSigCheckLimiter *pTxLimitSigChecks{};
     CheckInputsLimiter *pBlockLimitSigChecks{};
+    ScriptCheckOutcome *pOutcome{};
+
+    /// Verify the script, deferring its Schnorr signatures to `deferred` if given
+    bool VerifyScript(DeferredSignatures *deferred);
+    /// Account for the sigchecks of the verified script in the limiters
+    bool ConsumeSigChecks();
+    /// Report the result to pOutcome if set, in which case the check itself always succeeds
+    bool Report(bool fOk);
 
 public:
     CScriptCheck() = default;
@@ -590,6 +665,15 @@ public:
 
     bool operator()();
 
+    /**
+     * Run a batch of checks with the same result as running them one by one, used by CCheckQueue: their Schnorr
+     * signatures are verified all at once at the end, and if that fails, the checks are run again one by one.
+     */
+    static bool RunBatch(std::vector<CScriptCheck> &checks);
+
+    /// Report the result of this check to `outcome` rather than to the queue
+    void ReportTo(ScriptCheckOutcome &outcome) { pOutcome = &outcome; }
+
     ScriptError GetScriptError() const { return error; }
 
     const ScriptExecutionMetrics & GetScriptExecutionMetrics() const { return metrics; }
@@ -21,6 +21,15 @@ bool CZMQAbstractNotifier::NotifyTransaction(
     return true;
 }
 
+bool CZMQAbstractNotifier::NotifyTransactions(Span<const CTransactionRef> transactions) {
+    for (const CTransactionRef &tx : transactions) {
+        if (!NotifyTransaction(*tx)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool CZMQAbstractNotifier::NotifyDoubleSpend(const CTransaction & /*transaction*/) {
     return true;
 }
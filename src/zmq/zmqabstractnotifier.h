@@ -5,17 +5,22 @@
 
 #pragma once
 
+#include <primitives/transaction.h>
+#include <span.h>
+
 #include <memory>
 #include <string>
 
 class CBlockIndex;
-class CTransaction;
 class CZMQAbstractNotifier;
 
 using CZMQNotifierFactory = std::unique_ptr<CZMQAbstractNotifier> (*)();
 
 class CZMQAbstractNotifier {
 public:
+    //! The kinds of events a notifier publishes
+    enum class Topic { Block, Transaction, DoubleSpend };
+
     CZMQAbstractNotifier() : psocket(nullptr) {}
     virtual ~CZMQAbstractNotifier();
 
@@ -29,11 +34,18 @@ public:
     std::string GetAddress() const { return address; }
     void SetAddress(const std::string &a) { address = a; }
 
+    virtual Topic GetTopic() const = 0;
+
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    /**
+     * Notify several transactions at once, in order. Notifiers may publish
+     * them as a single message; by default they are notified one by one.
+     */
+    virtual bool NotifyTransactions(Span<const CTransactionRef> transactions);
     virtual bool NotifyDoubleSpend(const CTransaction &transaction);
 
 protected:
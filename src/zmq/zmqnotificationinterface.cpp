@@ -6,6 +6,7 @@
 
 #include <streams.h>
 #include <util/system.h>
+#include <util/thread.h>
 #include <validation.h>
 #include <version.h>
 #include <zmq/zmqnotificationinterface.h>
@@ -14,7 +15,9 @@
 
 #include <zmq.h>
 
+#include <algorithm>
 #include <map>
+#include <utility>
 
 CZMQNotificationInterface::CZMQNotificationInterface() = default;
 
@@ -22,15 +25,23 @@ CZMQNotificationInterface::~CZMQNotificationInterface() {
     Shutdown();
 }
 
-std::list<const CZMQAbstractNotifier *>
+std::vector<CZMQNotificationInterface::NotifierInfo>
 CZMQNotificationInterface::GetActiveNotifiers() const {
-    std::list<const CZMQAbstractNotifier *> result;
+    const auto dropped = WITH_LOCK(cs_queue, return nDropped);
+    std::vector<NotifierInfo> result;
+    LOCK(cs_notifiers);
+    result.reserve(notifiers.size());
     for (const auto &n : notifiers) {
-        result.push_back(n.get());
+        result.push_back({n->GetType(), n->GetAddress(), dropped[static_cast<size_t>(n->GetTopic())]});
     }
     return result;
 }
 
+size_t CZMQNotificationInterface::GetQueueHighWaterMark() const {
+    LOCK(cs_queue);
+    return nQueueHighWaterMark;
+}
+
 std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create() {
     std::map<std::string, CZMQNotifierFactory> factories;
 
@@ -62,7 +73,14 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create() {
 
     if (!notifiers.empty()) {
         std::unique_ptr<CZMQNotificationInterface> notificationInterface(new CZMQNotificationInterface);
-        notificationInterface->notifiers = std::move(notifiers);
+        for (const auto &notifier : notifiers) {
+            notificationInterface->fHasTopic[static_cast<size_t>(notifier->GetTopic())] = true;
+        }
+        WITH_LOCK(notificationInterface->cs_notifiers, notificationInterface->notifiers = std::move(notifiers));
+        notificationInterface->nMaxQueueSize =
+            std::max<int64_t>(1, gArgs.GetArg("-zmqqueuesize", int64_t(DEFAULT_ZMQ_QUEUE_SIZE)));
+        notificationInterface->nTxBatchSize =
+            std::max<int64_t>(1, gArgs.GetArg("-zmqtxbatchsize", int64_t(DEFAULT_ZMQ_TX_BATCH_SIZE)));
 
         if (notificationInterface->Initialize()) {
             return notificationInterface;
@@ -88,24 +106,37 @@ bool CZMQNotificationInterface::Initialize() {
         return false;
     }
 
-    for (auto &notifier : notifiers) {
-        if (notifier->Initialize(pcontext)) {
-            LogPrint(BCLog::ZMQ, "  Notifier %s ready (address = %s)\n",
-                     notifier->GetType(), notifier->GetAddress());
-        } else {
-            LogPrint(BCLog::ZMQ, "  Notifier %s failed (address = %s)\n",
-                     notifier->GetType(), notifier->GetAddress());
-            return false;
+    {
+        LOCK(cs_notifiers);
+        for (auto &notifier : notifiers) {
+            if (notifier->Initialize(pcontext)) {
+                LogPrint(BCLog::ZMQ, "  Notifier %s ready (address = %s)\n",
+                         notifier->GetType(), notifier->GetAddress());
+            } else {
+                LogPrint(BCLog::ZMQ, "  Notifier %s failed (address = %s)\n",
+                         notifier->GetType(), notifier->GetAddress());
+                return false;
+            }
         }
     }
 
+    // From here on, the sockets are only used by the publisher thread.
+    publisherThread = std::thread(util::TraceThread, "zmqpub", [this] { ThreadPublish(); });
+
     return true;
 }
 
 // Called during shutdown sequence
 void CZMQNotificationInterface::Shutdown() {
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
+    if (publisherThread.joinable()) {
+        // Let the publisher thread publish what is queued, then stop.
+        WITH_LOCK(cs_queue, fStopPublisher = true);
+        cond_queue.notify_one();
+        publisherThread.join();
+    }
     if (pcontext) {
+        LOCK(cs_notifiers);
         for (auto &notifier : notifiers) {
             LogPrint(BCLog::ZMQ, "   Shutdown notifier %s at %s\n",
                      notifier->GetType(), notifier->GetAddress());
@@ -134,55 +165,129 @@ void TryForEachAndRemoveFailed(std::list<std::unique_ptr<CZMQAbstractNotifier>>&
 
 } // namespace
 
+void CZMQNotificationInterface::Enqueue(Notification &&notification) {
+    {
+        LOCK(cs_queue);
+        if (queue.size() >= nMaxQueueSize) {
+            // The publisher can't keep up; rather drop than hold up the validation interface queue.
+            const uint64_t count = notification.block ? notification.block->vtx.size() : 1;
+            nDropped[static_cast<size_t>(notification.topic)] += count;
+            LogPrint(BCLog::ZMQ, "zmq: Queue full, dropped %u notification(s)\n", count);
+            return;
+        }
+        queue.push_back(std::move(notification));
+        nQueueHighWaterMark = std::max(nQueueHighWaterMark, queue.size());
+    }
+    cond_queue.notify_one();
+}
+
+void CZMQNotificationInterface::PublishTransactions(std::vector<CTransactionRef> &txs) {
+    if (txs.empty()) {
+        return;
+    }
+    TryForEachAndRemoveFailed(notifiers, [&txs](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyTransactions(txs);
+    });
+    txs.clear();
+}
+
+void CZMQNotificationInterface::ThreadPublish() {
+    std::deque<Notification> pending;
+    std::vector<CTransactionRef> txs;
+    txs.reserve(nTxBatchSize);
+    while (true) {
+        {
+            WAIT_LOCK(cs_queue, lock);
+            cond_queue.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(cs_queue) {
+                return fStopPublisher || !queue.empty();
+            });
+            if (queue.empty()) {
+                // Stopping, and everything has been published.
+                return;
+            }
+            pending.swap(queue);
+        }
+
+        LOCK(cs_notifiers);
+        auto AddTransaction = [&](CTransactionRef tx) EXCLUSIVE_LOCKS_REQUIRED(cs_notifiers) {
+            txs.push_back(std::move(tx));
+            if (txs.size() >= nTxBatchSize) {
+                PublishTransactions(txs);
+            }
+        };
+        for (Notification &notification : pending) {
+            switch (notification.topic) {
+                case Topic::Transaction:
+                    if (notification.block) {
+                        for (const CTransactionRef &ptx : notification.block->vtx) {
+                            AddTransaction(ptx);
+                        }
+                    } else {
+                        AddTransaction(std::move(notification.tx));
+                    }
+                    break;
+                case Topic::Block:
+                    // Keep the order of the notifications.
+                    PublishTransactions(txs);
+                    TryForEachAndRemoveFailed(notifiers, [&notification](CZMQAbstractNotifier* notifier) {
+                        return notifier->NotifyBlock(notification.pindex);
+                    });
+                    break;
+                case Topic::DoubleSpend:
+                    PublishTransactions(txs);
+                    TryForEachAndRemoveFailed(notifiers, [&notification](CZMQAbstractNotifier* notifier) {
+                        return notifier->NotifyDoubleSpend(*notification.tx);
+                    });
+                    break;
+            }
+        }
+        // Batches only combine transactions that were queued at the same time; they never wait for more.
+        PublishTransactions(txs);
+        pending.clear();
+    }
+}
+
 void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew,
                                                 const CBlockIndex *pindexFork,
                                                 bool fInitialDownload) {
     // In IBD or blocks were disconnected without any new ones
-    if (fInitialDownload || pindexNew == pindexFork) {
+    if (fInitialDownload || pindexNew == pindexFork || !fHasTopic[static_cast<size_t>(Topic::Block)]) {
         return;
     }
 
-    TryForEachAndRemoveFailed(notifiers, [pindexNew](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyBlock(pindexNew);
-    });
+    Enqueue({Topic::Block, pindexNew, nullptr, nullptr});
 }
 
 void CZMQNotificationInterface::TransactionAddedToMempool(
     const CTransactionRef &ptx) {
-    // Used by BlockConnected and BlockDisconnected as well, because they're all
-    // the same external callback.
-    const CTransaction &tx = *ptx;
-
-    TryForEachAndRemoveFailed(notifiers, [&tx](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyTransaction(tx);
-    });
+    if (fHasTopic[static_cast<size_t>(Topic::Transaction)]) {
+        Enqueue({Topic::Transaction, nullptr, ptx, nullptr});
+    }
 }
 
 void CZMQNotificationInterface::BlockConnected(
     const std::shared_ptr<const CBlock> &pblock,
     const CBlockIndex *,
     const std::vector<CTransactionRef> &) {
-    for (const CTransactionRef &ptx : pblock->vtx) {
-        // Do a normal notify for each transaction added in the block
-        TransactionAddedToMempool(ptx);
+    // Do a normal notify for each transaction added in the block
+    if (fHasTopic[static_cast<size_t>(Topic::Transaction)]) {
+        Enqueue({Topic::Transaction, nullptr, nullptr, pblock});
     }
 }
 
 void CZMQNotificationInterface::BlockDisconnected(
     const std::shared_ptr<const CBlock> &pblock) {
-    for (const CTransactionRef &ptx : pblock->vtx) {
-        // Do a normal notify for each transaction removed in block
-        // disconnection
-        TransactionAddedToMempool(ptx);
+    // Do a normal notify for each transaction removed in block
+    // disconnection
+    if (fHasTopic[static_cast<size_t>(Topic::Transaction)]) {
+        Enqueue({Topic::Transaction, nullptr, nullptr, pblock});
     }
 }
 
 void CZMQNotificationInterface::TransactionDoubleSpent(const CTransactionRef &ptx, const DspId &) {
-    const CTransaction &tx = *ptx;
-
-    TryForEachAndRemoveFailed(notifiers, [&tx](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyDoubleSpend(tx);
-    });
+    if (fHasTopic[static_cast<size_t>(Topic::DoubleSpend)]) {
+        Enqueue({Topic::DoubleSpend, nullptr, ptx, nullptr});
+    }
 }
 
 
@@ -5,19 +5,45 @@
 
 #pragma once
 
+#include <sync.h>
 #include <validationinterface.h>
+#include <zmq/zmqabstractnotifier.h>
 
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <list>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 class CBlockIndex;
-class CZMQAbstractNotifier;
+
+//! Default for -zmqqueuesize, the number of notifications that may wait for the publisher thread
+static constexpr size_t DEFAULT_ZMQ_QUEUE_SIZE = 10000;
+//! Default for -zmqtxbatchsize, the maximum number of transactions published in one message
+static constexpr size_t DEFAULT_ZMQ_TX_BATCH_SIZE = 1;
 
 class CZMQNotificationInterface final : public CValidationInterface {
 public:
     ~CZMQNotificationInterface();
 
-    std::list<const CZMQAbstractNotifier *> GetActiveNotifiers() const;
+    struct NotifierInfo {
+        std::string type;
+        std::string address;
+        //! Notifications for this notifier's topic that were dropped because the queue was full
+        uint64_t dropped;
+    };
+    std::vector<NotifierInfo> GetActiveNotifiers() const;
+
+    //! The highest number of notifications that were waiting for the publisher thread at once
+    size_t GetQueueHighWaterMark() const;
+
+    //! The ZeroMQ context of the notifiers, e.g. to connect inproc:// subscribers to
+    void *GetContext() const { return pcontext; }
 
     static std::unique_ptr<CZMQNotificationInterface> Create();
 
@@ -38,10 +64,48 @@ protected:
                                 const DspId &dspId) override;
 
 private:
+    using Topic = CZMQAbstractNotifier::Topic;
+
+    //! A notification waiting for the publisher thread
+    struct Notification {
+        Topic topic;
+        //! Topic::Block: the new tip
+        const CBlockIndex *pindex = nullptr;
+        //! Topic::Transaction, Topic::DoubleSpend: the transaction
+        CTransactionRef tx;
+        //! Topic::Transaction: alternatively, a block whose transactions are all published
+        std::shared_ptr<const CBlock> block;
+    };
+
     CZMQNotificationInterface();
 
+    //! Queue a notification for the publisher thread, or drop it if the queue is full
+    void Enqueue(Notification &&notification);
+    //! Publish queued notifications until Shutdown()
+    void ThreadPublish();
+    void PublishTransactions(std::vector<CTransactionRef> &txs) EXCLUSIVE_LOCKS_REQUIRED(cs_notifiers);
+
     void *pcontext = nullptr;
-    std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
+    //! Whether any notifier publishes the Topic; set up before any notification comes in
+    std::array<bool, 3> fHasTopic{};
+    //! Maximum number of queued notifications (-zmqqueuesize)
+    size_t nMaxQueueSize = DEFAULT_ZMQ_QUEUE_SIZE;
+    //! Maximum number of transactions per message (-zmqtxbatchsize)
+    size_t nTxBatchSize = DEFAULT_ZMQ_TX_BATCH_SIZE;
+
+    //! The notifiers are used by the publisher thread, and inspected by RPC
+    mutable Mutex cs_notifiers;
+    std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers GUARDED_BY(cs_notifiers);
+
+    mutable Mutex cs_queue;
+    std::condition_variable cond_queue;
+    std::deque<Notification> queue GUARDED_BY(cs_queue);
+    bool fStopPublisher GUARDED_BY(cs_queue){false};
+    size_t nQueueHighWaterMark GUARDED_BY(cs_queue){0};
+    //! Dropped notifications, indexed by Topic. A block's transactions count one by one.
+    std::array<uint64_t, 3> nDropped GUARDED_BY(cs_queue){};
+
+    std::thread publisherThread;
 };
 
 extern std::unique_ptr<CZMQNotificationInterface> g_zmq_notification_interface;
@@ -18,8 +18,8 @@
 #include <zmq.h>
 
 #include <algorithm>
-#include <cstdarg>
 #include <cstddef>
+#include <cstring>
 #include <map>
 #include <string>
 #include <utility>
@@ -35,42 +35,29 @@ inline constexpr auto MSG_HASHDS = "hashds";
 inline constexpr auto MSG_RAWDS = "rawds";
 
 // Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void *data, size_t size, ...) {
-    va_list args;
-    va_start(args, size);
-
-    while (1) {
+static int zmq_send_multipart(void *sock, const std::vector<Span<const uint8_t>> &parts) {
+    for (size_t i = 0; i < parts.size(); ++i) {
         zmq_msg_t msg;
 
-        int rc = zmq_msg_init_size(&msg, size);
+        int rc = zmq_msg_init_size(&msg, parts[i].size());
         if (rc != 0) {
             zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
             return -1;
         }
 
-        void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
-
-        data = va_arg(args, const void *);
+        if (!parts[i].empty()) {
+            std::memcpy(zmq_msg_data(&msg), parts[i].data(), parts[i].size());
+        }
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
+        rc = zmq_msg_send(&msg, sock, i + 1 < parts.size() ? ZMQ_SNDMORE : 0);
         if (rc == -1) {
             zmqError("Unable to send ZMQ msg");
             zmq_msg_close(&msg);
-            va_end(args);
             return -1;
         }
 
         zmq_msg_close(&msg);
-
-        if (!data) {
-            break;
-        }
-
-        size = va_arg(args, size_t);
     }
-    va_end(args);
     return 0;
 }
 
@@ -139,13 +126,22 @@ void CZMQAbstractPublishNotifier::Shutdown() {
 
 bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command,
                                                  const void *data, size_t size) {
+    return SendZmqMessage(command, std::vector<Span<const uint8_t>>{{static_cast<const uint8_t *>(data), size}});
+}
+
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command,
+                                                 const std::vector<Span<const uint8_t>> &parts) {
     assert(psocket);
 
-    /* send three parts, command & data & a LE 4byte sequence number */
+    /* send the command, the data parts and a LE 4byte sequence number */
     uint8_t msgseq[sizeof(uint32_t)];
     WriteLE32(&msgseq[0], nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size,
-                                msgseq, (size_t)sizeof(uint32_t), nullptr);
+    std::vector<Span<const uint8_t>> message;
+    message.reserve(parts.size() + 2);
+    message.emplace_back(reinterpret_cast<const uint8_t *>(command), std::strlen(command));
+    message.insert(message.end(), parts.begin(), parts.end());
+    message.emplace_back(msgseq, sizeof(msgseq));
+    int rc = zmq_send_multipart(psocket, message);
     if (rc == -1) {
         return false;
     }
@@ -177,6 +173,23 @@ bool CZMQPublishHashTransactionNotifier::NotifyTransaction(
     return SendZmqMessage(MSG_HASHTX, data, 32);
 }
 
+bool CZMQPublishHashTransactionNotifier::NotifyTransactions(Span<const CTransactionRef> transactions) {
+    if (transactions.size() == 1) {
+        return NotifyTransaction(*transactions.front());
+    }
+    LogPrint(BCLog::ZMQ, "zmq: Publish hashtx batch of %u\n", transactions.size());
+    std::vector<TxId> revtxids;
+    revtxids.reserve(transactions.size());
+    std::vector<Span<const uint8_t>> parts;
+    parts.reserve(transactions.size());
+    for (const CTransactionRef &tx : transactions) {
+        const TxId &txid = tx->GetId();
+        std::reverse_copy(txid.begin(), txid.end(), revtxids.emplace_back(TxId::Uninitialized).begin());
+        parts.emplace_back(revtxids.back().begin(), revtxids.back().size());
+    }
+    return SendZmqMessage(MSG_HASHTX, parts);
+}
+
 bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex) {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s\n",
              pindex->GetBlockHash().GetHex());
@@ -203,6 +216,30 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(
     return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
 
+bool CZMQPublishRawTransactionNotifier::NotifyTransactions(Span<const CTransactionRef> transactions) {
+    if (transactions.size() == 1) {
+        return NotifyTransaction(*transactions.front());
+    }
+    LogPrint(BCLog::ZMQ, "zmq: Publish rawtx batch of %u\n", transactions.size());
+    // Serialize all transactions into one buffer, then point a message part at each of them.
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    std::vector<size_t> ends;
+    ends.reserve(transactions.size());
+    for (const CTransactionRef &tx : transactions) {
+        ss << *tx;
+        ends.push_back(ss.size());
+    }
+    const Span<const uint8_t> data{reinterpret_cast<const uint8_t *>(ss.data()), ss.size()};
+    std::vector<Span<const uint8_t>> parts;
+    parts.reserve(transactions.size());
+    size_t begin = 0;
+    for (const size_t end : ends) {
+        parts.push_back(data.subspan(begin, end - begin));
+        begin = end;
+    }
+    return SendZmqMessage(MSG_RAWTX, parts);
+}
+
 bool CZMQPublishHashDoubleSpendNotifier::NotifyDoubleSpend(const CTransaction &transaction) {
     const TxId txid = transaction.GetId();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashds %s\n", txid.GetHex());
@@ -5,8 +5,12 @@
 
 #pragma once
 
+#include <span.h>
 #include <zmq/zmqabstractnotifier.h>
 
+#include <cstdint>
+#include <vector>
+
 class CBlockIndex;
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier {
@@ -22,6 +26,13 @@ public:
           * message sequence number
     */
     bool SendZmqMessage(const char *command, const void *data, size_t size);
+    /* send zmq multipart message with several data parts
+       parts:
+          * command
+          * data, one part for each element of `parts`
+          * message sequence number
+    */
+    bool SendZmqMessage(const char *command, const std::vector<Span<const uint8_t>> &parts);
 
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
@@ -29,31 +40,39 @@ public:
 
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier {
 public:
+    Topic GetTopic() const override { return Topic::Block; }
     bool NotifyBlock(const CBlockIndex *pindex) override;
 };
 
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier {
 public:
+    Topic GetTopic() const override { return Topic::Transaction; }
     bool NotifyTransaction(const CTransaction &transaction) override;
+    bool NotifyTransactions(Span<const CTransactionRef> transactions) override;
 };
 
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier {
 public:
+    Topic GetTopic() const override { return Topic::Block; }
     bool NotifyBlock(const CBlockIndex *pindex) override;
 };
 
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier {
 public:
+    Topic GetTopic() const override { return Topic::Transaction; }
     bool NotifyTransaction(const CTransaction &transaction) override;
+    bool NotifyTransactions(Span<const CTransactionRef> transactions) override;
 };
 
 
 class CZMQPublishHashDoubleSpendNotifier : public CZMQAbstractPublishNotifier {
 public:
+    Topic GetTopic() const override { return Topic::DoubleSpend; }
     bool NotifyDoubleSpend(const CTransaction &transaction) override;
 };
 
 class CZMQPublishRawDoubleSpendNotifier : public CZMQAbstractPublishNotifier {
 public:
+    Topic GetTopic() const override { return Topic::DoubleSpend; }
     bool NotifyDoubleSpend(const CTransaction &transaction) override;
 };
@@ -23,9 +23,14 @@ UniValue getzmqnotifications(const Config &,
             {},
             RPCResult{
                 "[\n"
-                "  {                        (json object)\n"
-                "    \"type\": \"pubhashtx\",   (string) Type of notification\n"
-                "    \"address\": \"...\"       (string) Address of the publisher\n"
+                "  {                          (json object)\n"
+                "    \"type\": \"pubhashtx\",       (string) Type of notification\n"
+                "    \"address\": \"...\",          (string) Address of the publisher\n"
+                "    \"dropped\": n,              (numeric) Number of notifications of the same topic (blocks,\n"
+                "                                 transactions or double spends) that were dropped because the\n"
+                "                                 publisher queue was full\n"
+                "    \"queuehighwatermark\": n    (numeric) The largest number of notifications (of any topic)\n"
+                "                                 that were waiting in the publisher queue at once\n"
                 "  },\n"
                 "  ...\n"
                 "]\n"},
@@ -36,13 +41,16 @@ UniValue getzmqnotifications(const Config &,
 
     UniValue::Array result;
     if (g_zmq_notification_interface != nullptr) {
-        auto notifiers = g_zmq_notification_interface->GetActiveNotifiers();
+        const auto notifiers = g_zmq_notification_interface->GetActiveNotifiers();
+        const size_t queueHighWaterMark = g_zmq_notification_interface->GetQueueHighWaterMark();
         result.reserve(notifiers.size());
-        for (const auto *n : notifiers) {
+        for (const auto &n : notifiers) {
             UniValue::Object obj;
-            obj.reserve(2);
-            obj.emplace_back("type", n->GetType());
-            obj.emplace_back("address", n->GetAddress());
+            obj.reserve(4);
+            obj.emplace_back("type", n.type);
+            obj.emplace_back("address", n.address);
+            obj.emplace_back("dropped", n.dropped);
+            obj.emplace_back("queuehighwatermark", queueHighWaterMark);
             result.emplace_back(std::move(obj));
         }
     }
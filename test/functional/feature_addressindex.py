@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the address index (-addressindex).
+
+Tests the getaddresshistory and getaddressutxos RPC calls and their REST
+counterparts, for confirmed and mempool transactions and across a reorg.
+"""
+
+from decimal import Decimal
+import http.client
+import json
+import urllib.parse
+
+from test_framework.messages import sha256
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+    hex_str_to_bytes,
+    wait_until,
+)
+
+
+class AddressIndexTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [["-addressindex", "-rest"], []]
+
+    def scripthash(self, address):
+        script = self.nodes[0].validateaddress(address)['scriptPubKey']
+        return sha256(hex_str_to_bytes(script))[::-1].hex()
+
+    def rest_request(self, uri, status=200):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request('GET', '/rest' + uri)
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        body = resp.read().decode('utf-8')
+        return json.loads(body, parse_float=Decimal) if status == 200 else body
+
+    def run_test(self):
+        node = self.nodes[0]
+        miner = node.get_deterministic_priv_key()
+        other = self.nodes[1].get_deterministic_priv_key()
+
+        self.log.info("Check that the index covers the initial chain")
+        self.generatetoaddress(node, 101, miner.address)
+        history = node.getaddresshistory(miner.address)
+        assert_equal(len(history), 101)
+        assert_equal([entry['height'] for entry in history], list(range(1, 102)))
+        assert_equal(history[0]['txid'], node.getblock(node.getblockhash(1))['tx'][0])
+        utxos = node.getaddressutxos(miner.address)
+        assert_equal(len(utxos), 101)
+        assert_equal(node.getaddresshistory(self.scripthash(miner.address)), history)
+        assert_equal(node.getaddressutxos(self.scripthash(miner.address)), utxos)
+        assert_equal(node.getaddresshistory(other.address), [])
+        assert node.getindexinfo()['addressindex']['synced']
+
+        self.log.info("Check mempool transactions")
+        coin = next(u for u in utxos if u['height'] == 1)
+        raw = node.createrawtransaction([{'txid': coin['txid'], 'vout': coin['vout']}],
+                                        {other.address: Decimal('10'), miner.address: coin['amount'] - Decimal('10.001')})
+        signed = node.signrawtransactionwithkey(raw, [miner.key])['hex']
+        txid = node.sendrawtransaction(signed)
+        self.sync_mempools()
+
+        history = node.getaddresshistory(other.address)
+        assert_equal(history, [{'txid': txid, 'height': 0}])
+        assert_equal(node.getaddresshistory(other.address, False), [])
+        utxos = node.getaddressutxos(other.address)
+        assert_equal(utxos, [{'txid': txid, 'vout': 0, 'amount': Decimal('10'), 'height': 0}])
+        assert_equal(node.getaddressutxos(other.address, False), [])
+
+        miner_history = node.getaddresshistory(miner.address)
+        assert_equal(len(miner_history), 102)
+        assert_equal(miner_history[-1], {'txid': txid, 'height': 0})
+        miner_utxos = node.getaddressutxos(miner.address)
+        assert_equal(len(miner_utxos), 101)
+        assert coin not in miner_utxos
+        assert_equal(len(node.getaddressutxos(miner.address, False)), 101)
+
+        self.log.info("Check that mined transactions move to the confirmed history")
+        block_hash = self.generatetoaddress(node, 1, miner.address)[0]
+        assert_equal(node.getaddresshistory(other.address), [{'txid': txid, 'height': 102}])
+        assert_equal(node.getaddressutxos(other.address)[0]['height'], 102)
+        assert_equal(len(node.getaddresshistory(miner.address)), 103)
+
+        self.log.info("Check the REST interface")
+        assert_equal(self.rest_request('/addresshistory/{}.json'.format(other.address)),
+                     node.getaddresshistory(other.address))
+        assert_equal(self.rest_request('/addressutxos/{}.json'.format(self.scripthash(other.address))),
+                     node.getaddressutxos(other.address))
+        self.rest_request('/addressutxos/notanaddress.json', status=400)
+        self.rest_request('/addressutxos/{}.bin'.format(other.address), status=404)
+
+        self.log.info("Check that a reorg removes the transactions of stale blocks")
+        node.invalidateblock(block_hash)
+        assert_equal(node.getaddresshistory(other.address), [{'txid': txid, 'height': 0}])
+        assert_equal(node.getaddresshistory(other.address, False), [])
+        assert_equal(node.getaddressutxos(other.address, False), [])
+        assert_equal(len(node.getaddresshistory(miner.address, False)), 101)
+        assert coin in node.getaddressutxos(miner.address, False)
+        node.reconsiderblock(block_hash)
+        assert_equal(node.getaddresshistory(other.address), [{'txid': txid, 'height': 102}])
+        assert_equal(len(node.getaddresshistory(miner.address)), 103)
+
+        self.log.info("Check that the index catches up after a restart")
+        self.restart_node(0, extra_args=self.extra_args[0])
+        wait_until(lambda: node.getindexinfo()['addressindex']['synced'])
+        self.generatetoaddress(node, 1, other.address)
+        assert_equal(node.getaddresshistory(other.address)[0], {'txid': txid, 'height': 102})
+        assert_equal(len(node.getaddressutxos(other.address)), 2)
+
+        self.log.info("Check errors")
+        assert_raises_rpc_error(-5, "Invalid address or script hash", node.getaddresshistory, "notanaddress")
+        assert_raises_rpc_error(-1, "Address index is not enabled", self.nodes[1].getaddresshistory, other.address)
+        assert_raises_rpc_error(-1, "Address index is not enabled", self.nodes[1].getaddressutxos, other.address)
+
+
+if __name__ == '__main__':
+    AddressIndexTest().main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the spent output index (-spentindex).
+
+Tests the getspentby RPC call and its REST counterpart, for confirmed and
+mempool spenders and across a reorg.
+"""
+
+from decimal import Decimal
+import http.client
+import json
+import urllib.parse
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+
+
+class SpentIndexTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [["-spentindex", "-rest"], []]
+
+    def rest_request(self, uri, status=200):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request('GET', '/rest' + uri)
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        body = resp.read().decode('utf-8')
+        return json.loads(body, parse_float=Decimal) if status == 200 else body
+
+    def run_test(self):
+        node = self.nodes[0]
+        miner = node.get_deterministic_priv_key()
+        other = self.nodes[1].get_deterministic_priv_key()
+
+        self.generatetoaddress(node, 101, miner.address)
+        assert node.getindexinfo()['spentindex']['synced']
+        coinbase = node.getblock(node.getblockhash(1))['tx'][0]
+        assert_equal(node.getspentby(coinbase, 0), None)
+
+        self.log.info("Check a spender in the mempool")
+        amount = node.gettxout(coinbase, 0)['value']
+        raw = node.createrawtransaction([{'txid': coinbase, 'vout': 0}],
+                                        {other.address: Decimal('10'), miner.address: amount - Decimal('10.001')})
+        signed = node.signrawtransactionwithkey(raw, [miner.key])['hex']
+        txid = node.sendrawtransaction(signed)
+        assert_equal(node.getspentby(coinbase, 0), {'txid': txid, 'vin': 0, 'height': 0})
+        assert_equal(node.getspentby(coinbase, 0, False), None)
+        assert_equal(node.getspentby(txid, 0), None)
+
+        self.log.info("Check a confirmed spender")
+        block_hash = self.generatetoaddress(node, 1, miner.address)[0]
+        spender = {'txid': txid, 'vin': 0, 'height': 102, 'blockhash': block_hash}
+        assert_equal(node.getspentby(coinbase, 0), spender)
+        assert_equal(node.getspentby(coinbase, 0, False), spender)
+
+        self.log.info("Check the REST interface")
+        assert_equal(self.rest_request('/spentby/{}-0.json'.format(coinbase)), spender)
+        assert_equal(self.rest_request('/spentby/{}-1.json'.format(txid)), None)
+        self.rest_request('/spentby/{}.json'.format(coinbase), status=400)
+        self.rest_request('/spentby/{}--1.json'.format(coinbase), status=400)
+        self.rest_request('/spentby/{}-0.bin'.format(coinbase), status=404)
+
+        self.log.info("Check that a reorg removes the spenders of stale blocks")
+        node.invalidateblock(block_hash)
+        assert_equal(node.getspentby(coinbase, 0), {'txid': txid, 'vin': 0, 'height': 0})
+        assert_equal(node.getspentby(coinbase, 0, False), None)
+        node.reconsiderblock(block_hash)
+        assert_equal(node.getspentby(coinbase, 0), spender)
+
+        self.log.info("Check errors")
+        assert_raises_rpc_error(-8, "vout must be positive", node.getspentby, coinbase, -1)
+        assert_raises_rpc_error(-1, "Spent index is not enabled", self.nodes[1].getspentby, coinbase, 0)
+
+
+if __name__ == '__main__':
+    SpentIndexTest().main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test dumputxoset and loadutxoset.
+
+A node that only knows the headers of a chain loads a UTXO snapshot written by
+another node, continues to sync from the snapshot block, keeps its chainstate
+across a restart, and validates the history below the snapshot in the
+background.
+"""
+
+import os
+
+from test_framework.messages import NODE_NETWORK
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+    connect_nodes_bi,
+    wait_until,
+)
+
+
+class UTXOSnapshotTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+
+    def setup_network(self):
+        self.setup_nodes()
+
+    def run_test(self):
+        node0, node1 = self.nodes
+        address = node0.get_deterministic_priv_key().address
+        self.generatetoaddress(node0, 150, address)
+        base_hash = node0.getbestblockhash()
+
+        self.log.info("Dump the UTXO set")
+        dump = node0.dumputxoset("utxo.dat")
+        expected_hash = node0.gettxoutsetinfo("ecmh")["ecmh"]
+        assert_equal(dump["base_hash"], base_hash)
+        assert_equal(dump["base_height"], 150)
+        assert_equal(dump["coins_written"], 150)
+        assert_equal(dump["ecmh"], expected_hash)
+        path = dump["path"]
+        assert_equal(path, os.path.join(node0.datadir, self.chain, "utxo.dat"))
+        assert_raises_rpc_error(-8, "already exists", node0.dumputxoset, "utxo.dat")
+
+        self.log.info("Refuse snapshots of unknown blocks")
+        assert_raises_rpc_error(-1, "is not known yet", node1.loadutxoset, path, expected_hash)
+
+        for height in range(1, 151):
+            node1.submitheader(node0.getblockheader(node0.getblockhash(height), False))
+        assert_equal(node1.getblockcount(), 0)
+
+        self.log.info("Refuse snapshots that are corrupt or do not have the expected hash")
+        with open(path, "rb") as f:
+            data = bytearray(f.read())
+        data[len(data) // 2] ^= 1
+        corrupt_path = os.path.join(node1.datadir, "corrupt.dat")
+        with open(corrupt_path, "wb") as f:
+            f.write(data)
+        assert_raises_rpc_error(-1, "Unable to load the UTXO snapshot", node1.loadutxoset, corrupt_path, expected_hash)
+        assert_raises_rpc_error(-1, "does not have the expected hash", node1.loadutxoset, path, "00" * 32)
+        assert_equal(node1.getblockcount(), 0)
+        assert_equal(node1.gettxoutsetinfo()["txouts"], 0)
+        assert not os.path.exists(os.path.join(node1.datadir, self.chain, "chainstate_snapshot"))
+
+        self.log.info("Load the snapshot")
+        load = node1.loadutxoset(path, expected_hash)
+        assert_equal(load["coins_loaded"], 150)
+        assert_equal(load["base_hash"], base_hash)
+        assert_equal(load["ecmh"], expected_hash)
+        assert_equal(node1.getbestblockhash(), base_hash)
+        assert not os.path.exists(os.path.join(node1.datadir, self.chain, "chainstate_snapshot"))
+        assert_equal(node1.gettxoutsetinfo("ecmh")["ecmh"], expected_hash)
+        assert_raises_rpc_error(-1, "Block not available (pruned data)", node1.getblock, node0.getblockhash(100))
+        assert_raises_rpc_error(-1, "while the chain tip is the genesis block", node1.loadutxoset, path, expected_hash)
+        info = node1.getblockchaininfo()
+        assert_equal(info["snapshot_base_height"], 150)
+        assert info["background_validation_height"] <= 0
+        assert "snapshot_base_height" not in node0.getblockchaininfo()
+
+        self.log.info("Restart the node from the snapshot chainstate")
+        self.restart_node(1)
+        assert_equal(node1.getblockcount(), 150)
+        assert_equal(node1.gettxoutsetinfo("ecmh")["ecmh"], expected_hash)
+        assert_equal(node1.getblockchaininfo()["snapshot_base_height"], 150)
+        assert_equal(int(node1.getnetworkinfo()["localservices"], 16) & NODE_NETWORK, 0)
+        assert_equal(int(node0.getnetworkinfo()["localservices"], 16) & NODE_NETWORK, NODE_NETWORK)
+
+        self.log.info("Sync the blocks after the snapshot, and validate the history below it in the background")
+        connect_nodes_bi(node0, node1)
+        self.generatetoaddress(node0, 10, address)
+        self.sync_blocks()
+        assert_equal(node1.gettxoutsetinfo("ecmh")["ecmh"], node0.gettxoutsetinfo("ecmh")["ecmh"])
+        node1.getblock(node1.getbestblockhash())
+        wait_until(lambda: "snapshot_base_height" not in node1.getblockchaininfo(), timeout=60)
+        assert_equal(node1.getblock(node0.getblockhash(100)), node0.getblock(node0.getblockhash(100)))
+        # The background chainstate is removed right after the snapshot base is forgotten
+        wait_until(lambda: not os.path.exists(os.path.join(node1.datadir, self.chain, "chainstate_background")),
+                   timeout=10)
+        assert_equal(node1.gettxoutsetinfo("ecmh")["ecmh"], node0.gettxoutsetinfo("ecmh")["ecmh"])
+
+        self.log.info("Advertise NODE_NETWORK again once the history is validated")
+        self.restart_node(1)
+        assert_equal(node1.getblockcount(), 160)
+        assert_equal(int(node1.getnetworkinfo()["localservices"], 16) & NODE_NETWORK, NODE_NETWORK)
+
+
+if __name__ == '__main__':
+    UTXOSnapshotTest().main()
@@ -4,13 +4,14 @@
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 """Test the ZMQ notification interface."""
 import struct
+from decimal import Decimal
 from io import BytesIO
 
-from test_framework.blocktools import create_raw_transaction
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.messages import CTransaction
 from test_framework.util import (
     assert_equal,
+    assert_greater_than_or_equal,
     assert_raises_rpc_error,
     hash256_reversed,
 )
@@ -37,6 +38,14 @@ class ZMQSubscriber:
         self.sequence += 1
         return body
 
+    def receive_batch(self):
+        """Receive a message of -zmqtxbatchsize transactions, with one part per transaction."""
+        topic, *bodies, seq = self.socket.recv_multipart()
+        assert_equal(topic, self.topic)
+        assert_equal(struct.unpack('<I', seq)[-1], self.sequence)
+        self.sequence += 1
+        return bodies
+
 
 class ZMQTest (BitcoinTestFramework):
     def set_test_params(self):
@@ -45,7 +54,6 @@ class ZMQTest (BitcoinTestFramework):
     def skip_test_if_missing_module(self):
         self.skip_if_no_py3_zmq()
         self.skip_if_no_bitcoind_zmq()
-        self.skip_if_no_wallet()
 
     def setup_nodes(self):
         import zmq
@@ -70,7 +78,8 @@ class ZMQTest (BitcoinTestFramework):
 
         self.extra_args = [
             ["-zmqpub{}={}".format(sub.topic.decode(), ADDRESS) for sub in [
-                self.hashblock, self.hashtx, self.rawblock, self.rawtx, self.hashds, self.rawds]],
+                self.hashblock, self.hashtx, self.rawblock, self.rawtx, self.hashds, self.rawds]] + [
+                "-zmqtxbatchsize=2"],
             [],
         ]
         self.add_nodes(self.num_nodes, self.extra_args)
@@ -84,11 +93,16 @@ class ZMQTest (BitcoinTestFramework):
             self.log.debug("Destroying ZMQ context")
             self.zmq_context.destroy(linger=None)
 
+    def sign_transaction(self, node, inputs, outputs, key):
+        raw = node.createrawtransaction(inputs, outputs)
+        return node.signrawtransactionwithkey(raw, [key])['hex']
+
     def _zmq_test(self):
+        key = self.nodes[0].get_deterministic_priv_key()
         num_blocks = 5
         self.log.info(
             "Generate {0} blocks (and {0} coinbase txes)".format(num_blocks))
-        genhashes = self.generate(self.nodes[0], num_blocks)
+        genhashes = self.generatetoaddress(self.nodes[0], num_blocks, key.address)
         self.sync_all()
 
         for x in range(num_blocks):
@@ -113,8 +127,13 @@ class ZMQTest (BitcoinTestFramework):
             assert_equal(genhashes[x], hash256_reversed(block[:80]).hex())
 
         self.log.info("Wait for tx from second node")
-        payment_txid = self.nodes[1].sendtoaddress(
-            self.nodes[0].getnewaddress(), 1.0)
+        # The first blocks of the cached chain pay to the key of node 0
+        coinbase = self.nodes[1].getblock(self.nodes[1].getblockhash(1))['tx'][0]
+        value = self.nodes[1].gettxout(coinbase, 0)['value']
+        payment_txid = self.nodes[1].sendrawtransaction(self.sign_transaction(
+            self.nodes[1], [{'txid': coinbase, 'vout': 0}],
+            {key.address: 1.0, self.nodes[1].get_deterministic_priv_key().address: value - Decimal('1.001')},
+            key.key))
         self.sync_all()
 
         # Should receive the broadcasted txid.
@@ -126,14 +145,18 @@ class ZMQTest (BitcoinTestFramework):
         assert_equal(payment_txid, hash256_reversed(hex).hex())
 
         self.log.info("Test the getzmqnotifications RPC")
-        assert_equal(self.nodes[0].getzmqnotifications(), [
-            {"type": "pubhashblock", "address": ADDRESS},
-            {"type": "pubhashds", "address": ADDRESS},
-            {"type": "pubhashtx", "address": ADDRESS},
-            {"type": "pubrawblock", "address": ADDRESS},
-            {"type": "pubrawds", "address": ADDRESS},
-            {"type": "pubrawtx", "address": ADDRESS},
+        notifications = self.nodes[0].getzmqnotifications()
+        assert_equal([{"type": n["type"], "address": n["address"], "dropped": n["dropped"]} for n in notifications], [
+            {"type": "pubhashblock", "address": ADDRESS, "dropped": 0},
+            {"type": "pubhashds", "address": ADDRESS, "dropped": 0},
+            {"type": "pubhashtx", "address": ADDRESS, "dropped": 0},
+            {"type": "pubrawblock", "address": ADDRESS, "dropped": 0},
+            {"type": "pubrawds", "address": ADDRESS, "dropped": 0},
+            {"type": "pubrawtx", "address": ADDRESS, "dropped": 0},
         ])
+        # The queue is shared, and has held at least one notification
+        assert_equal(len({n["queuehighwatermark"] for n in notifications}), 1)
+        assert_greater_than_or_equal(notifications[0]["queuehighwatermark"], 1)
 
         assert_equal(self.nodes[1].getzmqnotifications(), [])
 
@@ -153,10 +176,10 @@ class ZMQTest (BitcoinTestFramework):
         assert amt > fee * 2
         self.log.info(f"Spending {amt} from {payment_txid}:{vout}, fee: {fee}")
         ds_txs = [None, None]
-        addr = self.nodes[0].getnewaddress()
-        ds_txs[0] = create_raw_transaction(self.nodes[0], payment_txid, addr, amt - fee, vout)
+        inputs = [{'txid': payment_txid, 'vout': vout}]
+        ds_txs[0] = self.sign_transaction(self.nodes[0], inputs, {key.address: round(amt - fee, 8)}, key.key)
         self.log.info("Signed tx 0")
-        ds_txs[1] = create_raw_transaction(self.nodes[0], payment_txid, addr, amt - fee * 2, vout)
+        ds_txs[1] = self.sign_transaction(self.nodes[0], inputs, {key.address: round(amt - fee * 2, 8)}, key.key)
         self.log.info("Signed tx 1 (conflicting tx)")
 
         # Broadcast the two tx's via the other node
@@ -186,6 +209,17 @@ class ZMQTest (BitcoinTestFramework):
         ds_tx_zmq: bytes = self.rawds.receive()
         assert_equal(ds_txs[0], ds_tx_zmq.hex())
 
+        self.log.info("Test that the transactions of a block are published in batches")
+        # The block has the coinbase, the payment and the double-spent transaction, which fill one batch and a half.
+        blockhash = self.generatetoaddress(self.nodes[0], 1, key.address)[0]
+        block_txids = self.nodes[0].getblock(blockhash)['tx']
+        assert_equal(block_txids[1:], sorted([payment_txid, ds_txid]))
+        for batch in [block_txids[:2], block_txids[2:]]:
+            assert_equal([txid.hex() for txid in self.hashtx.receive_batch()], batch)
+            assert_equal([hash256_reversed(raw).hex() for raw in self.rawtx.receive_batch()], batch)
+        assert_equal(self.hashblock.receive().hex(), blockhash)
+        assert_equal(hash256_reversed(self.rawblock.receive()[:80]).hex(), blockhash)
+
 
 if __name__ == '__main__':
     ZMQTest().main()
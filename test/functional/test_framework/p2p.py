@@ -35,6 +35,9 @@ from test_framework.messages import (
     msg_block,
     MSG_BLOCK,
     msg_blocktxn,
+    msg_cfcheckpt,
+    msg_cfheaders,
+    msg_cfilter,
     msg_cmpctblock,
     msg_feefilter,
     msg_filteradd,
@@ -43,6 +46,9 @@ from test_framework.messages import (
     msg_getaddr,
     msg_getblocks,
     msg_getblocktxn,
+    msg_getcfcheckpt,
+    msg_getcfheaders,
+    msg_getcfilters,
     msg_getdata,
     msg_getheaders,
     msg_headers,
@@ -79,6 +85,9 @@ MESSAGEMAP = {
     b"addrv2": msg_addrv2,
     b"block": msg_block,
     b"blocktxn": msg_blocktxn,
+    b"cfcheckpt": msg_cfcheckpt,
+    b"cfheaders": msg_cfheaders,
+    b"cfilter": msg_cfilter,
     b"cmpctblock": msg_cmpctblock,
     b"feefilter": msg_feefilter,
     b"filteradd": msg_filteradd,
@@ -87,6 +96,9 @@ MESSAGEMAP = {
     b"getaddr": msg_getaddr,
     b"getblocks": msg_getblocks,
     b"getblocktxn": msg_getblocktxn,
+    b"getcfcheckpt": msg_getcfcheckpt,
+    b"getcfheaders": msg_getcfheaders,
+    b"getcfilters": msg_getcfilters,
     b"getdata": msg_getdata,
     b"getheaders": msg_getheaders,
     b"headers": msg_headers,
@@ -402,6 +414,12 @@ class P2PInterface(P2PConnection):
 
     def on_blocktxn(self, message): pass
 
+    def on_cfcheckpt(self, message): pass
+
+    def on_cfheaders(self, message): pass
+
+    def on_cfilter(self, message): pass
+
     def on_cmpctblock(self, message): pass
 
     def on_feefilter(self, message): pass
@@ -418,6 +436,12 @@ class P2PInterface(P2PConnection):
 
     def on_getblocktxn(self, message): pass
 
+    def on_getcfcheckpt(self, message): pass
+
+    def on_getcfheaders(self, message): pass
+
+    def on_getcfilters(self, message): pass
+
     def on_getdata(self, message): pass
 
     def on_dsproofbeta(self, message): pass